@@ -0,0 +1,424 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Cost of parsing _BST, _BIX and a nested package result with the acpiview.h view compared to
+// copying every argument out as the Rust demo used to. Heap allocations are counted with a
+// replaced operator new, the view must not make any. Every truncation of each buffer is also
+// fed to the parser to check it is rejected rather than read past the end.
+//
+// Requests for SKIN.THRS and THRM._DSM are built with the acpireq.h builder in a reused arena,
+// which must not allocate either, and the arguments it wrote are checked with the view. The
+// same requests made from the ecmethods.h bindings must match the builder byte for byte.
+//
+// Usage: acpibench [iterations]
+//
+// Build:
+//   g++ -std=c++14 -O2 -o acpibench acpibench.cpp
+//   cl /std:c++14 /O2 /EHsc acpibench.cpp
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "../inc/acpireq.h"
+#include "../inc/ecmethods.h"
+
+using Clock = std::chrono::steady_clock;
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size)
+{
+    g_allocations++;
+    void* p = malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// Output buffers are built the way the ACPI driver lays them out
+static void PutArg(std::vector<uint8_t>& out, uint16_t type, const void* data, uint16_t length)
+{
+    const uint8_t header[4] = { static_cast<uint8_t>(type), static_cast<uint8_t>(type >> 8),
+                                static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8) };
+    out.insert(out.end(), header, header + sizeof(header));
+    out.insert(out.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + length);
+    out.resize(out.size() + (ACPI_VIEW_ARG_SIZE(length) - ACPI_VIEW_ARG_HEADER - length), 0);
+}
+
+static void PutInteger(std::vector<uint8_t>& out, uint32_t value)
+{
+    PutArg(out, ACPI_VIEW_TYPE_INTEGER, &value, sizeof(value));
+}
+
+static void PutString(std::vector<uint8_t>& out, const char* value)
+{
+    PutArg(out, ACPI_VIEW_TYPE_STRING, value, static_cast<uint16_t>(strlen(value) + 1));
+}
+
+static std::vector<uint8_t> MakeOutput(const std::vector<uint8_t>& args, uint32_t count)
+{
+    std::vector<uint8_t> out(ACPI_VIEW_OUTPUT_HEADER);
+    uint32_t signature = ACPI_VIEW_OUTPUT_SIGNATURE;
+    uint32_t length = static_cast<uint32_t>(ACPI_VIEW_OUTPUT_HEADER + args.size());
+    memcpy(&out[0], &signature, sizeof(signature));
+    memcpy(&out[4], &length, sizeof(length));
+    memcpy(&out[8], &count, sizeof(count));
+    out.insert(out.end(), args.begin(), args.end());
+    return out;
+}
+
+static std::vector<uint8_t> MakeBst()
+{
+    std::vector<uint8_t> args;
+    PutInteger(args, 2);        // Charging
+    PutInteger(args, 1500);     // Present rate
+    PutInteger(args, 4200);     // Remaining capacity
+    PutInteger(args, 12600);    // Present voltage
+    return MakeOutput(args, 4);
+}
+
+static std::vector<uint8_t> MakeBix()
+{
+    std::vector<uint8_t> args;
+    const uint32_t fields[16] = { 1, 0, 5000, 4800, 1, 12600, 500, 200, 42, 95000, 1000, 500, 1000, 500, 10, 10 };
+    for (uint32_t field : fields) {
+        PutInteger(args, field);
+    }
+    PutString(args, "ECTEST-BAT");
+    PutString(args, "0123456789");
+    PutString(args, "LION");
+    PutString(args, "Open Device Partnership");
+    PutInteger(args, 1);        // Swapping capability
+    return MakeOutput(args, 21);
+}
+
+// A package of packages, as returned by _PSS or _TRT
+static std::vector<uint8_t> MakeNested()
+{
+    std::vector<uint8_t> outer;
+    for (uint32_t i = 0; i < 4; i++) {
+        std::vector<uint8_t> inner;
+        for (uint32_t j = 0; j < 6; j++) {
+            PutInteger(inner, i * 100 + j);
+        }
+        PutArg(outer, ACPI_VIEW_TYPE_PACKAGE, inner.data(), static_cast<uint16_t>(inner.size()));
+    }
+
+    std::vector<uint8_t> args;
+    PutArg(args, ACPI_VIEW_TYPE_PACKAGE, outer.data(), static_cast<uint16_t>(outer.size()));
+    return MakeOutput(args, 1);
+}
+
+struct Bst {
+    uint32_t state, rate, capacity, voltage;
+};
+
+struct Bix {
+    uint32_t fields[16];
+    const char* strings[4];
+    uint32_t swapping;
+};
+
+static bool ViewBst(const std::vector<uint8_t>& buffer, Bst& bst)
+{
+    acpiview::ArgList args;
+    if (!acpiview::Parse(buffer.data(), buffer.size(), args) || args.Count() != 4) {
+        return false;
+    }
+
+    uint32_t* out[] = { &bst.state, &bst.rate, &bst.capacity, &bst.voltage };
+    size_t i = 0;
+    for (acpiview::Arg arg : args) {
+        *out[i++] = static_cast<uint32_t>(arg.Integer());
+    }
+    return true;
+}
+
+static bool ViewBix(const std::vector<uint8_t>& buffer, Bix& bix)
+{
+    acpiview::ArgList args;
+    acpiview::Arg arg;
+    if (!acpiview::Parse(buffer.data(), buffer.size(), args) || args.Count() != 21) {
+        return false;
+    }
+
+    for (size_t i = 0; i < 16 && args.Next(arg); i++) {
+        bix.fields[i] = static_cast<uint32_t>(arg.Integer());
+    }
+    for (size_t i = 0; i < 4 && args.Next(arg); i++) {
+        bix.strings[i] = arg.String();
+    }
+    args.Next(arg);
+    bix.swapping = static_cast<uint32_t>(arg.Integer());
+    return true;
+}
+
+static bool ViewNested(const std::vector<uint8_t>& buffer, uint64_t& sum)
+{
+    acpiview::ArgList args;
+    if (!acpiview::Parse(buffer.data(), buffer.size(), args) || args.Count() != 1 || !args[0].IsPackage()) {
+        return false;
+    }
+
+    sum = 0;
+    for (acpiview::Arg state : args[0].Package()) {
+        for (acpiview::Arg value : state.Package()) {
+            sum += value.Integer();
+        }
+    }
+    return true;
+}
+
+// Reference that copies each argument into its own vector
+static bool CopyArgs(const std::vector<uint8_t>& buffer, std::vector<std::vector<uint8_t>>& args)
+{
+    uint32_t count;
+    memcpy(&count, &buffer[8], sizeof(count));
+    size_t offset = ACPI_VIEW_OUTPUT_HEADER;
+
+    args.clear();
+    for (uint32_t i = 0; i < count; i++) {
+        if (offset + ACPI_VIEW_ARG_HEADER > buffer.size()) {
+            return false;
+        }
+        uint16_t length;
+        memcpy(&length, &buffer[offset + 2], sizeof(length));
+        if (offset + ACPI_VIEW_ARG_HEADER + length > buffer.size()) {
+            return false;
+        }
+        args.emplace_back(buffer.begin() + offset + ACPI_VIEW_ARG_HEADER,
+                          buffer.begin() + offset + ACPI_VIEW_ARG_HEADER + length);
+        offset += ACPI_VIEW_ARG_SIZE(length);
+    }
+    return true;
+}
+
+// THRS(2, Package() { timeout, low, high }) of thermal.asl
+static bool BuildThrs(acpireq::Builder& req)
+{
+    req.Reset("\\_SB.SKIN.THRS");
+    req.Integer(2).Package().Integer(1000).Integer(3032).Integer(3132).EndPackage();
+    return req.End() == ACPI_REQ_OK;
+}
+
+// THRM._DSM GET_VARS with a package of six variable UUIDs
+static bool BuildDsm(acpireq::Builder& req)
+{
+    static const uint8_t dsm[16] = { 0x82, 0x63, 0xff, 0x07, 0x9a, 0xe2, 0xc9, 0x47,
+                                     0xac, 0x87, 0xe7, 0x9d, 0xad, 0x71, 0xdd, 0x82 };
+    uint8_t var[16] = { 0 };
+
+    req.Reset("\\_SB.THRM._DSM");
+    req.Buffer(dsm, sizeof(dsm)).Integer(0).Integer(4).Package();
+    for (uint8_t i = 0; i < 6; i++) {
+        var[0] = i;
+        req.Buffer(var, sizeof(var));
+    }
+    req.EndPackage();
+    return req.End() == ACPI_REQ_OK;
+}
+
+// Packages nested three deep with strings, only useful to exercise the builder
+static bool BuildNested(acpireq::Builder& req)
+{
+    req.Reset("\\_SB.ECT0.TNST");
+    req.Package().String("outer").Package().Integer(1).Package().String("inner").EndPackage().EndPackage();
+    req.Package().EndPackage().EndPackage().Integer(7);
+    return req.End() == ACPI_REQ_OK;
+}
+
+// The same two requests from the generated bindings
+static size_t BindThrs(uint8_t* request)
+{
+    return ecmethods::SKIN::THRS::Build(request, 2, 1000, 3032, 3132);
+}
+
+static size_t BindDsm(uint8_t* request)
+{
+    AcpiGuid_t vars[6] = {};
+    for (uint32_t i = 0; i < 6; i++) {
+        vars[i].Data1 = i;
+    }
+    return ecmethods::THRM::Input::GVRS::Build(request, vars, 6);
+}
+
+/*
+ * Function: CheckBinding
+ * ----------------------
+ * The request from a binding must be the one the builder makes.
+ */
+template <typename Build, typename Bind>
+static bool CheckBinding(const char* name, Build&& build, Bind&& bind)
+{
+    acpireq::Request<512> req("");
+    uint8_t request[512];
+    size_t length = bind(request);
+    if (!build(req) || length != req.Length() || memcmp(request, req.Data(), length) != 0) {
+        printf("%s binding does not match the builder\n", name);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Function: CheckRequest
+ * ----------------------
+ * Builds a request in an arena that is too small, then in one of the size asked for, and checks
+ * the arguments written with the view.
+ */
+template <typename Build>
+static bool CheckRequest(const char* name, uint32_t count, Build&& build)
+{
+    uint8_t small[ACPI_REQ_HEADER + 8];
+    acpireq::Builder probe(small, sizeof(small), "");
+    if (build(probe) || probe.Status() != ACPI_REQ_NO_SPACE) {
+        printf("%s built in a %zu byte arena\n", name, sizeof(small));
+        return false;
+    }
+
+    std::vector<uint8_t> arena(probe.Length());
+    acpireq::Builder req(arena.data(), arena.size(), "");
+    uint32_t size, argc, checked;
+    if (!build(req) || req.Length() != arena.size()) {
+        printf("%s needs %zu bytes, %zu were asked for\n", name, req.Length(), arena.size());
+        return false;
+    }
+
+    memcpy(&size, &arena[ACPI_REQ_SIZE_OFFSET], sizeof(size));
+    memcpy(&argc, &arena[ACPI_REQ_COUNT_OFFSET], sizeof(argc));
+    if (ACPI_REQ_HEADER + size != arena.size() || argc != count ||
+        !acpiview::Check(&arena[ACPI_REQ_HEADER], arena.data() + arena.size(), checked, 0) || checked != count) {
+        printf("%s arguments do not parse\n", name);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Function: Measure
+ * -----------------
+ * Runs parse iterations times and prints the time and heap allocations per call.
+ */
+template <typename Parse>
+static size_t Measure(const char* name, int iterations, Parse&& parse)
+{
+    size_t allocations = g_allocations;
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        if (!parse()) {
+            printf("%-12s parse failed\n", name);
+            exit(1);
+        }
+    }
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    allocations = g_allocations - allocations;
+
+    printf("%-12s %10.1f %12.2f\n", name, secs * 1e9 / iterations, (double)allocations / iterations);
+    return allocations;
+}
+
+/*
+ * Function: CheckTruncation
+ * -------------------------
+ * Every prefix of a valid buffer, with Length patched to match, must be rejected.
+ */
+static bool CheckTruncation(const char* name, const std::vector<uint8_t>& buffer)
+{
+    acpiview::ArgList args;
+    for (size_t length = 0; length < buffer.size(); length++) {
+        std::vector<uint8_t> cut(buffer.begin(), buffer.begin() + length);
+        if (length >= ACPI_VIEW_OUTPUT_HEADER) {
+            uint32_t total = static_cast<uint32_t>(length);
+            memcpy(&cut[4], &total, sizeof(total));
+        }
+        if (acpiview::Parse(cut.data(), cut.size(), args)) {
+            // Cutting only the padding of the last argument leaves a complete buffer
+            if (length + ACPI_VIEW_ARG_MIN_DATA > buffer.size()) {
+                continue;
+            }
+            printf("%s truncated to %zu bytes was accepted\n", name, length);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+    const std::vector<uint8_t> bst = MakeBst();
+    const std::vector<uint8_t> bix = MakeBix();
+    const std::vector<uint8_t> nested = MakeNested();
+
+    if (!CheckTruncation("_BST", bst) || !CheckTruncation("_BIX", bix) || !CheckTruncation("nested", nested)) {
+        return 1;
+    }
+    if (!CheckRequest("THRS", 2, BuildThrs) || !CheckRequest("_DSM", 4, BuildDsm) || !CheckRequest("nested", 2, BuildNested)) {
+        return 1;
+    }
+    if (!CheckBinding("THRS", BuildThrs, BindThrs) || !CheckBinding("_DSM", BuildDsm, BindDsm)) {
+        return 1;
+    }
+
+    Bst bstOut = {};
+    Bix bixOut = {};
+    uint64_t sum = 0;
+    std::vector<std::vector<uint8_t>> copies;
+    copies.reserve(32);
+
+    printf("%-12s %10s %12s\n", "case", "ns/call", "allocs/call");
+    size_t viewAllocations =
+        Measure("_BST view", iterations, [&] { return ViewBst(bst, bstOut); }) +
+        Measure("_BIX view", iterations, [&] { return ViewBix(bix, bixOut); }) +
+        Measure("nested view", iterations, [&] { return ViewNested(nested, sum); });
+    Measure("_BST copy", iterations, [&] { return CopyArgs(bst, copies); });
+    Measure("_BIX copy", iterations, [&] { return CopyArgs(bix, copies); });
+
+    acpireq::Request<512> request("");
+    viewAllocations +=
+        Measure("THRS build", iterations, [&] { return BuildThrs(request); }) +
+        Measure("_DSM build", iterations, [&] { return BuildDsm(request); });
+
+    uint8_t bound[512];
+    viewAllocations +=
+        Measure("THRS bind", iterations, [&] { return BindThrs(bound) != 0; }) +
+        Measure("_DSM bind", iterations, [&] { return BindDsm(bound) != 0; });
+
+    printf("\n_BST state %u rate %u capacity %u voltage %u\n", bstOut.state, bstOut.rate, bstOut.capacity, bstOut.voltage);
+    printf("_BIX model %s serial %s type %s oem %s cycles %u\n",
+           bixOut.strings[0], bixOut.strings[1], bixOut.strings[2], bixOut.strings[3], bixOut.fields[8]);
+    printf("nested sum %llu\n", static_cast<unsigned long long>(sum));
+
+    if (viewAllocations != 0) {
+        printf("view and builder made %zu allocations\n", viewAllocations);
+        return 1;
+    }
+    return 0;
+}
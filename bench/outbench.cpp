@@ -0,0 +1,215 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Cost of writing an ACPI method result with the acpiout.h writer in each format compared to
+// the printf per value dump ectest used to make, with the raw buffer printed after the
+// arguments. Output goes to a temporary file so the console is not measured. The bin output
+// is read back and must be the result byte for byte, jsonl must be one line and csv a row per
+// argument.
+//
+// Usage: outbench [iterations] [buffer bytes]
+//
+// Build:
+//   g++ -std=c++14 -O2 -o outbench outbench.cpp
+//   cl /std:c++14 /O2 /EHsc outbench.cpp
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../inc/acpiout.h"
+
+using Clock = std::chrono::steady_clock;
+
+static void PutArg(std::vector<uint8_t>& out, uint16_t type, const void* data, uint16_t length)
+{
+    const uint8_t header[4] = { static_cast<uint8_t>(type), static_cast<uint8_t>(type >> 8),
+                                static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8) };
+    out.insert(out.end(), header, header + sizeof(header));
+    out.insert(out.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + length);
+    out.resize(out.size() + (ACPI_VIEW_ARG_SIZE(length) - ACPI_VIEW_ARG_HEADER - length), 0);
+}
+
+// An integer, a string, a buffer of the given size and a package of two integers
+static std::vector<uint8_t> MakeResult(size_t bytes)
+{
+    std::vector<uint8_t> args, package, data(bytes);
+    const uint32_t values[3] = { 3032, 7, 9 };
+
+    for (size_t i = 0; i < bytes; i++) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+    PutArg(args, ACPI_VIEW_TYPE_INTEGER, &values[0], sizeof(values[0]));
+    PutArg(args, ACPI_VIEW_TYPE_STRING, "ECTEST", 7);
+    PutArg(args, ACPI_VIEW_TYPE_BUFFER, data.data(), static_cast<uint16_t>(bytes));
+    PutArg(package, ACPI_VIEW_TYPE_INTEGER, &values[1], sizeof(values[1]));
+    PutArg(package, ACPI_VIEW_TYPE_INTEGER, &values[2], sizeof(values[2]));
+    PutArg(args, ACPI_VIEW_TYPE_PACKAGE, package.data(), static_cast<uint16_t>(package.size()));
+
+    std::vector<uint8_t> out(ACPI_VIEW_OUTPUT_HEADER);
+    uint32_t signature = ACPI_VIEW_OUTPUT_SIGNATURE;
+    uint32_t length = static_cast<uint32_t>(ACPI_VIEW_OUTPUT_HEADER + args.size());
+    uint32_t count = 4;
+    memcpy(&out[0], &signature, sizeof(signature));
+    memcpy(&out[4], &length, sizeof(length));
+    memcpy(&out[8], &count, sizeof(count));
+    out.insert(out.end(), args.begin(), args.end());
+    return out;
+}
+
+// What ectest printed before, one printf per value and per byte
+static void PrintfArgs(FILE* f, const acpiview::ArgList& args, int depth)
+{
+    int indent = 4 + depth * 4;
+    int i = 0;
+
+    for (acpiview::Arg arg : args) {
+        fprintf(f, "%*sArgument[%i]:\n", indent, "", i++);
+        switch (arg.Type()) {
+        case ACPI_VIEW_TYPE_INTEGER:
+            fprintf(f, "%*sInteger Value: 0x%llx\n", indent, "", static_cast<unsigned long long>(arg.Integer()));
+            break;
+        case ACPI_VIEW_TYPE_STRING:
+            fprintf(f, "%*sString Value: %s\n", indent, "", arg.String());
+            break;
+        case ACPI_VIEW_TYPE_PACKAGE:
+        case ACPI_VIEW_TYPE_PACKAGE_EX:
+            fprintf(f, "%*sPackage of %u elements:\n", indent, "", arg.Package().Count());
+            PrintfArgs(f, arg.Package(), depth + 1);
+            break;
+        default:
+            fprintf(f, "%*sBuffer Data:\n%*s", indent, "", indent, "");
+            for (size_t j = 0; j < arg.BufferLength(); j++) {
+                fprintf(f, " 0x%x,", arg.Buffer()[j]);
+            }
+            fprintf(f, "\n");
+            break;
+        }
+    }
+}
+
+static void PrintfResult(FILE* f, const std::vector<uint8_t>& result)
+{
+    acpiview::ArgList args;
+    uint32_t length = static_cast<uint32_t>(result.size());
+
+    fprintf(f, "ACPI Method: \n");
+    fprintf(f, "  Signature: 0x%x\n", ACPI_VIEW_OUTPUT_SIGNATURE);
+    fprintf(f, "  Length: 0x%x\n", length);
+    fprintf(f, "  Count: 0x%x\n", 4);
+    if (acpiview::Parse(result.data(), result.size(), args)) {
+        PrintfArgs(f, args, 0);
+    }
+    fprintf(f, "\n\nACPI Raw Output:\n");
+    for (uint32_t i = 0; i < length; i++) {
+        fprintf(f, " 0x%x", result[i]);
+    }
+    fprintf(f, "\n\n");
+}
+
+static std::vector<char> ReadBack(FILE* f)
+{
+    std::vector<char> data(static_cast<size_t>(ftell(f)));
+    rewind(f);
+    if (!data.empty() && fread(data.data(), 1, data.size(), f) != data.size()) {
+        data.clear();
+    }
+    rewind(f);
+    return data;
+}
+
+// Runs one format, format ACPI_OUT_COUNT is the printf dump. Returns false if the output is wrong.
+static bool Run(const char* name, uint32_t format, uint32_t flags, const std::vector<uint8_t>& result, size_t iterations)
+{
+    FILE* f = tmpfile();
+    if (f == nullptr) {
+        printf("tmpfile failed\n");
+        return false;
+    }
+
+    size_t bytes = 0;
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        rewind(f);
+        if (format == ACPI_OUT_COUNT) {
+            PrintfResult(f, result);
+            fflush(f);
+        } else {
+            acpiout::Writer w(f);
+            acpiout::Result(w, format, flags, "\\_SB.ECT0.TEST", 0, result.data(), result.size());
+        }
+        bytes = static_cast<size_t>(ftell(f));
+    }
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<char> out = ReadBack(f);
+    fclose(f);
+
+    size_t lines = 0;
+    for (char c : out) {
+        lines += c == '\n';
+    }
+
+    bool ok = out.size() == bytes;
+    if (format == ACPI_OUT_BIN) {
+        ok = ok && out.size() == result.size() && memcmp(out.data(), result.data(), out.size()) == 0;
+    } else if (format == ACPI_OUT_JSONL) {
+        ok = ok && lines == 1 && out.back() == '\n';
+    } else if (format == ACPI_OUT_CSV) {
+        // Header, 4 arguments, 2 package elements and the raw row
+        ok = ok && lines == 1u + 6u + ((flags & ACPI_OUT_RAW) ? 1u : 0u);
+    }
+    if (!ok) {
+        printf("%-12s wrong output\n", name);
+        return false;
+    }
+
+    printf("%-12s %10.1f %10zu\n", name, secs * 1e6 / iterations, bytes);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 0) : 2000;
+    size_t bytes = argc > 2 ? strtoul(argv[2], nullptr, 0) : 4096;
+    if (iterations == 0 || bytes > 0xFFFF - 64) {
+        printf("Usage: outbench [iterations] [buffer bytes up to %u]\n", 0xFFFF - 64);
+        return 1;
+    }
+
+    std::vector<uint8_t> result = MakeResult(bytes);
+    bool ok = true;
+
+    printf("%-12s %10s %10s\n", "format", "us/result", "bytes");
+    ok &= Run("printf+raw", ACPI_OUT_COUNT, 0, result, iterations);
+    ok &= Run("text+raw", ACPI_OUT_TEXT, ACPI_OUT_RAW, result, iterations);
+    ok &= Run("text", ACPI_OUT_TEXT, 0, result, iterations);
+    ok &= Run("json", ACPI_OUT_JSON, 0, result, iterations);
+    ok &= Run("jsonl", ACPI_OUT_JSONL, 0, result, iterations);
+    ok &= Run("csv", ACPI_OUT_CSV, 0, result, iterations);
+    ok &= Run("csv+raw", ACPI_OUT_CSV, ACPI_OUT_RAW, result, iterations);
+    ok &= Run("bin", ACPI_OUT_BIN, 0, result, iterations);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+// Cost of recording a session with the ecrecord.h writer, per record and against the round trip
+// of the calls being recorded, and size of the recording per record. A mix of _BST evaluations,
+// SKIN._TMP evaluations from several threads completing out of order, FF-A commands and
+// notifications is written, read back and checked field by field. Every prefix of a recording
+// must read as exactly the records that fit in it, as a recording cut short by a crash would.
+//
+// Usage: recordbench [records] [round_trip_us]
+//
+// Build:
+//   g++ -std=c++14 -O2 -o recordbench recordbench.cpp
+//   cl /std:c++14 /O2 /EHsc recordbench.cpp
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../inc/ecrecord.h"
+
+using Clock = std::chrono::steady_clock;
+
+static const char* const Methods[] = { "\\_SB.BAT0._BST", "\\_SB.SKIN._TMP", "\\_SB.ECT0.NEVT" };
+static const uint8_t ThermalUuid[EC_RECORD_UUID_SIZE] = {
+    0x5c, 0xf8, 0x39, 0xdf, 0x8b, 0xe7, 0x42, 0xb9, 0x9a, 0xc5, 0x34, 0x03, 0xca, 0x2c, 0x8a, 0x6a };
+
+// Output of _BST, four integers in an ACPI_EVAL_OUTPUT_BUFFER_V1
+static const uint8_t BstOutput[] = {
+    0x41, 0x65, 0x6f, 0x42, 0x3c, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0xe8, 0x03, 0x00, 0x00,
+    0x00, 0x00, 0x04, 0x00, 0x10, 0x27, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0xd4, 0x30, 0x00, 0x00 };
+
+/*
+ * Function: WriteRecord
+ * ---------------------
+ * Appends record i of the mix. Times advance 50us per record, every fourth record completed
+ * before the one in front of it.
+ */
+static void WriteRecord(ecrecord::Writer& writer, uint32_t i)
+{
+    uint64_t time = i * 500ull - ((i % 4 == 3) ? 700 : 0);
+    uint8_t response[40] = {};
+    uint8_t input[8] = { 0x02, 0x02 };
+    uint32_t value = 3000 + i % 100;
+
+    switch (i % 8) {
+    case 0: case 1: case 2: case 4: case 5:
+        writer.Eval(time, 120 + i % 50, Methods[i % 2], (i % 2) ? 0 : UINT32_MAX, 0x45696541, 0, 256,
+                    nullptr, 0, BstOutput, sizeof(BstOutput));
+        break;
+    case 3: case 6:
+        writer.Command(ThermalUuid, 2, 1, 4, 0, input, &value);
+        writer.Command(ThermalUuid, 2, 1, 4, 0, input, &value);
+        writer.Ffa(time, 80, 0, 1);
+        break;
+    default:
+        memcpy(response, &i, sizeof(i));
+        writer.Notify(time, 0x20 + i % 3, response, sizeof(response));
+        break;
+    }
+}
+
+/*
+ * Function: CheckRecord
+ * ---------------------
+ * Compares a record read back with what WriteRecord wrote for it.
+ */
+static bool CheckRecord(ecrecord::Reader& reader, const ecrecord::Record& record, uint32_t i)
+{
+    uint64_t time = i * 500ull - ((i % 4 == 3) ? 700 : 0);
+    if (record.time != time) {
+        return false;
+    }
+
+    switch (i % 8) {
+    case 0: case 1: case 2: case 4: case 5:
+        return record.kind == EC_RECORD_EVAL && record.duration == 120 + i % 50 &&
+               record.name_len == strlen(Methods[i % 2]) && memcmp(record.name, Methods[i % 2], record.name_len) == 0 &&
+               record.priority == ((i % 2) ? 0 : UINT32_MAX) && record.capacity == 256 &&
+               record.output_len == sizeof(BstOutput) && memcmp(record.output, BstOutput, sizeof(BstOutput)) == 0;
+    case 3: case 6: {
+        ecrecord::Command command;
+        uint32_t value = 3000 + i % 100;
+        if (record.kind != EC_RECORD_FFA || record.count != 2) {
+            return false;
+        }
+        for (int c = 0; c < 2; c++) {
+            if (!reader.NextCommand(command) || memcmp(command.uuid, ThermalUuid, EC_RECORD_UUID_SIZE) != 0 ||
+                command.outlen != 4 || memcmp(command.output, &value, sizeof(value)) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    default:
+        return record.kind == EC_RECORD_NOTIFY && record.event == 0x20 + i % 3 && record.output_len == 40 &&
+               memcmp(record.output, &i, sizeof(i)) == 0;
+    }
+}
+
+/*
+ * Function: CheckPrefixes
+ * -----------------------
+ * A recording cut at any byte must read back the records that fit in it and no more.
+ */
+static bool CheckPrefixes(const ecrecord::Writer& writer, uint32_t records)
+{
+    for (size_t length = EC_RECORD_HEADER_SIZE; length <= writer.Length(); length++) {
+        ecrecord::Reader reader(writer.Data(), length);
+        ecrecord::Record record;
+        uint32_t i = 0;
+        while (reader.Next(record)) {
+            if (i >= records || !CheckRecord(reader, record, i)) {
+                printf("prefix of %zu bytes read record %u wrong\n", length, i);
+                return false;
+            }
+            i++;
+        }
+        bool whole = length == writer.Length();
+        if ((i == records) != whole || (whole && reader.Truncated())) {
+            printf("prefix of %zu bytes read %u records, truncated %d\n", length, i, reader.Truncated());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t records = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 1000000;
+    double round_trip = argc > 2 ? atof(argv[2]) : 50.0;
+
+    // Small recording for the field and truncation checks
+    ecrecord::Writer small;
+    small.Header(0);
+    for (uint32_t i = 0; i < 64; i++) {
+        WriteRecord(small, i);
+    }
+    if (!CheckPrefixes(small, 64)) {
+        return 1;
+    }
+
+    // Flushed every 64KB the way eclib does, so the buffer stays in cache
+    ecrecord::Writer writer;
+    writer.Reserve(0x20000);
+    writer.Header(0);
+    std::vector<uint8_t> file;
+    file.reserve(static_cast<size_t>(records) * 64);
+
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < records; i++) {
+        WriteRecord(writer, i);
+        if (writer.Length() >= 0x10000) {
+            file.insert(file.end(), writer.Data(), writer.Data() + writer.Length());
+            writer.Clear();
+        }
+    }
+    double write = std::chrono::duration<double>(Clock::now() - start).count() * 1e9 / records;
+    file.insert(file.end(), writer.Data(), writer.Data() + writer.Length());
+
+    ecrecord::Reader reader(file.data(), file.size());
+    ecrecord::Record record;
+    uint32_t read = 0;
+    start = Clock::now();
+    while (reader.Next(record)) {
+        if (!CheckRecord(reader, record, read)) {
+            printf("record %u read back wrong\n", read);
+            return 1;
+        }
+        read++;
+    }
+    double parse = std::chrono::duration<double>(Clock::now() - start).count() * 1e9 / records;
+    if (read != records || reader.Truncated()) {
+        printf("read %u of %u records\n", read, records);
+        return 1;
+    }
+
+    printf("%u records, %.1f bytes/record\n", records, (double)file.size() / records);
+    printf("write %.1f ns/record, %.2f%% of a %.0f us round trip\n", write, write / (round_trip * 10.0), round_trip);
+    printf("read  %.1f ns/record\n", parse);
+    return 0;
+}
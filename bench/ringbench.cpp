@@ -0,0 +1,154 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Throughput of fragmented messages through the shared memory ring layout with a local producer
+// thread standing in for the EC and the reference reassembler as consumer. Slot count and entry
+// size can be given on the command line to compare ring geometries.
+//
+// Usage: ringbench [iterations] [slots] [entry_size]
+//
+// Build:
+//   g++ -std=c++17 -O2 -pthread -o ringbench ringbench.cpp
+//   cl /std:c++17 /O2 /EHsc ringbench.cpp
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "../inc/ecring.h"
+
+using Clock = std::chrono::steady_clock;
+
+/*
+ * Function: ProduceMessage
+ * ------------------------
+ * Writes one message into the ring as the EC would, waiting for a free slot for each fragment.
+ */
+static void ProduceMessage(ecring::RingPage& ring, uint16_t seq, const std::vector<uint8_t>& payload)
+{
+    size_t slot = 0;
+    ecring::Fragment(seq, payload.data(), payload.size(), ring.EntrySize(),
+        [&](uint64_t header, const uint8_t* data, size_t length) {
+            // Fill the ring in order, spin until the consumer frees the next slot
+            while (ring.Header(slot) != 0) {
+                std::this_thread::yield();
+            }
+            memcpy(ring.Entry(slot), data, length);
+            ring.SetHeader(slot, header);
+            slot = (slot + 1) % ring.SlotCount();
+        });
+}
+
+/*
+ * Function: ConsumeMessage
+ * ------------------------
+ * Scans the ring for the fragments of seq and reassembles them, releasing each slot once copied.
+ */
+static bool ConsumeMessage(ecring::RingPage& ring, ecring::Reassembler& reassembler, uint16_t seq)
+{
+    reassembler.Reset(seq);
+    for (;;) {
+        bool found = false;
+        for (size_t slot = 0; slot < ring.SlotCount(); slot++) {
+            uint64_t header = ring.Header(slot);
+            if (!reassembler.Wants(header)) {
+                continue;
+            }
+
+            found = true;
+            auto result = reassembler.Push(header, ring.Entry(slot));
+            ring.SetHeader(slot, 0);
+            if (result == ecring::Reassembler::Result::Complete) {
+                return true;
+            } else if (result == ecring::Reassembler::Result::Error) {
+                return false;
+            }
+        }
+        if (!found) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 200;
+    int slots = argc > 2 ? atoi(argv[2]) : EC_RING_DEFAULT_SLOT_COUNT;
+    int entry_size = argc > 3 ? strtol(argv[3], nullptr, 0) : EC_RING_DEFAULT_ENTRY_SIZE;
+
+    // Publish and read back the geometry header the same way UEFI and the driver do
+    ecring::Geometry published = ecring::Geometry::Make(static_cast<uint16_t>(slots), static_cast<uint16_t>(entry_size));
+    if (!published.Valid()) {
+        printf("Usage: ringbench [iterations] [slots %d-%d] [entry_size 0x%x-0x%x multiple of 0x%x]\n",
+               EC_RING_SLOT_MIN, EC_RING_SLOT_MAX, EC_RING_ENTRY_MIN, EC_RING_ENTRY_MAX, EC_RING_ENTRY_ALIGN);
+        return 1;
+    }
+
+    std::vector<uint64_t> region(published.region_size / sizeof(uint64_t));
+    published.Write(region.data());
+
+    ecring::Geometry geometry;
+    if (!geometry.Read(region.data())) {
+        printf("Geometry header did not parse\n");
+        return 1;
+    }
+
+    uint8_t* rx = reinterpret_cast<uint8_t*>(region.data()) + geometry.rx_offset;
+    ecring::RingPage ring(rx, geometry);
+    ecring::Reassembler reassembler;
+
+    printf("slots %u entry 0x%x ring 0x%x\n", geometry.slot_count, geometry.entry_size, geometry.ring_size);
+    printf("%8s %10s %12s %12s\n", "payload", "messages", "MB/s", "us/msg");
+    for (size_t size = 1024; size <= 64 * 1024; size *= 2) {
+        std::vector<uint8_t> payload(size);
+        for (size_t i = 0; i < size; i++) {
+            payload[i] = static_cast<uint8_t>(i * 7);
+        }
+
+        memset(rx, 0, geometry.ring_size);
+        auto start = Clock::now();
+        std::thread producer([&] {
+            for (int i = 0; i < iterations; i++) {
+                ProduceMessage(ring, static_cast<uint16_t>(i % 0xFFFF + 1), payload);
+            }
+        });
+
+        bool ok = true;
+        for (int i = 0; i < iterations && ok; i++) {
+            ok = ConsumeMessage(ring, reassembler, static_cast<uint16_t>(i % 0xFFFF + 1)) &&
+                 reassembler.Message() == payload;
+        }
+        producer.join();
+        double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (!ok) {
+            printf("%8zu reassembly mismatch\n", size);
+            return 1;
+        }
+        printf("%8zu %10d %12.1f %12.2f\n", size, iterations,
+               (double)size * iterations / secs / (1024 * 1024), secs * 1e6 / iterations);
+    }
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Simulates the driver priority queues of one shard with the ecsched.h rules while critical
+// clients keep the critical class saturated, each queuing its next evaluation as soon as the
+// last one completes. One bulk and one normal request are queued once the critical traffic
+// is running and must still be dispatched within two aging periods of their class. The same
+// run with the limits checked against the original class, as the driver used to, shows the
+// bulk request starving.
+//
+// Usage: schedbench [critical clients] [critical service us]
+//
+// Build:
+//   g++ -std=c++14 -O2 -o schedbench schedbench.cpp
+//   cl /std:c++14 /O2 /EHsc schedbench.cpp
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <queue>
+#include <vector>
+#include "../inc/ecsched.h"
+
+#define TICKS_PER_MS    10000ULL        // 100ns units like KeQueryInterruptTime
+#define SIM_LENGTH_MS   2000ULL
+#define LATE_START_MS   50ULL           // Bulk and normal requests arrive once critical is saturated
+
+struct Request {
+    unsigned int cls;
+    unsigned long long enqueued;
+    bool client;                        // Critical client request, queued again when done
+};
+
+struct Completion {
+    unsigned long long time;
+    Request request;
+    bool operator>(const Completion& other) const { return time > other.time; }
+};
+
+struct Shard {
+    std::deque<Request> queues[EC_SCHED_CLASSES];
+    unsigned int inflight = 0;
+};
+
+// PriorityNext for one shard, aged says whether limits use the aged class
+static bool Next(Shard& shard, unsigned long long now, bool aged, Request& out)
+{
+    unsigned int best = EC_SCHED_CLASSES, bestLevel = EC_SCHED_CLASSES;
+    unsigned long long bestWaited = 0;
+
+    for (unsigned int i = 0; i < EC_SCHED_CLASSES; i++) {
+        if (shard.queues[i].empty()) {
+            continue;
+        }
+        unsigned long long waited = now - shard.queues[i].front().enqueued;
+        unsigned int level = EcSchedLevel(i, waited);
+        if (EcSchedCheck(aged ? level : i, shard.inflight, shard.inflight) != EC_SCHED_ALLOWED) {
+            continue;
+        }
+        if (aged ? EcSchedBetter(level, waited, bestLevel, bestWaited) : level < bestLevel) {
+            best = i;
+            bestLevel = level;
+            bestWaited = waited;
+        }
+    }
+
+    if (best == EC_SCHED_CLASSES) {
+        return false;
+    }
+    out = shard.queues[best].front();
+    shard.queues[best].pop_front();
+    return true;
+}
+
+// Runs the scenario, returns the dispatch delay in ms of each class, SIM_LENGTH_MS if never
+static void Run(bool aged, unsigned int clients, unsigned long long service, unsigned long long delay[EC_SCHED_CLASSES])
+{
+    const unsigned long long serviceTicks[EC_SCHED_CLASSES] = { service, 5 * TICKS_PER_MS, 20 * TICKS_PER_MS };
+    std::priority_queue<Completion, std::vector<Completion>, std::greater<Completion>> running;
+    Shard shard;
+    unsigned long long now = 0;
+    bool late = false;
+
+    for (unsigned int i = 0; i < EC_SCHED_CLASSES; i++) {
+        delay[i] = SIM_LENGTH_MS;
+    }
+    for (unsigned int c = 0; c < clients; c++) {
+        shard.queues[0].push_back({ 0, 0, true });
+    }
+
+    while (now < SIM_LENGTH_MS * TICKS_PER_MS) {
+        if (!late && now >= LATE_START_MS * TICKS_PER_MS) {
+            shard.queues[1].push_back({ 1, now, false });
+            shard.queues[2].push_back({ 2, now, false });
+            late = true;
+        }
+
+        // PriorityDispatch runs on every queue and completion
+        Request request;
+        while (Next(shard, now, aged, request)) {
+            shard.inflight++;
+            if (!request.client) {
+                delay[request.cls] = (now - request.enqueued) / TICKS_PER_MS;
+            }
+            running.push({ now + serviceTicks[request.cls], request });
+        }
+
+        if (running.empty()) {
+            break;
+        }
+        now = running.top().time;
+        if (!late && now > LATE_START_MS * TICKS_PER_MS) {
+            now = LATE_START_MS * TICKS_PER_MS;
+            continue;
+        }
+        while (!running.empty() && running.top().time == now) {
+            Request done = running.top().request;
+            running.pop();
+            shard.inflight--;
+            if (done.client) {
+                shard.queues[0].push_back({ 0, now, true });
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int clients = argc > 1 ? strtoul(argv[1], nullptr, 0) : 6;
+    unsigned long long serviceUs = argc > 2 ? strtoul(argv[2], nullptr, 0) : 2000;
+    if (clients <= EcSchedShardLimit[0] || serviceUs == 0) {
+        printf("Usage: schedbench [critical clients above %u] [critical service us]\n", EcSchedShardLimit[0]);
+        return 1;
+    }
+
+    unsigned long long agedDelay[EC_SCHED_CLASSES], classDelay[EC_SCHED_CLASSES];
+    Run(true, clients, serviceUs * TICKS_PER_MS / 1000, agedDelay);
+    Run(false, clients, serviceUs * TICKS_PER_MS / 1000, classDelay);
+
+    printf("%u critical clients, %llu us each, shard limits %u/%u/%u, aging %u/%u ms\n",
+           clients, serviceUs, EcSchedShardLimit[0], EcSchedShardLimit[1], EcSchedShardLimit[2],
+           EcSchedAgeMs[1], EcSchedAgeMs[2]);
+    printf("%-8s %14s %14s %10s\n", "class", "aged limits", "class limits", "bound");
+
+    bool ok = true;
+    const char* names[EC_SCHED_CLASSES] = { "critical", "normal", "bulk" };
+    for (unsigned int i = 1; i < EC_SCHED_CLASSES; i++) {
+        unsigned long long bound = 2ULL * EcSchedAgeMs[i];
+        printf("%-8s %11llu ms %11llu ms %7llu ms%s\n", names[i], agedDelay[i], classDelay[i], bound,
+               classDelay[i] >= SIM_LENGTH_MS ? "  (class limits never dispatched it)" : "");
+        // Two aging periods plus a critical service time for a slot to free up
+        if (agedDelay[i] > bound + serviceUs / 1000 + 1) {
+            printf("%s waited %llu ms, more than %llu ms\n", names[i], agedDelay[i], bound);
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,1208 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Emulator of the EC secure partition management, thermal and battery services so the FF-A
+// and shared memory ring protocol can be load tested on any Linux box without QEMU.
+//
+// Direct requests arrive over a Unix socket (see ecemu.h) and are handled by a pool of workers
+// after a configurable service time. The emulator is also the EC end of the TX/RX rings in a
+// shared memory file: it consumes TX entries, posts responses on the RX ring fragmenting them
+// as needed and rings the RX/TX doorbells as notifications. Unsolicited EC events come from a
+// generator with the same rate, burst and distribution controls as the driver's IOCTL_GENERATOR,
+// started by clients with FRAME_GENERATOR or at startup with -notify. A pool of bulk buffers
+// follows the rings in the file, published the way UEFI does, for EC_CAP_BULK transfers. A log
+// stream ring follows the pool: requests, generator runs and every generated event are logged to
+// it, and the log doorbell is rung only when a reader has armed it.
+//
+// Build:
+//   g++ -std=c++17 -O2 -pthread -Wno-unknown-pragmas -o ecemu ecemu.cpp
+//
+// Usage:
+//   ecemu [-socket path] [-ring path] [-slots n] [-entry bytes] [-service us] [-jitter us]
+//         [-notify hz] [-workers n] [-async-bytes n] [-bulk-buffers n] [-bulk-size bytes]
+//         [-log-size bytes]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/un.h>
+#include "ecemu.h"
+
+using namespace ecemu;
+
+struct Options {
+    std::string socket_path = ECEMU_DEFAULT_SOCKET;
+    std::string ring_path = ECEMU_DEFAULT_RING;
+    int slots = EC_RING_DEFAULT_SLOT_COUNT;
+    int entry_size = EC_RING_DEFAULT_ENTRY_SIZE;
+    int service_us = 50;        // Fixed part of every request
+    int jitter_us = 0;          // Uniform random extra service time
+    uint32_t notify_hz = 0;     // Rate of unsolicited EC events at startup, 0 for none
+    int workers = 1;            // Requests processed in parallel, a real EC has one
+    int async_bytes = 8;        // Size of responses posted to the RX ring
+    uint32_t fw_state = 0x00010002;
+    int bulk_buffers = 4;       // Pool buffers after the rings, 0 for no pool
+    uint32_t bulk_size = 0x40000;
+    uint32_t log_size = 0x10000;    // Log stream ring after the pool, 0 for none
+};
+
+struct Client {
+    int fd;
+    std::mutex write_lock;
+};
+
+class Emulator;
+
+#define SERVICE_TICK_MS         10
+
+/*
+ * Class: Service
+ * --------------
+ * One EC secure partition service. Handle gets x4-x17 of the request and fills in x4-x17 of the
+ * response, returning the FF-A status for x0. Tick runs every SERVICE_TICK_MS for state that
+ * changes on its own.
+ */
+class Service {
+public:
+    virtual ~Service() = default;
+    virtual const GUID& Uuid() const = 0;
+    virtual const char* Name() const = 0;
+    virtual uint64_t Handle(const FFA_SEND_DIRECT_REQ2_BUFFER& in, FFA_SEND_DIRECT_REQ2_BUFFER& out) = 0;
+    virtual void Tick() {}
+};
+
+class Emulator {
+public:
+    explicit Emulator(const Options& options) : m_options(options) {}
+
+    bool Start();
+    void Run();
+    void Stop();
+
+    void Broadcast(const GUID& uuid, uint32_t notify_id, const GeneratorStamp_t* stamp = nullptr);
+    void RaiseEvent(uint32_t notify_id, const void* data, size_t length, const GeneratorStamp_t* stamp = nullptr);
+    bool ControlGenerator(const GeneratorReq_t& req, GeneratorRsp_t& rsp);
+    void KickRing();
+    uint8_t* BulkBuffer(uint64_t handle);
+    void Log(uint8_t level, uint16_t source, const char* format, ...) __attribute__((format(printf, 4, 5)));
+    const Options& Opts() const { return m_options; }
+
+private:
+    struct Work {
+        std::shared_ptr<Client> client;
+        Frame frame;
+    };
+
+    bool MapRing();
+    Service* Find(const GUID& uuid);
+    uint64_t Dispatch(const GUID& uuid, const FFA_SEND_DIRECT_REQ2_BUFFER& in, FFA_SEND_DIRECT_REQ2_BUFFER& out);
+    void ServiceTime();
+
+    void AcceptThread();
+    void ClientThread(std::shared_ptr<Client> client);
+    void WorkerThread();
+    void RingThread();
+    void GeneratorThread();
+    void TickThread();
+
+    bool PostResponse(uint16_t seq, const std::vector<uint8_t>& data);
+
+    Options m_options;
+    std::vector<std::unique_ptr<Service>> m_services;
+    std::atomic<bool> m_stop{false};
+    int m_listen = -1;
+
+    std::mutex m_clients_lock;
+    std::vector<std::shared_ptr<Client>> m_clients;
+
+    std::mutex m_work_lock;
+    std::condition_variable m_work_cv;
+    std::deque<Work> m_work;
+
+    std::mutex m_ring_lock;
+    std::condition_variable m_ring_cv;
+    bool m_ring_kick = false;
+
+    uint8_t* m_region = nullptr;
+    ecring::Geometry m_geometry;
+    std::unique_ptr<ecring::RingPage> m_tx;
+    std::unique_ptr<ecring::RingPage> m_rx;
+    ecring::BulkPool m_bulk;
+    std::mutex m_event_lock;
+
+    std::mutex m_log_lock;
+    std::unique_ptr<ecring::LogRing> m_log;
+
+    std::mutex m_gen_lock;
+    std::condition_variable m_gen_cv;
+    GeneratorReq_t m_gen_config = {};
+    bool m_gen_running = false;
+    uint32_t m_gen_run = 0;
+    uint64_t m_gen_generated = 0;
+    uint64_t m_gen_start = 0;       // Now100ns when the run started
+    uint64_t m_gen_elapsed = 0;
+    uint32_t m_gen_next = 0;
+    uint32_t m_gen_random = 1;
+
+    std::vector<std::thread> m_threads;
+};
+
+/*
+ * Class: ManagementService
+ * ------------------------
+ * EC_SVC_MANAGEMENT, firmware state, test notifications, memory sharing and async kicks.
+ */
+class ManagementService : public Service {
+public:
+    explicit ManagementService(Emulator& emu) : m_emu(emu) {}
+    const GUID& Uuid() const override { return ManagementUuid; }
+    const char* Name() const override { return "management"; }
+
+    uint64_t Handle(const FFA_SEND_DIRECT_REQ2_BUFFER& in, FFA_SEND_DIRECT_REQ2_BUFFER& out) override
+    {
+        switch (GetPayload<uint8_t>(in, EC_PAYLOAD_CMD)) {
+        case EC_ASYNC:
+            // Entry is already on the TX ring, response goes out on the RX ring
+            m_emu.KickRing();
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT, m_emu.Opts().fw_state);
+            return 0;
+        case EC_CAP_GET_FW_STATE:
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT, m_emu.Opts().fw_state);
+            return 0;
+        case EC_CAP_TEST_NFY: {
+            // Bytes after the event ID are echoed back as event data
+            uint8_t id = GetPayload<uint8_t>(in, 1);
+            m_emu.RaiseEvent(id != 0 ? id : EC_NOTIFY_EVENT_MIN, in.Buffer + 2, EC_PAYLOAD_OUT - 2);
+            return 0;
+        }
+        case EC_CAP_MAP_SHARE:
+            // Rings are already mapped from the shared memory file
+            printf("MAP_SHARE descriptor 0x%llx length %llu\n",
+                   (unsigned long long)in.Arg5, (unsigned long long)in.Arg6);
+            m_emu.Log(EC_LOG_LEVEL_INFO, LOG_SOURCE_MANAGEMENT, "MAP_SHARE descriptor 0x%llx length %llu",
+                      (unsigned long long)in.Arg5, (unsigned long long)in.Arg6);
+            SetPayload<uint32_t>(out, EC_MAP_SHARE_STATUS, 0);
+            return 0;
+        case EC_CAP_BULK: {
+            uint32_t status = Bulk(in, out);
+            SetPayload<uint32_t>(out, EC_BULK_STATUS, status);
+            m_emu.Log(status == 0 ? EC_LOG_LEVEL_VERBOSE : EC_LOG_LEVEL_WARNING, LOG_SOURCE_MANAGEMENT,
+                      "bulk op %u object %u offset 0x%x length 0x%x status %u", GetPayload<uint8_t>(in, EC_BULK_OP),
+                      GetPayload<uint8_t>(in, EC_BULK_OBJECT), GetPayload<uint32_t>(in, EC_BULK_OBJECT_OFFSET),
+                      GetPayload<uint32_t>(in, EC_BULK_LENGTH), status);
+            return 0;
+        }
+        default:
+            return 1;
+        }
+    }
+
+private:
+    // Moves up to one pool buffer between the buffer and an object, returns the EC status
+    uint32_t Bulk(const FFA_SEND_DIRECT_REQ2_BUFFER& in, FFA_SEND_DIRECT_REQ2_BUFFER& out)
+    {
+        uint8_t op = GetPayload<uint8_t>(in, EC_BULK_OP);
+        uint8_t id = GetPayload<uint8_t>(in, EC_BULK_OBJECT);
+        uint32_t offset = GetPayload<uint32_t>(in, EC_BULK_OBJECT_OFFSET);
+        uint32_t length = GetPayload<uint32_t>(in, EC_BULK_LENGTH);
+        uint8_t* buffer = m_emu.BulkBuffer(GetPayload<uint64_t>(in, EC_BULK_HANDLE));
+        if (buffer == nullptr || length > m_emu.Opts().bulk_size) {
+            return 2;
+        }
+
+        std::lock_guard<std::mutex> lock(m_bulk_lock);
+        std::vector<uint8_t>* object = Object(id);
+        if (object == nullptr || (op == EC_BULK_OP_WRITE && id != EC_BULK_OBJ_FIRMWARE) ||
+            static_cast<uint64_t>(offset) + length > BULK_MAX_LENGTH) {
+            return 3;
+        }
+
+        uint32_t moved = 0;
+        if (op == EC_BULK_OP_READ) {
+            moved = offset < object->size() ? std::min<uint32_t>(length, static_cast<uint32_t>(object->size() - offset)) : 0;
+            memcpy(buffer, object->data() + offset, moved);
+        } else if (op == EC_BULK_OP_WRITE) {
+            object->resize(std::max<size_t>(object->size(), offset + length));
+            memcpy(object->data() + offset, buffer, length);
+            moved = length;
+        } else {
+            return 3;
+        }
+        SetPayload<uint32_t>(out, EC_BULK_MOVED, moved);
+        SetPayload<uint32_t>(out, EC_BULK_TOTAL, static_cast<uint32_t>(object->size()));
+        return 0;
+    }
+
+    std::vector<uint8_t>* Object(uint8_t id)
+    {
+        if (m_log.empty()) {
+            // 512KB of log text and 256KB of 16 byte history records
+            char line[64];
+            for (uint32_t i = 0; m_log.size() < 0x80000; i++) {
+                int n = snprintf(line, sizeof(line), "%08u ecemu log entry\n", i);
+                m_log.insert(m_log.end(), line, line + n);
+            }
+            m_log.resize(0x80000);
+            m_history.resize(0x40000);
+            for (size_t i = 0; i < m_history.size(); i += 16) {
+                uint32_t record[4] = { static_cast<uint32_t>(i / 16), 3000u + static_cast<uint32_t>(i / 16 % 300), 2500, 4800 };
+                memcpy(m_history.data() + i, record, sizeof(record));
+            }
+        }
+        switch (id) {
+        case EC_BULK_OBJ_LOG: return &m_log;
+        case EC_BULK_OBJ_HISTORY: return &m_history;
+        case EC_BULK_OBJ_FIRMWARE: return &m_firmware;
+        default: return nullptr;
+        }
+    }
+
+    Emulator& m_emu;
+    std::mutex m_bulk_lock;
+    std::vector<uint8_t> m_log;
+    std::vector<uint8_t> m_history;
+    std::vector<uint8_t> m_firmware;
+};
+
+/*
+ * Class: ThermalService
+ * ---------------------
+ * EC_SVC_THERMAL, sensor temperatures, thresholds and fan variables.
+ */
+class ThermalService : public Service {
+public:
+    explicit ThermalService(Emulator& emu) : m_emu(emu)
+    {
+        // Defaults in deci-Kelvin and RPM
+        m_vars[Key("ba17b567-c368-48d5-bc6f-a312a41583c1")] = 3130; // OnTemp
+        m_vars[Key("3a62688c-d95b-4d2d-bacc-90d7a5816bcd")] = 3230; // RampTemp
+        m_vars[Key("dcb758b1-f0fd-4ec7-b2c0-ef1e2a547b76")] = 3530; // MaxTemp
+        m_vars[Key("db261c77-934b-45e2-9742-256c62badb7a")] = 1000; // MinRpm
+        m_vars[Key("5cf839df-8be7-42b9-9ac5-3403ca2c8a6a")] = 6000; // MaxRpm
+        m_vars[Key("adf95492-0776-4ffc-84f3-b6c8b5269683")] = 2500; // CurrentRpm
+    }
+
+    const GUID& Uuid() const override { return ThermalUuid; }
+    const char* Name() const override { return "thermal"; }
+
+    uint64_t Handle(const FFA_SEND_DIRECT_REQ2_BUFFER& in, FFA_SEND_DIRECT_REQ2_BUFFER& out) override
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        uint8_t tzid = GetPayload<uint8_t>(in, EC_THM_TZID);
+
+        switch (GetPayload<uint8_t>(in, EC_PAYLOAD_CMD)) {
+        case EC_THM_GET_TMP:
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT, m_temp + tzid);
+            return 0;
+        case EC_THM_SET_THRS: {
+            // Checked on the next tick, so a sensor already outside raises right away
+            Threshold& thrs = m_thresholds[tzid];
+            thrs.low = GetPayload<uint32_t>(in, EC_THM_THRS_LOW);
+            thrs.high = GetPayload<uint32_t>(in, EC_THM_THRS_HIGH);
+            uint32_t timeout = GetPayload<uint32_t>(in, EC_THM_THRS_TIMEOUT);
+            thrs.deadline = timeout != 0 ? Now100ns() + static_cast<uint64_t>(timeout) * 10000 : 0;
+            thrs.armed = true;
+            SetPayload<uint32_t>(out, EC_THM_THRS_STATUS, 0);
+            return 0;
+        }
+        case EC_THM_GET_VAR: {
+            auto it = m_vars.find(KeyFrom(in));
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT, it == m_vars.end() ? 1 : 0);
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT + 4, it == m_vars.end() ? 0 : it->second);
+            return 0;
+        }
+        case EC_THM_SET_VAR: {
+            auto it = m_vars.find(KeyFrom(in));
+            if (it != m_vars.end()) {
+                it->second = GetPayload<uint32_t>(in, EC_THM_VAR_VALUE);
+            }
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT, it == m_vars.end() ? 1 : 0);
+            return 0;
+        }
+        case EC_THM_GET_VARS:
+        case EC_THM_SET_VARS: {
+            bool set = GetPayload<uint8_t>(in, EC_PAYLOAD_CMD) == EC_THM_SET_VARS;
+            uint8_t count = GetPayload<uint8_t>(in, EC_THM_VARS_COUNT);
+            if (count == 0 || count > (set ? EC_THM_SET_VARS_MAX : EC_THM_GET_VARS_MAX)) {
+                return 1;
+            }
+            uint32_t missing = 0;
+            for (uint8_t i = 0; i < count; i++) {
+                size_t entry = EC_THM_VARS_DATA + i * (set ? EC_THM_SET_VARS_ENTRY : EC_THM_GET_VARS_ENTRY);
+                auto it = m_vars.find(VarKey(reinterpret_cast<const char*>(in.Buffer + entry), sizeof(GUID)));
+                if (it == m_vars.end()) {
+                    missing |= 1u << i;
+                } else if (set) {
+                    it->second = GetPayload<uint32_t>(in, entry + sizeof(GUID));
+                } else {
+                    SetPayload<uint32_t>(out, EC_THM_VARS_VALUE + i * sizeof(uint32_t), it->second);
+                }
+            }
+            SetPayload<uint32_t>(out, EC_THM_VARS_MISSING, missing);
+            return 0;
+        }
+        default:
+            return 1;
+        }
+    }
+
+    // Temperature wanders around 30C, each armed sensor raises EC_NOTIFY_THERMAL once
+    void Tick() override
+    {
+        std::vector<Crossing> crossings;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            int step = static_cast<int>(m_rng() % 3) - 1;
+            m_temp = std::min<uint32_t>(std::max<uint32_t>(m_temp + step, 2982), 3132);
+
+            uint64_t now = Now100ns();
+            for (auto& entry : m_thresholds) {
+                Threshold& thrs = entry.second;
+                uint32_t temp = m_temp + entry.first;
+                uint8_t reason;
+                if (!thrs.armed) {
+                    continue;
+                } else if (temp < thrs.low) {
+                    reason = EC_THM_REASON_LOW;
+                } else if (temp > thrs.high) {
+                    reason = EC_THM_REASON_HIGH;
+                } else if (thrs.deadline != 0 && now >= thrs.deadline) {
+                    reason = EC_THM_REASON_TIMEOUT;
+                } else {
+                    continue;
+                }
+                thrs.armed = false;
+                crossings.push_back({entry.first, reason, temp});
+            }
+        }
+
+        // Raise without the lock, clients may answer with another SET_THRS
+        for (auto& crossing : crossings) {
+            uint8_t data[EC_THM_EVENT_SIZE] = {};
+            data[EC_THM_EVENT_TZID] = crossing.tzid;
+            data[EC_THM_EVENT_REASON] = crossing.reason;
+            memcpy(data + EC_THM_EVENT_TEMP, &crossing.temp, sizeof(crossing.temp));
+            m_emu.RaiseEvent(EC_NOTIFY_THERMAL, data, sizeof(data));
+            m_emu.Log(EC_LOG_LEVEL_INFO, LOG_SOURCE_THERMAL, "sensor %u reason %u temperature %u", crossing.tzid,
+                      crossing.reason, crossing.temp);
+        }
+    }
+
+private:
+    using VarKey = std::string;
+
+    struct Threshold {
+        uint32_t low = 0;
+        uint32_t high = 0;
+        uint64_t deadline = 0;  // Now100ns the timeout expires, 0 for none
+        bool armed = false;
+    };
+
+    struct Crossing {
+        uint8_t tzid;
+        uint8_t reason;
+        uint32_t temp;
+    };
+
+    // Variable GUIDs are compared as the raw 16 bytes ToUUID produces
+    static VarKey Key(const char* text)
+    {
+        unsigned int d1, d2, d3, b[8];
+        sscanf(text, "%8x-%4x-%4x-%2x%2x-%2x%2x%2x%2x%2x%2x",
+               &d1, &d2, &d3, &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &b[6], &b[7]);
+        GUID g = { d1, static_cast<uint16_t>(d2), static_cast<uint16_t>(d3), {} };
+        for (int i = 0; i < 8; i++) {
+            g.Data4[i] = static_cast<uint8_t>(b[i]);
+        }
+        return VarKey(reinterpret_cast<const char*>(&g), sizeof(g));
+    }
+
+    static VarKey KeyFrom(const FFA_SEND_DIRECT_REQ2_BUFFER& in)
+    {
+        return VarKey(reinterpret_cast<const char*>(in.Buffer + EC_THM_VAR_UUID), sizeof(GUID));
+    }
+
+    std::mutex m_lock;
+    Emulator& m_emu;
+    std::minstd_rand m_rng;
+    uint32_t m_temp = 3042;
+    std::map<uint8_t, Threshold> m_thresholds;
+    std::map<VarKey, uint32_t> m_vars;
+};
+
+/*
+ * Class: BatteryService
+ * ---------------------
+ * EC_SVC_BATTERY, static _BIX data and a slowly discharging _BST.
+ */
+class BatteryService : public Service {
+public:
+    const GUID& Uuid() const override { return BatteryUuid; }
+    const char* Name() const override { return "battery"; }
+
+    uint64_t Handle(const FFA_SEND_DIRECT_REQ2_BUFFER& in, FFA_SEND_DIRECT_REQ2_BUFFER& out) override
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        switch (GetPayload<uint8_t>(in, EC_PAYLOAD_CMD)) {
+        case EC_BAT_GET_BIX:
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT, 1);           // Power unit mA
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT + 4, 5000);    // Design capacity
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT + 8, 4800);    // Last full charge capacity
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT + 12, 11400);  // Design voltage mV
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT + 16, 42);     // Cycle count
+            return 0;
+        case EC_BAT_GET_BST:
+            if (m_remaining > 0) {
+                m_remaining--;
+            }
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT, 1);           // Discharging
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT + 4, 1200);    // Present rate
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT + 8, m_remaining);
+            SetPayload<uint32_t>(out, EC_PAYLOAD_OUT + 12, 11800);  // Present voltage
+            return 0;
+        default:
+            return 1;
+        }
+    }
+
+private:
+    std::mutex m_lock;
+    uint32_t m_remaining = 4800;
+};
+
+/*
+ * Function: Emulator::MapRing
+ * ---------------------------
+ * Creates the shared memory file, publishes the geometry header, bulk pool table and log
+ * descriptor the way UEFI does and maps both rings. The pool buffers follow the rings and the log
+ * ring follows the pool.
+ */
+bool Emulator::MapRing()
+{
+    m_geometry = ecring::Geometry::Make(static_cast<uint16_t>(m_options.slots), static_cast<uint16_t>(m_options.entry_size));
+    if (!m_geometry.Valid()) {
+        fprintf(stderr, "Invalid ring geometry slots %d entry 0x%x\n", m_options.slots, m_options.entry_size);
+        return false;
+    }
+
+    m_bulk.count = static_cast<uint16_t>(std::max(0, std::min(m_options.bulk_buffers, EC_BULK_BUFFER_MAX)));
+    m_bulk.buffer_size = m_options.bulk_size;
+    uint64_t file_size = m_geometry.region_size;
+    for (uint16_t i = 0; i < m_bulk.count; i++) {
+        m_bulk.handle[i] = 0xB000 + i;
+        m_bulk.offset[i] = EC_RING_ALIGN_UP(file_size, EC_RING_PAGE_SIZE);
+        file_size = m_bulk.offset[i] + m_bulk.buffer_size;
+    }
+    if (m_bulk.count != 0 && !m_bulk.Valid(file_size)) {
+        fprintf(stderr, "Invalid bulk pool buffers %d size 0x%x\n", m_options.bulk_buffers, m_options.bulk_size);
+        return false;
+    }
+
+    uint32_t log_offset = 0;
+    if (m_options.log_size != 0) {
+        if (m_options.log_size < EC_LOG_SIZE_MIN || m_options.log_size > EC_LOG_SIZE_MAX ||
+            (m_options.log_size & (m_options.log_size - 1)) != 0) {
+            fprintf(stderr, "Invalid log size 0x%x\n", m_options.log_size);
+            return false;
+        }
+        log_offset = static_cast<uint32_t>(EC_RING_ALIGN_UP(file_size, EC_RING_PAGE_SIZE));
+        file_size = log_offset + ecring::LogRing::AreaSize(m_options.log_size);
+    }
+
+    int fd = open(m_options.ring_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0 || ftruncate(fd, static_cast<off_t>(file_size)) != 0) {
+        perror(m_options.ring_path.c_str());
+        return false;
+    }
+
+    void* base = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+
+    m_region = static_cast<uint8_t*>(base);
+    memset(m_region, 0, m_geometry.region_size);
+    m_geometry.Write(m_region);
+    if (m_bulk.count != 0) {
+        m_bulk.Write(m_region);
+    }
+    if (m_options.log_size != 0) {
+        // Timestamps are Now100ns, the descriptor goes out once the header is ready
+        m_log = std::make_unique<ecring::LogRing>(m_region + log_offset, m_options.log_size);
+        m_log->SetFrequency(10000000);
+        ecring::LogRing::Publish(m_region, log_offset, m_options.log_size);
+    }
+    m_tx = std::make_unique<ecring::RingPage>(m_region + m_geometry.tx_offset, m_geometry);
+    m_rx = std::make_unique<ecring::RingPage>(m_region + m_geometry.rx_offset, m_geometry);
+    return true;
+}
+
+uint8_t* Emulator::BulkBuffer(uint64_t handle)
+{
+    for (uint16_t i = 0; i < m_bulk.count; i++) {
+        if (m_bulk.handle[i] == handle) {
+            return m_region + m_bulk.offset[i];
+        }
+    }
+    return nullptr;
+}
+
+bool Emulator::Start()
+{
+    m_services.push_back(std::make_unique<ManagementService>(*this));
+    m_services.push_back(std::make_unique<ThermalService>(*this));
+    m_services.push_back(std::make_unique<BatteryService>());
+
+    if (!MapRing()) {
+        return false;
+    }
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, m_options.socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(addr.sun_path);
+
+    m_listen = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listen < 0 ||
+        bind(m_listen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(m_listen, 16) != 0) {
+        perror(m_options.socket_path.c_str());
+        return false;
+    }
+
+    m_threads.emplace_back(&Emulator::AcceptThread, this);
+    m_threads.emplace_back(&Emulator::RingThread, this);
+    for (int i = 0; i < m_options.workers; i++) {
+        m_threads.emplace_back(&Emulator::WorkerThread, this);
+    }
+    m_threads.emplace_back(&Emulator::GeneratorThread, this);
+    m_threads.emplace_back(&Emulator::TickThread, this);
+
+    // -notify keeps raising the EC events in turn until stopped
+    if (m_options.notify_hz > 0) {
+        GeneratorReq_t req = {};
+        GeneratorRsp_t rsp;
+        req.rate = m_options.notify_hz;
+        req.firstevent = EC_NOTIFY_EVENT_MIN;
+        req.lastevent = EC_NOTIFY_EVENT_MAX;
+        if (!ControlGenerator(req, rsp)) {
+            fprintf(stderr, "-notify must be at most %u\n", GENERATOR_MAX_RATE);
+            return false;
+        }
+    }
+
+    printf("ecemu listening on %s, ring %s slots %u entry 0x%x\n", m_options.socket_path.c_str(),
+           m_options.ring_path.c_str(), m_geometry.slot_count, m_geometry.entry_size);
+    printf("service %dus jitter %dus notify %uHz workers %d\n", m_options.service_us, m_options.jitter_us,
+           m_options.notify_hz, m_options.workers);
+    printf("bulk pool %u buffers of 0x%x, log ring 0x%x\n", m_bulk.count, m_bulk.buffer_size, m_options.log_size);
+    Log(EC_LOG_LEVEL_INFO, LOG_SOURCE_EMULATOR, "ecemu started, fw state 0x%08x", m_options.fw_state);
+    return true;
+}
+
+static volatile sig_atomic_t g_signalled;
+
+static void OnSignal(int)
+{
+    g_signalled = 1;
+}
+
+void Emulator::Run()
+{
+    while (!m_stop && !g_signalled) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
+
+void Emulator::Stop()
+{
+    m_stop = true;
+    shutdown(m_listen, SHUT_RDWR);
+    close(m_listen);
+    {
+        std::lock_guard<std::mutex> lock(m_clients_lock);
+        for (auto& client : m_clients) {
+            shutdown(client->fd, SHUT_RDWR);
+        }
+    }
+    m_work_cv.notify_all();
+    m_ring_cv.notify_all();
+    m_gen_cv.notify_all();
+    for (auto& t : m_threads) {
+        t.join();
+    }
+    unlink(m_options.socket_path.c_str());
+}
+
+Service* Emulator::Find(const GUID& uuid)
+{
+    for (auto& service : m_services) {
+        if (service->Uuid() == uuid) {
+            return service.get();
+        }
+    }
+    return nullptr;
+}
+
+uint64_t Emulator::Dispatch(const GUID& uuid, const FFA_SEND_DIRECT_REQ2_BUFFER& in, FFA_SEND_DIRECT_REQ2_BUFFER& out)
+{
+    Service* service = Find(uuid);
+    if (service == nullptr) {
+        return 1;
+    }
+    if (in.Buffer[EC_PAYLOAD_CMD] != EC_MUX) {
+        return service->Handle(in, out);
+    }
+
+    // Run each packed command as if it arrived alone and pack the output windows back
+    uint32_t count = in.Buffer[EC_MUX_COUNT];
+    uint32_t rd = EC_MUX_DATA;
+    uint32_t wr = EC_MUX_DATA;
+    for (uint32_t i = 0; i < count; i++) {
+        if (rd + EC_MUX_HEADER_SIZE > EC_FFA_PAYLOAD_SIZE) {
+            return 1;
+        }
+        uint32_t inlen = in.Buffer[rd];
+        uint32_t outoff = in.Buffer[rd + 1];
+        uint32_t outlen = in.Buffer[rd + 2];
+        rd += EC_MUX_HEADER_SIZE;
+        if (inlen == 0 || rd + inlen > EC_FFA_PAYLOAD_SIZE || outoff + outlen > EC_FFA_PAYLOAD_SIZE ||
+            wr + 1 + outlen > EC_FFA_PAYLOAD_SIZE) {
+            return 1;
+        }
+
+        FFA_SEND_DIRECT_REQ2_BUFFER sub_in = {};
+        FFA_SEND_DIRECT_REQ2_BUFFER sub_out = {};
+        memcpy(sub_in.Buffer, in.Buffer + rd, inlen);
+        rd += inlen;
+        if (sub_in.Buffer[EC_PAYLOAD_CMD] == EC_MUX) {
+            return 1;
+        }
+
+        out.Buffer[wr++] = static_cast<uint8_t>(service->Handle(sub_in, sub_out));
+        memcpy(out.Buffer + wr, sub_out.Buffer + outoff, outlen);
+        wr += outlen;
+    }
+    out.Buffer[EC_PAYLOAD_CMD] = EC_MUX;
+    out.Buffer[EC_MUX_COUNT] = static_cast<uint8_t>(count);
+    return 0;
+}
+
+void Emulator::ServiceTime()
+{
+    thread_local std::minstd_rand rng(std::random_device{}());
+    int us = m_options.service_us;
+    if (m_options.jitter_us > 0) {
+        us += static_cast<int>(rng() % static_cast<unsigned>(m_options.jitter_us + 1));
+    }
+    if (us > 0) {
+        Delay(std::chrono::microseconds(us));
+    }
+}
+
+/*
+ * Function: Emulator::Broadcast
+ * -----------------------------
+ * Sends a notification to every connected client as the SPMC would deliver an FF-A notification.
+ * Generated events also carry their stamp.
+ */
+void Emulator::Broadcast(const GUID& uuid, uint32_t notify_id, const GeneratorStamp_t* stamp)
+{
+    Frame frame = {};
+    frame.type = FRAME_NOTIFY;
+    frame.notify_id = notify_id;
+    frame.params.ServiceUuid = uuid;
+    if (stamp != nullptr) {
+        memcpy(frame.params.OutputBuffer.Buffer, stamp, sizeof(*stamp));
+    }
+
+    std::lock_guard<std::mutex> lock(m_clients_lock);
+    for (auto& client : m_clients) {
+        std::lock_guard<std::mutex> write(client->write_lock);
+        WriteAll(client->fd, &frame, sizeof(frame));
+    }
+}
+
+/*
+ * Function: Emulator::RaiseEvent
+ * ------------------------------
+ * Publishes an EC event record in the geometry page and then raises the event notification, so
+ * the driver can attach the event data to the notification it delivers.
+ */
+void Emulator::RaiseEvent(uint32_t notify_id, const void* data, size_t length, const GeneratorStamp_t* stamp)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_event_lock);
+        ecring::EventRecord(m_region).Write(notify_id, data, length);
+    }
+    Broadcast(ManagementUuid, notify_id, stamp);
+}
+
+/*
+ * Function: Emulator::Log
+ * -----------------------
+ * Appends a record to the log stream ring, if there is one, and rings the log doorbell when a
+ * reader armed it.
+ */
+void Emulator::Log(uint8_t level, uint16_t source, const char* format, ...)
+{
+    if (!m_log) {
+        return;
+    }
+
+    char text[EC_LOG_TEXT_MAX + 1];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0) {
+        return;
+    }
+
+    bool armed;
+    {
+        std::lock_guard<std::mutex> lock(m_log_lock);
+        armed = m_log->Append(level, source, Now100ns(), text, std::min<size_t>(length, EC_LOG_TEXT_MAX));
+    }
+    if (armed) {
+        Broadcast(ManagementUuid, EC_NOTIFY_LOG_DOORBELL);
+    }
+}
+
+void Emulator::KickRing()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_ring_lock);
+        m_ring_kick = true;
+    }
+    m_ring_cv.notify_one();
+}
+
+void Emulator::AcceptThread()
+{
+    while (!m_stop) {
+        int fd = accept(m_listen, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+
+        auto client = std::make_shared<Client>();
+        client->fd = fd;
+        {
+            std::lock_guard<std::mutex> lock(m_clients_lock);
+            m_clients.push_back(client);
+        }
+        std::thread(&Emulator::ClientThread, this, client).detach();
+    }
+}
+
+void Emulator::ClientThread(std::shared_ptr<Client> client)
+{
+    Frame frame;
+    while (!m_stop && ReadAll(client->fd, &frame, sizeof(frame))) {
+        // Generator control is answered straight away, it does not go to the EC services
+        if (frame.type == FRAME_GENERATOR) {
+            GeneratorReq_t req;
+            GeneratorRsp_t rsp;
+            memcpy(&req, frame.params.InputBuffer.Buffer, sizeof(req));
+            frame.ffa_status = ControlGenerator(req, rsp) ? 0 : 1;
+            memcpy(frame.params.OutputBuffer.Buffer, &rsp, sizeof(rsp));
+            std::lock_guard<std::mutex> write(client->write_lock);
+            WriteAll(client->fd, &frame, sizeof(frame));
+            continue;
+        }
+        if (frame.type != FRAME_DIRECT_REQ) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_work_lock);
+            m_work.push_back({ client, frame });
+        }
+        m_work_cv.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(m_clients_lock);
+    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+        if (*it == client) {
+            m_clients.erase(it);
+            break;
+        }
+    }
+    close(client->fd);
+}
+
+void Emulator::WorkerThread()
+{
+    while (!m_stop) {
+        Work work;
+        {
+            std::unique_lock<std::mutex> lock(m_work_lock);
+            m_work_cv.wait(lock, [&] { return m_stop || !m_work.empty(); });
+            if (m_stop) {
+                return;
+            }
+            work = std::move(m_work.front());
+            m_work.pop_front();
+        }
+
+        ServiceTime();
+
+        Frame& frame = work.frame;
+        memset(&frame.params.OutputBuffer, 0, sizeof(frame.params.OutputBuffer));
+        frame.ffa_status = Dispatch(frame.params.ServiceUuid, frame.params.InputBuffer, frame.params.OutputBuffer);
+        frame.type = FRAME_DIRECT_RSP;
+
+        std::lock_guard<std::mutex> write(work.client->write_lock);
+        WriteAll(work.client->fd, &frame, sizeof(frame));
+    }
+}
+
+/*
+ * Function: Emulator::PostResponse
+ * --------------------------------
+ * Posts a response on the RX ring, one fragment per free slot, ringing the RX doorbell after
+ * each fragment so the host can drain the ring while the rest is written.
+ */
+bool Emulator::PostResponse(uint16_t seq, const std::vector<uint8_t>& data)
+{
+    size_t slot = 0;
+    bool ok = true;
+
+    ecring::Fragment(seq, data.data(), data.size(), m_rx->EntrySize(),
+        [&](uint64_t header, const uint8_t* fragment, size_t length) {
+            while (ok) {
+                if (m_rx->Header(slot) == 0) {
+                    memcpy(m_rx->Entry(slot), fragment, length);
+                    m_rx->SetHeader(slot, header);
+                    Broadcast(ManagementUuid, EC_NOTIFY_RX_DOORBELL);
+                    slot = (slot + 1) % m_rx->SlotCount();
+                    return;
+                }
+                slot = (slot + 1) % m_rx->SlotCount();
+                if (slot == 0) {
+                    if (m_stop) {
+                        ok = false;
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+        });
+
+    return ok;
+}
+
+/*
+ * Function: Emulator::RingThread
+ * ------------------------------
+ * EC end of the TX ring. Woken by EC_ASYNC or every millisecond, takes each valid TX entry,
+ * releases the slot with a TX doorbell, runs the request and posts the response on the RX ring.
+ */
+void Emulator::RingThread()
+{
+    std::vector<uint8_t> entry(m_tx->EntrySize());
+
+    while (!m_stop) {
+        {
+            std::unique_lock<std::mutex> lock(m_ring_lock);
+            m_ring_cv.wait_for(lock, std::chrono::milliseconds(1), [&] { return m_stop || m_ring_kick; });
+            m_ring_kick = false;
+        }
+
+        for (size_t slot = 0; slot < m_tx->SlotCount() && !m_stop; slot++) {
+            uint64_t header = m_tx->Header(slot);
+            if ((header & EC_SLOT_VALID) == 0) {
+                continue;
+            }
+
+            ecring::SlotHeader h = ecring::SlotHeader::Decode(header);
+            size_t length = h.length < entry.size() ? h.length : entry.size();
+            memcpy(entry.data(), m_tx->Entry(slot), length);
+            m_tx->SetHeader(slot, 0);
+            Broadcast(ManagementUuid, EC_NOTIFY_TX_DOORBELL);
+
+            // Entries are the ACPI FFixedHw buffer image, entries queued by ASYQ do not fill in
+            // the UUID so a null UUID goes to the management service
+            GUID uuid = {};
+            FFA_SEND_DIRECT_REQ2_BUFFER in = {};
+            FFA_SEND_DIRECT_REQ2_BUFFER out = {};
+            if (length >= 2 + sizeof(GUID)) {
+                memcpy(&uuid, entry.data() + 2, sizeof(GUID));
+            }
+            if (length > EC_FFA_PAYLOAD_OFFSET) {
+                size_t payload = length - EC_FFA_PAYLOAD_OFFSET;
+                memcpy(in.Buffer, entry.data() + EC_FFA_PAYLOAD_OFFSET, payload < sizeof(in.Buffer) ? payload : sizeof(in.Buffer));
+            }
+            if (uuid == GUID{}) {
+                uuid = ManagementUuid;
+            }
+
+            ServiceTime();
+            Dispatch(uuid, in, out);
+
+            // Response is the output data padded with a pattern to the configured size
+            std::vector<uint8_t> rsp(m_options.async_bytes > 0 ? m_options.async_bytes : 1);
+            for (size_t i = 0; i < rsp.size(); i++) {
+                rsp[i] = i < 8 ? out.Buffer[EC_PAYLOAD_OUT + i] : static_cast<uint8_t>(i);
+            }
+            PostResponse(h.seq, rsp);
+        }
+    }
+}
+
+// Same limit as the driver so a run that falls behind catches up over several ticks
+#define GENERATOR_MAX_PER_TICK  4096
+
+/*
+ * Function: GeneratorDue
+ * ----------------------
+ * Number of events that should have been raised after elapsed 100ns units, only counting time
+ * spent in the on part of each burst cycle. Matches the driver's generator.
+ */
+static uint64_t GeneratorDue(const GeneratorReq_t& config, uint64_t elapsed)
+{
+    uint64_t on = static_cast<uint64_t>(config.burston) * 10000;
+    uint64_t off = static_cast<uint64_t>(config.burstoff) * 10000;
+    uint64_t active = elapsed;
+
+    if (on != 0) {
+        active = (elapsed / (on + off)) * on + std::min(elapsed % (on + off), on);
+    }
+    return active * config.rate / 10000000;
+}
+
+/*
+ * Function: GeneratorPick
+ * -----------------------
+ * Picks the notify ID of the next event according to the configured distribution.
+ */
+static uint32_t GeneratorPick(const GeneratorReq_t& config, uint32_t& next, uint32_t& random)
+{
+    auto xorshift = [&random]() {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        return random;
+    };
+    uint32_t first = config.firstevent;
+    uint32_t span = static_cast<uint32_t>(config.lastevent) - first + 1;
+
+    switch (config.distribution) {
+    case GENERATOR_DIST_UNIFORM:
+        return first + xorshift() % span;
+    case GENERATOR_DIST_HOT:
+        return (xorshift() & 1) ? first : first + xorshift() % span;
+    default: {
+        uint32_t value = first + next;
+        next = (next + 1) % span;
+        return value;
+    }
+    }
+}
+
+/*
+ * Function: Emulator::ControlGenerator
+ * ------------------------------------
+ * Starts a run if rate is not 0, stops the current run if it is 0 and leaves it alone for
+ * GENERATOR_RATE_QUERY, as IOCTL_GENERATOR does. Returns false if the request is invalid.
+ */
+bool Emulator::ControlGenerator(const GeneratorReq_t& req, GeneratorRsp_t& rsp)
+{
+    bool start = req.rate != 0 && req.rate != GENERATOR_RATE_QUERY;
+    std::lock_guard<std::mutex> lock(m_gen_lock);
+
+    if (start && (req.rate > GENERATOR_MAX_RATE || req.firstevent > req.lastevent ||
+                  req.distribution > GENERATOR_DIST_HOT || (req.burstoff != 0 && req.burston == 0))) {
+        rsp = {};
+        return false;
+    }
+
+    if (start) {
+        m_gen_config = req;
+        m_gen_running = true;
+        m_gen_run++;
+        m_gen_generated = 0;
+        m_gen_next = 0;
+        m_gen_start = Now100ns();
+        m_gen_random = req.seed != 0 ? req.seed : static_cast<uint32_t>(m_gen_start) | 1;
+        m_gen_elapsed = 0;
+        m_gen_cv.notify_all();
+        Log(EC_LOG_LEVEL_INFO, LOG_SOURCE_GENERATOR, "generator run %u rate %uHz events 0x%x-0x%x duration %ums",
+            m_gen_run, req.rate, req.firstevent, req.lastevent, req.duration);
+    } else if (req.rate == 0 && m_gen_running) {
+        m_gen_running = false;
+        m_gen_elapsed = Now100ns() - m_gen_start;
+    }
+
+    rsp.running = m_gen_running;
+    rsp.run = m_gen_run;
+    rsp.generated = m_gen_generated;
+    rsp.start = m_gen_start;
+    rsp.elapsed = m_gen_running ? Now100ns() - m_gen_start : m_gen_elapsed;
+    return true;
+}
+
+/*
+ * Function: Emulator::GeneratorThread
+ * -----------------------------------
+ * Ticks every millisecond while a run is active and raises every event that is due, each with
+ * a GeneratorStamp_t as both event data and notification stamp.
+ */
+void Emulator::GeneratorThread()
+{
+    std::vector<std::pair<uint32_t, GeneratorStamp_t>> events;
+    std::unique_lock<std::mutex> lock(m_gen_lock);
+
+    while (!m_stop) {
+        if (!m_gen_running) {
+            m_gen_cv.wait_for(lock, std::chrono::milliseconds(100));
+            continue;
+        }
+
+        uint64_t elapsed = Now100ns() - m_gen_start;
+        uint64_t end = static_cast<uint64_t>(m_gen_config.duration) * 10000;
+        bool finished = end != 0 && elapsed >= end;
+        m_gen_elapsed = finished ? end : elapsed;
+
+        uint64_t due = GeneratorDue(m_gen_config, m_gen_elapsed);
+        events.clear();
+        while (m_gen_generated < due && events.size() < GENERATOR_MAX_PER_TICK) {
+            GeneratorStamp_t stamp = {};
+            stamp.run = m_gen_run;
+            stamp.sequence = m_gen_generated++;
+            events.emplace_back(GeneratorPick(m_gen_config, m_gen_next, m_gen_random), stamp);
+        }
+        if (finished) {
+            m_gen_running = false;
+            printf("generator run %u done, %llu events\n", m_gen_run,
+                   static_cast<unsigned long long>(m_gen_generated));
+            Log(EC_LOG_LEVEL_INFO, LOG_SOURCE_GENERATOR, "generator run %u done, %llu events", m_gen_run,
+                static_cast<unsigned long long>(m_gen_generated));
+        }
+
+        // Raise without the lock so control requests are not held up by slow clients
+        lock.unlock();
+        for (auto& event : events) {
+            event.second.generated = Now100ns();
+            RaiseEvent(event.first, &event.second, sizeof(event.second), &event.second);
+            Log(EC_LOG_LEVEL_VERBOSE, LOG_SOURCE_GENERATOR, "event 0x%x run %u sequence %llu", event.first,
+                event.second.run, static_cast<unsigned long long>(event.second.sequence));
+        }
+        lock.lock();
+
+        if (m_gen_running) {
+            m_gen_cv.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+}
+
+/*
+ * Function: Emulator::TickThread
+ * ------------------------------
+ * Ticks every service each SERVICE_TICK_MS.
+ */
+void Emulator::TickThread()
+{
+    while (!m_stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(SERVICE_TICK_MS));
+        for (auto& service : m_services) {
+            service->Tick();
+        }
+    }
+}
+
+static void Usage()
+{
+    printf("Usage: ecemu [-socket path] [-ring path] [-slots n] [-entry bytes] [-service us] [-jitter us]\n"
+           "             [-notify hz] [-workers n] [-async-bytes n] [-bulk-buffers n] [-bulk-size bytes]\n"
+           "             [-log-size bytes]\n");
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            Usage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "-socket") {
+            options.socket_path = value;
+        } else if (arg == "-ring") {
+            options.ring_path = value;
+        } else if (arg == "-slots") {
+            options.slots = atoi(value);
+        } else if (arg == "-entry") {
+            options.entry_size = static_cast<int>(strtol(value, nullptr, 0));
+        } else if (arg == "-service") {
+            options.service_us = atoi(value);
+        } else if (arg == "-jitter") {
+            options.jitter_us = atoi(value);
+        } else if (arg == "-notify") {
+            options.notify_hz = static_cast<uint32_t>(strtoul(value, nullptr, 0));
+        } else if (arg == "-workers") {
+            options.workers = atoi(value) > 0 ? atoi(value) : 1;
+        } else if (arg == "-async-bytes") {
+            options.async_bytes = atoi(value);
+        } else if (arg == "-bulk-buffers") {
+            options.bulk_buffers = atoi(value);
+        } else if (arg == "-bulk-size") {
+            options.bulk_size = static_cast<uint32_t>(strtoul(value, nullptr, 0));
+        } else if (arg == "-log-size") {
+            options.log_size = static_cast<uint32_t>(strtoul(value, nullptr, 0));
+        } else {
+            Usage();
+            return 1;
+        }
+    }
+
+    Emulator emulator(options);
+    if (!emulator.Start()) {
+        return 1;
+    }
+
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+    emulator.Run();
+    emulator.Stop();
+    return 0;
+}
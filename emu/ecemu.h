@@ -0,0 +1,153 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Wire protocol between the EC service emulator (ecemu) and host side clients (ecload).
+//
+// Direct requests stand in for FFA_MSG_SEND_DIRECT_REQ2 and carry the same parameter block the
+// driver passes to SendDirectReq2. Notifications stand in for FF-A notifications and carry the
+// service UUID and notify ID that _NFY would receive. Frames are fixed size over a Unix stream
+// socket, the shared memory rings live in a file both sides mmap.
+//
+// Generator frames control the synthetic event generator with the GeneratorReq_t and
+// GeneratorRsp_t of IOCTL_GENERATOR, and notifications it raises carry a GeneratorStamp_t. The
+// emulator stamps with steady_clock in 100ns units, see Now100ns.
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "ffashim.h"
+#include "../inc/ecsvc.h"
+#include "../inc/ecring.h"
+#include "../inc/ectest.h"
+
+#define ECEMU_DEFAULT_SOCKET    "/tmp/ecemu.sock"
+#define ECEMU_DEFAULT_RING      "/dev/shm/ecemu.ring"
+
+namespace ecemu {
+
+enum FrameType : uint32_t {
+    FRAME_DIRECT_REQ = 1,   // Client to EC, params.InputBuffer holds x4-x17
+    FRAME_DIRECT_RSP = 2,   // EC to client, params.OutputBuffer holds x4-x17
+    FRAME_NOTIFY = 3,       // EC to client, params.ServiceUuid and notify_id, params.OutputBuffer
+                            // holds a GeneratorStamp_t for generated events
+    FRAME_GENERATOR = 4,    // Client to EC GeneratorReq_t in params.InputBuffer, EC to client
+                            // GeneratorRsp_t in params.OutputBuffer
+};
+
+// Source field of the records the emulator appends to the log stream ring
+enum LogSource : uint16_t {
+    LOG_SOURCE_EMULATOR = 0,
+    LOG_SOURCE_MANAGEMENT = 1,
+    LOG_SOURCE_GENERATOR = 2,  // Run start and end, one VERBOSE record per generated event
+    LOG_SOURCE_THERMAL = 3,    // Threshold events
+};
+
+struct Frame {
+    uint32_t type;
+    uint32_t notify_id;
+    uint64_t tag;           // Echoed in the response so clients can keep several requests in flight
+    uint64_t ffa_status;    // x0 of the response, 0 on success
+    FFA_MSG_SEND_DIRECT_REQ2_PARAMETERS params;
+};
+
+// Extra level so the UUID macros expand to separate DEFINE_GUID arguments
+#define ECEMU_DEFINE_GUID(name, ...) DEFINE_GUID(name, __VA_ARGS__)
+
+ECEMU_DEFINE_GUID(ManagementUuid, EC_SVC_MANAGEMENT_UUID);
+ECEMU_DEFINE_GUID(ThermalUuid, EC_SVC_THERMAL_UUID);
+ECEMU_DEFINE_GUID(BatteryUuid, EC_SVC_BATTERY_UUID);
+
+// Little endian accessors for payload bytes of x4-x17
+template <typename T>
+inline T GetPayload(const FFA_SEND_DIRECT_REQ2_BUFFER& buffer, size_t offset)
+{
+    T value{};
+    if (offset + sizeof(T) <= sizeof(buffer.Buffer)) {
+        memcpy(&value, buffer.Buffer + offset, sizeof(T));
+    }
+    return value;
+}
+
+template <typename T>
+inline void SetPayload(FFA_SEND_DIRECT_REQ2_BUFFER& buffer, size_t offset, T value)
+{
+    if (offset + sizeof(T) <= sizeof(buffer.Buffer)) {
+        memcpy(buffer.Buffer + offset, &value, sizeof(T));
+    }
+}
+
+// Read or write exactly len bytes, returns false if the peer went away
+inline bool ReadAll(int fd, void* data, size_t len)
+{
+    auto p = static_cast<uint8_t*>(data);
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline bool WriteAll(int fd, const void* data, size_t len)
+{
+    auto p = static_cast<const uint8_t*>(data);
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline uint64_t Now100ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count()) / 100;
+}
+
+// Sleep for short service times is too coarse so spin below 200us
+inline void Delay(std::chrono::microseconds us)
+{
+    auto deadline = std::chrono::steady_clock::now() + us;
+    if (us > std::chrono::microseconds(200)) {
+        std::this_thread::sleep_until(deadline);
+        return;
+    }
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace ecemu
@@ -0,0 +1,1095 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Load generator for ecemu. Plays the host side the way ectest.asl and the KMDF driver do:
+// direct mode sends FFA_MSG_SEND_DIRECT_REQ2 requests and waits for each response, async mode
+// queues an entry on the TX ring, kicks the EC with EC_ASYNC and waits for the RX doorbell to
+// reassemble the response. Prints throughput and latency percentiles. Notify mode starts a run
+// of the emulator's event generator and reports loss and delivery latency of the stamped events.
+// With -batch, direct mode packs that many copies of the command into one EC_MUX request the way
+// the driver's IOCTL_FFA_MUX does and reports commands per second next to requests per second.
+// Bulk mode reads an EC object through the pre-shared buffer pool like IOCTL_BULK_TRANSFER, each
+// thread on its own pool buffer, and reports MB/s. Log mode follows the EC log stream ring the way
+// IOCTL_LOG_READ does while a generator run logs every event, waiting on the armed log doorbell
+// when caught up, and reports records missed, bytes lost and the latency from EC timestamp to
+// reader. Thermal mode follows a sensor the way SubscribeTemperature does, arming thresholds
+// around the last reported temperature, and reports how many requests that took. Replay mode
+// sends the FF-A commands and notifications of a session recorded by eclib again.
+//
+// Build:
+//   g++ -std=c++17 -O2 -pthread -Wno-unknown-pragmas -o ecload ecload.cpp
+//
+// Usage:
+//   ecload [-socket path] [-ring path] [-mode direct|async] [-cmd fw|tmp|var|fan|bst] [-threads n] [-count n]
+//          [-batch n]
+//   ecload -mode bulk [-object log|history|fw] [-bytes n] [-threads n] [-count n]
+//   ecload -mode notify [-rate hz] [-duration ms] [-events first:last] [-dist rr|uniform|hot] [-burst on:off]
+//   ecload -mode log [-rate hz] [-duration ms]
+//   ecload -mode thermal [-duration ms] [-low dK] [-high dK] [-hysteresis dK]
+//   ecload -mode replay -file recording [-speed percent]
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "ecemu.h"
+#include "../inc/ecrecord.h"
+
+using namespace ecemu;
+using Clock = std::chrono::steady_clock;
+
+/*
+ * Class: Connection
+ * -----------------
+ * Client end of the emulator socket. A reader thread matches responses to requests by tag and
+ * counts notifications, waking anyone waiting on a doorbell. Stamped notifications from the
+ * generator are gathered per run.
+ */
+class Connection {
+public:
+    bool Open(const std::string& path)
+    {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_fd < 0 || connect(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            perror(path.c_str());
+            return false;
+        }
+        m_reader = std::thread(&Connection::Reader, this);
+        return true;
+    }
+
+    void Close()
+    {
+        shutdown(m_fd, SHUT_RDWR);
+        if (m_reader.joinable()) {
+            m_reader.join();
+        }
+        close(m_fd);
+    }
+
+    // Synchronous FFA_MSG_SEND_DIRECT_REQ2, returns the x0 status
+    uint64_t SendDirectReq2(const GUID& uuid, const FFA_SEND_DIRECT_REQ2_BUFFER& in, FFA_SEND_DIRECT_REQ2_BUFFER& out)
+    {
+        Frame frame = {};
+        frame.type = FRAME_DIRECT_REQ;
+        frame.params.Version = FFA_MSG_SEND_DIRECT_REQ2_PARAMETERS_VERSION_V1;
+        frame.params.ServiceUuid = uuid;
+        frame.params.InputBuffer = in;
+        return Transact(frame, out);
+    }
+
+    // Starts, stops or queries the generator like IOCTL_GENERATOR, returns false on failure
+    bool ControlGenerator(const GeneratorReq_t& req, GeneratorRsp_t& rsp)
+    {
+        Frame frame = {};
+        FFA_SEND_DIRECT_REQ2_BUFFER out = {};
+        frame.type = FRAME_GENERATOR;
+        memcpy(frame.params.InputBuffer.Buffer, &req, sizeof(req));
+        if (Transact(frame, out) != 0) {
+            return false;
+        }
+        memcpy(&rsp, out.Buffer, sizeof(rsp));
+        return true;
+    }
+
+    // Stamped notifications of the latest run seen
+    struct GeneratorStats {
+        uint32_t run = 0;
+        uint64_t received = 0;
+        uint64_t reordered = 0;     // Sequence lower than one already received
+        uint64_t next = 0;          // Highest sequence received + 1
+        std::vector<double> latency;// us from stamp to reader
+    };
+
+    GeneratorStats Generated()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_generated;
+    }
+
+    // Wait for the next doorbell or the timeout, whichever comes first
+    void WaitDoorbell(uint64_t seen, std::chrono::microseconds timeout, uint32_t id = EC_NOTIFY_RX_DOORBELL)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_cv.wait_for(lock, timeout, [&] { return m_closed || m_notify[id] != seen; });
+    }
+
+    uint64_t Notifications(uint32_t id)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_notify[id];
+    }
+
+    std::map<uint32_t, uint64_t> AllNotifications()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_notify;
+    }
+
+private:
+    // Sends a request frame and waits for the response with the same tag, returns the x0 status
+    uint64_t Transact(Frame& frame, FFA_SEND_DIRECT_REQ2_BUFFER& out)
+    {
+        frame.tag = ++m_tag;
+
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_pending[frame.tag] = nullptr;
+        {
+            std::lock_guard<std::mutex> write(m_write_lock);
+            if (!WriteAll(m_fd, &frame, sizeof(frame))) {
+                m_pending.erase(frame.tag);
+                return 1;
+            }
+        }
+        m_cv.wait(lock, [&] { return m_closed || m_pending[frame.tag] != nullptr; });
+        if (m_pending[frame.tag] == nullptr) {
+            return 1;
+        }
+
+        Frame rsp = *m_pending[frame.tag];
+        m_pending.erase(frame.tag);
+        out = rsp.params.OutputBuffer;
+        return rsp.ffa_status;
+    }
+
+    void Stamped(const GeneratorStamp_t& stamp)
+    {
+        if (stamp.run != m_generated.run) {
+            m_generated = GeneratorStats();
+            m_generated.run = stamp.run;
+        }
+        m_generated.received++;
+        if (stamp.sequence < m_generated.next) {
+            m_generated.reordered++;
+        } else {
+            m_generated.next = stamp.sequence + 1;
+        }
+        uint64_t now = Now100ns();
+        m_generated.latency.push_back(now > stamp.generated ? (now - stamp.generated) / 10.0 : 0);
+    }
+
+    void Reader()
+    {
+        Frame frame;
+        while (ReadAll(m_fd, &frame, sizeof(frame))) {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (frame.type == FRAME_DIRECT_RSP || frame.type == FRAME_GENERATOR) {
+                auto it = m_pending.find(frame.tag);
+                if (it != m_pending.end()) {
+                    it->second = std::make_shared<Frame>(frame);
+                }
+            } else if (frame.type == FRAME_NOTIFY) {
+                GeneratorStamp_t stamp;
+                memcpy(&stamp, frame.params.OutputBuffer.Buffer, sizeof(stamp));
+                m_notify[frame.notify_id]++;
+                if (stamp.run != 0) {
+                    Stamped(stamp);
+                }
+            }
+            m_cv.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_closed = true;
+        m_cv.notify_all();
+    }
+
+    int m_fd = -1;
+    std::thread m_reader;
+    std::atomic<uint64_t> m_tag{0};
+    std::mutex m_write_lock;
+    std::mutex m_lock;
+    std::condition_variable m_cv;
+    std::map<uint64_t, std::shared_ptr<Frame>> m_pending;
+    std::map<uint32_t, uint64_t> m_notify;
+    GeneratorStats m_generated;
+    bool m_closed = false;
+};
+
+/*
+ * Class: HostRing
+ * ---------------
+ * Host end of the shared memory rings, mirrors QTXB and the driver's RX reassembly.
+ */
+class HostRing {
+public:
+    bool Open(const std::string& path)
+    {
+        int fd = open(path.c_str(), O_RDWR);
+        struct stat st = {};
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            perror(path.c_str());
+            return false;
+        }
+
+        void* base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            perror("mmap");
+            return false;
+        }
+
+        auto region = static_cast<uint8_t*>(base);
+        if (!m_geometry.Read(region) || m_geometry.region_size > static_cast<uint64_t>(st.st_size)) {
+            fprintf(stderr, "No valid ring geometry in %s\n", path.c_str());
+            return false;
+        }
+
+        m_tx = std::make_unique<ecring::RingPage>(region + m_geometry.tx_offset, m_geometry);
+        m_rx = std::make_unique<ecring::RingPage>(region + m_geometry.rx_offset, m_geometry);
+        m_region = region;
+        m_bulk.Read(region, static_cast<uint64_t>(st.st_size));
+        uint32_t log_offset = 0;
+        uint32_t log_size = ecring::LogRing::Find(region, static_cast<uint64_t>(st.st_size), log_offset);
+        if (log_size != 0) {
+            m_log = std::make_unique<ecring::LogRing>(region + log_offset, log_size);
+        }
+        return true;
+    }
+
+    // Queue an ACPI buffer image on the TX ring, returns the sequence or 0 if the ring is full
+    uint16_t Queue(const uint8_t* data, size_t length)
+    {
+        std::lock_guard<std::mutex> lock(m_tx_lock);
+        for (size_t slot = 0; slot < m_tx->SlotCount(); slot++) {
+            if (m_tx->Header(slot) != 0) {
+                continue;
+            }
+
+            uint16_t seq = m_seq++;
+            if (m_seq == 0) {
+                m_seq = 1;
+            }
+
+            ecring::SlotHeader h;
+            h.seq = seq;
+            h.length = static_cast<uint16_t>(length);
+            h.valid = true;
+            memcpy(m_tx->Entry(slot), data, length);
+            m_tx->SetHeader(slot, h.Encode());
+            return seq;
+        }
+        return 0;
+    }
+
+    // Collect whatever fragments of the reassembler's sequence are on the RX ring
+    ecring::Reassembler::Result Collect(ecring::Reassembler& reassembler)
+    {
+        std::lock_guard<std::mutex> lock(m_rx_lock);
+        for (;;) {
+            bool found = false;
+            for (size_t slot = 0; slot < m_rx->SlotCount(); slot++) {
+                uint64_t header = m_rx->Header(slot);
+                if (!reassembler.Wants(header)) {
+                    continue;
+                }
+
+                found = true;
+                auto result = reassembler.Push(header, m_rx->Entry(slot));
+                m_rx->SetHeader(slot, 0);
+                if (result != ecring::Reassembler::Result::NeedMore) {
+                    return result;
+                }
+            }
+            if (!found) {
+                return ecring::Reassembler::Result::NeedMore;
+            }
+        }
+    }
+
+    const ecring::Geometry& Geometry() const { return m_geometry; }
+    const ecring::BulkPool& Bulk() const { return m_bulk; }
+    uint8_t* BulkBuffer(size_t index) const { return m_region + m_bulk.offset[index]; }
+    ecring::LogRing* Log() const { return m_log.get(); }
+
+    // EC event record of the last event raised
+    bool Event(uint32_t& id, std::vector<uint8_t>& data) const
+    {
+        return ecring::EventRecord(m_region).Read(id, data);
+    }
+
+private:
+    ecring::Geometry m_geometry;
+    ecring::BulkPool m_bulk;
+    std::unique_ptr<ecring::LogRing> m_log;
+    uint8_t* m_region = nullptr;
+    std::unique_ptr<ecring::RingPage> m_tx;
+    std::unique_ptr<ecring::RingPage> m_rx;
+    std::mutex m_tx_lock;
+    std::mutex m_rx_lock;
+    uint16_t m_seq = 1;
+};
+
+struct Options {
+    std::string socket_path = ECEMU_DEFAULT_SOCKET;
+    std::string ring_path = ECEMU_DEFAULT_RING;
+    std::string mode = "direct";
+    std::string cmd = "tmp";
+    int threads = 1;
+    int count = 1000;
+    int batch = 1;
+    std::string object = "log";
+    uint32_t bytes = 0x40000;
+    GeneratorReq_t generator = { 10000, 1000, 0, 0, EC_NOTIFY_EVENT_MIN, EC_NOTIFY_EVENT_MAX, GENERATOR_DIST_ROUND_ROBIN, 0, 0 };
+    uint32_t low = 3037;
+    uint32_t high = 3047;
+    uint32_t hysteresis = 3;
+    std::string file;
+    uint32_t speed = 100;       // Percent of the recorded pace, 0 untimed
+};
+
+/*
+ * Function: BuildCommand
+ * ----------------------
+ * Fills in the payload the ASL sends for the selected command, its service and the number of
+ * payload bytes that matter.
+ */
+static bool BuildCommand(const std::string& cmd, FFA_SEND_DIRECT_REQ2_BUFFER& in, const GUID*& uuid, uint8_t& inlen)
+{
+    uuid = &ManagementUuid;
+    inlen = EC_THM_TZID + 1;
+
+    if (cmd == "fw") {
+        SetPayload<uint8_t>(in, EC_PAYLOAD_CMD, EC_CAP_GET_FW_STATE);
+    } else if (cmd == "tmp") {
+        uuid = &ThermalUuid;
+        SetPayload<uint8_t>(in, EC_PAYLOAD_CMD, EC_THM_GET_TMP);
+        SetPayload<uint8_t>(in, EC_THM_TZID, 2);
+    } else if (cmd == "var") {
+        static const GUID MaxRpm = { EC_THM_VAR_FAN_MAX_RPM_UUID };
+        uuid = &ThermalUuid;
+        SetPayload<uint8_t>(in, EC_PAYLOAD_CMD, EC_THM_GET_VAR);
+        SetPayload<uint8_t>(in, EC_THM_TZID, 1);
+        SetPayload<uint16_t>(in, EC_THM_VAR_LENGTH, 4);
+        memcpy(in.Buffer + EC_THM_VAR_UUID, &MaxRpm, sizeof(MaxRpm));
+        inlen = EC_THM_VAR_UUID + sizeof(MaxRpm);
+    } else if (cmd == "fan") {
+        // Full fan state in one request, what six "var" requests would read
+        static const GUID Fan[] = {
+            { EC_THM_VAR_FAN_ON_TEMP_UUID }, { EC_THM_VAR_FAN_RAMP_TEMP_UUID }, { EC_THM_VAR_FAN_MAX_TEMP_UUID },
+            { EC_THM_VAR_FAN_MIN_RPM_UUID }, { EC_THM_VAR_FAN_MAX_RPM_UUID }, { EC_THM_VAR_FAN_CURRENT_RPM_UUID },
+        };
+        uuid = &ThermalUuid;
+        SetPayload<uint8_t>(in, EC_PAYLOAD_CMD, EC_THM_GET_VARS);
+        SetPayload<uint8_t>(in, EC_THM_TZID, 1);
+        SetPayload<uint8_t>(in, EC_THM_VARS_COUNT, EC_THM_GET_VARS_MAX);
+        memcpy(in.Buffer + EC_THM_VARS_DATA, Fan, sizeof(Fan));
+        inlen = EC_THM_VARS_DATA + sizeof(Fan);
+    } else if (cmd == "bst") {
+        uuid = &BatteryUuid;
+        SetPayload<uint8_t>(in, EC_PAYLOAD_CMD, EC_BAT_GET_BST);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Function: DirectRequest
+ * -----------------------
+ * Issues one direct request matching what the ASL sends for the selected command, or with a
+ * batch above one an EC_MUX request carrying that many copies of it with 8 output bytes each.
+ */
+static bool DirectRequest(Connection& conn, const std::string& cmd, int batch)
+{
+    FFA_SEND_DIRECT_REQ2_BUFFER command = {};
+    FFA_SEND_DIRECT_REQ2_BUFFER in = {};
+    FFA_SEND_DIRECT_REQ2_BUFFER out = {};
+    const GUID* uuid = nullptr;
+    uint8_t inlen = 0;
+
+    if (!BuildCommand(cmd, command, uuid, inlen)) {
+        return false;
+    }
+    if (batch <= 1) {
+        return conn.SendDirectReq2(*uuid, command, out) == 0 &&
+               (cmd != "fan" || GetPayload<uint32_t>(out, EC_THM_VARS_MISSING) == 0);
+    }
+
+    size_t offset = EC_MUX_DATA;
+    SetPayload<uint8_t>(in, EC_PAYLOAD_CMD, EC_MUX);
+    SetPayload<uint8_t>(in, EC_MUX_COUNT, static_cast<uint8_t>(batch));
+    for (int i = 0; i < batch; i++) {
+        in.Buffer[offset++] = inlen;
+        in.Buffer[offset++] = EC_PAYLOAD_OUT;
+        in.Buffer[offset++] = 8;
+        memcpy(in.Buffer + offset, command.Buffer, inlen);
+        offset += inlen;
+    }
+
+    if (conn.SendDirectReq2(*uuid, in, out) != 0 || out.Buffer[EC_PAYLOAD_CMD] != EC_MUX ||
+        out.Buffer[EC_MUX_COUNT] != batch) {
+        return false;
+    }
+    for (int i = 0; i < batch; i++) {
+        if (out.Buffer[EC_MUX_DATA + i * 9] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Function: AsyncRequest
+ * ----------------------
+ * Queues an EC_ASYNC entry like ASYQ, kicks the EC and waits for the reassembled response like
+ * RXDB, blocking on the RX doorbell with a 1ms fallback poll.
+ */
+static bool AsyncRequest(Connection& conn, HostRing& ring)
+{
+    uint8_t entry[20] = {};
+    entry[1] = sizeof(entry);                           // LENG
+    entry[EC_FFA_PAYLOAD_OFFSET + EC_PAYLOAD_CMD] = EC_ASYNC;
+
+    uint16_t seq = 0;
+    while ((seq = ring.Queue(entry, sizeof(entry))) == 0) {
+        std::this_thread::yield();
+    }
+
+    FFA_SEND_DIRECT_REQ2_BUFFER in = {};
+    FFA_SEND_DIRECT_REQ2_BUFFER out = {};
+    SetPayload<uint8_t>(in, EC_PAYLOAD_CMD, EC_ASYNC);
+    SetPayload<uint16_t>(in, EC_ASYNC_SEQ, seq);
+    if (conn.SendDirectReq2(ManagementUuid, in, out) != 0) {
+        return false;
+    }
+
+    ecring::Reassembler reassembler(seq);
+    auto deadline = Clock::now() + std::chrono::milliseconds(500);
+    while (Clock::now() < deadline) {
+        uint64_t seen = conn.Notifications(EC_NOTIFY_RX_DOORBELL);
+        auto result = ring.Collect(reassembler);
+        if (result != ecring::Reassembler::Result::NeedMore) {
+            return result == ecring::Reassembler::Result::Complete;
+        }
+        conn.WaitDoorbell(seen, std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+/*
+ * Function: BulkRequest
+ * ---------------------
+ * Reads bytes of an object through one pool buffer like the driver's bulk work item, one
+ * EC_CAP_BULK request per buffer, copying each buffer out before the next request.
+ */
+static bool BulkRequest(Connection& conn, HostRing& ring, size_t index, uint8_t object, std::vector<uint8_t>& data)
+{
+    const ecring::BulkPool& pool = ring.Bulk();
+    uint32_t done = 0;
+
+    while (done < data.size()) {
+        uint32_t chunk = std::min<uint32_t>(static_cast<uint32_t>(data.size()) - done, pool.buffer_size);
+        FFA_SEND_DIRECT_REQ2_BUFFER in = {};
+        FFA_SEND_DIRECT_REQ2_BUFFER out = {};
+        SetPayload<uint8_t>(in, EC_PAYLOAD_CMD, EC_CAP_BULK);
+        SetPayload<uint8_t>(in, EC_BULK_OP, EC_BULK_OP_READ);
+        SetPayload<uint8_t>(in, EC_BULK_OBJECT, object);
+        SetPayload<uint32_t>(in, EC_BULK_OBJECT_OFFSET, done);
+        SetPayload<uint64_t>(in, EC_BULK_HANDLE, pool.handle[index]);
+        SetPayload<uint32_t>(in, EC_BULK_LENGTH, chunk);
+        if (conn.SendDirectReq2(ManagementUuid, in, out) != 0 || GetPayload<uint32_t>(out, EC_BULK_STATUS) != 0) {
+            return false;
+        }
+
+        uint32_t moved = std::min(GetPayload<uint32_t>(out, EC_BULK_MOVED), chunk);
+        memcpy(data.data() + done, ring.BulkBuffer(index), moved);
+        done += moved;
+        if (moved < chunk) {
+            break;
+        }
+    }
+    return true;
+}
+
+static double Percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+/*
+ * Function: NotifyRun
+ * -------------------
+ * Runs the emulator's generator for the configured duration, waits for stragglers and reports
+ * how many stamped events arrived, how many were lost or out of order and their latency.
+ */
+static int NotifyRun(Connection& conn, const GeneratorReq_t& req)
+{
+    GeneratorRsp_t rsp = {};
+    if (req.duration == 0 || !conn.ControlGenerator(req, rsp)) {
+        fprintf(stderr, "generator rejected the run\n");
+        return 1;
+    }
+
+    GeneratorReq_t query = {};
+    query.rate = GENERATOR_RATE_QUERY;
+    do {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        conn.ControlGenerator(query, rsp);
+    } while (rsp.running);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    auto stats = conn.Generated();
+    if (stats.run != rsp.run) {
+        stats = Connection::GeneratorStats();
+    }
+    std::sort(stats.latency.begin(), stats.latency.end());
+
+    printf("run %u rate %u/s duration %ums burst %u/%ums\n", rsp.run, req.rate, req.duration, req.burston, req.burstoff);
+    printf("generated %llu received %llu lost %lld reordered %llu\n",
+           (unsigned long long)rsp.generated, (unsigned long long)stats.received,
+           (long long)(rsp.generated - stats.received), (unsigned long long)stats.reordered);
+    printf("latency us p50 %.1f p99 %.1f p99.9 %.1f max %.1f\n",
+           Percentile(stats.latency, 0.50), Percentile(stats.latency, 0.99), Percentile(stats.latency, 0.999),
+           stats.latency.empty() ? 0 : stats.latency.back());
+    return stats.received == rsp.generated ? 0 : 1;
+}
+
+/*
+ * Function: LogRun
+ * ----------------
+ * Follows the log stream ring from its head while a generator run logs every event. When caught
+ * up the reader arms the log doorbell and waits for it, polling every 20ms in case it is missed,
+ * as the driver does. Reports event records read against events generated, bytes overwritten
+ * before they were read and the latency from the EC timestamp to the reader.
+ */
+static int LogRun(Connection& conn, HostRing& ring, const GeneratorReq_t& req)
+{
+    ecring::LogRing* log = ring.Log();
+    if (log == nullptr) {
+        fprintf(stderr, "no log ring published in the shared memory file\n");
+        return 1;
+    }
+
+    uint64_t cursor = log->Head();
+    GeneratorRsp_t rsp = {};
+    if (req.duration == 0 || !conn.ControlGenerator(req, rsp)) {
+        fprintf(stderr, "generator rejected the run\n");
+        return 1;
+    }
+
+    GeneratorReq_t query = {};
+    query.rate = GENERATOR_RATE_QUERY;
+    std::vector<ecring::LogRecord> records;
+    std::vector<double> latency;
+    uint64_t lost = 0, reads = 0, waits = 0, events = 0;
+    uint64_t doorbells = conn.Notifications(EC_NOTIFY_LOG_DOORBELL);
+    auto next_query = Clock::now() + std::chrono::milliseconds(100);
+    auto end = Clock::time_point::max();
+
+    while (Clock::now() < end) {
+        uint64_t seen = conn.Notifications(EC_NOTIFY_LOG_DOORBELL);
+        records.clear();
+        log->Read(cursor, records, lost);
+        reads++;
+
+        uint64_t now = Now100ns();
+        for (auto& record : records) {
+            if (record.source == LOG_SOURCE_GENERATOR && record.level == EC_LOG_LEVEL_VERBOSE) {
+                events++;
+                latency.push_back(now > record.timestamp ? (now - record.timestamp) / 10.0 : 0);
+            }
+        }
+
+        // Arm before the last look at HEAD so a record appended in between still rings
+        if (records.empty()) {
+            log->Arm();
+            if (log->Head() == cursor) {
+                waits++;
+                conn.WaitDoorbell(seen, std::chrono::milliseconds(20), EC_NOTIFY_LOG_DOORBELL);
+            }
+        }
+
+        if (end == Clock::time_point::max() && Clock::now() >= next_query) {
+            next_query += std::chrono::milliseconds(100);
+            conn.ControlGenerator(query, rsp);
+            if (!rsp.running) {
+                end = Clock::now() + std::chrono::milliseconds(100);
+            }
+        }
+    }
+    doorbells = conn.Notifications(EC_NOTIFY_LOG_DOORBELL) - doorbells;
+    std::sort(latency.begin(), latency.end());
+
+    printf("run %u rate %u/s duration %ums log ring 0x%llx bytes\n", rsp.run, req.rate, req.duration,
+           (unsigned long long)(log->Head() - log->Tail()));
+    printf("generated %llu logged %llu missed %lld lost %llu bytes\n", (unsigned long long)rsp.generated,
+           (unsigned long long)events, (long long)(rsp.generated - events), (unsigned long long)lost);
+    printf("reads %llu waits %llu doorbells %llu records per read %.1f\n", (unsigned long long)reads,
+           (unsigned long long)waits, (unsigned long long)doorbells, reads == 0 ? 0 : static_cast<double>(events) / reads);
+    printf("latency us p50 %.1f p99 %.1f p99.9 %.1f max %.1f\n",
+           Percentile(latency, 0.50), Percentile(latency, 0.99), Percentile(latency, 0.999),
+           latency.empty() ? 0 : latency.back());
+    return events == rsp.generated ? 0 : 1;
+}
+
+// Thermal requests of ThermalRun, sensor 2 is SKIN
+static bool ThermalRequest(Connection& conn, uint8_t cmd, const uint32_t* thresholds, uint32_t& value)
+{
+    FFA_SEND_DIRECT_REQ2_BUFFER in = {};
+    FFA_SEND_DIRECT_REQ2_BUFFER out = {};
+    SetPayload<uint8_t>(in, EC_PAYLOAD_CMD, cmd);
+    SetPayload<uint8_t>(in, EC_THM_TZID, 2);
+    if (thresholds != nullptr) {
+        SetPayload<uint32_t>(in, EC_THM_THRS_TIMEOUT, thresholds[0]);
+        SetPayload<uint32_t>(in, EC_THM_THRS_LOW, thresholds[1]);
+        SetPayload<uint32_t>(in, EC_THM_THRS_HIGH, thresholds[2]);
+    }
+    if (conn.SendDirectReq2(ThermalUuid, in, out) != 0) {
+        return false;
+    }
+    value = GetPayload<uint32_t>(out, thresholds != nullptr ? EC_THM_THRS_STATUS : EC_PAYLOAD_OUT);
+    return true;
+}
+
+/*
+ * Function: ThermalRun
+ * --------------------
+ * Follows sensor 2 for the configured duration with the window eclib's TemperatureWindow arms:
+ * the hysteresis around the last report, stopping at the low and high thresholds. Nothing is
+ * sent between EC_NOTIFY_THERMAL events unless the event record is missing or the timeout
+ * expired. Every event for a crossing must carry a temperature outside the armed window.
+ */
+static int ThermalRun(Connection& conn, HostRing& ring, const Options& options)
+{
+    uint32_t temperature = 0, low = 0, high = 0, status = 0;
+    uint64_t requests = 0, events = 0, reports = 0, errors = 0;
+    bool first = true, known = false;
+    auto start = Clock::now();
+    auto end = start + std::chrono::milliseconds(options.generator.duration);
+
+    while (Clock::now() < end) {
+        if (!known) {
+            requests++;
+            if (!ThermalRequest(conn, EC_THM_GET_TMP, nullptr, temperature)) {
+                fprintf(stderr, "GET_TMP failed\n");
+                return 1;
+            }
+        }
+        known = false;
+
+        if (first || temperature < low || temperature > high) {
+            reports++;
+            bool below = temperature < options.low, above = temperature > options.high;
+            first = false;
+            low = options.hysteresis != 0 && temperature > options.hysteresis ? temperature - options.hysteresis : 0;
+            high = options.hysteresis != 0 ? temperature + options.hysteresis : UINT32_MAX;
+            if (!below) {
+                low = std::max(low, options.low);
+            } else {
+                high = std::min(high, options.low - 1);
+            }
+            if (!above) {
+                high = std::min(high, options.high);
+            } else {
+                low = std::max(low, options.high + 1);
+            }
+        }
+
+        // Count before arming, the EC raises right away if the sensor is already outside
+        uint64_t seen = conn.Notifications(EC_NOTIFY_THERMAL);
+        uint32_t thresholds[3] = { 1000, low, high };
+        requests++;
+        if (!ThermalRequest(conn, EC_THM_SET_THRS, thresholds, status) || status != 0) {
+            fprintf(stderr, "SET_THRS failed\n");
+            return 1;
+        }
+
+        conn.WaitDoorbell(seen, std::chrono::duration_cast<std::chrono::microseconds>(end - Clock::now()),
+                          EC_NOTIFY_THERMAL);
+        if (conn.Notifications(EC_NOTIFY_THERMAL) == seen) {
+            break;
+        }
+        events++;
+
+        uint32_t id = 0;
+        std::vector<uint8_t> data;
+        if (ring.Event(id, data) && id == EC_NOTIFY_THERMAL && data.size() >= EC_THM_EVENT_SIZE &&
+            data[EC_THM_EVENT_REASON] != EC_THM_REASON_TIMEOUT) {
+            memcpy(&temperature, &data[EC_THM_EVENT_TEMP], sizeof(temperature));
+            known = true;
+            if (temperature >= low && temperature <= high) {
+                errors++;
+            }
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    printf("sensor 2 window %u-%u hysteresis %u duration %ums\n", options.low, options.high, options.hysteresis,
+           options.generator.duration);
+    printf("reports %llu events %llu requests %llu (%.1f/s) errors %llu\n", (unsigned long long)reports,
+           (unsigned long long)events, (unsigned long long)requests, seconds > 0 ? requests / seconds : 0,
+           (unsigned long long)errors);
+    return errors == 0 ? 0 : 1;
+}
+
+/*
+ * Function: ReplayRun
+ * -------------------
+ * Replays a recording made with eclib's StartRecording against the emulator at the recorded
+ * pace scaled by speed. Each FF-A command goes out as an EC_MUX request of one, which runs it as
+ * if it arrived alone, and its status and output are compared with the recording. Each
+ * notification is raised again as a one event generator run. Evaluations need the ASL and are
+ * only counted.
+ */
+static int ReplayRun(Connection& conn, const Options& options)
+{
+    struct stat st;
+    int fd = open(options.file.c_str(), O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(options.file.c_str());
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 1;
+    }
+    void* base = st.st_size > 0 ? mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    ecrecord::Reader reader(base != MAP_FAILED ? base : nullptr, base != MAP_FAILED ? static_cast<size_t>(st.st_size) : 0);
+    if (!reader.Valid()) {
+        fprintf(stderr, "%s is not a recording\n", options.file.c_str());
+        if (base != MAP_FAILED) {
+            munmap(base, static_cast<size_t>(st.st_size));
+        }
+        return 1;
+    }
+
+    ecrecord::Record record;
+    ecrecord::Command command;
+    uint64_t records = 0, evaluations = 0, commands = 0, notifications = 0;
+    uint64_t statusdiffs = 0, outputdiffs = 0, failures = 0;
+    double recorded = 0, replayed = 0, late = 0;
+    uint64_t first = UINT64_MAX;
+    auto begin = Clock::now();
+
+    while (reader.Next(record)) {
+        records++;
+        if (first == UINT64_MAX) {
+            first = record.time;
+        }
+        if (options.speed != 0) {
+            uint64_t offset = record.time > first ? record.time - first : 0;
+            auto due = begin + std::chrono::microseconds(offset * 10 / options.speed);
+            auto now = Clock::now();
+            if (now < due) {
+                Delay(std::chrono::duration_cast<std::chrono::microseconds>(due - now));
+            } else {
+                late = std::max(late, std::chrono::duration<double, std::micro>(now - due).count());
+            }
+        }
+
+        if (record.kind == EC_RECORD_EVAL) {
+            evaluations++;
+            continue;
+        }
+        if (record.kind == EC_RECORD_NOTIFY) {
+            GeneratorReq_t req = {};
+            GeneratorRsp_t rsp = {};
+            req.rate = 1000;
+            req.duration = 1;
+            req.firstevent = req.lastevent = static_cast<uint8_t>(record.event);
+            if (record.event > 0xFF || !conn.ControlGenerator(req, rsp)) {
+                failures++;
+            }
+            notifications++;
+            continue;
+        }
+
+        auto start = Clock::now();
+        while (reader.NextCommand(command)) {
+            FFA_SEND_DIRECT_REQ2_BUFFER in = {};
+            FFA_SEND_DIRECT_REQ2_BUFFER out = {};
+            GUID uuid;
+            commands++;
+            if (EC_MUX_DATA + EC_MUX_HEADER_SIZE + command.inlen > EC_FFA_PAYLOAD_SIZE ||
+                EC_MUX_DATA + 1 + command.outlen > EC_FFA_PAYLOAD_SIZE) {
+                failures++;
+                continue;
+            }
+
+            memcpy(&uuid, command.uuid, sizeof(uuid));
+            SetPayload<uint8_t>(in, EC_PAYLOAD_CMD, EC_MUX);
+            SetPayload<uint8_t>(in, EC_MUX_COUNT, 1);
+            SetPayload<uint8_t>(in, EC_MUX_DATA, command.inlen);
+            SetPayload<uint8_t>(in, EC_MUX_DATA + 1, command.outoff);
+            SetPayload<uint8_t>(in, EC_MUX_DATA + 2, command.outlen);
+            memcpy(in.Buffer + EC_MUX_DATA + EC_MUX_HEADER_SIZE, command.input, command.inlen);
+            if (conn.SendDirectReq2(uuid, in, out) != 0 || out.Buffer[EC_PAYLOAD_CMD] != EC_MUX ||
+                out.Buffer[EC_MUX_COUNT] != 1) {
+                failures++;
+                continue;
+            }
+
+            // Commands of a request that failed when recorded have nothing to compare with
+            uint8_t status = out.Buffer[EC_MUX_DATA];
+            if (record.status != 0) {
+                continue;
+            }
+            if (status != command.status) {
+                statusdiffs++;
+            } else if (status == 0 && memcmp(out.Buffer + EC_MUX_DATA + 1, command.output, command.outlen) != 0) {
+                outputdiffs++;
+            }
+        }
+        recorded += record.duration / 10.0;
+        replayed += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+
+    printf("records %llu evaluations skipped %llu commands %llu notifications %llu%s\n",
+           (unsigned long long)records, (unsigned long long)evaluations, (unsigned long long)commands,
+           (unsigned long long)notifications, reader.Truncated() ? " recording cut short" : "");
+    printf("failed %llu different status %llu different output %llu\n", (unsigned long long)failures,
+           (unsigned long long)statusdiffs, (unsigned long long)outputdiffs);
+    printf("command time us recorded %.1f replayed %.1f, at most %.1f behind schedule\n", recorded, replayed, late);
+
+    munmap(base, static_cast<size_t>(st.st_size));
+    return failures == 0 ? 0 : 1;
+}
+
+static void Usage()
+{
+    printf("Usage: ecload [-socket path] [-ring path] [-mode direct|async] [-cmd fw|tmp|var|fan|bst]\n"
+           "              [-threads n] [-count n] [-batch n]\n"
+           "       ecload -mode bulk [-object log|history|fw] [-bytes n] [-threads n] [-count n]\n"
+           "       ecload -mode notify [-rate hz] [-duration ms] [-events first:last] [-dist rr|uniform|hot]\n"
+           "              [-burst on_ms:off_ms]\n"
+           "       ecload -mode log [-rate hz] [-duration ms]\n"
+           "       ecload -mode thermal [-duration ms] [-low dK] [-high dK] [-hysteresis dK]\n"
+           "       ecload -mode replay -file recording [-speed percent]\n");
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            Usage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "-socket") {
+            options.socket_path = value;
+        } else if (arg == "-ring") {
+            options.ring_path = value;
+        } else if (arg == "-mode") {
+            options.mode = value;
+        } else if (arg == "-cmd") {
+            options.cmd = value;
+        } else if (arg == "-threads") {
+            options.threads = std::max(1, atoi(value));
+        } else if (arg == "-count") {
+            options.count = std::max(1, atoi(value));
+        } else if (arg == "-batch") {
+            options.batch = std::max(1, atoi(value));
+        } else if (arg == "-object") {
+            options.object = value;
+        } else if (arg == "-bytes") {
+            options.bytes = static_cast<uint32_t>(std::max(1UL, strtoul(value, nullptr, 0)));
+        } else if (arg == "-rate") {
+            options.generator.rate = static_cast<uint32_t>(strtoul(value, nullptr, 0));
+        } else if (arg == "-duration") {
+            options.generator.duration = static_cast<uint32_t>(strtoul(value, nullptr, 0));
+        } else if (arg == "-events") {
+            char* end = nullptr;
+            options.generator.firstevent = static_cast<uint8_t>(strtoul(value, &end, 0));
+            options.generator.lastevent = *end == ':' ? static_cast<uint8_t>(strtoul(end + 1, nullptr, 0))
+                                                      : options.generator.firstevent;
+        } else if (arg == "-dist") {
+            std::string dist = value;
+            options.generator.distribution = dist == "uniform" ? GENERATOR_DIST_UNIFORM
+                                           : dist == "hot"     ? GENERATOR_DIST_HOT
+                                                               : GENERATOR_DIST_ROUND_ROBIN;
+        } else if (arg == "-low") {
+            options.low = static_cast<uint32_t>(strtoul(value, nullptr, 0));
+        } else if (arg == "-high") {
+            options.high = static_cast<uint32_t>(strtoul(value, nullptr, 0));
+        } else if (arg == "-hysteresis") {
+            options.hysteresis = static_cast<uint32_t>(strtoul(value, nullptr, 0));
+        } else if (arg == "-file") {
+            options.file = value;
+        } else if (arg == "-speed") {
+            options.speed = static_cast<uint32_t>(strtoul(value, nullptr, 0));
+        } else if (arg == "-burst") {
+            char* end = nullptr;
+            options.generator.burston = static_cast<uint32_t>(strtoul(value, &end, 0));
+            options.generator.burstoff = *end == ':' ? static_cast<uint32_t>(strtoul(end + 1, nullptr, 0)) : 0;
+        } else {
+            Usage();
+            return 1;
+        }
+    }
+
+    if (options.mode == "notify") {
+        Connection conn;
+        if (!conn.Open(options.socket_path)) {
+            return 1;
+        }
+        int result = NotifyRun(conn, options.generator);
+        conn.Close();
+        return result;
+    }
+
+    if (options.mode == "replay") {
+        Connection conn;
+        if (options.file.empty() || !conn.Open(options.socket_path)) {
+            return 1;
+        }
+        int result = ReplayRun(conn, options);
+        conn.Close();
+        return result;
+    }
+
+    if (options.mode == "log") {
+        Connection conn;
+        HostRing ring;
+        if (!conn.Open(options.socket_path) || !ring.Open(options.ring_path)) {
+            return 1;
+        }
+        int result = LogRun(conn, ring, options.generator);
+        conn.Close();
+        return result;
+    }
+
+    if (options.mode == "thermal") {
+        Connection conn;
+        HostRing ring;
+        if (!conn.Open(options.socket_path) || !ring.Open(options.ring_path)) {
+            return 1;
+        }
+        int result = ThermalRun(conn, ring, options);
+        conn.Close();
+        return result;
+    }
+
+    bool async = options.mode == "async";
+    bool bulk = options.mode == "bulk";
+    uint8_t object = options.object == "history" ? EC_BULK_OBJ_HISTORY
+                   : options.object == "fw"      ? EC_BULK_OBJ_FIRMWARE
+                                                 : EC_BULK_OBJ_LOG;
+    if (!async && !bulk && options.mode != "direct") {
+        Usage();
+        return 1;
+    }
+
+    // Every packed command costs its header, its payload and a status byte plus 8 output bytes
+    if (options.batch > 1) {
+        FFA_SEND_DIRECT_REQ2_BUFFER command = {};
+        const GUID* uuid = nullptr;
+        uint8_t inlen = 0;
+        if (async || !BuildCommand(options.cmd, command, uuid, inlen) ||
+            EC_MUX_DATA + options.batch * (EC_MUX_HEADER_SIZE + inlen) > EC_FFA_PAYLOAD_SIZE ||
+            EC_MUX_DATA + options.batch * 9 > EC_FFA_PAYLOAD_SIZE) {
+            fprintf(stderr, "batch of %d does not fit in one direct request\n", options.batch);
+            return 1;
+        }
+    }
+
+    Connection conn;
+    HostRing ring;
+    if (!conn.Open(options.socket_path) || ((async || bulk) && !ring.Open(options.ring_path))) {
+        return 1;
+    }
+    if (bulk && ring.Bulk().count < static_cast<size_t>(options.threads)) {
+        fprintf(stderr, "bulk mode needs a pool buffer per thread, pool has %u\n", ring.Bulk().count);
+        conn.Close();
+        return 1;
+    }
+
+    std::vector<std::vector<double>> latencies(options.threads);
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+
+    auto start = Clock::now();
+    for (int t = 0; t < options.threads; t++) {
+        threads.emplace_back([&, t] {
+            std::vector<uint8_t> data(bulk ? options.bytes : 0);
+            latencies[t].reserve(options.count);
+            for (int i = 0; i < options.count; i++) {
+                auto begin = Clock::now();
+                bool ok = bulk  ? BulkRequest(conn, ring, t, object, data)
+                        : async ? AsyncRequest(conn, ring)
+                                : DirectRequest(conn, options.cmd, options.batch);
+                if (!ok) {
+                    failures++;
+                    continue;
+                }
+                latencies[t].push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> all;
+    for (auto& l : latencies) {
+        all.insert(all.end(), l.begin(), l.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    double sum = 0;
+    for (double v : all) {
+        sum += v;
+    }
+
+    printf("mode %s threads %d requests %zu failed %d\n", options.mode.c_str(), options.threads, all.size(), failures.load());
+    printf("throughput %.1f req/s\n", all.size() / secs);
+    if (options.batch > 1) {
+        printf("batch %d throughput %.1f commands/s\n", options.batch, all.size() * options.batch / secs);
+    }
+    if (bulk) {
+        printf("bulk %s %u bytes per transfer %.1f MB/s\n", options.object.c_str(), options.bytes,
+               all.size() * static_cast<double>(options.bytes) / secs / 1e6);
+    }
+    printf("latency us min %.1f avg %.1f p50 %.1f p99 %.1f max %.1f\n",
+           all.empty() ? 0 : all.front(), all.empty() ? 0 : sum / all.size(),
+           Percentile(all, 0.50), Percentile(all, 0.99), all.empty() ? 0 : all.back());
+    for (auto& n : conn.AllNotifications()) {
+        printf("notify 0x%x count %llu\n", n.first, (unsigned long long)n.second);
+    }
+
+    conn.Close();
+    return failures == 0 ? 0 : 1;
+}
@@ -1,483 +1,1884 @@
-/*
-MIT License
-
-Copyright (c) 2025 Open Device Partnership
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*/
-
-#include <DriverSpecs.h>
-_Analysis_mode_(_Analysis_code_type_user_code_)
-
-#define INITGUID
-#include <windows.h>
-#include <strsafe.h>
-#include <cfgmgr32.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <errno.h>
-#include <SetupAPI.h>
-#include <Devpkey.h>
-#include <Acpiioct.h>
-#include <devioctl.h>
-#include <Objbase.h>
-#include <memory>
-#include "..\inc\ectest.h"
-
-extern "C" {
-    #include "..\inc\eclib.h"
-}
-
-#define EC_TEST_NOTIFICATIONS
-//#define EC_TEST_SHARED_BUFFER
-
-#define ACPI_OUTPUT_BUFFER_SIZE 1024
-#define MAX_STRING_LEN 256
-#define CMD_MIN_ARG_COUNT 3  // Always need ectest.exe -acpi <method>
-
-// Global event handle
-static HANDLE gExitEvent = NULL;
-
-/*
- * Function: void DumpAcpi
- *
- * Description:
- * The DumpAcpi function evaluates an ACPI method on a specified device and prints the results.
- * It sends an IOCTL request to the device to execute the ACPI method and processes the returned data.
- *
- * Parameters:
- * methodName: Method of ACPI to evaluate and dump
- *
- * Return Value:
- * None.
- */
-int DumpAcpi(ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX *acpiinput )
-{
-
-    BYTE buffer[ACPI_OUTPUT_BUFFER_SIZE];
-    ACPI_EVAL_OUTPUT_BUFFER_V1 *AcpiOut = (ACPI_EVAL_OUTPUT_BUFFER_V1 *)buffer;
-    size_t buffer_size = sizeof(buffer);
-
-    int status = EvaluateAcpi((void *)acpiinput, sizeof(ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX) + acpiinput->Size, buffer, &buffer_size );
-
-    if(status != ERROR_SUCCESS) {
-        printf("EvaluateAcpi failed, status: 0x%x\n", status);
-        return status;
-    }
-
-    // Print the raw output data returned from ACPI function
-    printf("ACPI Method: \n");
-    printf("  Signature: 0x%x\n", AcpiOut->Signature);
-    printf("  Length: 0x%x\n", AcpiOut->Length);
-    printf("  Count: 0x%x\n", AcpiOut->Count);
-
-    // Dump out the contents of each Argument separately
-    ACPI_METHOD_ARGUMENT_V1 *Argument = AcpiOut->Argument;
-
-    for(ULONG i=0; i < AcpiOut->Count; i++) {
-        printf("    Argument[%i]:\n", i);
-        switch(Argument->Type) {
-            case ACPI_METHOD_ARGUMENT_INTEGER:
-                printf("    Integer Value: 0x%x\n", Argument->Argument);
-                break;
-            case ACPI_METHOD_ARGUMENT_STRING:
-                printf("    String Value: %s\n", Argument->Data);
-                break;
-            case ACPI_METHOD_ARGUMENT_BUFFER:
-            case ACPI_METHOD_ARGUMENT_PACKAGE:
-            default:
-                printf("    Buffer Data:\n");
-                for(int j=0; j < Argument->DataLength; j++) {
-                    printf(" 0x%x,", Argument->Data[j]);
-                }
-                break;
-
-        }
-        // Argument is variable length so update to point to next entry
-        Argument = (ACPI_METHOD_ARGUMENT_V1 *)(Argument->Data + Argument->DataLength);
-    }
-
-    printf("\n\nACPI Raw Output:\n");
-    for(ULONG i=0; i < AcpiOut->Length; i++) {
-        printf(" 0x%x",((BYTE *)AcpiOut)[i]);
-    }
-    printf("\n\n");
-
-    return ERROR_SUCCESS;
-}
-
-/*
- * Function: int CharToGUID
- *
- * Description:
- * This function converts an ASCII character to corresponding hex value or returns 0 if invalid
- *
- * Parameters:
- * out: Output BYTE array that contains GUID values
- * out_len: Length of output buffer must be at least 16 bytes
- * guid: Input pointer to char * of string representation of GUID
- * guid_len: Must be 39 bytes including terminating \0
- *
- * Return Value:
- * ERROR_SUCESS or failure code
- */
-int CharToGUID(BYTE *out, size_t out_len, char *guid, size_t guid_len)
-{
-    // Make sure in and out buffers are lengths and format we expect
-    if(out_len < 16 || guid_len != 39) {
-        return ERROR_INVALID_PARAMETER;
-    }
-    
-    // Convert char* to wide string
-    wchar_t wideGuidStr[39]; // GUID string is 38 chars + null terminator
-    size_t bytesReturned = 0;
-    int status = mbstowcs_s(&bytesReturned, wideGuidStr, guid, guid_len);
-    if( status != ERROR_SUCCESS) {
-        return status;
-    }
-
-    IID uuid;
-    HRESULT hr = IIDFromString(wideGuidStr, &uuid);
-
-    if (SUCCEEDED(hr)) {
-        // Copy data to guid buffer
-        memcpy(out, &uuid, sizeof(IID));
-    } else {
-        return ERROR_INVALID_PARAMETER;
-    }
-
-    return ERROR_SUCCESS;
-}
-
-/*
- * Function: int ParseCmdline
- *
- * Description:
- * The ParseCmdline function parses the command line arguments and sets the ACPI method name if provided.
- * It checks the number of arguments and prints usage instructions if the required arguments are not provided.
- *
- * Parameters:
- * int argc: The number of command line arguments.
- * char **argv: The array of command line arguments.
- *
- * Return Value:
- * Returns ERROR_SUCCESS if the ACPI method name is successfully set, otherwise returns ERROR_INVALID_PARAMETER.
- */
-int ParseCmdline(
-    _In_ int argc,
-    _In_ char ** argv
-    )
-{
-
-    // Must always have at least 3 parameters
-    if( argc < CMD_MIN_ARG_COUNT ) {
-        printf("Usage:\n");
-        printf("    ectest.exe                        --- Print this help\n");
-        printf("    ectest.exe -acpi \\_SB.ECT0.NEVT  --- Evaluate given ACPI method with no arguments\n");
-        printf("    ectest.exe -acpi \\_SB.ECT0.TDSM {07ff6382-e29a-47c9-ac87-e79dad71dd82} 1 3 0\n");
-        printf("               GUID - {xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}\n");
-        printf("            Integer - 0x123ABC 1234 -1234\n");
-        printf("             String - \'TestString\'\n");
-
-        return ERROR_INVALID_PARAMETER;
-    } else if(argc > CMD_MIN_ARG_COUNT + 7) {
-        // ACPI function cannot accept more than 7 arguments
-        printf("Exceeded 7 ACPI arguments!\n");
-        return ERROR_INVALID_PARAMETER;
-    }
-
-    // Create new buffer based on number of parameters and max string size
-    size_t buffer_max = (argc-CMD_MIN_ARG_COUNT)*MAX_STRING_LEN + sizeof(ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX);
-    std::unique_ptr<BYTE[]> buffer(new BYTE[buffer_max]); // Throws exception if it fails, auto frees
-
-    auto* params = reinterpret_cast<ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX*>(buffer.get());
-    params->Signature = ACPI_EVAL_INPUT_BUFFER_COMPLEX_SIGNATURE_EX;
-    strncpy_s(params->MethodName, sizeof(params->MethodName), argv[2], strlen(argv[2]));
-    params->ArgumentCount = argc - 3;
-    params->Size = 0;
-
-
-    printf("Signature: 0x%x\n", params->Signature);
-
-    // Iterate through the argument creation
-    ACPI_METHOD_ARGUMENT_V1 *arg = &params->Argument[0];
-
-    // Loop through each remaining parameters and convert to correct type
-    for(size_t i=0; i < params->ArgumentCount; i++) {
-        char *carg = argv[i+CMD_MIN_ARG_COUNT];
-
-        // Make sure this parameter will not overflow our buffer allocation
-        size_t str_len = strlen(carg);
-        if( ((UINT64)arg->Data - (UINT64)buffer.get()) + str_len > buffer_max ) {
-            printf("Parameters too long\n");
-            return ERROR_INVALID_PARAMETER;
-        }
-        
-        // GUID must be in this exact format {25cb5207-ac36-427d-aaef-3aa78877d27e}
-        if(carg[0] == '{') {
-            int status = CharToGUID(arg->Data, 16, carg, str_len+1); // Include terminating \0 in length
-            if(status != ERROR_SUCCESS) {
-                printf("Failed to convert GUID\n");
-                printf("Please provide GUID in this format: {25cb5207-ac36-427d-aaef-3aa78877d27e}\n");
-                return status;
-            }
-            // Print out the GUID
-            printf("Converted GUID: {");
-            for(size_t j=0; j < 16; j++) {
-                printf("0x%x,", arg->Data[j]);
-            }
-            printf("}\n");
-
-            arg->Type = ACPI_METHOD_ARGUMENT_BUFFER;
-            arg->DataLength = 16;
-
-        } else if(carg[0] == '\'') {
-            // Pull off the start and ending ' '
-            arg->Type = ACPI_METHOD_ARGUMENT_STRING;
-            arg->DataLength = static_cast<USHORT>(strlen(carg)-1);
-            strncpy_s(reinterpret_cast<char*>(arg->Data), MAX_STRING_LEN, &carg[1], arg->DataLength-1);
-            printf("Converting to String: %s\n", arg->Data);
-        } else {
-            char *endptr = nullptr;
-            arg->Type = ACPI_METHOD_ARGUMENT_INTEGER;
-            arg->DataLength = 4; // Length of DWORD
-            arg->Argument = strtol(carg, &endptr, 0); // Try to guess the base
-            if(endptr == carg) {
-                printf("Failed to convert number\n");
-                return ERROR_INVALID_PARAMETER;
-            }
-            printf("Converted to Number: 0x%x\n",arg->Argument);
-        }
-
-        params->Size += arg->DataLength;
-
-        // Increment to next value
-        arg = reinterpret_cast<ACPI_METHOD_ARGUMENT_V1*>(
-            reinterpret_cast<UINT64>(arg) + sizeof(USHORT) * 2 + arg->DataLength);
-    }
-
-    // Evaluate and dump output
-    return DumpAcpi(params);
-}
-
-/*
- * Function: int ReadRxBuffer
- *
- * Description:
- * The ReadRxBuffer function reads the receive buffer from a Kernel-Mode Driver Framework (KMDF) driver.
- * It sends a request to the driver and receives the buffer data.
- *
- * Parameters:
- * HANDLE hDevice: A handle to the device from which the receive buffer is to be read.
- *
- * Return Value:
- * Returns ERROR_SUCCESS if the receive buffer is successfully read, otherwise returns ERROR_INVALID_PARAMETER.
- */
-#ifdef EC_TEST_SHARED_BUFFER
-int ReadRxBuffer(
-    _In_ HANDLE hDevice
-    )
-{
-    BOOL bRc;
-    ULONG bytesReturned;
-    ULONG inbuf;
-    RxBufferRsp_t rxrsp;
-
-    printf("\nCalling DeviceIoControl IOCTL_GET_RX_BUFFER\n");
-
-    bRc = DeviceIoControl ( hDevice,
-                            (DWORD) IOCTL_READ_RX_BUFFER,
-                            &inbuf,
-                            sizeof(inbuf),
-                            &rxrsp,
-                            sizeof(rxrsp),
-                            &bytesReturned,
-                            NULL
-                            );
-
-    if ( !bRc )
-    {
-        printf ( "***       Error in DeviceIoControl : %d \n", GetLastError());
-        return ERROR_INVALID_PARAMETER;
-    }
-
-    // Print out notification details
-    printf("***                 data: 0x%llx\n", rxrsp.data);
-
-    return ERROR_SUCCESS;
-}
-#endif // EC_TEST_SHARED_BUFFER
-
-#ifdef EC_TEST_NOTIFICATIONS
-/*
- * Function: DDWORD NotificationThread
- *
- * Description:
- * The NotificationThread function retrieves a notification from a Kernel-Mode Driver Framework (KMDF) driver.
- * It sends a request to the driver and receives the notification details.
- *
- * Parameters:
- * LPVOID lpParam: A handle to ready event we notfiy after sending IOCTL to wait for events
- *
- * Return Value:
- * Returns ERROR_SUCCESS if the notification is successfully retrieved, otherwise returns ERROR_INVALID_PARAMETER.
- */
-DWORD WINAPI NotificationThread(LPVOID lpParam) 
-{
-    UNREFERENCED_PARAMETER(lpParam);
-
-    // Main loop to wait for notifications
-    for(;;) {
-        UINT32 event = WaitForNotification(0);
-        printf("Received Notification Event: 0x%x\n", event);
-        // If we get exit event then break out of loop and exit thread
-        if( WaitForSingleObject(gExitEvent, 0) == WAIT_OBJECT_0) {
-            break;
-        }
-    }
-
-    return 0;
-}
-
-
-/*
- * Function: HANDLE StartNotificationListener
- *
- * Description:
- * The StartNotificationListener function creates a thread to listen for notifications and returns a handle to the thread.
- * It creates an event to signal when the thread is ready and waits for the thread to be ready or terminated.
- *
- * Parameters:
- * None
- *
- * Return Value:
- * Returns a handle to the notification listener thread if successful, otherwise returns NULL.
- */
-HANDLE StartNotificationListener(void)
-{
-    HANDLE hThread;
-    DWORD dwThreadId;
-
-    // Initialize external notification lib
-    int status = InitializeNotification();
-    if(status != ERROR_SUCCESS) {
-        printf("InitializeNotification failed, status: 0x%x\n", status);
-        return NULL;
-    }
-
-    // Create the thread
-    hThread = CreateThread(
-        NULL,                   // Default security attributes
-        0,                      // Default stack size
-        NotificationThread,     // Thread routine
-        NULL,                   // Parameter to thread routine
-        0,                      // Default creation flags
-        &dwThreadId);           // Receive thread identifier
-
-    return hThread;
-}
-#endif // EC_TEST_NOTIFICATIONS
-
-
-/*
- * Function: int main
- *
- * Description:
- * The main function serves as the entry point for the program. It parses the command line arguments,
- * retrieves a handle to the KMDF driver, and evaluates an ACPI method on the device.
- *
- * Parameters:
- * int argc: The number of command line arguments.
- * char* argv[]: The array of command line arguments.
- *
- * Return Value:
- * Returns the status of the operations. Returns ERROR_SUCCESS if all operations are successful,
- * otherwise returns an error code.
- */
-int __cdecl
-main(
-    _In_ int argc,
-    _In_reads_(argc) char* argv[]
-    )
-{
-
-    HANDLE hThread = NULL;
-    int status = ERROR_SUCCESS;
-
-    // Keep only one instance of the application running
-    // This makes the App & Driver simple by not allowing multiple instances
-    //
-    HANDLE hMutex = CreateMutex(NULL, TRUE, L"Global\\ECTestAppMutex");
-    if (hMutex == NULL) {
-        status = GetLastError();
-        printf("CreateMutex failed, error: %d\n", status);
-        goto CleanUp;
-    }
-
-    if (GetLastError() == ERROR_ALREADY_EXISTS) {
-        printf("Another instance of the application is already running.\n");
-        goto CleanUp;
-    }
-
-#ifdef EC_TEST_NOTIFICATIONS
-    // Create the exit event
-    gExitEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
-    if (gExitEvent == NULL) {
-        status = GetLastError();
-        printf("CreateEvent failed, error: %d\n", status);
-        goto CleanUp;
-    }
-
-    // This creates a new thread and blocks until listener is running
-    hThread = StartNotificationListener();
-    if(hThread == NULL) {
-        goto CleanUp;
-    }
-#endif // EC_TEST_NOTIFICATIONS
-
-    status = ParseCmdline(argc,argv);
-    if(status != ERROR_SUCCESS) {
-        goto CleanUp;
-    }
-
-    // Loop until we hit "q to quit"
-    printf("Waiting for notification press 'q' to quit.\n");
-    int key;
-    for(;;) {
-        key = getchar();
-        if( key == 'q') {
-            break;
-        }
-    }
-
-    printf("You pressed 'q'. Exiting...\n");
-CleanUp:
-
-    // Signal the exit event to stop the thread
-    if(gExitEvent) SetEvent(gExitEvent);
-    if(hThread) CancelSynchronousIo(hThread);
-    if(hThread) WaitForSingleObject(hThread, INFINITE);
-    if(hThread) CleanupNotification();
-    if(hThread) CloseHandle(hThread);
-
-    if(gExitEvent) CloseHandle(gExitEvent);
-    if(hMutex) CloseHandle(hMutex);
-
-    return status;
-}
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <DriverSpecs.h>
+_Analysis_mode_(_Analysis_code_type_user_code_)
+
+#define INITGUID
+#include <windows.h>
+#include <strsafe.h>
+#include <cfgmgr32.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <io.h>
+#include <fcntl.h>
+#include <SetupAPI.h>
+#include <Devpkey.h>
+#include <Acpiioct.h>
+#include <devioctl.h>
+#include <Objbase.h>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include "..\inc\ectest.h"
+#include "..\inc\ecring.h"
+#include "..\inc\ecsvc.h"
+#include "..\inc\acpiview.h"
+#include "..\inc\acpireq.h"
+#include "..\inc\acpiout.h"
+
+extern "C" {
+    #include "..\inc\eclib.h"
+}
+
+#define EC_TEST_NOTIFICATIONS
+//#define EC_TEST_SHARED_BUFFER
+
+#define ACPI_OUTPUT_BUFFER_SIZE 1024
+#define MAX_STRING_LEN 256
+#define ACPI_REQUEST_ARENA_SIZE 1024 // Larger requests from the command line are sized exactly
+#define CMD_MIN_ARG_COUNT 3  // Always need ectest.exe -acpi <method>
+
+// Global event handle
+static HANDLE gExitEvent = NULL;
+
+// Thread following the EC log with -log follow
+static HANDLE gLogThread = NULL;
+
+// Temperature subscription made with -subscribe, 0 if none
+static UINT32 gSubscription = 0;
+
+// Methods of the rules set with -prefetch, indexed by PrefetchResult_t rule
+static const char *gPrefetchMethods[PREFETCH_RULE_MAX];
+
+#define GENERATOR_MAX_SAMPLES 1000000
+
+// Results of the current generator run gathered by the notification thread
+typedef struct {
+    SRWLOCK lock;
+    UINT32 run;
+    UINT64 received;            // Occurrences, so coalesced events are counted too
+    UINT64 notifications;       // Notifications carrying a stamp
+    std::vector<UINT64> latency;// Stamp to app in 100ns units, capped at GENERATOR_MAX_SAMPLES
+} GeneratorStats_t;
+
+static GeneratorStats_t gGenStats = { SRWLOCK_INIT };
+
+// Priority class set with -priority, EVAL_PRIORITY_COUNT uses the plain IOCTL_ACPI_EVAL_METHOD_EX
+static UINT32 gPriority = EVAL_PRIORITY_COUNT;
+
+static const char *gPriorityNames[EVAL_PRIORITY_COUNT] = { "critical", "normal", "bulk" };
+
+// Methods discovered and output sizes seen, kept next to ectest.exe between runs
+#define METHOD_CACHE_FILE "ectest.methods"
+static char gMethodCache[MAX_PATH];
+
+// Set while this process samples results for others, or waits to take over
+static BOOL gShareStarted = FALSE;
+
+// Set while every call is recorded, see -record
+static BOOL gRecording = FALSE;
+
+// Set while calls and driver events are traced, see -trace
+static BOOL gTracing = FALSE;
+
+// Format of -acpi results set with -format, ACPI_OUT_RAW is set with -raw
+static UINT32 gFormat = ACPI_OUT_TEXT;
+static UINT32 gFormatFlags = 0;
+
+/*
+ * Function: int EvaluateMethod
+ *
+ * Description:
+ * Evaluates an ACPI method, in the priority class given with -priority if any.
+ *
+ * Parameters:
+ * acpiinput: Method of ACPI to evaluate
+ * buffer: Output buffer for the result
+ * buffer_size: Input size of buffer, output bytes returned
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code
+ */
+int EvaluateMethod(ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX *acpiinput, BYTE *buffer, size_t *buffer_size)
+{
+    size_t input_size = FIELD_OFFSET(ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX, Argument) + acpiinput->Size;
+
+    if(gPriority < EVAL_PRIORITY_COUNT) {
+        return EvaluateAcpiPriority(gPriority, (void *)acpiinput, input_size, buffer, buffer_size);
+    }
+    return EvaluateAcpi((void *)acpiinput, input_size, buffer, buffer_size);
+}
+
+/*
+ * Function: void DumpAcpi
+ *
+ * Description:
+ * The DumpAcpi function evaluates an ACPI method on a specified device and prints the results.
+ * It sends an IOCTL request to the device to execute the ACPI method and processes the returned data.
+ * Results are written in the format selected with -format, the raw output buffer only with -raw.
+ *
+ * Parameters:
+ * methodName: Method of ACPI to evaluate and dump
+ *
+ * Return Value:
+ * None.
+ */
+int DumpAcpi(ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX *acpiinput )
+{
+
+    // Size the output from what the method returned before, ACPI reports the size it needs if
+    // that is still too small
+    std::vector<BYTE> buffer(ACPI_OUTPUT_BUFFER_SIZE);
+    AcpiMethodInfo_t info;
+    if(GetAcpiMethodInfo(acpiinput->MethodName, &info) == ERROR_SUCCESS && info.output > buffer.size()) {
+        buffer.resize(info.output);
+    }
+
+    size_t buffer_size = buffer.size();
+
+    int status = EvaluateMethod(acpiinput, buffer.data(), &buffer_size);
+    if(status == ERROR_MORE_DATA && ((ACPI_EVAL_OUTPUT_BUFFER_V1 *)buffer.data())->Length > buffer.size()) {
+        buffer.resize(((ACPI_EVAL_OUTPUT_BUFFER_V1 *)buffer.data())->Length);
+        buffer_size = buffer.size();
+        status = EvaluateMethod(acpiinput, buffer.data(), &buffer_size);
+    }
+
+    // Machine readable output keeps stdout for results, failures are also written as a record
+    if(status != ERROR_SUCCESS) {
+        fprintf(gFormat == ACPI_OUT_TEXT ? stdout : stderr, "EvaluateAcpi failed, status: 0x%x\n", status);
+    }
+
+    // One buffered write of the whole result rather than a printf per value
+    acpiout::Writer out(stdout);
+    acpiout::Result(out, gFormat, gFormatFlags, acpiinput->MethodName, status, buffer.data(), buffer_size);
+    if(!out.Flush() && status == ERROR_SUCCESS) {
+        status = ERROR_WRITE_FAULT;
+    }
+
+    return status;
+}
+
+/*
+ * Function: int BenchAcpi
+ *
+ * Description:
+ * Evaluates an ACPI method repeatedly and prints round trip latency statistics measured with QPC.
+ * Used to compare changes on the async path, for example ectest -bench 100 \_SB.ECT0.ASYC
+ *
+ * Parameters:
+ * acpiinput: Method of ACPI to evaluate
+ * iterations: Number of times to evaluate the method
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code of the first failing evaluation
+ */
+int BenchAcpi(ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX *acpiinput, ULONG iterations)
+{
+    BYTE buffer[ACPI_OUTPUT_BUFFER_SIZE];
+    LARGE_INTEGER freq, start, end;
+    std::vector<double> samples;
+
+    QueryPerformanceFrequency(&freq);
+    samples.reserve(iterations);
+
+    for(ULONG i=0; i < iterations; i++) {
+        size_t buffer_size = sizeof(buffer);
+
+        QueryPerformanceCounter(&start);
+        int status = EvaluateMethod(acpiinput, buffer, &buffer_size);
+        QueryPerformanceCounter(&end);
+
+        if(status != ERROR_SUCCESS) {
+            printf("EvaluateAcpi failed on iteration %u, status: 0x%x\n", i, status);
+            return status;
+        }
+        samples.push_back((double)(end.QuadPart - start.QuadPart) * 1000000.0 / freq.QuadPart);
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double total = 0;
+    for(double sample : samples) {
+        total += sample;
+    }
+
+    printf("%s: %u iterations\n", acpiinput->MethodName, iterations);
+    printf("  min: %.1f us\n", samples.front());
+    printf("  avg: %.1f us\n", total / iterations);
+    printf("  p50: %.1f us\n", samples[iterations / 2]);
+    printf("  p99: %.1f us\n", samples[(iterations * 99) / 100]);
+    printf("  max: %.1f us\n", samples.back());
+
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: VOID PrintBenchStats
+ *
+ * Description:
+ * Prints the latency summary and log2 histogram of one target of an in-driver benchmark.
+ *
+ * Parameters:
+ * name: Target name to print
+ * stats: Statistics returned by the driver
+ *
+ * Return Value:
+ * None
+ */
+VOID PrintBenchStats(const char* name, const BenchStats_t* stats)
+{
+    double scale = 1000000.0 / stats->frequency;
+    UINT64 seen = 0;
+    UINT64 peak = 1;
+
+    printf("%s: %llu iterations, %llu failed", name, stats->count, stats->failures);
+    if(stats->failures != 0) {
+        printf(" (first status 0x%x)", stats->status);
+    }
+    printf("\n");
+    if(stats->count == 0) {
+        return;
+    }
+
+    printf("  min: %.1f us\n", stats->min * scale);
+    printf("  avg: %.1f us\n", (double)stats->total / stats->count * scale);
+    printf("  max: %.1f us\n", stats->max * scale);
+
+    for(UINT32 i = 0; i < BENCH_BUCKETS; i++) {
+        peak = max(peak, (UINT64)stats->buckets[i]);
+    }
+
+    // Percentiles are only known to the bucket, print the bucket they fall in
+    for(UINT32 i = 0; i < BENCH_BUCKETS; i++) {
+        if(stats->buckets[i] == 0) {
+            continue;
+        }
+        UINT64 before = seen;
+        seen += stats->buckets[i];
+        printf("  %7llu - %7llu us %8u %-40.*s%s%s\n", i == 0 ? 0 : 1ULL << i, 2ULL << i, stats->buckets[i],
+               (int)(stats->buckets[i] * 40 / peak), "########################################",
+               before * 2 < stats->count && seen * 2 >= stats->count ? " p50" : "",
+               before * 100 < stats->count * 99 && seen * 100 >= stats->count * 99 ? " p99" : "");
+    }
+}
+
+/*
+ * Function: int KernelBench
+ *
+ * Description:
+ * Runs an ACPI method, or the FF-A GET_CAPS direct request if acpiinput is NULL, inside the driver
+ * and prints the latency measured there. Unlike BenchAcpi this excludes the IOCTL path and
+ * scheduling in the app, so comparing both shows how much of the round trip is the EC.
+ *
+ * Parameters:
+ * acpiinput: Method of ACPI to evaluate, NULL for FF-A
+ * iterations: Number of times to evaluate the method
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code
+ */
+int KernelBench(ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX *acpiinput, ULONG iterations)
+{
+    size_t input_size = acpiinput ? FIELD_OFFSET(ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX, Argument) + acpiinput->Size : 0;
+    size_t req_size = BENCH_REQ_HEADER_SIZE + input_size;
+    std::unique_ptr<BYTE[]> buffer(new BYTE[req_size]());
+    auto* req = reinterpret_cast<BenchReq_t*>(buffer.get());
+    BenchRsp_t rsp;
+
+    req->targets = acpiinput ? BENCH_TARGET_ACPI : BENCH_TARGET_FFA;
+    req->iterations = iterations;
+    req->warmup = min(iterations / 10, 100UL);
+    req->inputsize = static_cast<UINT32>(input_size);
+    if(acpiinput) {
+        memcpy(req->input, acpiinput, input_size);
+    }
+
+    int status = RunDriverBench(req, req_size, &rsp);
+    if(status != ERROR_SUCCESS) {
+        printf("RunDriverBench failed, error: %d\n", status);
+        return status;
+    }
+
+    if(acpiinput) {
+        PrintBenchStats(acpiinput->MethodName, &rsp.acpi);
+    } else {
+        PrintBenchStats("FF-A GET_CAPS", &rsp.ffa);
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: VOID PrintPriorityStats
+ *
+ * Description:
+ * Prints queue depth, in flight count and average and worst wait and service time of each
+ * priority class and each target device shard in the driver, and the admission counters.
+ *
+ * Parameters:
+ * None
+ *
+ * Return Value:
+ * None
+ */
+VOID PrintPriorityStats()
+{
+    EvalPriorityStats_t stats[EVAL_PRIORITY_COUNT] = {0};
+    UINT32 count = EVAL_PRIORITY_COUNT;
+
+    int status = GetPriorityStats(stats, &count);
+    if(status != ERROR_SUCCESS) {
+        printf("GetPriorityStats failed, error: %d\n", status);
+        return;
+    }
+
+    printf("  %-8s %5s %8s %10s %7s %9s %9s %9s %9s\n", "Class", "Depth", "InFlight", "Dispatched", "Aged",
+           "Wait avg", "Wait max", "Svc avg", "Svc max");
+    for(UINT32 i = 0; i < count; i++) {
+        EvalPriorityStats_t *c = &stats[i];
+        printf("  %-8s %5u %8u %10llu %7llu %7.1fus %7.1fus %7.1fus %7.1fus\n", gPriorityNames[i], c->depth, c->inflight,
+               c->dispatched, c->aged,
+               c->dispatched ? c->waittotal / 10.0 / c->dispatched : 0.0, c->waitmax / 10.0,
+               c->completed ? c->servicetotal / 10.0 / c->completed : 0.0, c->servicemax / 10.0);
+    }
+
+    EvalShardStatsRsp_t shards = {0};
+    status = GetShardStats(&shards);
+    if(status != ERROR_SUCCESS) {
+        printf("GetShardStats failed, error: %d\n", status);
+        return;
+    }
+
+    printf("  Shards: %u In flight: %u of %u\n", shards.count, shards.inflight, shards.limit);
+    printf("  %-20s %5s %5s %8s %10s %8s %9s %9s %9s\n", "Device", "Limit", "Depth", "InFlight", "Dispatched",
+           "Deferred", "Wait avg", "Wait max", "Svc avg");
+    for(UINT32 i = 0; i < shards.count; i++) {
+        EvalShardStats_t *c = &shards.shards[i];
+        printf("  %-20.*s %5u %5u %8u %10llu %8llu %7.1fus %7.1fus %7.1fus\n",
+               EVAL_SHARD_PREFIX_LEN, c->prefix[0] ? c->prefix : "(shared)", c->limit, c->depth, c->inflight,
+               c->dispatched, c->deferred,
+               c->dispatched ? c->waittotal / 10.0 / c->dispatched : 0.0, c->waitmax / 10.0,
+               c->completed ? c->servicetotal / 10.0 / c->completed : 0.0);
+    }
+
+    AdmissionReq_t query = { ADMISSION_KEEP, ADMISSION_KEEP, ADMISSION_KEEP, 0 };
+    AdmissionRsp_t admission = {0};
+    status = ConfigureAdmission(&query, &admission);
+    if(status != ERROR_SUCCESS) {
+        printf("ConfigureAdmission failed, error: %d\n", status);
+        return;
+    }
+
+    printf("  Admission: %u outstanding, limits %u device %u client, retry %u ms\n", admission.outstanding,
+           admission.devicelimit, admission.clientlimit, admission.retryms);
+    printf("  Admitted: %llu Rejected: %llu device %llu client\n", admission.admitted, admission.rejecteddevice,
+           admission.rejectedclient);
+}
+
+/*
+ * Function: int FfaTelemetryTick
+ *
+ * Description:
+ * Reads a set of thermal zone temperatures and the battery state straight over FF-A with
+ * IOCTL_FFA_MUX, the way a periodic telemetry poll would, and prints how many direct requests
+ * the driver needed for them.
+ *
+ * Parameters:
+ * ULONG zones - Number of thermal zones to read, starting at TZID 0.
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code
+ */
+int FfaTelemetryTick(ULONG zones)
+{
+    const GUID thermal = { EC_SVC_THERMAL_UUID };
+    const GUID battery = { EC_SVC_BATTERY_UUID };
+    FfaMuxCommand_t commands[FFA_MUX_MAX_COMMANDS] = {0};
+    UINT32 count = 0;
+    UINT32 calls = 0;
+
+    zones = min(zones, (ULONG)(FFA_MUX_MAX_COMMANDS - 1));
+    for(ULONG i = 0; i < zones; i++) {
+        FfaMuxCommand_t *cmd = &commands[count++];
+        cmd->uuid = thermal;
+        cmd->inlen = EC_THM_TZID + 1;
+        cmd->outoff = EC_PAYLOAD_OUT;
+        cmd->outlen = sizeof(UINT32);
+        cmd->data[EC_PAYLOAD_CMD] = EC_THM_GET_TMP;
+        cmd->data[EC_THM_TZID] = (UINT8)i;
+    }
+
+    FfaMuxCommand_t *bst = &commands[count++];
+    bst->uuid = battery;
+    bst->inlen = EC_BAT_INDEX + 1;
+    bst->outoff = EC_PAYLOAD_OUT;
+    bst->outlen = 4 * sizeof(UINT32);
+    bst->data[EC_PAYLOAD_CMD] = EC_BAT_GET_BST;
+
+    int status = SendFfaCommands(commands, count, &calls);
+    if(status != ERROR_SUCCESS) {
+        printf("SendFfaCommands failed, error: %d\n", status);
+        return status;
+    }
+
+    for(ULONG i = 0; i < zones; i++) {
+        UINT32 value = 0;
+        memcpy(&value, commands[i].data, sizeof(value));
+        if(commands[i].status != 0) {
+            printf("  TZID %u: status 0x%x\n", i, commands[i].status);
+        } else {
+            printf("  TZID %u: %u\n", i, value);
+        }
+    }
+
+    if(bst->status != 0) {
+        printf("  Battery: status 0x%x\n", bst->status);
+    } else {
+        UINT32 fields[4];
+        memcpy(fields, bst->data, sizeof(fields));
+        printf("  Battery: state %u rate %u remaining %u voltage %u\n", fields[0], fields[1], fields[2], fields[3]);
+    }
+    printf("  %u commands in %u FF-A direct requests\n", count, calls);
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: int FanControl
+ *
+ * Description:
+ * Optionally sets the fan speed, then reads the whole fan state with one THRM._DSM evaluation,
+ * one FF-A request instead of one per variable.
+ *
+ * Parameters:
+ * const char *rpm - New FanCurrentRpm, or nullptr to only read.
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code
+ */
+int FanControl(const char *rpm)
+{
+    ecvar::FanState state = {};
+
+    if(rpm != nullptr) {
+        int status = ecvar::Set(std::make_tuple(ecvar::Rpm{ static_cast<UINT32>(strtoul(rpm, nullptr, 0)) }), ecvar::FanCurrentRpm);
+        if(status != ERROR_SUCCESS) {
+            printf("SetThermalVars failed, error: %d\n", status);
+            return status;
+        }
+    }
+
+    int status = ecvar::GetFanState(state);
+    if(status != ERROR_SUCCESS) {
+        printf("GetThermalVars failed, error: %d\n", status);
+        return status;
+    }
+
+    // Temperatures are in deci-Kelvin
+    printf("  On %.1f C Ramp %.1f C Max %.1f C\n", ((int)state.onTemp.value - 2732) / 10.0,
+           ((int)state.rampTemp.value - 2732) / 10.0, ((int)state.maxTemp.value - 2732) / 10.0);
+    printf("  RPM %u (min %u max %u)\n", state.currentRpm.value, state.minRpm.value, state.maxRpm.value);
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: VOID TemperatureChanged
+ *
+ * Description:
+ * Temperature subscription callback, prints the reading in Celsius and which threshold it is past.
+ *
+ * Parameters:
+ * UINT32 sensor: EC sensor ID
+ * UINT32 temperature: Temperature in deci-Kelvin
+ * UINT32 flags: TEMP_ALERT_* flags
+ * PVOID context: Not used
+ *
+ * Return Value:
+ * None
+ */
+VOID CALLBACK TemperatureChanged(UINT32 sensor, UINT32 temperature, UINT32 flags, PVOID context)
+{
+    UNREFERENCED_PARAMETER(context);
+    printf("  Sensor %u: %.1f C%s%s%s\n", sensor, ((int)temperature - 2732) / 10.0,
+           (flags & TEMP_ALERT_LOW) ? " below low" : "",
+           (flags & TEMP_ALERT_HIGH) ? " above high" : "",
+           (flags & TEMP_ALERT_POLLED) ? " (polled)" : "");
+}
+
+/*
+ * Function: int BulkCopy
+ *
+ * Description:
+ * Reads an EC object into a file or writes a file into one through the driver's pool of
+ * buffers shared with the EC, and prints the throughput.
+ *
+ * Parameters:
+ * op - EC_BULK_OP_READ or EC_BULK_OP_WRITE.
+ * object - Object name: log, history or fw.
+ * path - File to write the object to or read the object from, may be NULL for reads.
+ * length - Bytes to read, ignored for writes.
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code
+ */
+int BulkCopy(UINT8 op, const char *object, const char *path, UINT32 length)
+{
+    static const char *objects[] = { nullptr, "log", "history", "fw" };
+    UINT8 id = 0;
+    for(UINT8 i = EC_BULK_OBJ_LOG; i <= EC_BULK_OBJ_FIRMWARE; i++) {
+        if(_stricmp(object, objects[i]) == 0) {
+            id = i;
+        }
+    }
+    if(id == 0) {
+        printf("Invalid bulk object %s\n", object);
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    FILE *file = nullptr;
+    std::vector<BYTE> data;
+    if(op == EC_BULK_OP_WRITE) {
+        if(path == nullptr || fopen_s(&file, path, "rb") != 0) {
+            printf("Cannot open %s\n", path ? path : "");
+            return ERROR_FILE_NOT_FOUND;
+        }
+        fseek(file, 0, SEEK_END);
+        length = (UINT32)min((long)BULK_MAX_LENGTH, ftell(file));
+        fseek(file, 0, SEEK_SET);
+        data.resize(length);
+        length = (UINT32)fread(data.data(), 1, length, file);
+        fclose(file);
+    } else {
+        data.resize(length);
+    }
+
+    BulkRsp_t rsp = {0};
+    LARGE_INTEGER freq, start, end;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    int status = BulkTransfer(op, id, 0, data.data(), length, &rsp);
+    QueryPerformanceCounter(&end);
+    if(status != ERROR_SUCCESS) {
+        printf("BulkTransfer failed, error: %d\n", status);
+        return status;
+    }
+
+    double us = (double)(end.QuadPart - start.QuadPart) * 1000000.0 / freq.QuadPart;
+    printf("  %s %u of %u bytes, EC status %u\n", op == EC_BULK_OP_READ ? "Read" : "Wrote", rsp.length, rsp.total, rsp.status);
+    printf("  %u direct requests on pool buffer %u of %u bytes in %.1f us, %.1f MB/s\n", rsp.calls, rsp.buffer,
+           rsp.buffersize, us, rsp.length / us);
+
+    if(op == EC_BULK_OP_READ && path != nullptr) {
+        if(fopen_s(&file, path, "wb") != 0) {
+            printf("Cannot create %s\n", path);
+            return ERROR_FILE_NOT_FOUND;
+        }
+        fwrite(data.data(), 1, rsp.length, file);
+        fclose(file);
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: int PrintLogRecords
+ *
+ * Description:
+ * Prints the records of an EC log read. Timestamps are converted to host QueryPerformanceCounter
+ * seconds when the driver could read the EC clock, so they line up with host side traces.
+ *
+ * Parameters:
+ * rsp - Response of ReadEcLog.
+ *
+ * Return Value:
+ * Number of records printed
+ */
+int PrintLogRecords(const LogReadRsp_t *rsp)
+{
+    static const char levels[] = "?EWIV";
+    const double host = (double)rsp->hosttime / (double)rsp->hostfrequency;
+    ecring::LogRecord record;
+    int count = 0;
+
+    if(rsp->lost != 0) {
+        printf("  ... %llu bytes of EC log lost\n", (unsigned long long)rsp->lost);
+    }
+
+    for(UINT32 offset = 0; offset < rsp->length && record.Decode(rsp->data + offset, rsp->length - offset); offset += record.size) {
+        double seconds;
+        if(rsp->frequency != 0 && rsp->ectime != 0) {
+            seconds = host + (double)(INT64)(record.timestamp - rsp->ectime) / (double)rsp->frequency;
+        } else {
+            seconds = rsp->frequency != 0 ? (double)record.timestamp / (double)rsp->frequency : (double)record.timestamp;
+        }
+        printf("[%14.6f] %c %04x %s\n", seconds, levels[min(record.level, (UINT8)EC_LOG_LEVEL_VERBOSE)],
+               record.source, record.text.c_str());
+        count++;
+    }
+    return count;
+}
+
+/*
+ * Function: DWORD WINAPI LogFollowThread
+ *
+ * Description:
+ * Follows the EC log from the newest record on and prints every record until exit.
+ *
+ * Parameters:
+ * lpParam - Unused
+ *
+ * Return Value:
+ * 0
+ */
+DWORD WINAPI LogFollowThread(LPVOID lpParam)
+{
+    UNREFERENCED_PARAMETER(lpParam);
+
+    std::vector<BYTE> buffer(LOG_READ_RSP_HEADER_SIZE + LOG_READ_MAX_LENGTH);
+    LogReadRsp_t *rsp = (LogReadRsp_t *)buffer.data();
+    UINT64 cursor = 0;
+    UINT32 flags = LOG_READ_NEWEST;
+
+    // Short timeouts so the thread notices the exit event
+    while(WaitForSingleObject(gExitEvent, 0) != WAIT_OBJECT_0) {
+        int status = ReadEcLog(&cursor, flags, 250, rsp, buffer.size());
+        if(status != ERROR_SUCCESS) {
+            printf("ReadEcLog failed, error: %d\n", status);
+            break;
+        }
+        flags = 0;
+        PrintLogRecords(rsp);
+    }
+    return 0;
+}
+
+/*
+ * Function: int DumpEcLog
+ *
+ * Description:
+ * Prints every record still in the EC log ring, or starts a thread that follows the log.
+ *
+ * Parameters:
+ * follow - Keep printing new records until 'q'.
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code
+ */
+int DumpEcLog(BOOL follow)
+{
+    if(follow) {
+        gLogThread = CreateThread(NULL, 0, LogFollowThread, NULL, 0, NULL);
+        return gLogThread != NULL ? ERROR_SUCCESS : (int)GetLastError();
+    }
+
+    std::vector<BYTE> buffer(LOG_READ_RSP_HEADER_SIZE + LOG_READ_MAX_LENGTH);
+    LogReadRsp_t *rsp = (LogReadRsp_t *)buffer.data();
+    UINT64 cursor = 0;
+    int total = 0;
+    int status;
+
+    do {
+        status = ReadEcLog(&cursor, LOG_READ_NOWAIT, 0, rsp, buffer.size());
+        if(status != ERROR_SUCCESS) {
+            printf("ReadEcLog failed, error: %d\n", status);
+            return status;
+        }
+        total += PrintLogRecords(rsp);
+    } while(rsp->records != 0);
+
+    printf("  %d records, next position 0x%llx\n", total, (unsigned long long)cursor);
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: int ListMethods
+ *
+ * Description:
+ * Prints the methods eclib knows about, optionally walking the ACPI namespace below the device
+ * first so missing methods are rejected without a round trip.
+ *
+ * Parameters:
+ * discover - Run DiscoverAcpiMethods before printing.
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code
+ */
+int ListMethods(BOOL discover)
+{
+    UINT32 present = 0;
+    UINT32 absent = 0;
+    UINT32 count = 0;
+    int status;
+
+    if(discover) {
+        status = DiscoverAcpiMethods(&present, &absent);
+        if(status != ERROR_SUCCESS) {
+            printf("DiscoverAcpiMethods failed, error: %d\n", status);
+            return status;
+        }
+        printf("  Found %u methods, %u in the ASL are missing\n", present, absent);
+    }
+
+    EnumAcpiMethods(nullptr, &count);
+    std::vector<AcpiMethodInfo_t> methods(count);
+    status = EnumAcpiMethods(methods.data(), &count);
+    if(status != ERROR_SUCCESS) {
+        printf("EnumAcpiMethods failed, error: %d\n", status);
+        return status;
+    }
+
+    std::sort(methods.begin(), methods.end(), [](const AcpiMethodInfo_t& a, const AcpiMethodInfo_t& b) {
+        return strcmp(a.path, b.path) < 0;
+    });
+
+    printf("  %-24s %4s %7s %6s\n", "Method", "Args", "State", "Output");
+    for(const AcpiMethodInfo_t& m : methods) {
+        char args[8] = "?";
+        if(m.argc != ACPI_METHOD_ARGC_UNKNOWN) {
+            sprintf_s(args, sizeof(args), "%u%s", m.argc, (m.flags & ACPI_METHOD_ARGC_MISMATCH) ? "!" : "");
+        }
+        printf("  %-24s %4s %7s %6u\n", m.path, args,
+               (m.flags & ACPI_METHOD_PRESENT) ? "present" : (m.flags & ACPI_METHOD_ABSENT) ? "missing" : "-",
+               m.output);
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: int ShareResults
+ *
+ * Description:
+ * Samples the methods for every process on the host through the shared result segment, or
+ * waits to take over if another process already samples them.
+ *
+ * Parameters:
+ * period - Milliseconds between samples of each method.
+ * count - Number of methods.
+ * methods - Methods that take no arguments.
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code
+ */
+int ShareResults(UINT32 period, UINT32 count, char *methods[])
+{
+    SharedSeries_t series[SHARED_SERIES_MAX];
+    BOOL owner = FALSE;
+
+    for(UINT32 i = 0; i < count; i++) {
+        series[i].method = methods[i];
+        series[i].period_ms = period;
+    }
+
+    int status = StartResultShare(series, count, &owner);
+    if(status != ERROR_SUCCESS) {
+        printf("StartResultShare failed, error: %d\n", status);
+        return status;
+    }
+    gShareStarted = TRUE;
+    printf("  %s\n", owner ? "Sampling for all processes" : "Another process is sampling, waiting to take over");
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: int PrintSharedResults
+ *
+ * Description:
+ * Prints the latest sample of every method in the shared result segment without evaluating
+ * anything. Works while another ectest instance is running.
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code
+ */
+int PrintSharedResults()
+{
+    SharedResult_t results[SHARED_SERIES_MAX];
+    UINT32 count = SHARED_SERIES_MAX;
+
+    int status = EnumSharedResults(results, &count);
+    if(status != ERROR_SUCCESS) {
+        printf("EnumSharedResults failed, error: %d\n", status);
+        return status;
+    }
+
+    UINT64 now = GetTickCount64();
+    printf("  Owner: %u\n", count > 0 ? results[0].owner : 0);
+    printf("  %-24s %6s %8s %8s %6s  %s\n", "Method", "Period", "Age", "Samples", "Status", "Value");
+    for(UINT32 i = 0; i < count; i++) {
+        const SharedResult_t *r = &results[i];
+        printf("  %-24s %4ums %6llums %8u %6d  ", r->method, r->period_ms,
+               r->timestamp != 0 ? (unsigned long long)(now - r->timestamp) : 0ULL, r->samples, r->status);
+        if(r->status != ERROR_SUCCESS) {
+            printf("-\n");
+        } else if(r->type == ACPI_VIEW_TYPE_STRING) {
+            printf("'%.*s'\n", (int)r->length, (const char *)r->data);
+        } else if(r->type == ACPI_VIEW_TYPE_INTEGER || r->type == ACPI_VIEW_TYPE_PACKAGE ||
+                  r->type == ACPI_VIEW_TYPE_PACKAGE_EX) {
+            for(UINT32 j = 0; j + sizeof(UINT64) <= r->length; j += sizeof(UINT64)) {
+                UINT64 value;
+                memcpy(&value, r->data + j, sizeof(value));
+                printf("0x%llx ", (unsigned long long)value);
+            }
+            printf("\n");
+        } else {
+            for(UINT32 j = 0; j < r->length; j++) {
+                printf("%02x", r->data[j]);
+            }
+            printf("\n");
+        }
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: int ReplaySession
+ *
+ * Description:
+ * Sends the evaluations and FF-A requests of a recording to the device again and prints how the
+ * results and times compare with the recording.
+ *
+ * Parameters:
+ * file - Recording made with -record.
+ * speed - Percent of the recorded pace, 0 sends each call as soon as the last one returns.
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code
+ */
+int ReplaySession(const char *file, UINT32 speed)
+{
+    ReplayStats_t stats;
+
+    int status = ReplayRecording(file, speed, &stats);
+    if(status != ERROR_SUCCESS) {
+        printf("ReplayRecording failed, error: %d\n", status);
+        return status;
+    }
+
+    printf("  %llu records: %llu evaluations, %llu FF-A commands, %llu notifications not raised%s\n",
+           stats.records, stats.evaluations, stats.commands, stats.notifications,
+           stats.truncated ? ", recording cut short" : "");
+    printf("  Different status: %llu Different output: %llu\n", stats.statusdiffs, stats.outputdiffs);
+    printf("  Call time: recorded %llu us replayed %llu us, at most %llu us behind schedule\n",
+           stats.recordedus, stats.replayedus, stats.maxlateus);
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: int StopSession
+ *
+ * Description:
+ * Closes the recording started with -record and prints its size.
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code
+ */
+int StopSession()
+{
+    RecordStats_t stats;
+
+    int status = StopRecording(&stats);
+    if(status != ERROR_SUCCESS) {
+        printf("StopRecording failed, error: %d\n", status);
+        return status;
+    }
+
+    printf("Recorded %llu records in %llu bytes", stats.records, stats.bytes);
+    if(stats.dropped != 0) {
+        printf(", %llu lost to write errors", stats.dropped);
+    }
+    printf("\n");
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: int StopTracing
+ *
+ * Description:
+ * Closes the trace started with -trace and prints what it holds.
+ *
+ * Return Value:
+ * ERROR_SUCCESS or failure code
+ */
+int StopTracing()
+{
+    TraceStats_t stats;
+
+    int status = StopTrace(&stats);
+    if(status != ERROR_SUCCESS) {
+        printf("StopTrace failed, error: %d\n", status);
+        return status;
+    }
+
+    printf("Traced %llu calls and %llu driver events in %llu bytes", stats.calls, stats.driverevents, stats.bytes);
+    if(!stats.driver) {
+        printf(", driver has no timeline");
+    }
+    if(stats.lost != 0) {
+        printf(", %llu driver events lost", stats.lost);
+    }
+    if(stats.writefailed) {
+        printf(", write failed");
+    }
+    printf("\n");
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: int CharToGUID
+ *
+ * Description:
+ * This function converts an ASCII character to corresponding hex value or returns 0 if invalid
+ *
+ * Parameters:
+ * out: Output BYTE array that contains GUID values
+ * out_len: Length of output buffer must be at least 16 bytes
+ * guid: Input pointer to char * of string representation of GUID
+ * guid_len: Must be 39 bytes including terminating \0
+ *
+ * Return Value:
+ * ERROR_SUCESS or failure code
+ */
+int CharToGUID(BYTE *out, size_t out_len, char *guid, size_t guid_len)
+{
+    // Make sure in and out buffers are lengths and format we expect
+    if(out_len < 16 || guid_len != 39) {
+        return ERROR_INVALID_PARAMETER;
+    }
+    
+    // Convert char* to wide string
+    wchar_t wideGuidStr[39]; // GUID string is 38 chars + null terminator
+    size_t bytesReturned = 0;
+    int status = mbstowcs_s(&bytesReturned, wideGuidStr, guid, guid_len);
+    if( status != ERROR_SUCCESS) {
+        return status;
+    }
+
+    IID uuid;
+    HRESULT hr = IIDFromString(wideGuidStr, &uuid);
+
+    if (SUCCEEDED(hr)) {
+        // Copy data to guid buffer
+        memcpy(out, &uuid, sizeof(IID));
+    } else {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: int BuildRequest
+ *
+ * Description:
+ * Builds the ACPI input for a method and its command line arguments in an arena. An argument
+ * starting with [ opens a package before its value and one ending with ] closes it after, a lone
+ * [ or ] works too, so [3032 [1 2] 'Name'] is a package holding an integer, a nested package and
+ * a string.
+ *
+ * Parameters:
+ * req: Builder state, the request is at req->arena on success
+ * arena: Memory to build the request in
+ * capacity: Bytes at arena
+ * method: ACPI method path
+ * argc: Number of arguments following the method
+ * argv: Arguments following the method
+ * verbose: Print each converted argument
+ * length: Receives the request length, or the arena size needed on ERROR_INSUFFICIENT_BUFFER
+ *
+ * Return Value:
+ * ERROR_SUCCESS, ERROR_INSUFFICIENT_BUFFER or failure code
+ */
+int BuildRequest(
+    _Out_ AcpiRequest_t *req,
+    _In_ BYTE *arena,
+    _In_ size_t capacity,
+    _In_ char *method,
+    _In_ int argc,
+    _In_ char **argv,
+    _In_ bool verbose,
+    _Out_ size_t *length
+    )
+{
+    char value[MAX_STRING_LEN];
+    BYTE data[MAX_STRING_LEN / 2];
+
+    AcpiRequestBegin(req, arena, capacity, method);
+
+    // Loop through each remaining parameters and convert to correct type
+    for(int i=0; i < argc; i++) {
+        char *carg = argv[i];
+        size_t str_len = strlen(carg);
+        size_t close = 0;
+
+        while(carg[0] == '[') {
+            if(verbose) {
+                printf("Package begin\n");
+            }
+            AcpiRequestPackage(req);
+            carg++;
+            str_len--;
+        }
+        while(str_len > 0 && carg[str_len-1] == ']') {
+            close++;
+            str_len--;
+        }
+
+        // Make sure this parameter will fit the conversion buffers
+        if(str_len >= sizeof(value)) {
+            printf("Parameters too long\n");
+            return ERROR_INVALID_PARAMETER;
+        }
+        memcpy(value, carg, str_len);
+        value[str_len] = '\0';
+
+        if(str_len == 0) {
+            // Only opened or closed packages
+        } else if(value[0] == '{') {
+            // GUID must be in this exact format {25cb5207-ac36-427d-aaef-3aa78877d27e}
+            int status = CharToGUID(data, 16, value, str_len+1); // Include terminating \0 in length
+            if(status != ERROR_SUCCESS) {
+                printf("Failed to convert GUID\n");
+                printf("Please provide GUID in this format: {25cb5207-ac36-427d-aaef-3aa78877d27e}\n");
+                return status;
+            }
+            if(verbose) {
+                // Print out the GUID
+                printf("Converted GUID: {");
+                for(size_t j=0; j < 16; j++) {
+                    printf("0x%x,", data[j]);
+                }
+                printf("}\n");
+            }
+            AcpiRequestBuffer(req, data, 16);
+
+        } else if(value[0] == '#') {
+            // Buffer of hex byte pairs
+            size_t count = (str_len - 1) / 2;
+            for(size_t j=0; j < count; j++) {
+                char byte[3] = { value[1 + j*2], value[2 + j*2], '\0' };
+                char *endptr = nullptr;
+                data[j] = static_cast<BYTE>(strtoul(byte, &endptr, 16));
+                if(endptr != byte + 2) {
+                    count = 0;
+                    break;
+                }
+            }
+            if(count == 0 || (str_len - 1) % 2 != 0) {
+                printf("Failed to convert buffer, use hex byte pairs: #0102A0FF\n");
+                return ERROR_INVALID_PARAMETER;
+            }
+            if(verbose) {
+                printf("Converted Buffer of %zu bytes\n", count);
+            }
+            AcpiRequestBuffer(req, data, count);
+
+        } else if(value[0] == '\'') {
+            // Pull off the start and ending ' '
+            value[str_len-1] = '\0';
+            if(verbose) {
+                printf("Converting to String: %s\n", &value[1]);
+            }
+            AcpiRequestString(req, &value[1]);
+
+        } else {
+            char *endptr = nullptr;
+            UINT32 number = strtol(value, &endptr, 0); // Try to guess the base
+            if(endptr == value) {
+                printf("Failed to convert number\n");
+                return ERROR_INVALID_PARAMETER;
+            }
+            if(verbose) {
+                printf("Converted to Number: 0x%x\n", number);
+            }
+            AcpiRequestInteger(req, number);
+        }
+
+        while(close-- > 0) {
+            if(verbose) {
+                printf("Package end\n");
+            }
+            AcpiRequestEndPackage(req);
+        }
+    }
+
+    int status = AcpiRequestEnd(req, length);
+    if(status == ERROR_INVALID_PARAMETER) {
+        // ACPI function cannot accept more than 7 arguments
+        printf("Exceeded 7 ACPI arguments, unmatched [ ] or packages nested too deep!\n");
+    }
+    return status;
+}
+
+/*
+ * Function: int ParseCmdline
+ *
+ * Description:
+ * The ParseCmdline function parses the command line arguments and sets the ACPI method name if provided.
+ * It checks the number of arguments and prints usage instructions if the required arguments are not provided.
+ *
+ * Parameters:
+ * int argc: The number of command line arguments.
+ * char **argv: The array of command line arguments.
+ *
+ * Return Value:
+ * Returns ERROR_SUCCESS if the ACPI method name is successfully set, otherwise returns ERROR_INVALID_PARAMETER.
+ */
+int ParseCmdline(
+    _In_ int argc,
+    _In_ char ** argv
+    )
+{
+
+    ULONG iterations = 0;
+    BOOL kernel = FALSE;
+
+    // -record writes every call the rest of the command line makes, and notifications, to a file
+    if( argc > 3 && _stricmp(argv[1], "-record") == 0 ) {
+        int status = StartRecording(argv[2]);
+        if( status != ERROR_SUCCESS ) {
+            printf("StartRecording failed, error: %d\n", status);
+            return status;
+        }
+        gRecording = TRUE;
+        argc -= 2;
+        argv += 2;
+    }
+
+    // -trace writes every call the rest of the command line makes, with the driver timestamps of
+    // each request, for tools\ectrace.py to convert
+    if( argc > 3 && _stricmp(argv[1], "-trace") == 0 ) {
+        int status = StartTrace(argv[2]);
+        if( status != ERROR_SUCCESS ) {
+            printf("StartTrace failed, error: %d\n", status);
+            return status;
+        }
+        gTracing = TRUE;
+        argc -= 2;
+        argv += 2;
+    }
+
+    // -replay sends the calls of a recording again and compares the results
+    if( argc >= 3 && argc <= 4 && _stricmp(argv[1], "-replay") == 0 ) {
+        return ReplaySession(argv[2], argc > 3 ? strtoul(argv[3], nullptr, 0) : REPLAY_SPEED_ORIGINAL);
+    }
+
+    // -admission only configures the driver, counters are printed with 'p'
+    if( argc == 5 && _stricmp(argv[1], "-admission") == 0 ) {
+        AdmissionReq_t req = {0};
+        AdmissionRsp_t rsp = {0};
+        req.devicelimit = strtoul(argv[2], nullptr, 0);
+        req.clientlimit = strtoul(argv[3], nullptr, 0);
+        req.retryms = strtoul(argv[4], nullptr, 0);
+        int status = ConfigureAdmission(&req, &rsp);
+        if( status != ERROR_SUCCESS ) {
+            printf("ConfigureAdmission failed, error: %d\n", status);
+        }
+        return status;
+    }
+
+    // -priority selects the driver queue of the evaluations that follow it
+    if( argc > 3 && _stricmp(argv[1], "-priority") == 0 ) {
+        for(UINT32 i = 0; i < EVAL_PRIORITY_COUNT; i++) {
+            if( _stricmp(argv[2], gPriorityNames[i]) == 0 ) {
+                gPriority = i;
+            }
+        }
+        if( gPriority == EVAL_PRIORITY_COUNT ) {
+            printf("Invalid priority class %s\n", argv[2]);
+            return ERROR_INVALID_PARAMETER;
+        }
+        argc -= 2;
+        argv += 2;
+    }
+
+    // -format writes -acpi results for scripts, json, jsonl, csv or the raw output buffer with bin
+    if( argc > 3 && _stricmp(argv[1], "-format") == 0 ) {
+        gFormat = acpiout::ParseFormat(argv[2]);
+        if( gFormat == ACPI_OUT_COUNT ) {
+            printf("Invalid output format %s\n", argv[2]);
+            return ERROR_INVALID_PARAMETER;
+        }
+        if( gFormat == ACPI_OUT_BIN ) {
+            _setmode(_fileno(stdout), _O_BINARY);
+        }
+        argc -= 2;
+        argv += 2;
+    }
+
+    // -raw also writes the whole output buffer in hex, in any format
+    if( argc > 2 && _stricmp(argv[1], "-raw") == 0 ) {
+        gFormatFlags |= ACPI_OUT_RAW;
+        argc--;
+        argv++;
+    }
+
+    // -mux reads a telemetry set over FF-A, packed by the driver into as few requests as possible
+    if( argc >= 2 && argc <= 3 && _stricmp(argv[1], "-mux") == 0 ) {
+        return FfaTelemetryTick(argc > 2 ? strtoul(argv[2], nullptr, 0) : 4);
+    }
+
+    // -fan reads every fan variable in one request, with an RPM it sets the fan speed first
+    if( argc >= 2 && argc <= 3 && _stricmp(argv[1], "-fan") == 0 ) {
+        return FanControl(argc > 2 ? argv[2] : nullptr);
+    }
+
+    // -subscribe prints SKIN temperature changes until 'q', thresholds are in deci-Kelvin
+    if( argc >= 4 && argc <= 5 && _stricmp(argv[1], "-subscribe") == 0 ) {
+        UINT32 low = strtoul(argv[2], nullptr, 0);
+        UINT32 high = strtoul(argv[3], nullptr, 0);
+        UINT32 hysteresis = argc > 4 ? strtoul(argv[4], nullptr, 0) : 0;
+        int status = SubscribeTemperature(2, low, high, hysteresis, TemperatureChanged, nullptr, &gSubscription);
+        if( status != ERROR_SUCCESS ) {
+            printf("SubscribeTemperature failed, error: %d\n", status);
+        }
+        return status;
+    }
+
+    // -prefetch evaluates the methods as soon as the event arrives, results print with it until 'q'
+    if( argc >= 4 && argc <= 3 + PREFETCH_RULE_MAX && _stricmp(argv[1], "-prefetch") == 0 ) {
+        PrefetchRule_t rules[PREFETCH_RULE_MAX] = {0};
+        UINT32 count = (UINT32)(argc - 3);
+        for(UINT32 i = 0; i < count; i++) {
+            rules[i].event = strtoul(argv[2], nullptr, 0);
+            rules[i].method = argv[3 + i];
+            gPrefetchMethods[i] = argv[3 + i];
+        }
+        int status = SetPrefetchRules(rules, count);
+        if( status != ERROR_SUCCESS ) {
+            printf("SetPrefetchRules failed, error: %d\n", status);
+        }
+        return status;
+    }
+
+    // -bulk moves an EC object through the pre-shared buffer pool
+    if( argc >= 4 && argc <= 6 && _stricmp(argv[1], "-bulk") == 0 ) {
+        if( _stricmp(argv[2], "write") == 0 && argc == 5 ) {
+            return BulkCopy(EC_BULK_OP_WRITE, argv[3], argv[4], 0);
+        }
+        UINT32 length = argc > 4 ? strtoul(argv[4], nullptr, 0) : 0x10000;
+        if( _stricmp(argv[2], "read") != 0 || length == 0 || length > BULK_MAX_LENGTH ) {
+            printf("Invalid bulk transfer\n");
+            return ERROR_INVALID_PARAMETER;
+        }
+        return BulkCopy(EC_BULK_OP_READ, argv[3], argc > 5 ? argv[5] : nullptr, length);
+    }
+
+    // -methods prints the method cache, -methods discover walks the namespace first
+    if( argc >= 2 && argc <= 3 && _stricmp(argv[1], "-methods") == 0 ) {
+        return ListMethods(argc > 2 && _stricmp(argv[2], "discover") == 0);
+    }
+
+    // -share samples the methods for every process on the host until 'q'
+    if( argc >= 4 && argc <= 3 + SHARED_SERIES_MAX && _stricmp(argv[1], "-share") == 0 ) {
+        return ShareResults(strtoul(argv[2], nullptr, 0), (UINT32)(argc - 3), &argv[3]);
+    }
+
+    // -log prints what the EC log ring holds, -log follow keeps printing until 'q'
+    if( argc >= 2 && argc <= 3 && _stricmp(argv[1], "-log") == 0 ) {
+        return DumpEcLog(argc > 2 && _stricmp(argv[2], "follow") == 0);
+    }
+
+    // -coalesce only configures the driver, notifications are printed until 'q'
+    if( argc == 4 && _stricmp(argv[1], "-coalesce") == 0 ) {
+        UINT32 event = _stricmp(argv[2], "all") == 0 ? NOTIFY_EVENT_ALL : strtoul(argv[2], nullptr, 0);
+        UINT32 window = strtoul(argv[3], nullptr, 0);
+        int status = SetNotificationCoalescing(event, window);
+        if( status != ERROR_SUCCESS ) {
+            printf("SetNotificationCoalescing failed, error: %d\n", status);
+        }
+        return status;
+    }
+
+    // -generate starts a synthetic notification run, results are printed with 'g'
+    if( argc >= 4 && argc <= 9 && _stricmp(argv[1], "-generate") == 0 ) {
+        GeneratorReq_t req = {0};
+        GeneratorRsp_t rsp = {0};
+        req.rate = strtoul(argv[2], nullptr, 0);
+        req.duration = strtoul(argv[3], nullptr, 0);
+        req.firstevent = (UINT8)(argc > 4 ? strtoul(argv[4], nullptr, 0) : 0x80);
+        req.lastevent = (UINT8)(argc > 5 ? strtoul(argv[5], nullptr, 0) : req.firstevent);
+        req.distribution = (UINT8)(argc > 6 ? strtoul(argv[6], nullptr, 0) : GENERATOR_DIST_ROUND_ROBIN);
+        req.burston = argc > 7 ? strtoul(argv[7], nullptr, 0) : 0;
+        req.burstoff = argc > 8 ? strtoul(argv[8], nullptr, 0) : 0;
+        int status = ControlGenerator(&req, &rsp);
+        if( status != ERROR_SUCCESS ) {
+            printf("ControlGenerator failed, error: %d\n", status);
+        } else if( req.rate != 0 ) {
+            printf("Generator run %u started at %u/s for %u ms\n", rsp.run, req.rate, req.duration);
+        }
+        return status;
+    }
+
+    // -bench and -kbench take an iteration count before the method name, or ffa for -kbench
+    if( argc > 2 && (_stricmp(argv[1], "-bench") == 0 || _stricmp(argv[1], "-kbench") == 0) ) {
+        kernel = _stricmp(argv[1], "-kbench") == 0;
+        iterations = strtoul(argv[2], nullptr, 0);
+        argc--;
+        argv++;
+        if( iterations == 0 ) {
+            printf("Invalid iteration count\n");
+            return ERROR_INVALID_PARAMETER;
+        }
+        if( kernel && argc == 3 && _stricmp(argv[2], "ffa") == 0 ) {
+            return KernelBench(nullptr, iterations);
+        }
+    }
+
+    // Must always have at least 3 parameters
+    if( argc < CMD_MIN_ARG_COUNT ) {
+        printf("Usage:\n");
+        printf("    ectest.exe                        --- Print this help\n");
+        printf("    ectest.exe -acpi \\_SB.ECT0.NEVT  --- Evaluate given ACPI method with no arguments\n");
+        printf("    ectest.exe -acpi \\_SB.ECT0.TDSM {07ff6382-e29a-47c9-ac87-e79dad71dd82} 1 3 0\n");
+        printf("    ectest.exe -acpi \\_SB.SKIN.THRS 2 [1000 3032 3132] --- Package arguments in [ ], may nest\n");
+        printf("    ectest.exe -bench 100 \\_SB.ECT0.ASYC  --- Evaluate method 100 times and print latency\n");
+        printf("    ectest.exe -kbench 100 \\_SB.ECT0.ASYC --- Same timed inside the driver, 'ffa' for FF-A GET_CAPS\n");
+        printf("    ectest.exe -priority critical -acpi \\_SB.SKIN._TMP --- Evaluate in a driver priority class: critical, normal, bulk\n");
+        printf("    ectest.exe -format jsonl -acpi \\_SB.ECT0.NEVT --- Write the result as json, jsonl, csv or bin and exit\n");
+        printf("    ectest.exe -raw -acpi \\_SB.ECT0.NEVT --- Also print the raw output buffer, after -format if both are given\n");
+        printf("    ectest.exe -admission 64 16 5     --- Limit queued evaluations to 64 per device, 16 per process, 5ms retry\n");
+        printf("    ectest.exe -mux 4                 --- Read 4 thermal zones and the battery over FF-A in one packed request per service\n");
+        printf("    ectest.exe -fan [rpm]             --- Read the fan state in one FF-A request, optionally set the RPM first\n");
+        printf("    ectest.exe -subscribe 3032 3132 [10] --- Print SKIN temperature crossing 30C or 40C, or moving by 1C\n");
+        printf("    ectest.exe -prefetch 0x20 \\_SB.SKIN._TMP \\_SB.ECT0.NEVT --- Evaluate methods as soon as event 0x20 arrives\n");
+        printf("    ectest.exe -bulk read log 0x40000 [file] --- Read 256KB of the EC log through the shared buffer pool\n");
+        printf("    ectest.exe -bulk write fw image.bin --- Write a file to the EC firmware staging area\n");
+        printf("    ectest.exe -log [follow]          --- Print the EC log ring, 'follow' keeps printing new records\n");
+        printf("    ectest.exe -methods [discover]    --- Print known ACPI methods, 'discover' finds which exist below the device\n");
+        printf("    ectest.exe -share 1000 \\_SB.SKIN._TMP \\_SB.ECT0.NEVT --- Sample methods every 1000ms for all processes\n");
+        printf("    ectest.exe -shared                --- Print the latest shared samples, works while another instance runs\n");
+        printf("    ectest.exe -record s.ecr -mux 4   --- Record the calls and notifications of the rest of the command line\n");
+        printf("    ectest.exe -replay s.ecr [200]    --- Send the calls of a recording again at a percent of its pace, 0 untimed\n");
+        printf("    ectest.exe -trace t.ect -bench 100 \\_SB.ECT0.ASYC --- Trace the calls of the rest of the command line through the driver\n");
+        printf("    ectest.exe -coalesce 0x20 5000    --- Fold repeats of event 0x20 within 5ms, 'all' for every event\n");
+        printf("    ectest.exe -generate 10000 5000 [first last dist on_ms off_ms]  --- Raise 10000 synthetic events/s for 5s\n");
+        printf("               GUID - {xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}\n");
+        printf("            Integer - 0x123ABC 1234 -1234\n");
+        printf("             String - \'TestString\'\n");
+        printf("             Buffer - #0102A0FF\n");
+        printf("            Package - [1 \'Two\' [3 4]]\n");
+
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    // Requests are built in a stack arena, one that does not fit is sized exactly and built again
+    alignas(8) BYTE arena[ACPI_REQUEST_ARENA_SIZE];
+    std::unique_ptr<BYTE[]> large;
+    AcpiRequest_t req;
+    size_t length = 0;
+
+    int status = BuildRequest(&req, arena, sizeof(arena), argv[2],
+                              argc - CMD_MIN_ARG_COUNT, &argv[CMD_MIN_ARG_COUNT], true, &length);
+    if(status == ERROR_INSUFFICIENT_BUFFER) {
+        large.reset(new BYTE[length]); // Throws exception if it fails, auto frees
+        status = BuildRequest(&req, large.get(), length, argv[2],
+                              argc - CMD_MIN_ARG_COUNT, &argv[CMD_MIN_ARG_COUNT], false, &length);
+    }
+    if(status != ERROR_SUCCESS) {
+        return status;
+    }
+
+    auto* params = reinterpret_cast<ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX*>(req.arena);
+    if( gFormat == ACPI_OUT_TEXT ) {
+        printf("Signature: 0x%x\n", params->Signature);
+    }
+
+    // Evaluate and dump output
+    if( iterations != 0 ) {
+        return kernel ? KernelBench(params, iterations) : BenchAcpi(params, iterations);
+    }
+    return DumpAcpi(params);
+}
+
+/*
+ * Function: int ReadRxBuffer
+ *
+ * Description:
+ * The ReadRxBuffer function reads the receive buffer from a Kernel-Mode Driver Framework (KMDF) driver.
+ * It sends a request to the driver and receives the buffer data.
+ *
+ * Parameters:
+ * HANDLE hDevice: A handle to the device from which the receive buffer is to be read.
+ *
+ * Return Value:
+ * Returns ERROR_SUCCESS if the receive buffer is successfully read, otherwise returns ERROR_INVALID_PARAMETER.
+ */
+#ifdef EC_TEST_SHARED_BUFFER
+int ReadRxBuffer(
+    _In_ HANDLE hDevice
+    )
+{
+    BOOL bRc;
+    ULONG bytesReturned;
+    ULONG inbuf;
+    RxBufferRsp_t rxrsp;
+
+    printf("\nCalling DeviceIoControl IOCTL_GET_RX_BUFFER\n");
+
+    bRc = DeviceIoControl ( hDevice,
+                            (DWORD) IOCTL_READ_RX_BUFFER,
+                            &inbuf,
+                            sizeof(inbuf),
+                            &rxrsp,
+                            sizeof(rxrsp),
+                            &bytesReturned,
+                            NULL
+                            );
+
+    if ( !bRc )
+    {
+        printf ( "***       Error in DeviceIoControl : %d \n", GetLastError());
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    // Print out notification details
+    printf("***                 data: 0x%llx\n", rxrsp.data);
+
+    return ERROR_SUCCESS;
+}
+#endif // EC_TEST_SHARED_BUFFER
+
+#ifdef EC_TEST_NOTIFICATIONS
+/*
+ * Function: VOID PrintNotificationPayload
+ *
+ * Description:
+ * Prints the EC event and payload items the driver attached to a notification.
+ *
+ * Parameters:
+ * NotificationRsp_t* rsp: Notification response returned by WaitForNotificationEx
+ * size_t rsp_len: Number of valid bytes in rsp
+ *
+ * Return Value:
+ * None
+ */
+VOID PrintNotificationPayload(NotificationRsp_t* rsp, size_t rsp_len)
+{
+    size_t size = min((size_t)rsp->payloadsize, rsp_len - NOTIFICATION_RSP_HEADER_SIZE);
+    size_t offset = 0;
+
+    printf("  EC Event: 0x%x Payload: %u of %u bytes\n", rsp->ecevent, rsp->payloadsize, rsp->payloadtotal);
+    if(rsp->occurrences > 1) {
+        printf("  Coalesced: %u occurrences over %llu us\n", rsp->occurrences, (rsp->timestamp - rsp->firsttimestamp) / 10);
+    }
+
+    while(offset + sizeof(NotificationItem_t) <= size) {
+        NotificationItem_t* item = (NotificationItem_t*)(rsp->payload + offset);
+        BYTE* data = (BYTE*)(item + 1);
+        if(offset + NOTIFY_ITEM_SIZE(item->length) > size) {
+            break;
+        }
+
+        if(item->type == NOTIFY_PAYLOAD_RX_HEADERS) {
+            UINT64* headers = (UINT64*)data;
+            for(UINT16 i = 0; i < item->length / sizeof(UINT64); i++) {
+                if(headers[i] != 0) {
+                    printf("  RX Slot %u: SEQ 0x%llx LEN 0x%llx\n", i, EC_SLOT_SEQ(headers[i]), EC_SLOT_LEN(headers[i]));
+                }
+            }
+        } else if(item->type == NOTIFY_PAYLOAD_EVENT_DATA) {
+            printf("  Event Data:");
+            for(UINT16 i = 0; i < item->length; i++) {
+                printf(" %02x", data[i]);
+            }
+            printf("\n");
+        }
+        offset += NOTIFY_ITEM_SIZE(item->length);
+    }
+}
+
+/*
+ * Function: VOID PrintEventCounters
+ *
+ * Description:
+ * Prints the driver's counters for every event that has occurred or has a coalescing window.
+ *
+ * Parameters:
+ * None
+ *
+ * Return Value:
+ * None
+ */
+VOID PrintEventCounters()
+{
+    std::vector<EventCounter_t> counters(NOTIFY_EVENT_COUNT);
+    UINT32 count = NOTIFY_EVENT_COUNT;
+
+    int status = GetEventCounters(0, counters.data(), &count);
+    if(status != ERROR_SUCCESS) {
+        printf("GetEventCounters failed, error: %d\n", status);
+        return;
+    }
+
+    printf("Event      Count  Delivered  Coalesced  Pending  Window(us)\n");
+    for(UINT32 i = 0; i < count; i++) {
+        const EventCounter_t& c = counters[i];
+        if(c.count != 0 || c.window != 0) {
+            printf(" 0x%02x %10llu %10llu %10llu %8u %11u\n", i, c.count, c.delivered, c.coalesced, c.pending, c.window);
+        }
+    }
+}
+
+/*
+ * Function: BOOL RecordGeneratorStamp
+ *
+ * Description:
+ * Adds a notification raised by the generator to the statistics of its run. Stats are reset
+ * when the first notification of a new run arrives.
+ *
+ * Parameters:
+ * NotificationRsp_t* rsp: Notification response returned by WaitForNotificationEx
+ * size_t rsp_len: Number of valid bytes in rsp
+ *
+ * Return Value:
+ * Returns TRUE if the notification came from the generator.
+ */
+BOOL RecordGeneratorStamp(NotificationRsp_t* rsp, size_t rsp_len)
+{
+    size_t size = min((size_t)rsp->payloadsize, rsp_len - NOTIFICATION_RSP_HEADER_SIZE);
+    size_t offset = 0;
+    FILETIME now;
+
+    GetSystemTimePreciseAsFileTime(&now);
+    while(offset + sizeof(NotificationItem_t) <= size) {
+        NotificationItem_t* item = (NotificationItem_t*)(rsp->payload + offset);
+        if(offset + NOTIFY_ITEM_SIZE(item->length) > size) {
+            break;
+        }
+
+        if(item->type == NOTIFY_PAYLOAD_GENERATOR && item->length >= sizeof(GeneratorStamp_t)) {
+            GeneratorStamp_t* stamp = (GeneratorStamp_t*)(item + 1);
+            UINT64 received = ((UINT64)now.dwHighDateTime << 32) | now.dwLowDateTime;
+
+            AcquireSRWLockExclusive(&gGenStats.lock);
+            if(stamp->run != gGenStats.run) {
+                gGenStats.run = stamp->run;
+                gGenStats.received = 0;
+                gGenStats.notifications = 0;
+                gGenStats.latency.clear();
+            }
+            gGenStats.received += rsp->occurrences;
+            gGenStats.notifications++;
+            if(gGenStats.latency.size() < GENERATOR_MAX_SAMPLES) {
+                gGenStats.latency.push_back(received > stamp->generated ? received - stamp->generated : 0);
+            }
+            ReleaseSRWLockExclusive(&gGenStats.lock);
+            return TRUE;
+        }
+        offset += NOTIFY_ITEM_SIZE(item->length);
+    }
+
+    return FALSE;
+}
+
+/*
+ * Function: VOID PrintGeneratorStats
+ *
+ * Description:
+ * Prints delivery and loss of the current or last generator run. Events still pending in the
+ * driver count as lost until they are delivered.
+ *
+ * Parameters:
+ * None
+ *
+ * Return Value:
+ * None
+ */
+VOID PrintGeneratorStats()
+{
+    GeneratorReq_t req = {0};
+    GeneratorRsp_t rsp = {0};
+
+    req.rate = GENERATOR_RATE_QUERY;
+    int status = ControlGenerator(&req, &rsp);
+    if(status != ERROR_SUCCESS) {
+        printf("ControlGenerator failed, error: %d\n", status);
+        return;
+    }
+
+    AcquireSRWLockExclusive(&gGenStats.lock);
+    UINT64 received = gGenStats.run == rsp.run ? gGenStats.received : 0;
+    UINT64 notifications = gGenStats.run == rsp.run ? gGenStats.notifications : 0;
+    std::vector<UINT64> latency;
+    if(gGenStats.run == rsp.run) {
+        latency = gGenStats.latency;
+    }
+    ReleaseSRWLockExclusive(&gGenStats.lock);
+
+    printf("Generator run %u %s after %llu ms\n", rsp.run, rsp.running ? "running" : "done", rsp.elapsed / 10000);
+    printf("  Generated: %llu Received: %llu in %llu notifications Lost: %lld\n",
+           rsp.generated, received, notifications, (INT64)(rsp.generated - received));
+    if(!latency.empty()) {
+        std::sort(latency.begin(), latency.end());
+        printf("  Latency us: p50 %.1f p99 %.1f max %.1f\n",
+               latency[latency.size() / 2] / 10.0,
+               latency[latency.size() * 99 / 100] / 10.0,
+               latency.back() / 10.0);
+    }
+}
+
+/*
+ * Function: VOID PrintPrefetchResults
+ *
+ * Description:
+ * Prints the evaluations eclib prefetched for a notification, with the first integer each returned.
+ *
+ * Parameters:
+ * PrefetchResult_t* results: Results returned by WaitForNotificationPrefetch
+ * UINT32 count: Number of results
+ *
+ * Return Value:
+ * None
+ */
+VOID PrintPrefetchResults(PrefetchResult_t* results, UINT32 count)
+{
+    for(UINT32 i = 0; i < count; i++) {
+        const char *method = results[i].rule < PREFETCH_RULE_MAX ? gPrefetchMethods[results[i].rule] : NULL;
+        acpiview::ArgList args;
+
+        printf("  Prefetch %s: ", method ? method : "?");
+        if(results[i].status != ERROR_SUCCESS) {
+            printf("error %d", results[i].status);
+        } else if(acpiview::Parse(results[i].output, results[i].length, args) && !args.Empty() &&
+                  args[0].IsInteger()) {
+            printf("0x%llx", args[0].Integer());
+        } else {
+            printf("%u bytes", results[i].length);
+        }
+        printf(" after %u us\n", results[i].latency_us);
+    }
+}
+
+/*
+ * Function: DDWORD NotificationThread
+ *
+ * Description:
+ * The NotificationThread function retrieves a notification from a Kernel-Mode Driver Framework (KMDF) driver.
+ * It sends a request to the driver and receives the notification details.
+ *
+ * Parameters:
+ * LPVOID lpParam: A handle to ready event we notfiy after sending IOCTL to wait for events
+ *
+ * Return Value:
+ * Returns ERROR_SUCCESS if the notification is successfully retrieved, otherwise returns ERROR_INVALID_PARAMETER.
+ */
+DWORD WINAPI NotificationThread(LPVOID lpParam) 
+{
+    UNREFERENCED_PARAMETER(lpParam);
+
+    BYTE response[NOTIFICATION_RSP_MAX_SIZE];
+    NotificationRsp_t* rsp = (NotificationRsp_t*)response;
+
+    // Main loop to wait for notifications
+    for(;;) {
+        size_t rsp_len = sizeof(response);
+        PrefetchResult_t results[PREFETCH_RULE_MAX];
+        UINT32 count = PREFETCH_RULE_MAX;
+        UINT32 event = WaitForNotificationPrefetch(0, rsp, &rsp_len, results, &count);
+
+        // With -format stdout only carries results
+        if(gFormat == ACPI_OUT_TEXT) {
+            // Older drivers only return the legacy response without EC event or payload
+            if(rsp_len >= NOTIFICATION_RSP_HEADER_SIZE) {
+                // Generator runs are too fast to print, they are summarized with 'g'
+                if(!RecordGeneratorStamp(rsp, rsp_len)) {
+                    printf("Received Notification Event: 0x%x\n", event);
+                    PrintNotificationPayload(rsp, rsp_len);
+                }
+            } else {
+                printf("Received Notification Event: 0x%x\n", event);
+            }
+            PrintPrefetchResults(results, count);
+        }
+        // If we get exit event then break out of loop and exit thread
+        if( WaitForSingleObject(gExitEvent, 0) == WAIT_OBJECT_0) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+
+/*
+ * Function: HANDLE StartNotificationListener
+ *
+ * Description:
+ * The StartNotificationListener function creates a thread to listen for notifications and returns a handle to the thread.
+ * It creates an event to signal when the thread is ready and waits for the thread to be ready or terminated.
+ *
+ * Parameters:
+ * None
+ *
+ * Return Value:
+ * Returns a handle to the notification listener thread if successful, otherwise returns NULL.
+ */
+HANDLE StartNotificationListener(void)
+{
+    HANDLE hThread;
+    DWORD dwThreadId;
+
+    // Initialize external notification lib
+    int status = InitializeNotification();
+    if(status != ERROR_SUCCESS) {
+        printf("InitializeNotification failed, status: 0x%x\n", status);
+        return NULL;
+    }
+
+    // Create the thread
+    hThread = CreateThread(
+        NULL,                   // Default security attributes
+        0,                      // Default stack size
+        NotificationThread,     // Thread routine
+        NULL,                   // Parameter to thread routine
+        0,                      // Default creation flags
+        &dwThreadId);           // Receive thread identifier
+
+    return hThread;
+}
+#endif // EC_TEST_NOTIFICATIONS
+
+
+/*
+ * Function: int main
+ *
+ * Description:
+ * The main function serves as the entry point for the program. It parses the command line arguments,
+ * retrieves a handle to the KMDF driver, and evaluates an ACPI method on the device.
+ *
+ * Parameters:
+ * int argc: The number of command line arguments.
+ * char* argv[]: The array of command line arguments.
+ *
+ * Return Value:
+ * Returns the status of the operations. Returns ERROR_SUCCESS if all operations are successful,
+ * otherwise returns an error code.
+ */
+int __cdecl
+main(
+    _In_ int argc,
+    _In_reads_(argc) char* argv[]
+    )
+{
+
+    HANDLE hThread = NULL;
+    int status = ERROR_SUCCESS;
+
+    // Reading shared results sends nothing to the driver, so it does not need to be the only instance
+    if (argc == 2 && _stricmp(argv[1], "-shared") == 0) {
+        return PrintSharedResults();
+    }
+
+    // Keep only one instance of the application running
+    // This makes the App & Driver simple by not allowing multiple instances
+    //
+    HANDLE hMutex = CreateMutex(NULL, TRUE, L"Global\\ECTestAppMutex");
+    if (hMutex == NULL) {
+        status = GetLastError();
+        printf("CreateMutex failed, error: %d\n", status);
+        goto CleanUp;
+    }
+
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        printf("Another instance of the application is already running.\n");
+        goto CleanUp;
+    }
+
+    // Evaluations are checked against the methods found by earlier runs
+    if (GetModuleFileNameA(NULL, gMethodCache, sizeof(gMethodCache)) != 0 && strrchr(gMethodCache, '\\') != NULL) {
+        *(strrchr(gMethodCache, '\\') + 1) = 0;
+        StringCchCatA(gMethodCache, sizeof(gMethodCache), METHOD_CACHE_FILE);
+        LoadAcpiMethodCache(gMethodCache);
+    } else {
+        gMethodCache[0] = 0;
+    }
+
+#ifdef EC_TEST_NOTIFICATIONS
+    // Create the exit event
+    gExitEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (gExitEvent == NULL) {
+        status = GetLastError();
+        printf("CreateEvent failed, error: %d\n", status);
+        goto CleanUp;
+    }
+
+    // This creates a new thread and blocks until listener is running
+    hThread = StartNotificationListener();
+    if(hThread == NULL) {
+        goto CleanUp;
+    }
+#endif // EC_TEST_NOTIFICATIONS
+
+    status = ParseCmdline(argc,argv);
+    if(status != ERROR_SUCCESS) {
+        goto CleanUp;
+    }
+
+    // Machine readable runs end with their result so scripts can call ectest in a loop
+    if(gFormat != ACPI_OUT_TEXT) {
+        goto CleanUp;
+    }
+
+    // Loop until we hit "q to quit"
+    printf("Waiting for notification press 'q' to quit, 'c' for event counters, 'g' for generator stats, 'p' for priority queues.\n");
+    int key;
+    for(;;) {
+        key = getchar();
+        if( key == 'q') {
+            break;
+        }
+        if( key == 'c') {
+            PrintEventCounters();
+        }
+        if( key == 'g') {
+            PrintGeneratorStats();
+        }
+        if( key == 'p') {
+            PrintPriorityStats();
+        }
+    }
+
+    printf("You pressed 'q'. Exiting...\n");
+CleanUp:
+
+    // Hand sampling over to a waiting process before the driver handle goes away
+    if(gShareStarted) StopResultShare();
+
+    // Stop the subscription while its worker can still be woken by a notification
+    if(gSubscription) UnsubscribeTemperature(gSubscription);
+
+    // Signal the exit event to stop the thread
+    if(gExitEvent) SetEvent(gExitEvent);
+    if(hThread) CancelSynchronousIo(hThread);
+    if(hThread) WaitForSingleObject(hThread, INFINITE);
+    if(hThread) CleanupNotification();
+    if(hThread) CloseHandle(hThread);
+    if(gLogThread) WaitForSingleObject(gLogThread, INFINITE);
+    if(gLogThread) CloseHandle(gLogThread);
+    if(gRecording) StopSession();
+    if(gTracing) StopTracing();
+
+    if(gExitEvent) CloseHandle(gExitEvent);
+    if(gMethodCache[0]) SaveAcpiMethodCache(gMethodCache);
+    if(hMutex) CloseHandle(hMutex);
+
+    return status;
+}
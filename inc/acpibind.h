@@ -0,0 +1,207 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Support for the method bindings tools/aslbind.py generates from the ASL into ecmethods.h.
+// The request of each method is serialized at compile time into an Image, method name and
+// UUIDs included, in the same layout acpireq.h writes. Making a call copies the image and
+// patches the argument values at offsets the generator worked out, nothing is parsed.
+//
+// Only the portable parts of ecmethods.h depend on this, so host tools and benches can use the
+// bindings without the WDK.
+
+#include "acpireq.h"
+
+// Same layout as GUID, which is used when guiddef.h has been included
+#ifdef GUID_DEFINED
+typedef GUID AcpiGuid_t;
+#else
+typedef struct {
+    uint32_t Data1;
+    uint16_t Data2;
+    uint16_t Data3;
+    uint8_t Data4[8];
+} AcpiGuid_t;
+#endif
+
+#define ACPI_BIND_GUID_SIZE     16
+
+#ifdef __cplusplus
+
+static_assert(sizeof(AcpiGuid_t) == ACPI_BIND_GUID_SIZE, "UUID arguments are 16 byte buffers");
+
+namespace acpibind {
+
+// Request serialized at compile time, Capacity is the largest request the method takes
+template <size_t Capacity>
+class Image {
+public:
+    constexpr Image(const char* method) : m_bytes{}, m_length(ACPI_REQ_HEADER), m_count(0), m_depth(0), m_open{}
+    {
+        Put32(0, ACPI_REQ_SIGNATURE);
+        for (size_t i = 0; method[i] != 0 && i < ACPI_REQ_METHOD_MAX - 1; i++) {
+            m_bytes[ACPI_REQ_METHOD_OFFSET + i] = static_cast<uint8_t>(method[i]);
+        }
+    }
+
+    constexpr Image& Integer(uint32_t value)
+    {
+        Header(ACPI_VIEW_TYPE_INTEGER, sizeof(value));
+        Put32(m_length, value);
+        m_length += sizeof(value);
+        return *this;
+    }
+
+    constexpr Image& Guid(const AcpiGuid_t& value)
+    {
+        Header(ACPI_VIEW_TYPE_BUFFER, ACPI_BIND_GUID_SIZE);
+        Put32(m_length, value.Data1);
+        Put16(m_length + 4, value.Data2);
+        Put16(m_length + 6, value.Data3);
+        for (size_t i = 0; i < sizeof(value.Data4); i++) {
+            m_bytes[m_length + 8 + i] = value.Data4[i];
+        }
+        m_length += ACPI_BIND_GUID_SIZE;
+        return *this;
+    }
+
+    constexpr Image& Package()
+    {
+        const size_t header = m_length;
+        Header(ACPI_VIEW_TYPE_PACKAGE_EX, 0);
+        m_open[m_depth++] = header;
+        return *this;
+    }
+
+    // Elements of the templates are never shorter than the minimum argument size
+    constexpr Image& EndPackage()
+    {
+        size_t header = m_open[--m_depth];
+        Put16(header + 2, static_cast<uint16_t>(m_length - header - ACPI_VIEW_ARG_HEADER));
+        return *this;
+    }
+
+    constexpr Image& End()
+    {
+        Put32(ACPI_REQ_SIZE_OFFSET, static_cast<uint32_t>(m_length - ACPI_REQ_HEADER));
+        Put32(ACPI_REQ_COUNT_OFFSET, m_count);
+        return *this;
+    }
+
+    const uint8_t* Data() const { return m_bytes; }
+    constexpr size_t Length() const { return m_length; }
+
+private:
+    constexpr void Put16(size_t offset, uint16_t value)
+    {
+        m_bytes[offset] = static_cast<uint8_t>(value);
+        m_bytes[offset + 1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    constexpr void Put32(size_t offset, uint32_t value)
+    {
+        Put16(offset, static_cast<uint16_t>(value));
+        Put16(offset + 2, static_cast<uint16_t>(value >> 16));
+    }
+
+    constexpr void Header(uint16_t type, uint16_t length)
+    {
+        if (m_depth == 0) {
+            m_count++;
+        }
+        Put16(m_length, type);
+        Put16(m_length + 2, length);
+        m_length += ACPI_VIEW_ARG_HEADER;
+    }
+
+    alignas(8) uint8_t m_bytes[Capacity];
+    size_t m_length;
+    uint32_t m_count;
+    uint32_t m_depth;
+    size_t m_open[ACPI_VIEW_MAX_DEPTH];
+};
+
+inline void Patch32(void* request, size_t offset, uint32_t value)
+{
+    memcpy(static_cast<uint8_t*>(request) + offset, &value, sizeof(value));
+}
+
+inline void PatchGuid(void* request, size_t offset, const AcpiGuid_t& value)
+{
+    memcpy(static_cast<uint8_t*>(request) + offset, &value, sizeof(value));
+}
+
+// Cut a request whose last argument is a package short of the elements the template has room
+// for, package is the offset of its header. Returns the bytes to send.
+inline size_t Trim(void* request, size_t package, size_t length)
+{
+    auto p = static_cast<uint8_t*>(request);
+    const uint16_t data = static_cast<uint16_t>(length - package - ACPI_VIEW_ARG_HEADER);
+    const uint32_t size = static_cast<uint32_t>(length - ACPI_REQ_HEADER);
+    memcpy(p + package + 2, &data, sizeof(data));
+    memcpy(p + ACPI_REQ_SIZE_OFFSET, &size, sizeof(size));
+    return length;
+}
+
+// Path of a method in the ASL and the number of arguments it declares
+struct MethodInfo {
+    const char* path;
+    uint8_t argc;
+};
+
+// Results, false if the output is malformed or the first argument is of another type
+
+inline bool Integer(const void* output, size_t length, uint64_t& value)
+{
+    acpiview::ArgList list;
+    if (!acpiview::Parse(output, length, list) || list.Empty() || !list[0].IsInteger()) {
+        return false;
+    }
+    value = list[0].Integer();
+    return true;
+}
+
+inline bool Package(const void* output, size_t length, acpiview::ArgList& elements)
+{
+    acpiview::ArgList list;
+    if (!acpiview::Parse(output, length, list) || list.Empty() || !list[0].IsPackage()) {
+        return false;
+    }
+    elements = list[0].Package();
+    return true;
+}
+
+inline bool Any(const void* output, size_t length, acpiview::Arg& value)
+{
+    acpiview::ArgList list;
+    if (!acpiview::Parse(output, length, list) || list.Empty()) {
+        return false;
+    }
+    value = list[0];
+    return true;
+}
+
+} // namespace acpibind
+#endif // __cplusplus
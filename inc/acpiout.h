@@ -0,0 +1,475 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Writes the result of an ACPI method evaluation for people or for scripts. Everything goes
+// through one Writer that fills a buffer and hands it to the C runtime in large blocks, bytes
+// are turned into hex with a lookup table, so a large result costs a few fwrite calls rather
+// than a printf per byte.
+//
+// ACPI_OUT_TEXT    Indented dump, the same layout ectest has always printed
+// ACPI_OUT_JSON    One JSON document, an argument per line
+// ACPI_OUT_JSONL   One JSON object on a single line, runs can be appended to one file
+// ACPI_OUT_CSV     method,status,path,type,value with a row per argument, path is the index
+//                  of the argument and of each package it is in, e.g. 2.0
+// ACPI_OUT_BIN     The ACPI_EVAL_OUTPUT_BUFFER_V1 exactly as returned, acpiview.h reads it back
+//
+// The raw output buffer is only written with ACPI_OUT_RAW, or in text when it cannot be parsed.
+
+#include <stdio.h>
+#include "acpiview.h"
+
+#define ACPI_OUT_TEXT           0
+#define ACPI_OUT_JSON           1
+#define ACPI_OUT_JSONL          2
+#define ACPI_OUT_CSV            3
+#define ACPI_OUT_BIN            4
+#define ACPI_OUT_COUNT          5
+
+// Flags
+#define ACPI_OUT_RAW            0x1        // Also write the raw output buffer in hex
+
+#define ACPI_OUT_BUFFER_SIZE    0x4000     // Bytes buffered before they are written to the file
+
+#ifdef __cplusplus
+#include <cstring>
+
+namespace acpiout {
+
+// Format names as given on the command line, indexed by ACPI_OUT_*
+static const char* const FormatNames[ACPI_OUT_COUNT] = { "text", "json", "jsonl", "csv", "bin" };
+
+// Names of ACPI_VIEW_TYPE_*
+static const char* const TypeNames[] = { "integer", "string", "buffer", "package", "package" };
+
+// Two lower case hex digits for every byte value
+static const char HexPairs[513] =
+    "000102030405060708090a0b0c0d0e0f"
+    "101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f"
+    "303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f"
+    "505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f"
+    "707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f"
+    "909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+    "b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+    "d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+    "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+// Returns the ACPI_OUT_* format called name, ACPI_OUT_COUNT if there is none
+inline uint32_t ParseFormat(const char* name)
+{
+    for (uint32_t i = 0; i < ACPI_OUT_COUNT; i++) {
+        if (name != nullptr && strcmp(name, FormatNames[i]) == 0) {
+            return i;
+        }
+    }
+    return ACPI_OUT_COUNT;
+}
+
+// Buffered output to a FILE, written when full, on Flush and when it goes out of scope
+class Writer {
+public:
+    explicit Writer(FILE* file) : m_file(file), m_used(0), m_failed(false) {}
+    ~Writer() { Flush(); }
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    void Write(const void* data, size_t length)
+    {
+        if (length == 0) {
+            return;
+        }
+        if (m_used + length > sizeof(m_buffer)) {
+            Flush();
+            // Larger than the whole buffer, nothing is gained copying it
+            if (length > sizeof(m_buffer)) {
+                m_failed |= fwrite(data, 1, length, m_file) != length;
+                return;
+            }
+        }
+        memcpy(m_buffer + m_used, data, length);
+        m_used += length;
+    }
+
+    void Char(char c)
+    {
+        if (m_used == sizeof(m_buffer)) {
+            Flush();
+        }
+        m_buffer[m_used++] = c;
+    }
+
+    void Text(const char* s) { Write(s, strlen(s)); }
+
+    void Spaces(int count)
+    {
+        while (count-- > 0) {
+            Char(' ');
+        }
+    }
+
+    void Decimal(uint64_t value)
+    {
+        char digits[20];
+        size_t n = 0;
+        do {
+            digits[sizeof(digits) - ++n] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        Write(digits + sizeof(digits) - n, n);
+    }
+
+    // 0x followed by the significant digits, like %llx
+    void Hex(uint64_t value)
+    {
+        char digits[18];
+        size_t n = 0;
+        do {
+            digits[sizeof(digits) - ++n] = HexPairs[(value & 0xF) * 2 + 1];
+            value >>= 4;
+        } while (value != 0);
+        digits[sizeof(digits) - ++n] = 'x';
+        digits[sizeof(digits) - ++n] = '0';
+        Write(digits + sizeof(digits) - n, n);
+    }
+
+    // Two digits per byte, with prefix and suffix around each byte if given
+    void HexBytes(const uint8_t* data, size_t length, const char* prefix = "", const char* suffix = "")
+    {
+        size_t before = strlen(prefix);
+        size_t after = strlen(suffix);
+        size_t each = before + 2 + after;
+        for (size_t i = 0; i < length; i++) {
+            if (m_used + each > sizeof(m_buffer)) {
+                Flush();
+            }
+            memcpy(m_buffer + m_used, prefix, before);
+            memcpy(m_buffer + m_used + before, &HexPairs[data[i] * 2], 2);
+            memcpy(m_buffer + m_used + before + 2, suffix, after);
+            m_used += each;
+        }
+    }
+
+    // Returns false if anything written so far could not be written to the file
+    bool Flush()
+    {
+        if (m_used != 0) {
+            m_failed |= fwrite(m_buffer, 1, m_used, m_file) != m_used;
+            m_used = 0;
+        }
+        m_failed |= fflush(m_file) != 0;
+        return !m_failed;
+    }
+
+    bool Failed() const { return m_failed; }
+
+private:
+    FILE* m_file;
+    size_t m_used;
+    bool m_failed;
+    char m_buffer[ACPI_OUT_BUFFER_SIZE];
+};
+
+// Quoted JSON string, control characters escaped
+inline void JsonString(Writer& w, const char* s, size_t length)
+{
+    w.Char('"');
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = static_cast<uint8_t>(s[i]);
+        if (c == '"' || c == '\\') {
+            w.Char('\\');
+            w.Char(static_cast<char>(c));
+        } else if (c < 0x20) {
+            w.Write("\\u00", 4);
+            w.Write(&HexPairs[c * 2], 2);
+        } else {
+            w.Char(static_cast<char>(c));
+        }
+    }
+    w.Char('"');
+}
+
+// Quoted CSV field, quotes doubled
+inline void CsvString(Writer& w, const char* s, size_t length)
+{
+    w.Char('"');
+    for (size_t i = 0; i < length; i++) {
+        if (s[i] == '"') {
+            w.Char('"');
+        }
+        w.Char(s[i]);
+    }
+    w.Char('"');
+}
+
+// New line indented to depth in pretty printed JSON, nothing on a single line
+inline void JsonBreak(Writer& w, bool pretty, int depth)
+{
+    if (pretty) {
+        w.Char('\n');
+        w.Spaces(depth * 2);
+    }
+}
+
+inline void TextArgs(Writer& w, const acpiview::ArgList& args, int depth)
+{
+    int indent = 4 + depth * 4;
+    uint32_t i = 0;
+
+    for (acpiview::Arg arg : args) {
+        w.Spaces(indent);
+        w.Text("Argument[");
+        w.Decimal(i++);
+        w.Text("]:\n");
+        w.Spaces(indent);
+        switch (arg.Type()) {
+        case ACPI_VIEW_TYPE_INTEGER:
+            w.Text("Integer Value: ");
+            w.Hex(arg.Integer());
+            break;
+        case ACPI_VIEW_TYPE_STRING:
+            w.Text("String Value: ");
+            w.Write(arg.String(), arg.StringLength());
+            break;
+        case ACPI_VIEW_TYPE_PACKAGE:
+        case ACPI_VIEW_TYPE_PACKAGE_EX:
+            w.Text("Package of ");
+            w.Decimal(arg.Package().Count());
+            w.Text(" elements:\n");
+            TextArgs(w, arg.Package(), depth + 1);
+            continue;
+        case ACPI_VIEW_TYPE_BUFFER:
+        default:
+            w.Text("Buffer Data:\n");
+            w.Spaces(indent);
+            w.HexBytes(arg.Buffer(), arg.BufferLength(), " 0x", ",");
+            break;
+        }
+        w.Char('\n');
+    }
+}
+
+inline void JsonArgs(Writer& w, const acpiview::ArgList& args, bool pretty, int depth)
+{
+    bool first = true;
+
+    w.Char('[');
+    for (acpiview::Arg arg : args) {
+        if (!first) {
+            w.Char(',');
+        }
+        first = false;
+        JsonBreak(w, pretty, depth + 1);
+        w.Text("{\"type\":\"");
+        w.Text(TypeNames[arg.Type()]);
+        w.Text("\",\"value\":");
+        switch (arg.Type()) {
+        case ACPI_VIEW_TYPE_INTEGER:
+            w.Decimal(arg.Integer());
+            break;
+        case ACPI_VIEW_TYPE_STRING:
+            JsonString(w, arg.String(), arg.StringLength());
+            break;
+        case ACPI_VIEW_TYPE_PACKAGE:
+        case ACPI_VIEW_TYPE_PACKAGE_EX:
+            JsonArgs(w, arg.Package(), pretty, depth + 1);
+            break;
+        case ACPI_VIEW_TYPE_BUFFER:
+        default:
+            w.Char('"');
+            w.HexBytes(arg.Buffer(), arg.BufferLength());
+            w.Char('"');
+            break;
+        }
+        w.Char('}');
+    }
+    if (!first) {
+        JsonBreak(w, pretty, depth);
+    }
+    w.Char(']');
+}
+
+// One row per argument, the row of a package has its element count and is followed by its elements
+inline void CsvArgs(Writer& w, const char* method, uint32_t status, const acpiview::ArgList& args,
+                    char* path, size_t pathLength)
+{
+    uint32_t i = 0;
+
+    for (acpiview::Arg arg : args) {
+        // Deepest path is ACPI_VIEW_MAX_DEPTH + 1 indices of at most 5 digits
+        size_t length = pathLength;
+        if (length != 0) {
+            path[length++] = '.';
+        }
+        length += static_cast<size_t>(snprintf(path + length, 8, "%u", i++));
+
+        CsvString(w, method, strlen(method));
+        w.Char(',');
+        w.Decimal(status);
+        w.Char(',');
+        w.Write(path, length);
+        w.Char(',');
+        w.Text(TypeNames[arg.Type()]);
+        w.Char(',');
+        switch (arg.Type()) {
+        case ACPI_VIEW_TYPE_INTEGER:
+            w.Decimal(arg.Integer());
+            break;
+        case ACPI_VIEW_TYPE_STRING:
+            CsvString(w, arg.String(), arg.StringLength());
+            break;
+        case ACPI_VIEW_TYPE_PACKAGE:
+        case ACPI_VIEW_TYPE_PACKAGE_EX:
+            w.Decimal(arg.Package().Count());
+            w.Char('\n');
+            CsvArgs(w, method, status, arg.Package(), path, length);
+            continue;
+        case ACPI_VIEW_TYPE_BUFFER:
+        default:
+            w.HexBytes(arg.Buffer(), arg.BufferLength());
+            break;
+        }
+        w.Char('\n');
+    }
+}
+
+// Writes the result of evaluating method in format. status is the Win32 error of the evaluation,
+// output and length are only read when it is 0. Text only covers the output buffer, the caller
+// prints failures the way it prints other errors.
+inline void Result(Writer& w, uint32_t format, uint32_t flags, const char* method, uint32_t status,
+                   const void* output, size_t length)
+{
+    auto p = static_cast<const uint8_t*>(output);
+    uint32_t signature = 0, total = 0, count = 0;
+    acpiview::ArgList args;
+    bool parsed = false;
+
+    if (status == 0 && p != nullptr && length >= ACPI_VIEW_OUTPUT_HEADER) {
+        memcpy(&signature, p, sizeof(signature));
+        memcpy(&total, p + 4, sizeof(total));
+        memcpy(&count, p + 8, sizeof(count));
+        parsed = acpiview::Parse(p, length, args);
+    }
+    if (status != 0 || p == nullptr) {
+        length = 0;
+    }
+    if (total < length) {
+        length = total;
+    }
+    bool raw = (flags & ACPI_OUT_RAW) || (status == 0 && !parsed);
+
+    switch (format) {
+    case ACPI_OUT_TEXT:
+        if (status != 0) {
+            break;
+        }
+        w.Text("ACPI Method: \n  Signature: ");
+        w.Hex(signature);
+        w.Text("\n  Length: ");
+        w.Hex(total);
+        w.Text("\n  Count: ");
+        w.Hex(count);
+        w.Char('\n');
+        if (parsed) {
+            TextArgs(w, args, 0);
+        } else {
+            w.Text("    Malformed output buffer\n");
+        }
+        if (raw) {
+            w.Text("\n\nACPI Raw Output:\n");
+            w.HexBytes(p, length, " 0x");
+            w.Text("\n\n");
+        }
+        break;
+
+    case ACPI_OUT_JSON:
+    case ACPI_OUT_JSONL: {
+        bool pretty = format == ACPI_OUT_JSON;
+        w.Char('{');
+        JsonBreak(w, pretty, 1);
+        w.Text("\"method\":");
+        JsonString(w, method, strlen(method));
+        w.Char(',');
+        JsonBreak(w, pretty, 1);
+        w.Text("\"status\":");
+        w.Decimal(status);
+        if (status == 0) {
+            w.Char(',');
+            JsonBreak(w, pretty, 1);
+            w.Text("\"count\":");
+            w.Decimal(count);
+            w.Char(',');
+            JsonBreak(w, pretty, 1);
+            if (parsed) {
+                w.Text("\"args\":");
+                JsonArgs(w, args, pretty, 1);
+            } else {
+                w.Text("\"error\":\"malformed\"");
+            }
+        }
+        if (raw && status == 0) {
+            w.Char(',');
+            JsonBreak(w, pretty, 1);
+            w.Text("\"raw\":\"");
+            w.HexBytes(p, length);
+            w.Char('"');
+        }
+        JsonBreak(w, pretty, 0);
+        w.Text("}\n");
+        break;
+    }
+
+    case ACPI_OUT_CSV: {
+        char path[(ACPI_VIEW_MAX_DEPTH + 1) * 6 + 8];
+        w.Text("method,status,path,type,value\n");
+        if (parsed) {
+            CsvArgs(w, method, status, args, path, 0);
+        }
+        // A failed or malformed evaluation still gets a row so every run shows up
+        if (raw || !parsed) {
+            CsvString(w, method, strlen(method));
+            w.Char(',');
+            w.Decimal(status);
+            w.Text(raw && status == 0 ? ",raw,buffer," : ",,,");
+            w.HexBytes(p, length);
+            w.Char('\n');
+        }
+        break;
+    }
+
+    case ACPI_OUT_BIN:
+        w.Write(p, length);
+        break;
+    }
+}
+
+} // namespace acpiout
+#endif // __cplusplus
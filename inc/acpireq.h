@@ -0,0 +1,235 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Builds an ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX in place in a caller supplied arena, so the
+// same memory can be reused for every request of a hot loop. Arguments are appended in order,
+// a package is opened, filled and closed, and its length is patched in when it closes, so nested
+// packages are written in one pass without staging buffers.
+//
+// When the arena is too small the builder keeps counting without writing, the request fails with
+// ACPI_REQ_NO_SPACE and Length is the exact arena size needed to build it again.
+
+#include "acpiview.h"
+
+#define ACPI_REQ_SIGNATURE      0x46696541 // 'AeiF', ACPI_EVAL_INPUT_BUFFER_COMPLEX_SIGNATURE_EX
+#define ACPI_REQ_METHOD_OFFSET  4
+#define ACPI_REQ_METHOD_MAX     256        // MethodName including the NUL
+#define ACPI_REQ_SIZE_OFFSET    260        // Bytes of arguments
+#define ACPI_REQ_COUNT_OFFSET   264        // Top level arguments
+#define ACPI_REQ_HEADER         268        // FIELD_OFFSET(ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX, Argument)
+#define ACPI_REQ_MAX_ARGS       7          // ACPI methods take at most 7 arguments
+
+// Builder status, the first failure sticks until the builder is started again
+#define ACPI_REQ_OK             0
+#define ACPI_REQ_NO_SPACE       1          // Arena too small, Length has the size needed
+#define ACPI_REQ_INVALID        2          // Malformed request, e.g. unbalanced package or too many arguments
+
+typedef struct {
+    uint8_t* arena;
+    size_t capacity;
+    size_t length;          // Bytes of the request so far, may be past capacity
+    uint32_t status;        // ACPI_REQ_*
+    uint32_t count;         // Top level arguments
+    uint32_t depth;         // Packages open
+    size_t open[ACPI_VIEW_MAX_DEPTH]; // Offset of the header of each open package
+} AcpiRequest_t;
+
+#ifdef __cplusplus
+#include <cstring>
+
+namespace acpireq {
+
+// Start a request for method, the arena must stay valid until the request has been sent
+inline void Begin(AcpiRequest_t& req, void* arena, size_t capacity, const char* method)
+{
+    memset(&req, 0, sizeof(req));
+    req.arena = static_cast<uint8_t*>(arena);
+    req.capacity = arena != nullptr ? capacity : 0;
+    req.length = ACPI_REQ_HEADER;
+
+    size_t name = method != nullptr ? strlen(method) : ACPI_REQ_METHOD_MAX;
+    if (name >= ACPI_REQ_METHOD_MAX) {
+        req.status = ACPI_REQ_INVALID;
+        return;
+    }
+    if (req.capacity < ACPI_REQ_HEADER) {
+        req.status = ACPI_REQ_NO_SPACE;
+        return;
+    }
+
+    const uint32_t signature = ACPI_REQ_SIGNATURE;
+    memset(req.arena, 0, ACPI_REQ_HEADER);
+    memcpy(req.arena, &signature, sizeof(signature));
+    memcpy(req.arena + ACPI_REQ_METHOD_OFFSET, method, name);
+}
+
+// Append one argument, data may be null to leave it zeroed
+inline void Append(AcpiRequest_t& req, uint16_t type, const void* data, size_t length)
+{
+    if (req.status == ACPI_REQ_INVALID) {
+        return;
+    }
+    if (length > 0xFFFF || (req.depth == 0 && req.count >= ACPI_REQ_MAX_ARGS)) {
+        req.status = ACPI_REQ_INVALID;
+        return;
+    }
+
+    size_t size = ACPI_VIEW_ARG_SIZE(length);
+    if (req.status == ACPI_REQ_OK && req.length + size <= req.capacity) {
+        uint8_t* p = req.arena + req.length;
+        const uint16_t header[2] = { type, static_cast<uint16_t>(length) };
+        memcpy(p, header, sizeof(header));
+        memset(p + ACPI_VIEW_ARG_HEADER, 0, size - ACPI_VIEW_ARG_HEADER);
+        if (data != nullptr) {
+            memcpy(p + ACPI_VIEW_ARG_HEADER, data, length);
+        }
+    } else {
+        req.status = ACPI_REQ_NO_SPACE;
+    }
+
+    req.length += size;
+    if (req.depth == 0) {
+        req.count++;
+    }
+}
+
+inline void Integer(AcpiRequest_t& req, uint32_t value)
+{
+    Append(req, ACPI_VIEW_TYPE_INTEGER, &value, sizeof(value));
+}
+
+inline void String(AcpiRequest_t& req, const char* value)
+{
+    Append(req, ACPI_VIEW_TYPE_STRING, value, strlen(value) + 1);
+}
+
+inline void Buffer(AcpiRequest_t& req, const void* data, size_t length)
+{
+    Append(req, ACPI_VIEW_TYPE_BUFFER, data, length);
+}
+
+// Open a package, the arguments that follow are its elements until EndPackage
+inline void BeginPackage(AcpiRequest_t& req)
+{
+    if (req.depth >= ACPI_VIEW_MAX_DEPTH) {
+        req.status = ACPI_REQ_INVALID;
+        return;
+    }
+
+    size_t header = req.length;
+    Append(req, ACPI_VIEW_TYPE_PACKAGE_EX, nullptr, 0);
+    if (req.status == ACPI_REQ_INVALID) {
+        return;
+    }
+
+    // Elements go straight after the header, the empty package padding is not kept
+    req.length = header + ACPI_VIEW_ARG_HEADER;
+    req.open[req.depth++] = header;
+}
+
+// Close the innermost package and patch its length
+inline void EndPackage(AcpiRequest_t& req)
+{
+    if (req.status == ACPI_REQ_INVALID) {
+        return;
+    }
+    if (req.depth == 0) {
+        req.status = ACPI_REQ_INVALID;
+        return;
+    }
+
+    size_t header = req.open[--req.depth];
+    size_t length = req.length - header - ACPI_VIEW_ARG_HEADER;
+    if (length > 0xFFFF) {
+        req.status = ACPI_REQ_INVALID;
+        return;
+    }
+
+    // An empty package still takes the minimum argument size
+    size_t size = ACPI_VIEW_ARG_SIZE(length);
+    if (req.status == ACPI_REQ_OK && header + size <= req.capacity) {
+        const uint16_t data = static_cast<uint16_t>(length);
+        memcpy(req.arena + header + 2, &data, sizeof(data));
+        memset(req.arena + header + ACPI_VIEW_ARG_HEADER + length, 0, size - ACPI_VIEW_ARG_HEADER - length);
+    } else {
+        req.status = ACPI_REQ_NO_SPACE;
+    }
+    req.length = header + size;
+}
+
+// Fill in Size and ArgumentCount. Returns ACPI_REQ_OK when the request in the arena is complete,
+// Length is then the number of bytes to send.
+inline uint32_t End(AcpiRequest_t& req)
+{
+    if (req.depth != 0) {
+        req.status = ACPI_REQ_INVALID;
+    }
+    if (req.status == ACPI_REQ_OK) {
+        const uint32_t size = static_cast<uint32_t>(req.length - ACPI_REQ_HEADER);
+        memcpy(req.arena + ACPI_REQ_SIZE_OFFSET, &size, sizeof(size));
+        memcpy(req.arena + ACPI_REQ_COUNT_OFFSET, &req.count, sizeof(req.count));
+    }
+    return req.status;
+}
+
+// Chaining wrapper over the functions above
+class Builder {
+public:
+    Builder(void* arena, size_t capacity, const char* method) { Begin(m_req, arena, capacity, method); }
+
+    void Reset(const char* method) { Begin(m_req, m_req.arena, m_req.capacity, method); }
+
+    Builder& Integer(uint32_t value) { acpireq::Integer(m_req, value); return *this; }
+    Builder& String(const char* value) { acpireq::String(m_req, value); return *this; }
+    Builder& Buffer(const void* data, size_t length) { acpireq::Buffer(m_req, data, length); return *this; }
+    Builder& Package() { BeginPackage(m_req); return *this; }
+    Builder& EndPackage() { acpireq::EndPackage(m_req); return *this; }
+
+    uint32_t End() { return acpireq::End(m_req); }
+
+    uint32_t Status() const { return m_req.status; }
+    size_t Length() const { return m_req.length; }
+    void* Data() const { return m_req.arena; }
+    AcpiRequest_t& Raw() { return m_req; }
+
+private:
+    AcpiRequest_t m_req;
+};
+
+// Builder with its arena inline, for requests of a known bounded size
+template <size_t Capacity>
+class Request : public Builder {
+public:
+    explicit Request(const char* method) : Builder(m_arena, Capacity, method) {}
+    Request(const Request&) = delete;
+    Request& operator=(const Request&) = delete;
+
+private:
+    alignas(8) uint8_t m_arena[Capacity];
+};
+
+} // namespace acpireq
+#endif // __cplusplus
@@ -0,0 +1,307 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Read only view of the ACPI_EVAL_OUTPUT_BUFFER_V1 returned by IOCTL_ACPI_EVAL_METHOD(_EX).
+// The whole buffer, nested packages included, is bounds checked once when the view is made.
+// After that arguments are walked in place, nothing is copied or allocated.
+//
+// The layout matches Acpiioct.h but is spelled out here so host tools can use the view without
+// the WDK. Each argument is TYPE(16) LENGTH(16) followed by LENGTH bytes of data, padded to at
+// least 4 bytes. A package argument holds its elements as a sequence of arguments in its data.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ACPI_VIEW_OUTPUT_SIGNATURE  0x426F6541 // 'BoeA', ACPI_EVAL_OUTPUT_BUFFER_SIGNATURE_V1
+#define ACPI_VIEW_OUTPUT_HEADER     12         // Signature, Length, Count
+#define ACPI_VIEW_ARG_HEADER        4          // Type, DataLength
+#define ACPI_VIEW_ARG_MIN_DATA      4          // Integer data, also the padding of short arguments
+#define ACPI_VIEW_MAX_DEPTH         8          // Deepest package nesting accepted
+
+#define ACPI_VIEW_TYPE_INTEGER      0
+#define ACPI_VIEW_TYPE_STRING       1
+#define ACPI_VIEW_TYPE_BUFFER       2
+#define ACPI_VIEW_TYPE_PACKAGE      3
+#define ACPI_VIEW_TYPE_PACKAGE_EX   4
+
+#define ACPI_VIEW_ARG_SIZE(len)     ((size_t)ACPI_VIEW_ARG_HEADER + ((len) < ACPI_VIEW_ARG_MIN_DATA ? ACPI_VIEW_ARG_MIN_DATA : (len)))
+
+// Arguments left to walk in an output buffer or package, only valid over a checked buffer
+typedef struct {
+    const uint8_t* next;    // Header of the next argument
+    const uint8_t* end;     // End of the output buffer or package data
+    uint32_t count;         // Arguments in the whole list, not only the ones left
+} AcpiArgList_t;
+
+// One argument, data points into the output buffer
+typedef struct {
+    uint16_t type;          // ACPI_VIEW_TYPE_*
+    uint16_t length;        // Bytes at data, strings include the terminating NUL
+    const uint8_t* data;
+} AcpiArg_t;
+
+#ifdef __cplusplus
+#include <cstring>
+#include <iterator>
+
+namespace acpiview {
+
+// Count arguments in [p, end) and check each of them fits, recursing into packages.
+// Returns false if any argument runs past end or is malformed.
+inline bool Check(const uint8_t* p, const uint8_t* end, uint32_t& count, int depth)
+{
+    count = 0;
+    while (p < end) {
+        if (static_cast<size_t>(end - p) < ACPI_VIEW_ARG_HEADER) {
+            return false;
+        }
+
+        uint16_t type, length;
+        memcpy(&type, p, sizeof(type));
+        memcpy(&length, p + 2, sizeof(length));
+        const uint8_t* data = p + ACPI_VIEW_ARG_HEADER;
+        if (static_cast<size_t>(end - p) < ACPI_VIEW_ARG_SIZE(length)) {
+            // The last argument may leave out the padding
+            if (static_cast<size_t>(end - data) < length) {
+                return false;
+            }
+        }
+
+        uint32_t nested;
+        switch (type) {
+        case ACPI_VIEW_TYPE_INTEGER:
+            if (length != 4 && length != 8) {
+                return false;
+            }
+            break;
+        case ACPI_VIEW_TYPE_STRING:
+            if (length == 0 || data[length - 1] != 0) {
+                return false;
+            }
+            break;
+        case ACPI_VIEW_TYPE_BUFFER:
+            break;
+        case ACPI_VIEW_TYPE_PACKAGE:
+        case ACPI_VIEW_TYPE_PACKAGE_EX:
+            if (depth >= ACPI_VIEW_MAX_DEPTH || !Check(data, data + length, nested, depth + 1)) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+
+        count++;
+        p += ACPI_VIEW_ARG_SIZE(length);
+    }
+    return true;
+}
+
+class ArgList;
+
+// Typed access to one argument. Accessors for the wrong type return an empty value.
+class Arg {
+public:
+    Arg() : m_arg{ ACPI_VIEW_TYPE_BUFFER, 0, nullptr } {}
+    explicit Arg(const AcpiArg_t& arg) : m_arg(arg) {}
+
+    uint16_t Type() const { return m_arg.type; }
+    uint16_t Length() const { return m_arg.length; }
+    const uint8_t* Data() const { return m_arg.data; }
+    const AcpiArg_t& Raw() const { return m_arg; }
+
+    bool IsInteger() const { return m_arg.type == ACPI_VIEW_TYPE_INTEGER; }
+    bool IsString() const { return m_arg.type == ACPI_VIEW_TYPE_STRING; }
+    bool IsBuffer() const { return m_arg.type == ACPI_VIEW_TYPE_BUFFER; }
+    bool IsPackage() const { return m_arg.type == ACPI_VIEW_TYPE_PACKAGE || m_arg.type == ACPI_VIEW_TYPE_PACKAGE_EX; }
+
+    // 32 or 64 bit integer, 0 if not an integer
+    uint64_t Integer() const
+    {
+        if (!IsInteger()) {
+            return 0;
+        }
+        if (m_arg.length == 8) {
+            uint64_t v;
+            memcpy(&v, m_arg.data, sizeof(v));
+            return v;
+        }
+        uint32_t v;
+        memcpy(&v, m_arg.data, sizeof(v));
+        return v;
+    }
+
+    // NUL terminated string in the output buffer, "" if not a string
+    const char* String() const { return IsString() ? reinterpret_cast<const char*>(m_arg.data) : ""; }
+
+    // Characters of the string without the NUL
+    size_t StringLength() const { return IsString() ? m_arg.length - 1u : 0; }
+
+    // Buffer bytes, strings and integers can be read the same way
+    const uint8_t* Buffer() const { return m_arg.data; }
+    size_t BufferLength() const { return m_arg.length; }
+
+    // Elements of a package, empty if not a package
+    inline ArgList Package() const;
+
+private:
+    AcpiArg_t m_arg;
+};
+
+// Forward range over a checked list of arguments
+class ArgList {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Arg;
+        using difference_type = ptrdiff_t;
+        using pointer = const Arg*;
+        using reference = Arg;
+
+        Iterator(const uint8_t* p = nullptr, const uint8_t* end = nullptr) : m_p(p), m_end(end) {}
+
+        Arg operator*() const
+        {
+            AcpiArg_t arg;
+            memcpy(&arg.type, m_p, sizeof(arg.type));
+            memcpy(&arg.length, m_p + 2, sizeof(arg.length));
+            arg.data = m_p + ACPI_VIEW_ARG_HEADER;
+            return Arg(arg);
+        }
+
+        // The last argument may leave out its padding, stop at the end rather than past it
+        Iterator& operator++()
+        {
+            uint16_t length;
+            memcpy(&length, m_p + 2, sizeof(length));
+            size_t left = static_cast<size_t>(m_end - m_p);
+            m_p += ACPI_VIEW_ARG_SIZE(length) < left ? ACPI_VIEW_ARG_SIZE(length) : left;
+            return *this;
+        }
+
+        Iterator operator++(int) { Iterator it = *this; ++*this; return it; }
+
+        bool operator==(const Iterator& other) const { return m_p == other.m_p; }
+        bool operator!=(const Iterator& other) const { return m_p != other.m_p; }
+
+        const uint8_t* Position() const { return m_p; }
+
+    private:
+        const uint8_t* m_p;
+        const uint8_t* m_end;
+    };
+
+    ArgList() : m_list{ nullptr, nullptr, 0 } {}
+    explicit ArgList(const AcpiArgList_t& list) : m_list(list) {}
+
+    Iterator begin() const { return Iterator(m_list.next, m_list.end); }
+    Iterator end() const { return Iterator(m_list.end, m_list.end); }
+    uint32_t Count() const { return m_list.count; }
+    bool Empty() const { return m_list.count == 0; }
+    const AcpiArgList_t& Raw() const { return m_list; }
+
+    // Walks from the front, fine for the few elements of a method result
+    Arg operator[](uint32_t index) const
+    {
+        if (index >= m_list.count) {
+            return Arg();
+        }
+        Iterator it = begin();
+        while (index-- > 0) {
+            ++it;
+        }
+        return *it;
+    }
+
+    // Pop the next argument off the front, returns false at the end
+    bool Next(Arg& arg)
+    {
+        if (m_list.next >= m_list.end) {
+            return false;
+        }
+        Iterator it(m_list.next, m_list.end);
+        arg = *it;
+        m_list.next = (++it).Position();
+        return true;
+    }
+
+private:
+    AcpiArgList_t m_list;
+};
+
+inline ArgList Arg::Package() const
+{
+    AcpiArgList_t list = { nullptr, nullptr, 0 };
+    if (IsPackage()) {
+        // Already checked with the output buffer, only the count is needed
+        list.next = m_arg.data;
+        list.end = m_arg.data + m_arg.length;
+        for (ArgList::Iterator it(list.next, list.end), end(list.end, list.end); it != end; ++it) {
+            list.count++;
+        }
+    }
+    return ArgList(list);
+}
+
+// Check an output buffer and return the list of its arguments. Returns false if the buffer is
+// not a complete ACPI_EVAL_OUTPUT_BUFFER_V1 or any argument in it is out of bounds.
+inline bool Parse(const void* buffer, size_t length, ArgList& list)
+{
+    auto p = static_cast<const uint8_t*>(buffer);
+    if (p == nullptr || length < ACPI_VIEW_OUTPUT_HEADER) {
+        return false;
+    }
+
+    uint32_t signature, total, count, checked;
+    memcpy(&signature, p, sizeof(signature));
+    memcpy(&total, p + 4, sizeof(total));
+    memcpy(&count, p + 8, sizeof(count));
+    if (signature != ACPI_VIEW_OUTPUT_SIGNATURE || total < ACPI_VIEW_OUTPUT_HEADER || total > length) {
+        return false;
+    }
+
+    AcpiArgList_t raw = { p + ACPI_VIEW_OUTPUT_HEADER, p + total, 0 };
+    if (!Check(raw.next, raw.end, checked, 0) || checked < count) {
+        return false;
+    }
+
+    // Trailing bytes past Count arguments are ignored
+    raw.count = count;
+    if (checked > count) {
+        ArgList::Iterator it(raw.next, raw.end);
+        for (uint32_t i = 0; i < count; i++) {
+            ++it;
+        }
+        raw.end = it.Position();
+    }
+
+    list = ArgList(raw);
+    return true;
+}
+
+} // namespace acpiview
+#endif // __cplusplus
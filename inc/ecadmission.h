@@ -0,0 +1,33 @@
+#pragma once
+
+// Admission control of ACPI evaluations. Requests queued or in flight are limited per device
+// and per client process. Over a limit an evaluation completes at once with STATUS_DEVICE_BUSY,
+// ERROR_BUSY in user mode, and an AdmissionRetry_t in the output buffer if it fits, so the
+// client can back off instead of adding to the queue.
+#define ADMISSION_KEEP              0xFFFFFFFF  // Leave the setting unchanged
+#define ADMISSION_CLIENT_COUNT      16          // Processes tracked, others only count against the device limit
+#define ADMISSION_RETRY_SIGNATURE   0x59525452  // 'RTRY'
+
+typedef struct {
+    UINT32 devicelimit; // Evaluations queued or in flight across all clients
+    UINT32 clientlimit; // Evaluations queued or in flight for one process
+    UINT32 retryms;     // Smallest retry delay suggested to rejected clients
+    UINT32 reserved;
+} AdmissionReq_t;
+
+typedef struct {
+    UINT32 devicelimit;
+    UINT32 clientlimit;
+    UINT32 retryms;
+    UINT32 outstanding; // Evaluations queued or in flight now
+    UINT64 admitted;
+    UINT64 rejecteddevice;
+    UINT64 rejectedclient;
+} AdmissionRsp_t;
+
+typedef struct {
+    UINT32 signature;   // ADMISSION_RETRY_SIGNATURE
+    UINT32 retryms;     // Suggested delay before trying again
+    UINT32 outstanding; // Evaluations counted against the limit that was hit
+    UINT32 limit;
+} AdmissionRetry_t;
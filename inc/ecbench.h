@@ -0,0 +1,37 @@
+#pragma once
+
+// In-driver benchmark. Each iteration is timed with the performance counter around only the
+// ACPI evaluation or SendDirectReq2, so app, IOCTL and work item scheduling costs are excluded.
+#define BENCH_TARGET_ACPI       0x1 // Evaluate the ACPI_EVAL_INPUT_BUFFER_*_EX in input
+#define BENCH_TARGET_FFA        0x2 // SendDirectReq2 to uuid with command in x4
+#define BENCH_MAX_ITERATIONS    100000
+#define BENCH_BUCKETS           32  // Bucket i counts iterations of 2^i to 2^(i+1) us, 0 includes < 1us
+
+typedef struct {
+    UINT32 targets;     // BENCH_TARGET_*, iterations alternate if both are set
+    UINT32 iterations;  // Timed iterations of each target
+    UINT32 warmup;      // Untimed iterations of each target run first
+    UINT32 inputsize;   // Bytes of ACPI input
+    GUID   uuid;        // FF-A service, all zero for the management service GET_CAPS
+    UINT64 command;     // x4 of the FF-A request
+    UINT8  input[1];
+} BenchReq_t;
+
+#define BENCH_REQ_HEADER_SIZE FIELD_OFFSET(BenchReq_t, input)
+
+typedef struct {
+    UINT64 frequency;   // Performance counter ticks per second
+    UINT64 count;       // Timed iterations that succeeded
+    UINT64 failures;
+    UINT64 total;       // Ticks of all successful iterations
+    UINT64 min;
+    UINT64 max;
+    UINT32 status;      // NTSTATUS of the first failure
+    UINT32 reserved;
+    UINT32 buckets[BENCH_BUCKETS];
+} BenchStats_t;
+
+typedef struct {
+    BenchStats_t acpi;
+    BenchStats_t ffa;
+} BenchRsp_t;
@@ -0,0 +1,30 @@
+#pragma once
+
+// IOCTL_BULK_TRANSFER moves an EC object through the pool of buffers UEFI pre-shared with the
+// EC, see EC_BULK_MAGIC in ecring.h and EC_CAP_BULK in ecsvc.h. Write data follows the request,
+// read data follows the response. Transfers larger than one pool buffer take one direct request
+// per buffer, transfers wait in the driver while every buffer is in use.
+#define BULK_MAX_LENGTH         0x100000
+
+typedef struct {
+    UINT8  op;          // EC_BULK_OP_*
+    UINT8  object;      // EC_BULK_OBJ_*
+    UINT16 reserved;
+    UINT32 offset;      // Byte offset in the object
+    UINT32 length;      // Bytes to move, at most BULK_MAX_LENGTH
+    UINT32 reserved2;
+    UINT8  data[1];     // Write data
+} BulkReq_t;
+
+typedef struct {
+    UINT32 status;      // EC status of the last direct request, 0 on success
+    UINT32 length;      // Bytes moved, short at the end of the object
+    UINT32 total;       // Object size reported by the EC
+    UINT32 calls;       // Direct requests sent
+    UINT32 buffer;      // Pool buffer used
+    UINT32 buffersize;  // Bytes per pool buffer
+    UINT8  data[1];     // Read data
+} BulkRsp_t;
+
+#define BULK_REQ_HEADER_SIZE FIELD_OFFSET(BulkReq_t, data)
+#define BULK_RSP_HEADER_SIZE FIELD_OFFSET(BulkRsp_t, data)
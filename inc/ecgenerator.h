@@ -0,0 +1,39 @@
+#pragma once
+
+// Synthetic notification generator. Events go through the same counting, coalescing and delivery
+// as notifications from the EC. A run starts when rate is not 0 and stops after duration or
+// when a request with rate 0 is sent, every request returns the state of the current or last run.
+#define GENERATOR_MAX_RATE          50000
+#define GENERATOR_RATE_QUERY        0xFFFFFFFF  // Only return the state, the run is unchanged
+#define GENERATOR_DIST_ROUND_ROBIN  0   // firstevent to lastevent in turn
+#define GENERATOR_DIST_UNIFORM      1   // Uniformly random in firstevent to lastevent
+#define GENERATOR_DIST_HOT          2   // Half of all events are firstevent, the rest uniform
+
+typedef struct {
+    UINT32 rate;        // Events per second while a burst is on
+    UINT32 duration;    // Run time in ms, 0 runs until stopped
+    UINT32 burston;     // ms of each cycle events are raised, 0 for continuous
+    UINT32 burstoff;    // ms of each cycle with no events
+    UINT8  firstevent;  // Notify values to raise, inclusive range
+    UINT8  lastevent;
+    UINT8  distribution;// GENERATOR_DIST_*
+    UINT8  reserved;
+    UINT32 seed;        // 0 picks a seed from the clock
+} GeneratorReq_t;
+
+typedef struct {
+    UINT32 running;
+    UINT32 run;         // Run ID stamped on every event of the run
+    UINT64 generated;   // Events raised so far in the run
+    UINT64 start;       // Time the run started, same clock as the stamps
+    UINT64 elapsed;     // Run time so far in 100ns units
+} GeneratorRsp_t;
+
+// Attached to notifications raised by the generator. If occurrences were coalesced this is the
+// stamp of the last one, so received events are counted with occurrences not stamps.
+typedef struct {
+    UINT32 run;
+    UINT32 reserved;
+    UINT64 sequence;    // 0 based index of the event in the run
+    UINT64 generated;   // Time the event was raised, same clock and units as timestamp
+} GeneratorStamp_t;
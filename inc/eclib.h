@@ -44,6 +44,77 @@ ECLIB_API int EvaluateAcpi(
     _In_ size_t* buf_len
 );
 
+// Zero copy walk of an ACPI_EVAL_OUTPUT_BUFFER_V1 for callers that cannot use acpiview.h.
+// AcpiOutputArgs checks the whole buffer once, the other calls trust lists it returned.
+ECLIB_API
+int AcpiOutputArgs(
+    _In_reads_bytes_(length) const BYTE* buffer,
+    _In_ size_t length,
+    _Out_ AcpiArgList_t* list
+);
+
+ECLIB_API
+BOOL AcpiArgNext(
+    _Inout_ AcpiArgList_t* list,
+    _Out_ AcpiArg_t* arg
+);
+
+ECLIB_API
+UINT64 AcpiArgInteger(
+    _In_ const AcpiArg_t* arg
+);
+
+ECLIB_API
+int AcpiArgPackage(
+    _In_ const AcpiArg_t* arg,
+    _Out_ AcpiArgList_t* list
+);
+
+// Request builder over a caller supplied arena for callers that cannot use acpireq.h. Calls
+// after a failure do nothing, AcpiRequestEnd reports the first failure.
+ECLIB_API
+VOID AcpiRequestBegin(
+    _Out_ AcpiRequest_t* req,
+    _Out_writes_bytes_opt_(capacity) BYTE* arena,
+    _In_ size_t capacity,
+    _In_ const char* method
+);
+
+ECLIB_API
+VOID AcpiRequestInteger(
+    _Inout_ AcpiRequest_t* req,
+    _In_ UINT32 value
+);
+
+ECLIB_API
+VOID AcpiRequestString(
+    _Inout_ AcpiRequest_t* req,
+    _In_ const char* value
+);
+
+ECLIB_API
+VOID AcpiRequestBuffer(
+    _Inout_ AcpiRequest_t* req,
+    _In_reads_bytes_(length) const void* data,
+    _In_ size_t length
+);
+
+ECLIB_API
+VOID AcpiRequestPackage(
+    _Inout_ AcpiRequest_t* req
+);
+
+ECLIB_API
+VOID AcpiRequestEndPackage(
+    _Inout_ AcpiRequest_t* req
+);
+
+ECLIB_API
+int AcpiRequestEnd(
+    _Inout_ AcpiRequest_t* req,
+    _Out_opt_ size_t* length
+);
+
 ECLIB_API
 int InitializeNotification();
 
@@ -51,4 +122,224 @@ ECLIB_API
 VOID CleanupNotification();
 
 ECLIB_API
-UINT32 WaitForNotification(UINT32 event);
\ No newline at end of file
+UINT32 WaitForNotification(UINT32 event);
+
+ECLIB_API
+UINT32 WaitForNotificationEx(
+    _In_ UINT32 event,
+    _Out_opt_ NotificationRsp_t* rsp,
+    _Inout_opt_ size_t* rsp_len
+);
+
+ECLIB_API
+int SetNotificationCoalescing(
+    _In_ UINT32 event,
+    _In_ UINT32 window_us
+);
+
+ECLIB_API
+int GetEventCounters(
+    _In_ UINT32 first,
+    _Out_ EventCounter_t* counters,
+    _Inout_ UINT32* count
+);
+
+ECLIB_API
+int ControlGenerator(
+    _In_ const GeneratorReq_t* req,
+    _Out_opt_ GeneratorRsp_t* rsp
+);
+
+ECLIB_API
+int RunDriverBench(
+    _In_ const BenchReq_t* req,
+    _In_ size_t req_len,
+    _Out_ BenchRsp_t* rsp
+);
+
+ECLIB_API
+int EvaluateAcpiPriority(
+    _In_ UINT32 priority,
+    _In_ void* acpi_input,
+    _In_ size_t input_len,
+    _Out_ BYTE* buffer,
+    _Inout_ size_t* buf_len
+);
+
+ECLIB_API
+int GetPriorityStats(
+    _Out_ EvalPriorityStats_t* stats,
+    _Inout_ UINT32* count
+);
+
+ECLIB_API
+int GetShardStats(
+    _Out_ EvalShardStatsRsp_t* stats
+);
+
+ECLIB_API
+int SetEvalRetryPolicy(
+    _In_ UINT32 attempts,
+    _In_ UINT32 max_delay_ms
+);
+
+ECLIB_API
+int ConfigureAdmission(
+    _In_ const AdmissionReq_t* req,
+    _Out_opt_ AdmissionRsp_t* rsp
+);
+
+ECLIB_API
+int SendFfaCommands(
+    _Inout_updates_(count) FfaMuxCommand_t* commands,
+    _In_ UINT32 count,
+    _Out_opt_ UINT32* calls
+);
+
+ECLIB_API
+int BulkTransfer(
+    _In_ UINT8 op,
+    _In_ UINT8 object,
+    _In_ UINT32 offset,
+    _Inout_updates_bytes_(length) void* data,
+    _In_ UINT32 length,
+    _Out_opt_ BulkRsp_t* result
+);
+
+ECLIB_API
+int ReadEcLog(
+    _Inout_ UINT64* cursor,
+    _In_ UINT32 flags,
+    _In_ UINT32 timeout_ms,
+    _Out_writes_bytes_(rsp_len) LogReadRsp_t* rsp,
+    _In_ size_t rsp_len
+);
+
+ECLIB_API
+int GetThermalVars(
+    _In_reads_(count) const GUID* vars,
+    _In_ UINT32 count,
+    _Out_writes_(count) UINT32* values,
+    _Out_opt_ UINT32* missing
+);
+
+ECLIB_API
+int SetThermalVars(
+    _In_reads_(count) const GUID* vars,
+    _In_reads_(count) const UINT32* values,
+    _In_ UINT32 count,
+    _Out_opt_ UINT32* missing
+);
+
+ECLIB_API
+int WaitForRxSequence(
+    _In_ UINT16 sequence,
+    _In_ UINT32 timeout_ms,
+    _Out_ BYTE* buffer,
+    _Inout_ size_t* buf_len
+);
+
+// Features with their own header, apps only include this one
+#include "eclibprefetch.h"
+#include "eclibtemp.h"
+#include "eclibmethods.h"
+#include "eclibshare.h"
+#include "eclibrecord.h"
+#include "eclibtrace.h"
+
+#ifdef __cplusplus
+// Apps include this header in extern "C"
+extern "C++" {
+#include <tuple>
+#include <utility>
+#include "ecsvc.h"
+
+//
+// Typed access to thermal service variables. Each variable carries the type of its value, so
+// reading a temperature into an RPM does not compile, and Get and Set move every variable they
+// are given in one _DSM evaluation, which is one FF-A request to the EC.
+//
+namespace ecvar {
+
+struct DeciKelvin { UINT32 value; };
+struct Rpm { UINT32 value; };
+
+template <typename T>
+struct Var {
+    GUID uuid;
+};
+
+constexpr Var<DeciKelvin> FanOnTemp = { { EC_THM_VAR_FAN_ON_TEMP_UUID } };
+constexpr Var<DeciKelvin> FanRampTemp = { { EC_THM_VAR_FAN_RAMP_TEMP_UUID } };
+constexpr Var<DeciKelvin> FanMaxTemp = { { EC_THM_VAR_FAN_MAX_TEMP_UUID } };
+constexpr Var<Rpm> FanMinRpm = { { EC_THM_VAR_FAN_MIN_RPM_UUID } };
+constexpr Var<Rpm> FanMaxRpm = { { EC_THM_VAR_FAN_MAX_RPM_UUID } };
+constexpr Var<Rpm> FanCurrentRpm = { { EC_THM_VAR_FAN_CURRENT_RPM_UUID } };
+
+template <typename... T, size_t... I>
+void Unpack(std::tuple<T...>& values, const UINT32* raw, std::index_sequence<I...>)
+{
+    values = std::tuple<T...>(T{ raw[I] }...);
+}
+
+template <typename... T, size_t... I>
+int SetPacked(const std::tuple<T...>& values, const GUID* uuids, UINT32* missing, std::index_sequence<I...>)
+{
+    const UINT32 raw[] = { std::get<I>(values).value... };
+    return SetThermalVars(uuids, raw, sizeof...(T), missing);
+}
+
+// Reads the variables into values, ERROR_NOT_FOUND if the EC does not know one of them
+template <typename... T>
+int Get(std::tuple<T...>& values, const Var<T>&... vars)
+{
+    static_assert(sizeof...(T) > 0 && sizeof...(T) <= EC_THM_GET_VARS_MAX, "too many variables for one request");
+    const GUID uuids[] = { vars.uuid... };
+    UINT32 raw[sizeof...(T)] = {};
+    UINT32 missing = 0;
+
+    int status = GetThermalVars(uuids, sizeof...(T), raw, &missing);
+    if (status == ERROR_SUCCESS && missing != 0) {
+        return ERROR_NOT_FOUND;
+    }
+    if (status == ERROR_SUCCESS) {
+        Unpack(values, raw, std::index_sequence_for<T...>());
+    }
+    return status;
+}
+
+// Writes values to the variables, ERROR_NOT_FOUND if the EC does not know one of them
+template <typename... T>
+int Set(const std::tuple<T...>& values, const Var<T>&... vars)
+{
+    static_assert(sizeof...(T) > 0 && sizeof...(T) <= EC_THM_SET_VARS_MAX, "too many variables for one request");
+    const GUID uuids[] = { vars.uuid... };
+    UINT32 missing = 0;
+
+    int status = SetPacked(values, uuids, &missing, std::index_sequence_for<T...>());
+    return status == ERROR_SUCCESS && missing != 0 ? ERROR_NOT_FOUND : status;
+}
+
+struct FanState {
+    DeciKelvin onTemp;
+    DeciKelvin rampTemp;
+    DeciKelvin maxTemp;
+    Rpm minRpm;
+    Rpm maxRpm;
+    Rpm currentRpm;
+};
+
+// Refreshes every fan variable in one request
+inline int GetFanState(FanState& state)
+{
+    std::tuple<DeciKelvin, DeciKelvin, DeciKelvin, Rpm, Rpm, Rpm> values;
+    int status = Get(values, FanOnTemp, FanRampTemp, FanMaxTemp, FanMinRpm, FanMaxRpm, FanCurrentRpm);
+    if (status == ERROR_SUCCESS) {
+        std::tie(state.onTemp, state.rampTemp, state.maxTemp, state.minRpm, state.maxRpm, state.currentRpm) = values;
+    }
+    return status;
+}
+
+} // namespace ecvar
+} // extern "C++"
+#endif
@@ -0,0 +1,75 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Cache of the ACPI methods of the device, part of eclib.h which apps include instead
+
+#define ACPI_METHOD_PATH_MAX        64
+#define ACPI_METHOD_ARGC_UNKNOWN    0xFF
+
+// Flags of a cached method
+#define ACPI_METHOD_PRESENT     0x1 // Found below the device by DiscoverAcpiMethods
+#define ACPI_METHOD_ABSENT      0x2 // In the ASL, not found below a device DiscoverAcpiMethods walked
+#define ACPI_METHOD_ASL         0x4 // Declared in the ASL ecmethods.h is generated from
+#define ACPI_METHOD_ARGC_MISMATCH 0x8 // Evaluated with another number of arguments than argc
+
+// What eclib knows about a method, evaluations of ABSENT methods fail without reaching the
+// driver. argc is only used to flag evaluations that pass another number of arguments, the
+// driver and ACPI decide whether they are valid
+typedef struct {
+    char path[ACPI_METHOD_PATH_MAX];    // Absolute path, e.g. \_SB.ECT0.TEST
+    UINT8 argc;                         // Arguments, ACPI_METHOD_ARGC_UNKNOWN if not known
+    UINT8 reserved[3];
+    UINT32 flags;                       // ACPI_METHOD_*
+    UINT32 output;                      // Largest ACPI_EVAL_OUTPUT_BUFFER seen, 0 if never evaluated
+} AcpiMethodInfo_t;
+
+ECLIB_API
+int DiscoverAcpiMethods(
+    _Out_opt_ UINT32* present,
+    _Out_opt_ UINT32* absent
+);
+
+ECLIB_API
+int GetAcpiMethodInfo(
+    _In_ const char* method,
+    _Out_ AcpiMethodInfo_t* info
+);
+
+ECLIB_API
+int EnumAcpiMethods(
+    _Out_writes_opt_(*count) AcpiMethodInfo_t* methods,
+    _Inout_ UINT32* count
+);
+
+ECLIB_API
+int LoadAcpiMethodCache(
+    _In_ const char* file
+);
+
+ECLIB_API
+int SaveAcpiMethodCache(
+    _In_ const char* file
+);
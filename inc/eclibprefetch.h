@@ -0,0 +1,60 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Prefetch of follow up evaluations when a notification arrives, part of eclib.h which apps include instead
+
+#define PREFETCH_RULE_MAX       16
+#define PREFETCH_OUTPUT_MAX     256
+
+// Evaluation issued by eclib as soon as a matching notification arrives, see SetPrefetchRules
+typedef struct {
+    UINT32 event;           // Notify value, lastevent of the notification
+    UINT32 ecevent;         // FF-A notify ID from the EC event record, 0 for any
+    const char* method;     // ACPI method taking no arguments, e.g. \_SB.SKIN._TMP
+} PrefetchRule_t;
+
+typedef struct {
+    UINT32 rule;            // Index of the rule in the table
+    INT32 status;           // ERROR_SUCCESS or the evaluation error
+    UINT32 length;          // Bytes valid in output
+    UINT32 latency_us;      // From the notification arriving to the evaluation completing
+    BYTE output[PREFETCH_OUTPUT_MAX]; // ACPI_EVAL_OUTPUT_BUFFER_V1
+} PrefetchResult_t;
+
+ECLIB_API
+int SetPrefetchRules(
+    _In_reads_opt_(count) const PrefetchRule_t* rules,
+    _In_ UINT32 count
+);
+
+ECLIB_API
+UINT32 WaitForNotificationPrefetch(
+    _In_ UINT32 event,
+    _Out_opt_ NotificationRsp_t* rsp,
+    _Inout_opt_ size_t* rsp_len,
+    _Out_writes_opt_(*count) PrefetchResult_t* results,
+    _Inout_opt_ UINT32* count
+);
@@ -0,0 +1,68 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Recording and replay of sessions, part of eclib.h which apps include instead
+
+// Session recordings, see ecrecord.h for the file layout
+#define REPLAY_SPEED_ORIGINAL   100     // Percent of the recorded pace
+#define REPLAY_SPEED_UNTIMED    0       // Each call as soon as the last one returns
+
+typedef struct {
+    UINT64 records;         // Evaluations, FF-A requests and notifications written
+    UINT64 bytes;           // Size of the recording
+    UINT64 dropped;         // Records lost to a failed write
+} RecordStats_t;
+
+typedef struct {
+    UINT64 records;         // Records read, names not counted
+    UINT64 evaluations;     // Evaluations sent again
+    UINT64 commands;        // FF-A commands sent again
+    UINT64 notifications;   // Notifications passed, they cannot be raised on the device
+    UINT64 statusdiffs;     // Calls or commands that returned another status than recorded
+    UINT64 outputdiffs;     // Calls or commands that succeeded with another output
+    UINT64 recordedus;      // Time the recorded calls took
+    UINT64 replayedus;      // Time the same calls took during the replay
+    UINT64 maxlateus;       // Most a call was sent behind its scaled time
+    UINT32 truncated;       // The recording ends part way through a record
+    UINT32 reserved;
+} ReplayStats_t;
+
+ECLIB_API
+int StartRecording(
+    _In_ const char* file
+);
+
+ECLIB_API
+int StopRecording(
+    _Out_opt_ RecordStats_t* stats
+);
+
+ECLIB_API
+int ReplayRecording(
+    _In_ const char* file,
+    _In_ UINT32 speed,
+    _Out_ ReplayStats_t* stats
+);
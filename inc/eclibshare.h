@@ -0,0 +1,70 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// ACPI results shared between processes, part of eclib.h which apps include instead
+
+#define SHARED_SERIES_MAX       32
+#define SHARED_RESULT_DATA_MAX  40
+
+// Method sampled by the owner of the shared result segment, see StartResultShare
+typedef struct {
+    const char* method;     // ACPI method taking no arguments, e.g. \_SB.SKIN._TMP
+    UINT32 period_ms;       // Time between samples
+} SharedSeries_t;
+
+typedef struct {
+    char method[ACPI_METHOD_PATH_MAX];
+    UINT32 period_ms;
+    INT32 status;           // ERROR_SUCCESS or the error of the last evaluation
+    UINT32 type;            // ACPI_VIEW_TYPE_* of the first result argument
+    UINT32 length;          // Bytes valid in data
+    UINT32 samples;         // Samples published since the segment was created
+    UINT32 owner;           // Process ID of the owner, 0 if no process is sampling
+    UINT64 timestamp;       // GetTickCount64 when the sample was taken, 0 if none yet
+    BYTE data[SHARED_RESULT_DATA_MAX]; // Integer, or integers of a package, as UINT64, else the bytes
+} SharedResult_t;
+
+ECLIB_API
+int StartResultShare(
+    _In_reads_opt_(count) const SharedSeries_t* series,
+    _In_ UINT32 count,
+    _Out_opt_ BOOL* owner
+);
+
+ECLIB_API
+VOID StopResultShare();
+
+ECLIB_API
+int ReadSharedResult(
+    _In_ const char* method,
+    _Out_ SharedResult_t* result
+);
+
+ECLIB_API
+int EnumSharedResults(
+    _Out_writes_opt_(*count) SharedResult_t* results,
+    _Inout_ UINT32* count
+);
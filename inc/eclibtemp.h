@@ -0,0 +1,55 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Temperature threshold subscriptions, part of eclib.h which apps include instead
+
+// Flags passed to a TEMPERATURE_CALLBACK
+#define TEMP_ALERT_LOW      0x1 // Temperature is below the low threshold
+#define TEMP_ALERT_HIGH     0x2 // Temperature is above the high threshold
+#define TEMP_ALERT_POLLED   0x4 // EC thresholds are not available, the reading came from polling
+
+typedef VOID (CALLBACK *TEMPERATURE_CALLBACK)(
+    _In_ UINT32 sensor,
+    _In_ UINT32 temperature,
+    _In_ UINT32 flags,
+    _In_opt_ PVOID context
+);
+
+ECLIB_API
+int SubscribeTemperature(
+    _In_ UINT32 sensor,
+    _In_ UINT32 low,
+    _In_ UINT32 high,
+    _In_ UINT32 hysteresis,
+    _In_ TEMPERATURE_CALLBACK callback,
+    _In_opt_ PVOID context,
+    _Out_ UINT32* subscription
+);
+
+ECLIB_API
+int UnsubscribeTemperature(
+    _In_ UINT32 subscription
+);
@@ -0,0 +1,47 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Traces of calls and driver events, part of eclib.h which apps include instead
+
+// Traces of calls and the driver events they cause, see ectrace.h for the file layout
+typedef struct {
+    UINT64 calls;           // eclib calls traced
+    UINT64 driverevents;    // Events read from the driver timeline
+    UINT64 lost;            // Driver events overwritten before they were read
+    UINT64 bytes;           // Size of the trace
+    UINT32 driver;          // The driver supports IOCTL_TIMELINE_READ
+    UINT32 writefailed;     // Events were dropped because a write failed
+} TraceStats_t;
+
+ECLIB_API
+int StartTrace(
+    _In_ const char* file
+);
+
+ECLIB_API
+int StopTrace(
+    _Out_opt_ TraceStats_t* stats
+);
@@ -0,0 +1,31 @@
+#pragma once
+
+// IOCTL_LOG_READ follows the EC log stream, see EC_LOG_GEO_MAGIC in ecring.h. Each reader keeps
+// its own cursor, a stream position, and the driver copies the whole records from the cursor
+// on straight out of the shared ring, so the driver holds no copy of the log and readers never
+// hold each other up. A reader that falls more than the ring size behind loses the overwritten
+// records and is told how many bytes it missed. With no record after the cursor the read waits
+// for the EC log doorbell, a fallback poll or the timeout.
+#define LOG_READ_NEWEST         0x1         // Start at the newest position instead of the cursor
+#define LOG_READ_NOWAIT         0x2         // Complete at once even with no records
+#define LOG_READ_MAX_LENGTH     0x10000
+
+typedef struct {
+    UINT64 cursor;      // Stream position to read from, 0 for the oldest record
+    UINT32 timeout;     // ms to wait for a record, 0 waits forever
+    UINT32 flags;       // LOG_READ_*
+} LogReadReq_t;
+
+typedef struct {
+    UINT64 cursor;      // Position to pass to the next read
+    UINT64 lost;        // Bytes overwritten before they were read
+    UINT64 frequency;   // EC timestamp ticks per second, 0 if the EC did not publish it
+    UINT64 ectime;      // EC timestamp clock read together with hosttime, 0 if not available
+    UINT64 hosttime;    // KeQueryPerformanceCounter when the records were copied
+    UINT64 hostfrequency;
+    UINT32 records;     // Records in data, timed out reads return none
+    UINT32 length;      // Bytes of records in data
+    UINT8  data[1];     // Records as in the ring without pad records
+} LogReadRsp_t;
+
+#define LOG_READ_RSP_HEADER_SIZE FIELD_OFFSET(LogReadRsp_t, data)
@@ -0,0 +1,870 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Generated by tools/aslbind.py from ectest.asl and thermal.asl, do not edit.
+// Run "python3 tools/aslbind.py" from the root of the repository after changing the ASL.
+
+#pragma once
+
+#include "acpibind.h"
+
+namespace ecmethods {
+
+// \_SB.ECT0
+namespace ECT0 {
+
+struct STA {
+    static constexpr size_t Length = 268;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.ECT0._STA")
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+struct TEST {
+    static constexpr size_t Length = 268;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.ECT0.TEST")
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+struct RGEO {
+    static constexpr size_t Length = 268;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.ECT0.RGEO")
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+};
+
+struct ASYQ {
+    static constexpr size_t Length = 268;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.ECT0.ASYQ")
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// Return the response, an Integer up to 8 bytes else a Buffer
+struct ASYC {
+    static constexpr size_t Length = 268;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.ECT0.ASYC")
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, acpiview::Arg& value)
+    {
+        return acpibind::Any(output, length, value);
+    }
+};
+
+struct TFWS {
+    static constexpr size_t Length = 268;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.ECT0.TFWS")
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+struct TNFY {
+    static constexpr size_t Length = 268;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.ECT0.TNFY")
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+};
+
+} // namespace ECT0
+
+// \_SB.FFA0
+namespace FFA0 {
+
+struct RNY {
+    static constexpr size_t Length = 268;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.FFA0._RNY")
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, acpiview::ArgList& elements)
+    {
+        return acpibind::Package(output, length, elements);
+    }
+};
+
+struct AVAL {
+    static constexpr size_t Length = 268;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.FFA0.AVAL")
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+} // namespace FFA0
+
+// \_SB.SKIN
+namespace SKIN {
+
+namespace Uuid {
+constexpr AcpiGuid_t Dsm = { 0x1f0849fc, 0xa845, 0x4fcf, { 0x86, 0x5c, 0x41, 0x01, 0xbf, 0x8e, 0x8d, 0x79 } }; // 1f0849fc-a845-4fcf-865c-4101bf8e8d79
+} // namespace Uuid
+
+struct TMP {
+    static constexpr size_t Length = 268;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.SKIN._TMP")
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// Arg0 Temp sensor ID
+struct GTMP {
+    static constexpr size_t Length = 276;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.SKIN.GTMP")
+                .Integer(0)
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request, uint32_t tempSensorId)
+    {
+        memcpy(request, Template().Data(), Length);
+        acpibind::Patch32(request, 272, tempSensorId);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// Arg0 Temp sensor ID
+// Arg1 Package with Timeout, Low and High set points
+struct THRS {
+    static constexpr size_t Length = 304;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.SKIN.THRS")
+                .Integer(0)
+                .Package().Integer(0).Integer(0).Integer(0).EndPackage()
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request, uint32_t tempSensorId, uint32_t timeout, uint32_t low, uint32_t high)
+    {
+        memcpy(request, Template().Data(), Length);
+        acpibind::Patch32(request, 272, tempSensorId);
+        acpibind::Patch32(request, 284, timeout);
+        acpibind::Patch32(request, 292, low);
+        acpibind::Patch32(request, 300, high);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// _DSM 1f0849fc-a845-4fcf-865c-4101bf8e8d79
+namespace Dsm {
+
+// 1f0849fc-a845-4fcf-865c-4101bf8e8d79 function 1, \_SB.SKIN.THRS
+struct THRS {
+    static constexpr size_t Length = 332;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.SKIN._DSM")
+                .Guid(Uuid::Dsm)
+                .Integer(0)
+                .Integer(1)
+                .Package().Integer(0).Integer(0).Integer(0).EndPackage()
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request, uint32_t timeout, uint32_t low, uint32_t high)
+    {
+        memcpy(request, Template().Data(), Length);
+        acpibind::Patch32(request, 312, timeout);
+        acpibind::Patch32(request, 320, low);
+        acpibind::Patch32(request, 328, high);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+} // namespace Dsm
+
+} // namespace SKIN
+
+// \_SB.THRM
+namespace THRM {
+
+namespace Uuid {
+constexpr AcpiGuid_t Input = { 0x07ff6382, 0xe29a, 0x47c9, { 0xac, 0x87, 0xe7, 0x9d, 0xad, 0x71, 0xdd, 0x82 } }; // 07ff6382-e29a-47c9-ac87-e79dad71dd82
+constexpr AcpiGuid_t OnTemp = { 0xba17b567, 0xc368, 0x48d5, { 0xbc, 0x6f, 0xa3, 0x12, 0xa4, 0x15, 0x83, 0xc1 } }; // ba17b567-c368-48d5-bc6f-a312a41583c1
+constexpr AcpiGuid_t RampTemp = { 0x3a62688c, 0xd95b, 0x4d2d, { 0xba, 0xcc, 0x90, 0xd7, 0xa5, 0x81, 0x6b, 0xcd } }; // 3a62688c-d95b-4d2d-bacc-90d7a5816bcd
+constexpr AcpiGuid_t MaxTemp = { 0xdcb758b1, 0xf0fd, 0x4ec7, { 0xb2, 0xc0, 0xef, 0x1e, 0x2a, 0x54, 0x7b, 0x76 } }; // dcb758b1-f0fd-4ec7-b2c0-ef1e2a547b76
+constexpr AcpiGuid_t Output = { 0xd9b9b7f3, 0x2a3e, 0x4064, { 0x88, 0x41, 0xcb, 0x13, 0xd3, 0x17, 0x66, 0x9e } }; // d9b9b7f3-2a3e-4064-8841-cb13d317669e
+} // namespace Uuid
+
+// Arg0 Instance ID
+// Arg1 UUID of variable
+// Return (Status,Value)
+struct GVAR {
+    static constexpr size_t Length = 296;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.THRM.GVAR")
+                .Integer(0)
+                .Guid({})
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request, uint32_t instanceId, const AcpiGuid_t& variableUuid)
+    {
+        memcpy(request, Template().Data(), Length);
+        acpibind::Patch32(request, 272, instanceId);
+        acpibind::PatchGuid(request, 280, variableUuid);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// Arg0 Instance ID
+// Arg1 UUID of variable
+// Arg2 Value
+// Return (Status,Value)
+struct SVAR {
+    static constexpr size_t Length = 304;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.THRM.SVAR")
+                .Integer(0)
+                .Guid({})
+                .Integer(0)
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request, uint32_t instanceId, const AcpiGuid_t& variableUuid, uint32_t value)
+    {
+        memcpy(request, Template().Data(), Length);
+        acpibind::Patch32(request, 272, instanceId);
+        acpibind::PatchGuid(request, 280, variableUuid);
+        acpibind::Patch32(request, 300, value);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// Arg0 Instance ID
+// Arg1 Package of up to 6 variable UUIDs
+// Return Package(7) of a bit per unknown variable then each value, in one FF-A request
+struct GVRS {
+    static constexpr size_t Length = 400;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.THRM.GVRS")
+                .Integer(0)
+                .Package().Guid({}).Guid({}).Guid({}).Guid({}).Guid({}).Guid({}).EndPackage()
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send, 0 if count is not 1 to 6.
+    static size_t Build(void* request, uint32_t instanceId, const AcpiGuid_t* uuids, uint32_t count)
+    {
+        if (count == 0 || count > 6) {
+            return 0;
+        }
+        const size_t length = 280 + count * 20;
+        memcpy(request, Template().Data(), length);
+        acpibind::Patch32(request, 272, instanceId);
+        for (uint32_t i = 0; i < count; i++) {
+            acpibind::PatchGuid(request, 284 + i * 20, uuids[i]);
+        }
+        return acpibind::Trim(request, 276, length);
+    }
+
+    static bool Result(const void* output, size_t length, acpiview::ArgList& elements)
+    {
+        return acpibind::Package(output, length, elements);
+    }
+};
+
+// Arg0 Instance ID
+// Arg1 Package of up to 5 variable UUID and value pairs, flattened
+// Return bit per unknown variable, in one FF-A request
+struct SVRS {
+    static constexpr size_t Length = 420;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.THRM.SVRS")
+                .Integer(0)
+                .Package().Guid({}).Integer(0).Guid({}).Integer(0).Guid({}).Integer(0).Guid({}).Integer(0).Guid({}).Integer(0).EndPackage()
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send, 0 if count is not 1 to 5.
+    static size_t Build(void* request, uint32_t instanceId, const AcpiGuid_t* uuids, const uint32_t* values, uint32_t count)
+    {
+        if (count == 0 || count > 5) {
+            return 0;
+        }
+        const size_t length = 280 + count * 28;
+        memcpy(request, Template().Data(), length);
+        acpibind::Patch32(request, 272, instanceId);
+        for (uint32_t i = 0; i < count; i++) {
+            acpibind::PatchGuid(request, 284 + i * 28, uuids[i]);
+            acpibind::Patch32(request, 304 + i * 28, values[i]);
+        }
+        return acpibind::Trim(request, 276, length);
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// _DSM 07ff6382-e29a-47c9-ac87-e79dad71dd82
+namespace Input {
+
+// 07ff6382-e29a-47c9-ac87-e79dad71dd82 function 1, \_SB.THRM.GVAR
+// Return (Status,Value)
+struct OnTemp {
+    static constexpr size_t Length = 312;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.THRM._DSM")
+                .Guid(Uuid::Input)
+                .Integer(0)
+                .Integer(1)
+                .Integer(0)
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// 07ff6382-e29a-47c9-ac87-e79dad71dd82 function 2, \_SB.THRM.GVAR
+// Return (Status,Value)
+struct RampTemp {
+    static constexpr size_t Length = 312;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.THRM._DSM")
+                .Guid(Uuid::Input)
+                .Integer(0)
+                .Integer(2)
+                .Integer(0)
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// 07ff6382-e29a-47c9-ac87-e79dad71dd82 function 3, \_SB.THRM.GVAR
+// Return (Status,Value)
+struct MaxTemp {
+    static constexpr size_t Length = 312;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.THRM._DSM")
+                .Guid(Uuid::Input)
+                .Integer(0)
+                .Integer(3)
+                .Integer(0)
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request)
+    {
+        memcpy(request, Template().Data(), Length);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// 07ff6382-e29a-47c9-ac87-e79dad71dd82 function 4, \_SB.THRM.GVRS
+// Return Package(7) of a bit per unknown variable then each value, in one FF-A request
+struct GVRS {
+    static constexpr size_t Length = 428;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.THRM._DSM")
+                .Guid(Uuid::Input)
+                .Integer(0)
+                .Integer(4)
+                .Package().Guid({}).Guid({}).Guid({}).Guid({}).Guid({}).Guid({}).EndPackage()
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send, 0 if count is not 1 to 6.
+    static size_t Build(void* request, const AcpiGuid_t* uuids, uint32_t count)
+    {
+        if (count == 0 || count > 6) {
+            return 0;
+        }
+        const size_t length = 308 + count * 20;
+        memcpy(request, Template().Data(), length);
+        for (uint32_t i = 0; i < count; i++) {
+            acpibind::PatchGuid(request, 312 + i * 20, uuids[i]);
+        }
+        return acpibind::Trim(request, 304, length);
+    }
+
+    static bool Result(const void* output, size_t length, acpiview::ArgList& elements)
+    {
+        return acpibind::Package(output, length, elements);
+    }
+};
+
+} // namespace Input
+
+// _DSM d9b9b7f3-2a3e-4064-8841-cb13d317669e
+namespace Output {
+
+// d9b9b7f3-2a3e-4064-8841-cb13d317669e function 1, \_SB.THRM.SVAR
+// Return (Status,Value)
+struct OnTemp {
+    static constexpr size_t Length = 312;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.THRM._DSM")
+                .Guid(Uuid::Output)
+                .Integer(0)
+                .Integer(1)
+                .Integer(0)
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request, uint32_t value)
+    {
+        memcpy(request, Template().Data(), Length);
+        acpibind::Patch32(request, 308, value);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// d9b9b7f3-2a3e-4064-8841-cb13d317669e function 2, \_SB.THRM.SVAR
+// Return (Status,Value)
+struct RampTemp {
+    static constexpr size_t Length = 312;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.THRM._DSM")
+                .Guid(Uuid::Output)
+                .Integer(0)
+                .Integer(2)
+                .Integer(0)
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request, uint32_t value)
+    {
+        memcpy(request, Template().Data(), Length);
+        acpibind::Patch32(request, 308, value);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// d9b9b7f3-2a3e-4064-8841-cb13d317669e function 3, \_SB.THRM.SVAR
+// Return (Status,Value)
+struct MaxTemp {
+    static constexpr size_t Length = 312;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.THRM._DSM")
+                .Guid(Uuid::Output)
+                .Integer(0)
+                .Integer(3)
+                .Integer(0)
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send.
+    static size_t Build(void* request, uint32_t value)
+    {
+        memcpy(request, Template().Data(), Length);
+        acpibind::Patch32(request, 308, value);
+        return Length;
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+// d9b9b7f3-2a3e-4064-8841-cb13d317669e function 4, \_SB.THRM.SVRS
+// Return bit per unknown variable, in one FF-A request
+struct SVRS {
+    static constexpr size_t Length = 448;
+
+    static const acpibind::Image<Length>& Template()
+    {
+        static constexpr acpibind::Image<Length> image =
+            acpibind::Image<Length>("\\_SB.THRM._DSM")
+                .Guid(Uuid::Output)
+                .Integer(0)
+                .Integer(4)
+                .Package().Guid({}).Integer(0).Guid({}).Integer(0).Guid({}).Integer(0).Guid({}).Integer(0).Guid({}).Integer(0).EndPackage()
+                .End();
+        static_assert(image.Length() == Length, "template does not match the generated offsets");
+        return image;
+    }
+
+    // Request in request, at least Length bytes. Returns the bytes to send, 0 if count is not 1 to 5.
+    static size_t Build(void* request, const AcpiGuid_t* uuids, const uint32_t* values, uint32_t count)
+    {
+        if (count == 0 || count > 5) {
+            return 0;
+        }
+        const size_t length = 308 + count * 28;
+        memcpy(request, Template().Data(), length);
+        for (uint32_t i = 0; i < count; i++) {
+            acpibind::PatchGuid(request, 312 + i * 28, uuids[i]);
+            acpibind::Patch32(request, 332 + i * 28, values[i]);
+        }
+        return acpibind::Trim(request, 304, length);
+    }
+
+    static bool Result(const void* output, size_t length, uint64_t& value)
+    {
+        return acpibind::Integer(output, length, value);
+    }
+};
+
+} // namespace Output
+
+} // namespace THRM
+
+// Every method of the ASL, bound or not, with the arguments it declares
+constexpr acpibind::MethodInfo Methods[] = {
+    { "\\_SB.ECT0._STA", 0 },
+    { "\\_SB.ECT0.TEST", 0 },
+    { "\\_SB.ECT0.RGEO", 0 },
+    { "\\_SB.ECT0.RVCN", 1 },
+    { "\\_SB.ECT0.SHDR", 2 },
+    { "\\_SB.ECT0.SSET", 3 },
+    { "\\_SB.ECT0.SCKR", 1 },
+    { "\\_SB.ECT0.SCKW", 2 },
+    { "\\_SB.ECT0.SENT", 3 },
+    { "\\_SB.ECT0.SPUT", 3 },
+    { "\\_SB.ECT0.RXDB", 1 },
+    { "\\_SB.ECT0.QTXB", 2 },
+    { "\\_SB.ECT0.ASYQ", 0 },
+    { "\\_SB.ECT0.ASYC", 0 },
+    { "\\_SB.ECT0.TFWS", 0 },
+    { "\\_SB.ECT0.TNFY", 0 },
+    { "\\_SB.FFA0._RNY", 0 },
+    { "\\_SB.FFA0._NFY", 2 },
+    { "\\_SB.FFA0.AVAL", 0 },
+    { "\\_SB.SKIN._TMP", 0 },
+    { "\\_SB.SKIN.GTMP", 1 },
+    { "\\_SB.SKIN.THRS", 2 },
+    { "\\_SB.SKIN._DSM", 4 },
+    { "\\_SB.THRM.GVAR", 2 },
+    { "\\_SB.THRM.SVAR", 3 },
+    { "\\_SB.THRM.GVRS", 2 },
+    { "\\_SB.THRM.SVRS", 2 },
+    { "\\_SB.THRM._DSM", 4 },
+};
+
+} // namespace ecmethods
+
+// Not bound:
+//   \_SB.ECT0.RVCN, Arg0 is not documented
+//   \_SB.ECT0.SHDR, Arg0 is not documented
+//   \_SB.ECT0.SSET, Arg0 is not documented
+//   \_SB.ECT0.SCKR, Arg0 is not documented
+//   \_SB.ECT0.SCKW, Arg0 is not documented
+//   \_SB.ECT0.SENT, Arg0 is not documented
+//   \_SB.ECT0.SPUT, Arg0 is not documented
+//   \_SB.ECT0.RXDB, Arg0 is not documented
+//   \_SB.ECT0.QTXB, buffer argument
+//   \_SB.FFA0._NFY, Arg0 is not documented
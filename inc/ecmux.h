@@ -0,0 +1,26 @@
+#pragma once
+
+// IOCTL_FFA_MUX sends a list of small EC commands. The driver packs commands for the same
+// service UUID into EC_MUX direct requests, see ecsvc.h, and splits the responses back into
+// the list, which is returned in place with the same layout.
+#define FFA_MUX_MAX_COMMANDS    32
+#define FFA_MUX_DATA_SIZE       32
+#define FFA_MUX_STATUS_NOT_SENT 0xFFFFFFFF
+
+typedef struct {
+    GUID   uuid;        // Service of the command
+    UINT8  inlen;       // Payload bytes of the command, starting with the command byte
+    UINT8  outoff;      // First payload byte of the output to return
+    UINT8  outlen;      // Output bytes to return
+    UINT8  reserved;
+    UINT32 status;      // 0 on success, EC status, failing NTSTATUS or FFA_MUX_STATUS_NOT_SENT
+    UINT8  data[FFA_MUX_DATA_SIZE]; // Input on request, output on return
+} FfaMuxCommand_t;
+
+typedef struct {
+    UINT32 count;       // Commands that follow
+    UINT32 calls;       // Direct requests the driver sent for them
+    FfaMuxCommand_t command[1];
+} FfaMuxReq_t;
+
+#define FFA_MUX_REQ_HEADER_SIZE FIELD_OFFSET(FfaMuxReq_t, command)
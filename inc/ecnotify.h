@@ -0,0 +1,36 @@
+#pragma once
+
+// Events are tracked per ACPI Notify value, which is 8 bits
+#define NOTIFY_EVENT_COUNT      256
+#define NOTIFY_EVENT_ALL        0xFFFFFFFF
+#define NOTIFY_COALESCE_MAX_US  10000000
+
+// Repeats of an event within the window after its first occurrence are folded into one
+// notification. The window is rounded up to the system timer resolution.
+typedef struct {
+    UINT32 event;       // Notify value, NOTIFY_EVENT_ALL for every event
+    UINT32 window;      // Window in us, 0 delivers every occurrence
+} CoalesceReq_t;
+
+typedef struct {
+    UINT64 count;       // Occurrences received
+    UINT64 delivered;   // Notifications completed to the app
+    UINT64 coalesced;   // Occurrences folded into another occurrence's notification
+    UINT64 lasttimestamp;
+    UINT32 window;      // Coalescing window in us
+    UINT32 pending;     // Occurrences not yet delivered
+} EventCounter_t;
+
+// Counters for events first to first + count - 1, limited by the output buffer size
+typedef struct {
+    UINT32 first;
+    UINT32 count;
+} EventCountersReq_t;
+
+typedef struct {
+    UINT32 first;
+    UINT32 count;       // Entries valid in counter
+    EventCounter_t counter[1];
+} EventCountersRsp_t;
+
+#define EVENT_COUNTERS_RSP_HEADER_SIZE FIELD_OFFSET(EventCountersRsp_t, counter)
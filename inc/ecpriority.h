@@ -0,0 +1,75 @@
+#pragma once
+
+// Priority classes for ACPI evaluation. IOCTL_ACPI_EVAL_PRIORITY takes an EvalPriorityReq_t
+// followed by the ACPI_EVAL_INPUT_BUFFER_*_EX and returns the ACPI output like
+// IOCTL_ACPI_EVAL_METHOD_EX, which is evaluated as EVAL_PRIORITY_NORMAL. Higher classes are
+// always dispatched first, waiting requests are aged up so lower classes are not starved.
+#define EVAL_PRIORITY_CRITICAL  0   // Thermal control and other time critical reads
+#define EVAL_PRIORITY_NORMAL    1
+#define EVAL_PRIORITY_BULK      2   // Telemetry, battery information, async ring transfers
+#define EVAL_PRIORITY_COUNT     3
+
+typedef struct {
+    UINT32 priority;    // EVAL_PRIORITY_*
+    UINT32 correlation; // Timeline correlation ID, 0 for none
+    UINT8  input[1];    // ACPI_EVAL_INPUT_BUFFER_*_EX
+} EvalPriorityReq_t;
+
+#define EVAL_PRIORITY_REQ_HEADER_SIZE FIELD_OFFSET(EvalPriorityReq_t, input)
+
+// IOCTL_ACPI_EVAL_METHOD_EX input may end with an EvalCorrelation_t to pass a timeline
+// correlation ID without changing how the evaluation is queued. The driver strips it before
+// the input reaches ACPI.
+#define EVAL_CORRELATION_SIGNATURE 0x524F4345  // 'ECOR'
+
+typedef struct {
+    UINT32 correlation; // Timeline correlation ID
+    UINT32 signature;   // EVAL_CORRELATION_SIGNATURE, last so it is found from the end
+} EvalCorrelation_t;
+
+typedef struct {
+    UINT32 depth;       // Requests waiting to be dispatched
+    UINT32 inflight;    // Requests being evaluated
+    UINT64 dispatched;
+    UINT64 aged;        // Dispatched in a higher class because of waiting time
+    UINT64 waittotal;   // Queue wait of dispatched requests in 100ns units
+    UINT64 waitmax;
+    UINT64 servicetotal;// Evaluation time of completed requests in 100ns units
+    UINT64 servicemax;
+    UINT64 completed;
+} EvalPriorityStats_t;
+
+typedef struct {
+    EvalPriorityStats_t classes[EVAL_PRIORITY_COUNT];
+} EvalPriorityStatsRsp_t;
+
+// Evaluations are sharded by the ACPI device path of the method, everything before the last
+// '.', so a Serialized method blocking on one device does not hold up the others. Each shard
+// has its own priority queues and in flight limit. A shard with nothing queued or in flight is
+// given to the next new device. Devices that find every shard busy share shard 0, whose prefix
+// is empty.
+#define EVAL_SHARD_COUNT        8
+#define EVAL_SHARD_PREFIX_LEN   32  // Longer device paths are truncated here, shards match the full path
+
+typedef struct {
+    char   prefix[EVAL_SHARD_PREFIX_LEN]; // Device path, empty for the shared shard
+    UINT32 limit;       // Evaluations this shard may have in flight
+    UINT32 inflight;
+    UINT32 depth;       // Requests waiting in all classes
+    UINT32 reserved;
+    UINT64 dispatched;
+    UINT64 deferred;    // Dispatch passes that found room in this shard but not in the total limit
+    UINT64 waittotal;   // Queue wait of dispatched requests in 100ns units
+    UINT64 waitmax;
+    UINT64 servicetotal;// Evaluation time of completed requests in 100ns units
+    UINT64 servicemax;
+    UINT64 completed;
+} EvalShardStats_t;
+
+typedef struct {
+    UINT32 count;       // Shards in use
+    UINT32 inflight;    // Evaluations in flight across all shards
+    UINT32 limit;       // Total in flight limit across all shards
+    UINT32 reserved;
+    EvalShardStats_t shards[EVAL_SHARD_COUNT];
+} EvalShardStatsRsp_t;
@@ -0,0 +1,443 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+// Layout of the session recordings eclib writes with StartRecording and replays with
+// ReplayRecording, and that ecload replays against the emulator. A recording is a header
+// followed by records appended in completion order, so a file cut short by a crash is still
+// readable up to its last whole record. The reader walks a mapped file in place.
+//
+// Each record is a KIND byte followed by LEB128 varints and raw bytes. Times are in 100ns units
+// from the header's base; each record stores the zigzag coded difference from the previous
+// record's start, which may be negative as calls on other threads complete out of order.
+// Method names and service UUIDs are written once as NAME records and referred to by their ID,
+// the order they were defined in.
+//
+//   NAME    ID LENGTH BYTES
+//   EVAL    DT DURATION NAME PRIORITY+1 SIGNATURE STATUS CAPACITY TAILLEN TAIL OUTLEN OUTPUT
+//   FFA     DT DURATION STATUS CALLS COUNT, COUNT times UUID INLEN(8) OUTOFF(8) OUTLEN(8) STATUS
+//           INPUT[INLEN] OUTPUT[OUTLEN]
+//
+// NAME records always come before the record that first uses the name.
+//   NOTIFY  DT EVENT LENGTH RESPONSE
+//
+// TAIL is the evaluation input after the method name, or all of it for inputs without a name,
+// which are recorded with an empty NAME. PRIORITY+1 is 0 for EvaluateAcpi.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define EC_RECORD_SIGNATURE     0x63524345 // 'ECRc'
+#define EC_RECORD_VERSION       1
+#define EC_RECORD_HEADER_SIZE   32
+#define EC_RECORD_CLOCK         10000000   // Ticks per second of times and durations
+
+// Header at offset 0
+#define EC_RECORD_SIGNATURE_OFFSET  0x00 // UINT32
+#define EC_RECORD_VERSION_OFFSET    0x04 // UINT16
+#define EC_RECORD_HEADER_OFFSET     0x06 // UINT16 bytes before the first record
+#define EC_RECORD_CLOCK_OFFSET      0x08 // UINT32 EC_RECORD_CLOCK
+#define EC_RECORD_START_OFFSET      0x10 // UINT64 FILETIME when recording started, time 0
+
+#define EC_RECORD_NAME          1
+#define EC_RECORD_EVAL          2
+#define EC_RECORD_FFA           3
+#define EC_RECORD_NOTIFY        4
+
+#define EC_RECORD_EVAL_HEADER   260        // Signature and MethodName of ACPI_EVAL_INPUT_BUFFER_*_EX, before TAIL
+#define EC_RECORD_NAME_MAX      256
+#define EC_RECORD_UUID_SIZE     16
+
+#ifdef __cplusplus
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ecrecord {
+
+// Appends records to a buffer the caller flushes, names stay defined across flushes
+class Writer {
+public:
+    Writer() : m_count(0), m_last(0) {}
+
+    void Header(uint64_t start)
+    {
+        uint8_t header[EC_RECORD_HEADER_SIZE] = {};
+        uint32_t signature = EC_RECORD_SIGNATURE;
+        uint16_t version = EC_RECORD_VERSION;
+        uint16_t size = EC_RECORD_HEADER_SIZE;
+        uint32_t clock = EC_RECORD_CLOCK;
+        memcpy(header + EC_RECORD_SIGNATURE_OFFSET, &signature, sizeof(signature));
+        memcpy(header + EC_RECORD_VERSION_OFFSET, &version, sizeof(version));
+        memcpy(header + EC_RECORD_HEADER_OFFSET, &size, sizeof(size));
+        memcpy(header + EC_RECORD_CLOCK_OFFSET, &clock, sizeof(clock));
+        memcpy(header + EC_RECORD_START_OFFSET, &start, sizeof(start));
+        m_buffer.insert(m_buffer.end(), header, header + sizeof(header));
+    }
+
+    // priority is UINT32_MAX for EvaluateAcpi
+    void Eval(uint64_t time, uint64_t duration, const char* method, uint32_t priority, uint32_t signature,
+              uint32_t status, size_t capacity, const void* tail, size_t tail_len, const void* output, size_t output_len)
+    {
+        uint32_t name = Name(method, strnlen(method, EC_RECORD_NAME_MAX));
+        m_buffer.push_back(EC_RECORD_EVAL);
+        Time(time);
+        Put(duration);
+        Put(name);
+        Put(static_cast<uint32_t>(priority + 1));
+        Put(signature);
+        Put(status);
+        Put(capacity);
+        Bytes(tail, tail_len);
+        Bytes(output, output_len);
+    }
+
+    // Commands of the next FFA record, written by Ffa
+    void Command(const void* uuid, uint8_t inlen, uint8_t outoff, uint8_t outlen, uint32_t status,
+                 const void* input, const void* output)
+    {
+        uint32_t name = Name(static_cast<const char*>(uuid), EC_RECORD_UUID_SIZE);
+        Put(m_commands, name);
+        m_commands.push_back(inlen);
+        m_commands.push_back(outoff);
+        m_commands.push_back(outlen);
+        Put(m_commands, status);
+        Raw(m_commands, input, inlen);
+        Raw(m_commands, output, outlen);
+        m_count++;
+    }
+
+    void Ffa(uint64_t time, uint64_t duration, uint32_t status, uint32_t calls)
+    {
+        m_buffer.push_back(EC_RECORD_FFA);
+        Time(time);
+        Put(duration);
+        Put(status);
+        Put(calls);
+        Put(m_count);
+        m_buffer.insert(m_buffer.end(), m_commands.begin(), m_commands.end());
+        m_commands.clear();
+        m_count = 0;
+    }
+
+    void Notify(uint64_t time, uint32_t event, const void* response, size_t length)
+    {
+        m_buffer.push_back(EC_RECORD_NOTIFY);
+        Time(time);
+        Put(event);
+        Bytes(response, length);
+    }
+
+    const uint8_t* Data() const { return m_buffer.data(); }
+    size_t Length() const { return m_buffer.size(); }
+    void Clear() { m_buffer.clear(); }
+    void Reserve(size_t length) { m_buffer.reserve(length); }
+
+private:
+    uint32_t Name(const char* name, size_t length)
+    {
+        std::string key(name, length);
+        auto it = m_names.find(key);
+        if (it != m_names.end()) {
+            return it->second;
+        }
+
+        uint32_t id = static_cast<uint32_t>(m_names.size());
+        m_names.emplace(std::move(key), id);
+        m_buffer.push_back(EC_RECORD_NAME);
+        Put(id);
+        Bytes(name, length);
+        return id;
+    }
+
+    void Time(uint64_t time)
+    {
+        int64_t delta = static_cast<int64_t>(time - m_last);
+        m_last = time;
+        Put((static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+    }
+
+    static void Put(std::vector<uint8_t>& buffer, uint64_t value)
+    {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<uint8_t>(value));
+    }
+
+    static void Raw(std::vector<uint8_t>& buffer, const void* data, size_t length)
+    {
+        if (length > 0) {
+            auto p = static_cast<const uint8_t*>(data);
+            buffer.insert(buffer.end(), p, p + length);
+        }
+    }
+
+    void Put(uint64_t value) { Put(m_buffer, value); }
+
+    void Bytes(const void* data, size_t length)
+    {
+        Put(length);
+        Raw(m_buffer, data, length);
+    }
+
+    std::vector<uint8_t> m_buffer;
+    std::vector<uint8_t> m_commands;
+    uint32_t m_count;
+    std::unordered_map<std::string, uint32_t> m_names;
+    uint64_t m_last;
+};
+
+// One command of an FFA record
+struct Command {
+    const uint8_t* uuid;        // EC_RECORD_UUID_SIZE bytes
+    uint8_t inlen;
+    uint8_t outoff;
+    uint8_t outlen;
+    uint32_t status;
+    const uint8_t* input;
+    const uint8_t* output;
+};
+
+// One record, pointers are into the recording. NAME records are consumed by the reader
+struct Record {
+    uint8_t kind;
+    uint64_t time;              // From the start of the recording
+    uint64_t duration;          // EVAL and FFA
+    const char* name;           // EVAL method, not NUL terminated
+    size_t name_len;
+    uint32_t priority;          // EVAL, UINT32_MAX for EvaluateAcpi
+    uint32_t signature;         // EVAL input signature
+    uint32_t status;            // EVAL and FFA
+    size_t capacity;            // EVAL output buffer size
+    const uint8_t* tail;        // EVAL input after the method name
+    size_t tail_len;
+    const uint8_t* output;      // EVAL output, NOTIFY response
+    size_t output_len;
+    uint32_t calls;             // FFA
+    uint32_t count;             // FFA commands, walk them with Reader::NextCommand
+    uint32_t event;             // NOTIFY
+};
+
+// Walks a recording in place. Next stops at the end or at the first damaged or cut off record,
+// Truncated tells which
+class Reader {
+public:
+    Reader(const void* data, size_t length)
+        : m_data(static_cast<const uint8_t*>(data)), m_end(m_data + length), m_next(m_end), m_time(0),
+          m_valid(false), m_truncated(false), m_start(0), m_commands(nullptr), m_left(0)
+    {
+        uint32_t signature = 0;
+        uint16_t version = 0;
+        uint16_t size = 0;
+        if (length >= EC_RECORD_HEADER_SIZE) {
+            memcpy(&signature, m_data + EC_RECORD_SIGNATURE_OFFSET, sizeof(signature));
+            memcpy(&version, m_data + EC_RECORD_VERSION_OFFSET, sizeof(version));
+            memcpy(&size, m_data + EC_RECORD_HEADER_OFFSET, sizeof(size));
+            memcpy(&m_start, m_data + EC_RECORD_START_OFFSET, sizeof(m_start));
+        }
+        if (signature == EC_RECORD_SIGNATURE && version == EC_RECORD_VERSION && size >= EC_RECORD_HEADER_SIZE &&
+            size <= length) {
+            m_next = m_data + size;
+            m_valid = true;
+        }
+    }
+
+    bool Valid() const { return m_valid; }
+    bool Truncated() const { return m_truncated; }
+    uint64_t Start() const { return m_start; }
+
+    bool Next(Record& record)
+    {
+        m_left = 0;
+        for (;;) {
+            const uint8_t* p = m_next;
+            if (p == m_end) {
+                return false;
+            }
+
+            memset(&record, 0, sizeof(record));
+            record.kind = *p++;
+            uint64_t id, length, delta, value, duration;
+
+            switch (record.kind) {
+            case EC_RECORD_NAME:
+                if (!Get(p, id) || id != m_names.size() || !Get(p, length) || length > static_cast<size_t>(m_end - p)) {
+                    return Fail();
+                }
+                m_names.emplace_back(reinterpret_cast<const char*>(p), static_cast<size_t>(length));
+                m_next = p + length;
+                continue;
+
+            case EC_RECORD_EVAL:
+                if (!Get(p, delta) || !Get(p, duration) || !Get(p, id) || id >= m_names.size()) {
+                    return Fail();
+                }
+                record.duration = duration;
+                record.name = m_names[id].first;
+                record.name_len = m_names[id].second;
+                if (!Get(p, value)) {
+                    return Fail();
+                }
+                record.priority = static_cast<uint32_t>(value - 1);
+                if (!Get32(p, record.signature) || !Get32(p, record.status) || !Get(p, value) ||
+                    !GetBytes(p, record.tail, record.tail_len)) {
+                    return Fail();
+                }
+                record.capacity = static_cast<size_t>(value);
+                if (!GetBytes(p, record.output, record.output_len)) {
+                    return Fail();
+                }
+                break;
+
+            case EC_RECORD_FFA:
+                if (!Get(p, delta) || !Get(p, duration) || !Get32(p, record.status) || !Get32(p, record.calls) ||
+                    !Get32(p, record.count)) {
+                    return Fail();
+                }
+                // Checked whole here, so NextCommand cannot fail part way
+                record.duration = duration;
+                m_commands = p;
+                for (uint32_t i = 0; i < record.count; i++) {
+                    ecrecord::Command command;
+                    if (!ParseCommand(p, command)) {
+                        return Fail();
+                    }
+                }
+                m_left = record.count;
+                break;
+
+            case EC_RECORD_NOTIFY:
+                if (!Get(p, delta) || !Get32(p, record.event) || !GetBytes(p, record.output, record.output_len)) {
+                    return Fail();
+                }
+                break;
+
+            default:
+                return Fail();
+            }
+
+            m_time += (delta >> 1) ^ (0 - (delta & 1));
+            record.time = m_time;
+            m_next = p;
+            return true;
+        }
+    }
+
+    // Commands of the FFA record Next returned last, in order
+    bool NextCommand(Command& command)
+    {
+        if (m_left == 0) {
+            return false;
+        }
+        m_left--;
+        return ParseCommand(m_commands, command);
+    }
+
+private:
+    bool ParseCommand(const uint8_t*& p, Command& command) const
+    {
+        uint64_t id;
+        if (!Get(p, id) || id >= m_names.size() || m_names[id].second != EC_RECORD_UUID_SIZE || m_end - p < 3) {
+            return false;
+        }
+        command.uuid = reinterpret_cast<const uint8_t*>(m_names[id].first);
+        command.inlen = p[0];
+        command.outoff = p[1];
+        command.outlen = p[2];
+        p += 3;
+        if (!Get32(p, command.status) ||
+            static_cast<size_t>(m_end - p) < static_cast<size_t>(command.inlen) + command.outlen) {
+            return false;
+        }
+        command.input = p;
+        command.output = p + command.inlen;
+        p += command.inlen + command.outlen;
+        return true;
+    }
+
+    bool Fail()
+    {
+        m_truncated = true;
+        m_next = m_end;
+        m_left = 0;
+        return false;
+    }
+
+    bool Get(const uint8_t*& p, uint64_t& value) const
+    {
+        value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (p == m_end) {
+                return false;
+            }
+            uint8_t byte = *p++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Get32(const uint8_t*& p, uint32_t& value) const
+    {
+        uint64_t v;
+        if (!Get(p, v) || v > UINT32_MAX) {
+            return false;
+        }
+        value = static_cast<uint32_t>(v);
+        return true;
+    }
+
+    bool GetBytes(const uint8_t*& p, const uint8_t*& data, size_t& length) const
+    {
+        uint64_t v;
+        if (!Get(p, v) || v > static_cast<size_t>(m_end - p)) {
+            return false;
+        }
+        data = p;
+        length = static_cast<size_t>(v);
+        p += length;
+        return true;
+    }
+
+    const uint8_t* m_data;
+    const uint8_t* m_end;
+    const uint8_t* m_next;
+    uint64_t m_time;
+    bool m_valid;
+    bool m_truncated;
+    uint64_t m_start;
+    const uint8_t* m_commands;
+    uint32_t m_left;
+    std::vector<std::pair<const char*, size_t>> m_names;
+};
+
+} // namespace ecrecord
+#endif // __cplusplus
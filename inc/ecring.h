@@ -0,0 +1,755 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Layout of the shared memory ring used for async EC traffic, see RGEO/SHDR/SSET in ectest.asl.
+// The OS queues requests into the TX ring and the EC service posts responses into the RX ring.
+//
+// The region starts with a geometry header published by UEFI, so the slot count and entry size
+// can change without rebuilding the driver, ASL or host tools. Each ring starts with
+// VER(16) CNT(16) RSVD(32) followed by one 64-bit slot header per entry, entries start at the
+// entry offset which is the first 256 byte boundary after the slot headers.
+
+#define EC_RING_PAGE_SIZE       0x1000
+#define EC_RING_SLOT_OFFSET     0x8
+#define EC_RING_ENTRY_ALIGN     0x100
+
+// Geometry header at offset 0 of the shared region
+#define EC_RING_GEO_MAGIC       0x47524345 // 'ECRG'
+#define EC_RING_GEO_VERSION     1
+#define EC_RING_GEO_SIZE        0x20
+
+#define EC_RING_GEO_MAGIC_OFFSET        0x00 // UINT32
+#define EC_RING_GEO_VERSION_OFFSET      0x04 // UINT16
+#define EC_RING_GEO_HEADER_SIZE_OFFSET  0x06 // UINT16
+#define EC_RING_GEO_REGION_SIZE_OFFSET  0x08 // UINT32 bytes shared with the EC including this header
+#define EC_RING_GEO_SLOT_COUNT_OFFSET   0x0C // UINT16 slots per ring
+#define EC_RING_GEO_ENTRY_SIZE_OFFSET   0x0E // UINT16 bytes per entry
+#define EC_RING_GEO_TX_OFFSET_OFFSET    0x10 // UINT32 TX ring offset from start of region
+#define EC_RING_GEO_RX_OFFSET_OFFSET    0x14 // UINT32 RX ring offset from start of region
+#define EC_RING_GEO_RING_SIZE_OFFSET    0x18 // UINT32 bytes per ring
+#define EC_RING_GEO_ENTRY_OFFSET_OFFSET 0x1C // UINT16 entry offset from start of ring
+
+// Entry size must be a multiple of EC_RING_ENTRY_ALIGN so ASL can copy it in 256 byte chunks
+#define EC_RING_SLOT_MIN        1
+#define EC_RING_SLOT_MAX        64
+#define EC_RING_ENTRY_MIN       0x100
+#define EC_RING_ENTRY_MAX       0x1000
+
+#define EC_RING_ALIGN_UP(v, a)              (((v) + (a) - 1) & ~((a) - 1))
+#define EC_RING_ENTRY_OFFSET_FOR(slots)     EC_RING_ALIGN_UP(EC_RING_SLOT_OFFSET + (slots) * 8, EC_RING_ENTRY_ALIGN)
+#define EC_RING_SIZE_FOR(slots, entry)      EC_RING_ALIGN_UP(EC_RING_ENTRY_OFFSET_FOR(slots) + (slots) * (entry), EC_RING_PAGE_SIZE)
+
+// Geometry used when no valid header is found, matches the default UEFI publishes
+#define EC_RING_DEFAULT_SLOT_COUNT  8
+#define EC_RING_DEFAULT_ENTRY_SIZE  0x100
+#define EC_RING_DEFAULT_TX_OFFSET   EC_RING_PAGE_SIZE
+#define EC_RING_DEFAULT_RING_SIZE   EC_RING_SIZE_FOR(EC_RING_DEFAULT_SLOT_COUNT, EC_RING_DEFAULT_ENTRY_SIZE)
+#define EC_RING_DEFAULT_RX_OFFSET   (EC_RING_DEFAULT_TX_OFFSET + EC_RING_DEFAULT_RING_SIZE)
+
+// Slot header TBx/RBx: SEQ[15:0] LEN[31:16] VALID[32] MORE[33] FRAG[43:34] TOTAL[63:44]
+// A header of zero means the slot is free.
+//
+// Messages larger than one entry are split into fragments that share the same SEQ. FRAG is the
+// index of the fragment, MORE is set on every fragment except the last and TOTAL holds the length
+// of the whole message. A single entry message leaves MORE, FRAG and TOTAL zero.
+#define EC_SLOT_SEQ(h)          ((h) & 0xFFFF)
+#define EC_SLOT_LEN(h)          (((h) >> 16) & 0xFFFF)
+#define EC_SLOT_VALID           (1ULL << 32)
+#define EC_SLOT_MORE            (1ULL << 33)
+#define EC_SLOT_FRAG(h)         (((h) >> 34) & 0x3FF)
+#define EC_SLOT_TOTAL(h)        (((h) >> 44) & 0xFFFFF)
+
+#define EC_SLOT_FRAG_MAX        0x400
+#define EC_SLOT_TOTAL_MAX       0xFFFFF
+
+// FF-A notification IDs raised by the EC management service as doorbells
+#define EC_NOTIFY_RX_DOORBELL   0x4 // Response posted to RX page
+#define EC_NOTIFY_TX_DOORBELL   0x5 // Entries consumed from TX page
+
+// ACPI Notify() values raised on ECT0
+#define EC_ACPI_NOTIFY_EVENT    0x20 // Generic EC event, FF-A notify ID is in NEVT
+#define EC_ACPI_NOTIFY_DOORBELL 0x21 // RX doorbell, driver completes sequence waiters
+
+// Event record in the geometry page. The EC fills it before raising an event notification so the
+// driver can hand the event data to consumers along with the notification. GEN is odd while the
+// EC is writing the record, readers retry or drop the record if GEN changes under them.
+#define EC_EVENT_OFFSET         0x100
+#define EC_EVENT_GEN_OFFSET     0x100 // UINT32 generation, incremented before and after each update
+#define EC_EVENT_ID_OFFSET      0x104 // UINT32 FF-A notify ID of the event
+#define EC_EVENT_LENGTH_OFFSET  0x108 // UINT32 bytes valid in DATA
+#define EC_EVENT_DATA_OFFSET    0x110
+#define EC_EVENT_DATA_MAX       0xF0
+#define EC_EVENT_READ_RETRIES   3
+
+// Bulk buffer pool table in the geometry page, published by UEFI after the ring geometry. Each
+// buffer is shared with the EC in its own FFA_MEM_SHARE and retrieved by the EC once at boot, so
+// a transfer only passes the buffer's memory handle in an EC_CAP_BULK direct request. Offsets
+// are from the start of the shared region. The magic is written last.
+#define EC_BULK_MAGIC           0x4B424345 // 'ECBK'
+#define EC_BULK_MAGIC_OFFSET    0x40 // UINT32
+#define EC_BULK_COUNT_OFFSET    0x44 // UINT16 buffers in the pool
+#define EC_BULK_SIZE_OFFSET     0x48 // UINT32 bytes per buffer, a multiple of EC_RING_PAGE_SIZE
+#define EC_BULK_ENTRY_OFFSET    0x50 // Per buffer UINT64 handle then UINT64 offset
+#define EC_BULK_ENTRY_SIZE      0x10
+#define EC_BULK_BUFFER_MAX      8
+
+// Log stream ring published by UEFI in the geometry page. The EC appends console and diagnostic
+// records to it and the host follows it with its own cursor, see the log header below.
+#define EC_LOG_GEO_MAGIC        0x474C4345 // 'ECLG'
+#define EC_LOG_GEO_MAGIC_OFFSET 0x20 // UINT32
+#define EC_LOG_GEO_OFFSET_OFFSET 0x24 // UINT32 log header offset from start of region, page aligned
+#define EC_LOG_GEO_SIZE_OFFSET  0x28 // UINT32 record bytes after the header, a power of two
+
+// Log header, followed by the records at EC_LOG_DATA_OFFSET. Positions are byte offsets in the
+// stream since the EC started, a record at position p lives at p % size. The EC writes a record
+// and then moves HEAD past it. Before it overwrites older records it moves TAIL past them, so a
+// reader that copied records from position p still has them intact if TAIL is not past p after
+// the copy. Records never wrap, the EC fills the end of the ring with a pad record instead.
+#define EC_LOG_HEAD_OFFSET      0x00 // UINT64 position after the newest record, written by the EC
+#define EC_LOG_TAIL_OFFSET      0x08 // UINT64 position of the oldest record, written by the EC
+#define EC_LOG_FREQUENCY_OFFSET 0x10 // UINT64 timestamp ticks per second, written by the EC
+#define EC_LOG_ARMED_OFFSET     0x20 // UINT32 set by the host, the EC clears it and rings the doorbell
+#define EC_LOG_DATA_OFFSET      0x40
+#define EC_LOG_SIZE_MIN         0x1000
+#define EC_LOG_SIZE_MAX         0x100000
+
+// Record: SIZE(16) LEVEL(8) FLAGS(8) SOURCE(16) LENGTH(16) TIMESTAMP(64) then LENGTH bytes of
+// text. SIZE covers the header and the text padded to 8 bytes. Timestamps are the Arm generic
+// counter which the EC and the OS share, so they line up with host QueryPerformanceCounter.
+#define EC_LOG_RECORD_SIZE_OFFSET   0x00 // UINT16
+#define EC_LOG_RECORD_LEVEL_OFFSET  0x02 // UINT8 EC_LOG_LEVEL_*
+#define EC_LOG_RECORD_FLAGS_OFFSET  0x03 // UINT8 EC_LOG_FLAG_*
+#define EC_LOG_RECORD_SOURCE_OFFSET 0x04 // UINT16 service or partition that logged it
+#define EC_LOG_RECORD_LENGTH_OFFSET 0x06 // UINT16 text bytes
+#define EC_LOG_RECORD_TIME_OFFSET   0x08 // UINT64
+#define EC_LOG_RECORD_HEADER_SIZE   0x10
+#define EC_LOG_RECORD_ALIGN         8
+#define EC_LOG_TEXT_MAX             0xF0
+#define EC_LOG_FLAG_PAD             0x01 // Skip to the start of the ring, carries no text
+
+#define EC_LOG_LEVEL_ERROR      1
+#define EC_LOG_LEVEL_WARNING    2
+#define EC_LOG_LEVEL_INFO       3
+#define EC_LOG_LEVEL_VERBOSE    4
+
+// FF-A notification and ACPI Notify() value of the log doorbell, only raised while armed
+#define EC_NOTIFY_LOG_DOORBELL  0x6
+#define EC_ACPI_NOTIFY_LOG      0x22
+
+// Fallback poll interval when no doorbell arrives, doubles on every timeout
+#define EC_RING_POLL_MIN_MS     1
+#define EC_RING_POLL_MAX_MS     64
+
+#ifdef __cplusplus
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Reference codec for the ring protocol. The driver and ASL implement the same rules, this is
+// used by host tools and to test against a local producer.
+namespace ecring {
+
+struct SlotHeader {
+    uint16_t seq = 0;
+    uint16_t length = 0;
+    bool valid = false;
+    bool more = false;
+    uint16_t fragment = 0;
+    uint32_t total = 0;
+
+    static SlotHeader Decode(uint64_t raw)
+    {
+        SlotHeader h;
+        h.seq = static_cast<uint16_t>(EC_SLOT_SEQ(raw));
+        h.length = static_cast<uint16_t>(EC_SLOT_LEN(raw));
+        h.valid = (raw & EC_SLOT_VALID) != 0;
+        h.more = (raw & EC_SLOT_MORE) != 0;
+        h.fragment = static_cast<uint16_t>(EC_SLOT_FRAG(raw));
+        h.total = static_cast<uint32_t>(EC_SLOT_TOTAL(raw));
+        return h;
+    }
+
+    uint64_t Encode() const
+    {
+        return static_cast<uint64_t>(seq) |
+               (static_cast<uint64_t>(length) << 16) |
+               (valid ? EC_SLOT_VALID : 0) |
+               (more ? EC_SLOT_MORE : 0) |
+               ((static_cast<uint64_t>(fragment) & 0x3FF) << 34) |
+               ((static_cast<uint64_t>(total) & EC_SLOT_TOTAL_MAX) << 44);
+    }
+
+    // Length of the whole message this fragment belongs to
+    uint32_t MessageLength() const { return (more || fragment != 0) ? total : length; }
+};
+
+// Ring geometry as published in the header at the start of the shared region
+struct Geometry {
+    uint32_t region_size = EC_RING_DEFAULT_RX_OFFSET + EC_RING_DEFAULT_RING_SIZE;
+    uint16_t slot_count = EC_RING_DEFAULT_SLOT_COUNT;
+    uint16_t entry_size = EC_RING_DEFAULT_ENTRY_SIZE;
+    uint32_t tx_offset = EC_RING_DEFAULT_TX_OFFSET;
+    uint32_t rx_offset = EC_RING_DEFAULT_RX_OFFSET;
+    uint32_t ring_size = EC_RING_DEFAULT_RING_SIZE;
+    uint16_t entry_offset = EC_RING_ENTRY_OFFSET_FOR(EC_RING_DEFAULT_SLOT_COUNT);
+
+    // Geometry for the given slot count and entry size with the rings packed after the header page
+    static Geometry Make(uint16_t slots, uint16_t entry_size)
+    {
+        Geometry g;
+        g.slot_count = slots;
+        g.entry_size = entry_size;
+        g.entry_offset = static_cast<uint16_t>(EC_RING_ENTRY_OFFSET_FOR(slots));
+        g.ring_size = EC_RING_SIZE_FOR(static_cast<uint32_t>(slots), static_cast<uint32_t>(entry_size));
+        g.tx_offset = EC_RING_PAGE_SIZE;
+        g.rx_offset = g.tx_offset + g.ring_size;
+        g.region_size = g.rx_offset + g.ring_size;
+        return g;
+    }
+
+    bool Valid() const
+    {
+        return slot_count >= EC_RING_SLOT_MIN && slot_count <= EC_RING_SLOT_MAX &&
+               entry_size >= EC_RING_ENTRY_MIN && entry_size <= EC_RING_ENTRY_MAX &&
+               (entry_size % EC_RING_ENTRY_ALIGN) == 0 &&
+               entry_offset >= EC_RING_ENTRY_OFFSET_FOR(slot_count) &&
+               static_cast<uint64_t>(entry_offset) + static_cast<uint64_t>(slot_count) * entry_size <= ring_size &&
+               tx_offset >= EC_RING_GEO_SIZE && rx_offset >= EC_RING_GEO_SIZE &&
+               static_cast<uint64_t>(tx_offset) + ring_size <= region_size &&
+               static_cast<uint64_t>(rx_offset) + ring_size <= region_size;
+    }
+
+    // Parse the header at the start of region, returns false and leaves defaults if not valid
+    bool Read(const void* region)
+    {
+        auto p = static_cast<const uint8_t*>(region);
+        if (Get<uint32_t>(p, EC_RING_GEO_MAGIC_OFFSET) != EC_RING_GEO_MAGIC ||
+            Get<uint16_t>(p, EC_RING_GEO_VERSION_OFFSET) != EC_RING_GEO_VERSION) {
+            return false;
+        }
+
+        Geometry g;
+        g.region_size = Get<uint32_t>(p, EC_RING_GEO_REGION_SIZE_OFFSET);
+        g.slot_count = Get<uint16_t>(p, EC_RING_GEO_SLOT_COUNT_OFFSET);
+        g.entry_size = Get<uint16_t>(p, EC_RING_GEO_ENTRY_SIZE_OFFSET);
+        g.tx_offset = Get<uint32_t>(p, EC_RING_GEO_TX_OFFSET_OFFSET);
+        g.rx_offset = Get<uint32_t>(p, EC_RING_GEO_RX_OFFSET_OFFSET);
+        g.ring_size = Get<uint32_t>(p, EC_RING_GEO_RING_SIZE_OFFSET);
+        g.entry_offset = Get<uint16_t>(p, EC_RING_GEO_ENTRY_OFFSET_OFFSET);
+        if (!g.Valid()) {
+            return false;
+        }
+
+        *this = g;
+        return true;
+    }
+
+    // Publish the header at the start of region as UEFI does
+    void Write(void* region) const
+    {
+        auto p = static_cast<uint8_t*>(region);
+        memset(p, 0, EC_RING_GEO_SIZE);
+        Put<uint32_t>(p, EC_RING_GEO_MAGIC_OFFSET, EC_RING_GEO_MAGIC);
+        Put<uint16_t>(p, EC_RING_GEO_VERSION_OFFSET, EC_RING_GEO_VERSION);
+        Put<uint16_t>(p, EC_RING_GEO_HEADER_SIZE_OFFSET, EC_RING_GEO_SIZE);
+        Put<uint32_t>(p, EC_RING_GEO_REGION_SIZE_OFFSET, region_size);
+        Put<uint16_t>(p, EC_RING_GEO_SLOT_COUNT_OFFSET, slot_count);
+        Put<uint16_t>(p, EC_RING_GEO_ENTRY_SIZE_OFFSET, entry_size);
+        Put<uint32_t>(p, EC_RING_GEO_TX_OFFSET_OFFSET, tx_offset);
+        Put<uint32_t>(p, EC_RING_GEO_RX_OFFSET_OFFSET, rx_offset);
+        Put<uint32_t>(p, EC_RING_GEO_RING_SIZE_OFFSET, ring_size);
+        Put<uint16_t>(p, EC_RING_GEO_ENTRY_OFFSET_OFFSET, entry_offset);
+    }
+
+private:
+    template <typename T>
+    static T Get(const uint8_t* p, size_t offset) { T v; memcpy(&v, p + offset, sizeof(v)); return v; }
+    template <typename T>
+    static void Put(uint8_t* p, size_t offset, T v) { memcpy(p + offset, &v, sizeof(v)); }
+};
+
+// Bulk buffer pool table, see EC_BULK_MAGIC
+struct BulkPool {
+    uint16_t count = 0;
+    uint32_t buffer_size = 0;
+    uint64_t handle[EC_BULK_BUFFER_MAX] = {};
+    uint64_t offset[EC_BULK_BUFFER_MAX] = {};
+
+    bool Valid(uint64_t region_size) const
+    {
+        if (count == 0 || count > EC_BULK_BUFFER_MAX || buffer_size == 0 || (buffer_size % EC_RING_PAGE_SIZE) != 0) {
+            return false;
+        }
+        for (uint16_t i = 0; i < count; i++) {
+            if ((offset[i] % EC_RING_PAGE_SIZE) != 0 || offset[i] + buffer_size > region_size) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Parse the table in the geometry page, returns false and leaves an empty pool if not valid
+    bool Read(const void* region, uint64_t region_size)
+    {
+        auto p = static_cast<const uint8_t*>(region);
+        if (Get<uint32_t>(p, EC_BULK_MAGIC_OFFSET) != EC_BULK_MAGIC) {
+            return false;
+        }
+
+        BulkPool b;
+        b.count = Get<uint16_t>(p, EC_BULK_COUNT_OFFSET);
+        b.buffer_size = Get<uint32_t>(p, EC_BULK_SIZE_OFFSET);
+        for (uint16_t i = 0; i < b.count && i < EC_BULK_BUFFER_MAX; i++) {
+            b.handle[i] = Get<uint64_t>(p, EC_BULK_ENTRY_OFFSET + i * EC_BULK_ENTRY_SIZE);
+            b.offset[i] = Get<uint64_t>(p, EC_BULK_ENTRY_OFFSET + i * EC_BULK_ENTRY_SIZE + 8);
+        }
+        if (!b.Valid(region_size)) {
+            return false;
+        }
+
+        *this = b;
+        return true;
+    }
+
+    // Publish the table in the geometry page as UEFI does, the magic goes last
+    void Write(void* region) const
+    {
+        auto p = static_cast<uint8_t*>(region);
+        memset(p + EC_BULK_MAGIC_OFFSET, 0, EC_BULK_ENTRY_OFFSET + EC_BULK_BUFFER_MAX * EC_BULK_ENTRY_SIZE - EC_BULK_MAGIC_OFFSET);
+        Put<uint16_t>(p, EC_BULK_COUNT_OFFSET, count);
+        Put<uint32_t>(p, EC_BULK_SIZE_OFFSET, buffer_size);
+        for (uint16_t i = 0; i < count; i++) {
+            Put<uint64_t>(p, EC_BULK_ENTRY_OFFSET + i * EC_BULK_ENTRY_SIZE, handle[i]);
+            Put<uint64_t>(p, EC_BULK_ENTRY_OFFSET + i * EC_BULK_ENTRY_SIZE + 8, offset[i]);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        Put<uint32_t>(p, EC_BULK_MAGIC_OFFSET, EC_BULK_MAGIC);
+    }
+
+private:
+    template <typename T>
+    static T Get(const uint8_t* p, size_t offset) { T v; memcpy(&v, p + offset, sizeof(v)); return v; }
+    template <typename T>
+    static void Put(uint8_t* p, size_t offset, T v) { memcpy(p + offset, &v, sizeof(v)); }
+};
+
+// One record of the log stream, as the EC writes it and the driver returns it
+struct LogRecord {
+    uint16_t size = 0;
+    uint8_t level = 0;
+    uint8_t flags = 0;
+    uint16_t source = 0;
+    uint64_t timestamp = 0;
+    std::string text;
+
+    // Size a record with this much text takes in the ring
+    static uint32_t SizeFor(size_t length)
+    {
+        return static_cast<uint32_t>(EC_RING_ALIGN_UP(EC_LOG_RECORD_HEADER_SIZE + length, EC_LOG_RECORD_ALIGN));
+    }
+
+    // Parse the record at p, returns false if fewer than its size bytes are available or it is
+    // malformed
+    bool Decode(const uint8_t* p, size_t available)
+    {
+        uint16_t length;
+        if (available < EC_LOG_RECORD_ALIGN) {
+            return false;
+        }
+        memcpy(&size, p + EC_LOG_RECORD_SIZE_OFFSET, sizeof(size));
+        flags = p[EC_LOG_RECORD_FLAGS_OFFSET];
+        if (size < EC_LOG_RECORD_ALIGN || (size % EC_LOG_RECORD_ALIGN) != 0 || size > available) {
+            return false;
+        }
+        if (flags & EC_LOG_FLAG_PAD) {
+            text.clear();
+            return true;
+        }
+
+        memcpy(&length, p + EC_LOG_RECORD_LENGTH_OFFSET, sizeof(length));
+        if (size < EC_LOG_RECORD_HEADER_SIZE || length > size - EC_LOG_RECORD_HEADER_SIZE) {
+            return false;
+        }
+        level = p[EC_LOG_RECORD_LEVEL_OFFSET];
+        memcpy(&source, p + EC_LOG_RECORD_SOURCE_OFFSET, sizeof(source));
+        memcpy(&timestamp, p + EC_LOG_RECORD_TIME_OFFSET, sizeof(timestamp));
+        text.assign(reinterpret_cast<const char*>(p + EC_LOG_RECORD_HEADER_SIZE), length);
+        return true;
+    }
+};
+
+// Accessor for the log stream ring. Append is the EC side, Read follows the stream the way the
+// driver does for IOCTL_LOG_READ.
+class LogRing {
+public:
+    LogRing(void* header, uint32_t size) : m_base(static_cast<uint8_t*>(header)), m_size(size) {}
+
+    // Parse the descriptor in the geometry page, returns the ring size or 0 if there is no ring
+    static uint32_t Find(const void* region, uint64_t region_size, uint32_t& offset)
+    {
+        auto p = static_cast<const uint8_t*>(region);
+        uint32_t magic, size;
+        memcpy(&magic, p + EC_LOG_GEO_MAGIC_OFFSET, sizeof(magic));
+        memcpy(&offset, p + EC_LOG_GEO_OFFSET_OFFSET, sizeof(offset));
+        memcpy(&size, p + EC_LOG_GEO_SIZE_OFFSET, sizeof(size));
+        if (magic != EC_LOG_GEO_MAGIC || size < EC_LOG_SIZE_MIN || size > EC_LOG_SIZE_MAX || (size & (size - 1)) != 0 ||
+            offset < EC_RING_PAGE_SIZE || (offset % EC_RING_PAGE_SIZE) != 0 ||
+            static_cast<uint64_t>(offset) + EC_LOG_DATA_OFFSET + size > region_size) {
+            return 0;
+        }
+        return size;
+    }
+
+    // Publish the descriptor in the geometry page as UEFI does, the magic goes last
+    static void Publish(void* region, uint32_t offset, uint32_t size)
+    {
+        auto p = static_cast<uint8_t*>(region);
+        memcpy(p + EC_LOG_GEO_OFFSET_OFFSET, &offset, sizeof(offset));
+        memcpy(p + EC_LOG_GEO_SIZE_OFFSET, &size, sizeof(size));
+        std::atomic_thread_fence(std::memory_order_release);
+        uint32_t magic = EC_LOG_GEO_MAGIC;
+        memcpy(p + EC_LOG_GEO_MAGIC_OFFSET, &magic, sizeof(magic));
+    }
+
+    // Bytes the header and records take in the region
+    static uint32_t AreaSize(uint32_t size) { return EC_RING_ALIGN_UP(EC_LOG_DATA_OFFSET + size, EC_RING_PAGE_SIZE); }
+
+    uint64_t Head() const { return Word(EC_LOG_HEAD_OFFSET).load(std::memory_order_acquire); }
+    uint64_t Tail() const { return Word(EC_LOG_TAIL_OFFSET).load(std::memory_order_acquire); }
+    uint64_t Frequency() const { return Word(EC_LOG_FREQUENCY_OFFSET).load(std::memory_order_relaxed); }
+    void SetFrequency(uint64_t frequency) { Word(EC_LOG_FREQUENCY_OFFSET).store(frequency, std::memory_order_relaxed); }
+
+    // Ask the EC for a doorbell on the next record
+    void Arm() { Armed().store(1, std::memory_order_seq_cst); }
+
+    // Append a record as the EC does, text beyond EC_LOG_TEXT_MAX is cut. Returns true if the host
+    // armed the doorbell, which this clears, so the caller should ring it.
+    bool Append(uint8_t level, uint16_t source, uint64_t timestamp, const char* text, size_t length)
+    {
+        if (length > EC_LOG_TEXT_MAX) {
+            length = EC_LOG_TEXT_MAX;
+        }
+
+        uint32_t size = LogRecord::SizeFor(length);
+        uint64_t head = Word(EC_LOG_HEAD_OFFSET).load(std::memory_order_relaxed);
+        uint32_t pad = (head % m_size) + size > m_size ? m_size - static_cast<uint32_t>(head % m_size) : 0;
+        Reclaim(head + pad + size);
+
+        if (pad != 0) {
+            uint8_t record[EC_LOG_RECORD_ALIGN] = {};
+            uint16_t pad_size = static_cast<uint16_t>(pad);
+            memcpy(record + EC_LOG_RECORD_SIZE_OFFSET, &pad_size, sizeof(pad_size));
+            record[EC_LOG_RECORD_FLAGS_OFFSET] = EC_LOG_FLAG_PAD;
+            memcpy(Data(head), record, sizeof(record));
+            head += pad;
+        }
+
+        uint8_t* p = Data(head);
+        uint16_t size16 = static_cast<uint16_t>(size);
+        uint16_t length16 = static_cast<uint16_t>(length);
+        memset(p, 0, size);
+        memcpy(p + EC_LOG_RECORD_SIZE_OFFSET, &size16, sizeof(size16));
+        p[EC_LOG_RECORD_LEVEL_OFFSET] = level;
+        memcpy(p + EC_LOG_RECORD_SOURCE_OFFSET, &source, sizeof(source));
+        memcpy(p + EC_LOG_RECORD_LENGTH_OFFSET, &length16, sizeof(length16));
+        memcpy(p + EC_LOG_RECORD_TIME_OFFSET, &timestamp, sizeof(timestamp));
+        memcpy(p + EC_LOG_RECORD_HEADER_SIZE, text, length);
+
+        Word(EC_LOG_HEAD_OFFSET).store(head + size, std::memory_order_seq_cst);
+        return Armed().exchange(0, std::memory_order_seq_cst) != 0;
+    }
+
+    // Copy the records from cursor up to HEAD. lost is increased by the bytes overwritten before
+    // they were read, cursor moves past what was returned.
+    void Read(uint64_t& cursor, std::vector<LogRecord>& records, uint64_t& lost) const
+    {
+        for (int i = 0; i < EC_EVENT_READ_RETRIES; i++) {
+            uint64_t head = Head();
+            uint64_t tail = Tail();
+            if (cursor < tail || cursor > head) {
+                lost += cursor < tail ? tail - cursor : 0;
+                cursor = tail;
+            }
+
+            size_t first = records.size();
+            uint64_t position = cursor;
+            while (position < head) {
+                LogRecord record;
+                uint32_t offset = static_cast<uint32_t>(position % m_size);
+                if (!record.Decode(Data(position), m_size - offset)) {
+                    break;
+                }
+                position += record.size;
+                if ((record.flags & EC_LOG_FLAG_PAD) == 0) {
+                    records.push_back(std::move(record));
+                }
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            tail = Tail();
+            if (tail <= cursor) {
+                // A malformed record that was not overwritten cannot be resynchronized to
+                if (position < head && records.size() == first) {
+                    lost += head - position;
+                    position = head;
+                }
+                cursor = position;
+                return;
+            }
+
+            // The EC overwrote records while they were copied, drop them and start at the tail
+            records.resize(first);
+            lost += tail - cursor;
+            cursor = tail;
+        }
+    }
+
+private:
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "log words must be plain 64-bit words");
+
+    // Move TAIL past every record that writing up to end overwrites, before it is overwritten
+    void Reclaim(uint64_t end)
+    {
+        uint64_t tail = Word(EC_LOG_TAIL_OFFSET).load(std::memory_order_relaxed);
+        uint64_t moved = tail;
+        while (end - moved > m_size) {
+            uint16_t size;
+            memcpy(&size, Data(moved) + EC_LOG_RECORD_SIZE_OFFSET, sizeof(size));
+            if (size == 0) {
+                moved = end - m_size;
+                break;
+            }
+            moved += size;
+        }
+        if (moved != tail) {
+            Word(EC_LOG_TAIL_OFFSET).store(moved, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    uint8_t* Data(uint64_t position) const { return m_base + EC_LOG_DATA_OFFSET + position % m_size; }
+
+    std::atomic<uint64_t>& Word(size_t offset) const
+    {
+        return *reinterpret_cast<std::atomic<uint64_t>*>(m_base + offset);
+    }
+
+    std::atomic<uint32_t>& Armed() const
+    {
+        return *reinterpret_cast<std::atomic<uint32_t>*>(m_base + EC_LOG_ARMED_OFFSET);
+    }
+
+    uint8_t* m_base;
+    uint32_t m_size;
+};
+
+// Accessor for one ring (TX or RX) in shared memory
+class RingPage {
+public:
+    explicit RingPage(void* base, const Geometry& geometry = Geometry())
+        : m_base(static_cast<uint8_t*>(base)),
+          m_slots(geometry.slot_count),
+          m_entry_size(geometry.entry_size),
+          m_entry_offset(geometry.entry_offset)
+    {
+    }
+
+    uint64_t Header(size_t slot) const { return Slot(slot).load(std::memory_order_acquire); }
+    void SetHeader(size_t slot, uint64_t raw) { Slot(slot).store(raw, std::memory_order_release); }
+    uint8_t* Entry(size_t slot) const { return m_base + m_entry_offset + slot * m_entry_size; }
+
+    size_t SlotCount() const { return m_slots; }
+    size_t EntrySize() const { return m_entry_size; }
+
+private:
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "slot header must be a plain 64-bit word");
+
+    std::atomic<uint64_t>& Slot(size_t slot) const
+    {
+        return *reinterpret_cast<std::atomic<uint64_t>*>(m_base + EC_RING_SLOT_OFFSET + slot * sizeof(uint64_t));
+    }
+
+    uint8_t* m_base;
+    size_t m_slots;
+    size_t m_entry_size;
+    size_t m_entry_offset;
+};
+
+// Accessor for the event record in the geometry page
+class EventRecord {
+public:
+    explicit EventRecord(void* region) : m_base(static_cast<uint8_t*>(region)) {}
+
+    // Publish an event as the EC does, data beyond EC_EVENT_DATA_MAX is dropped
+    void Write(uint32_t id, const void* data, size_t length)
+    {
+        if (length > EC_EVENT_DATA_MAX) {
+            length = EC_EVENT_DATA_MAX;
+        }
+
+        uint32_t gen = Gen().load(std::memory_order_relaxed);
+        Gen().store(gen | 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(m_base + EC_EVENT_ID_OFFSET, &id, sizeof(id));
+        uint32_t len = static_cast<uint32_t>(length);
+        memcpy(m_base + EC_EVENT_LENGTH_OFFSET, &len, sizeof(len));
+        if (length > 0) {
+            memcpy(m_base + EC_EVENT_DATA_OFFSET, data, length);
+        }
+        Gen().store((gen | 1) + 1, std::memory_order_release);
+    }
+
+    // Consistent copy of the record, returns false if the EC kept updating it
+    bool Read(uint32_t& id, std::vector<uint8_t>& data) const
+    {
+        for (int i = 0; i < EC_EVENT_READ_RETRIES; i++) {
+            uint32_t gen = Gen().load(std::memory_order_acquire);
+            if (gen & 1) {
+                continue;
+            }
+
+            uint32_t len;
+            memcpy(&id, m_base + EC_EVENT_ID_OFFSET, sizeof(id));
+            memcpy(&len, m_base + EC_EVENT_LENGTH_OFFSET, sizeof(len));
+            if (len > EC_EVENT_DATA_MAX) {
+                len = EC_EVENT_DATA_MAX;
+            }
+            data.assign(m_base + EC_EVENT_DATA_OFFSET, m_base + EC_EVENT_DATA_OFFSET + len);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (Gen().load(std::memory_order_relaxed) == gen) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::atomic<uint32_t>& Gen() const
+    {
+        return *reinterpret_cast<std::atomic<uint32_t>*>(m_base + EC_EVENT_GEN_OFFSET);
+    }
+
+    uint8_t* m_base;
+};
+
+// Number of entries needed to carry a message
+inline size_t FragmentCount(size_t length, size_t entry_size)
+{
+    return length <= entry_size ? 1 : (length + entry_size - 1) / entry_size;
+}
+
+// Split a message into entry sized fragments. emit(header, data, length) is called once per
+// fragment in order. Returns the number of fragments or 0 if the message is too large.
+template <typename Emit>
+size_t Fragment(uint16_t seq, const uint8_t* data, size_t length, size_t entry_size, Emit&& emit)
+{
+    size_t count = FragmentCount(length, entry_size);
+    if (count > EC_SLOT_FRAG_MAX || length > EC_SLOT_TOTAL_MAX) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        size_t offset = i * entry_size;
+        SlotHeader h;
+        h.seq = seq;
+        h.length = static_cast<uint16_t>((length - offset) < entry_size ? (length - offset) : entry_size);
+        h.valid = true;
+        h.more = (i + 1) < count;
+        h.fragment = static_cast<uint16_t>(i);
+        h.total = count > 1 ? static_cast<uint32_t>(length) : 0;
+        emit(h.Encode(), data + offset, static_cast<size_t>(h.length));
+    }
+
+    return count;
+}
+
+// Collects the fragments of one sequence number back into a message. Fragments must be pushed
+// in order, the caller scans the ring for the fragment returned by NextFragment().
+class Reassembler {
+public:
+    enum class Result { NeedMore, Complete, Error };
+
+    explicit Reassembler(uint16_t seq = 0) { Reset(seq); }
+
+    void Reset(uint16_t seq)
+    {
+        m_seq = seq;
+        m_next = 0;
+        m_total = 0;
+        m_message.clear();
+    }
+
+    uint16_t Sequence() const { return m_seq; }
+    uint16_t NextFragment() const { return m_next; }
+
+    // True if the raw slot header is the fragment this reassembler is waiting for
+    bool Wants(uint64_t raw) const
+    {
+        return raw != 0 && EC_SLOT_SEQ(raw) == m_seq && EC_SLOT_FRAG(raw) == m_next;
+    }
+
+    Result Push(uint64_t raw, const uint8_t* entry)
+    {
+        SlotHeader h = SlotHeader::Decode(raw);
+        if (h.seq != m_seq || h.fragment != m_next) {
+            return Result::Error;
+        }
+
+        if (m_next == 0) {
+            m_total = h.MessageLength();
+            m_message.reserve(m_total);
+        } else if (h.total != m_total) {
+            return Result::Error;
+        }
+
+        if (m_message.size() + h.length > m_total) {
+            return Result::Error;
+        }
+
+        m_message.insert(m_message.end(), entry, entry + h.length);
+        m_next++;
+
+        if (h.more) {
+            return m_next < EC_SLOT_FRAG_MAX ? Result::NeedMore : Result::Error;
+        }
+        return m_message.size() == m_total ? Result::Complete : Result::Error;
+    }
+
+    const std::vector<uint8_t>& Message() const { return m_message; }
+
+private:
+    uint16_t m_seq;
+    uint16_t m_next;
+    uint32_t m_total;
+    std::vector<uint8_t> m_message;
+};
+
+} // namespace ecring
+#endif // __cplusplus
@@ -0,0 +1,82 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Dispatch rules of the driver priority queues, see kmdf/priority.c. They only depend on
+// counters and waiting times so bench/schedbench.cpp can run the same rules off target.
+//
+// A request is first raised one class for every aging period it has waited, then it may
+// dispatch if its shard and the whole device are under the in flight limits of the class it
+// was raised to. A bulk request that waited long enough therefore gets the room kept for
+// critical requests, and among candidates of the same class the one that waited longest wins.
+
+// Classes, the same as EVAL_PRIORITY_COUNT
+#define EC_SCHED_CLASSES        3
+
+// Evaluations in flight on the same shard below which each class may dispatch
+static const unsigned int EcSchedShardLimit[EC_SCHED_CLASSES] = { 3, 2, 1 };
+
+// Evaluations in flight across all shards below which each class may dispatch
+static const unsigned int EcSchedTotalLimit[EC_SCHED_CLASSES] = { 8, 6, 4 };
+
+// Waiting time in ms that raises a request by one class, 0 never ages
+static const unsigned int EcSchedAgeMs[EC_SCHED_CLASSES] = { 0, 20, 100 };
+
+// EcSchedCheck results
+#define EC_SCHED_ALLOWED        0
+#define EC_SCHED_SHARD_FULL     1
+#define EC_SCHED_TOTAL_FULL     2       // Shard has room, other shards hold the slots
+
+// Class a request of Class dispatches as after waiting Waited, in 100ns units
+static __inline unsigned int EcSchedLevel(unsigned int Class, unsigned long long Waited)
+{
+    unsigned long long aging;
+
+    if (EcSchedAgeMs[Class] == 0) {
+        return Class;
+    }
+    aging = Waited / (EcSchedAgeMs[Class] * 10000ULL);
+    return aging < Class ? Class - (unsigned int)aging : 0;
+}
+
+// Whether a request raised to Level may dispatch with the given evaluations in flight
+static __inline unsigned int EcSchedCheck(unsigned int Level, unsigned int ShardInflight, unsigned int TotalInflight)
+{
+    if (ShardInflight >= EcSchedShardLimit[Level]) {
+        return EC_SCHED_SHARD_FULL;
+    }
+    if (TotalInflight >= EcSchedTotalLimit[Level]) {
+        return EC_SCHED_TOTAL_FULL;
+    }
+    return EC_SCHED_ALLOWED;
+}
+
+// Whether a candidate beats the best one so far, the lower level wins and then the longer wait.
+// Candidates are visited from the highest class down, so a full tie keeps the first.
+static __inline int EcSchedBetter(unsigned int Level, unsigned long long Waited,
+                                  unsigned int BestLevel, unsigned long long BestWaited)
+{
+    return Level < BestLevel || (Level == BestLevel && Waited > BestWaited);
+}
@@ -0,0 +1,253 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Layout of the named shared memory segment eclib publishes sampled ACPI results in, see
+// StartResultShare. One owner process evaluates each series at its period and writes the result
+// into the slot of the series; any process can map the segment and read the latest value
+// without a system call or EC traffic. The owner holds a named mutex, when it exits a process
+// waiting on the mutex takes over and keeps publishing the same directory.
+//
+// The segment starts with a header line, followed by the directory of series and one cache line
+// per series. The directory and each slot are seqlocks: the writer makes GEN or SEQ odd, writes,
+// then makes it even again, and a reader retries if it changed or was odd while it copied.
+
+#define EC_SHARE_NAME           L"Local\\ECTestResults"
+#define EC_SHARE_OWNER_NAME     L"Local\\ECTestResultsOwner"
+
+#define EC_SHARE_SIGNATURE      0x72685345 // 'EShr'
+#define EC_SHARE_VERSION        1
+#define EC_SHARE_LINE           0x40
+#define EC_SHARE_SERIES_MAX     32
+#define EC_SHARE_METHOD_MAX     64         // Method path including the NUL
+#define EC_SHARE_DATA_MAX       40
+#define EC_SHARE_READ_RETRIES   64
+
+// Header at offset 0
+#define EC_SHARE_SIGNATURE_OFFSET   0x00 // UINT32
+#define EC_SHARE_VERSION_OFFSET     0x04 // UINT16
+#define EC_SHARE_COUNT_OFFSET       0x06 // UINT16 series in the directory
+#define EC_SHARE_GEN_OFFSET         0x08 // UINT32 directory seqlock
+#define EC_SHARE_OWNER_OFFSET       0x0C // UINT32 process ID of the owner, 0 if none
+#define EC_SHARE_HEARTBEAT_OFFSET   0x10 // UINT64 GetTickCount64 of the owner's last pass
+
+// Directory, METHOD(64) PERIOD(32) per series
+#define EC_SHARE_DIR_OFFSET         EC_SHARE_LINE
+#define EC_SHARE_DIR_ENTRY_SIZE     0x80
+#define EC_SHARE_DIR_METHOD_OFFSET  0x00
+#define EC_SHARE_DIR_PERIOD_OFFSET  0x40 // UINT32 ms between samples
+
+// Slots, one cache line each so writing one never invalidates a reader of another
+#define EC_SHARE_SLOT_OFFSET        (EC_SHARE_DIR_OFFSET + EC_SHARE_SERIES_MAX * EC_SHARE_DIR_ENTRY_SIZE)
+#define EC_SHARE_SLOT_SIZE          EC_SHARE_LINE
+#define EC_SHARE_SLOT_SEQ_OFFSET    0x00 // UINT32 seqlock, two per sample
+#define EC_SHARE_SLOT_STATUS_OFFSET 0x04 // UINT32 ERROR_SUCCESS or the evaluation error
+#define EC_SHARE_SLOT_TIME_OFFSET   0x08 // UINT64 GetTickCount64 of the sample
+#define EC_SHARE_SLOT_TYPE_OFFSET   0x10 // UINT16 ACPI_VIEW_TYPE_* of the result
+#define EC_SHARE_SLOT_LENGTH_OFFSET 0x12 // UINT16 bytes in DATA
+#define EC_SHARE_SLOT_DATA_OFFSET   0x18 // Integer, or integers of a package, as UINT64 else the bytes
+
+#define EC_SHARE_SIZE               0x2000
+
+#ifdef __cplusplus
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ecshare {
+
+static_assert(EC_SHARE_SLOT_DATA_OFFSET + EC_SHARE_DATA_MAX <= EC_SHARE_SLOT_SIZE, "slot data must fit its line");
+static_assert(EC_SHARE_SLOT_OFFSET + EC_SHARE_SERIES_MAX * EC_SHARE_SLOT_SIZE <= EC_SHARE_SIZE, "slots must fit the segment");
+
+struct Series {
+    char method[EC_SHARE_METHOD_MAX];
+    uint32_t period;
+};
+
+struct Sample {
+    uint32_t status;
+    uint16_t type;
+    uint16_t length;
+    uint64_t timestamp;
+    uint32_t samples;
+    uint8_t data[EC_SHARE_DATA_MAX];
+};
+
+// Accessor for a mapped segment, the mapping must be EC_SHARE_SIZE bytes and line aligned
+class Segment {
+public:
+    explicit Segment(void* base) : m_base(static_cast<uint8_t*>(base)) {}
+
+    bool Valid() const
+    {
+        uint32_t signature;
+        uint16_t version;
+        memcpy(&signature, m_base + EC_SHARE_SIGNATURE_OFFSET, sizeof(signature));
+        memcpy(&version, m_base + EC_SHARE_VERSION_OFFSET, sizeof(version));
+        return signature == EC_SHARE_SIGNATURE && version == EC_SHARE_VERSION;
+    }
+
+    // Owner only. A segment left by an older version is cleared, slots restart at zero
+    void Initialize()
+    {
+        if (Valid()) {
+            return;
+        }
+        memset(m_base, 0, EC_SHARE_SIZE);
+        uint16_t version = EC_SHARE_VERSION;
+        memcpy(m_base + EC_SHARE_VERSION_OFFSET, &version, sizeof(version));
+        std::atomic_thread_fence(std::memory_order_release);
+        Word32(EC_SHARE_SIGNATURE_OFFSET).store(EC_SHARE_SIGNATURE, std::memory_order_release);
+    }
+
+    // Owner only. Replaces the directory, readers looking up a series retry until it is done
+    void Publish(const Series* series, uint32_t count)
+    {
+        uint32_t gen = Gen().load(std::memory_order_relaxed);
+        Gen().store(gen | 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        uint16_t count16 = static_cast<uint16_t>(count < EC_SHARE_SERIES_MAX ? count : EC_SHARE_SERIES_MAX);
+        memcpy(m_base + EC_SHARE_COUNT_OFFSET, &count16, sizeof(count16));
+        for (uint32_t i = 0; i < count16; i++) {
+            uint8_t* entry = m_base + EC_SHARE_DIR_OFFSET + i * EC_SHARE_DIR_ENTRY_SIZE;
+            memcpy(entry + EC_SHARE_DIR_METHOD_OFFSET, series[i].method, EC_SHARE_METHOD_MAX);
+            entry[EC_SHARE_DIR_METHOD_OFFSET + EC_SHARE_METHOD_MAX - 1] = 0;
+            memcpy(entry + EC_SHARE_DIR_PERIOD_OFFSET, &series[i].period, sizeof(series[i].period));
+        }
+        Gen().store((gen | 1) + 1, std::memory_order_release);
+    }
+
+    // Consistent copy of the directory, false if it is being replaced. Returns the generation
+    // so lookups made from the copy can be checked later with Generation()
+    bool Directory(Series* series, uint32_t& count, uint32_t& generation) const
+    {
+        for (int i = 0; i < EC_SHARE_READ_RETRIES; i++) {
+            generation = Gen().load(std::memory_order_acquire);
+            if (generation & 1) {
+                continue;
+            }
+
+            uint16_t count16;
+            memcpy(&count16, m_base + EC_SHARE_COUNT_OFFSET, sizeof(count16));
+            count = count16 < EC_SHARE_SERIES_MAX ? count16 : EC_SHARE_SERIES_MAX;
+            for (uint32_t j = 0; j < count; j++) {
+                const uint8_t* entry = m_base + EC_SHARE_DIR_OFFSET + j * EC_SHARE_DIR_ENTRY_SIZE;
+                memcpy(series[j].method, entry + EC_SHARE_DIR_METHOD_OFFSET, EC_SHARE_METHOD_MAX);
+                series[j].method[EC_SHARE_METHOD_MAX - 1] = 0;
+                memcpy(&series[j].period, entry + EC_SHARE_DIR_PERIOD_OFFSET, sizeof(series[j].period));
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (Gen().load(std::memory_order_relaxed) == generation) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t Generation() const { return Gen().load(std::memory_order_acquire); }
+
+    // Owner only. Publishes a sample, data beyond EC_SHARE_DATA_MAX is dropped
+    void Write(uint32_t slot, uint32_t status, uint16_t type, const void* data, size_t length, uint64_t timestamp)
+    {
+        uint8_t* p = Slot(slot);
+        uint16_t length16 = static_cast<uint16_t>(length < EC_SHARE_DATA_MAX ? length : EC_SHARE_DATA_MAX);
+
+        uint32_t seq = Seq(slot).load(std::memory_order_relaxed);
+        Seq(slot).store(seq | 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(p + EC_SHARE_SLOT_STATUS_OFFSET, &status, sizeof(status));
+        memcpy(p + EC_SHARE_SLOT_TIME_OFFSET, &timestamp, sizeof(timestamp));
+        memcpy(p + EC_SHARE_SLOT_TYPE_OFFSET, &type, sizeof(type));
+        memcpy(p + EC_SHARE_SLOT_LENGTH_OFFSET, &length16, sizeof(length16));
+        if (length16 > 0) {
+            memcpy(p + EC_SHARE_SLOT_DATA_OFFSET, data, length16);
+        }
+        Seq(slot).store((seq | 1) + 1, std::memory_order_release);
+    }
+
+    // Consistent copy of the latest sample of a slot, false if the owner kept updating it
+    bool Read(uint32_t slot, Sample& sample) const
+    {
+        const uint8_t* p = Slot(slot);
+
+        for (int i = 0; i < EC_SHARE_READ_RETRIES; i++) {
+            uint32_t seq = Seq(slot).load(std::memory_order_acquire);
+            if (seq & 1) {
+                continue;
+            }
+
+            memcpy(&sample.status, p + EC_SHARE_SLOT_STATUS_OFFSET, sizeof(sample.status));
+            memcpy(&sample.timestamp, p + EC_SHARE_SLOT_TIME_OFFSET, sizeof(sample.timestamp));
+            memcpy(&sample.type, p + EC_SHARE_SLOT_TYPE_OFFSET, sizeof(sample.type));
+            memcpy(&sample.length, p + EC_SHARE_SLOT_LENGTH_OFFSET, sizeof(sample.length));
+            if (sample.length > EC_SHARE_DATA_MAX) {
+                sample.length = EC_SHARE_DATA_MAX;
+            }
+            memcpy(sample.data, p + EC_SHARE_SLOT_DATA_OFFSET, sample.length);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (Seq(slot).load(std::memory_order_relaxed) == seq) {
+                sample.samples = seq / 2;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t Owner() const { return Word32(EC_SHARE_OWNER_OFFSET).load(std::memory_order_acquire); }
+    void SetOwner(uint32_t pid) { Word32(EC_SHARE_OWNER_OFFSET).store(pid, std::memory_order_release); }
+
+    uint64_t Heartbeat() const { return Word64(EC_SHARE_HEARTBEAT_OFFSET).load(std::memory_order_relaxed); }
+    void SetHeartbeat(uint64_t now) { Word64(EC_SHARE_HEARTBEAT_OFFSET).store(now, std::memory_order_relaxed); }
+
+private:
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "shared words must be plain words");
+
+    uint8_t* Slot(uint32_t slot) const { return m_base + EC_SHARE_SLOT_OFFSET + slot * EC_SHARE_SLOT_SIZE; }
+
+    std::atomic<uint32_t>& Seq(uint32_t slot) const
+    {
+        return *reinterpret_cast<std::atomic<uint32_t>*>(Slot(slot) + EC_SHARE_SLOT_SEQ_OFFSET);
+    }
+
+    std::atomic<uint32_t>& Gen() const { return Word32(EC_SHARE_GEN_OFFSET); }
+
+    std::atomic<uint32_t>& Word32(size_t offset) const
+    {
+        return *reinterpret_cast<std::atomic<uint32_t>*>(m_base + offset);
+    }
+
+    std::atomic<uint64_t>& Word64(size_t offset) const
+    {
+        return *reinterpret_cast<std::atomic<uint64_t>*>(m_base + offset);
+    }
+
+    uint8_t* m_base;
+};
+
+} // namespace ecshare
+#endif // __cplusplus
@@ -0,0 +1,149 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// EC secure partition services and commands used by ectest.asl and thermal.asl.
+//
+// Requests are sent with FFA_MSG_SEND_DIRECT_REQ2. The ACPI FFixedHw buffer is STAT(8) LENG(8)
+// UUID(128) followed by the payload, which lands in x4 onwards. Byte N of the ACPI buffer
+// (N >= EC_FFA_PAYLOAD_OFFSET) is byte N - EC_FFA_PAYLOAD_OFFSET of FFA_SEND_DIRECT_REQ2_BUFFER.
+#define EC_FFA_PAYLOAD_OFFSET   18
+#define EC_FFA_PAYLOAD_SIZE     112 // x4-x17
+
+// Service UUIDs in DEFINE_GUID argument order
+#define EC_SVC_MANAGEMENT_UUID  0x330c1273, 0xfde5, 0x4757, 0x98, 0x19, 0x5b, 0x65, 0x39, 0x03, 0x75, 0x02
+#define EC_SVC_THERMAL_UUID     0x31f56da7, 0x593c, 0x4d72, 0xa4, 0xb3, 0x8f, 0xc7, 0x17, 0x1a, 0xc0, 0x73
+#define EC_SVC_BATTERY_UUID     0x25cb5207, 0xac36, 0x427d, 0xaa, 0xef, 0x3a, 0xa7, 0x88, 0x77, 0xd2, 0x7e
+
+// Payload offsets common to every command
+#define EC_PAYLOAD_CMD          0   // UINT8 command
+#define EC_PAYLOAD_OUT          8   // Output data, ACPI buffer byte 26
+
+// Multiplexed request, accepted by every service. Packs several commands for the service into
+// one direct request so a telemetry tick costs one world switch instead of one per command.
+//
+// Request:  EC_MUX, count, then per command inlen, outoff, outlen and inlen payload bytes
+//           starting with the command byte.
+// Response: EC_MUX, count handled, then per command a status byte, 0 on success, and outlen
+//           bytes of that command's output starting at payload byte outoff.
+//
+// Each command runs as if it arrived alone with its payload bytes past inlen zero. An EC that
+// does not know EC_MUX fails the request and the sender falls back to one command per request.
+#define EC_MUX                  0xFF
+#define EC_MUX_COUNT            1   // UINT8 commands in the request or handled in the response
+#define EC_MUX_DATA             2   // First command header or response
+#define EC_MUX_HEADER_SIZE      3   // inlen, outoff, outlen
+
+// EC_SVC_MANAGEMENT
+#define EC_ASYNC                0x0 // Process queued TX ring entry
+#define EC_CAP_GET_FW_STATE     0x1
+#define EC_CAP_TEST_NFY         0x4
+#define EC_CAP_MAP_SHARE        0x5
+
+#define EC_ASYNC_SEQ            1   // UINT16 sequence number of the TX entry
+#define EC_MAP_SHARE_ADDRESS    1   // x5 address of the memory region descriptor
+#define EC_MAP_SHARE_LENGTH     2   // x6 length of the descriptor
+#define EC_MAP_SHARE_STATUS     8   // UINT32 output, 0 once the EC has retrieved the region
+
+// Bulk transfer through a buffer of the pool in ecring.h, already retrieved by the EC. READ fills
+// the buffer from the object, WRITE stores the buffer into it. Output is the EC status, bytes
+// moved, which is short at the end of the object, and the object size.
+#define EC_CAP_BULK             0x6
+
+#define EC_BULK_OP              1   // UINT8 EC_BULK_OP_*
+#define EC_BULK_OBJECT          2   // UINT8 EC_BULK_OBJ_*
+#define EC_BULK_OBJECT_OFFSET   4   // UINT32 byte offset in the object
+#define EC_BULK_HANDLE          8   // UINT64 FF-A memory handle of the pool buffer
+#define EC_BULK_LENGTH          16  // UINT32 bytes to move, at most the buffer size
+#define EC_BULK_STATUS          8   // UINT32 output, 0 on success
+#define EC_BULK_MOVED           12  // UINT32 output
+#define EC_BULK_TOTAL           16  // UINT32 output
+
+#define EC_BULK_OP_READ         0   // EC to host
+#define EC_BULK_OP_WRITE        1   // Host to EC
+
+#define EC_BULK_OBJ_LOG         1   // EC log, read
+#define EC_BULK_OBJ_HISTORY     2   // Sensor history blocks, read
+#define EC_BULK_OBJ_FIRMWARE    3   // Firmware image staging area, read and write
+
+// EC_SVC_THERMAL
+#define EC_THM_GET_TMP          0x1
+#define EC_THM_SET_THRS         0x2
+#define EC_THM_GET_VAR          0x5
+#define EC_THM_SET_VAR          0x6
+
+#define EC_THM_TZID             1   // UINT8 sensor or instance ID
+#define EC_THM_THRS_TIMEOUT     2   // UINT32
+#define EC_THM_THRS_LOW         6   // UINT32
+#define EC_THM_THRS_HIGH        10  // UINT32
+#define EC_THM_THRS_STATUS      0   // UINT32 output
+#define EC_THM_VAR_LENGTH       2   // UINT16
+#define EC_THM_VAR_UUID         4   // GUID of the variable
+#define EC_THM_VAR_VALUE        20  // UINT32 value for SET_VAR
+
+// SET_THRS arms the sensor once. The EC raises EC_NOTIFY_THERMAL when the temperature goes
+// below low or above high, right away if it already is, or when the timeout in ms expires,
+// 0 for none. The event record tells which sensor, why and the temperature that was seen.
+#define EC_THM_EVENT_TZID       0   // UINT8 sensor ID
+#define EC_THM_EVENT_REASON     1   // UINT8 EC_THM_REASON_*
+#define EC_THM_EVENT_TEMP       4   // UINT32 deci-Kelvin
+#define EC_THM_EVENT_SIZE       8
+#define EC_THM_REASON_TIMEOUT   0
+#define EC_THM_REASON_LOW       1
+#define EC_THM_REASON_HIGH      2
+
+// Several DWORD variables of one instance in one request. GET_VARS carries a UUID per variable
+// and returns a bit per variable the EC does not know followed by every value, 0 for unknown
+// ones. SET_VARS carries a UUID and value per variable and returns the same bits. Requests hold
+// at most EC_THM_GET_VARS_MAX or EC_THM_SET_VARS_MAX variables.
+#define EC_THM_GET_VARS         0x7
+#define EC_THM_SET_VARS         0x8
+#define EC_THM_VARS_COUNT       2   // UINT8 variables in the request
+#define EC_THM_VARS_DATA        4   // GET_VARS UUID, SET_VARS UUID then UINT32 value, per variable
+#define EC_THM_VARS_MISSING     8   // UINT32 output, bit N set if variable N is unknown
+#define EC_THM_VARS_VALUE       12  // UINT32 output per variable of GET_VARS
+#define EC_THM_GET_VARS_MAX     6
+#define EC_THM_SET_VARS_MAX     5
+#define EC_THM_GET_VARS_ENTRY   16
+#define EC_THM_SET_VARS_ENTRY   20
+
+// Fan variables of the thermal service in DEFINE_GUID argument order
+#define EC_THM_VAR_FAN_ON_TEMP_UUID     0xba17b567, 0xc368, 0x48d5, 0xbc, 0x6f, 0xa3, 0x12, 0xa4, 0x15, 0x83, 0xc1
+#define EC_THM_VAR_FAN_RAMP_TEMP_UUID   0x3a62688c, 0xd95b, 0x4d2d, 0xba, 0xcc, 0x90, 0xd7, 0xa5, 0x81, 0x6b, 0xcd
+#define EC_THM_VAR_FAN_MAX_TEMP_UUID    0xdcb758b1, 0xf0fd, 0x4ec7, 0xb2, 0xc0, 0xef, 0x1e, 0x2a, 0x54, 0x7b, 0x76
+#define EC_THM_VAR_FAN_MIN_RPM_UUID     0xdb261c77, 0x934b, 0x45e2, 0x97, 0x42, 0x25, 0x6c, 0x62, 0xba, 0xdb, 0x7a
+#define EC_THM_VAR_FAN_MAX_RPM_UUID     0x5cf839df, 0x8be7, 0x42b9, 0x9a, 0xc5, 0x34, 0x03, 0xca, 0x2c, 0x8a, 0x6a
+#define EC_THM_VAR_FAN_CURRENT_RPM_UUID 0xadf95492, 0x0776, 0x4ffc, 0x84, 0xf3, 0xb6, 0xc8, 0xb5, 0x26, 0x96, 0x83
+
+// EC_SVC_BATTERY
+#define EC_BAT_GET_BIX          0x1
+#define EC_BAT_GET_BST          0x2
+
+#define EC_BAT_INDEX            1   // UINT8 battery index
+
+// FF-A notification IDs raised by the EC management service, doorbells are in ecring.h
+#define EC_NOTIFY_EVENT_MIN     0x1
+#define EC_NOTIFY_EVENT_MAX     0x3
+#define EC_NOTIFY_THERMAL       0x7 // Armed sensor left its thresholds, see EC_THM_EVENT_*
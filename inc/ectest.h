@@ -1,20 +1,99 @@
-
-// Define IOCTL's and structures shared between KMDF and Application
-#define IOCTL_GET_NOTIFICATION 0x1
-#define IOCTL_READ_RX_BUFFER 0x2
-
-#define SBSAQEMU_SHARED_MEM_BASE 0x10060000000
-
-typedef struct {
-    UINT64 count;
-    UINT64 timestamp;
-    UINT32  lastevent;
-} NotificationRsp_t;
-
-typedef struct {
-    UINT8 type;
-} NotificationReq_t;
-
-typedef struct {
-    UINT64 data;
-} RxBufferRsp_t;
+#pragma once
+
+// Define IOCTL's and structures shared between KMDF and Application
+#define IOCTL_GET_NOTIFICATION 0x1
+#define IOCTL_READ_RX_BUFFER 0x2
+
+// Newer IOCTL's use CTL_CODE so transfer type is always METHOD_BUFFERED
+#define ECTEST_IOCTL(fn) CTL_CODE(FILE_DEVICE_UNKNOWN, 0x800 + (fn), METHOD_BUFFERED, FILE_ANY_ACCESS)
+#define IOCTL_WAIT_RX_SEQUENCE ECTEST_IOCTL(0x3)
+#define IOCTL_SET_COALESCE ECTEST_IOCTL(0x4)
+#define IOCTL_GET_EVENT_COUNTERS ECTEST_IOCTL(0x5)
+#define IOCTL_GENERATOR ECTEST_IOCTL(0x6)
+#define IOCTL_BENCH ECTEST_IOCTL(0x7)
+#define IOCTL_ACPI_EVAL_PRIORITY ECTEST_IOCTL(0x8)
+#define IOCTL_GET_PRIORITY_STATS ECTEST_IOCTL(0x9)
+#define IOCTL_GET_SHARD_STATS ECTEST_IOCTL(0xA)
+#define IOCTL_ADMISSION ECTEST_IOCTL(0xB)
+#define IOCTL_FFA_MUX ECTEST_IOCTL(0xC)
+#define IOCTL_BULK_TRANSFER ECTEST_IOCTL(0xD)
+#define IOCTL_LOG_READ ECTEST_IOCTL(0xE)
+#define IOCTL_TIMELINE_READ ECTEST_IOCTL(0xF)
+
+#define SBSAQEMU_SHARED_MEM_BASE 0x10060000000
+
+// Output buffers of NOTIFICATION_RSP_LEGACY_SIZE only receive count, timestamp and lastevent.
+// Larger buffers also receive the EC event and a payload of NotificationItem_t records captured
+// when the notification arrived, so consumers do not need another IOCTL to act on it.
+typedef struct {
+    UINT64 count;
+    UINT64 timestamp;
+    UINT32  lastevent;
+    UINT32 ecevent;     // FF-A notify ID from the EC event record, 0 if none
+    UINT32 flags;       // NOTIFY_PAYLOAD_* items present in payload
+    UINT32 payloadsize; // Bytes valid in payload
+    UINT32 payloadtotal;// Bytes captured, larger than payloadsize if the output buffer was too small
+    UINT32 occurrences; // Occurrences of lastevent folded into this notification
+    UINT64 firsttimestamp; // Timestamp of the first occurrence, timestamp is the last
+    UINT8  payload[1];
+} NotificationRsp_t;
+
+#define NOTIFICATION_RSP_LEGACY_SIZE 24
+#define NOTIFICATION_RSP_HEADER_SIZE FIELD_OFFSET(NotificationRsp_t, payload)
+#define NOTIFICATION_RSP_MAX_SIZE    1024
+
+// Payload items, each followed by length bytes of data and padded to 8 bytes
+#define NOTIFY_PAYLOAD_EVENT_DATA 0x1   // Data from the EC event record
+#define NOTIFY_PAYLOAD_RX_HEADERS 0x2   // UINT64 RX slot headers, one per slot
+#define NOTIFY_PAYLOAD_GENERATOR  0x4   // GeneratorStamp_t of a synthetic event
+
+typedef struct {
+    UINT16 type;
+    UINT16 length;
+    UINT32 reserved;
+} NotificationItem_t;
+
+#define NOTIFY_ITEM_SIZE(len) (sizeof(NotificationItem_t) + (((len) + 7) & ~7))
+
+typedef struct {
+    UINT8 type;
+} NotificationReq_t;
+
+typedef struct {
+    UINT64 data;
+} RxBufferRsp_t;
+
+// Wait for the EC response with the given sequence number on the RX ring. Older apps do not
+// pass the correlation ID and only send RX_SEQUENCE_REQ_LEGACY_SIZE bytes
+typedef struct {
+    UINT16 sequence;
+    UINT16 reserved;
+    UINT32 timeout;     // Timeout in ms, 0 waits forever
+    UINT32 correlation; // Timeline correlation ID, 0 for none
+} RxSequenceReq_t;
+
+#define RX_SEQUENCE_REQ_LEGACY_SIZE FIELD_OFFSET(RxSequenceReq_t, correlation)
+
+// Output buffer size determines the maximum data length returned. Fragmented responses are
+// reassembled by the driver, if total is larger than length the output buffer was too small
+typedef struct {
+    UINT16 sequence;
+    UINT16 fragments;   // Number of ring entries the response arrived in
+    UINT32 length;      // Bytes valid in data
+    UINT32 total;       // Total bytes in the response
+    UINT32 reserved;
+    UINT8  data[1];
+} RxSequenceRsp_t;
+
+#define RX_SEQUENCE_RSP_HEADER_SIZE FIELD_OFFSET(RxSequenceRsp_t, data)
+
+// Requests of the driver features, one header per kmdf module
+#include "ecnotify.h"
+#include "ecgenerator.h"
+#include "ecbench.h"
+#include "ecpriority.h"
+#include "ecadmission.h"
+#include "ecmux.h"
+#include "ecbulk.h"
+#include "eclog.h"
+#include "ectimeline.h"
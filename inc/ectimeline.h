@@ -0,0 +1,51 @@
+#pragma once
+
+// IOCTL_TIMELINE_READ returns timestamped events of the requests going through the driver, kept
+// in a ring of TIMELINE_EVENT_COUNT events while capture is enabled. Each reader passes its own
+// cursor like IOCTL_LOG_READ and the read never waits. Evaluations and RX waits carry the
+// correlation ID the app passed in EvalPriorityReq_t, EvalCorrelation_t or RxSequenceReq_t,
+// requests without one get an ID with TIMELINE_CORRELATION_DRIVER set so their events can still
+// be matched up. Times are KeQueryPerformanceCounter ticks, the same clock as
+// QueryPerformanceCounter in user mode.
+#define TIMELINE_EVENT_COUNT        4096        // Events kept by the driver, a power of two
+#define TIMELINE_CORRELATION_DRIVER 0x80000000  // Set in IDs the driver assigned
+
+#define TIMELINE_READ_ENABLE        0x1         // Start capturing before reading
+#define TIMELINE_READ_DISABLE       0x2         // Stop capturing after reading
+#define TIMELINE_READ_NEWEST        0x4         // Start at the newest position instead of the cursor
+
+// Driver events
+#define TIMELINE_EVAL_QUEUED        0x01        // value: EVAL_PRIORITY_*
+#define TIMELINE_EVAL_START         0x02        // Work item picked the evaluation up
+#define TIMELINE_ACPI_BEGIN         0x03        // Sent to the ACPI driver
+#define TIMELINE_ACPI_END           0x04        // value: NTSTATUS, sequence: integer result that fits, ASYQ returns the RX sequence
+#define TIMELINE_EVAL_DONE          0x05        // value: NTSTATUS the request completed with
+#define TIMELINE_RX_WAIT            0x06        // sequence: RX ring sequence waited on
+#define TIMELINE_RX_DONE            0x07        // value: NTSTATUS, sequence: RX ring sequence
+#define TIMELINE_NOTIFY             0x08        // value: ACPI Notify value, doorbells included
+
+typedef struct {
+    UINT64 time;        // KeQueryPerformanceCounter ticks
+    UINT32 correlation; // 0 for events not tied to a request
+    UINT16 kind;        // TIMELINE_*
+    UINT16 sequence;    // RX ring sequence number, 0 if none
+    UINT32 value;       // Depends on kind
+    UINT32 reserved;
+} TimelineEvent_t;
+
+typedef struct {
+    UINT64 cursor;      // Event position to read from, 0 for the oldest event
+    UINT32 flags;       // TIMELINE_READ_*
+    UINT32 reserved;
+} TimelineReadReq_t;
+
+typedef struct {
+    UINT64 cursor;      // Position to pass to the next read
+    UINT64 lost;        // Events overwritten before they were read
+    UINT64 frequency;   // KeQueryPerformanceCounter ticks per second
+    UINT32 count;       // Events in events, as many as fit in the output buffer
+    UINT32 reserved;
+    TimelineEvent_t events[1];
+} TimelineReadRsp_t;
+
+#define TIMELINE_READ_RSP_HEADER_SIZE FIELD_OFFSET(TimelineReadRsp_t, events)
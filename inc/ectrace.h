@@ -0,0 +1,63 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+// Layout of the trace files eclib writes with StartTrace, which tools/ectrace.py converts to
+// Chrome trace JSON for Perfetto or chrome://tracing. Capture only appends fixed size binary
+// events, matching them up and formatting happen offline.
+//
+// A trace is a header followed by 24 byte events laid out as TimelineEvent_t in ectest.h, in the
+// order they were written rather than in time order. Driver events read with IOCTL_TIMELINE_READ
+// are copied as they are; eclib adds its own kinds from EC_TRACE_CALL_BEGIN up. All times are
+// QueryPerformanceCounter ticks, the clock KeQueryPerformanceCounter reads in the driver.
+//
+//   CALL_BEGIN  correlation, value: name ID, sequence: RX sequence for WaitForRxSequence
+//   CALL_END    correlation, value: Win32 status
+//   NAME        value: name ID, reserved: length, followed by the name padded to whole events
+//   LOST        value: driver events overwritten before eclib read them
+//   NOTIFY      value: Notify value of a notification eclib handed to the app
+//
+// A NAME always comes before the first CALL_BEGIN that uses it. The correlation ID of a call is
+// passed to the driver, so the driver events of the request carry the same ID.
+
+#define EC_TRACE_SIGNATURE          0x72544345 // 'ECTr'
+#define EC_TRACE_VERSION            1
+#define EC_TRACE_HEADER_SIZE        32
+#define EC_TRACE_EVENT_SIZE         24         // sizeof(TimelineEvent_t)
+
+// Header at offset 0
+#define EC_TRACE_SIGNATURE_OFFSET   0x00 // UINT32
+#define EC_TRACE_VERSION_OFFSET     0x04 // UINT16
+#define EC_TRACE_HEADER_OFFSET      0x06 // UINT16 bytes before the first event
+#define EC_TRACE_FREQUENCY_OFFSET   0x08 // UINT64 ticks per second
+#define EC_TRACE_BASE_OFFSET        0x10 // UINT64 ticks when the trace started
+#define EC_TRACE_START_OFFSET       0x18 // UINT64 FILETIME when the trace started
+
+#define EC_TRACE_CALL_BEGIN         0x10
+#define EC_TRACE_CALL_END           0x11
+#define EC_TRACE_NAME               0x12
+#define EC_TRACE_LOST               0x13
+#define EC_TRACE_NOTIFY             0x14
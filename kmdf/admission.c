@@ -0,0 +1,301 @@
+/*++
+Module Name:
+    admission.c
+
+Abstract:
+    Admission control for ACPI evaluations. Every evaluation is counted
+    against the device and the client process that sent it from the time
+    it is queued until the request object is cleaned up. Over either limit
+    the request is completed at once with STATUS_DEVICE_BUSY and a retry
+    hint, so a client flooding the driver cannot grow the queues without
+    bound and well behaved clients keep a bounded wait.
+
+Environment:
+    Kernel-mode only
+
+--*/
+
+#include "driver.h"
+#include "..\inc\ectest.h"
+#include "trace.h"
+#include "admission.tmh"
+
+#ifdef EC_TEST_ADMISSION
+
+#define ADMISSION_DEFAULT_DEVICE_LIMIT  64
+#define ADMISSION_DEFAULT_CLIENT_LIMIT  16
+#define ADMISSION_DEFAULT_RETRY_MS      5
+
+/*
+ * Function: NTSTATUS AdmissionInitialize
+ *
+ * Description:
+ * Creates the admission lock and sets the default limits.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+NTSTATUS
+AdmissionInitialize(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    WDF_OBJECT_ATTRIBUTES attributes;
+    NTSTATUS status;
+
+    RtlZeroMemory(&deviceContext->Admission, sizeof(deviceContext->Admission));
+    RtlZeroMemory(deviceContext->AdmissionClients, sizeof(deviceContext->AdmissionClients));
+    deviceContext->Admission.devicelimit = ADMISSION_DEFAULT_DEVICE_LIMIT;
+    deviceContext->Admission.clientlimit = ADMISSION_DEFAULT_CLIENT_LIMIT;
+    deviceContext->Admission.retryms = ADMISSION_DEFAULT_RETRY_MS;
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = Device;
+    status = WdfSpinLockCreate(&attributes, &deviceContext->AdmissionLock);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfSpinLockCreate failed %!STATUS!\n", status);
+    }
+
+    return status;
+}
+
+/*
+ * Function: PADMISSION_CLIENT AdmissionFindClient
+ *
+ * Description:
+ * Finds the entry of a client process or takes a free one. Entries are freed as soon as their
+ * client has nothing outstanding, so the table is only full while ADMISSION_CLIENT_COUNT
+ * processes are busy. AdmissionLock must be held.
+ *
+ * Parameters:
+ * DeviceContext - Device context holding the client table.
+ * ProcessId - Process that sent the request.
+ *
+ * Return Value:
+ * Client entry, NULL if every entry is held by a busy client.
+ */
+static PADMISSION_CLIENT
+AdmissionFindClient(
+    PDEVICE_CONTEXT DeviceContext,
+    ULONG ProcessId
+    )
+{
+    PADMISSION_CLIENT freeClient = NULL;
+    ULONG i;
+
+    for (i = 0; i < ADMISSION_CLIENT_COUNT; i++) {
+        if (DeviceContext->AdmissionClients[i].ProcessId == ProcessId) {
+            return &DeviceContext->AdmissionClients[i];
+        }
+        if (freeClient == NULL && DeviceContext->AdmissionClients[i].ProcessId == 0) {
+            freeClient = &DeviceContext->AdmissionClients[i];
+        }
+    }
+
+    if (freeClient != NULL) {
+        freeClient->ProcessId = ProcessId;
+    }
+
+    return freeClient;
+}
+
+/*
+ * Function: NTSTATUS AdmissionAdmit
+ *
+ * Description:
+ * Counts an ACPI evaluation against the device and its client before it is queued. A client
+ * that finds the table full is only held to the device limit, sharing one entry would let a
+ * single flooding process get every other untracked client rejected. Over a limit the request
+ * is not counted and an AdmissionRetry_t is placed in the output buffer if it fits.
+ * The suggested delay is the configured minimum or the average evaluation time, whichever is
+ * longer, as that is how soon a slot is expected to free up.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - ACPI evaluation request.
+ *
+ * Return Value:
+ * STATUS_SUCCESS if admitted, STATUS_DEVICE_BUSY with the information set if not.
+ */
+NTSTATUS
+AdmissionAdmit(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    PREQUEST_CONTEXT requestContext = RequestContextGet(Request);
+    AdmissionRsp_t *admission = &deviceContext->Admission;
+    ULONG processId = IoGetRequestorProcessId(WdfRequestWdmGetIrp(Request));
+    PADMISSION_CLIENT client;
+    AdmissionRetry_t *retry = NULL;
+    ULONGLONG serviceTotal = 0;
+    ULONGLONG completed = 0;
+    ULONG outstanding = 0;
+    ULONG limit = 0;
+    ULONG i;
+
+    requestContext->Device = Device;
+    requestContext->Client = NULL;
+    requestContext->Admitted = FALSE;
+
+    WdfSpinLockAcquire(deviceContext->AdmissionLock);
+    client = AdmissionFindClient(deviceContext, processId);
+    if (admission->outstanding >= admission->devicelimit) {
+        admission->rejecteddevice++;
+        outstanding = admission->outstanding;
+        limit = admission->devicelimit;
+    } else if (client != NULL && client->Outstanding >= admission->clientlimit) {
+        admission->rejectedclient++;
+        outstanding = client->Outstanding;
+        limit = admission->clientlimit;
+    } else {
+        admission->outstanding++;
+        admission->admitted++;
+        if (client != NULL) {
+            client->Outstanding++;
+        }
+        requestContext->Client = client;
+        requestContext->Admitted = TRUE;
+    }
+
+    // A new entry that was not admitted has nothing outstanding to release it later
+    if (client != NULL && client->Outstanding == 0) {
+        client->ProcessId = 0;
+    }
+    WdfSpinLockRelease(deviceContext->AdmissionLock);
+
+    if (requestContext->Admitted) {
+        return STATUS_SUCCESS;
+    }
+
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Request from %u over limit %u with %u outstanding\n", processId, limit, outstanding);
+
+    if (NT_SUCCESS(WdfRequestRetrieveOutputBuffer(Request, sizeof(AdmissionRetry_t), &retry, NULL))) {
+        // Statistics are only read for a hint, no need to hold PriorityLock
+        for (i = 0; i < EVAL_PRIORITY_COUNT; i++) {
+            serviceTotal += deviceContext->PriorityStats[i].servicetotal;
+            completed += deviceContext->PriorityStats[i].completed;
+        }
+
+        retry->signature = ADMISSION_RETRY_SIGNATURE;
+        retry->retryms = admission->retryms;
+        if (completed != 0) {
+            retry->retryms = max(retry->retryms, (ULONG)(serviceTotal / completed / 10000));
+        }
+        retry->outstanding = outstanding;
+        retry->limit = limit;
+        WdfRequestSetInformation(Request, sizeof(AdmissionRetry_t));
+    }
+
+    return STATUS_DEVICE_BUSY;
+}
+
+/*
+ * Function: VOID AdmissionRequestCleanup
+ *
+ * Description:
+ * Request cleanup callback, releases the device and client count of an admitted evaluation
+ * however the request was completed or cancelled.
+ *
+ * Parameters:
+ * Request - The WDFREQUEST being cleaned up.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+AdmissionRequestCleanup(
+    _In_ WDFOBJECT Request
+    )
+{
+    PREQUEST_CONTEXT requestContext = RequestContextGet(Request);
+    PADMISSION_CLIENT client = requestContext->Client;
+    PDEVICE_CONTEXT deviceContext;
+
+    if (!requestContext->Admitted) {
+        return;
+    }
+
+    deviceContext = DeviceContextGet(requestContext->Device);
+
+    WdfSpinLockAcquire(deviceContext->AdmissionLock);
+    deviceContext->Admission.outstanding--;
+    if (client != NULL) {
+        client->Outstanding--;
+        if (client->Outstanding == 0) {
+            client->ProcessId = 0;
+        }
+    }
+    WdfSpinLockRelease(deviceContext->AdmissionLock);
+
+    requestContext->Client = NULL;
+    requestContext->Admitted = FALSE;
+}
+
+/*
+ * Function: NTSTATUS AdmissionControl
+ *
+ * Description:
+ * Handles IOCTL_ADMISSION, applying the limits in AdmissionReq_t that are not ADMISSION_KEEP
+ * and returning the current limits and counters.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object holding an AdmissionReq_t with room for an AdmissionRsp_t.
+ * BytesReturned - Receives the number of output bytes written.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+NTSTATUS
+AdmissionControl(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    size_t *BytesReturned
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    AdmissionReq_t *req = NULL;
+    AdmissionRsp_t *rsp = NULL;
+    AdmissionReq_t config;
+    NTSTATUS status;
+
+    status = WdfRequestRetrieveInputBuffer(Request, sizeof(AdmissionReq_t), &req, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    status = WdfRequestRetrieveOutputBuffer(Request, sizeof(AdmissionRsp_t), &rsp, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    // Input and output share the system buffer
+    config = *req;
+    if (config.devicelimit == 0 || config.clientlimit == 0) {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    WdfSpinLockAcquire(deviceContext->AdmissionLock);
+    if (config.devicelimit != ADMISSION_KEEP) {
+        deviceContext->Admission.devicelimit = config.devicelimit;
+    }
+    if (config.clientlimit != ADMISSION_KEEP) {
+        deviceContext->Admission.clientlimit = config.clientlimit;
+    }
+    if (config.retryms != ADMISSION_KEEP) {
+        deviceContext->Admission.retryms = config.retryms;
+    }
+    *rsp = deviceContext->Admission;
+    WdfSpinLockRelease(deviceContext->AdmissionLock);
+
+    *BytesReturned = sizeof(AdmissionRsp_t);
+    return STATUS_SUCCESS;
+}
+
+#endif // EC_TEST_ADMISSION
@@ -0,0 +1,32 @@
+/*++
+Module Name:
+    admission.h
+
+Abstract:
+    Per device and per client limits on ACPI evaluations that are queued
+    or in flight, with a retry hint for rejected requests.
+--*/
+
+#ifdef EC_TEST_ADMISSION
+
+NTSTATUS
+AdmissionInitialize(
+    WDFDEVICE Device
+    );
+
+NTSTATUS
+AdmissionAdmit(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    );
+
+NTSTATUS
+AdmissionControl(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    size_t *BytesReturned
+    );
+
+EVT_WDF_OBJECT_CONTEXT_CLEANUP AdmissionRequestCleanup;
+
+#endif // EC_TEST_ADMISSION
@@ -0,0 +1,315 @@
+/*++
+Module Name:
+    bench.c
+
+Abstract:
+    Handles IOCTL_BENCH. Runs a number of ACPI evaluations through the same
+    IOCTL_ACPI_EVAL_METHOD_EX target path as WorkItemCallback and/or FF-A
+    SendDirectReq2 calls like FfaDrvTestDirectCall, timing each one with
+    the performance counter and returning a log2 histogram. Comparing with
+    ectest -bench separates the EC and firmware cost from the host stack.
+
+Environment:
+    Kernel-mode only
+
+--*/
+
+#include "driver.h"
+#include <acpiioct.h>
+#include "..\inc\ectest.h"
+#include "trace.h"
+#include "bench.tmh"
+#include "ffainterface.h"
+
+#ifdef EC_TEST_BENCH
+
+#define BENCH_ACPI_OUTPUT_SIZE  1024
+#define BENCH_POOL_TAG          'hcnB'
+#define BENCH_CANCEL_CHECK      64      // Iterations between checks for a cancelled request
+
+/*
+ * Function: NTSTATUS BenchStart
+ *
+ * Description:
+ * Validates an IOCTL_BENCH request and runs it on a work item, the iterations block for too long
+ * to run in the dispatch routine.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object holding a BenchReq_t.
+ *
+ * Return Value:
+ * NTSTATUS status code, on success the request is completed by the work item.
+ */
+NTSTATUS
+BenchStart(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    )
+{
+    NTSTATUS status;
+    WDF_OBJECT_ATTRIBUTES attributes;
+    WDF_WORKITEM_CONFIG workitemConfig;
+    WDFWORKITEM workItem;
+    PWORKITEM_CONTEXT context;
+    BenchReq_t *req = NULL;
+    BenchRsp_t *rsp = NULL;
+    size_t reqSize = 0;
+
+    status = WdfRequestRetrieveInputBuffer(Request, BENCH_REQ_HEADER_SIZE, &req, &reqSize);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    status = WdfRequestRetrieveOutputBuffer(Request, sizeof(BenchRsp_t), &rsp, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    if (req->targets == 0 ||
+        (req->targets & ~(BENCH_TARGET_ACPI | BENCH_TARGET_FFA)) != 0 ||
+        req->iterations == 0 ||
+        req->iterations > BENCH_MAX_ITERATIONS ||
+        req->warmup > BENCH_MAX_ITERATIONS ||
+        req->inputsize > reqSize - BENCH_REQ_HEADER_SIZE ||
+        ((req->targets & BENCH_TARGET_ACPI) && req->inputsize < sizeof(ACPI_EVAL_INPUT_BUFFER_V1_EX))) {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    WDF_WORKITEM_CONFIG_INIT(&workitemConfig, BenchWorkItemCallback);
+
+    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&attributes, WORKITEM_CONTEXT);
+    attributes.ParentObject = Device;
+
+    status = WdfWorkItemCreate(&workitemConfig, &attributes, &workItem);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfWorkItemCreate failed: %!STATUS!\n", status);
+        return status;
+    }
+
+    context = WorkItemGetContext(workItem);
+    context->Device = Device;
+    context->Request = Request;
+
+    WdfWorkItemEnqueue(workItem);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: VOID BenchRecord
+ *
+ * Description:
+ * Adds one timed iteration to the statistics of a target.
+ *
+ * Parameters:
+ * Stats - Statistics of the target.
+ * Ticks - Performance counter ticks the iteration took.
+ *
+ * Return Value:
+ * VOID
+ */
+static VOID
+BenchRecord(
+    BenchStats_t *Stats,
+    ULONG64 Ticks
+    )
+{
+    ULONG64 us = Ticks * 1000000 / Stats->frequency;
+    ULONG bucket = 0;
+
+    while (us > 1 && bucket < BENCH_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+
+    Stats->buckets[bucket]++;
+    Stats->total += Ticks;
+    Stats->min = Stats->count == 0 ? Ticks : min(Stats->min, Ticks);
+    Stats->max = max(Stats->max, Ticks);
+    Stats->count++;
+}
+
+/*
+ * Function: VOID BenchFailed
+ *
+ * Description:
+ * Counts a failed iteration and keeps the status of the first failure.
+ *
+ * Parameters:
+ * Stats - Statistics of the target.
+ * Status - Status of the iteration.
+ *
+ * Return Value:
+ * VOID
+ */
+static VOID
+BenchFailed(
+    BenchStats_t *Stats,
+    NTSTATUS Status
+    )
+{
+    if (Stats->failures++ == 0) {
+        Stats->status = (UINT32)Status;
+    }
+}
+
+/*
+ * Function: VOID BenchWorkItemCallback
+ *
+ * Description:
+ * Runs the warmup and timed iterations of an IOCTL_BENCH request and completes it with a
+ * BenchRsp_t. A cancelled request stops the run early.
+ *
+ * Parameters:
+ * WorkItem - The work item created by BenchStart.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+BenchWorkItemCallback(
+    _In_ WDFWORKITEM WorkItem
+    )
+{
+    PWORKITEM_CONTEXT context = WorkItemGetContext(WorkItem);
+    WDFREQUEST request = context->Request;
+    WDFIOTARGET target = WdfDeviceGetIoTarget(context->Device);
+    BenchReq_t *req = NULL;
+    BenchRsp_t *rsp = NULL;
+    PFFA_INTERFACE ffaInterface = NULL;
+    FFA_MSG_SEND_DIRECT_REQ2_PARAMETERS ffaParameters;
+    WDF_MEMORY_DESCRIPTOR inputMemDesc;
+    WDF_MEMORY_DESCRIPTOR outputMemDesc;
+    PVOID acpiInput = NULL;
+    PVOID acpiOutput = NULL;
+    LARGE_INTEGER frequency, start, end;
+    ULONG_PTR bytesReturned;
+    ULONG targets, iterations, warmup, total, i;
+    ULONG64 command;
+    GUID uuid;
+    GUID noUuid = {0};
+    BOOLEAN timed;
+    NTSTATUS status;
+
+    status = WdfRequestRetrieveInputBuffer(request, BENCH_REQ_HEADER_SIZE, &req, NULL);
+    if (NT_SUCCESS(status)) {
+        status = WdfRequestRetrieveOutputBuffer(request, sizeof(BenchRsp_t), &rsp, NULL);
+    }
+    if (!NT_SUCCESS(status)) {
+        goto Cleanup;
+    }
+
+    // Request is reused as the response buffer, keep what is needed from it
+    targets = req->targets;
+    iterations = req->iterations;
+    warmup = req->warmup;
+    uuid = req->uuid;
+    command = req->command;
+
+    if (targets & BENCH_TARGET_ACPI) {
+        acpiInput = ExAllocatePool2(POOL_FLAG_NON_PAGED, req->inputsize, BENCH_POOL_TAG);
+        acpiOutput = ExAllocatePool2(POOL_FLAG_NON_PAGED, BENCH_ACPI_OUTPUT_SIZE, BENCH_POOL_TAG);
+        if (acpiInput == NULL || acpiOutput == NULL) {
+            status = STATUS_INSUFFICIENT_RESOURCES;
+            goto Cleanup;
+        }
+        RtlCopyMemory(acpiInput, req->input, req->inputsize);
+        WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(&inputMemDesc, acpiInput, req->inputsize);
+    }
+
+    if (targets & BENCH_TARGET_FFA) {
+        // Looked up once so the lookup is not part of the timed call
+        ffaInterface = FfaGetInterface();
+        if (ffaInterface == NULL) {
+            Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Bench has no FF-A interface\n");
+            status = STATUS_NOT_SUPPORTED;
+            goto Cleanup;
+        }
+        if (RtlCompareMemory(&uuid, &noUuid, sizeof(GUID)) == sizeof(GUID)) {
+            uuid = GUID_CAPS_SERVICE_UUID;
+            command = 0x1; // GET_CAPS
+        }
+    }
+
+    RtlZeroMemory(rsp, sizeof(BenchRsp_t));
+    KeQueryPerformanceCounter(&frequency);
+    rsp->acpi.frequency = frequency.QuadPart;
+    rsp->ffa.frequency = frequency.QuadPart;
+
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Bench targets 0x%x %u iterations %u warmup\n", targets, iterations, warmup);
+
+    total = warmup + iterations;
+    for (i = 0; i < total; i++) {
+        timed = i >= warmup;
+
+        if ((i % BENCH_CANCEL_CHECK) == 0 && WdfRequestIsCanceled(request)) {
+            Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Bench cancelled after %u iterations\n", i);
+            status = STATUS_CANCELLED;
+            goto Cleanup;
+        }
+
+        if (targets & BENCH_TARGET_ACPI) {
+            WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(&outputMemDesc, acpiOutput, BENCH_ACPI_OUTPUT_SIZE);
+            bytesReturned = 0;
+
+            start = KeQueryPerformanceCounter(NULL);
+            status = WdfIoTargetSendInternalIoctlSynchronously(target,
+                                                               NULL,
+                                                               IOCTL_ACPI_EVAL_METHOD_EX,
+                                                               &inputMemDesc,
+                                                               &outputMemDesc,
+                                                               NULL,
+                                                               &bytesReturned);
+            end = KeQueryPerformanceCounter(NULL);
+
+            if (timed) {
+                if (NT_SUCCESS(status)) {
+                    BenchRecord(&rsp->acpi, end.QuadPart - start.QuadPart);
+                } else {
+                    BenchFailed(&rsp->acpi, status);
+                }
+            }
+        }
+
+        if (targets & BENCH_TARGET_FFA) {
+            RtlZeroMemory(&ffaParameters, sizeof(ffaParameters));
+            ffaParameters.Version = FFA_MSG_SEND_DIRECT_REQ2_PARAMETERS_VERSION_V1;
+            ffaParameters.AsyncParameters.Flags.FrameworkYieldHandling = ENABLE_FFA_YIELD;
+            ffaParameters.ServiceUuid = uuid;
+            ffaParameters.InputBuffer.Arg4 = command;
+
+            start = KeQueryPerformanceCounter(NULL);
+            status = ffaInterface->SendDirectReq2(&ffaParameters);
+            end = KeQueryPerformanceCounter(NULL);
+
+            if (timed) {
+                if (NT_SUCCESS(status)) {
+                    BenchRecord(&rsp->ffa, end.QuadPart - start.QuadPart);
+                } else {
+                    BenchFailed(&rsp->ffa, status);
+                }
+            }
+        }
+    }
+
+    // Failures are reported per target in the response
+    status = STATUS_SUCCESS;
+
+Cleanup:
+    if (acpiInput != NULL) {
+        ExFreePoolWithTag(acpiInput, BENCH_POOL_TAG);
+    }
+    if (acpiOutput != NULL) {
+        ExFreePoolWithTag(acpiOutput, BENCH_POOL_TAG);
+    }
+
+    if (NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Bench done, ACPI %llu ok %llu failed, FF-A %llu ok %llu failed\n",
+              rsp->acpi.count, rsp->acpi.failures, rsp->ffa.count, rsp->ffa.failures);
+        WdfRequestCompleteWithInformation(request, status, sizeof(BenchRsp_t));
+    } else {
+        WdfRequestComplete(request, status);
+    }
+}
+
+#endif // EC_TEST_BENCH
@@ -0,0 +1,20 @@
+/*++
+Module Name:
+    bench.h
+
+Abstract:
+    In-driver latency benchmark of ACPI evaluation and FF-A direct
+    requests.
+--*/
+
+#ifdef EC_TEST_BENCH
+
+NTSTATUS
+BenchStart(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    );
+
+EVT_WDF_WORKITEM BenchWorkItemCallback;
+
+#endif // EC_TEST_BENCH
@@ -0,0 +1,477 @@
+/*++
+Module Name:
+    bulk.c
+
+Abstract:
+    Handles IOCTL_BULK_TRANSFER. UEFI shares a pool of large buffers with
+    the EC at boot, each in its own FFA_MEM_SHARE that the EC retrieves
+    once, and publishes their memory handles in the geometry page. A
+    transfer takes a free buffer, passes its handle to the EC in an
+    EC_CAP_BULK direct request and copies the data between the buffer and
+    the request, so a firmware image or log dump moves a buffer at a time
+    instead of a ring entry at a time and never pays the share and
+    retrieve handshake. Transfers wait in a manual queue while every
+    buffer is in use.
+
+Environment:
+    Kernel-mode only
+
+--*/
+
+#include "driver.h"
+#include "..\inc\ectest.h"
+#include "..\inc\ecsvc.h"
+#include "trace.h"
+#include "bulk.tmh"
+#include "ffainterface.h"
+
+#ifdef EC_TEST_BULK
+
+// Largest span of the shared region the pool may cover
+#define BULK_POOL_MAX_SPAN      0x1000000
+
+/*
+ * Function: NTSTATUS BulkReadPool
+ *
+ * Description:
+ * Reads the bulk buffer table UEFI publishes after the ring geometry and maps the buffers.
+ *
+ * Parameters:
+ * DeviceContext - Device context to fill in.
+ *
+ * Return Value:
+ * STATUS_NOT_FOUND if firmware did not publish a pool, otherwise NTSTATUS of the mapping.
+ */
+static NTSTATUS
+BulkReadPool(
+    PDEVICE_CONTEXT DeviceContext
+    )
+{
+    PHYSICAL_ADDRESS physicalAddress;
+    PUCHAR header;
+    ULONG64 offsets[EC_BULK_BUFFER_MAX];
+    ULONG64 low = MAXULONG64;
+    ULONG64 high = 0;
+    ULONG magic, count, size, i;
+
+    physicalAddress.QuadPart = SBSAQEMU_SHARED_MEM_BASE;
+    header = MmMapIoSpaceEx(physicalAddress, EC_RING_PAGE_SIZE, PAGE_READONLY | PAGE_NOCACHE);
+    if (header == NULL) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Failed to map ring geometry page\n");
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    magic = READ_REGISTER_ULONG((PULONG)(header + EC_BULK_MAGIC_OFFSET));
+    count = READ_REGISTER_USHORT((PUSHORT)(header + EC_BULK_COUNT_OFFSET));
+    size = READ_REGISTER_ULONG((PULONG)(header + EC_BULK_SIZE_OFFSET));
+    for (i = 0; magic == EC_BULK_MAGIC && i < count && i < EC_BULK_BUFFER_MAX; i++) {
+        DeviceContext->BulkHandles[i] = READ_REGISTER_ULONG64((PULONG64)(header + EC_BULK_ENTRY_OFFSET + i * EC_BULK_ENTRY_SIZE));
+        offsets[i] = READ_REGISTER_ULONG64((PULONG64)(header + EC_BULK_ENTRY_OFFSET + i * EC_BULK_ENTRY_SIZE + 8));
+        low = min(low, offsets[i]);
+        high = max(high, offsets[i] + size);
+    }
+    MmUnmapIoSpace(header, EC_RING_PAGE_SIZE);
+
+    if (magic != EC_BULK_MAGIC) {
+        Trace(TRACE_LEVEL_WARNING, TRACE_QUEUE,"No bulk buffer pool published\n");
+        return STATUS_NOT_FOUND;
+    }
+
+    if (count == 0 || count > EC_BULK_BUFFER_MAX ||
+        size == 0 || (size % EC_RING_PAGE_SIZE) != 0 ||
+        (low % EC_RING_PAGE_SIZE) != 0 || low < EC_RING_PAGE_SIZE ||
+        high - low > BULK_POOL_MAX_SPAN) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Invalid bulk pool count %u size 0x%x span 0x%llx\n", count, size, high - low);
+        return STATUS_DEVICE_CONFIGURATION_ERROR;
+    }
+
+    for (i = 0; i < count; i++) {
+        if ((offsets[i] % EC_RING_PAGE_SIZE) != 0) {
+            return STATUS_DEVICE_CONFIGURATION_ERROR;
+        }
+        DeviceContext->BulkOffsets[i] = (ULONG)(offsets[i] - low);
+    }
+
+    physicalAddress.QuadPart = SBSAQEMU_SHARED_MEM_BASE + low;
+    DeviceContext->BulkPool = MmMapIoSpaceEx(physicalAddress, (SIZE_T)(high - low), PAGE_READWRITE | PAGE_NOCACHE);
+    if (DeviceContext->BulkPool == NULL) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Failed to map bulk pool\n");
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    DeviceContext->BulkPoolSize = (SIZE_T)(high - low);
+    DeviceContext->BulkCount = count;
+    DeviceContext->BulkSize = size;
+    DeviceContext->BulkFree = (1UL << count) - 1;
+
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Bulk pool %u buffers of 0x%x at 0x%llx\n", count, size, low);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: NTSTATUS BulkInitialize
+ *
+ * Description:
+ * Creates the pool lock and the queue of waiting transfers and maps the bulk buffer pool.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * NTSTATUS status code, on failure IOCTL_BULK_TRANSFER is not supported.
+ */
+NTSTATUS
+BulkInitialize(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    WDF_IO_QUEUE_CONFIG queueConfig;
+    WDF_OBJECT_ATTRIBUTES attributes;
+    NTSTATUS status;
+
+    deviceContext->BulkPool = NULL;
+    deviceContext->BulkPoolSize = 0;
+    deviceContext->BulkCount = 0;
+    deviceContext->BulkFree = 0;
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = Device;
+    status = WdfWaitLockCreate(&attributes, &deviceContext->BulkLock);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfWaitLockCreate failed %!STATUS!\n", status);
+        return status;
+    }
+
+    WDF_IO_QUEUE_CONFIG_INIT(&queueConfig, WdfIoQueueDispatchManual);
+    status = WdfIoQueueCreate(Device, &queueConfig, WDF_NO_OBJECT_ATTRIBUTES, &deviceContext->BulkQueue);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfIoQueueCreate for bulk failed %!STATUS!\n", status);
+        return status;
+    }
+
+    return BulkReadPool(deviceContext);
+}
+
+/*
+ * Function: VOID BulkUninitialize
+ *
+ * Description:
+ * Unmaps the bulk buffer pool, waiting transfers have already been cancelled when the queue
+ * was purged.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+BulkUninitialize(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+
+    if (deviceContext->BulkPool != NULL) {
+        MmUnmapIoSpace(deviceContext->BulkPool, deviceContext->BulkPoolSize);
+        deviceContext->BulkPool = NULL;
+        deviceContext->BulkPoolSize = 0;
+    }
+}
+
+/*
+ * Function: VOID BulkDispatch
+ *
+ * Description:
+ * Hands free pool buffers to waiting transfers, each on its own work item.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * VOID
+ */
+static VOID
+BulkDispatch(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    WDF_OBJECT_ATTRIBUTES attributes;
+    WDF_WORKITEM_CONFIG workitemConfig;
+    WDFWORKITEM workItem;
+    PWORKITEM_CONTEXT context;
+    WDFREQUEST request;
+    NTSTATUS status;
+    ULONG index;
+
+    WdfWaitLockAcquire(deviceContext->BulkLock, NULL);
+    while (deviceContext->BulkFree != 0) {
+        status = WdfIoQueueRetrieveNextRequest(deviceContext->BulkQueue, &request);
+        if (!NT_SUCCESS(status)) {
+            break;
+        }
+
+        for (index = 0; (deviceContext->BulkFree & (1UL << index)) == 0; index++);
+
+        WDF_WORKITEM_CONFIG_INIT(&workitemConfig, BulkWorkItemCallback);
+        WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&attributes, WORKITEM_CONTEXT);
+        attributes.ParentObject = Device;
+
+        status = WdfWorkItemCreate(&workitemConfig, &attributes, &workItem);
+        if (!NT_SUCCESS(status)) {
+            Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfWorkItemCreate failed: %!STATUS!\n", status);
+            WdfRequestComplete(request, status);
+            continue;
+        }
+
+        deviceContext->BulkFree &= ~(1UL << index);
+        context = WorkItemGetContext(workItem);
+        context->Device = Device;
+        context->Request = request;
+        context->BulkBuffer = index;
+        WdfWorkItemEnqueue(workItem);
+    }
+    WdfWaitLockRelease(deviceContext->BulkLock);
+}
+
+/*
+ * Function: NTSTATUS BulkStart
+ *
+ * Description:
+ * Validates a BulkReq_t and queues the transfer until a pool buffer is free.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object holding a BulkReq_t, output receives a BulkRsp_t.
+ *
+ * Return Value:
+ * NTSTATUS status code, on success the request is completed by the work item.
+ */
+NTSTATUS
+BulkStart(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    BulkReq_t *req = NULL;
+    BulkRsp_t *rsp = NULL;
+    size_t reqSize = 0;
+    size_t rspSize = 0;
+    NTSTATUS status;
+
+    if (deviceContext->BulkPool == NULL) {
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    status = WdfRequestRetrieveInputBuffer(Request, BULK_REQ_HEADER_SIZE, &req, &reqSize);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    status = WdfRequestRetrieveOutputBuffer(Request, BULK_RSP_HEADER_SIZE, &rsp, &rspSize);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    if ((req->op != EC_BULK_OP_READ && req->op != EC_BULK_OP_WRITE) ||
+        req->length == 0 ||
+        req->length > BULK_MAX_LENGTH ||
+        (req->op == EC_BULK_OP_WRITE && reqSize < BULK_REQ_HEADER_SIZE + req->length) ||
+        (req->op == EC_BULK_OP_READ && rspSize < BULK_RSP_HEADER_SIZE + req->length)) {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    status = WdfRequestForwardToIoQueue(Request, deviceContext->BulkQueue);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfRequestForwardToIoQueue failed %!STATUS!\n", status);
+        return status;
+    }
+
+    BulkDispatch(Device);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: VOID BulkCopyToPool
+ *
+ * Description:
+ * Copies request data into a pool buffer. The pool may be mapped as device memory so only
+ * aligned 64-bit accesses are used.
+ *
+ * Parameters:
+ * Pool - Pool buffer, page aligned.
+ * Data - Source, 8 byte aligned.
+ * Length - Bytes to copy.
+ *
+ * Return Value:
+ * VOID
+ */
+static VOID
+BulkCopyToPool(
+    PUCHAR Pool,
+    PUCHAR Data,
+    ULONG Length
+    )
+{
+    ULONG words = Length / sizeof(ULONG64);
+    ULONG64 tail = 0;
+
+    WRITE_REGISTER_BUFFER_ULONG64((PULONG64)Pool, (PULONG64)Data, words);
+    if ((Length % sizeof(ULONG64)) != 0) {
+        RtlCopyMemory(&tail, Data + words * sizeof(ULONG64), Length % sizeof(ULONG64));
+        WRITE_REGISTER_ULONG64((PULONG64)Pool + words, tail);
+    }
+}
+
+/*
+ * Function: VOID BulkCopyFromPool
+ *
+ * Description:
+ * Copies a pool buffer into the response with aligned 64-bit accesses.
+ *
+ * Parameters:
+ * Data - Destination, 8 byte aligned.
+ * Pool - Pool buffer, page aligned.
+ * Length - Bytes to copy.
+ *
+ * Return Value:
+ * VOID
+ */
+static VOID
+BulkCopyFromPool(
+    PUCHAR Data,
+    PUCHAR Pool,
+    ULONG Length
+    )
+{
+    ULONG words = Length / sizeof(ULONG64);
+    ULONG64 tail;
+
+    READ_REGISTER_BUFFER_ULONG64((PULONG64)Pool, (PULONG64)Data, words);
+    if ((Length % sizeof(ULONG64)) != 0) {
+        tail = READ_REGISTER_ULONG64((PULONG64)Pool + words);
+        RtlCopyMemory(Data + words * sizeof(ULONG64), &tail, Length % sizeof(ULONG64));
+    }
+}
+
+/*
+ * Function: VOID BulkWorkItemCallback
+ *
+ * Description:
+ * Runs one transfer through the pool buffer BulkDispatch handed it, one EC_CAP_BULK direct
+ * request per buffer's worth of data, stopping early at the end of the object. The buffer goes
+ * back to the pool before the request is completed.
+ *
+ * Parameters:
+ * WorkItem - Work item created by BulkDispatch.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+BulkWorkItemCallback(
+    _In_ WDFWORKITEM WorkItem
+    )
+{
+    PWORKITEM_CONTEXT context = WorkItemGetContext(WorkItem);
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(context->Device);
+    WDFREQUEST request = context->Request;
+    ULONG index = context->BulkBuffer;
+    PUCHAR pool = deviceContext->BulkPool + deviceContext->BulkOffsets[index];
+    FFA_MSG_SEND_DIRECT_REQ2_PARAMETERS ffaParameters;
+    PUCHAR in = ffaParameters.InputBuffer.Buffer;
+    PUCHAR out = ffaParameters.OutputBuffer.Buffer;
+    PFFA_INTERFACE ffaInterface;
+    BulkReq_t *req = NULL;
+    BulkRsp_t *rsp = NULL;
+    ULONG op, object, offset, length;
+    ULONG done = 0, calls = 0, ecStatus = 0, total = 0;
+    ULONG chunk, moved;
+    size_t information = 0;
+    NTSTATUS status;
+
+    status = WdfRequestRetrieveInputBuffer(request, BULK_REQ_HEADER_SIZE, &req, NULL);
+    if (NT_SUCCESS(status)) {
+        status = WdfRequestRetrieveOutputBuffer(request, BULK_RSP_HEADER_SIZE, &rsp, NULL);
+    }
+    if (!NT_SUCCESS(status)) {
+        goto Cleanup;
+    }
+
+    ffaInterface = FfaGetInterface();
+    if (ffaInterface == NULL) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Bulk has no FF-A interface\n");
+        status = STATUS_NOT_SUPPORTED;
+        goto Cleanup;
+    }
+
+    // Input and output share the system buffer, the response header is only written at the end
+    op = req->op;
+    object = req->object;
+    offset = req->offset;
+    length = req->length;
+
+    while (done < length) {
+        chunk = min(length - done, deviceContext->BulkSize);
+        if (op == EC_BULK_OP_WRITE) {
+            BulkCopyToPool(pool, req->data + done, chunk);
+        }
+
+        RtlZeroMemory(&ffaParameters, sizeof(ffaParameters));
+        ffaParameters.Version = FFA_MSG_SEND_DIRECT_REQ2_PARAMETERS_VERSION_V1;
+        ffaParameters.AsyncParameters.Flags.FrameworkYieldHandling = ENABLE_FFA_YIELD;
+        ffaParameters.ServiceUuid = GUID_CAPS_SERVICE_UUID;
+        in[EC_PAYLOAD_CMD] = EC_CAP_BULK;
+        in[EC_BULK_OP] = (UCHAR)op;
+        in[EC_BULK_OBJECT] = (UCHAR)object;
+        *(PULONG)(in + EC_BULK_OBJECT_OFFSET) = offset + done;
+        *(PULONG64)(in + EC_BULK_HANDLE) = deviceContext->BulkHandles[index];
+        *(PULONG)(in + EC_BULK_LENGTH) = chunk;
+
+        calls++;
+        status = ffaInterface->SendDirectReq2(&ffaParameters);
+        if (!NT_SUCCESS(status)) {
+            Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"EC_CAP_BULK failed %!STATUS!\n", status);
+            break;
+        }
+
+        ecStatus = *(PULONG)(out + EC_BULK_STATUS);
+        total = *(PULONG)(out + EC_BULK_TOTAL);
+        if (ecStatus != 0) {
+            break;
+        }
+
+        moved = min(*(PULONG)(out + EC_BULK_MOVED), chunk);
+        if (op == EC_BULK_OP_READ) {
+            BulkCopyFromPool(rsp->data + done, pool, moved);
+        }
+        done += moved;
+        if (moved < chunk) {
+            break;
+        }
+    }
+
+    if (NT_SUCCESS(status)) {
+        rsp->status = ecStatus;
+        rsp->length = done;
+        rsp->total = total;
+        rsp->calls = calls;
+        rsp->buffer = index;
+        rsp->buffersize = deviceContext->BulkSize;
+        information = BULK_RSP_HEADER_SIZE + (op == EC_BULK_OP_READ ? done : 0);
+        Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Bulk op %u object %u moved %u bytes in %u requests\n", op, object, done, calls);
+    }
+
+Cleanup:
+    WdfWaitLockAcquire(deviceContext->BulkLock, NULL);
+    deviceContext->BulkFree |= 1UL << index;
+    WdfWaitLockRelease(deviceContext->BulkLock);
+    BulkDispatch(context->Device);
+
+    WdfRequestCompleteWithInformation(request, status, information);
+}
+
+#endif // EC_TEST_BULK
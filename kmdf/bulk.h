@@ -0,0 +1,30 @@
+/*++
+Module Name:
+    bulk.h
+
+Abstract:
+    Bulk transfers of EC objects through the pool of buffers UEFI shares
+    with the EC at boot.
+--*/
+
+#ifdef EC_TEST_BULK
+
+NTSTATUS
+BulkInitialize(
+    WDFDEVICE Device
+    );
+
+VOID
+BulkUninitialize(
+    WDFDEVICE Device
+    );
+
+NTSTATUS
+BulkStart(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    );
+
+EVT_WDF_WORKITEM BulkWorkItemCallback;
+
+#endif // EC_TEST_BULK
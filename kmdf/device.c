@@ -1,117 +1,190 @@
-/*++
-Module Name:
-    device.c - Device handling events for example driver.
-
-Abstract:
-    This is a C version of a very simple sample driver that illustrates
-    how to use the driver framework and demonstrates best practices.
---*/
-
-#include "driver.h"
-#include "trace.h"
-#include "device.tmh"
-
-#ifdef ALLOC_PRAGMA
-#pragma alloc_text (PAGE, ECTestDeviceCreate)
-#endif
-
-
-NTSTATUS
-ECTestDeviceCreate(
-    PWDFDEVICE_INIT DeviceInit
-    )
-/*++
-
-Routine Description:
-
-    Worker routine called to create a device and its software resources.
-
-Arguments:
-
-    DeviceInit - Pointer to an opaque init structure. Memory for this
-                    structure will be freed by the framework when the WdfDeviceCreate
-                    succeeds. So don't access the structure after that point.
-
-Return Value:
-
-    NTSTATUS
-
---*/
-{
-    WDF_OBJECT_ATTRIBUTES   deviceAttributes;
-    PDEVICE_CONTEXT deviceContext;
-    WDFDEVICE device;
-    NTSTATUS status;
-
-    PAGED_CODE();
-
-    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&deviceAttributes, DEVICE_CONTEXT);
-    status = WdfDeviceCreate(&DeviceInit, &deviceAttributes, &device);
-
-    if (NT_SUCCESS(status)) {
-        //
-        // Get the device context and initialize it. DeviceContextGet is an
-        // inline function generated by WDF_DECLARE_CONTEXT_TYPE macro in the
-        // device.h header file. This function will do the type checking and return
-        // the device context. If you pass a wrong object  handle
-        // it will return NULL and assert if run under framework verifier mode.
-        //
-        deviceContext = DeviceContextGet(device);
-        deviceContext->PendingRequest = NULL;
-
-#if defined(EC_TEST_NOTIFICATIONS) && defined(ENABLE_NOTIFICATION_SIMULATION)
-        deviceContext->Timer = NULL;
-#endif
-
-#ifdef EC_TEST_NOTIFICATIONS
-        WDF_OBJECT_ATTRIBUTES attributes;
-
-        WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
-        attributes.ParentObject = device;
-        status = WdfWaitLockCreate(&attributes, &deviceContext->NotificationLock);
-
-        if (NT_SUCCESS(status)) {
-#endif // EC_TEST_NOTIFICATIONS
-
-            //
-            // Create a device interface so that application can find and talk
-            // to us.
-            //
-            status = WdfDeviceCreateDeviceInterface(
-                device,
-                &GUID_DEVINTERFACE_ECTEST,
-                NULL // ReferenceString
-                );
-
-            if (NT_SUCCESS(status)) {
-                //
-                // Initialize the I/O Package and any Queues
-                //
-                status = ECTestQueueInitialize(device);
-
-#if defined(EC_TEST_NOTIFICATIONS) && defined(ENABLE_NOTIFICATION_SIMULATION)
-                WDF_OBJECT_ATTRIBUTES timerAttributes;
-                WDF_TIMER_CONFIG timerConfig;
-                // Initialize the timer configuration
-                WDF_TIMER_CONFIG_INIT_PERIODIC(&timerConfig, TimerCallback, 1000); // 1000 ms period
-
-                // Set the timer attributes
-                WDF_OBJECT_ATTRIBUTES_INIT(&timerAttributes);
-                timerAttributes.ParentObject = device;
-
-                // Create the timer
-                if (!NT_SUCCESS(WdfTimerCreate(&timerConfig, &timerAttributes, &deviceContext->Timer))) {
-
-                    // Ignore the failure, and allow the device to create successfully
-                    Trace(TRACE_LEVEL_ERROR, TRACE_DEVICE,"WdfTimerCreate failed\n");
-                    deviceContext->Timer = NULL;
-                }
-#endif
-            }
-#ifdef EC_TEST_NOTIFICATIONS
-        }
-#endif // EC_TEST_NOTIFICATIONS
-    }
-
-    return status;
-}
+/*++
+Module Name:
+    device.c - Device handling events for example driver.
+
+Abstract:
+    This is a C version of a very simple sample driver that illustrates
+    how to use the driver framework and demonstrates best practices.
+--*/
+
+#include "driver.h"
+#include "trace.h"
+#include "device.tmh"
+
+#ifdef ALLOC_PRAGMA
+#pragma alloc_text (PAGE, ECTestDeviceCreate)
+#endif
+
+
+NTSTATUS
+ECTestDeviceCreate(
+    PWDFDEVICE_INIT DeviceInit
+    )
+/*++
+
+Routine Description:
+
+    Worker routine called to create a device and its software resources.
+
+Arguments:
+
+    DeviceInit - Pointer to an opaque init structure. Memory for this
+                    structure will be freed by the framework when the WdfDeviceCreate
+                    succeeds. So don't access the structure after that point.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    WDF_OBJECT_ATTRIBUTES   deviceAttributes;
+    PDEVICE_CONTEXT deviceContext;
+    WDFDEVICE device;
+    NTSTATUS status;
+
+    PAGED_CODE();
+
+#ifdef EC_TEST_PRIORITY
+    WDF_OBJECT_ATTRIBUTES requestAttributes;
+
+    // Every request gets a context so evaluations can carry their class through the queues
+    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&requestAttributes, REQUEST_CONTEXT);
+#ifdef EC_TEST_ADMISSION
+    requestAttributes.EvtCleanupCallback = AdmissionRequestCleanup;
+#endif
+    WdfDeviceInitSetRequestAttributes(DeviceInit, &requestAttributes);
+#endif
+
+    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&deviceAttributes, DEVICE_CONTEXT);
+    deviceAttributes.EvtCleanupCallback = ECTestEvtDeviceCleanup;
+    status = WdfDeviceCreate(&DeviceInit, &deviceAttributes, &device);
+
+    if (NT_SUCCESS(status)) {
+        //
+        // Get the device context and initialize it. DeviceContextGet is an
+        // inline function generated by WDF_DECLARE_CONTEXT_TYPE macro in the
+        // device.h header file. This function will do the type checking and return
+        // the device context. If you pass a wrong object  handle
+        // it will return NULL and assert if run under framework verifier mode.
+        //
+        deviceContext = DeviceContextGet(device);
+        deviceContext->PendingRequest = NULL;
+
+#ifdef EC_TEST_NOTIFICATIONS
+        WDF_OBJECT_ATTRIBUTES attributes;
+
+        WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+        attributes.ParentObject = device;
+        status = WdfWaitLockCreate(&attributes, &deviceContext->NotificationLock);
+
+        if (NT_SUCCESS(status)) {
+            status = NotifyInitialize(device);
+        }
+
+#ifdef EC_TEST_GENERATOR
+        if (NT_SUCCESS(status)) {
+            status = GeneratorInitialize(device);
+        }
+#endif
+
+        if (NT_SUCCESS(status)) {
+#endif // EC_TEST_NOTIFICATIONS
+
+            //
+            // Create a device interface so that application can find and talk
+            // to us.
+            //
+            status = WdfDeviceCreateDeviceInterface(
+                device,
+                &GUID_DEVINTERFACE_ECTEST,
+                NULL // ReferenceString
+                );
+
+            if (NT_SUCCESS(status)) {
+                //
+                // Initialize the I/O Package and any Queues
+                //
+                status = ECTestQueueInitialize(device);
+
+#ifdef EC_TEST_DOORBELL
+                if (NT_SUCCESS(status)) {
+                    // Without the ring async waits fail but the rest of the driver still works
+                    if (!NT_SUCCESS(RingInitialize(device))) {
+                        Trace(TRACE_LEVEL_ERROR, TRACE_DEVICE,"RingInitialize failed\n");
+                    }
+                }
+#endif
+
+#ifdef EC_TEST_BULK
+                if (NT_SUCCESS(status)) {
+                    // Without the pool bulk transfers fail but the rest of the driver still works
+                    if (!NT_SUCCESS(BulkInitialize(device))) {
+                        Trace(TRACE_LEVEL_ERROR, TRACE_DEVICE,"BulkInitialize failed\n");
+                    }
+                }
+#endif
+
+#ifdef EC_TEST_LOG
+                if (NT_SUCCESS(status)) {
+                    // Without the log ring log reads fail but the rest of the driver still works
+                    if (!NT_SUCCESS(LogInitialize(device))) {
+                        Trace(TRACE_LEVEL_ERROR, TRACE_DEVICE,"LogInitialize failed\n");
+                    }
+                }
+#endif
+
+#ifdef EC_TEST_TIMELINE
+                if (NT_SUCCESS(status)) {
+                    // Without the ring timeline reads fail but the rest of the driver still works
+                    if (!NT_SUCCESS(TimelineInitialize(device))) {
+                        Trace(TRACE_LEVEL_ERROR, TRACE_DEVICE,"TimelineInitialize failed\n");
+                    }
+                }
+#endif
+
+            }
+#ifdef EC_TEST_NOTIFICATIONS
+        }
+#endif // EC_TEST_NOTIFICATIONS
+    }
+
+    return status;
+}
+
+VOID
+ECTestEvtDeviceCleanup(
+    WDFOBJECT Device
+    )
+/*++
+
+Routine Description:
+
+    Releases resources that are not parented to the device object.
+
+Arguments:
+
+    Device - Handle to the framework device object.
+
+Return Value:
+
+    VOID
+
+--*/
+{
+#if !defined(EC_TEST_DOORBELL) && !defined(EC_TEST_BULK) && !defined(EC_TEST_LOG) && !defined(EC_TEST_TIMELINE)
+    UNREFERENCED_PARAMETER(Device);
+#endif
+#ifdef EC_TEST_DOORBELL
+    RingUninitialize((WDFDEVICE)Device);
+#endif
+#ifdef EC_TEST_BULK
+    BulkUninitialize((WDFDEVICE)Device);
+#endif
+#ifdef EC_TEST_LOG
+    LogUninitialize((WDFDEVICE)Device);
+#endif
+#ifdef EC_TEST_TIMELINE
+    TimelineUninitialize((WDFDEVICE)Device);
+#endif
+}
@@ -1,45 +1,248 @@
-/*++
-Module Name:
-    device.h
-
-Abstract:
-    This is a C version of a very simple sample driver that illustrates
-    how to use the driver framework and demonstrates best practices.
---*/
-
-#include "public.h"
-
-#define EC_TEST_NOTIFICATIONS  // Enable notification support
-//#define ENABLE_NOTIFICATION_SIMULATION // Enable notification simulation
-
-//
-// The device context performs the same job as
-// a WDM device extension in the driver frameworks
-//
-typedef struct _DEVICE_CONTEXT
-{
-    WDFREQUEST PendingRequest; // Pending request for notification
-#ifdef EC_TEST_NOTIFICATIONS
-    WDFWAITLOCK  NotificationLock; // lock for notification
-#endif
-#if defined(EC_TEST_NOTIFICATIONS) && defined(ENABLE_NOTIFICATION_SIMULATION)
-    WDFTIMER Timer; // Timer for notification simulation
-#endif
-} DEVICE_CONTEXT, *PDEVICE_CONTEXT;
-
-//
-// This macro will generate an inline function called DeviceContextGet
-// which will be used to get a pointer to the device context memory
-// in a type safe manner.
-//
-WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(DEVICE_CONTEXT, DeviceContextGet)
-
-//
-// Function to initialize the device and its callbacks
-//
-NTSTATUS ECTestDeviceCreate(PWDFDEVICE_INIT DeviceInit );
-
-#if defined(EC_TEST_NOTIFICATIONS) && defined(ENABLE_NOTIFICATION_SIMULATION)
-// Timer routine to simulate receiving the Notification at the driver.
-VOID TimerCallback(WDFTIMER Timer);
-#endif
+/*++
+Module Name:
+    device.h
+
+Abstract:
+    This is a C version of a very simple sample driver that illustrates
+    how to use the driver framework and demonstrates best practices.
+--*/
+
+#include "public.h"
+#include "..\inc\ecring.h"
+#include "..\inc\ectest.h"
+
+#define EC_TEST_NOTIFICATIONS  // Enable notification support
+#define EC_TEST_GENERATOR      // Synthetic notifications controlled by IOCTL_GENERATOR
+#define EC_TEST_DOORBELL       // Complete RX ring waits from EC doorbell notification
+#define EC_TEST_BENCH          // In-driver ACPI and FF-A latency benchmark with IOCTL_BENCH
+#define EC_TEST_PRIORITY       // Dispatch ACPI evaluations from per priority class queues
+#define EC_TEST_ADMISSION      // Per device and per client limits on queued evaluations, needs EC_TEST_PRIORITY
+#define EC_TEST_MUX            // Pack small FF-A commands into EC_MUX direct requests with IOCTL_FFA_MUX
+#define EC_TEST_BULK           // Move large EC objects through pre-shared buffers with IOCTL_BULK_TRANSFER
+#define EC_TEST_LOG            // Follow the EC log stream ring with IOCTL_LOG_READ
+#define EC_TEST_NAMESPACE      // Pass IOCTL_ACPI_ENUM_CHILDREN to ACPI for method discovery
+#define EC_TEST_TIMELINE       // Timestamped request events for IOCTL_TIMELINE_READ, needs EC_TEST_PRIORITY
+
+#ifdef EC_TEST_NOTIFICATIONS
+//
+// Occurrences of one event ID, folded together while the coalescing window is open
+//
+typedef struct _NOTIFY_BATCH
+{
+    ULONG Value;            // Notify value of the last occurrence
+    ULONG Occurrences;
+    LONGLONG First;         // System time of first and last occurrence
+    LONGLONG Last;
+    BOOLEAN Stamped;        // Stamp holds the last generated occurrence
+    GeneratorStamp_t Stamp;
+} NOTIFY_BATCH, *PNOTIFY_BATCH;
+
+typedef struct _NOTIFY_EVENT
+{
+    NOTIFY_BATCH Batch;     // Occurrences not yet delivered
+    ULONG WindowUs;         // Coalescing window, 0 delivers every occurrence
+    BOOLEAN Ready;          // Batch can be delivered to the next request
+    ULONGLONG Deadline;     // Interrupt time the window closes, 0 if not open
+    LONGLONG LastSeen;      // System time of the last occurrence
+    ULONG64 Count;
+    ULONG64 Delivered;
+    ULONG64 Coalesced;
+} NOTIFY_EVENT, *PNOTIFY_EVENT;
+#endif
+
+#if defined(EC_TEST_NOTIFICATIONS) && defined(EC_TEST_GENERATOR)
+//
+// State of the synthetic notification generator
+//
+typedef struct _GENERATOR
+{
+    GeneratorReq_t Config;
+    BOOLEAN Running;
+    ULONG Run;
+    ULONG64 Generated;
+    ULONG Random;           // xorshift32 state
+    ULONG Next;             // Offset of the next event for round robin
+    ULONGLONG Start;        // Interrupt time the run started
+    LONGLONG StartSystem;   // System time the run started
+    ULONGLONG Elapsed;
+} GENERATOR, *PGENERATOR;
+#endif
+
+#ifdef EC_TEST_DOORBELL
+//
+// Request waiting for a sequence number to show up on the RX ring
+//
+typedef struct _RX_WAITER
+{
+    WDFREQUEST Request;
+    PUCHAR Output;          // RxSequenceRsp_t in request output buffer
+    size_t OutputSize;
+    USHORT Sequence;
+    USHORT NextFragment;    // Next fragment index expected on the ring
+    ULONG Received;         // Bytes reassembled so far
+    ULONG Total;            // Message length from the first fragment
+    ULONGLONG Deadline;     // Interrupt time in 100ns units, 0 for no timeout
+    ULONG Correlation;      // Timeline correlation ID
+} RX_WAITER, *PRX_WAITER;
+#endif
+
+#ifdef EC_TEST_LOG
+#define LOG_WAITER_COUNT 16
+
+//
+// Reader waiting for the EC to log past its cursor
+//
+typedef struct _LOG_WAITER
+{
+    WDFREQUEST Request;
+    ULONG64 Cursor;         // Stream position the reader is at
+    ULONGLONG Deadline;     // Interrupt time in 100ns units, 0 for no timeout
+} LOG_WAITER, *PLOG_WAITER;
+#endif
+
+#ifdef EC_TEST_ADMISSION
+//
+// Evaluations outstanding for one client process
+//
+typedef struct _ADMISSION_CLIENT
+{
+    ULONG ProcessId;        // 0 when the entry is free
+    ULONG Outstanding;      // Requests queued or in flight
+} ADMISSION_CLIENT, *PADMISSION_CLIENT;
+#endif
+
+#ifdef EC_TEST_PRIORITY
+//
+// Per request state of ACPI evaluations going through the priority queues
+//
+typedef struct _REQUEST_CONTEXT
+{
+    ULONG Priority;         // EVAL_PRIORITY_* class
+    ULONG Shard;            // Index in DEVICE_CONTEXT Shards
+    ULONG InputOffset;      // Bytes before the ACPI input in the input buffer
+    ULONG InputTrailer;     // Bytes after the ACPI input, an EvalCorrelation_t or 0
+    ULONGLONG Enqueued;     // Interrupt time the request was queued
+    ULONGLONG Dispatched;   // Interrupt time the request was handed to a work item
+    ULONG Correlation;      // Timeline correlation ID
+#ifdef EC_TEST_ADMISSION
+    WDFDEVICE Device;       // Device the request is counted against
+    PADMISSION_CLIENT Client; // Client the request is counted against, NULL if not tracked
+    BOOLEAN Admitted;       // Counted against the device until cleanup
+#endif
+} REQUEST_CONTEXT, *PREQUEST_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(REQUEST_CONTEXT, RequestContextGet)
+
+#define EVAL_SHARD_PATH_LEN 256 // ACPI_EVAL_INPUT_BUFFER_V1_EX MethodName
+
+//
+// Evaluations for one ACPI device path, each shard is dispatched independently
+//
+typedef struct _EVAL_SHARD
+{
+    WDFQUEUE Queues[EVAL_PRIORITY_COUNT]; // Manual queues of waiting evaluations
+    CHAR Path[EVAL_SHARD_PATH_LEN]; // Full device path, Stats only has room for a prefix
+    EvalShardStats_t Stats; // Holds the prefix and in flight count
+} EVAL_SHARD, *PEVAL_SHARD;
+#endif
+
+#ifdef EC_TEST_TIMELINE
+//
+// Timeline ring entry, Position is the stream position plus one once the event is written and
+// 0 while it is being written
+//
+typedef struct _TIMELINE_SLOT
+{
+    volatile LONG64 Position;
+    TimelineEvent_t Event;
+} TIMELINE_SLOT, *PTIMELINE_SLOT;
+#endif
+
+//
+// The device context performs the same job as
+// a WDM device extension in the driver frameworks
+//
+typedef struct _DEVICE_CONTEXT
+{
+    WDFREQUEST PendingRequest; // Pending request for notification
+#ifdef EC_TEST_NOTIFICATIONS
+    WDFWAITLOCK  NotificationLock; // lock for notification
+    WDFTIMER CoalesceTimer; // Closes coalescing windows
+    ULONGLONG CoalesceDeadline; // Interrupt time CoalesceTimer is due, 0 if idle
+    NOTIFY_EVENT Events[NOTIFY_EVENT_COUNT]; // Indexed by Notify value
+#endif
+#if defined(EC_TEST_NOTIFICATIONS) && defined(EC_TEST_GENERATOR)
+    WDFWAITLOCK GeneratorLock; // lock for Generator
+    WDFTIMER GeneratorTimer; // Raises generator events every tick
+    GENERATOR Generator;
+#endif
+#ifdef EC_TEST_DOORBELL
+    WDFSPINLOCK RingLock; // lock for RX ring and waiters
+    WDFTIMER RingTimer; // Fallback poll in case a doorbell is missed
+    ULONG RingPollMs; // Current fallback poll interval
+    PUCHAR RingHeader; // Mapped geometry page holding the EC event record
+    ULONG EventGen; // GEN of the last event record delivered with a notification
+    PUCHAR RxRing; // Mapped RX ring of shared memory
+    SIZE_T RxRingSize; // Bytes mapped at RxRing
+    ULONG RingSlots; // Geometry read from the shared region header
+    ULONG RingEntrySize;
+    ULONG RingEntryOffset;
+    RX_WAITER RxWaiters[EC_RING_SLOT_MAX]; // Only RingSlots are used
+#endif
+#ifdef EC_TEST_PRIORITY
+    WDFWAITLOCK PriorityLock; // lock for dispatching from the priority queues
+    ULONG PriorityInflight; // Evaluations on work items across all shards and classes
+    EvalPriorityStats_t PriorityStats[EVAL_PRIORITY_COUNT];
+    EVAL_SHARD Shards[EVAL_SHARD_COUNT];
+    ULONG ShardCount; // Shards ever assigned, shard 0 is shared and idle ones are reassigned
+    ULONG ShardNext; // Shard looked at first on the next dispatch, for fairness
+#endif
+#ifdef EC_TEST_ADMISSION
+    WDFSPINLOCK AdmissionLock; // lock for admission counters, released from request cleanup
+    AdmissionRsp_t Admission; // Limits and counters
+    ADMISSION_CLIENT AdmissionClients[ADMISSION_CLIENT_COUNT]; // Entries are freed once idle
+#endif
+#ifdef EC_TEST_MUX
+    BOOLEAN MuxUnsupported; // EC rejected EC_MUX, send one command per request
+#endif
+#ifdef EC_TEST_BULK
+    WDFWAITLOCK BulkLock; // lock for the bulk buffer pool
+    WDFQUEUE BulkQueue; // Manual queue of transfers waiting for a buffer
+    PUCHAR BulkPool; // Mapped buffers, from the first buffer offset to the end of the last
+    SIZE_T BulkPoolSize; // Bytes mapped at BulkPool, 0 if the pool is not available
+    ULONG BulkCount; // Buffers in the pool
+    ULONG BulkSize; // Bytes per buffer
+    ULONG BulkFree; // Bit set for every buffer not in use
+    ULONG64 BulkHandles[EC_BULK_BUFFER_MAX]; // FF-A memory handle of each buffer
+    ULONG BulkOffsets[EC_BULK_BUFFER_MAX]; // Offset of each buffer in BulkPool
+#endif
+#ifdef EC_TEST_LOG
+    WDFSPINLOCK LogLock; // lock for log waiters
+    WDFTIMER LogTimer; // Fallback poll and timeouts while readers wait
+    PUCHAR LogHeader; // Mapped log header followed by the records, NULL if there is no log ring
+    SIZE_T LogMapSize; // Bytes mapped at LogHeader
+    ULONG LogSize; // Record bytes, a power of two
+    LOG_WAITER LogWaiters[LOG_WAITER_COUNT];
+#endif
+#ifdef EC_TEST_TIMELINE
+    PTIMELINE_SLOT Timeline; // Ring of TIMELINE_EVENT_COUNT events, NULL if it could not be allocated
+    volatile LONG64 TimelineHead; // Stream position of the next event
+    volatile LONG TimelineEnabled; // Events are only recorded while set
+    volatile LONG TimelineNext; // Last correlation ID assigned by the driver
+#endif
+} DEVICE_CONTEXT, *PDEVICE_CONTEXT;
+
+//
+// This macro will generate an inline function called DeviceContextGet
+// which will be used to get a pointer to the device context memory
+// in a type safe manner.
+//
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(DEVICE_CONTEXT, DeviceContextGet)
+
+//
+// Function to initialize the device and its callbacks
+//
+NTSTATUS ECTestDeviceCreate(PWDFDEVICE_INIT DeviceInit );
+
+EVT_WDF_OBJECT_CONTEXT_CLEANUP ECTestEvtDeviceCleanup;
+
@@ -1,23 +1,34 @@
-/*++
-Module Name:
-    driver.h
-
-Abstract:
-
-    This is a C version of a very simple driver that illustrates
-    how to use the driver framework and demonstrates best practices.
---*/
-
-#define INITGUID
-
-#include <ntddk.h>
-#include <wdf.h>
-
-#include "device.h"
-#include "queue.h"
-
-//
-// WDFDRIVER Events
-//
-DRIVER_INITIALIZE DriverEntry;
-EVT_WDF_DRIVER_DEVICE_ADD EvtDeviceAdd;
+/*++
+Module Name:
+    driver.h
+
+Abstract:
+
+    This is a C version of a very simple driver that illustrates
+    how to use the driver framework and demonstrates best practices.
+--*/
+
+#define INITGUID
+
+#include <ntddk.h>
+#include <wdf.h>
+
+#include "device.h"
+#include "queue.h"
+#include "ring.h"
+#include "notify.h"
+#include "generator.h"
+#include "bench.h"
+#include "priority.h"
+#include "admission.h"
+#include "mux.h"
+#include "bulk.h"
+#include "log.h"
+#include "namespace.h"
+#include "timeline.h"
+
+//
+// WDFDRIVER Events
+//
+DRIVER_INITIALIZE DriverEntry;
+EVT_WDF_DRIVER_DEVICE_ADD EvtDeviceAdd;
@@ -0,0 +1,325 @@
+/*++
+Module Name:
+    generator.c
+
+Abstract:
+    Synthetic notification generator. Replaces the fixed one second
+    simulation timer with runs configured through IOCTL_GENERATOR: rate,
+    on/off burst pattern, event ID distribution and duration.
+
+    Events are raised through NotificationRaise so they are counted,
+    coalesced and delivered exactly like notifications from the EC, and
+    each carries a GeneratorStamp_t so the app can measure delivery
+    latency and loss. The timer ticks at the system timer resolution and
+    raises however many events are due, so the average rate is exact and
+    events within one tick are back to back. KMDF has no periodic passive
+    level timers, so the timer is one-shot and each tick arms the next.
+
+Environment:
+    Kernel-mode only
+
+--*/
+
+#include "driver.h"
+#include "..\inc\ectest.h"
+#include "trace.h"
+#include "generator.tmh"
+
+#if defined(EC_TEST_NOTIFICATIONS) && defined(EC_TEST_GENERATOR)
+
+// Bounds the time spent in one tick if the system falls behind
+#define GENERATOR_MAX_PER_TICK  4096
+#define GENERATOR_TICK_MS       1
+
+/*
+ * Function: NTSTATUS GeneratorInitialize
+ *
+ * Description:
+ * Creates the generator lock and the tick timer. The generator stays idle until started
+ * with IOCTL_GENERATOR.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+NTSTATUS
+GeneratorInitialize(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    WDF_OBJECT_ATTRIBUTES attributes;
+    WDF_TIMER_CONFIG timerConfig;
+    NTSTATUS status;
+
+    RtlZeroMemory(&deviceContext->Generator, sizeof(deviceContext->Generator));
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = Device;
+    status = WdfWaitLockCreate(&attributes, &deviceContext->GeneratorLock);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfWaitLockCreate failed %!STATUS!\n", status);
+        return status;
+    }
+
+    // One-shot, GeneratorTimerCallback re-arms it while a run is going
+    WDF_TIMER_CONFIG_INIT(&timerConfig, GeneratorTimerCallback);
+    timerConfig.AutomaticSerialization = FALSE;
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = Device;
+    attributes.ExecutionLevel = WdfExecutionLevelPassive;
+    status = WdfTimerCreate(&timerConfig, &attributes, &deviceContext->GeneratorTimer);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfTimerCreate failed %!STATUS!\n", status);
+    }
+
+    return status;
+}
+
+/*
+ * Function: ULONG GeneratorRandom
+ *
+ * Description:
+ * xorshift32, good enough to spread event IDs and cheap enough to call per event.
+ *
+ * Parameters:
+ * Generator - Generator holding the state.
+ *
+ * Return Value:
+ * Next pseudo random value.
+ */
+static ULONG
+GeneratorRandom(
+    PGENERATOR Generator
+    )
+{
+    ULONG x = Generator->Random;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    Generator->Random = x;
+    return x;
+}
+
+/*
+ * Function: ULONG GeneratorPick
+ *
+ * Description:
+ * Picks the Notify value of the next event according to the configured distribution.
+ *
+ * Parameters:
+ * Generator - Generator holding the configuration.
+ *
+ * Return Value:
+ * Notify value to raise.
+ */
+static ULONG
+GeneratorPick(
+    PGENERATOR Generator
+    )
+{
+    ULONG first = Generator->Config.firstevent;
+    ULONG span = (ULONG)Generator->Config.lastevent - first + 1;
+    ULONG value;
+
+    switch (Generator->Config.distribution) {
+    case GENERATOR_DIST_UNIFORM:
+        return first + GeneratorRandom(Generator) % span;
+
+    case GENERATOR_DIST_HOT:
+        if (GeneratorRandom(Generator) & 1) {
+            return first;
+        }
+        return first + GeneratorRandom(Generator) % span;
+
+    default:
+        value = first + Generator->Next;
+        Generator->Next = (Generator->Next + 1) % span;
+        return value;
+    }
+}
+
+/*
+ * Function: ULONG64 GeneratorDue
+ *
+ * Description:
+ * Number of events that should have been raised after Elapsed, only counting time spent in the
+ * on part of each burst cycle.
+ *
+ * Parameters:
+ * Config - Run configuration.
+ * Elapsed - Run time in 100ns units.
+ *
+ * Return Value:
+ * Events due.
+ */
+static ULONG64
+GeneratorDue(
+    GeneratorReq_t *Config,
+    ULONGLONG Elapsed
+    )
+{
+    ULONGLONG on = (ULONGLONG)Config->burston * 10000;
+    ULONGLONG off = (ULONGLONG)Config->burstoff * 10000;
+    ULONGLONG active = Elapsed;
+
+    if (on != 0) {
+        active = (Elapsed / (on + off)) * on + min(Elapsed % (on + off), on);
+    }
+
+    return active * Config->rate / 10000000;
+}
+
+/*
+ * Function: VOID GeneratorTimerCallback
+ *
+ * Description:
+ * Raises every event that is due since the last tick and arms the timer for the next one,
+ * until the run is stopped or the duration has passed.
+ *
+ * Parameters:
+ * Timer - The Timer object.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+GeneratorTimerCallback(
+    WDFTIMER Timer
+    )
+{
+    WDFDEVICE device = WdfTimerGetParentObject(Timer);
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(device);
+    PGENERATOR generator = &deviceContext->Generator;
+    GeneratorStamp_t stamp;
+    LARGE_INTEGER now;
+    ULONGLONG elapsed, end;
+    ULONG64 due;
+    ULONG raised = 0;
+    BOOLEAN finished = FALSE;
+
+    // Timer is only re-armed under the lock so a run started meanwhile keeps its timer
+    WdfWaitLockAcquire(deviceContext->GeneratorLock, NULL);
+    if (!generator->Running) {
+        WdfWaitLockRelease(deviceContext->GeneratorLock);
+        return;
+    }
+
+    elapsed = KeQueryInterruptTime() - generator->Start;
+    end = (ULONGLONG)generator->Config.duration * 10000;
+    if (end != 0 && elapsed >= end) {
+        elapsed = end;
+        finished = TRUE;
+    }
+    generator->Elapsed = elapsed;
+
+    due = GeneratorDue(&generator->Config, elapsed);
+    while (generator->Generated < due && raised < GENERATOR_MAX_PER_TICK) {
+        KeQuerySystemTimePrecise(&now);
+        stamp.run = generator->Run;
+        stamp.reserved = 0;
+        stamp.sequence = generator->Generated++;
+        stamp.generated = now.QuadPart;
+        NotificationRaise(device, GeneratorPick(generator), &stamp);
+        raised++;
+    }
+
+    if (raised == GENERATOR_MAX_PER_TICK) {
+        Trace(TRACE_LEVEL_WARNING, TRACE_QUEUE,"Generator run %u behind by %llu events\n", generator->Run, due - generator->Generated);
+    }
+
+    if (finished) {
+        generator->Running = FALSE;
+        Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Generator run %u done, %llu events\n", generator->Run, generator->Generated);
+    } else {
+        WdfTimerStart(Timer, WDF_REL_TIMEOUT_IN_MS(GENERATOR_TICK_MS));
+    }
+    WdfWaitLockRelease(deviceContext->GeneratorLock);
+}
+
+/*
+ * Function: NTSTATUS GeneratorControl
+ *
+ * Description:
+ * Handles IOCTL_GENERATOR. Starts a new run if rate is not 0, stops the current run if it is 0
+ * and leaves it alone for GENERATOR_RATE_QUERY. Returns the state of the current or last run.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object holding a GeneratorReq_t.
+ * BytesReturned - Receives the number of output bytes written.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+NTSTATUS
+GeneratorControl(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    size_t *BytesReturned
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    PGENERATOR generator = &deviceContext->Generator;
+    GeneratorReq_t *req = NULL;
+    GeneratorRsp_t *rsp = NULL;
+    LARGE_INTEGER now;
+    BOOLEAN start;
+    NTSTATUS status;
+
+    status = WdfRequestRetrieveInputBuffer(Request, sizeof(GeneratorReq_t), &req, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    status = WdfRequestRetrieveOutputBuffer(Request, sizeof(GeneratorRsp_t), &rsp, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    start = req->rate != 0 && req->rate != GENERATOR_RATE_QUERY;
+    if (start && (req->rate > GENERATOR_MAX_RATE ||
+                  req->firstevent > req->lastevent ||
+                  req->distribution > GENERATOR_DIST_HOT ||
+                  (req->burstoff != 0 && req->burston == 0))) {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    WdfWaitLockAcquire(deviceContext->GeneratorLock, NULL);
+    if (start) {
+        KeQuerySystemTimePrecise(&now);
+        generator->Config = *req;
+        generator->Running = TRUE;
+        generator->Run++;
+        generator->Generated = 0;
+        generator->Next = 0;
+        generator->Random = req->seed != 0 ? req->seed : (ULONG)now.QuadPart | 1;
+        generator->Start = KeQueryInterruptTime();
+        generator->StartSystem = now.QuadPart;
+        generator->Elapsed = 0;
+        Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Generator run %u at %u/s for %u ms\n", generator->Run, req->rate, req->duration);
+    } else if (req->rate == 0 && generator->Running) {
+        generator->Running = FALSE;
+        generator->Elapsed = KeQueryInterruptTime() - generator->Start;
+        Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Generator run %u stopped, %llu events\n", generator->Run, generator->Generated);
+    }
+
+    rsp->running = generator->Running;
+    rsp->run = generator->Run;
+    rsp->generated = generator->Generated;
+    rsp->start = generator->StartSystem;
+    rsp->elapsed = generator->Running ? KeQueryInterruptTime() - generator->Start : generator->Elapsed;
+    WdfWaitLockRelease(deviceContext->GeneratorLock);
+
+    if (start) {
+        WdfTimerStart(deviceContext->GeneratorTimer, WDF_REL_TIMEOUT_IN_MS(GENERATOR_TICK_MS));
+    }
+
+    *BytesReturned = sizeof(GeneratorRsp_t);
+    return STATUS_SUCCESS;
+}
+
+#endif // EC_TEST_NOTIFICATIONS && EC_TEST_GENERATOR
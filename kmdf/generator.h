@@ -0,0 +1,26 @@
+/*++
+Module Name:
+    generator.h
+
+Abstract:
+    Synthetic notification generator used to load test notification
+    delivery without the EC.
+--*/
+
+#if defined(EC_TEST_NOTIFICATIONS) && defined(EC_TEST_GENERATOR)
+
+NTSTATUS
+GeneratorInitialize(
+    WDFDEVICE Device
+    );
+
+NTSTATUS
+GeneratorControl(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    size_t *BytesReturned
+    );
+
+EVT_WDF_TIMER GeneratorTimerCallback;
+
+#endif // EC_TEST_NOTIFICATIONS && EC_TEST_GENERATOR
@@ -0,0 +1,507 @@
+/*++
+Module Name:
+    log.c
+
+Abstract:
+    Handles IOCTL_LOG_READ. The EC appends console and diagnostic records
+    to a log stream ring in shared memory that UEFI publishes in the
+    geometry page. Every reader passes its own cursor and gets the whole
+    records from there on copied straight out of the ring, so the driver
+    keeps no copy of the log and its memory use does not grow with the
+    number of readers or how far behind they are. A reader with nothing
+    to read waits for the log doorbell, which the EC only rings after the
+    driver armed it, with a fallback poll in case one is lost.
+
+Environment:
+    Kernel-mode only
+
+--*/
+
+#include "driver.h"
+#include "..\inc\ectest.h"
+#include "trace.h"
+#include "log.tmh"
+
+#ifdef EC_TEST_LOG
+
+// Fallback poll and timeout granularity while readers wait
+#define LOG_POLL_MS             20
+
+#define LOG_HEADER_WORD(Context, Offset) \
+    ((PULONG64)((Context)->LogHeader + (Offset)))
+
+/*
+ * Function: NTSTATUS LogInitialize
+ *
+ * Description:
+ * Creates the waiter lock and fallback timer and maps the log ring UEFI publishes in the
+ * geometry page.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * NTSTATUS status code, on failure IOCTL_LOG_READ is not supported.
+ */
+NTSTATUS
+LogInitialize(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    WDF_OBJECT_ATTRIBUTES attributes;
+    WDF_TIMER_CONFIG timerConfig;
+    PHYSICAL_ADDRESS physicalAddress;
+    PUCHAR header;
+    ULONG magic, offset, size;
+    NTSTATUS status;
+
+    deviceContext->LogHeader = NULL;
+    deviceContext->LogMapSize = 0;
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = Device;
+    status = WdfSpinLockCreate(&attributes, &deviceContext->LogLock);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfSpinLockCreate failed %!STATUS!\n", status);
+        return status;
+    }
+
+    WDF_TIMER_CONFIG_INIT(&timerConfig, LogTimerCallback);
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = Device;
+    status = WdfTimerCreate(&timerConfig, &attributes, &deviceContext->LogTimer);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfTimerCreate failed %!STATUS!\n", status);
+        return status;
+    }
+
+    physicalAddress.QuadPart = SBSAQEMU_SHARED_MEM_BASE;
+    header = MmMapIoSpaceEx(physicalAddress, EC_RING_PAGE_SIZE, PAGE_READONLY | PAGE_NOCACHE);
+    if (header == NULL) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Failed to map ring geometry page\n");
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    magic = READ_REGISTER_ULONG((PULONG)(header + EC_LOG_GEO_MAGIC_OFFSET));
+    offset = READ_REGISTER_ULONG((PULONG)(header + EC_LOG_GEO_OFFSET_OFFSET));
+    size = READ_REGISTER_ULONG((PULONG)(header + EC_LOG_GEO_SIZE_OFFSET));
+    MmUnmapIoSpace(header, EC_RING_PAGE_SIZE);
+
+    if (magic != EC_LOG_GEO_MAGIC) {
+        Trace(TRACE_LEVEL_WARNING, TRACE_QUEUE,"No log ring published\n");
+        return STATUS_NOT_FOUND;
+    }
+
+    if (size < EC_LOG_SIZE_MIN || size > EC_LOG_SIZE_MAX || (size & (size - 1)) != 0 ||
+        offset < EC_RING_PAGE_SIZE || (offset % EC_RING_PAGE_SIZE) != 0) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Invalid log ring offset 0x%x size 0x%x\n", offset, size);
+        return STATUS_DEVICE_CONFIGURATION_ERROR;
+    }
+
+    physicalAddress.QuadPart = SBSAQEMU_SHARED_MEM_BASE + offset;
+    deviceContext->LogHeader = MmMapIoSpaceEx(physicalAddress, EC_LOG_DATA_OFFSET + size, PAGE_READWRITE | PAGE_NOCACHE);
+    if (deviceContext->LogHeader == NULL) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Failed to map log ring\n");
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+    deviceContext->LogMapSize = EC_LOG_DATA_OFFSET + size;
+    deviceContext->LogSize = size;
+
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Log ring at 0x%x size 0x%x\n", offset, size);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: VOID LogUninitialize
+ *
+ * Description:
+ * Unmaps the log ring, waiting readers have already been cancelled when the queue was purged.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+LogUninitialize(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+
+    if (deviceContext->LogHeader != NULL) {
+        MmUnmapIoSpace(deviceContext->LogHeader, deviceContext->LogMapSize);
+        deviceContext->LogHeader = NULL;
+        deviceContext->LogMapSize = 0;
+    }
+}
+
+/*
+ * Function: VOID LogComplete
+ *
+ * Description:
+ * Copies the whole records from the cursor on into the output buffer of a read and completes it.
+ * If the EC overwrites records while they are copied they are dropped and counted as lost, and
+ * the copy starts again at the new tail. The request must not be cancelable.
+ *
+ * Parameters:
+ * DeviceContext - Device context holding the mapped log ring.
+ * Request - Read to complete, the output buffer was checked by LogRead.
+ * Cursor - Stream position to read from.
+ *
+ * Return Value:
+ * VOID
+ */
+static VOID
+LogComplete(
+    PDEVICE_CONTEXT DeviceContext,
+    WDFREQUEST Request,
+    ULONG64 Cursor
+    )
+{
+    PUCHAR data = DeviceContext->LogHeader + EC_LOG_DATA_OFFSET;
+    LogReadRsp_t *rsp = NULL;
+    size_t rspSize = 0;
+    LARGE_INTEGER frequency;
+    ULONG64 head, tail, position, word;
+    ULONG64 lost = 0;
+    ULONG maxData, offset, size, flags, written, records, i;
+    BOOLEAN malformed, done = FALSE;
+    NTSTATUS status;
+
+    status = WdfRequestRetrieveOutputBuffer(Request, LOG_READ_RSP_HEADER_SIZE, &rsp, &rspSize);
+    if (!NT_SUCCESS(status)) {
+        WdfRequestComplete(Request, status);
+        return;
+    }
+    maxData = (ULONG)min(rspSize - LOG_READ_RSP_HEADER_SIZE, LOG_READ_MAX_LENGTH);
+
+    position = Cursor;
+    written = 0;
+    records = 0;
+    for (i = 0; i < EC_EVENT_READ_RETRIES && !done; i++) {
+        head = READ_REGISTER_ULONG64(LOG_HEADER_WORD(DeviceContext, EC_LOG_HEAD_OFFSET));
+        tail = READ_REGISTER_ULONG64(LOG_HEADER_WORD(DeviceContext, EC_LOG_TAIL_OFFSET));
+        if (Cursor < tail || Cursor > head) {
+            // Fell behind, or the EC restarted its stream
+            lost += (Cursor < tail) ? tail - Cursor : 0;
+            Cursor = tail;
+        }
+
+        position = Cursor;
+        written = 0;
+        records = 0;
+        malformed = FALSE;
+        while (position < head) {
+            offset = (ULONG)(position & (DeviceContext->LogSize - 1));
+            word = READ_REGISTER_ULONG64((PULONG64)(data + offset));
+            size = (ULONG)(word & 0xFFFF);
+            flags = (ULONG)((word >> (EC_LOG_RECORD_FLAGS_OFFSET * 8)) & 0xFF);
+            if (size < EC_LOG_RECORD_ALIGN || (size % EC_LOG_RECORD_ALIGN) != 0 ||
+                offset + size > DeviceContext->LogSize ||
+                ((flags & EC_LOG_FLAG_PAD) == 0 && size < EC_LOG_RECORD_HEADER_SIZE)) {
+                malformed = TRUE;
+                break;
+            }
+
+            if ((flags & EC_LOG_FLAG_PAD) == 0) {
+                if (written + size > maxData) {
+                    break;
+                }
+                // Ring may be mapped as device memory so only use aligned 64-bit accesses
+                READ_REGISTER_BUFFER_ULONG64((PULONG64)(data + offset), (PULONG64)(rsp->data + written), size / sizeof(ULONG64));
+                written += size;
+                records++;
+            }
+            position += size;
+        }
+
+        KeMemoryBarrier();
+        tail = READ_REGISTER_ULONG64(LOG_HEADER_WORD(DeviceContext, EC_LOG_TAIL_OFFSET));
+        if (tail <= Cursor) {
+            // A malformed record that was not overwritten cannot be resynchronized to
+            if (malformed && records == 0) {
+                Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Malformed log record at 0x%llx, skipping to 0x%llx\n", position, head);
+                lost += head - position;
+                position = head;
+            }
+            done = TRUE;
+        } else {
+            lost += tail - Cursor;
+            Cursor = tail;
+        }
+    }
+
+    if (!done) {
+        // The EC kept lapping the copy, hand back nothing and the newest tail
+        position = Cursor;
+        written = 0;
+        records = 0;
+    }
+
+    rsp->cursor = position;
+    rsp->lost = lost;
+    rsp->frequency = READ_REGISTER_ULONG64(LOG_HEADER_WORD(DeviceContext, EC_LOG_FREQUENCY_OFFSET));
+    rsp->hosttime = KeQueryPerformanceCounter(&frequency).QuadPart;
+#if defined(_M_ARM64)
+    // EC timestamps are the generic counter, read it next to the host counter to line them up
+    rsp->ectime = _ReadStatusReg(ARM64_CNTVCT);
+#else
+    rsp->ectime = 0;
+#endif
+    rsp->hostfrequency = frequency.QuadPart;
+    rsp->records = records;
+    rsp->length = written;
+
+    if (lost != 0) {
+        Trace(TRACE_LEVEL_WARNING, TRACE_QUEUE,"Log reader lost 0x%llx bytes\n", lost);
+    }
+    WdfRequestCompleteWithInformation(Request, STATUS_SUCCESS, LOG_READ_RSP_HEADER_SIZE + written);
+}
+
+/*
+ * Function: BOOLEAN LogCompleteWaiters
+ *
+ * Description:
+ * Completes every waiter the EC has logged past or whose deadline has passed, and arms the
+ * doorbell again for those still waiting.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * TRUE if there are still waiters pending.
+ */
+static BOOLEAN
+LogCompleteWaiters(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    WDFREQUEST done[LOG_WAITER_COUNT];
+    ULONG64 doneCursor[LOG_WAITER_COUNT];
+    ULONG doneCount, i;
+    ULONG64 head;
+    ULONGLONG now;
+    BOOLEAN pending, again;
+
+    do {
+        doneCount = 0;
+        pending = FALSE;
+        again = FALSE;
+        now = KeQueryInterruptTime();
+        head = READ_REGISTER_ULONG64(LOG_HEADER_WORD(deviceContext, EC_LOG_HEAD_OFFSET));
+
+        WdfSpinLockAcquire(deviceContext->LogLock);
+        for (i = 0; i < LOG_WAITER_COUNT; i++) {
+            PLOG_WAITER waiter = &deviceContext->LogWaiters[i];
+
+            if (waiter->Request == NULL) {
+                continue;
+            }
+
+            if (waiter->Cursor == head && (waiter->Deadline == 0 || now < waiter->Deadline)) {
+                pending = TRUE;
+                continue;
+            }
+
+            done[doneCount] = waiter->Request;
+            doneCursor[doneCount] = waiter->Cursor;
+            doneCount++;
+            waiter->Request = NULL;
+        }
+
+        if (pending) {
+            // A record logged before the doorbell was armed rings nothing, so look again
+            WRITE_REGISTER_ULONG((PULONG)(deviceContext->LogHeader + EC_LOG_ARMED_OFFSET), 1);
+            KeMemoryBarrier();
+            again = READ_REGISTER_ULONG64(LOG_HEADER_WORD(deviceContext, EC_LOG_HEAD_OFFSET)) != head;
+        }
+        WdfSpinLockRelease(deviceContext->LogLock);
+
+        // Copy and complete outside the lock, if the request is being cancelled the cancel routine completes it
+        for (i = 0; i < doneCount; i++) {
+            if (STATUS_CANCELLED != WdfRequestUnmarkCancelable(done[i])) {
+                LogComplete(deviceContext, done[i], doneCursor[i]);
+            }
+        }
+    } while (again);
+
+    return pending;
+}
+
+/*
+ * Function: VOID LogDoorbell
+ *
+ * Description:
+ * Called from the notification callback when the EC rings the log doorbell.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+LogDoorbell(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+
+    if (deviceContext->LogHeader != NULL) {
+        LogCompleteWaiters(Device);
+    }
+}
+
+/*
+ * Function: VOID LogTimerCallback
+ *
+ * Description:
+ * Fallback poll of the log ring while readers wait, also times them out.
+ *
+ * Parameters:
+ * Timer - The Timer object.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+LogTimerCallback(
+    WDFTIMER Timer
+    )
+{
+    WDFDEVICE device = WdfTimerGetParentObject(Timer);
+
+    if (LogCompleteWaiters(device)) {
+        WdfTimerStart(Timer, WDF_REL_TIMEOUT_IN_MS(LOG_POLL_MS));
+    }
+}
+
+/*
+ * Function: VOID LogEvtRequestCancel
+ *
+ * Description:
+ * Removes a cancelled read from the waiter list and completes it.
+ *
+ * Parameters:
+ * Request - The WDFREQUEST object representing the request.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+LogEvtRequestCancel(
+    WDFREQUEST Request
+    )
+{
+    WDFDEVICE device = WdfIoQueueGetDevice(WdfRequestGetIoQueue(Request));
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(device);
+
+    WdfSpinLockAcquire(deviceContext->LogLock);
+    for (ULONG i = 0; i < LOG_WAITER_COUNT; i++) {
+        if (deviceContext->LogWaiters[i].Request == Request) {
+            deviceContext->LogWaiters[i].Request = NULL;
+            break;
+        }
+    }
+    WdfSpinLockRelease(deviceContext->LogLock);
+
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Completing log reader 0x%llx with STATUS_CANCELLED\n", (UINT64)Request);
+    WdfRequestComplete(Request, STATUS_CANCELLED);
+}
+
+/*
+ * Function: NTSTATUS LogRead
+ *
+ * Description:
+ * Handles IOCTL_LOG_READ. Completes right away if the EC has logged past the cursor, otherwise
+ * pends the read until the doorbell, the fallback poll or the timeout.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object holding a LogReadReq_t, the output buffer receives a
+ *           LogReadRsp_t and must hold at least one record of the longest text.
+ *
+ * Return Value:
+ * STATUS_PENDING if the driver owns the request, otherwise an error to complete it with.
+ */
+NTSTATUS
+LogRead(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    LogReadReq_t *req = NULL;
+    PVOID rsp = NULL;
+    LOG_WAITER waiter = {0};
+    ULONG64 head;
+    ULONG flags;
+    NTSTATUS status;
+
+    if (deviceContext->LogHeader == NULL) {
+        return STATUS_DEVICE_NOT_READY;
+    }
+
+    status = WdfRequestRetrieveInputBuffer(Request, sizeof(LogReadReq_t), &req, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    status = WdfRequestRetrieveOutputBuffer(Request, LOG_READ_RSP_HEADER_SIZE + EC_LOG_RECORD_HEADER_SIZE + EC_LOG_TEXT_MAX, &rsp, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    // Input and output share the system buffer, take the request before the response is written
+    head = READ_REGISTER_ULONG64(LOG_HEADER_WORD(deviceContext, EC_LOG_HEAD_OFFSET));
+    flags = req->flags;
+    waiter.Request = Request;
+    waiter.Cursor = (flags & LOG_READ_NEWEST) ? head : req->cursor;
+    if (req->timeout != 0) {
+        waiter.Deadline = KeQueryInterruptTime() + (ULONGLONG)req->timeout * 10000;
+    }
+
+    if (waiter.Cursor != head || (flags & LOG_READ_NOWAIT)) {
+        LogComplete(deviceContext, Request, waiter.Cursor);
+        return STATUS_PENDING;
+    }
+
+    WdfSpinLockAcquire(deviceContext->LogLock);
+    WRITE_REGISTER_ULONG((PULONG)(deviceContext->LogHeader + EC_LOG_ARMED_OFFSET), 1);
+    KeMemoryBarrier();
+    if (READ_REGISTER_ULONG64(LOG_HEADER_WORD(deviceContext, EC_LOG_HEAD_OFFSET)) != head) {
+        // Logged before the doorbell was armed
+        WdfSpinLockRelease(deviceContext->LogLock);
+        LogComplete(deviceContext, Request, waiter.Cursor);
+        return STATUS_PENDING;
+    }
+
+    for (ULONG i = 0; i < LOG_WAITER_COUNT; i++) {
+        if (deviceContext->LogWaiters[i].Request != NULL) {
+            continue;
+        }
+
+        // Mark cancelable under the lock so the cancel routine always finds the waiter
+        status = WdfRequestMarkCancelableEx(Request, LogEvtRequestCancel);
+        if (NT_SUCCESS(status)) {
+            deviceContext->LogWaiters[i] = waiter;
+        }
+        WdfSpinLockRelease(deviceContext->LogLock);
+
+        if (NT_SUCCESS(status)) {
+            Trace(TRACE_LEVEL_VERBOSE, TRACE_QUEUE,"Log reader 0x%llx pended at 0x%llx\n", (UINT64)Request, waiter.Cursor);
+            WdfTimerStart(deviceContext->LogTimer, WDF_REL_TIMEOUT_IN_MS(LOG_POLL_MS));
+            status = STATUS_PENDING;
+        }
+        return status;
+    }
+    WdfSpinLockRelease(deviceContext->LogLock);
+
+    return STATUS_DEVICE_BUSY;
+}
+
+#endif // EC_TEST_LOG
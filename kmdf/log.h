@@ -0,0 +1,35 @@
+/*++
+Module Name:
+    log.h
+
+Abstract:
+    Readers of the EC log stream ring in shared memory.
+--*/
+
+#ifdef EC_TEST_LOG
+
+NTSTATUS
+LogInitialize(
+    WDFDEVICE Device
+    );
+
+VOID
+LogUninitialize(
+    WDFDEVICE Device
+    );
+
+NTSTATUS
+LogRead(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    );
+
+VOID
+LogDoorbell(
+    WDFDEVICE Device
+    );
+
+EVT_WDF_TIMER LogTimerCallback;
+EVT_WDF_REQUEST_CANCEL LogEvtRequestCancel;
+
+#endif // EC_TEST_LOG
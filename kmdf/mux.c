@@ -0,0 +1,330 @@
+/*++
+Module Name:
+    mux.c
+
+Abstract:
+    Handles IOCTL_FFA_MUX. Commands in the list that go to the same
+    service UUID are packed into EC_MUX direct requests, as many as fit
+    in x4-x17 for both the request and the response, so a telemetry tick
+    of several reads costs one world switch per service instead of one
+    per read. The response of each EC_MUX request is split back into the
+    commands it carried. A command that is alone for its service, or any
+    command once the EC has rejected EC_MUX, is sent on its own.
+
+Environment:
+    Kernel-mode only
+
+--*/
+
+#include "driver.h"
+#include "..\inc\ectest.h"
+#include "..\inc\ecsvc.h"
+#include "trace.h"
+#include "mux.tmh"
+#include "ffainterface.h"
+
+#ifdef EC_TEST_MUX
+
+/*
+ * Function: NTSTATUS MuxStart
+ *
+ * Description:
+ * Validates an FfaMuxReq_t and queues a work item to send it, FF-A calls block until the EC
+ * responds.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object holding an FfaMuxReq_t, the output buffer has the same size.
+ *
+ * Return Value:
+ * NTSTATUS status code, on success the request is completed by the work item.
+ */
+NTSTATUS
+MuxStart(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    )
+{
+    NTSTATUS status;
+    WDF_OBJECT_ATTRIBUTES attributes;
+    WDF_WORKITEM_CONFIG workitemConfig;
+    WDFWORKITEM workItem;
+    PWORKITEM_CONTEXT context;
+    FfaMuxReq_t *req = NULL;
+    FfaMuxReq_t *rsp = NULL;
+    FfaMuxCommand_t *cmd;
+    size_t reqSize = 0;
+    size_t rspSize = 0;
+    ULONG i;
+
+    status = WdfRequestRetrieveInputBuffer(Request, FFA_MUX_REQ_HEADER_SIZE, &req, &reqSize);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    status = WdfRequestRetrieveOutputBuffer(Request, FFA_MUX_REQ_HEADER_SIZE, &rsp, &rspSize);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    if (req->count == 0 ||
+        req->count > FFA_MUX_MAX_COMMANDS ||
+        reqSize < FFA_MUX_REQ_HEADER_SIZE + req->count * sizeof(FfaMuxCommand_t) ||
+        rspSize < FFA_MUX_REQ_HEADER_SIZE + req->count * sizeof(FfaMuxCommand_t)) {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    for (i = 0; i < req->count; i++) {
+        cmd = &req->command[i];
+        if (cmd->inlen == 0 ||
+            cmd->inlen > FFA_MUX_DATA_SIZE ||
+            cmd->outlen > FFA_MUX_DATA_SIZE ||
+            (ULONG)cmd->outoff + cmd->outlen > EC_FFA_PAYLOAD_SIZE) {
+            return STATUS_INVALID_PARAMETER;
+        }
+    }
+
+    WDF_WORKITEM_CONFIG_INIT(&workitemConfig, MuxWorkItemCallback);
+
+    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&attributes, WORKITEM_CONTEXT);
+    attributes.ParentObject = Device;
+
+    status = WdfWorkItemCreate(&workitemConfig, &attributes, &workItem);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfWorkItemCreate failed: %!STATUS!\n", status);
+        return status;
+    }
+
+    context = WorkItemGetContext(workItem);
+    context->Device = Device;
+    context->Request = Request;
+
+    WdfWorkItemEnqueue(workItem);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: VOID MuxSendSingle
+ *
+ * Description:
+ * Sends one command in its own direct request and copies its output window back.
+ *
+ * Parameters:
+ * FfaInterface - Kernel FF-A interface.
+ * Command - Command to send, receives status and output.
+ *
+ * Return Value:
+ * VOID
+ */
+static VOID
+MuxSendSingle(
+    PFFA_INTERFACE FfaInterface,
+    FfaMuxCommand_t *Command
+    )
+{
+    FFA_MSG_SEND_DIRECT_REQ2_PARAMETERS ffaParameters;
+    NTSTATUS status;
+
+    RtlZeroMemory(&ffaParameters, sizeof(ffaParameters));
+    ffaParameters.Version = FFA_MSG_SEND_DIRECT_REQ2_PARAMETERS_VERSION_V1;
+    ffaParameters.AsyncParameters.Flags.FrameworkYieldHandling = ENABLE_FFA_YIELD;
+    ffaParameters.ServiceUuid = Command->uuid;
+    RtlCopyMemory(ffaParameters.InputBuffer.Buffer, Command->data, Command->inlen);
+
+    status = FfaInterface->SendDirectReq2(&ffaParameters);
+    if (!NT_SUCCESS(status)) {
+        Command->status = (UINT32)status;
+        return;
+    }
+
+    Command->status = 0;
+    RtlCopyMemory(Command->data, ffaParameters.OutputBuffer.Buffer + Command->outoff, Command->outlen);
+}
+
+/*
+ * Function: NTSTATUS MuxSendFrame
+ *
+ * Description:
+ * Packs the given commands, all for the same service, into one EC_MUX direct request and
+ * splits the response back into them.
+ *
+ * Parameters:
+ * FfaInterface - Kernel FF-A interface.
+ * Commands - Command list of the request.
+ * Members - Indexes in Commands to send, in order.
+ * Count - Entries in Members.
+ * Rejected - Set to TRUE if the EC answered with something other than EC_MUX.
+ *
+ * Return Value:
+ * STATUS_SUCCESS if the EC handled the EC_MUX request, the commands hold their own status.
+ * Otherwise the commands are left unsent, if the EC did not reject EC_MUX it may still have
+ * run them.
+ */
+static NTSTATUS
+MuxSendFrame(
+    PFFA_INTERFACE FfaInterface,
+    FfaMuxCommand_t *Commands,
+    ULONG *Members,
+    ULONG Count,
+    BOOLEAN *Rejected
+    )
+{
+    FFA_MSG_SEND_DIRECT_REQ2_PARAMETERS ffaParameters;
+    PUCHAR in = ffaParameters.InputBuffer.Buffer;
+    PUCHAR out = ffaParameters.OutputBuffer.Buffer;
+    FfaMuxCommand_t *cmd;
+    ULONG offset = EC_MUX_DATA;
+    ULONG i;
+    NTSTATUS status;
+
+    *Rejected = FALSE;
+    RtlZeroMemory(&ffaParameters, sizeof(ffaParameters));
+    ffaParameters.Version = FFA_MSG_SEND_DIRECT_REQ2_PARAMETERS_VERSION_V1;
+    ffaParameters.AsyncParameters.Flags.FrameworkYieldHandling = ENABLE_FFA_YIELD;
+    ffaParameters.ServiceUuid = Commands[Members[0]].uuid;
+
+    in[EC_PAYLOAD_CMD] = EC_MUX;
+    in[EC_MUX_COUNT] = (UCHAR)Count;
+    for (i = 0; i < Count; i++) {
+        cmd = &Commands[Members[i]];
+        in[offset++] = cmd->inlen;
+        in[offset++] = cmd->outoff;
+        in[offset++] = cmd->outlen;
+        RtlCopyMemory(in + offset, cmd->data, cmd->inlen);
+        offset += cmd->inlen;
+    }
+
+    status = FfaInterface->SendDirectReq2(&ffaParameters);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"EC_MUX of %u commands failed %!STATUS!\n", Count, status);
+        return status;
+    }
+
+    // Older firmware answers an unknown command with its own response, nothing was run
+    if (out[EC_PAYLOAD_CMD] != EC_MUX) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"EC_MUX of %u commands rejected, response 0x%x\n", Count, out[EC_PAYLOAD_CMD]);
+        *Rejected = TRUE;
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    if (out[EC_MUX_COUNT] != Count) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"EC_MUX of %u commands answered %u\n", Count, out[EC_MUX_COUNT]);
+        return STATUS_DEVICE_PROTOCOL_ERROR;
+    }
+
+    offset = EC_MUX_DATA;
+    for (i = 0; i < Count; i++) {
+        cmd = &Commands[Members[i]];
+        cmd->status = out[offset++];
+        RtlCopyMemory(cmd->data, out + offset, cmd->outlen);
+        offset += cmd->outlen;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: VOID MuxWorkItemCallback
+ *
+ * Description:
+ * Sends every command of an IOCTL_FFA_MUX request. Starting from the first unsent command,
+ * later unsent commands for the same service join its EC_MUX request until one of them does not
+ * fit in the request or response payload, so commands of one service keep their order. A frame
+ * that failed in transport is not sent again, the EC may already have run it.
+ *
+ * Parameters:
+ * WorkItem - Work item created by MuxStart.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+MuxWorkItemCallback(
+    _In_ WDFWORKITEM WorkItem
+    )
+{
+    PWORKITEM_CONTEXT context = WorkItemGetContext(WorkItem);
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(context->Device);
+    WDFREQUEST request = context->Request;
+    PFFA_INTERFACE ffaInterface;
+    FfaMuxReq_t *req = NULL;
+    FfaMuxCommand_t *cmd;
+    ULONG members[FFA_MUX_MAX_COMMANDS];
+    ULONG count, memberCount, reqBytes, rspBytes, i, j;
+    BOOLEAN rejected;
+    NTSTATUS status, frameStatus;
+
+    status = WdfRequestRetrieveOutputBuffer(request, FFA_MUX_REQ_HEADER_SIZE, &req, NULL);
+    if (!NT_SUCCESS(status)) {
+        goto Cleanup;
+    }
+
+    ffaInterface = FfaGetInterface();
+    if (ffaInterface == NULL) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Mux has no FF-A interface\n");
+        status = STATUS_NOT_SUPPORTED;
+        goto Cleanup;
+    }
+
+    // Input and output share the system buffer, commands are answered in place
+    count = req->count;
+    req->calls = 0;
+    for (i = 0; i < count; i++) {
+        req->command[i].status = FFA_MUX_STATUS_NOT_SENT;
+    }
+
+    for (i = 0; i < count; i++) {
+        cmd = &req->command[i];
+        if (cmd->status != FFA_MUX_STATUS_NOT_SENT) {
+            continue;
+        }
+
+        members[0] = i;
+        memberCount = 1;
+        reqBytes = EC_MUX_DATA + EC_MUX_HEADER_SIZE + cmd->inlen;
+        rspBytes = EC_MUX_DATA + 1 + cmd->outlen;
+        for (j = i + 1; j < count && !deviceContext->MuxUnsupported; j++) {
+            FfaMuxCommand_t *next = &req->command[j];
+            if (next->status != FFA_MUX_STATUS_NOT_SENT || !IsEqualGUID(&next->uuid, &cmd->uuid)) {
+                continue;
+            }
+            // Packing a later command of the service would send it ahead of this one
+            if (reqBytes + EC_MUX_HEADER_SIZE + next->inlen > EC_FFA_PAYLOAD_SIZE ||
+                rspBytes + 1 + next->outlen > EC_FFA_PAYLOAD_SIZE) {
+                break;
+            }
+            reqBytes += EC_MUX_HEADER_SIZE + next->inlen;
+            rspBytes += 1 + next->outlen;
+            members[memberCount++] = j;
+        }
+
+        if (memberCount > 1) {
+            req->calls++;
+            frameStatus = MuxSendFrame(ffaInterface, req->command, members, memberCount, &rejected);
+            if (NT_SUCCESS(frameStatus)) {
+                continue;
+            }
+            if (!rejected) {
+                for (j = 0; j < memberCount; j++) {
+                    req->command[members[j]].status = (UINT32)frameStatus;
+                }
+                continue;
+            }
+            // Older EC firmware, stop packing for the life of the device
+            deviceContext->MuxUnsupported = TRUE;
+        }
+
+        for (j = 0; j < memberCount; j++) {
+            req->calls++;
+            MuxSendSingle(ffaInterface, &req->command[members[j]]);
+        }
+    }
+
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Mux sent %u commands in %u direct requests\n", count, req->calls);
+    WdfRequestSetInformation(request, FFA_MUX_REQ_HEADER_SIZE + count * sizeof(FfaMuxCommand_t));
+
+Cleanup:
+    WdfRequestComplete(request, status);
+}
+
+#endif // EC_TEST_MUX
@@ -0,0 +1,20 @@
+/*++
+Module Name:
+    mux.h
+
+Abstract:
+    Packs small EC commands for the same service into EC_MUX FF-A direct
+    requests and splits the responses.
+--*/
+
+#ifdef EC_TEST_MUX
+
+NTSTATUS
+MuxStart(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    );
+
+EVT_WDF_WORKITEM MuxWorkItemCallback;
+
+#endif // EC_TEST_MUX
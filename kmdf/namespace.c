@@ -0,0 +1,154 @@
+/*++
+Module Name:
+    namespace.c
+
+Abstract:
+    Handles IOCTL_ACPI_ENUM_CHILDREN. The request is checked and passed to
+    the ACPI target like IOCTL_ACPI_EVAL_METHOD_EX, so user mode can walk
+    the objects below the device once, cache which methods exist and
+    reject calls to missing ones without a round trip. When the output
+    buffer is too small ACPI returns STATUS_BUFFER_OVERFLOW with the size
+    it needs in NumberOfChildren, which is passed back with the header.
+
+Environment:
+    Kernel-mode only
+
+--*/
+
+#include "driver.h"
+#include <acpiioct.h>
+#include "..\inc\ectest.h"
+#include "trace.h"
+#include "namespace.tmh"
+
+#ifdef EC_TEST_NAMESPACE
+
+#define NAMESPACE_ENUM_FLAGS    (ENUM_CHILDREN_IMMEDIATE_ONLY | ENUM_CHILDREN_MULTILEVEL | ENUM_CHILDREN_NAME_IS_FILTER)
+
+/*
+ * Function: NTSTATUS NamespaceEnumStart
+ *
+ * Description:
+ * Validates an ACPI_ENUM_CHILDREN_INPUT_BUFFER and runs the enumeration on a work item, the
+ * ACPI target is called synchronously.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object holding an ACPI_ENUM_CHILDREN_INPUT_BUFFER.
+ *
+ * Return Value:
+ * NTSTATUS status code, on success the request is completed by the work item.
+ */
+NTSTATUS
+NamespaceEnumStart(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    )
+{
+    NTSTATUS status;
+    WDF_OBJECT_ATTRIBUTES attributes;
+    WDF_WORKITEM_CONFIG workitemConfig;
+    WDFWORKITEM workItem;
+    PWORKITEM_CONTEXT context;
+    ACPI_ENUM_CHILDREN_INPUT_BUFFER *req = NULL;
+    size_t reqSize = 0;
+
+    status = WdfRequestRetrieveInputBuffer(Request, sizeof(ACPI_ENUM_CHILDREN_INPUT_BUFFER), &req, &reqSize);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    status = WdfRequestRetrieveOutputBuffer(Request, sizeof(ACPI_ENUM_CHILDREN_OUTPUT_BUFFER), NULL, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    if (req->Signature != ACPI_ENUM_CHILDREN_INPUT_BUFFER_SIGNATURE ||
+        (req->Flags & ~NAMESPACE_ENUM_FLAGS) != 0 ||
+        req->NameLength > reqSize - FIELD_OFFSET(ACPI_ENUM_CHILDREN_INPUT_BUFFER, Name) ||
+        ((req->Flags & ENUM_CHILDREN_NAME_IS_FILTER) && req->NameLength == 0)) {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    WDF_WORKITEM_CONFIG_INIT(&workitemConfig, NamespaceWorkItemCallback);
+
+    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&attributes, WORKITEM_CONTEXT);
+    attributes.ParentObject = Device;
+
+    status = WdfWorkItemCreate(&workitemConfig, &attributes, &workItem);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfWorkItemCreate failed: %!STATUS!\n", status);
+        return status;
+    }
+
+    context = WorkItemGetContext(workItem);
+    context->Device = Device;
+    context->Request = Request;
+
+    WdfWorkItemEnqueue(workItem);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: VOID NamespaceWorkItemCallback
+ *
+ * Description:
+ * Sends the enumeration to the ACPI target with the output buffer of the request and completes
+ * it with the bytes ACPI returned.
+ *
+ * Parameters:
+ * WorkItem - Work item holding the device and request.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+NamespaceWorkItemCallback(
+    _In_ WDFWORKITEM WorkItem
+    )
+{
+    PWORKITEM_CONTEXT context = WorkItemGetContext(WorkItem);
+    WDF_MEMORY_DESCRIPTOR inputMemDesc;
+    WDF_MEMORY_DESCRIPTOR outputMemDesc;
+    ULONG_PTR bytesReturned = 0;
+    PVOID input = NULL;
+    PVOID output = NULL;
+    size_t inputSize = 0;
+    size_t outputSize = 0;
+    NTSTATUS status;
+
+    status = WdfRequestRetrieveInputBuffer(context->Request, 0, &input, &inputSize);
+    if (!NT_SUCCESS(status)) {
+        goto Cleanup;
+    }
+
+    status = WdfRequestRetrieveOutputBuffer(context->Request, 0, &output, &outputSize);
+    if (!NT_SUCCESS(status)) {
+        goto Cleanup;
+    }
+
+    WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(&inputMemDesc, input, (ULONG)inputSize);
+    WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(&outputMemDesc, output, (ULONG)outputSize);
+
+    status = WdfIoTargetSendInternalIoctlSynchronously(WdfDeviceGetIoTarget(context->Device),
+                                                       NULL,
+                                                       IOCTL_ACPI_ENUM_CHILDREN,
+                                                       &inputMemDesc,
+                                                       &outputMemDesc,
+                                                       NULL,
+                                                       &bytesReturned);
+    if (status == STATUS_BUFFER_OVERFLOW) {
+        // Header holds the size needed, it is all ACPI wrote
+        bytesReturned = sizeof(ACPI_ENUM_CHILDREN_OUTPUT_BUFFER);
+        Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Enum children needs %u bytes\n",
+              ((ACPI_ENUM_CHILDREN_OUTPUT_BUFFER *)output)->NumberOfChildren);
+    } else if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"IOCTL_ACPI_ENUM_CHILDREN failed %!STATUS!\n", status);
+        bytesReturned = 0;
+    }
+
+Cleanup:
+    WdfRequestCompleteWithInformation(context->Request, status, bytesReturned);
+}
+
+#endif // EC_TEST_NAMESPACE
@@ -0,0 +1,19 @@
+/*++
+Module Name:
+    namespace.h
+
+Abstract:
+    Enumeration of the ACPI namespace below the device for method discovery.
+--*/
+
+#ifdef EC_TEST_NAMESPACE
+
+NTSTATUS
+NamespaceEnumStart(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    );
+
+EVT_WDF_WORKITEM NamespaceWorkItemCallback;
+
+#endif // EC_TEST_NAMESPACE
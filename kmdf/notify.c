@@ -0,0 +1,447 @@
+/*++
+Module Name:
+    notify.c
+
+Abstract:
+    Per event ID counters and coalescing of EC notifications. Every
+    occurrence is counted, occurrences of the same event ID that arrive
+    while its coalescing window is open, or while no notification request
+    is pending, are folded into one delivery that carries the occurrence
+    count and the first and last timestamps.
+
+    All routines other than the IOCTL handlers and the timer callback
+    expect NotificationLock to be held.
+
+Environment:
+    Kernel-mode only
+
+--*/
+
+#include "driver.h"
+#include "..\inc\ectest.h"
+#include "trace.h"
+#include "notify.tmh"
+
+#ifdef EC_TEST_NOTIFICATIONS
+
+/*
+ * Function: NTSTATUS NotifyInitialize
+ *
+ * Description:
+ * Creates the timer that closes coalescing windows. The timer runs at passive level since the
+ * event table is protected by NotificationLock, so windows are rounded up to the system timer
+ * resolution.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+NTSTATUS
+NotifyInitialize(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    WDF_OBJECT_ATTRIBUTES attributes;
+    WDF_TIMER_CONFIG timerConfig;
+    NTSTATUS status;
+
+    RtlZeroMemory(deviceContext->Events, sizeof(deviceContext->Events));
+    deviceContext->CoalesceDeadline = 0;
+
+    WDF_TIMER_CONFIG_INIT(&timerConfig, NotifyCoalesceTimerCallback);
+    timerConfig.AutomaticSerialization = FALSE;
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = Device;
+    attributes.ExecutionLevel = WdfExecutionLevelPassive;
+    status = WdfTimerCreate(&timerConfig, &attributes, &deviceContext->CoalesceTimer);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfTimerCreate failed %!STATUS!\n", status);
+    }
+
+    return status;
+}
+
+/*
+ * Function: VOID NotifyArmTimer
+ *
+ * Description:
+ * Makes sure the coalescing timer fires no later than Deadline. NotificationLock must be held.
+ *
+ * Parameters:
+ * DeviceContext - Device context holding the timer.
+ * Deadline - Interrupt time in 100ns units.
+ * Now - Current interrupt time.
+ *
+ * Return Value:
+ * VOID
+ */
+static VOID
+NotifyArmTimer(
+    PDEVICE_CONTEXT DeviceContext,
+    ULONGLONG Deadline,
+    ULONGLONG Now
+    )
+{
+    if (DeviceContext->CoalesceDeadline != 0 && DeviceContext->CoalesceDeadline <= Deadline) {
+        return;
+    }
+
+    DeviceContext->CoalesceDeadline = Deadline;
+    WdfTimerStart(DeviceContext->CoalesceTimer, -(LONGLONG)(Deadline > Now ? Deadline - Now : 1));
+}
+
+/*
+ * Function: VOID NotifyRecord
+ *
+ * Description:
+ * Counts one occurrence of an event and folds it into the batch for its event ID. The batch is
+ * ready for delivery immediately if the event has no coalescing window, otherwise once the
+ * window that started with the first occurrence closes. NotificationLock must be held.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * NotifyValue - The value associated with the ACPI notification.
+ * Timestamp - System time the notification was received.
+ * Stamp - Generator stamp for synthetic events, NULL for events from the EC.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+NotifyRecord(
+    WDFDEVICE Device,
+    ULONG NotifyValue,
+    LONGLONG Timestamp,
+    GeneratorStamp_t *Stamp
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    PNOTIFY_EVENT event = &deviceContext->Events[NotifyValue % NOTIFY_EVENT_COUNT];
+    ULONGLONG now;
+
+    event->Count++;
+    event->LastSeen = Timestamp;
+    if (event->Batch.Occurrences == 0) {
+        event->Batch.First = Timestamp;
+    }
+    event->Batch.Value = NotifyValue;
+    event->Batch.Occurrences++;
+    event->Batch.Last = Timestamp;
+    if (Stamp != NULL) {
+        event->Batch.Stamped = TRUE;
+        event->Batch.Stamp = *Stamp;
+    }
+
+    // Already waiting for the window to close or for a request to deliver it to
+    if (event->Ready || event->Deadline != 0) {
+        return;
+    }
+
+    if (event->WindowUs == 0) {
+        event->Ready = TRUE;
+        return;
+    }
+
+    now = KeQueryInterruptTime();
+    event->Deadline = now + (ULONGLONG)event->WindowUs * 10;
+    NotifyArmTimer(deviceContext, event->Deadline, now);
+}
+
+/*
+ * Function: BOOLEAN NotifyTakeReady
+ *
+ * Description:
+ * Removes the ready batch with the oldest first occurrence from the event table so it can be
+ * delivered. NotificationLock must be held.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Batch - Receives the batch to deliver.
+ *
+ * Return Value:
+ * TRUE if a batch was ready.
+ */
+BOOLEAN
+NotifyTakeReady(
+    WDFDEVICE Device,
+    PNOTIFY_BATCH Batch
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    PNOTIFY_EVENT oldest = NULL;
+    ULONG i;
+
+    for (i = 0; i < NOTIFY_EVENT_COUNT; i++) {
+        PNOTIFY_EVENT event = &deviceContext->Events[i];
+        if (event->Ready && (oldest == NULL || event->Batch.First < oldest->Batch.First)) {
+            oldest = event;
+        }
+    }
+
+    if (oldest == NULL) {
+        return FALSE;
+    }
+
+    *Batch = oldest->Batch;
+    oldest->Delivered++;
+    oldest->Coalesced += oldest->Batch.Occurrences - 1;
+    RtlZeroMemory(&oldest->Batch, sizeof(oldest->Batch));
+    oldest->Ready = FALSE;
+    return TRUE;
+}
+
+/*
+ * Function: VOID NotifyRestore
+ *
+ * Description:
+ * Puts back a batch taken by NotifyTakeReady that could not be delivered because the request
+ * was cancelled. Occurrences that arrived in the meantime are folded in. NotificationLock must
+ * be held.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Batch - Batch returned by NotifyTakeReady.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+NotifyRestore(
+    WDFDEVICE Device,
+    PNOTIFY_BATCH Batch
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    PNOTIFY_EVENT event = &deviceContext->Events[Batch->Value % NOTIFY_EVENT_COUNT];
+
+    event->Delivered--;
+    event->Coalesced -= Batch->Occurrences - 1;
+
+    if (event->Batch.Occurrences == 0) {
+        event->Batch = *Batch;
+    } else {
+        event->Batch.First = Batch->First;
+        event->Batch.Occurrences += Batch->Occurrences;
+        if (!event->Batch.Stamped) {
+            event->Batch.Stamped = Batch->Stamped;
+            event->Batch.Stamp = Batch->Stamp;
+        }
+    }
+
+    // The open window, if any, now covers the restored occurrences as well
+    if (event->Deadline == 0) {
+        event->Ready = TRUE;
+    }
+}
+
+/*
+ * Function: BOOLEAN NotifyPutItem
+ *
+ * Description:
+ * Appends one NotificationItem_t and its data to a notification payload if it fits. The item is
+ * always counted in Total so the caller can report how large a buffer would have been needed.
+ *
+ * Parameters:
+ * Rsp - Notification response being filled in.
+ * PayloadSize - Bytes available at Rsp->payload.
+ * Type - NOTIFY_PAYLOAD_* item type.
+ * Data - Item data.
+ * Length - Bytes of item data.
+ *
+ * Return Value:
+ * TRUE if the item was written.
+ */
+BOOLEAN
+NotifyPutItem(
+    NotificationRsp_t *Rsp,
+    size_t PayloadSize,
+    USHORT Type,
+    PVOID Data,
+    USHORT Length
+    )
+{
+    NotificationItem_t *item;
+    ULONG itemSize = (ULONG)NOTIFY_ITEM_SIZE(Length);
+    ULONG offset = Rsp->payloadtotal;
+
+    Rsp->payloadtotal += itemSize;
+    if (offset != Rsp->payloadsize || (size_t)offset + itemSize > PayloadSize) {
+        return FALSE;
+    }
+
+    item = (NotificationItem_t *)(Rsp->payload + offset);
+    RtlZeroMemory(item, itemSize);
+    item->type = Type;
+    item->length = Length;
+    RtlCopyMemory(item + 1, Data, Length);
+    Rsp->payloadsize += itemSize;
+    Rsp->flags |= Type;
+    return TRUE;
+}
+
+/*
+ * Function: VOID NotifyCoalesceTimerCallback
+ *
+ * Description:
+ * Closes every coalescing window that has expired, re-arms the timer for the next one and
+ * delivers a ready batch if a notification request is pending.
+ *
+ * Parameters:
+ * Timer - The Timer object.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+NotifyCoalesceTimerCallback(
+    WDFTIMER Timer
+    )
+{
+    WDFDEVICE device = WdfTimerGetParentObject(Timer);
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(device);
+    ULONGLONG now, next = 0;
+    ULONG i;
+
+    WdfWaitLockAcquire(deviceContext->NotificationLock, NULL);
+    now = KeQueryInterruptTime();
+    for (i = 0; i < NOTIFY_EVENT_COUNT; i++) {
+        PNOTIFY_EVENT event = &deviceContext->Events[i];
+        if (event->Deadline == 0) {
+            continue;
+        }
+
+        if (event->Deadline <= now) {
+            event->Deadline = 0;
+            event->Ready = TRUE;
+        } else if (next == 0 || event->Deadline < next) {
+            next = event->Deadline;
+        }
+    }
+
+    deviceContext->CoalesceDeadline = 0;
+    if (next != 0) {
+        NotifyArmTimer(deviceContext, next, now);
+    }
+    WdfWaitLockRelease(deviceContext->NotificationLock);
+
+    NotificationDeliver(device);
+}
+
+/*
+ * Function: NTSTATUS NotifySetCoalesce
+ *
+ * Description:
+ * Handles IOCTL_SET_COALESCE. A new window applies from the next occurrence that opens one, a
+ * window already open keeps its deadline.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object holding a CoalesceReq_t.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+NTSTATUS
+NotifySetCoalesce(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    CoalesceReq_t *req = NULL;
+    ULONG i;
+    NTSTATUS status;
+
+    status = WdfRequestRetrieveInputBuffer(Request, sizeof(CoalesceReq_t), &req, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    if (req->window > NOTIFY_COALESCE_MAX_US ||
+        (req->event != NOTIFY_EVENT_ALL && req->event >= NOTIFY_EVENT_COUNT)) {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    WdfWaitLockAcquire(deviceContext->NotificationLock, NULL);
+    for (i = 0; i < NOTIFY_EVENT_COUNT; i++) {
+        if (req->event == NOTIFY_EVENT_ALL || req->event == i) {
+            deviceContext->Events[i].WindowUs = req->window;
+        }
+    }
+    WdfWaitLockRelease(deviceContext->NotificationLock);
+
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Coalescing window for 0x%x set to %u us\n", req->event, req->window);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: NTSTATUS NotifyGetCounters
+ *
+ * Description:
+ * Handles IOCTL_GET_EVENT_COUNTERS, copying a consistent snapshot of the requested range of the
+ * event table.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object holding an EventCountersReq_t.
+ * BytesReturned - Receives the number of output bytes written.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+NTSTATUS
+NotifyGetCounters(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    size_t *BytesReturned
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    EventCountersReq_t *req = NULL;
+    EventCountersRsp_t *rsp = NULL;
+    size_t rspSize = 0;
+    ULONG count, i;
+    NTSTATUS status;
+
+    status = WdfRequestRetrieveInputBuffer(Request, sizeof(EventCountersReq_t), &req, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    status = WdfRequestRetrieveOutputBuffer(Request, EVENT_COUNTERS_RSP_HEADER_SIZE, &rsp, &rspSize);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    if (req->first >= NOTIFY_EVENT_COUNT) {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    count = min(req->count, NOTIFY_EVENT_COUNT - req->first);
+    count = min(count, (ULONG)((rspSize - EVENT_COUNTERS_RSP_HEADER_SIZE) / sizeof(EventCounter_t)));
+
+    rsp->first = req->first;
+    rsp->count = count;
+
+    WdfWaitLockAcquire(deviceContext->NotificationLock, NULL);
+    for (i = 0; i < count; i++) {
+        PNOTIFY_EVENT event = &deviceContext->Events[req->first + i];
+        EventCounter_t *counter = &rsp->counter[i];
+
+        counter->count = event->Count;
+        counter->delivered = event->Delivered;
+        counter->coalesced = event->Coalesced;
+        counter->lasttimestamp = event->LastSeen;
+        counter->window = event->WindowUs;
+        counter->pending = event->Batch.Occurrences;
+    }
+    WdfWaitLockRelease(deviceContext->NotificationLock);
+
+    *BytesReturned = EVENT_COUNTERS_RSP_HEADER_SIZE + count * sizeof(EventCounter_t);
+    return STATUS_SUCCESS;
+}
+
+#endif // EC_TEST_NOTIFICATIONS
@@ -0,0 +1,61 @@
+/*++
+Module Name:
+    notify.h
+
+Abstract:
+    Per event ID counters and coalescing of EC notifications before they
+    are delivered to the app.
+--*/
+
+#ifdef EC_TEST_NOTIFICATIONS
+
+NTSTATUS
+NotifyInitialize(
+    WDFDEVICE Device
+    );
+
+VOID
+NotifyRecord(
+    WDFDEVICE Device,
+    ULONG NotifyValue,
+    LONGLONG Timestamp,
+    GeneratorStamp_t *Stamp
+    );
+
+BOOLEAN
+NotifyTakeReady(
+    WDFDEVICE Device,
+    PNOTIFY_BATCH Batch
+    );
+
+VOID
+NotifyRestore(
+    WDFDEVICE Device,
+    PNOTIFY_BATCH Batch
+    );
+
+BOOLEAN
+NotifyPutItem(
+    NotificationRsp_t *Rsp,
+    size_t PayloadSize,
+    USHORT Type,
+    PVOID Data,
+    USHORT Length
+    );
+
+NTSTATUS
+NotifySetCoalesce(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    );
+
+NTSTATUS
+NotifyGetCounters(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    size_t *BytesReturned
+    );
+
+EVT_WDF_TIMER NotifyCoalesceTimerCallback;
+
+#endif // EC_TEST_NOTIFICATIONS
@@ -0,0 +1,659 @@
+/*++
+Module Name:
+    priority.c
+
+Abstract:
+    ACPI evaluations are held in one manual queue per EVAL_PRIORITY_*
+    class and handed to work items by PriorityDispatch, which always takes
+    the highest class first. Each class may only dispatch while fewer than
+    its limit of evaluations are in flight, so slots stay free for higher
+    classes and a thermal read never waits for slow bulk transfers to
+    finish. A waiting request is raised one class for every aging period
+    it has waited so lower classes still make progress under load.
+
+    The queues are sharded by the ACPI device path of the method. The ASL
+    methods of a device are Serialized, so a second evaluation on a busy
+    device only blocks a system worker thread. Each shard has its own
+    limits and shards take turns on ties, so callers on different devices
+    scale independently and the total limit keeps one shard from using up
+    the system work item threads.
+
+Environment:
+    Kernel-mode only
+
+--*/
+
+#include "driver.h"
+#include <acpiioct.h>
+#include "..\inc\ectest.h"
+#include "..\inc\ecsched.h"
+#include "trace.h"
+#include "priority.tmh"
+
+#ifdef EC_TEST_PRIORITY
+
+// Limits and aging periods are in ecsched.h, shared with bench/schedbench.cpp
+C_ASSERT(EC_SCHED_CLASSES == EVAL_PRIORITY_COUNT);
+C_ASSERT(EVAL_SHARD_PATH_LEN == RTL_FIELD_SIZE(ACPI_EVAL_INPUT_BUFFER_V1_EX, MethodName));
+
+/*
+ * Function: NTSTATUS PriorityInitialize
+ *
+ * Description:
+ * Creates the dispatch lock and one manual queue per priority class for every shard. Shard 0
+ * is the shared shard for methods without a device path and devices that find every shard busy.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+NTSTATUS
+PriorityInitialize(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    WDF_IO_QUEUE_CONFIG queueConfig;
+    WDF_OBJECT_ATTRIBUTES attributes;
+    NTSTATUS status;
+    ULONG i, j;
+
+    deviceContext->PriorityInflight = 0;
+    deviceContext->ShardCount = 1;
+    deviceContext->ShardNext = 0;
+    RtlZeroMemory(deviceContext->PriorityStats, sizeof(deviceContext->PriorityStats));
+    RtlZeroMemory(deviceContext->Shards, sizeof(deviceContext->Shards));
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = Device;
+    status = WdfWaitLockCreate(&attributes, &deviceContext->PriorityLock);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfWaitLockCreate failed %!STATUS!\n", status);
+        return status;
+    }
+
+    for (j = 0; j < EVAL_SHARD_COUNT; j++) {
+        deviceContext->Shards[j].Stats.limit = EcSchedShardLimit[EVAL_PRIORITY_CRITICAL];
+        for (i = 0; i < EVAL_PRIORITY_COUNT; i++) {
+            WDF_IO_QUEUE_CONFIG_INIT(&queueConfig, WdfIoQueueDispatchManual);
+            status = WdfIoQueueCreate(Device,
+                                      &queueConfig,
+                                      WDF_NO_OBJECT_ATTRIBUTES,
+                                      &deviceContext->Shards[j].Queues[i]);
+            if (!NT_SUCCESS(status)) {
+                Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfIoQueueCreate for shard %u priority %u failed %!STATUS!\n", j, i, status);
+                return status;
+            }
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: BOOLEAN ShardIdle
+ *
+ * Description:
+ * Whether a shard has nothing queued or in flight, so it can be given to another device.
+ * PriorityLock must be held.
+ *
+ * Parameters:
+ * Shard - Shard to check.
+ *
+ * Return Value:
+ * TRUE if the shard is idle.
+ */
+static BOOLEAN
+ShardIdle(
+    PEVAL_SHARD Shard
+    )
+{
+    ULONG queued, driver, i;
+
+    if (Shard->Stats.inflight != 0) {
+        return FALSE;
+    }
+    for (i = 0; i < EVAL_PRIORITY_COUNT; i++) {
+        WdfIoQueueGetState(Shard->Queues[i], &queued, &driver);
+        if (queued != 0) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * Function: ULONG ShardLookup
+ *
+ * Description:
+ * Finds the shard of the ACPI device that owns the method, everything before the last '.' of
+ * the method path, comparing the whole path. A device seen for the first time gets an unused
+ * shard, or else one that is idle, so paths that were only used once do not hold on to shards.
+ * PriorityLock must be held until the request is queued, or the shard could be reassigned
+ * before it is.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - ACPI evaluation request.
+ * InputOffset - Bytes before the ACPI input in the request input buffer.
+ *
+ * Return Value:
+ * Index in Shards, 0 if the method has no device path or every shard is busy.
+ */
+static ULONG
+ShardLookup(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    ULONG InputOffset
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    PACPI_EVAL_INPUT_BUFFER_V1_EX input;
+    PEVAL_SHARD shard;
+    PUCHAR buffer = NULL;
+    size_t length = 0;
+    size_t i;
+    ULONG found = 0;
+    ULONG limit;
+    ULONG j;
+
+    // All _EX input buffers start with the signature and the full method path
+    if (!NT_SUCCESS(WdfRequestRetrieveInputBuffer(Request,
+                                                  InputOffset + sizeof(ACPI_EVAL_INPUT_BUFFER_V1_EX),
+                                                  &buffer,
+                                                  NULL))) {
+        return 0;
+    }
+    input = (PACPI_EVAL_INPUT_BUFFER_V1_EX)(buffer + InputOffset);
+
+    // Path is shorter than MethodName so it always fits Path with its terminator
+    for (i = 0; i < sizeof(input->MethodName) && input->MethodName[i] != '\0'; i++) {
+        if (input->MethodName[i] == '.') {
+            length = i;
+        }
+    }
+    if (length == 0) {
+        return 0;
+    }
+
+    for (j = 1; j < deviceContext->ShardCount; j++) {
+        shard = &deviceContext->Shards[j];
+        if (strlen(shard->Path) == length && RtlCompareMemory(shard->Path, input->MethodName, length) == length) {
+            return j;
+        }
+    }
+
+    if (deviceContext->ShardCount < EVAL_SHARD_COUNT) {
+        found = deviceContext->ShardCount++;
+    } else {
+        for (j = 1; j < EVAL_SHARD_COUNT; j++) {
+            if (ShardIdle(&deviceContext->Shards[j])) {
+                found = j;
+                break;
+            }
+        }
+        if (found == 0) {
+            return 0;
+        }
+    }
+
+    // Statistics of the device that had the shard before go with it
+    shard = &deviceContext->Shards[found];
+    limit = shard->Stats.limit;
+    RtlZeroMemory(shard->Path, sizeof(shard->Path));
+    RtlZeroMemory(&shard->Stats, sizeof(shard->Stats));
+    shard->Stats.limit = limit;
+    RtlCopyMemory(shard->Path, input->MethodName, length);
+    RtlCopyMemory(shard->Stats.prefix, input->MethodName, min(length, EVAL_SHARD_PREFIX_LEN - 1));
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Shard %u for %s\n", found, shard->Path);
+
+    return found;
+}
+
+/*
+ * Function: NTSTATUS PriorityEnqueue
+ *
+ * Description:
+ * Queues an ACPI evaluation in the queue of its shard and class and dispatches if there is room.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - ACPI evaluation request.
+ * Priority - EVAL_PRIORITY_* class.
+ * InputOffset - Bytes before the ACPI input in the request input buffer.
+ * InputTrailer - Bytes after the ACPI input in the request input buffer.
+ * Correlation - Timeline correlation ID the app passed, 0 for none.
+ *
+ * Return Value:
+ * NTSTATUS status code, on success the request is completed by the work item. STATUS_DEVICE_BUSY
+ * if admission control rejected the request.
+ */
+NTSTATUS
+PriorityEnqueue(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    ULONG Priority,
+    ULONG InputOffset,
+    ULONG InputTrailer,
+    ULONG Correlation
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    PREQUEST_CONTEXT requestContext = RequestContextGet(Request);
+    NTSTATUS status;
+
+#ifdef EC_TEST_ADMISSION
+    status = AdmissionAdmit(Device, Request);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+#endif
+
+    requestContext->Priority = Priority;
+    requestContext->InputOffset = InputOffset;
+    requestContext->InputTrailer = InputTrailer;
+    requestContext->Enqueued = KeQueryInterruptTime();
+    requestContext->Dispatched = 0;
+#ifdef EC_TEST_TIMELINE
+    requestContext->Correlation = TimelineCorrelation(Device, Correlation);
+    TimelineRecord(Device, TIMELINE_EVAL_QUEUED, requestContext->Correlation, 0, Priority);
+#else
+    UNREFERENCED_PARAMETER(Correlation);
+    requestContext->Correlation = 0;
+#endif
+
+    // Shard is looked up and the request queued in one go so the shard is not reassigned meanwhile
+    WdfWaitLockAcquire(deviceContext->PriorityLock, NULL);
+    requestContext->Shard = ShardLookup(Device, Request, InputOffset);
+    status = WdfRequestForwardToIoQueue(Request, deviceContext->Shards[requestContext->Shard].Queues[Priority]);
+    WdfWaitLockRelease(deviceContext->PriorityLock);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfRequestForwardToIoQueue failed %!STATUS!\n", status);
+        return status;
+    }
+
+    PriorityDispatch(Device);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: NTSTATUS PriorityEvaluate
+ *
+ * Description:
+ * Handles IOCTL_ACPI_EVAL_PRIORITY, queuing the ACPI input after the EvalPriorityReq_t header
+ * in the requested class.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object holding an EvalPriorityReq_t.
+ *
+ * Return Value:
+ * NTSTATUS status code, on success the request is completed by the work item.
+ */
+NTSTATUS
+PriorityEvaluate(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    )
+{
+    EvalPriorityReq_t *req = NULL;
+    NTSTATUS status;
+
+    status = WdfRequestRetrieveInputBuffer(Request,
+                                           EVAL_PRIORITY_REQ_HEADER_SIZE + sizeof(ACPI_EVAL_INPUT_BUFFER_V1_EX),
+                                           &req,
+                                           NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    if (req->priority >= EVAL_PRIORITY_COUNT) {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    return PriorityEnqueue(Device, Request, req->priority, EVAL_PRIORITY_REQ_HEADER_SIZE, 0, req->correlation);
+}
+
+/*
+ * Function: NTSTATUS PriorityEvaluateMethod
+ *
+ * Description:
+ * Handles IOCTL_ACPI_EVAL_METHOD_EX, queuing the evaluation as EVAL_PRIORITY_NORMAL. An
+ * EvalCorrelation_t at the end of the input is taken off and its correlation ID recorded.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object holding an ACPI_EVAL_INPUT_BUFFER_*_EX.
+ *
+ * Return Value:
+ * NTSTATUS status code, on success the request is completed by the work item.
+ */
+NTSTATUS
+PriorityEvaluateMethod(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    )
+{
+    EvalCorrelation_t *trailer;
+    PUCHAR input = NULL;
+    size_t length = 0;
+    NTSTATUS status;
+
+    status = WdfRequestRetrieveInputBuffer(Request, sizeof(ACPI_EVAL_INPUT_BUFFER_V1_EX), &input, &length);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    if (length >= sizeof(ACPI_EVAL_INPUT_BUFFER_V1_EX) + sizeof(EvalCorrelation_t)) {
+        trailer = (EvalCorrelation_t *)(input + length - sizeof(EvalCorrelation_t));
+        if (trailer->signature == EVAL_CORRELATION_SIGNATURE) {
+            return PriorityEnqueue(Device, Request, EVAL_PRIORITY_NORMAL, 0, sizeof(EvalCorrelation_t), trailer->correlation);
+        }
+    }
+
+    return PriorityEnqueue(Device, Request, EVAL_PRIORITY_NORMAL, 0, 0, 0);
+}
+
+/*
+ * Function: WDFREQUEST PriorityNext
+ *
+ * Description:
+ * Takes the next request to dispatch. Raises the oldest request of every shard and class by the
+ * number of aging periods it has waited, keeps those under the shard and total in flight limits
+ * of the class they were raised to and picks the highest class. The longer wait wins ties, so
+ * an aged bulk request gets the next critical slot rather than starving behind steady critical
+ * traffic. Shards take turns on full ties. PriorityLock must be held.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Retry - Set to TRUE if the chosen request was cancelled before it could be removed.
+ *
+ * Return Value:
+ * Request removed from its queue, or NULL if nothing can be dispatched.
+ */
+static WDFREQUEST
+PriorityNext(
+    WDFDEVICE Device,
+    BOOLEAN *Retry
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    WDFREQUEST found[EVAL_SHARD_COUNT][EVAL_PRIORITY_COUNT] = { 0 };
+    WDFREQUEST request = NULL;
+    PREQUEST_CONTEXT requestContext;
+    PEVAL_SHARD shard;
+    ULONGLONG now = KeQueryInterruptTime();
+    ULONGLONG waited;
+    ULONGLONG bestWaited = 0;
+    ULONG best = EVAL_PRIORITY_COUNT;
+    ULONG bestShard = 0;
+    ULONG bestLevel = EVAL_PRIORITY_COUNT;
+    ULONG level, i, j, n;
+    NTSTATUS status;
+
+    *Retry = FALSE;
+    for (n = 0; n < deviceContext->ShardCount; n++) {
+        j = (deviceContext->ShardNext + n) % deviceContext->ShardCount;
+        shard = &deviceContext->Shards[j];
+
+        // Critical has the highest limit, nothing else fits a shard it has filled
+        if (shard->Stats.inflight >= EcSchedShardLimit[EVAL_PRIORITY_CRITICAL]) {
+            continue;
+        }
+
+        for (i = 0; i < EVAL_PRIORITY_COUNT; i++) {
+            // Oldest request stays in the queue, found holds a reference to it
+            if (!NT_SUCCESS(WdfIoQueueFindRequest(shard->Queues[i], NULL, NULL, NULL, &found[j][i]))) {
+                found[j][i] = NULL;
+                continue;
+            }
+
+            // Limits are those of the class the request has aged to, or it would never get a slot
+            waited = now - RequestContextGet(found[j][i])->Enqueued;
+            level = EcSchedLevel(i, waited);
+            switch (EcSchedCheck(level, shard->Stats.inflight, deviceContext->PriorityInflight)) {
+            case EC_SCHED_SHARD_FULL:
+                continue;
+            case EC_SCHED_TOTAL_FULL:
+                shard->Stats.deferred++;
+                continue;
+            }
+
+            if (EcSchedBetter(level, waited, bestLevel, bestWaited)) {
+                best = i;
+                bestShard = j;
+                bestLevel = level;
+                bestWaited = waited;
+            }
+        }
+    }
+
+    if (best != EVAL_PRIORITY_COUNT) {
+        shard = &deviceContext->Shards[bestShard];
+        status = WdfIoQueueRetrieveFoundRequest(shard->Queues[best], found[bestShard][best], &request);
+        if (!NT_SUCCESS(status)) {
+            // Cancelled since it was found
+            Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Shard %u priority %u request gone %!STATUS!\n", bestShard, best, status);
+            request = NULL;
+            *Retry = TRUE;
+        }
+    }
+
+    for (j = 0; j < deviceContext->ShardCount; j++) {
+        for (i = 0; i < EVAL_PRIORITY_COUNT; i++) {
+            if (found[j][i] != NULL) {
+                WdfObjectDereference(found[j][i]);
+            }
+        }
+    }
+
+    if (request != NULL) {
+        EvalPriorityStats_t *stats = &deviceContext->PriorityStats[best];
+
+        requestContext = RequestContextGet(request);
+        requestContext->Dispatched = now;
+        waited = now - requestContext->Enqueued;
+
+        deviceContext->PriorityInflight++;
+        deviceContext->ShardNext = (bestShard + 1) % deviceContext->ShardCount;
+        stats->inflight++;
+        stats->dispatched++;
+        stats->waittotal += waited;
+        stats->waitmax = max(stats->waitmax, waited);
+        if (bestLevel != best) {
+            stats->aged++;
+        }
+
+        shard->Stats.inflight++;
+        shard->Stats.dispatched++;
+        shard->Stats.waittotal += waited;
+        shard->Stats.waitmax = max(shard->Stats.waitmax, waited);
+    }
+
+    return request;
+}
+
+/*
+ * Function: VOID PriorityDispatch
+ *
+ * Description:
+ * Hands queued evaluations to work items until every class is at its in flight limit or all
+ * queues are empty. Called when a request is queued and when an evaluation completes.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+PriorityDispatch(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    WDFREQUEST request;
+    NTSTATUS status;
+    BOOLEAN retry;
+
+    for (;;) {
+        WdfWaitLockAcquire(deviceContext->PriorityLock, NULL);
+        request = PriorityNext(Device, &retry);
+        WdfWaitLockRelease(deviceContext->PriorityLock);
+
+        if (request == NULL) {
+            // A request cancelled between find and retrieve leaves the others queued, look again
+            if (retry) {
+                continue;
+            }
+            break;
+        }
+
+        status = CreateAndEnqueueWorkItem(Device, request);
+        if (!NT_SUCCESS(status)) {
+            Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"CreateAndEnqueueWorkItem failed\n");
+            PriorityDone(Device, request);
+            WdfRequestComplete(request, status);
+        }
+    }
+}
+
+/*
+ * Function: VOID PriorityDone
+ *
+ * Description:
+ * Accounts for an evaluation that finished, must be called before the request is completed.
+ * The caller dispatches again after completing it.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - Evaluation that finished.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+PriorityDone(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    PREQUEST_CONTEXT requestContext = RequestContextGet(Request);
+    EvalPriorityStats_t *stats = &deviceContext->PriorityStats[requestContext->Priority];
+    EvalShardStats_t *shardStats = &deviceContext->Shards[requestContext->Shard].Stats;
+    ULONGLONG service = KeQueryInterruptTime() - requestContext->Dispatched;
+
+    WdfWaitLockAcquire(deviceContext->PriorityLock, NULL);
+    deviceContext->PriorityInflight--;
+    stats->inflight--;
+    stats->completed++;
+    stats->servicetotal += service;
+    stats->servicemax = max(stats->servicemax, service);
+    shardStats->inflight--;
+    shardStats->completed++;
+    shardStats->servicetotal += service;
+    shardStats->servicemax = max(shardStats->servicemax, service);
+    WdfWaitLockRelease(deviceContext->PriorityLock);
+}
+
+/*
+ * Function: NTSTATUS PriorityGetStats
+ *
+ * Description:
+ * Handles IOCTL_GET_PRIORITY_STATS, returning depth, in flight count, wait and service time of
+ * every priority class.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object with room for an EvalPriorityStatsRsp_t.
+ * BytesReturned - Receives the number of output bytes written.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+NTSTATUS
+PriorityGetStats(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    size_t *BytesReturned
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    EvalPriorityStatsRsp_t *rsp = NULL;
+    ULONG queued, driver, i, j;
+    NTSTATUS status;
+
+    status = WdfRequestRetrieveOutputBuffer(Request, sizeof(EvalPriorityStatsRsp_t), &rsp, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    WdfWaitLockAcquire(deviceContext->PriorityLock, NULL);
+    for (i = 0; i < EVAL_PRIORITY_COUNT; i++) {
+        rsp->classes[i] = deviceContext->PriorityStats[i];
+        rsp->classes[i].depth = 0;
+        for (j = 0; j < deviceContext->ShardCount; j++) {
+            WdfIoQueueGetState(deviceContext->Shards[j].Queues[i], &queued, &driver);
+            rsp->classes[i].depth += queued;
+        }
+    }
+    WdfWaitLockRelease(deviceContext->PriorityLock);
+
+    *BytesReturned = sizeof(EvalPriorityStatsRsp_t);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: NTSTATUS PriorityGetShardStats
+ *
+ * Description:
+ * Handles IOCTL_GET_SHARD_STATS, returning the device path, limit, depth, in flight count,
+ * wait and service time of every shard in use.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object with room for an EvalShardStatsRsp_t.
+ * BytesReturned - Receives the number of output bytes written.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+NTSTATUS
+PriorityGetShardStats(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    size_t *BytesReturned
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    EvalShardStatsRsp_t *rsp = NULL;
+    ULONG queued, driver, i, j;
+    NTSTATUS status;
+
+    status = WdfRequestRetrieveOutputBuffer(Request, sizeof(EvalShardStatsRsp_t), &rsp, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    RtlZeroMemory(rsp, sizeof(EvalShardStatsRsp_t));
+    WdfWaitLockAcquire(deviceContext->PriorityLock, NULL);
+    rsp->count = deviceContext->ShardCount;
+    rsp->inflight = deviceContext->PriorityInflight;
+    rsp->limit = EcSchedTotalLimit[EVAL_PRIORITY_CRITICAL];
+    for (j = 0; j < deviceContext->ShardCount; j++) {
+        rsp->shards[j] = deviceContext->Shards[j].Stats;
+        for (i = 0; i < EVAL_PRIORITY_COUNT; i++) {
+            WdfIoQueueGetState(deviceContext->Shards[j].Queues[i], &queued, &driver);
+            rsp->shards[j].depth += queued;
+        }
+    }
+    WdfWaitLockRelease(deviceContext->PriorityLock);
+
+    *BytesReturned = sizeof(EvalShardStatsRsp_t);
+    return STATUS_SUCCESS;
+}
+
+#endif // EC_TEST_PRIORITY
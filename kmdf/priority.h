@@ -0,0 +1,65 @@
+/*++
+Module Name:
+    priority.h
+
+Abstract:
+    Priority classes for ACPI evaluation requests, each with its own
+    manual queue per target device shard, and the dispatcher that drains
+    them.
+--*/
+
+#ifdef EC_TEST_PRIORITY
+
+NTSTATUS
+PriorityInitialize(
+    WDFDEVICE Device
+    );
+
+NTSTATUS
+PriorityEnqueue(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    ULONG Priority,
+    ULONG InputOffset,
+    ULONG InputTrailer,
+    ULONG Correlation
+    );
+
+NTSTATUS
+PriorityEvaluate(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    );
+
+NTSTATUS
+PriorityEvaluateMethod(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    );
+
+VOID
+PriorityDone(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    );
+
+VOID
+PriorityDispatch(
+    WDFDEVICE Device
+    );
+
+NTSTATUS
+PriorityGetStats(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    size_t *BytesReturned
+    );
+
+NTSTATUS
+PriorityGetShardStats(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    size_t *BytesReturned
+    );
+
+#endif // EC_TEST_PRIORITY
@@ -1,25 +1,25 @@
-/*++
-Module Name:
-    public.h
-
-Abstract:
-
-    This module contains the common declarations shared by driver
-    and user applications.
-
-Environment:
-    user and kernel
-
---*/
-
-#define WHILE(a) \
-__pragma(warning(suppress:4127)) while(a)
-
-//
-// Define an Interface Guid so that app can find the device and talk to it.
-//
-
-DEFINE_GUID (GUID_DEVINTERFACE_ECTEST,
-    0xcdc35b6e, 0xbe4, 0x4936, 0xbf, 0x5f, 0x55, 0x37, 0x38, 0xa, 0x7c, 0x1a);
-// {CDC35B6E-0BE4-4936-BF5F-5537380A7C1A}
-
+/*++
+Module Name:
+    public.h
+
+Abstract:
+
+    This module contains the common declarations shared by driver
+    and user applications.
+
+Environment:
+    user and kernel
+
+--*/
+
+#define WHILE(a) \
+__pragma(warning(suppress:4127)) while(a)
+
+//
+// Define an Interface Guid so that app can find the device and talk to it.
+//
+
+DEFINE_GUID (GUID_DEVINTERFACE_ECTEST,
+    0xcdc35b6e, 0xbe4, 0x4936, 0xbf, 0x5f, 0x55, 0x37, 0x38, 0xa, 0x7c, 0x1a);
+// {CDC35B6E-0BE4-4936-BF5F-5537380A7C1A}
+
@@ -1,40 +1,67 @@
-/*++
-Module Name:
-    queue.h
-
-Abstract:
-
-    This is a C version of a very simple sample driver that illustrates
-    how to use the driver framework and demonstrates best practices.
---*/
-
-#include <acpiioct.h>
-
-//
-// This is the context that can be placed per queue
-// and would contain per queue information.
-//
-typedef struct _WORKITEM_CONTEXT {
-    WDFDEVICE Device;
-    WDFQUEUE Queue;
-    WDFREQUEST Request;
-    ACPI_EVAL_INPUT_BUFFER_V1_EX *Buffer;
-} WORKITEM_CONTEXT, *PWORKITEM_CONTEXT;
-
-WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(WORKITEM_CONTEXT, WorkItemGetContext);
-
-NTSTATUS
-ECTestQueueInitialize(
-    WDFDEVICE hDevice
-    );
-
-EVT_WDF_IO_QUEUE_CONTEXT_DESTROY_CALLBACK ECTestEvtIoQueueContextDestroy;
-
-VOID
-ECTestEvtIoDeviceControl(
-    IN WDFQUEUE         Queue,
-    IN WDFREQUEST       Request,
-    IN size_t           OutputBufferLength,
-    IN size_t           InputBufferLength,
-    IN ULONG            IoControlCode
-    );
+/*++
+Module Name:
+    queue.h
+
+Abstract:
+
+    This is a C version of a very simple sample driver that illustrates
+    how to use the driver framework and demonstrates best practices.
+--*/
+
+#include <acpiioct.h>
+
+//
+// This is the context that can be placed per queue
+// and would contain per queue information.
+//
+typedef struct _WORKITEM_CONTEXT {
+    WDFDEVICE Device;
+    WDFQUEUE Queue;
+    WDFREQUEST Request;
+    ACPI_EVAL_INPUT_BUFFER_V1_EX *Buffer;
+#ifdef EC_TEST_BULK
+    ULONG BulkBuffer; // Pool buffer held by a bulk transfer
+#endif
+} WORKITEM_CONTEXT, *PWORKITEM_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(WORKITEM_CONTEXT, WorkItemGetContext);
+
+NTSTATUS
+ECTestQueueInitialize(
+    WDFDEVICE hDevice
+    );
+
+EVT_WDF_IO_QUEUE_CONTEXT_DESTROY_CALLBACK ECTestEvtIoQueueContextDestroy;
+
+NTSTATUS
+CreateAndEnqueueWorkItem(
+    _In_ WDFDEVICE Device,
+    _In_ WDFREQUEST Request
+    );
+
+// PFFA_INTERFACE, ffainterface.h is only included where direct requests are sent
+struct _FFA_INTERFACE_V1 *
+FfaGetInterface(VOID);
+
+VOID
+ECTestEvtIoDeviceControl(
+    IN WDFQUEUE         Queue,
+    IN WDFREQUEST       Request,
+    IN size_t           OutputBufferLength,
+    IN size_t           InputBufferLength,
+    IN ULONG            IoControlCode
+    );
+
+#ifdef EC_TEST_NOTIFICATIONS
+VOID
+NotificationDeliver(
+    WDFDEVICE Device
+    );
+
+VOID
+NotificationRaise(
+    WDFDEVICE Device,
+    ULONG NotifyValue,
+    GeneratorStamp_t *Stamp
+    );
+#endif
@@ -0,0 +1,580 @@
+/*++
+Module Name:
+    ring.c
+
+Abstract:
+    Host side consumer of the shared memory RX ring. The EC service rings a
+    doorbell (FF-A notification routed through ECT0 as Notify 0x21) when it
+    posts a response, which completes any request waiting on that sequence
+    number. A backoff timer rescans the ring in case a doorbell is lost.
+    Responses larger than one entry are reassembled from their fragments.
+
+Environment:
+    Kernel-mode only
+
+--*/
+
+#include "driver.h"
+#include "..\inc\ectest.h"
+#include "trace.h"
+#include "ring.tmh"
+
+#ifdef EC_TEST_DOORBELL
+
+#define RING_SLOT_HEADER(Ring, Index) \
+    ((PULONG64)((Ring) + EC_RING_SLOT_OFFSET) + (Index))
+#define RING_ENTRY(Context, Index) \
+    ((PULONG64)((Context)->RxRing + (Context)->RingEntryOffset + (Index) * (Context)->RingEntrySize))
+
+/*
+ * Function: NTSTATUS RingReadGeometry
+ *
+ * Description:
+ * Reads the ring geometry UEFI publishes at the start of the shared region. Falls back to the
+ * default geometry if there is no valid header so older firmware keeps working.
+ *
+ * Parameters:
+ * DeviceContext - Device context to fill in, RingHeader must be mapped.
+ * RxOffset - Receives the offset of the RX ring from the start of the region.
+ * RingSize - Receives the size of each ring in bytes.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+static NTSTATUS
+RingReadGeometry(
+    PDEVICE_CONTEXT DeviceContext,
+    PULONG RxOffset,
+    PULONG RingSize
+    )
+{
+    PUCHAR header = DeviceContext->RingHeader;
+    ULONG magic, version, regionSize, slots, entrySize, rxOffset, ringSize, entryOffset;
+
+    magic = READ_REGISTER_ULONG((PULONG)(header + EC_RING_GEO_MAGIC_OFFSET));
+    version = READ_REGISTER_USHORT((PUSHORT)(header + EC_RING_GEO_VERSION_OFFSET));
+    regionSize = READ_REGISTER_ULONG((PULONG)(header + EC_RING_GEO_REGION_SIZE_OFFSET));
+    slots = READ_REGISTER_USHORT((PUSHORT)(header + EC_RING_GEO_SLOT_COUNT_OFFSET));
+    entrySize = READ_REGISTER_USHORT((PUSHORT)(header + EC_RING_GEO_ENTRY_SIZE_OFFSET));
+    rxOffset = READ_REGISTER_ULONG((PULONG)(header + EC_RING_GEO_RX_OFFSET_OFFSET));
+    ringSize = READ_REGISTER_ULONG((PULONG)(header + EC_RING_GEO_RING_SIZE_OFFSET));
+    entryOffset = READ_REGISTER_USHORT((PUSHORT)(header + EC_RING_GEO_ENTRY_OFFSET_OFFSET));
+
+    if (magic != EC_RING_GEO_MAGIC || version != EC_RING_GEO_VERSION) {
+        Trace(TRACE_LEVEL_WARNING, TRACE_QUEUE,"No ring geometry header found, using defaults\n");
+        slots = EC_RING_DEFAULT_SLOT_COUNT;
+        entrySize = EC_RING_DEFAULT_ENTRY_SIZE;
+        entryOffset = EC_RING_ENTRY_OFFSET_FOR(EC_RING_DEFAULT_SLOT_COUNT);
+        rxOffset = EC_RING_DEFAULT_RX_OFFSET;
+        ringSize = EC_RING_DEFAULT_RING_SIZE;
+    } else if (slots < EC_RING_SLOT_MIN || slots > EC_RING_SLOT_MAX ||
+               entrySize < EC_RING_ENTRY_MIN || entrySize > EC_RING_ENTRY_MAX ||
+               (entrySize % EC_RING_ENTRY_ALIGN) != 0 ||
+               entryOffset < EC_RING_ENTRY_OFFSET_FOR(slots) ||
+               (ULONG64)entryOffset + (ULONG64)slots * entrySize > ringSize ||
+               (ULONG64)rxOffset + ringSize > regionSize) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Invalid ring geometry slots %u entry 0x%x ring 0x%x\n", slots, entrySize, ringSize);
+        return STATUS_DEVICE_CONFIGURATION_ERROR;
+    }
+
+    DeviceContext->RingSlots = slots;
+    DeviceContext->RingEntrySize = entrySize;
+    DeviceContext->RingEntryOffset = entryOffset;
+    *RxOffset = rxOffset;
+    *RingSize = ringSize;
+
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Ring geometry slots %u entry 0x%x rx 0x%x size 0x%x\n", slots, entrySize, rxOffset, ringSize);
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: NTSTATUS RingInitialize
+ *
+ * Description:
+ * Maps the geometry page and the RX ring of the shared memory region and creates the lock and
+ * fallback timer used to complete sequence waiters. The geometry page stays mapped so event
+ * records can be captured with notifications.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+NTSTATUS
+RingInitialize(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    WDF_OBJECT_ATTRIBUTES attributes;
+    WDF_TIMER_CONFIG timerConfig;
+    PHYSICAL_ADDRESS physicalAddress;
+    ULONG rxOffset = 0;
+    ULONG ringSize = 0;
+    NTSTATUS status;
+
+    deviceContext->RingPollMs = EC_RING_POLL_MIN_MS;
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = Device;
+    status = WdfSpinLockCreate(&attributes, &deviceContext->RingLock);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfSpinLockCreate failed %!STATUS!\n", status);
+        return status;
+    }
+
+    WDF_TIMER_CONFIG_INIT(&timerConfig, RingTimerCallback);
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = Device;
+    status = WdfTimerCreate(&timerConfig, &attributes, &deviceContext->RingTimer);
+    if (!NT_SUCCESS(status)) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"WdfTimerCreate failed %!STATUS!\n", status);
+        return status;
+    }
+
+    physicalAddress.QuadPart = SBSAQEMU_SHARED_MEM_BASE;
+    deviceContext->RingHeader = MmMapIoSpaceEx(physicalAddress, EC_RING_PAGE_SIZE, PAGE_READONLY | PAGE_NOCACHE);
+    if (deviceContext->RingHeader == NULL) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Failed to map ring geometry page\n");
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+    deviceContext->EventGen = READ_REGISTER_ULONG((PULONG)(deviceContext->RingHeader + EC_EVENT_GEN_OFFSET));
+
+    status = RingReadGeometry(deviceContext, &rxOffset, &ringSize);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    physicalAddress.QuadPart = SBSAQEMU_SHARED_MEM_BASE + rxOffset;
+    deviceContext->RxRing = MmMapIoSpaceEx(physicalAddress, ringSize, PAGE_READWRITE | PAGE_NOCACHE);
+    if (deviceContext->RxRing == NULL) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Failed to map RX ring\n");
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+    deviceContext->RxRingSize = ringSize;
+
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: VOID RingUninitialize
+ *
+ * Description:
+ * Unmaps the RX ring and geometry page. Pending waiters have already been cancelled when the
+ * queue was purged.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+RingUninitialize(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+
+    if (deviceContext->RxRing != NULL) {
+        MmUnmapIoSpace(deviceContext->RxRing, deviceContext->RxRingSize);
+        deviceContext->RxRing = NULL;
+    }
+
+    if (deviceContext->RingHeader != NULL) {
+        MmUnmapIoSpace(deviceContext->RingHeader, EC_RING_PAGE_SIZE);
+        deviceContext->RingHeader = NULL;
+    }
+}
+
+/*
+ * Function: BOOLEAN RingTakeSequence
+ *
+ * Description:
+ * Looks for the next fragment of the waiter's sequence number on the RX ring. Each fragment found
+ * is appended to the waiter's output buffer and the slot is released back to the EC so it can post
+ * the following fragment. RingLock must be held.
+ *
+ * Parameters:
+ * DeviceContext - Device context holding the mapped ring.
+ * Waiter - Waiter to fill in, tracks reassembly progress between calls.
+ * BytesReturned - Receives the number of output bytes written once complete.
+ * Status - Receives the completion status once complete.
+ *
+ * Return Value:
+ * TRUE if the last fragment of the message has been received.
+ */
+static BOOLEAN
+RingTakeSequence(
+    PDEVICE_CONTEXT DeviceContext,
+    PRX_WAITER Waiter,
+    size_t *BytesReturned,
+    NTSTATUS *Status
+    )
+{
+    RxSequenceRsp_t *rsp = (RxSequenceRsp_t *)Waiter->Output;
+    size_t maxData = Waiter->OutputSize - RX_SEQUENCE_RSP_HEADER_SIZE;
+    ULONG64 chunk[EC_RING_ENTRY_ALIGN / sizeof(ULONG64)];
+    BOOLEAN found;
+
+    do {
+        found = FALSE;
+        for (ULONG i = 0; i < DeviceContext->RingSlots; i++) {
+            ULONG64 header = READ_REGISTER_ULONG64(RING_SLOT_HEADER(DeviceContext->RxRing, i));
+            if (header == 0 ||
+                EC_SLOT_SEQ(header) != Waiter->Sequence ||
+                EC_SLOT_FRAG(header) != Waiter->NextFragment) {
+                continue;
+            }
+
+            ULONG length = (ULONG)min(EC_SLOT_LEN(header), DeviceContext->RingEntrySize);
+            if (Waiter->NextFragment == 0) {
+                Waiter->Total = (header & EC_SLOT_MORE) ? (ULONG)EC_SLOT_TOTAL(header) : length;
+            }
+
+            // Ring may be mapped as device memory so only use aligned 64-bit accesses, entries can be
+            // up to a page so copy through a small chunk rather than the whole entry on the stack.
+            // Keep draining fragments that do not fit so the EC is not left blocked on the ring
+            for (ULONG offset = 0; offset < length; offset += sizeof(chunk)) {
+                ULONG count = min(length - offset, (ULONG)sizeof(chunk));
+                if (Waiter->Received + offset >= maxData) {
+                    break;
+                }
+                READ_REGISTER_BUFFER_ULONG64(RING_ENTRY(DeviceContext, i) + offset / sizeof(ULONG64), chunk,
+                                             (count + sizeof(ULONG64) - 1) / sizeof(ULONG64));
+                RtlCopyMemory(rsp->data + Waiter->Received + offset, chunk, min(count, maxData - Waiter->Received - offset));
+            }
+            WRITE_REGISTER_ULONG64(RING_SLOT_HEADER(DeviceContext->RxRing, i), 0);
+
+            Waiter->Received += length;
+            Waiter->NextFragment++;
+            found = TRUE;
+
+            if ((header & EC_SLOT_MORE) == 0 || Waiter->NextFragment >= EC_SLOT_FRAG_MAX) {
+                rsp->sequence = Waiter->Sequence;
+                rsp->fragments = Waiter->NextFragment;
+                rsp->total = Waiter->Received;
+                rsp->length = (UINT32)min(Waiter->Received, maxData);
+                *BytesReturned = RX_SEQUENCE_RSP_HEADER_SIZE + rsp->length;
+                *Status = (Waiter->Received > maxData) ? STATUS_BUFFER_OVERFLOW :
+                          (Waiter->Received != Waiter->Total) ? STATUS_DATA_ERROR : STATUS_SUCCESS;
+                return TRUE;
+            }
+        }
+    } while (found);
+
+    return FALSE;
+}
+
+/*
+ * Function: BOOLEAN RingCompleteWaiters
+ *
+ * Description:
+ * Completes every waiter whose sequence number is on the ring or whose deadline has passed.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * TRUE if there are still waiters pending.
+ */
+static BOOLEAN
+RingCompleteWaiters(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    WDFREQUEST done[EC_RING_SLOT_MAX];
+    NTSTATUS doneStatus[EC_RING_SLOT_MAX];
+    size_t doneInfo[EC_RING_SLOT_MAX];
+    ULONG doneCount = 0;
+    BOOLEAN pending = FALSE;
+    ULONGLONG now = KeQueryInterruptTime();
+
+    WdfSpinLockAcquire(deviceContext->RingLock);
+    for (ULONG i = 0; i < deviceContext->RingSlots; i++) {
+        PRX_WAITER waiter = &deviceContext->RxWaiters[i];
+        size_t info = 0;
+
+        if (waiter->Request == NULL) {
+            continue;
+        }
+
+        if (RingTakeSequence(deviceContext, waiter, &info, &doneStatus[doneCount])) {
+            // Status filled in by RingTakeSequence
+        } else if (waiter->Deadline != 0 && now >= waiter->Deadline) {
+            doneStatus[doneCount] = STATUS_IO_TIMEOUT;
+        } else {
+            pending = TRUE;
+            continue;
+        }
+#ifdef EC_TEST_TIMELINE
+        TimelineRecord(Device, TIMELINE_RX_DONE, waiter->Correlation, waiter->Sequence, (ULONG)doneStatus[doneCount]);
+#endif
+
+        done[doneCount] = waiter->Request;
+        doneInfo[doneCount] = info;
+        doneCount++;
+        waiter->Request = NULL;
+    }
+    WdfSpinLockRelease(deviceContext->RingLock);
+
+    // Complete outside the lock, if the request is being cancelled the cancel routine completes it
+    for (ULONG i = 0; i < doneCount; i++) {
+        if (STATUS_CANCELLED != WdfRequestUnmarkCancelable(done[i])) {
+            Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Completing RX waiter 0x%llx with %!STATUS!\n", (UINT64)done[i], doneStatus[i]);
+            WdfRequestCompleteWithInformation(done[i], doneStatus[i], doneInfo[i]);
+        }
+    }
+
+    return pending;
+}
+
+/*
+ * Function: VOID RingCaptureNotification
+ *
+ * Description:
+ * Adds the EC event and payload items from shared memory to a notification response. The event
+ * record is only reported if the EC updated it since the last notification, and is dropped if
+ * the EC keeps rewriting it while it is being copied. The RX slot headers are a snapshot and
+ * are not consumed, sequence waiters still take the entries.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Rsp - Notification response with the extended header zeroed.
+ * PayloadSize - Bytes available at Rsp->payload.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+RingCaptureNotification(
+    WDFDEVICE Device,
+    NotificationRsp_t *Rsp,
+    size_t PayloadSize
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    UCHAR data[EC_EVENT_DATA_MAX];
+    ULONG64 headers[EC_RING_SLOT_MAX];
+    ULONG gen, id, length, i;
+
+    if (deviceContext->RingHeader == NULL) {
+        return;
+    }
+
+    for (i = 0; i < EC_EVENT_READ_RETRIES; i++) {
+        gen = READ_REGISTER_ULONG((PULONG)(deviceContext->RingHeader + EC_EVENT_GEN_OFFSET));
+        if ((gen & 1) != 0) {
+            continue;
+        }
+        if (gen == deviceContext->EventGen) {
+            break;
+        }
+
+        id = READ_REGISTER_ULONG((PULONG)(deviceContext->RingHeader + EC_EVENT_ID_OFFSET));
+        length = READ_REGISTER_ULONG((PULONG)(deviceContext->RingHeader + EC_EVENT_LENGTH_OFFSET));
+        length = min(length, EC_EVENT_DATA_MAX);
+        READ_REGISTER_BUFFER_UCHAR(deviceContext->RingHeader + EC_EVENT_DATA_OFFSET, data, length);
+
+        KeMemoryBarrier();
+        if (READ_REGISTER_ULONG((PULONG)(deviceContext->RingHeader + EC_EVENT_GEN_OFFSET)) == gen) {
+            deviceContext->EventGen = gen;
+            Rsp->ecevent = id;
+            NotifyPutItem(Rsp, PayloadSize, NOTIFY_PAYLOAD_EVENT_DATA, data, (USHORT)length);
+            break;
+        }
+    }
+
+    if (deviceContext->RxRing != NULL) {
+        for (i = 0; i < deviceContext->RingSlots; i++) {
+            headers[i] = READ_REGISTER_ULONG64(RING_SLOT_HEADER(deviceContext->RxRing, i));
+        }
+        NotifyPutItem(Rsp, PayloadSize, NOTIFY_PAYLOAD_RX_HEADERS, headers, (USHORT)(deviceContext->RingSlots * sizeof(ULONG64)));
+    }
+}
+
+/*
+ * Function: VOID RingDoorbell
+ *
+ * Description:
+ * Called from the notification callback when the EC rings the RX doorbell.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+RingDoorbell(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+
+    if (deviceContext->RxRing != NULL) {
+        RingCompleteWaiters(Device);
+    }
+}
+
+/*
+ * Function: VOID RingTimerCallback
+ *
+ * Description:
+ * Fallback poll of the RX ring. Interval doubles every time it fires with waiters still pending
+ * so a working doorbell costs almost nothing and a lost one still completes eventually.
+ *
+ * Parameters:
+ * Timer - The Timer object.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+RingTimerCallback(
+    WDFTIMER Timer
+    )
+{
+    WDFDEVICE device = WdfTimerGetParentObject(Timer);
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(device);
+    ULONG pollMs;
+
+    if (RingCompleteWaiters(device)) {
+        WdfSpinLockAcquire(deviceContext->RingLock);
+        deviceContext->RingPollMs = min(deviceContext->RingPollMs * 2, EC_RING_POLL_MAX_MS);
+        pollMs = deviceContext->RingPollMs;
+        WdfSpinLockRelease(deviceContext->RingLock);
+
+        WdfTimerStart(Timer, WDF_REL_TIMEOUT_IN_MS(pollMs));
+    }
+}
+
+/*
+ * Function: VOID RingEvtRequestCancel
+ *
+ * Description:
+ * Removes a cancelled request from the waiter list and completes it.
+ *
+ * Parameters:
+ * Request - The WDFREQUEST object representing the request.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+RingEvtRequestCancel(
+    WDFREQUEST Request
+    )
+{
+    WDFDEVICE device = WdfIoQueueGetDevice(WdfRequestGetIoQueue(Request));
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(device);
+
+    WdfSpinLockAcquire(deviceContext->RingLock);
+    for (ULONG i = 0; i < deviceContext->RingSlots; i++) {
+        if (deviceContext->RxWaiters[i].Request == Request) {
+            deviceContext->RxWaiters[i].Request = NULL;
+            break;
+        }
+    }
+    WdfSpinLockRelease(deviceContext->RingLock);
+
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"Completing RX waiter 0x%llx with STATUS_CANCELLED\n", (UINT64)Request);
+    WdfRequestComplete(Request, STATUS_CANCELLED);
+}
+
+/*
+ * Function: NTSTATUS RingWaitSequence
+ *
+ * Description:
+ * Handles IOCTL_WAIT_RX_SEQUENCE. Completes right away if the response is already on the ring,
+ * otherwise pends the request until the doorbell or fallback timer finds it.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object representing the request.
+ *
+ * Return Value:
+ * STATUS_PENDING if the driver owns the request, otherwise an error to complete it with.
+ */
+NTSTATUS
+RingWaitSequence(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    RxSequenceReq_t *req = NULL;
+    RX_WAITER waiter = {0};
+    size_t size = 0;
+    size_t info = 0;
+    NTSTATUS status;
+    NTSTATUS takeStatus;
+
+    if (deviceContext->RxRing == NULL) {
+        return STATUS_DEVICE_NOT_READY;
+    }
+
+    status = WdfRequestRetrieveInputBuffer(Request, RX_SEQUENCE_REQ_LEGACY_SIZE, &req, &size);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    status = WdfRequestRetrieveOutputBuffer(Request, RX_SEQUENCE_RSP_HEADER_SIZE, &waiter.Output, &waiter.OutputSize);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    // Sequence 0 marks a free slot so it can never be waited on
+    if (req->sequence == 0) {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    waiter.Request = Request;
+    waiter.Sequence = req->sequence;
+    if (req->timeout != 0) {
+        waiter.Deadline = KeQueryInterruptTime() + (ULONGLONG)req->timeout * 10000;
+    }
+#ifdef EC_TEST_TIMELINE
+    waiter.Correlation = TimelineCorrelation(Device, size >= sizeof(RxSequenceReq_t) ? req->correlation : 0);
+    TimelineRecord(Device, TIMELINE_RX_WAIT, waiter.Correlation, waiter.Sequence, 0);
+#endif
+
+    WdfSpinLockAcquire(deviceContext->RingLock);
+    if (RingTakeSequence(deviceContext, &waiter, &info, &takeStatus)) {
+        WdfSpinLockRelease(deviceContext->RingLock);
+#ifdef EC_TEST_TIMELINE
+        TimelineRecord(Device, TIMELINE_RX_DONE, waiter.Correlation, waiter.Sequence, (ULONG)takeStatus);
+#endif
+        WdfRequestCompleteWithInformation(Request, takeStatus, info);
+        return STATUS_PENDING;
+    }
+
+    for (ULONG i = 0; i < deviceContext->RingSlots; i++) {
+        if (deviceContext->RxWaiters[i].Request != NULL) {
+            continue;
+        }
+
+        // Mark cancelable under the lock so the cancel routine always finds the waiter
+        status = WdfRequestMarkCancelableEx(Request, RingEvtRequestCancel);
+        if (NT_SUCCESS(status)) {
+            deviceContext->RxWaiters[i] = waiter;
+            deviceContext->RingPollMs = EC_RING_POLL_MIN_MS;
+        }
+        WdfSpinLockRelease(deviceContext->RingLock);
+
+        if (NT_SUCCESS(status)) {
+            Trace(TRACE_LEVEL_INFORMATION, TRACE_QUEUE,"RX waiter 0x%llx pended for sequence %u\n", (UINT64)Request, waiter.Sequence);
+            WdfTimerStart(deviceContext->RingTimer, WDF_REL_TIMEOUT_IN_MS(EC_RING_POLL_MIN_MS));
+            status = STATUS_PENDING;
+        }
+        return status;
+    }
+    WdfSpinLockRelease(deviceContext->RingLock);
+
+    // No more waiters than ring slots
+    return STATUS_DEVICE_BUSY;
+}
+
+#endif // EC_TEST_DOORBELL
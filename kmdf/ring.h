@@ -0,0 +1,45 @@
+/*++
+Module Name:
+    ring.h
+
+Abstract:
+    Host side consumer of the shared memory RX ring that the EC service
+    posts async responses to.
+--*/
+
+#include "..\inc\ectest.h"
+
+#ifdef EC_TEST_DOORBELL
+
+NTSTATUS
+RingInitialize(
+    WDFDEVICE Device
+    );
+
+VOID
+RingUninitialize(
+    WDFDEVICE Device
+    );
+
+NTSTATUS
+RingWaitSequence(
+    WDFDEVICE Device,
+    WDFREQUEST Request
+    );
+
+VOID
+RingDoorbell(
+    WDFDEVICE Device
+    );
+
+VOID
+RingCaptureNotification(
+    WDFDEVICE Device,
+    NotificationRsp_t *Rsp,
+    size_t PayloadSize
+    );
+
+EVT_WDF_TIMER RingTimerCallback;
+EVT_WDF_REQUEST_CANCEL RingEvtRequestCancel;
+
+#endif // EC_TEST_DOORBELL
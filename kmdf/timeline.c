@@ -0,0 +1,303 @@
+/*++
+Module Name:
+    timeline.c
+
+Abstract:
+    Records a timestamped event at every step of a request through the
+    driver, queued, picked up by the work item, sent to ACPI, completed,
+    waiting on and taken from the RX ring, and every notification, so the
+    app can line them up with its own calls. Events go into a ring that is
+    written without a lock from any IRQL, each slot is published with its
+    stream position, so recording costs an interlocked increment and a
+    few stores and readers detect slots that were overwritten under them.
+    Nothing is recorded until a reader enables capture.
+
+Environment:
+    Kernel-mode only
+
+--*/
+
+#include "driver.h"
+#include <acpiioct.h>
+#include "..\inc\ectest.h"
+#include "trace.h"
+#include "timeline.tmh"
+
+#ifdef EC_TEST_TIMELINE
+
+#define TIMELINE_POOL_TAG       'lmiT'
+
+/*
+ * Function: NTSTATUS TimelineInitialize
+ *
+ * Description:
+ * Allocates the event ring, capture starts disabled.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * NTSTATUS status code, on failure IOCTL_TIMELINE_READ is not supported.
+ */
+NTSTATUS
+TimelineInitialize(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+
+    deviceContext->TimelineHead = 0;
+    deviceContext->TimelineEnabled = 0;
+    deviceContext->TimelineNext = 0;
+
+    // Zeroed so no slot looks published before it is written
+    deviceContext->Timeline = ExAllocatePool2(POOL_FLAG_NON_PAGED,
+                                              TIMELINE_EVENT_COUNT * sizeof(TIMELINE_SLOT),
+                                              TIMELINE_POOL_TAG);
+    if (deviceContext->Timeline == NULL) {
+        Trace(TRACE_LEVEL_ERROR, TRACE_QUEUE,"Failed to allocate timeline ring\n");
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Function: VOID TimelineUninitialize
+ *
+ * Description:
+ * Frees the event ring, the queues are already stopped so nothing records into it.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+TimelineUninitialize(
+    WDFDEVICE Device
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+
+    deviceContext->TimelineEnabled = 0;
+    if (deviceContext->Timeline != NULL) {
+        ExFreePoolWithTag(deviceContext->Timeline, TIMELINE_POOL_TAG);
+        deviceContext->Timeline = NULL;
+    }
+}
+
+/*
+ * Function: ULONG TimelineCorrelation
+ *
+ * Description:
+ * Returns the correlation ID to record a request with. Requests from apps that did not pass one
+ * get the next driver ID while capture is enabled.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Correlation - ID the app passed, 0 for none.
+ *
+ * Return Value:
+ * Correlation ID, 0 if there was none and capture is disabled.
+ */
+ULONG
+TimelineCorrelation(
+    WDFDEVICE Device,
+    ULONG Correlation
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+
+    if (Correlation != 0 || ReadNoFence(&deviceContext->TimelineEnabled) == 0) {
+        return Correlation;
+    }
+    return TIMELINE_CORRELATION_DRIVER | ((ULONG)InterlockedIncrement(&deviceContext->TimelineNext) & ~TIMELINE_CORRELATION_DRIVER);
+}
+
+/*
+ * Function: VOID TimelineRecord
+ *
+ * Description:
+ * Appends an event to the ring if capture is enabled. Callable at any IRQL up to DISPATCH_LEVEL
+ * and with spin locks held. The slot is marked unpublished while it is written so a reader never
+ * copies half an event.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Kind - TIMELINE_* event.
+ * Correlation - Correlation ID of the request, 0 if none.
+ * Sequence - RX ring sequence number, 0 if none.
+ * Value - Depends on Kind, see ectest.h.
+ *
+ * Return Value:
+ * VOID
+ */
+VOID
+TimelineRecord(
+    WDFDEVICE Device,
+    USHORT Kind,
+    ULONG Correlation,
+    USHORT Sequence,
+    ULONG Value
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    PTIMELINE_SLOT slot;
+    LONG64 position;
+
+    if (deviceContext->Timeline == NULL || ReadNoFence(&deviceContext->TimelineEnabled) == 0) {
+        return;
+    }
+
+    position = InterlockedIncrement64(&deviceContext->TimelineHead) - 1;
+    slot = &deviceContext->Timeline[position & (TIMELINE_EVENT_COUNT - 1)];
+
+    InterlockedExchange64(&slot->Position, 0);
+    slot->Event.time = (UINT64)KeQueryPerformanceCounter(NULL).QuadPart;
+    slot->Event.correlation = Correlation;
+    slot->Event.kind = Kind;
+    slot->Event.sequence = Sequence;
+    slot->Event.value = Value;
+    slot->Event.reserved = 0;
+    WriteRelease64(&slot->Position, position + 1);
+}
+
+/*
+ * Function: USHORT TimelineSequence
+ *
+ * Description:
+ * Returns the result of an evaluation that returned a single integer that fits a sequence number,
+ * which is how ASYQ returns the RX ring sequence of the request it queued. The app can then
+ * match the evaluation to the RX wait on that sequence.
+ *
+ * Parameters:
+ * Output - ACPI_EVAL_OUTPUT_BUFFER_V1 returned by ACPI.
+ * Length - Bytes returned.
+ *
+ * Return Value:
+ * Sequence number, 0 if the result is not a single 16-bit integer.
+ */
+USHORT
+TimelineSequence(
+    PVOID Output,
+    size_t Length
+    )
+{
+    PACPI_EVAL_OUTPUT_BUFFER_V1 output = (PACPI_EVAL_OUTPUT_BUFFER_V1)Output;
+
+    if (Output == NULL ||
+        Length < FIELD_OFFSET(ACPI_EVAL_OUTPUT_BUFFER_V1, Argument) + FIELD_OFFSET(ACPI_METHOD_ARGUMENT_V1, Data) + sizeof(ULONG) ||
+        output->Signature != ACPI_EVAL_OUTPUT_BUFFER_SIGNATURE_V1 ||
+        output->Count != 1 ||
+        output->Argument[0].Type != ACPI_METHOD_ARGUMENT_INTEGER ||
+        output->Argument[0].Argument > MAXUSHORT) {
+        return 0;
+    }
+    return (USHORT)output->Argument[0].Argument;
+}
+
+/*
+ * Function: NTSTATUS TimelineRead
+ *
+ * Description:
+ * Handles IOCTL_TIMELINE_READ. Copies the events from the cursor on that fit in the output
+ * buffer, stopping at a slot that is still being written. Events overwritten before or while
+ * they were copied are counted as lost. Never waits.
+ *
+ * Parameters:
+ * Device - The WDFDEVICE object representing the device.
+ * Request - The WDFREQUEST object holding a TimelineReadReq_t.
+ * BytesReturned - Receives the number of output bytes written.
+ *
+ * Return Value:
+ * NTSTATUS status code indicating the success or failure of the operation.
+ */
+NTSTATUS
+TimelineRead(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    size_t *BytesReturned
+    )
+{
+    PDEVICE_CONTEXT deviceContext = DeviceContextGet(Device);
+    TimelineReadReq_t *req = NULL;
+    TimelineReadRsp_t *rsp = NULL;
+    size_t rspSize = 0;
+    PTIMELINE_SLOT slot;
+    LARGE_INTEGER frequency;
+    LONG64 head, cursor, seen;
+    ULONG64 lost = 0;
+    ULONG maxEvents, count = 0;
+    ULONG flags;
+    NTSTATUS status;
+
+    if (deviceContext->Timeline == NULL) {
+        return STATUS_DEVICE_NOT_READY;
+    }
+
+    status = WdfRequestRetrieveInputBuffer(Request, sizeof(TimelineReadReq_t), &req, NULL);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    status = WdfRequestRetrieveOutputBuffer(Request, TIMELINE_READ_RSP_HEADER_SIZE, &rsp, &rspSize);
+    if (!NT_SUCCESS(status)) {
+        return status;
+    }
+
+    // Input and output share the system buffer
+    flags = req->flags;
+    cursor = (LONG64)req->cursor;
+
+    if (flags & TIMELINE_READ_ENABLE) {
+        InterlockedExchange(&deviceContext->TimelineEnabled, 1);
+    }
+
+    head = ReadAcquire64(&deviceContext->TimelineHead);
+    if ((flags & TIMELINE_READ_NEWEST) || cursor > head) {
+        cursor = head;
+    }
+    if (head - cursor > TIMELINE_EVENT_COUNT) {
+        lost += (ULONG64)(head - TIMELINE_EVENT_COUNT - cursor);
+        cursor = head - TIMELINE_EVENT_COUNT;
+    }
+
+    maxEvents = (ULONG)((rspSize - TIMELINE_READ_RSP_HEADER_SIZE) / sizeof(TimelineEvent_t));
+    while (cursor < head && count < maxEvents) {
+        slot = &deviceContext->Timeline[cursor & (TIMELINE_EVENT_COUNT - 1)];
+        seen = ReadAcquire64(&slot->Position);
+        if (seen == cursor + 1) {
+            rsp->events[count] = slot->Event;
+            KeMemoryBarrier();
+            if (ReadNoFence64(&slot->Position) == cursor + 1) {
+                count++;
+            } else {
+                lost++;
+            }
+        } else if (seen > cursor + 1) {
+            lost++;
+        } else {
+            // Writer has the position but has not published the event yet
+            break;
+        }
+        cursor++;
+    }
+
+    if (flags & TIMELINE_READ_DISABLE) {
+        InterlockedExchange(&deviceContext->TimelineEnabled, 0);
+    }
+
+    KeQueryPerformanceCounter(&frequency);
+    rsp->cursor = (UINT64)cursor;
+    rsp->lost = lost;
+    rsp->frequency = (UINT64)frequency.QuadPart;
+    rsp->count = count;
+    rsp->reserved = 0;
+
+    *BytesReturned = TIMELINE_READ_RSP_HEADER_SIZE + count * sizeof(TimelineEvent_t);
+    return STATUS_SUCCESS;
+}
+
+#endif // EC_TEST_TIMELINE
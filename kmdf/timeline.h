@@ -0,0 +1,50 @@
+/*++
+Module Name:
+    timeline.h
+
+Abstract:
+    Timestamped events of requests going through the driver, read with
+    IOCTL_TIMELINE_READ.
+--*/
+
+#ifdef EC_TEST_TIMELINE
+
+NTSTATUS
+TimelineInitialize(
+    WDFDEVICE Device
+    );
+
+VOID
+TimelineUninitialize(
+    WDFDEVICE Device
+    );
+
+ULONG
+TimelineCorrelation(
+    WDFDEVICE Device,
+    ULONG Correlation
+    );
+
+VOID
+TimelineRecord(
+    WDFDEVICE Device,
+    USHORT Kind,
+    ULONG Correlation,
+    USHORT Sequence,
+    ULONG Value
+    );
+
+USHORT
+TimelineSequence(
+    PVOID Output,
+    size_t Length
+    );
+
+NTSTATUS
+TimelineRead(
+    WDFDEVICE Device,
+    WDFREQUEST Request,
+    size_t *BytesReturned
+    );
+
+#endif // EC_TEST_TIMELINE
@@ -33,14 +33,20 @@ SOFTWARE.
 #include <Devpkey.h>
 #include <Acpiioct.h>
 #include <devioctl.h>
-#include "..\inc\eclib.h"
+#include <memory>
+#include <random>
 #include "..\inc\ectest.h"
+#include "..\inc\ecsvc.h"
+#include "..\inc\ecring.h"
+#include "..\inc\acpiview.h"
+#include "..\inc\acpireq.h"
+#include "..\inc\ecmethods.h"
+#include "..\inc\eclib.h"
+#include "internal.h"
 
 #include <wil/resource.h>
 #include <wil/result.h>
 
-#define MAX_DEVPATH_LENGTH  64
-
 // GUID defined in the KMDF INX file for ectest.sys
 // {5362ad97-ddfe-429d-9305-31c0ad27880a}
 const GUID GUID_DEVCLASS_ECTEST = { 0x5362ad97, 0xddfe, 0x429d, { 0x93, 0x05, 0x31, 0xc0, 0xad, 0x27, 0x88, 0x0a } };
@@ -52,10 +58,18 @@ typedef struct {
     BOOL initialized;
     UINT32 event;
     HANDLE handle;
+    BYTE response[NOTIFICATION_RSP_MAX_SIZE];   // Last response from the driver
+    DWORD response_len;
+    PrefetchResult_t prefetch[PREFETCH_RULE_MAX];   // Evaluations prefetched for the last response
+    UINT32 prefetch_count;
 } NotificationState;
 
 static NotificationState g_notify;
 
+// Retries of evaluations rejected by driver admission control, see SetEvalRetryPolicy
+static UINT32 g_retry_attempts = 4;
+static UINT32 g_retry_max_ms = 200;
+
 /*
  * Function: GetGUIDPath
  * ---------------------
@@ -171,6 +185,135 @@ int GetKMDFDriverHandle(
     return status;
 }
 
+/*
+ * Function: EvaluateWithBackoff
+ * -----------------------------
+ * Sends an evaluation IOCTL and retries it while the driver rejects it with ERROR_BUSY. The
+ * delay starts at the hint the driver returns in the output buffer, doubles on every attempt up
+ * to the policy maximum, and a random half of it is dropped so clients rejected together do not
+ * come back together.
+ *
+ * Parameters:
+ *   HANDLE hDevice     - Handle to the KMDF driver.
+ *   DWORD ioctl        - IOCTL_ACPI_EVAL_METHOD_EX or IOCTL_ACPI_EVAL_PRIORITY.
+ *   void* input        - Request input buffer.
+ *   size_t input_len   - Length of the input buffer.
+ *   BYTE* buffer       - Output buffer for the result.
+ *   size_t* buf_len    - Input: size of buffer; Output: bytes returned.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, ERROR_BUSY if still rejected after the last attempt, or
+ *         another error code on failure.
+ */
+static int EvaluateWithBackoff(
+    _In_ HANDLE hDevice,
+    _In_ DWORD ioctl,
+    _In_ void* input,
+    _In_ size_t input_len,
+    _Out_ BYTE* buffer,
+    _Inout_ size_t* buf_len
+)
+{
+    thread_local std::minstd_rand jitter(GetCurrentThreadId() ^ GetTickCount());
+    ULONG bytesReturned = 0;
+
+    for (UINT32 attempt = 0; ; attempt++) {
+        bytesReturned = 0;
+        if (DeviceIoControl(
+            hDevice,
+            ioctl,
+            input,
+            static_cast<DWORD>(input_len),
+            buffer,
+            static_cast<DWORD>(*buf_len),
+            &bytesReturned,
+            nullptr)) {
+            *buf_len = bytesReturned;
+            return ERROR_SUCCESS;
+        }
+
+        DWORD error = GetLastError();
+        if (error != ERROR_BUSY || attempt >= g_retry_attempts) {
+            return static_cast<int>(error);
+        }
+
+        // Output buffers too small for the hint fall back to the policy maximum
+        UINT32 delay = g_retry_max_ms;
+        auto* retry = reinterpret_cast<AdmissionRetry_t*>(buffer);
+        if (bytesReturned >= sizeof(AdmissionRetry_t) && retry->signature == ADMISSION_RETRY_SIGNATURE) {
+            delay = static_cast<UINT32>(min(static_cast<UINT64>(max(retry->retryms, 1u)) << min(attempt, 16u),
+                                            static_cast<UINT64>(g_retry_max_ms)));
+        }
+        Sleep(delay / 2 + jitter() % (delay / 2 + 1));
+    }
+}
+
+/*
+ * Function: SetEvalRetryPolicy
+ * ----------------------------
+ * Sets how EvaluateAcpi and EvaluateAcpiPriority retry evaluations the driver rejects because
+ * of its admission limits. Applies to the whole process.
+ *
+ * Parameters:
+ *   UINT32 attempts    - Retries after the first rejection, 0 returns ERROR_BUSY at once.
+ *   UINT32 max_delay_ms- Longest delay between attempts.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS.
+ */
+ECLIB_API
+int SetEvalRetryPolicy(
+    _In_ UINT32 attempts,
+    _In_ UINT32 max_delay_ms
+)
+{
+    g_retry_attempts = attempts;
+    g_retry_max_ms = max_delay_ms;
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: EvaluatePriority
+ * --------------------------
+ * Sends an evaluation with IOCTL_ACPI_EVAL_PRIORITY, the ACPI input after an EvalPriorityReq_t.
+ *
+ * Parameters:
+ *   HANDLE hDevice       - Handle to the KMDF driver.
+ *   UINT32 priority      - EVAL_PRIORITY_* class.
+ *   UINT32 correlation   - Trace correlation ID, 0 if not tracing.
+ *   void* acpi_input     - Pointer to ACPI_EVAL_INPUT_xxxx structure.
+ *   size_t input_len     - Length of the input structure.
+ *   BYTE* buffer         - Output buffer for the result.
+ *   size_t* buf_len      - Input: size of buffer; Output: bytes returned.
+ *
+ * Returns:
+ *   int - As EvaluateWithBackoff.
+ */
+static int EvaluatePriority(
+    _In_ HANDLE hDevice,
+    _In_ UINT32 priority,
+    _In_ UINT32 correlation,
+    _In_ void* acpi_input,
+    _In_ size_t input_len,
+    _Out_ BYTE* buffer,
+    _Inout_ size_t* buf_len
+)
+{
+    size_t req_len = EVAL_PRIORITY_REQ_HEADER_SIZE + input_len;
+    std::unique_ptr<BYTE[]> req_buf(new BYTE[req_len]);
+    auto* req = reinterpret_cast<EvalPriorityReq_t*>(req_buf.get());
+
+    req->priority = priority;
+    req->correlation = correlation;
+    memcpy(req->input, acpi_input, input_len);
+    return EvaluateWithBackoff(hDevice,
+                               static_cast<DWORD>(IOCTL_ACPI_EVAL_PRIORITY),
+                               req,
+                               req_len,
+                               buffer,
+                               buf_len);
+}
+
 /*
  * Function: EvaluateAcpi
  * ----------------------
@@ -183,7 +326,8 @@ int GetKMDFDriverHandle(
  *   size_t* buf_len    - Input: size of buffer; Output: bytes returned.
  *
  * Returns:
- *   int - ERROR_SUCCESS on success, ERROR_INVALID_PARAMETER on failure.
+ *   int - ERROR_SUCCESS on success, ERROR_INVALID_PARAMETER on failure, ERROR_BUSY if the
+ *         driver is over its admission limits after all retries.
  */
 ECLIB_API
 int EvaluateAcpi(
@@ -194,7 +338,6 @@ int EvaluateAcpi(
 )
 {
     WCHAR pathbuf[MAX_DEVPATH_LENGTH];
-    ULONG bytesReturned;
 
     // Look up handle to ACPI entry
     wchar_t* dpath = GetGUIDPath(GUID_DEVCLASS_ECTEST, L"ETST0001", pathbuf, sizeof(pathbuf));
@@ -211,20 +354,286 @@ int EvaluateAcpi(
         NULL));
 
     RETURN_LAST_ERROR_IF(!hDevice.is_valid());
-    RETURN_IF_WIN32_BOOL_FALSE(DeviceIoControl(
-        hDevice.get(),
-        static_cast<DWORD>(IOCTL_ACPI_EVAL_METHOD_EX),
-        acpi_input,
-        static_cast<DWORD>(input_len),
-        buffer,
-        static_cast<DWORD>(*buf_len),
-        &bytesReturned,
-        nullptr));
 
-    *buf_len = bytesReturned;
+    AcpiMethodInfo_t* info;
+    int status = CheckAcpiMethod(acpi_input, input_len, &info);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+
+    size_t capacity = *buf_len;
+    UINT64 started = RecordClock();
+    UINT32 correlation = TraceBeginEval(acpi_input, input_len);
+    void* input = acpi_input;
+    size_t length = input_len;
+    std::unique_ptr<BYTE[]> traced;
+    if (correlation != 0) {
+        // Same IOCTL as untraced calls, the ID rides in a trailer the driver strips
+        EvalCorrelation_t trailer = { correlation, EVAL_CORRELATION_SIGNATURE };
+        length = input_len + sizeof(trailer);
+        traced.reset(new BYTE[length]);
+        memcpy(traced.get(), acpi_input, input_len);
+        memcpy(traced.get() + input_len, &trailer, sizeof(trailer));
+        input = traced.get();
+    }
+    status = EvaluateWithBackoff(hDevice.get(),
+                                 static_cast<DWORD>(IOCTL_ACPI_EVAL_METHOD_EX),
+                                 input,
+                                 length,
+                                 buffer,
+                                 buf_len);
+    TraceEnd(correlation, status);
+    if (started != 0) {
+        RecordEval(started, UINT32_MAX, acpi_input, input_len, status, capacity, buffer, *buf_len);
+    }
+    RecordAcpiOutput(info, status, buffer, *buf_len);
+    return status;
+}
+
+/*
+ * Function: AcpiOutputArgs
+ * ------------------------
+ * Checks an ACPI_EVAL_OUTPUT_BUFFER_V1, including every nested package, and returns the list of
+ * its arguments. Arguments point into buffer, which must stay valid while the list is used.
+ *
+ * Parameters:
+ *   const BYTE* buffer   - Output of EvaluateAcpi.
+ *   size_t length        - Bytes returned in buffer.
+ *   AcpiArgList_t* list  - Receives the arguments, walk them with AcpiArgNext.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, ERROR_INVALID_DATA if any argument is out of bounds or malformed.
+ */
+ECLIB_API
+int AcpiOutputArgs(
+    _In_reads_bytes_(length) const BYTE* buffer,
+    _In_ size_t length,
+    _Out_ AcpiArgList_t* list
+)
+{
+    acpiview::ArgList args;
+
+    if (list == nullptr) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    if (!acpiview::Parse(buffer, length, args)) {
+        *list = {};
+        return ERROR_INVALID_DATA;
+    }
+
+    *list = args.Raw();
     return ERROR_SUCCESS;
 }
 
+/*
+ * Function: AcpiArgNext
+ * ---------------------
+ * Takes the next argument off a list returned by AcpiOutputArgs or AcpiArgPackage.
+ *
+ * Parameters:
+ *   AcpiArgList_t* list  - List to advance.
+ *   AcpiArg_t* arg       - Receives the argument.
+ *
+ * Returns:
+ *   BOOL - FALSE once every argument has been returned.
+ */
+ECLIB_API
+BOOL AcpiArgNext(
+    _Inout_ AcpiArgList_t* list,
+    _Out_ AcpiArg_t* arg
+)
+{
+    acpiview::ArgList args(*list);
+    acpiview::Arg next;
+
+    if (!args.Next(next)) {
+        return FALSE;
+    }
+
+    *list = args.Raw();
+    *arg = next.Raw();
+    return TRUE;
+}
+
+/*
+ * Function: AcpiArgInteger
+ * ------------------------
+ * Value of an integer argument, 32 and 64 bit integers are both returned as UINT64.
+ *
+ * Parameters:
+ *   const AcpiArg_t* arg - Argument from AcpiArgNext.
+ *
+ * Returns:
+ *   UINT64 - Value, 0 if the argument is not an integer.
+ */
+ECLIB_API
+UINT64 AcpiArgInteger(
+    _In_ const AcpiArg_t* arg
+)
+{
+    return acpiview::Arg(*arg).Integer();
+}
+
+/*
+ * Function: AcpiArgPackage
+ * ------------------------
+ * Returns the elements of a package argument. The package was checked with its output buffer
+ * so this only counts the elements.
+ *
+ * Parameters:
+ *   const AcpiArg_t* arg - Argument from AcpiArgNext.
+ *   AcpiArgList_t* list  - Receives the elements.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, ERROR_INVALID_DATA if the argument is not a package.
+ */
+ECLIB_API
+int AcpiArgPackage(
+    _In_ const AcpiArg_t* arg,
+    _Out_ AcpiArgList_t* list
+)
+{
+    acpiview::Arg package(*arg);
+
+    *list = package.Package().Raw();
+    return package.IsPackage() ? ERROR_SUCCESS : ERROR_INVALID_DATA;
+}
+
+/*
+ * Function: AcpiRequestBegin
+ * --------------------------
+ * Starts building an ACPI_EVAL_INPUT_BUFFER_COMPLEX_V1_EX in arena. The arena can be reused for
+ * the next request once the previous one has been evaluated.
+ *
+ * Parameters:
+ *   AcpiRequest_t* req   - Builder state.
+ *   BYTE* arena          - Memory the request is written to, may be NULL to only size it.
+ *   size_t capacity      - Bytes at arena.
+ *   const char* method   - Full path of the method, e.g. \_SB.SKIN.THRS.
+ */
+ECLIB_API
+VOID AcpiRequestBegin(
+    _Out_ AcpiRequest_t* req,
+    _Out_writes_bytes_opt_(capacity) BYTE* arena,
+    _In_ size_t capacity,
+    _In_ const char* method
+)
+{
+    acpireq::Begin(*req, arena, capacity, method);
+}
+
+/*
+ * Function: AcpiRequestInteger
+ * ----------------------------
+ * Appends a DWORD integer to the request or to the innermost open package.
+ */
+ECLIB_API
+VOID AcpiRequestInteger(
+    _Inout_ AcpiRequest_t* req,
+    _In_ UINT32 value
+)
+{
+    acpireq::Integer(*req, value);
+}
+
+/*
+ * Function: AcpiRequestString
+ * ---------------------------
+ * Appends a NUL terminated string to the request or to the innermost open package.
+ */
+ECLIB_API
+VOID AcpiRequestString(
+    _Inout_ AcpiRequest_t* req,
+    _In_ const char* value
+)
+{
+    if (value == nullptr) {
+        req->status = ACPI_REQ_INVALID;
+        return;
+    }
+    acpireq::String(*req, value);
+}
+
+/*
+ * Function: AcpiRequestBuffer
+ * ---------------------------
+ * Appends a buffer, e.g. a UUID, to the request or to the innermost open package.
+ */
+ECLIB_API
+VOID AcpiRequestBuffer(
+    _Inout_ AcpiRequest_t* req,
+    _In_reads_bytes_(length) const void* data,
+    _In_ size_t length
+)
+{
+    acpireq::Buffer(*req, data, length);
+}
+
+/*
+ * Function: AcpiRequestPackage
+ * ----------------------------
+ * Opens a package, arguments appended until AcpiRequestEndPackage are its elements. Packages
+ * nest up to ACPI_VIEW_MAX_DEPTH deep.
+ */
+ECLIB_API
+VOID AcpiRequestPackage(
+    _Inout_ AcpiRequest_t* req
+)
+{
+    acpireq::BeginPackage(*req);
+}
+
+/*
+ * Function: AcpiRequestEndPackage
+ * -------------------------------
+ * Closes the innermost open package.
+ */
+ECLIB_API
+VOID AcpiRequestEndPackage(
+    _Inout_ AcpiRequest_t* req
+)
+{
+    acpireq::EndPackage(*req);
+}
+
+/*
+ * Function: AcpiRequestEnd
+ * ------------------------
+ * Completes the request header. The arena then holds the input to pass to EvaluateAcpi.
+ *
+ * Parameters:
+ *   AcpiRequest_t* req   - Builder state.
+ *   size_t* length       - Receives the bytes of the request, or the arena size needed to build it
+ *                          when ERROR_INSUFFICIENT_BUFFER is returned.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, ERROR_INSUFFICIENT_BUFFER if the arena is too small, or
+ *         ERROR_INVALID_PARAMETER if packages are unbalanced, nested too deep, an argument is
+ *         too long or there are more than ACPI_REQ_MAX_ARGS arguments.
+ */
+ECLIB_API
+int AcpiRequestEnd(
+    _Inout_ AcpiRequest_t* req,
+    _Out_opt_ size_t* length
+)
+{
+    UINT32 status = acpireq::End(*req);
+
+    if (length != nullptr) {
+        *length = req->length;
+    }
+
+    switch (status) {
+    case ACPI_REQ_OK:
+        return ERROR_SUCCESS;
+    case ACPI_REQ_NO_SPACE:
+        return ERROR_INSUFFICIENT_BUFFER;
+    default:
+        return ERROR_INVALID_PARAMETER;
+    }
+}
+
 /*
  * Function: InitializeNotification
  * -------------------------------
@@ -293,23 +702,27 @@ VOID CleanupNotification()
 }
 
 /*
- * Function: WaitForNotification
- * -----------------------------
- * Waits for a notification event from the KMDF driver. If event is 0, waits for any event.
- *
- * Parameters:
- *   UINT32 event - The event code to wait for (0 for any event).
+ * Function: WaitForNotificationShared
+ * -----------------------------------
+ * Waits for a notification from the KMDF driver. Only the first caller sends
+ * IOCTL_GET_NOTIFICATION, runs the prefetch rules and publishes the response with their results;
+ * the other callers share it.
  *
  * Returns:
  *   UINT32 - The event code received, or 0 if none.
  */
-ECLIB_API
-UINT32 WaitForNotification(UINT32 event)
+static UINT32 WaitForNotificationShared(
+    _In_ UINT32 event,
+    _Out_opt_ NotificationRsp_t* rsp,
+    _Inout_opt_ size_t* rsp_len,
+    _Out_writes_opt_(*count) PrefetchResult_t* results,
+    _Inout_opt_ UINT32* count
+)
 {
-    HANDLE hDevice = NULL;
     UINT32 ievent = 0;
-    NotificationRsp_t notify_response = {0};
     NotificationReq_t notify_request = {0};
+    BYTE notify_response[NOTIFICATION_RSP_MAX_SIZE] = {0};
+    PrefetchResult_t prefetch[PREFETCH_RULE_MAX];
 
     // Make sure Initialization has been done
     if(g_notify.handle == INVALID_HANDLE_VALUE) {
@@ -326,38 +739,977 @@ UINT32 WaitForNotification(UINT32 event)
             g_notify.in_progress = TRUE;
             LeaveCriticalSection(&g_notify.lock);
 
-            ULONG bytesReturned;
+            ULONG bytesReturned = 0;
             notify_request.type = 0x1;
-            if(DeviceIoControl ( g_notify.handle,
+            BOOL ok = DeviceIoControl ( g_notify.handle,
                                 (DWORD) IOCTL_GET_NOTIFICATION,
                                 &notify_request,
                                 sizeof(notify_request),
-                                &notify_response,
+                                notify_response,
                                 sizeof( notify_response),
                                 &bytesReturned,
                                 NULL
-                                ) == TRUE )
-            {
-                g_notify.event = notify_response.lastevent;               
+                                );
+
+            if(ok == TRUE && bytesReturned >= NOTIFICATION_RSP_LEGACY_SIZE) {
+                RecordNotify(notify_response, bytesReturned);
+                TraceNotify(((NotificationRsp_t*)notify_response)->lastevent);
+            }
+
+            // Follow up evaluations go out before anyone is woken, so they get the results too
+            UINT32 prefetched = 0;
+            if(ok == TRUE && bytesReturned >= NOTIFICATION_RSP_LEGACY_SIZE) {
+                prefetched = RunPrefetch(notify_response, bytesReturned, prefetch);
+            }
+
+            // Publish the response under the lock so waiters copy a consistent one
+            EnterCriticalSection(&g_notify.lock);
+            if(ok == TRUE && bytesReturned >= NOTIFICATION_RSP_LEGACY_SIZE) {
+                g_notify.event = ((NotificationRsp_t*)notify_response)->lastevent;
+                g_notify.response_len = bytesReturned;
+                memcpy(g_notify.response, notify_response, bytesReturned);
             } else {
                 g_notify.event = 0;
+                g_notify.response_len = 0;
             }
+            g_notify.prefetch_count = prefetched;
+            memcpy(g_notify.prefetch, prefetch, prefetched * sizeof(PrefetchResult_t));
 
             g_notify.in_progress = FALSE;
             WakeAllConditionVariable(&g_notify.cv);
         } else {
             // Wait for notification to be set
-            LeaveCriticalSection(&g_notify.lock);
             SleepConditionVariableCS(&g_notify.cv, &g_notify.lock, INFINITE);
         }
 
         if(event == 0 || g_notify.event == event) {
             ievent = g_notify.event;
+            if(rsp != NULL && rsp_len != NULL) {
+                size_t len = min(*rsp_len, (size_t)g_notify.response_len);
+                memcpy(rsp, g_notify.response, len);
+                *rsp_len = len;
+            }
+            if(results != NULL && count != NULL) {
+                *count = min(*count, g_notify.prefetch_count);
+                memcpy(results, g_notify.prefetch, *count * sizeof(PrefetchResult_t));
+            }
+            LeaveCriticalSection(&g_notify.lock);
             break;
         }
 
-    } 
+        LeaveCriticalSection(&g_notify.lock);
+    }
 
     // Return no event
     return ievent;
-}
\ No newline at end of file
+}
+
+/*
+ * Function: WaitForNotificationEx
+ * -------------------------------
+ * Waits for a notification event from the KMDF driver and returns the full response, including
+ * the EC event and the payload the driver captured when the notification arrived. If event is
+ * 0, waits for any event.
+ *
+ * Parameters:
+ *   UINT32 event - The event code to wait for (0 for any event).
+ *   NotificationRsp_t* rsp - Buffer to receive the response, may be NULL.
+ *   size_t* rsp_len - Size of rsp on input, bytes written on output.
+ *
+ * Returns:
+ *   UINT32 - The event code received, or 0 if none.
+ */
+ECLIB_API
+UINT32 WaitForNotificationEx(
+    _In_ UINT32 event,
+    _Out_opt_ NotificationRsp_t* rsp,
+    _Inout_opt_ size_t* rsp_len
+)
+{
+    return WaitForNotificationShared(event, rsp, rsp_len, NULL, NULL);
+}
+
+/*
+ * Function: WaitForNotificationPrefetch
+ * -------------------------------------
+ * Same as WaitForNotificationEx, and also returns the results of the prefetch rules that matched
+ * the notification. They were evaluated as soon as it arrived, before any waiter was woken, so
+ * the follow up evaluations are already done when this returns.
+ *
+ * Parameters:
+ *   UINT32 event - The event code to wait for (0 for any event).
+ *   NotificationRsp_t* rsp - Buffer to receive the response, may be NULL.
+ *   size_t* rsp_len - Size of rsp on input, bytes written on output.
+ *   PrefetchResult_t* results - Receives the results in rule order, may be NULL.
+ *   UINT32* count - Entries in results on input, results written on output.
+ *
+ * Returns:
+ *   UINT32 - The event code received, or 0 if none.
+ */
+ECLIB_API
+UINT32 WaitForNotificationPrefetch(
+    _In_ UINT32 event,
+    _Out_opt_ NotificationRsp_t* rsp,
+    _Inout_opt_ size_t* rsp_len,
+    _Out_writes_opt_(*count) PrefetchResult_t* results,
+    _Inout_opt_ UINT32* count
+)
+{
+    return WaitForNotificationShared(event, rsp, rsp_len, results, count);
+}
+
+/*
+ * Function: WaitForNotification
+ * -----------------------------
+ * Waits for a notification event from the KMDF driver. If event is 0, waits for any event.
+ *
+ * Parameters:
+ *   UINT32 event - The event code to wait for (0 for any event).
+ *
+ * Returns:
+ *   UINT32 - The event code received, or 0 if none.
+ */
+ECLIB_API
+UINT32 WaitForNotification(UINT32 event)
+{
+    return WaitForNotificationEx(event, NULL, NULL);
+}
+
+/*
+ * Function: SetNotificationCoalescing
+ * -----------------------------------
+ * Sets the window in which repeats of an event are folded into one notification. The
+ * notification carries the number of occurrences and the first and last timestamps.
+ *
+ * Parameters:
+ *   UINT32 event     - Notify value, or NOTIFY_EVENT_ALL for every event.
+ *   UINT32 window_us - Window in us, 0 delivers every occurrence.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int SetNotificationCoalescing(
+    _In_ UINT32 event,
+    _In_ UINT32 window_us
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    CoalesceReq_t request = {0};
+    ULONG bytesReturned = 0;
+
+    int status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    // Driver requires an output buffer on every IOCTL, nothing is written to it
+    CoalesceReq_t unused = {0};
+    request.event = event;
+    request.window = window_us;
+    if (!DeviceIoControl(
+        hDevice.get(),
+        static_cast<DWORD>(IOCTL_SET_COALESCE),
+        &request,
+        sizeof(request),
+        &unused,
+        sizeof(unused),
+        &bytesReturned,
+        nullptr)) {
+        return static_cast<int>(GetLastError());
+    }
+
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: GetEventCounters
+ * --------------------------
+ * Reads the per event counters kept by the driver. Counts are exact even when occurrences are
+ * coalesced or arrive while no notification request is pending.
+ *
+ * Parameters:
+ *   UINT32 first             - First Notify value to return.
+ *   EventCounter_t* counters - Output array, entry i is for event first + i.
+ *   UINT32* count            - Input: entries in counters; Output: entries returned.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int GetEventCounters(
+    _In_ UINT32 first,
+    _Out_ EventCounter_t* counters,
+    _Inout_ UINT32* count
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    EventCountersReq_t request = {0};
+    ULONG bytesReturned = 0;
+
+    int status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    size_t rsp_len = EVENT_COUNTERS_RSP_HEADER_SIZE + *count * sizeof(EventCounter_t);
+    std::unique_ptr<BYTE[]> rsp_buf(new BYTE[rsp_len]);
+    auto* rsp = reinterpret_cast<EventCountersRsp_t*>(rsp_buf.get());
+
+    request.first = first;
+    request.count = *count;
+    if (!DeviceIoControl(
+        hDevice.get(),
+        static_cast<DWORD>(IOCTL_GET_EVENT_COUNTERS),
+        &request,
+        sizeof(request),
+        rsp,
+        static_cast<DWORD>(rsp_len),
+        &bytesReturned,
+        nullptr)) {
+        return static_cast<int>(GetLastError());
+    }
+
+    if (bytesReturned < EVENT_COUNTERS_RSP_HEADER_SIZE || rsp->count > *count) {
+        return ERROR_INVALID_DATA;
+    }
+
+    memcpy(counters, rsp->counter, rsp->count * sizeof(EventCounter_t));
+    *count = rsp->count;
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: ControlGenerator
+ * --------------------------
+ * Starts or stops the synthetic notification generator in the driver. Generated events take
+ * the same path as EC notifications and carry a NOTIFY_PAYLOAD_GENERATOR item with the run,
+ * sequence number and time they were raised, so the caller can measure loss and latency.
+ *
+ * Parameters:
+ *   const GeneratorReq_t* req - Run configuration, rate 0 stops the current run.
+ *   GeneratorRsp_t* rsp       - Optional, receives the state of the current or last run.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int ControlGenerator(
+    _In_ const GeneratorReq_t* req,
+    _Out_opt_ GeneratorRsp_t* rsp
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    GeneratorRsp_t response = {0};
+    ULONG bytesReturned = 0;
+
+    int status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    if (!DeviceIoControl(
+        hDevice.get(),
+        static_cast<DWORD>(IOCTL_GENERATOR),
+        const_cast<GeneratorReq_t*>(req),
+        sizeof(*req),
+        &response,
+        sizeof(response),
+        &bytesReturned,
+        nullptr)) {
+        return static_cast<int>(GetLastError());
+    }
+
+    if (rsp != nullptr) {
+        *rsp = response;
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: RunDriverBench
+ * ------------------------
+ * Runs ACPI evaluations and/or FF-A direct requests inside the driver and returns per target
+ * latency statistics. Blocks until every iteration is done.
+ *
+ * Parameters:
+ *   const BenchReq_t* req - Benchmark request followed by the ACPI input if any.
+ *   size_t req_len        - BENCH_REQ_HEADER_SIZE + req->inputsize.
+ *   BenchRsp_t* rsp       - Receives the statistics.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int RunDriverBench(
+    _In_ const BenchReq_t* req,
+    _In_ size_t req_len,
+    _Out_ BenchRsp_t* rsp
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    ULONG bytesReturned = 0;
+
+    int status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    if (!DeviceIoControl(
+        hDevice.get(),
+        static_cast<DWORD>(IOCTL_BENCH),
+        const_cast<BenchReq_t*>(req),
+        static_cast<DWORD>(req_len),
+        rsp,
+        sizeof(*rsp),
+        &bytesReturned,
+        nullptr)) {
+        return static_cast<int>(GetLastError());
+    }
+
+    if (bytesReturned < sizeof(*rsp)) {
+        return ERROR_INVALID_DATA;
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: EvaluateAcpiPriority
+ * ------------------------------
+ * Evaluates an ACPI method like EvaluateAcpi, queued in the given priority class of the driver.
+ * Critical evaluations such as thermal reads are started ahead of queued normal and bulk ones
+ * and always have a free slot.
+ *
+ * Parameters:
+ *   UINT32 priority    - EVAL_PRIORITY_CRITICAL, EVAL_PRIORITY_NORMAL or EVAL_PRIORITY_BULK.
+ *   void* acpi_input   - Pointer to ACPI_EVAL_INPUT_xxxx structure.
+ *   size_t input_len   - Length of the input structure.
+ *   BYTE* buffer       - Output buffer for the result.
+ *   size_t* buf_len    - Input: size of buffer; Output: bytes returned.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int EvaluateAcpiPriority(
+    _In_ UINT32 priority,
+    _In_ void* acpi_input,
+    _In_ size_t input_len,
+    _Out_ BYTE* buffer,
+    _Inout_ size_t* buf_len
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+
+    if (priority >= EVAL_PRIORITY_COUNT) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    AcpiMethodInfo_t* info;
+    int status = CheckAcpiMethod(acpi_input, input_len, &info);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+
+    status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    size_t capacity = *buf_len;
+    UINT64 started = RecordClock();
+    UINT32 correlation = TraceBeginEval(acpi_input, input_len);
+    status = EvaluatePriority(hDevice.get(), priority, correlation, acpi_input, input_len, buffer, buf_len);
+    TraceEnd(correlation, status);
+    if (started != 0) {
+        RecordEval(started, priority, acpi_input, input_len, status, capacity, buffer, *buf_len);
+    }
+    RecordAcpiOutput(info, status, buffer, *buf_len);
+    return status;
+}
+
+/*
+ * Function: GetPriorityStats
+ * --------------------------
+ * Reads queue depth, in flight count, wait and service time of each priority class. Times are
+ * in 100ns units.
+ *
+ * Parameters:
+ *   EvalPriorityStats_t* stats - Output array indexed by EVAL_PRIORITY_*.
+ *   UINT32* count              - Input: entries in stats; Output: entries returned.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int GetPriorityStats(
+    _Out_ EvalPriorityStats_t* stats,
+    _Inout_ UINT32* count
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    EvalPriorityStatsRsp_t response = {0};
+    UINT32 request = 0;
+    ULONG bytesReturned = 0;
+
+    int status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    // Driver rejects requests without an input buffer
+    if (!DeviceIoControl(
+        hDevice.get(),
+        static_cast<DWORD>(IOCTL_GET_PRIORITY_STATS),
+        &request,
+        sizeof(request),
+        &response,
+        sizeof(response),
+        &bytesReturned,
+        nullptr)) {
+        return static_cast<int>(GetLastError());
+    }
+
+    if (bytesReturned < sizeof(response)) {
+        return ERROR_INVALID_DATA;
+    }
+
+    *count = min(*count, static_cast<UINT32>(EVAL_PRIORITY_COUNT));
+    memcpy(stats, response.classes, *count * sizeof(EvalPriorityStats_t));
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: GetShardStats
+ * -----------------------
+ * Reads the per target device shards of the driver queues: device path, in flight limit,
+ * depth, in flight count, wait and service time. Times are in 100ns units.
+ *
+ * Parameters:
+ *   EvalShardStatsRsp_t* stats - Receives the shards in use and the totals.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int GetShardStats(
+    _Out_ EvalShardStatsRsp_t* stats
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    UINT32 request = 0;
+    ULONG bytesReturned = 0;
+
+    int status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    // Driver rejects requests without an input buffer
+    if (!DeviceIoControl(
+        hDevice.get(),
+        static_cast<DWORD>(IOCTL_GET_SHARD_STATS),
+        &request,
+        sizeof(request),
+        stats,
+        sizeof(*stats),
+        &bytesReturned,
+        nullptr)) {
+        return static_cast<int>(GetLastError());
+    }
+
+    if (bytesReturned < sizeof(*stats) || stats->count > EVAL_SHARD_COUNT) {
+        return ERROR_INVALID_DATA;
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: ConfigureAdmission
+ * ----------------------------
+ * Sets the driver limits on evaluations queued or in flight per device and per client process
+ * and the smallest retry delay suggested to rejected clients. Fields set to ADMISSION_KEEP are
+ * left unchanged, so all ADMISSION_KEEP only reads the current limits and counters.
+ *
+ * Parameters:
+ *   const AdmissionReq_t* req - New limits.
+ *   AdmissionRsp_t* rsp       - Optional, receives the limits and counters.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int ConfigureAdmission(
+    _In_ const AdmissionReq_t* req,
+    _Out_opt_ AdmissionRsp_t* rsp
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    AdmissionRsp_t response = {0};
+    ULONG bytesReturned = 0;
+
+    int status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    if (!DeviceIoControl(
+        hDevice.get(),
+        static_cast<DWORD>(IOCTL_ADMISSION),
+        const_cast<AdmissionReq_t*>(req),
+        sizeof(*req),
+        &response,
+        sizeof(response),
+        &bytesReturned,
+        nullptr)) {
+        return static_cast<int>(GetLastError());
+    }
+
+    if (rsp != nullptr) {
+        *rsp = response;
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: SendFfaCommands
+ * -------------------------
+ * Sends a list of small EC commands straight over FF-A. The driver packs commands for the same
+ * service into EC_MUX direct requests, so a periodic set of reads costs one world switch per
+ * service. Each command gets its own status, 0 on success, and its outlen output bytes from
+ * outoff of the EC response in data.
+ *
+ * Parameters:
+ *   FfaMuxCommand_t* commands - Commands to send, answered in place.
+ *   UINT32 count              - Number of commands, at most FFA_MUX_MAX_COMMANDS.
+ *   UINT32* calls             - Optional, receives the number of direct requests used.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int SendFfaCommands(
+    _Inout_updates_(count) FfaMuxCommand_t* commands,
+    _In_ UINT32 count,
+    _Out_opt_ UINT32* calls
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    ULONG bytesReturned = 0;
+
+    if (commands == nullptr || count == 0 || count > FFA_MUX_MAX_COMMANDS) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    int status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    size_t size = FFA_MUX_REQ_HEADER_SIZE + count * sizeof(FfaMuxCommand_t);
+    std::unique_ptr<BYTE[]> buf(new BYTE[size]());
+    FfaMuxReq_t* req = reinterpret_cast<FfaMuxReq_t*>(buf.get());
+    req->count = count;
+    memcpy(req->command, commands, count * sizeof(FfaMuxCommand_t));
+
+    UINT64 started = RecordClock();
+    UINT32 correlation = TraceBegin("SendFfaCommands", sizeof("SendFfaCommands") - 1, 0);
+    if (!DeviceIoControl(
+        hDevice.get(),
+        static_cast<DWORD>(IOCTL_FFA_MUX),
+        buf.get(),
+        static_cast<DWORD>(size),
+        buf.get(),
+        static_cast<DWORD>(size),
+        &bytesReturned,
+        nullptr)) {
+        status = static_cast<int>(GetLastError());
+    } else if (bytesReturned < size) {
+        status = ERROR_INVALID_DATA;
+    }
+    TraceEnd(correlation, status);
+
+    if (started != 0) {
+        RecordFfa(started, status, commands, req, count);
+    }
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+
+    memcpy(commands, req->command, count * sizeof(FfaMuxCommand_t));
+    if (calls != nullptr) {
+        *calls = req->calls;
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: BulkTransfer
+ * ----------------------
+ * Reads or writes an EC object through the pool of buffers shared with the EC at boot, a pool
+ * buffer at a time instead of a ring entry at a time. A read shorter than length means the end
+ * of the object was reached.
+ *
+ * Parameters:
+ *   UINT8 op          - EC_BULK_OP_READ or EC_BULK_OP_WRITE.
+ *   UINT8 object      - EC_BULK_OBJ_* to transfer.
+ *   UINT32 offset     - Byte offset in the object.
+ *   void* data        - Data to write or buffer to read into.
+ *   UINT32 length     - Bytes to transfer, at most BULK_MAX_LENGTH.
+ *   BulkRsp_t* result - Optional, receives the response header with bytes moved and EC status.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, the EC status is in result, or an error code on failure.
+ */
+ECLIB_API
+int BulkTransfer(
+    _In_ UINT8 op,
+    _In_ UINT8 object,
+    _In_ UINT32 offset,
+    _Inout_updates_bytes_(length) void* data,
+    _In_ UINT32 length,
+    _Out_opt_ BulkRsp_t* result
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    ULONG bytesReturned = 0;
+    bool read = op == EC_BULK_OP_READ;
+
+    if (data == nullptr || length == 0 || length > BULK_MAX_LENGTH) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    int status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    size_t req_len = BULK_REQ_HEADER_SIZE + (read ? 0 : length);
+    size_t rsp_len = BULK_RSP_HEADER_SIZE + (read ? length : 0);
+    std::unique_ptr<BYTE[]> req_buf(new BYTE[req_len]());
+    std::unique_ptr<BYTE[]> rsp_buf(new BYTE[rsp_len]());
+    BulkReq_t* req = reinterpret_cast<BulkReq_t*>(req_buf.get());
+    BulkRsp_t* rsp = reinterpret_cast<BulkRsp_t*>(rsp_buf.get());
+    req->op = op;
+    req->object = object;
+    req->offset = offset;
+    req->length = length;
+    if (!read) {
+        memcpy(req->data, data, length);
+    }
+
+    if (!DeviceIoControl(
+        hDevice.get(),
+        static_cast<DWORD>(IOCTL_BULK_TRANSFER),
+        req_buf.get(),
+        static_cast<DWORD>(req_len),
+        rsp_buf.get(),
+        static_cast<DWORD>(rsp_len),
+        &bytesReturned,
+        nullptr)) {
+        return static_cast<int>(GetLastError());
+    }
+
+    if (bytesReturned < BULK_RSP_HEADER_SIZE || rsp->length > length ||
+        (read && bytesReturned < BULK_RSP_HEADER_SIZE + rsp->length)) {
+        return ERROR_INVALID_DATA;
+    }
+
+    if (read) {
+        memcpy(data, rsp->data, rsp->length);
+    }
+    if (result != nullptr) {
+        *result = *rsp;
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: ReadEcLog
+ * -------------------
+ * Reads the EC log records after the cursor from the log stream ring. The driver copies them
+ * straight out of shared memory, so any number of readers can follow the stream, each with
+ * its own cursor. Waits for the EC to log something if there is nothing after the cursor.
+ *
+ * Parameters:
+ *   UINT64* cursor     - Input: stream position to read from, 0 for the oldest record;
+ *                        Output: position to pass to the next read.
+ *   UINT32 flags       - LOG_READ_NEWEST to skip what is already logged, LOG_READ_NOWAIT to
+ *                        return at once with no records.
+ *   UINT32 timeout_ms  - Maximum time to wait in ms, 0 waits forever. A read that times out
+ *                        succeeds with no records.
+ *   LogReadRsp_t* rsp  - Receives the records, the bytes lost if the reader fell behind and
+ *                        the EC and host clocks to convert record timestamps.
+ *   size_t rsp_len     - Size of rsp, at least LOG_READ_RSP_HEADER_SIZE plus one record of
+ *                        EC_LOG_TEXT_MAX text.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int ReadEcLog(
+    _Inout_ UINT64* cursor,
+    _In_ UINT32 flags,
+    _In_ UINT32 timeout_ms,
+    _Out_writes_bytes_(rsp_len) LogReadRsp_t* rsp,
+    _In_ size_t rsp_len
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    LogReadReq_t request = {0};
+    ULONG bytesReturned = 0;
+
+    if (cursor == nullptr || rsp == nullptr || rsp_len < LOG_READ_RSP_HEADER_SIZE + EC_LOG_RECORD_HEADER_SIZE + EC_LOG_TEXT_MAX) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    int status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    request.cursor = *cursor;
+    request.timeout = timeout_ms;
+    request.flags = flags;
+    if (!DeviceIoControl(
+        hDevice.get(),
+        static_cast<DWORD>(IOCTL_LOG_READ),
+        &request,
+        sizeof(request),
+        rsp,
+        static_cast<DWORD>(min(rsp_len, static_cast<size_t>(LOG_READ_RSP_HEADER_SIZE + LOG_READ_MAX_LENGTH))),
+        &bytesReturned,
+        nullptr)) {
+        return static_cast<int>(GetLastError());
+    }
+
+    if (bytesReturned < LOG_READ_RSP_HEADER_SIZE || bytesReturned < LOG_READ_RSP_HEADER_SIZE + rsp->length) {
+        return ERROR_INVALID_DATA;
+    }
+
+    *cursor = rsp->cursor;
+    return ERROR_SUCCESS;
+}
+
+// Requests built from the ecmethods.h bindings of THRM._DSM function 4, GVRS and SVRS
+#define THRM_DSM_INPUT_MAX      512
+static_assert(ecmethods::THRM::Input::GVRS::Length <= THRM_DSM_INPUT_MAX &&
+              ecmethods::THRM::Output::SVRS::Length <= THRM_DSM_INPUT_MAX, "THRM_DSM_INPUT_MAX too small");
+
+/*
+ * Function: EvaluateThermalVars
+ * -----------------------------
+ * Evaluates function 4 of the THRM variable _DSM with the variable UUIDs, each followed by its
+ * value when values is not null.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+static int EvaluateThermalVars(
+    _In_reads_(count) const GUID* vars,
+    _In_opt_ const UINT32* values,
+    _In_ UINT32 count,
+    _Out_ BYTE* buffer,
+    _Inout_ size_t* buf_len
+)
+{
+    BYTE request[THRM_DSM_INPUT_MAX];
+
+    size_t length = values == nullptr ?
+        ecmethods::THRM::Input::GVRS::Build(request, vars, count) :
+        ecmethods::THRM::Output::SVRS::Build(request, vars, values, count);
+    if (length == 0) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    return EvaluateAcpi(request, length, buffer, buf_len);
+}
+
+/*
+ * Function: GetThermalVars
+ * ------------------------
+ * Reads several DWORD variables of the thermal service in one FF-A request through THRM._DSM,
+ * instead of one GVAR evaluation and request per variable.
+ *
+ * Parameters:
+ *   GUID* vars      - UUIDs of the variables.
+ *   UINT32 count    - Number of variables, at most EC_THM_GET_VARS_MAX.
+ *   UINT32* values  - Receives each value, 0 for a variable the EC does not know.
+ *   UINT32* missing - Optional, receives bit N set if variable N is unknown.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int GetThermalVars(
+    _In_reads_(count) const GUID* vars,
+    _In_ UINT32 count,
+    _Out_writes_(count) UINT32* values,
+    _Out_opt_ UINT32* missing
+)
+{
+    BYTE buffer[256] = {0};
+    size_t buf_len = sizeof(buffer);
+
+    if (vars == nullptr || values == nullptr || count == 0 || count > EC_THM_GET_VARS_MAX) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    int status = EvaluateThermalVars(vars, nullptr, count, buffer, &buf_len);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+
+    // GVRS returns the missing bits then a value per variable, or Ones if the EC did not answer
+    auto* output = reinterpret_cast<ACPI_EVAL_OUTPUT_BUFFER_V1*>(buffer);
+    if (output->Signature != ACPI_EVAL_OUTPUT_BUFFER_SIGNATURE_V1 || output->Count < 1 + count) {
+        return output->Count == 1 ? ERROR_GEN_FAILURE : ERROR_INVALID_DATA;
+    }
+
+    UINT32 integers[1 + EC_THM_GET_VARS_MAX];
+    ACPI_METHOD_ARGUMENT_V1* arg = output->Argument;
+    for (UINT32 i = 0; i <= count; i++) {
+        if (arg->Type != ACPI_METHOD_ARGUMENT_INTEGER) {
+            return ERROR_INVALID_DATA;
+        }
+        integers[i] = arg->Argument;
+        arg = reinterpret_cast<ACPI_METHOD_ARGUMENT_V1*>(arg->Data + arg->DataLength);
+    }
+
+    memcpy(values, &integers[1], count * sizeof(UINT32));
+    if (missing != nullptr) {
+        *missing = integers[0];
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: SetThermalVars
+ * ------------------------
+ * Writes several DWORD variables of the thermal service in one FF-A request through THRM._DSM.
+ *
+ * Parameters:
+ *   GUID* vars      - UUIDs of the variables.
+ *   UINT32* values  - Value of each variable.
+ *   UINT32 count    - Number of variables, at most EC_THM_SET_VARS_MAX.
+ *   UINT32* missing - Optional, receives bit N set if variable N is unknown and was not written.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int SetThermalVars(
+    _In_reads_(count) const GUID* vars,
+    _In_reads_(count) const UINT32* values,
+    _In_ UINT32 count,
+    _Out_opt_ UINT32* missing
+)
+{
+    BYTE buffer[64] = {0};
+    size_t buf_len = sizeof(buffer);
+
+    if (vars == nullptr || values == nullptr || count == 0 || count > EC_THM_SET_VARS_MAX) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    int status = EvaluateThermalVars(vars, values, count, buffer, &buf_len);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+
+    // SVRS returns the missing bits, Ones has bits past count set if the EC did not answer
+    auto* output = reinterpret_cast<ACPI_EVAL_OUTPUT_BUFFER_V1*>(buffer);
+    if (output->Signature != ACPI_EVAL_OUTPUT_BUFFER_SIGNATURE_V1 || output->Count < 1 ||
+        output->Argument[0].Type != ACPI_METHOD_ARGUMENT_INTEGER) {
+        return ERROR_INVALID_DATA;
+    }
+    if ((output->Argument[0].Argument >> count) != 0) {
+        return ERROR_GEN_FAILURE;
+    }
+
+    if (missing != nullptr) {
+        *missing = output->Argument[0].Argument;
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: WaitForRxSequence
+ * ---------------------------
+ * Waits for the EC response with the given sequence number to be posted to the shared memory
+ * RX ring. The KMDF driver completes the wait when the EC rings the RX doorbell, so there is
+ * no polling from user mode. Sequence numbers come from queuing a request with \_SB.ECT0.ASYQ.
+ *
+ * Parameters:
+ *   UINT16 sequence    - Sequence number returned when the request was queued.
+ *   UINT32 timeout_ms  - Maximum time to wait in ms, 0 waits forever.
+ *   BYTE* buffer       - Output buffer for the response data.
+ *   size_t* buf_len    - Input: size of buffer; Output: bytes of response data.
+ *
+ * Responses larger than one ring entry are reassembled by the driver. If the buffer is too
+ * small ERROR_MORE_DATA is returned and buf_len is set to the full response length.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int WaitForRxSequence(
+    _In_ UINT16 sequence,
+    _In_ UINT32 timeout_ms,
+    _Out_ BYTE* buffer,
+    _Inout_ size_t* buf_len
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    RxSequenceReq_t request = {0};
+    ULONG bytesReturned = 0;
+
+    int status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    size_t rsp_len = RX_SEQUENCE_RSP_HEADER_SIZE + *buf_len;
+    std::unique_ptr<BYTE[]> rsp_buf(new BYTE[rsp_len]);
+    auto* rsp = reinterpret_cast<RxSequenceRsp_t*>(rsp_buf.get());
+
+    request.sequence = sequence;
+    request.timeout = timeout_ms;
+    request.correlation = TraceBegin("WaitForRxSequence", sizeof("WaitForRxSequence") - 1, sequence);
+    if (!DeviceIoControl(
+        hDevice.get(),
+        static_cast<DWORD>(IOCTL_WAIT_RX_SEQUENCE),
+        &request,
+        sizeof(request),
+        rsp,
+        static_cast<DWORD>(rsp_len),
+        &bytesReturned,
+        nullptr)) {
+        status = static_cast<int>(GetLastError());
+    }
+    TraceEnd(request.correlation, status);
+    if (status != ERROR_SUCCESS && status != ERROR_MORE_DATA) {
+        return status;
+    }
+
+    if (bytesReturned < RX_SEQUENCE_RSP_HEADER_SIZE) {
+        return ERROR_INVALID_DATA;
+    }
+
+    // On ERROR_MORE_DATA the data is truncated and buf_len returns the size needed
+    memcpy(buffer, rsp->data, rsp->length);
+    *buf_len = (status == ERROR_MORE_DATA) ? rsp->total : rsp->length;
+    return status;
+}
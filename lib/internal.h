@@ -0,0 +1,116 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Shared between the eclib source files, not exported. Each feature keeps its state static in
+// its own file and only the calls the core makes into it are declared here.
+
+#define MAX_DEVPATH_LENGTH  64
+
+// GUID defined in the KMDF INX file for ectest.sys, see eclib.cpp
+extern const GUID GUID_DEVCLASS_ECTEST;
+
+// eclib.cpp
+wchar_t *GetGUIDPath(
+    _In_ GUID GUID_DEVCLASS_SYSTEM,
+    _In_ const wchar_t* name,
+    _Out_ wchar_t* path,
+    _In_ size_t path_len
+);
+
+// prefetch.cpp
+UINT32 RunPrefetch(
+    _In_reads_bytes_(response_len) const BYTE* response,
+    _In_ DWORD response_len,
+    _Out_writes_(PREFETCH_RULE_MAX) PrefetchResult_t* results
+);
+
+// methods.cpp
+int CheckAcpiMethod(
+    _In_ const void* input,
+    _In_ size_t input_len,
+    _Out_ AcpiMethodInfo_t** info
+);
+
+void RecordAcpiOutput(
+    _In_opt_ AcpiMethodInfo_t* info,
+    _In_ int status,
+    _In_ const BYTE* buffer,
+    _In_ size_t length
+);
+
+BOOL ResolveMethodPath(
+    _In_reads_(name_len) const char* name,
+    _In_ size_t name_len,
+    _Out_writes_(ACPI_METHOD_PATH_MAX) char* path
+);
+
+// record.cpp
+UINT64 RecordClock();
+
+void RecordEval(
+    _In_ UINT64 started,
+    _In_ UINT32 priority,
+    _In_ const void* input,
+    _In_ size_t input_len,
+    _In_ int status,
+    _In_ size_t capacity,
+    _In_ const BYTE* buffer,
+    _In_ size_t length
+);
+
+void RecordFfa(
+    _In_ UINT64 started,
+    _In_ int status,
+    _In_reads_(count) const FfaMuxCommand_t* commands,
+    _In_ const FfaMuxReq_t* req,
+    _In_ UINT32 count
+);
+
+void RecordNotify(
+    _In_ const BYTE* response,
+    _In_ size_t length
+);
+
+// trace.cpp
+UINT32 TraceBegin(
+    _In_reads_(length) const char* name,
+    _In_ size_t length,
+    _In_ UINT16 sequence
+);
+
+void TraceEnd(
+    _In_ UINT32 correlation,
+    _In_ int status
+);
+
+void TraceNotify(
+    _In_ UINT32 event
+);
+
+UINT32 TraceBeginEval(
+    _In_reads_bytes_(input_len) const void* input,
+    _In_ size_t input_len
+);
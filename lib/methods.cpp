@@ -0,0 +1,669 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <windows.h>
+#include <strsafe.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <Acpiioct.h>
+#include <devioctl.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "..\inc\ectest.h"
+#include "..\inc\acpiview.h"
+#include "..\inc\acpireq.h"
+#include "..\inc\ecmethods.h"
+#include "..\inc\eclib.h"
+#include "internal.h"
+
+#include <wil/resource.h>
+#include <wil/result.h>
+
+// Methods eclib knows about, see DiscoverAcpiMethods. Open addressing on the path, entries are
+// never removed so a pointer to one stays valid and its output size can be raised under the
+// shared lock.
+#define METHOD_CACHE_SIZE       256
+#define METHOD_CACHE_VERSION    1
+#define METHOD_DEFAULT_SCOPE    "\\_SB.ECT0"    // Device of ETST0001, relative names resolve here
+#define METHOD_ENUM_INITIAL     4096
+
+typedef struct {
+    SRWLOCK lock;
+    BOOL seeded;                                // Methods of ecmethods::Methods added
+    UINT32 count;
+    char scope[ACPI_METHOD_PATH_MAX];           // Path of the device, from discovery
+    AcpiMethodInfo_t entries[METHOD_CACHE_SIZE];
+} MethodCache;
+
+static MethodCache g_methods = { SRWLOCK_INIT };
+
+/*
+ * Function: MethodPath
+ * --------------------
+ * Returns the absolute, upper case path of a method name as the cache keys it.
+ *
+ * Parameters:
+ *   const char* name   - Method name, absolute or relative to the device.
+ *   size_t name_len    - Most characters of name to read.
+ *   char* path         - Receives the path.
+ *
+ * Returns:
+ *   BOOL - FALSE if the path does not fit in ACPI_METHOD_PATH_MAX.
+ */
+static BOOL MethodPath(
+    _In_reads_(name_len) const char* name,
+    _In_ size_t name_len,
+    _Out_writes_(ACPI_METHOD_PATH_MAX) char* path
+)
+{
+    size_t length = 0;
+
+    if (name_len > 0 && name[0] != '\\') {
+        const char* scope = g_methods.scope[0] != 0 ? g_methods.scope : METHOD_DEFAULT_SCOPE;
+        length = strlen(scope);
+        memcpy(path, scope, length);
+        path[length++] = '.';
+    }
+
+    for (size_t i = 0; i < name_len && name[i] != 0; i++) {
+        if (length >= ACPI_METHOD_PATH_MAX - 1) {
+            return FALSE;
+        }
+        path[length++] = static_cast<char>(toupper(static_cast<unsigned char>(name[i])));
+    }
+    path[length] = 0;
+    return length > 0;
+}
+
+/*
+ * Function: ResolveMethodPath
+ * ---------------------------
+ * MethodPath for callers outside the cache, reads the device scope under the cache lock.
+ */
+BOOL ResolveMethodPath(
+    _In_reads_(name_len) const char* name,
+    _In_ size_t name_len,
+    _Out_writes_(ACPI_METHOD_PATH_MAX) char* path
+)
+{
+    AcquireSRWLockShared(&g_methods.lock);
+    BOOL valid = MethodPath(name, name_len, path);
+    ReleaseSRWLockShared(&g_methods.lock);
+    return valid;
+}
+
+// FNV-1a of the path
+static UINT32 MethodHash(
+    _In_ const char* path
+)
+{
+    UINT32 hash = 2166136261u;
+    for (; *path != 0; path++) {
+        hash = (hash ^ static_cast<BYTE>(*path)) * 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * Function: MethodFind
+ * --------------------
+ * Looks up a path in the cache, adding it if insert is set. Caller holds the lock, exclusive
+ * to insert.
+ *
+ * Returns:
+ *   AcpiMethodInfo_t* - Entry of the path, NULL if not found or the cache is full.
+ */
+static AcpiMethodInfo_t* MethodFind(
+    _In_ const char* path,
+    _In_ BOOL insert
+)
+{
+    UINT32 slot = MethodHash(path) % METHOD_CACHE_SIZE;
+
+    for (UINT32 probe = 0; probe < METHOD_CACHE_SIZE; probe++) {
+        AcpiMethodInfo_t* entry = &g_methods.entries[(slot + probe) % METHOD_CACHE_SIZE];
+        if (entry->path[0] == 0) {
+            if (!insert || g_methods.count >= METHOD_CACHE_SIZE * 3 / 4) {
+                return nullptr;
+            }
+            StringCchCopyA(entry->path, ACPI_METHOD_PATH_MAX, path);
+            entry->argc = ACPI_METHOD_ARGC_UNKNOWN;
+            entry->flags = 0;
+            entry->output = 0;
+            g_methods.count++;
+            return entry;
+        }
+        if (strcmp(entry->path, path) == 0) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+// Adds the methods declared in the ASL, caller holds the lock exclusive
+static void MethodSeed()
+{
+    if (g_methods.seeded) {
+        return;
+    }
+    g_methods.seeded = TRUE;
+
+    for (const auto& method : ecmethods::Methods) {
+        AcpiMethodInfo_t* entry = MethodFind(method.path, TRUE);
+        if (entry != nullptr) {
+            entry->argc = method.argc;
+            entry->flags |= ACPI_METHOD_ASL;
+        }
+    }
+}
+
+/*
+ * Function: CheckAcpiMethod
+ * -------------------------
+ * Checks an evaluation against the cache before it is sent. Only ACPI_EVAL_INPUT_BUFFER_xxx_EX
+ * inputs are checked, others are passed to the driver as they are. The argument count from the
+ * ASL table is only compared to flag the method with ACPI_METHOD_ARGC_MISMATCH, the evaluation
+ * is still sent.
+ *
+ * Parameters:
+ *   const void* input      - ACPI_EVAL_INPUT_BUFFER_xxx structure.
+ *   size_t input_len       - Length of the input structure.
+ *   AcpiMethodInfo_t** info- Receives the entry of the method to record the output in, or NULL.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, or ERROR_PROC_NOT_FOUND if discovery found the method missing.
+ */
+int CheckAcpiMethod(
+    _In_ const void* input,
+    _In_ size_t input_len,
+    _Out_ AcpiMethodInfo_t** info
+)
+{
+    const BYTE* bytes = static_cast<const BYTE*>(input);
+    char path[ACPI_METHOD_PATH_MAX];
+    UINT32 signature = 0;
+    UINT32 count = 0;
+
+    *info = nullptr;
+    if (input_len < ACPI_REQ_METHOD_OFFSET + ACPI_REQ_METHOD_MAX) {
+        return ERROR_SUCCESS;
+    }
+
+    memcpy(&signature, bytes, sizeof(signature));
+    switch (signature) {
+    case ACPI_EVAL_INPUT_BUFFER_SIGNATURE_EX:
+        count = 0;
+        break;
+    case ACPI_EVAL_INPUT_BUFFER_SIMPLE_INTEGER_SIGNATURE_EX:
+    case ACPI_EVAL_INPUT_BUFFER_SIMPLE_STRING_SIGNATURE_EX:
+        count = 1;
+        break;
+    case ACPI_EVAL_INPUT_BUFFER_COMPLEX_SIGNATURE_EX:
+        if (input_len < ACPI_REQ_HEADER) {
+            return ERROR_SUCCESS;
+        }
+        memcpy(&count, bytes + ACPI_REQ_COUNT_OFFSET, sizeof(count));
+        break;
+    default:
+        return ERROR_SUCCESS;
+    }
+
+    UINT32 flags = 0;
+    UINT8 argc = ACPI_METHOD_ARGC_UNKNOWN;
+
+    AcquireSRWLockShared(&g_methods.lock);
+    BOOL valid = MethodPath(reinterpret_cast<const char*>(bytes + ACPI_REQ_METHOD_OFFSET), ACPI_REQ_METHOD_MAX, path);
+    AcpiMethodInfo_t* entry = (valid && g_methods.seeded) ? MethodFind(path, FALSE) : nullptr;
+    if (entry != nullptr) {
+        flags = entry->flags;
+        argc = entry->argc;
+    }
+    ReleaseSRWLockShared(&g_methods.lock);
+
+    // First evaluation of a method, add it so its output size is learned
+    if (valid && entry == nullptr) {
+        AcquireSRWLockExclusive(&g_methods.lock);
+        MethodSeed();
+        entry = MethodFind(path, TRUE);
+        if (entry != nullptr) {
+            flags = entry->flags;
+            argc = entry->argc;
+        }
+        ReleaseSRWLockExclusive(&g_methods.lock);
+    }
+
+    if (flags & ACPI_METHOD_ABSENT) {
+        return ERROR_PROC_NOT_FOUND;
+    }
+    if (argc != ACPI_METHOD_ARGC_UNKNOWN && argc != count && !(flags & ACPI_METHOD_ARGC_MISMATCH)) {
+        AcquireSRWLockExclusive(&g_methods.lock);
+        entry->flags |= ACPI_METHOD_ARGC_MISMATCH;
+        ReleaseSRWLockExclusive(&g_methods.lock);
+    }
+    *info = entry;
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: RecordAcpiOutput
+ * --------------------------
+ * Raises the output size cached for a method to what an evaluation returned or, when the
+ * buffer was too small, to the Length ACPI reported it needs.
+ */
+void RecordAcpiOutput(
+    _In_opt_ AcpiMethodInfo_t* info,
+    _In_ int status,
+    _In_ const BYTE* buffer,
+    _In_ size_t length
+)
+{
+    UINT32 output = 0;
+
+    if (info == nullptr) {
+        return;
+    }
+
+    if (status == ERROR_SUCCESS) {
+        output = static_cast<UINT32>(length);
+    } else if (status == ERROR_MORE_DATA && length >= ACPI_VIEW_OUTPUT_HEADER) {
+        UINT32 signature;
+        memcpy(&signature, buffer, sizeof(signature));
+        if (signature == ACPI_VIEW_OUTPUT_SIGNATURE) {
+            memcpy(&output, buffer + sizeof(signature), sizeof(output));
+        }
+    }
+
+    LONG seen = static_cast<LONG>(info->output);
+    while (output > static_cast<UINT32>(seen)) {
+        LONG previous = InterlockedCompareExchange(reinterpret_cast<volatile LONG*>(&info->output),
+                                                   static_cast<LONG>(output),
+                                                   seen);
+        if (previous == seen) {
+            break;
+        }
+        seen = previous;
+    }
+}
+
+/*
+ * Function: EnumAcpiChildren
+ * --------------------------
+ * Sends IOCTL_ACPI_ENUM_CHILDREN to the driver and returns the paths of the children, growing
+ * the output buffer to the size ACPI asks for when it is too small.
+ *
+ * Parameters:
+ *   HANDLE hDevice     - Handle to the KMDF driver.
+ *   ULONG flags        - ENUM_CHILDREN_xxx flags.
+ *   const char* name   - Name segment to find with ENUM_CHILDREN_NAME_IS_FILTER, else NULL.
+ *   std::vector<std::string>& paths - Receives the upper case paths, the device itself first.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, ERROR_INVALID_DATA if the output is malformed, or an error code.
+ */
+static int EnumAcpiChildren(
+    _In_ HANDLE hDevice,
+    _In_ ULONG flags,
+    _In_opt_ const char* name,
+    _Out_ std::vector<std::string>& paths
+)
+{
+    BYTE request[sizeof(ACPI_ENUM_CHILDREN_INPUT_BUFFER) + ACPI_METHOD_PATH_MAX] = {0};
+    auto* input = reinterpret_cast<ACPI_ENUM_CHILDREN_INPUT_BUFFER*>(request);
+    std::unique_ptr<BYTE[]> output;
+    ULONG capacity = METHOD_ENUM_INITIAL;
+    ULONG bytesReturned = 0;
+
+    paths.clear();
+    input->Signature = ACPI_ENUM_CHILDREN_INPUT_BUFFER_SIGNATURE;
+    input->Flags = flags;
+    if (name != nullptr) {
+        input->NameLength = static_cast<ULONG>(strnlen(name, ACPI_METHOD_PATH_MAX - 1) + 1);
+        memcpy(input->Name, name, input->NameLength - 1);
+    }
+
+    for (;;) {
+        output.reset(new BYTE[capacity]);
+        bytesReturned = 0;
+        if (DeviceIoControl(
+            hDevice,
+            static_cast<DWORD>(IOCTL_ACPI_ENUM_CHILDREN),
+            request,
+            static_cast<DWORD>(FIELD_OFFSET(ACPI_ENUM_CHILDREN_INPUT_BUFFER, Name) + max(input->NameLength, 1ul)),
+            output.get(),
+            capacity,
+            &bytesReturned,
+            nullptr)) {
+            break;
+        }
+
+        // NumberOfChildren holds the bytes needed when the buffer is too small
+        DWORD error = GetLastError();
+        auto* header = reinterpret_cast<ACPI_ENUM_CHILDREN_OUTPUT_BUFFER*>(output.get());
+        if (error != ERROR_MORE_DATA) {
+            return static_cast<int>(error);
+        }
+        if (bytesReturned < FIELD_OFFSET(ACPI_ENUM_CHILDREN_OUTPUT_BUFFER, Children) ||
+            header->Signature != ACPI_ENUM_CHILDREN_OUTPUT_BUFFER_SIGNATURE ||
+            header->NumberOfChildren <= capacity) {
+            return ERROR_INVALID_DATA;
+        }
+        capacity = header->NumberOfChildren;
+    }
+
+    auto* header = reinterpret_cast<ACPI_ENUM_CHILDREN_OUTPUT_BUFFER*>(output.get());
+    if (bytesReturned < FIELD_OFFSET(ACPI_ENUM_CHILDREN_OUTPUT_BUFFER, Children) ||
+        header->Signature != ACPI_ENUM_CHILDREN_OUTPUT_BUFFER_SIGNATURE) {
+        return ERROR_INVALID_DATA;
+    }
+
+    size_t offset = FIELD_OFFSET(ACPI_ENUM_CHILDREN_OUTPUT_BUFFER, Children);
+    for (ULONG i = 0; i < header->NumberOfChildren; i++) {
+        if (offset + FIELD_OFFSET(ACPI_ENUM_CHILD, Name) > bytesReturned) {
+            return ERROR_INVALID_DATA;
+        }
+        // Children are packed back to back, so may not be aligned
+        ULONG nameLength;
+        memcpy(&nameLength, output.get() + offset + FIELD_OFFSET(ACPI_ENUM_CHILD, NameLength), sizeof(nameLength));
+        offset += FIELD_OFFSET(ACPI_ENUM_CHILD, Name);
+        if (nameLength > bytesReturned - offset) {
+            return ERROR_INVALID_DATA;
+        }
+
+        char path[ACPI_METHOD_PATH_MAX];
+        if (MethodPath(reinterpret_cast<const char*>(output.get() + offset), nameLength, path)) {
+            paths.push_back(path);
+        }
+        offset += nameLength;
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: DiscoverAcpiMethods
+ * -----------------------------
+ * Walks the ACPI namespace below the device once and caches which methods exist. Every name
+ * segment of the ASL methods and of methods evaluated so far is looked up below the device;
+ * methods found are marked ACPI_METHOD_PRESENT and those under an enumerated device that were
+ * not found ACPI_METHOD_ABSENT, which EvaluateAcpi then fails without a round trip. Windows
+ * does not report how many arguments a method takes, that comes from the ASL.
+ *
+ * Parameters:
+ *   UINT32* present    - Optional, receives the number of methods found.
+ *   UINT32* absent     - Optional, receives the number of ASL methods found missing.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int DiscoverAcpiMethods(
+    _Out_opt_ UINT32* present,
+    _Out_opt_ UINT32* absent
+)
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    std::vector<std::string> devices;
+    std::vector<std::string> found;
+    std::vector<std::string> paths;
+    std::vector<std::string> names;
+
+    int status = GetKMDFDriverHandle(0, &handle);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    wil::unique_handle hDevice(handle);
+
+    // Devices below ours, the first is the device itself
+    status = EnumAcpiChildren(hDevice.get(), ENUM_CHILDREN_MULTILEVEL, nullptr, devices);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+    if (devices.empty()) {
+        return ERROR_NOT_FOUND;
+    }
+
+    AcquireSRWLockExclusive(&g_methods.lock);
+    MethodSeed();
+    for (const auto& entry : g_methods.entries) {
+        const char* segment = strrchr(entry.path, '.');
+        if (segment != nullptr && std::find(names.begin(), names.end(), segment + 1) == names.end()) {
+            names.push_back(segment + 1);
+        }
+    }
+    ReleaseSRWLockExclusive(&g_methods.lock);
+
+    for (const auto& name : names) {
+        status = EnumAcpiChildren(hDevice.get(), ENUM_CHILDREN_MULTILEVEL | ENUM_CHILDREN_NAME_IS_FILTER, name.c_str(), paths);
+        if (status != ERROR_SUCCESS) {
+            return status;
+        }
+        found.insert(found.end(), paths.begin(), paths.end());
+    }
+
+    UINT32 present_count = 0;
+    UINT32 absent_count = 0;
+
+    AcquireSRWLockExclusive(&g_methods.lock);
+    StringCchCopyA(g_methods.scope, ACPI_METHOD_PATH_MAX, devices[0].c_str());
+    for (const auto& path : found) {
+        MethodFind(path.c_str(), TRUE);
+    }
+    for (auto& entry : g_methods.entries) {
+        const char* segment = strrchr(entry.path, '.');
+        if (segment == nullptr ||
+            std::find(devices.begin(), devices.end(), std::string(entry.path, segment - entry.path)) == devices.end()) {
+            continue;
+        }
+
+        entry.flags &= ~(ACPI_METHOD_PRESENT | ACPI_METHOD_ABSENT);
+        if (std::find(found.begin(), found.end(), entry.path) != found.end()) {
+            entry.flags |= ACPI_METHOD_PRESENT;
+            present_count++;
+        } else if (entry.flags & ACPI_METHOD_ASL) {
+            entry.flags |= ACPI_METHOD_ABSENT;
+            absent_count++;
+        }
+    }
+    ReleaseSRWLockExclusive(&g_methods.lock);
+
+    if (present != nullptr) {
+        *present = present_count;
+    }
+    if (absent != nullptr) {
+        *absent = absent_count;
+    }
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: GetAcpiMethodInfo
+ * ---------------------------
+ * Returns what is cached about a method, such as the output size to allocate before
+ * evaluating it.
+ *
+ * Parameters:
+ *   const char* method     - Method name, absolute or relative to the device.
+ *   AcpiMethodInfo_t* info - Receives the cached entry.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, ERROR_NOT_FOUND if the method is not cached.
+ */
+ECLIB_API
+int GetAcpiMethodInfo(
+    _In_ const char* method,
+    _Out_ AcpiMethodInfo_t* info
+)
+{
+    char path[ACPI_METHOD_PATH_MAX];
+    int status = ERROR_NOT_FOUND;
+
+    AcquireSRWLockExclusive(&g_methods.lock);
+    MethodSeed();
+    if (MethodPath(method, ACPI_REQ_METHOD_MAX, path)) {
+        AcpiMethodInfo_t* entry = MethodFind(path, FALSE);
+        if (entry != nullptr) {
+            *info = *entry;
+            status = ERROR_SUCCESS;
+        }
+    }
+    ReleaseSRWLockExclusive(&g_methods.lock);
+    return status;
+}
+
+/*
+ * Function: EnumAcpiMethods
+ * -------------------------
+ * Copies the cached methods, in no particular order.
+ *
+ * Parameters:
+ *   AcpiMethodInfo_t* methods  - Optional output array.
+ *   UINT32* count              - Input: entries in methods; Output: methods cached.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, ERROR_MORE_DATA if methods was too small for all of them.
+ */
+ECLIB_API
+int EnumAcpiMethods(
+    _Out_writes_opt_(*count) AcpiMethodInfo_t* methods,
+    _Inout_ UINT32* count
+)
+{
+    UINT32 copied = 0;
+
+    AcquireSRWLockExclusive(&g_methods.lock);
+    MethodSeed();
+    for (const auto& entry : g_methods.entries) {
+        if (entry.path[0] != 0 && methods != nullptr && copied < *count) {
+            methods[copied] = entry;
+        }
+        copied += (entry.path[0] != 0);
+    }
+    ReleaseSRWLockExclusive(&g_methods.lock);
+
+    int status = (methods == nullptr || copied > *count) ? ERROR_MORE_DATA : ERROR_SUCCESS;
+    *count = copied;
+    return status;
+}
+
+/*
+ * Function: LoadAcpiMethodCache
+ * -----------------------------
+ * Merges a cache saved by SaveAcpiMethodCache, so discovery and output sizes carry over between
+ * runs. The number of arguments in the ASL takes precedence over the file. Run discovery again
+ * after a firmware update.
+ *
+ * Parameters:
+ *   const char* file   - Path of the cache file.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, ERROR_FILE_NOT_FOUND, or ERROR_BAD_FORMAT if the file is not a cache
+ *         of this version.
+ */
+ECLIB_API
+int LoadAcpiMethodCache(
+    _In_ const char* file
+)
+{
+    FILE* f = nullptr;
+    char line[ACPI_METHOD_PATH_MAX + 64];
+    char path[ACPI_METHOD_PATH_MAX];
+    char scope[ACPI_METHOD_PATH_MAX] = {0};
+    UINT32 version = 0;
+
+    if (fopen_s(&f, file, "r") != 0) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+
+    if (fgets(line, sizeof(line), f) == nullptr ||
+        sscanf_s(line, "ectest-methods %u %63s", &version, scope, static_cast<unsigned>(sizeof(scope))) < 1 ||
+        version != METHOD_CACHE_VERSION) {
+        fclose(f);
+        return ERROR_BAD_FORMAT;
+    }
+
+    AcquireSRWLockExclusive(&g_methods.lock);
+    MethodSeed();
+    if (scope[0] == '\\') {
+        StringCchCopyA(g_methods.scope, ACPI_METHOD_PATH_MAX, scope);
+    }
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        unsigned argc, flags, output;
+        if (sscanf_s(line, "%63s %u %x %u", path, static_cast<unsigned>(sizeof(path)), &argc, &flags, &output) != 4 ||
+            path[0] != '\\') {
+            continue;
+        }
+
+        AcpiMethodInfo_t* entry = MethodFind(path, TRUE);
+        if (entry == nullptr) {
+            break;
+        }
+        if (entry->argc == ACPI_METHOD_ARGC_UNKNOWN && argc <= ACPI_REQ_MAX_ARGS) {
+            entry->argc = static_cast<UINT8>(argc);
+        }
+        entry->flags = (entry->flags & ACPI_METHOD_ASL) | (flags & (ACPI_METHOD_PRESENT | ACPI_METHOD_ABSENT));
+        entry->output = max(entry->output, output);
+    }
+    ReleaseSRWLockExclusive(&g_methods.lock);
+
+    fclose(f);
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: SaveAcpiMethodCache
+ * -----------------------------
+ * Writes the cached methods to a text file, one "path argc flags output" line each.
+ *
+ * Parameters:
+ *   const char* file   - Path of the cache file.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, or the error creating the file.
+ */
+ECLIB_API
+int SaveAcpiMethodCache(
+    _In_ const char* file
+)
+{
+    FILE* f = nullptr;
+
+    if (fopen_s(&f, file, "w") != 0) {
+        return static_cast<int>(GetLastError());
+    }
+
+    AcquireSRWLockShared(&g_methods.lock);
+    fprintf(f, "ectest-methods %u %s\n", METHOD_CACHE_VERSION,
+            g_methods.scope[0] != 0 ? g_methods.scope : METHOD_DEFAULT_SCOPE);
+    for (const auto& entry : g_methods.entries) {
+        if (entry.path[0] != 0) {
+            fprintf(f, "%s %u 0x%x %u\n", entry.path, entry.argc, entry.flags, entry.output);
+        }
+    }
+    ReleaseSRWLockShared(&g_methods.lock);
+
+    int status = ferror(f) ? ERROR_WRITE_FAULT : ERROR_SUCCESS;
+    fclose(f);
+    return status;
+}
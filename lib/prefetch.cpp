@@ -0,0 +1,217 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <Acpiioct.h>
+#include <devioctl.h>
+#include "..\inc\ectest.h"
+#include "..\inc\acpiview.h"
+#include "..\inc\acpireq.h"
+#include "..\inc\eclib.h"
+#include "internal.h"
+
+// Rule of the prefetch table with its input prebuilt, see SetPrefetchRules
+typedef struct {
+    UINT32 event;
+    UINT32 ecevent;
+    HANDLE done;                                // Manual reset event for the overlapped request
+    ACPI_EVAL_INPUT_BUFFER_V1_EX input;
+} PrefetchEntry;
+
+typedef struct {
+    SRWLOCK lock;                               // Shared while prefetching, exclusive to replace rules
+    HANDLE handle;                              // Overlapped handle to ETST0001, NULL without rules
+    UINT32 count;
+    PrefetchEntry rules[PREFETCH_RULE_MAX];
+} PrefetchState;
+
+static PrefetchState g_prefetch = { SRWLOCK_INIT };
+
+/*
+ * Function: RunPrefetch
+ * ---------------------
+ * Issues the evaluation of every prefetch rule matching a notification, all at once on the
+ * overlapped handle so the driver runs them side by side, and waits for them to complete.
+ *
+ * Returns:
+ *   UINT32 - Number of results written.
+ */
+UINT32 RunPrefetch(
+    _In_reads_bytes_(response_len) const BYTE* response,
+    _In_ DWORD response_len,
+    _Out_writes_(PREFETCH_RULE_MAX) PrefetchResult_t* results
+)
+{
+    const NotificationRsp_t* rsp = reinterpret_cast<const NotificationRsp_t*>(response);
+    UINT32 ecevent = response_len >= NOTIFICATION_RSP_HEADER_SIZE ? rsp->ecevent : 0;
+    OVERLAPPED overlapped[PREFETCH_RULE_MAX];
+    LARGE_INTEGER start, now, frequency;
+    UINT32 count = 0;
+
+    AcquireSRWLockShared(&g_prefetch.lock);
+    if(g_prefetch.count == 0) {
+        ReleaseSRWLockShared(&g_prefetch.lock);
+        return 0;
+    }
+
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+    for(UINT32 i = 0; i < g_prefetch.count; i++) {
+        PrefetchEntry* entry = &g_prefetch.rules[i];
+        if(entry->event != rsp->lastevent || (entry->ecevent != 0 && entry->ecevent != ecevent)) {
+            continue;
+        }
+
+        PrefetchResult_t* result = &results[count];
+        ZeroMemory(&overlapped[count], sizeof(OVERLAPPED));
+        overlapped[count].hEvent = entry->done;
+        result->rule = i;
+        result->length = 0;
+        result->latency_us = 0;
+        result->status = ERROR_IO_PENDING;
+        if(!DeviceIoControl(g_prefetch.handle,
+                            (DWORD) IOCTL_ACPI_EVAL_METHOD_EX,
+                            &entry->input,
+                            sizeof(entry->input),
+                            result->output,
+                            sizeof(result->output),
+                            NULL,
+                            &overlapped[count]) &&
+            GetLastError() != ERROR_IO_PENDING) {
+            result->status = static_cast<INT32>(GetLastError());
+        }
+        count++;
+    }
+
+    for(UINT32 i = 0; i < count; i++) {
+        DWORD bytes = 0;
+        if(results[i].status == ERROR_IO_PENDING) {
+            if(GetOverlappedResult(g_prefetch.handle, &overlapped[i], &bytes, TRUE)) {
+                results[i].status = ERROR_SUCCESS;
+                results[i].length = bytes;
+            } else {
+                results[i].status = static_cast<INT32>(GetLastError());
+            }
+        }
+        QueryPerformanceCounter(&now);
+        results[i].latency_us = static_cast<UINT32>((now.QuadPart - start.QuadPart) * 1000000 / frequency.QuadPart);
+    }
+    ReleaseSRWLockShared(&g_prefetch.lock);
+
+    return count;
+}
+
+/*
+ * Function: SetPrefetchRules
+ * --------------------------
+ * Replaces the prefetch rules table. When a notification matching a rule arrives, eclib evaluates
+ * the rule's method right away, side by side with the other matching rules, and hands the results
+ * to WaitForNotificationPrefetch together with the notification. This takes the usual follow up
+ * evaluation off the caller's path from event to reaction.
+ *
+ * Parameters:
+ *   PrefetchRule_t* rules - Rules in the order results are returned, may be NULL to clear.
+ *   UINT32 count          - Number of rules, at most PREFETCH_RULE_MAX, 0 to clear.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, or an error code on failure.
+ */
+ECLIB_API
+int SetPrefetchRules(
+    _In_reads_opt_(count) const PrefetchRule_t* rules,
+    _In_ UINT32 count
+)
+{
+    WCHAR pathbuf[MAX_DEVPATH_LENGTH];
+    int status = ERROR_SUCCESS;
+
+    if(count > PREFETCH_RULE_MAX || (count != 0 && rules == NULL)) {
+        return ERROR_INVALID_PARAMETER;
+    }
+    for(UINT32 i = 0; i < count; i++) {
+        if(rules[i].method == NULL || strlen(rules[i].method) >= sizeof(g_prefetch.rules[i].input.MethodName)) {
+            return ERROR_INVALID_PARAMETER;
+        }
+    }
+
+    // Waits for a prefetch in progress to finish with the old rules
+    AcquireSRWLockExclusive(&g_prefetch.lock);
+    for(UINT32 i = 0; i < g_prefetch.count; i++) {
+        CloseHandle(g_prefetch.rules[i].done);
+    }
+    g_prefetch.count = 0;
+    if(g_prefetch.handle != NULL) {
+        CloseHandle(g_prefetch.handle);
+        g_prefetch.handle = NULL;
+    }
+    if(count == 0) {
+        ReleaseSRWLockExclusive(&g_prefetch.lock);
+        return ERROR_SUCCESS;
+    }
+
+    wchar_t* dpath = GetGUIDPath(GUID_DEVCLASS_ECTEST, L"ETST0001", pathbuf, sizeof(pathbuf));
+    if(dpath == nullptr) {
+        ReleaseSRWLockExclusive(&g_prefetch.lock);
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    HANDLE handle = CreateFile(dpath,
+        GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_WRITE,
+        NULL,
+        OPEN_EXISTING,
+        FILE_FLAG_OVERLAPPED,
+        NULL);
+    if(handle == INVALID_HANDLE_VALUE) {
+        status = static_cast<int>(GetLastError());
+        ReleaseSRWLockExclusive(&g_prefetch.lock);
+        return status;
+    }
+
+    for(UINT32 i = 0; i < count; i++) {
+        PrefetchEntry* entry = &g_prefetch.rules[i];
+        entry->done = CreateEvent(NULL, TRUE, FALSE, NULL);
+        if(entry->done == NULL) {
+            status = static_cast<int>(GetLastError());
+            for(UINT32 j = 0; j < i; j++) {
+                CloseHandle(g_prefetch.rules[j].done);
+            }
+            CloseHandle(handle);
+            ReleaseSRWLockExclusive(&g_prefetch.lock);
+            return status;
+        }
+        entry->event = rules[i].event;
+        entry->ecevent = rules[i].ecevent;
+        ZeroMemory(&entry->input, sizeof(entry->input));
+        entry->input.Signature = ACPI_EVAL_INPUT_BUFFER_SIGNATURE_EX;
+        strcpy_s(entry->input.MethodName, sizeof(entry->input.MethodName), rules[i].method);
+    }
+    g_prefetch.handle = handle;
+    g_prefetch.count = count;
+    ReleaseSRWLockExclusive(&g_prefetch.lock);
+
+    return ERROR_SUCCESS;
+}
@@ -0,0 +1,460 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <Acpiioct.h>
+#include <devioctl.h>
+#include <vector>
+#include "..\inc\ectest.h"
+#include "..\inc\ecrecord.h"
+#include "..\inc\acpiview.h"
+#include "..\inc\acpireq.h"
+#include "..\inc\eclib.h"
+#include "internal.h"
+
+#include <wil/resource.h>
+#include <wil/result.h>
+
+// Session recording, see StartRecording. Records are encoded under the lock into a buffer that is
+// written out once it holds RECORD_FLUSH_SIZE bytes, so the file only ever ends on a whole record
+// unless a write fails.
+#define RECORD_FLUSH_SIZE       0x10000
+
+typedef struct {
+    SRWLOCK lock;                               // Exclusive to append a record or flush
+    volatile BOOL active;                       // Checked without the lock by every call
+    HANDLE file;
+    ecrecord::Writer* writer;
+    LARGE_INTEGER frequency;
+    UINT64 base;                                // RecordTicks when recording started
+    UINT64 pending;                             // Records in the buffer
+    RecordStats_t stats;
+} RecordState;
+
+static RecordState g_record = { SRWLOCK_INIT };
+
+// QueryPerformanceCounter in EC_RECORD_CLOCK units
+static UINT64 RecordTicks()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    UINT64 frequency = static_cast<UINT64>(g_record.frequency.QuadPart);
+    UINT64 ticks = static_cast<UINT64>(now.QuadPart);
+    return (ticks / frequency) * EC_RECORD_CLOCK + (ticks % frequency) * EC_RECORD_CLOCK / frequency;
+}
+
+// Start time of a call to record, 0 if not recording
+UINT64 RecordClock()
+{
+    return g_record.active ? RecordTicks() : 0;
+}
+
+/*
+ * Function: RecordFlush
+ * ---------------------
+ * Writes out the buffered records, called with the lock held exclusive.
+ */
+static void RecordFlush()
+{
+    DWORD written = 0;
+    ecrecord::Writer* writer = g_record.writer;
+
+    if (writer->Length() == 0) {
+        return;
+    }
+    if (WriteFile(g_record.file, writer->Data(), static_cast<DWORD>(writer->Length()), &written, nullptr) &&
+        written == writer->Length()) {
+        g_record.stats.bytes += written;
+    } else {
+        g_record.stats.dropped += g_record.pending;
+        g_record.stats.records -= g_record.pending;
+    }
+    writer->Clear();
+    g_record.pending = 0;
+}
+
+/*
+ * Function: RecordAppended
+ * ------------------------
+ * Counts a record appended under the lock and flushes a full buffer.
+ */
+static void RecordAppended()
+{
+    g_record.stats.records++;
+    g_record.pending++;
+    if (g_record.writer->Length() >= RECORD_FLUSH_SIZE) {
+        RecordFlush();
+    }
+}
+
+/*
+ * Function: RecordEval
+ * --------------------
+ * Records an evaluation that was sent to the driver. Inputs with a method name are recorded as
+ * the name and the bytes after it; the name is written once per recording.
+ */
+void RecordEval(
+    _In_ UINT64 started,
+    _In_ UINT32 priority,
+    _In_ const void* input,
+    _In_ size_t input_len,
+    _In_ int status,
+    _In_ size_t capacity,
+    _In_ const BYTE* buffer,
+    _In_ size_t length
+)
+{
+    const BYTE* bytes = static_cast<const BYTE*>(input);
+    UINT32 signature = 0;
+    const char* method = "";
+    size_t header = 0;
+
+    if (input_len >= sizeof(signature)) {
+        memcpy(&signature, bytes, sizeof(signature));
+    }
+    if (input_len >= EC_RECORD_EVAL_HEADER &&
+        (signature == ACPI_EVAL_INPUT_BUFFER_SIGNATURE_EX || signature == ACPI_EVAL_INPUT_BUFFER_SIMPLE_INTEGER_SIGNATURE_EX ||
+         signature == ACPI_EVAL_INPUT_BUFFER_SIMPLE_STRING_SIGNATURE_EX || signature == ACPI_EVAL_INPUT_BUFFER_COMPLEX_SIGNATURE_EX)) {
+        method = reinterpret_cast<const char*>(bytes + ACPI_REQ_METHOD_OFFSET);
+        header = EC_RECORD_EVAL_HEADER;
+    }
+
+    UINT64 now = RecordTicks();
+    AcquireSRWLockExclusive(&g_record.lock);
+    if (g_record.writer != nullptr) {
+        g_record.writer->Eval(started > g_record.base ? started - g_record.base : 0, now - started, method, priority,
+                              signature, static_cast<UINT32>(status), capacity, bytes + header, input_len - header,
+                              buffer, status == ERROR_SUCCESS ? length : 0);
+        RecordAppended();
+    }
+    ReleaseSRWLockExclusive(&g_record.lock);
+}
+
+/*
+ * Function: RecordFfa
+ * -------------------
+ * Records an IOCTL_FFA_MUX request with the input of each command and the status and output it
+ * returned, which are only meaningful when status is ERROR_SUCCESS.
+ */
+void RecordFfa(
+    _In_ UINT64 started,
+    _In_ int status,
+    _In_reads_(count) const FfaMuxCommand_t* commands,
+    _In_ const FfaMuxReq_t* req,
+    _In_ UINT32 count
+)
+{
+    UINT64 now = RecordTicks();
+    AcquireSRWLockExclusive(&g_record.lock);
+    if (g_record.writer != nullptr) {
+        for (UINT32 i = 0; i < count; i++) {
+            const FfaMuxCommand_t& command = commands[i];
+            g_record.writer->Command(&command.uuid, min(command.inlen, static_cast<UINT8>(FFA_MUX_DATA_SIZE)),
+                                     command.outoff, min(command.outlen, static_cast<UINT8>(FFA_MUX_DATA_SIZE)),
+                                     req->command[i].status, command.data, req->command[i].data);
+        }
+        g_record.writer->Ffa(started > g_record.base ? started - g_record.base : 0, now - started,
+                             static_cast<UINT32>(status), req->calls);
+        RecordAppended();
+    }
+    ReleaseSRWLockExclusive(&g_record.lock);
+}
+
+/*
+ * Function: RecordNotify
+ * ----------------------
+ * Records a notification response when it arrives from the driver, nothing to do if not recording.
+ */
+void RecordNotify(
+    _In_ const BYTE* response,
+    _In_ size_t length
+)
+{
+    if (!g_record.active) {
+        return;
+    }
+
+    UINT64 now = RecordTicks();
+    AcquireSRWLockExclusive(&g_record.lock);
+    if (g_record.writer != nullptr) {
+        g_record.writer->Notify(now > g_record.base ? now - g_record.base : 0,
+                                reinterpret_cast<const NotificationRsp_t*>(response)->lastevent, response, length);
+        RecordAppended();
+    }
+    ReleaseSRWLockExclusive(&g_record.lock);
+}
+
+/*
+ * Function: StartRecording
+ * ------------------------
+ * Records every evaluation, FF-A request and notification of this process to a file until
+ * StopRecording, so a session can be replayed with ReplayRecording or against the emulator with
+ * ecload. Each record holds the call's input, status, output, start time and duration; see
+ * ecrecord.h. Calls made while not recording only pay for one flag check.
+ *
+ * Parameters:
+ *   const char* file   - Recording to create, replaced if it exists.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, ERROR_ALREADY_INITIALIZED if already recording, or an error code.
+ */
+ECLIB_API
+int StartRecording(
+    _In_ const char* file
+)
+{
+    FILETIME start;
+    int status = ERROR_SUCCESS;
+
+    if (file == nullptr) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    AcquireSRWLockExclusive(&g_record.lock);
+    if (g_record.writer != nullptr) {
+        ReleaseSRWLockExclusive(&g_record.lock);
+        return ERROR_ALREADY_INITIALIZED;
+    }
+
+    g_record.file = CreateFileA(file, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (g_record.file == INVALID_HANDLE_VALUE) {
+        status = static_cast<int>(GetLastError());
+    } else {
+        QueryPerformanceFrequency(&g_record.frequency);
+        GetSystemTimePreciseAsFileTime(&start);
+        g_record.base = RecordTicks();
+        g_record.pending = 0;
+        g_record.stats = {};
+        g_record.writer = new ecrecord::Writer();
+        g_record.writer->Reserve(RECORD_FLUSH_SIZE * 2);
+        g_record.writer->Header((static_cast<UINT64>(start.dwHighDateTime) << 32) | start.dwLowDateTime);
+        RecordFlush();
+        g_record.active = TRUE;
+    }
+    ReleaseSRWLockExclusive(&g_record.lock);
+    return status;
+}
+
+/*
+ * Function: StopRecording
+ * -----------------------
+ * Writes out the records still buffered and closes the recording.
+ *
+ * Parameters:
+ *   RecordStats_t* stats - Optional, receives what was recorded.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, ERROR_NOT_READY if not recording.
+ */
+ECLIB_API
+int StopRecording(
+    _Out_opt_ RecordStats_t* stats
+)
+{
+    g_record.active = FALSE;
+
+    AcquireSRWLockExclusive(&g_record.lock);
+    if (g_record.writer == nullptr) {
+        ReleaseSRWLockExclusive(&g_record.lock);
+        return ERROR_NOT_READY;
+    }
+
+    RecordFlush();
+    CloseHandle(g_record.file);
+    g_record.file = INVALID_HANDLE_VALUE;
+    delete g_record.writer;
+    g_record.writer = nullptr;
+    if (stats != nullptr) {
+        *stats = g_record.stats;
+    }
+    ReleaseSRWLockExclusive(&g_record.lock);
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: ReplayWait
+ * --------------------
+ * Waits until due, in RecordTicks, sleeping while more than 2ms away and spinning after that.
+ * Returns how late it already was.
+ */
+static UINT64 ReplayWait(
+    _In_ UINT64 due
+)
+{
+    UINT64 now = RecordTicks();
+    if (now >= due) {
+        return now - due;
+    }
+    while (due - now > 20000) {
+        Sleep(static_cast<DWORD>((due - now) / 10000 - 1));
+        now = RecordTicks();
+    }
+    while (RecordTicks() < due) {
+        YieldProcessor();
+    }
+    return 0;
+}
+
+/*
+ * Function: ReplayRecording
+ * -------------------------
+ * Sends the evaluations and FF-A requests of a recording to the device again, at the recorded
+ * pace scaled by speed, and compares what they return with what was recorded. Notifications
+ * cannot be raised on the device, they are counted and their time is kept. Replaying while
+ * recording records the replay, which can then be compared with the original.
+ *
+ * Parameters:
+ *   const char* file       - Recording made by StartRecording.
+ *   UINT32 speed           - Percent of the recorded pace, REPLAY_SPEED_ORIGINAL, or
+ *                            REPLAY_SPEED_UNTIMED to send each call as soon as the last returns.
+ *   ReplayStats_t* stats   - Receives the counts and differences.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS if the recording was replayed, even with differences,
+ *         ERROR_INVALID_DATA if it is not a recording, or an error code.
+ */
+ECLIB_API
+int ReplayRecording(
+    _In_ const char* file,
+    _In_ UINT32 speed,
+    _Out_ ReplayStats_t* stats
+)
+{
+    LARGE_INTEGER size;
+
+    if (file == nullptr || stats == nullptr) {
+        return ERROR_INVALID_PARAMETER;
+    }
+    *stats = {};
+
+    // Mapped and walked in place, the replay only allocates its input and output buffers
+    wil::unique_hfile hFile(CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                        FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+    RETURN_LAST_ERROR_IF(!hFile.is_valid());
+    if (!GetFileSizeEx(hFile.get(), &size) || size.QuadPart < EC_RECORD_HEADER_SIZE) {
+        return ERROR_INVALID_DATA;
+    }
+
+    wil::unique_handle hMapping(CreateFileMappingW(hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+    RETURN_LAST_ERROR_IF(!hMapping.is_valid());
+    wil::unique_mapview_ptr<BYTE> view(static_cast<BYTE*>(MapViewOfFile(hMapping.get(), FILE_MAP_READ, 0, 0, 0)));
+    RETURN_LAST_ERROR_IF(!view);
+
+    ecrecord::Reader reader(view.get(), static_cast<size_t>(size.QuadPart));
+    if (!reader.Valid()) {
+        return ERROR_INVALID_DATA;
+    }
+
+    if (g_record.frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&g_record.frequency);
+    }
+
+    std::vector<BYTE> input;
+    std::vector<BYTE> output;
+    FfaMuxCommand_t commands[FFA_MUX_MAX_COMMANDS];
+    ecrecord::Command recorded[FFA_MUX_MAX_COMMANDS];
+    ecrecord::Record record;
+    UINT64 begin = RecordTicks();
+    UINT64 first = UINT64_MAX;
+
+    while (reader.Next(record)) {
+        stats->records++;
+        if (first == UINT64_MAX) {
+            first = record.time;
+        }
+        if (speed != REPLAY_SPEED_UNTIMED) {
+            UINT64 offset = record.time > first ? record.time - first : 0;
+            UINT64 late = ReplayWait(begin + offset * REPLAY_SPEED_ORIGINAL / speed);
+            stats->maxlateus = max(stats->maxlateus, late / 10);
+        }
+
+        if (record.kind == EC_RECORD_NOTIFY) {
+            stats->notifications++;
+            continue;
+        }
+
+        int status;
+        BOOL same = TRUE;
+        UINT64 started = RecordTicks();
+
+        if (record.kind == EC_RECORD_EVAL) {
+            if (record.name_len == 0) {
+                input.assign(record.tail, record.tail + record.tail_len);
+            } else {
+                input.assign(EC_RECORD_EVAL_HEADER + record.tail_len, 0);
+                memcpy(input.data(), &record.signature, sizeof(record.signature));
+                memcpy(input.data() + ACPI_REQ_METHOD_OFFSET, record.name, min(record.name_len, static_cast<size_t>(ACPI_REQ_METHOD_MAX - 1)));
+                if (record.tail_len > 0) {
+                    memcpy(input.data() + EC_RECORD_EVAL_HEADER, record.tail, record.tail_len);
+                }
+            }
+            output.resize(max(record.capacity, static_cast<size_t>(1)));
+            size_t length = record.capacity;
+
+            status = (record.priority == UINT32_MAX) ?
+                EvaluateAcpi(input.data(), input.size(), output.data(), &length) :
+                EvaluateAcpiPriority(record.priority, input.data(), input.size(), output.data(), &length);
+            stats->evaluations++;
+            same = status != ERROR_SUCCESS ||
+                   (length == record.output_len && memcmp(output.data(), record.output, length) == 0);
+        } else {
+            UINT32 count = 0;
+            while (count < FFA_MUX_MAX_COMMANDS && reader.NextCommand(recorded[count])) {
+                const ecrecord::Command& command = recorded[count];
+                FfaMuxCommand_t& c = commands[count++];
+                memset(&c, 0, sizeof(c));
+                memcpy(&c.uuid, command.uuid, sizeof(c.uuid));
+                c.inlen = min(command.inlen, static_cast<UINT8>(FFA_MUX_DATA_SIZE));
+                c.outoff = command.outoff;
+                c.outlen = min(command.outlen, static_cast<UINT8>(FFA_MUX_DATA_SIZE));
+                memcpy(c.data, command.input, c.inlen);
+            }
+
+            // Each command is compared on its own once the request itself went through again
+            status = (count > 0) ? SendFfaCommands(commands, count, nullptr) : ERROR_INVALID_DATA;
+            stats->commands += count;
+            for (UINT32 i = 0; status == ERROR_SUCCESS && record.status == ERROR_SUCCESS && i < count; i++) {
+                if (commands[i].status != recorded[i].status) {
+                    stats->statusdiffs++;
+                } else if (commands[i].status == 0 && memcmp(commands[i].data, recorded[i].output, commands[i].outlen) != 0) {
+                    stats->outputdiffs++;
+                }
+            }
+        }
+
+        stats->recordedus += record.duration / 10;
+        stats->replayedus += (RecordTicks() - started) / 10;
+        if (static_cast<UINT32>(status) != record.status) {
+            stats->statusdiffs++;
+        } else if (!same) {
+            stats->outputdiffs++;
+        }
+    }
+
+    stats->truncated = reader.Truncated();
+    return ERROR_SUCCESS;
+}
@@ -0,0 +1,464 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <Acpiioct.h>
+#include <devioctl.h>
+#include "..\inc\ectest.h"
+#include "..\inc\ecshare.h"
+#include "..\inc\acpiview.h"
+#include "..\inc\acpireq.h"
+#include "..\inc\eclib.h"
+#include "internal.h"
+
+// Shared result segment, see StartResultShare. Views are kept mapped for the life of the process
+// so readers never take a lock or make a system call after the first read.
+#define SHARE_MIN_PERIOD_MS     10
+#define SHARE_HEARTBEAT_MS      1000
+
+static_assert(SHARED_SERIES_MAX == EC_SHARE_SERIES_MAX && SHARED_RESULT_DATA_MAX == EC_SHARE_DATA_MAX &&
+              ACPI_METHOD_PATH_MAX == EC_SHARE_METHOD_MAX, "SharedResult_t must match ecshare.h");
+
+typedef struct {
+    SRWLOCK lock;                               // Exclusive to map the segment or start and stop sharing
+    HANDLE mapping;
+    void* volatile view;                        // Read only unless this process shares results
+    void* writable;
+    HANDLE mutex;                               // Held by the worker while this process is the owner
+    HANDLE stop;
+    HANDLE started;
+    HANDLE thread;
+    volatile BOOL owner;
+    UINT32 count;
+    ecshare::Series series[EC_SHARE_SERIES_MAX];// Directory to publish, empty to keep the current one
+} ShareState;
+
+static ShareState g_share = { SRWLOCK_INIT };
+
+/*
+ * Function: ShareView
+ * -------------------
+ * Returns the mapped segment, mapping it read only the first time.
+ *
+ * Returns:
+ *   void* - View of EC_SHARE_SIZE bytes, NULL if no process created the segment.
+ */
+static void* ShareView()
+{
+    void* view = g_share.view;
+    if (view != nullptr) {
+        return view;
+    }
+
+    AcquireSRWLockExclusive(&g_share.lock);
+    if (g_share.view == nullptr) {
+        HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, EC_SHARE_NAME);
+        if (mapping != nullptr) {
+            g_share.view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, EC_SHARE_SIZE);
+            if (g_share.view != nullptr) {
+                g_share.mapping = mapping;
+            } else {
+                CloseHandle(mapping);
+            }
+        }
+    }
+    view = g_share.view;
+    ReleaseSRWLockExclusive(&g_share.lock);
+    return view;
+}
+
+/*
+ * Function: ShareSample
+ * ---------------------
+ * Evaluates the method of a series and publishes the first argument of its result in the slot.
+ */
+static void ShareSample(
+    _In_ ecshare::Segment& segment,
+    _In_ UINT32 slot,
+    _In_ const char* method
+)
+{
+    ACPI_EVAL_INPUT_BUFFER_V1_EX input = {0};
+    BYTE output[PREFETCH_OUTPUT_MAX];
+    size_t length = sizeof(output);
+    UINT64 values[EC_SHARE_DATA_MAX / sizeof(UINT64)];
+    const void* data = values;
+    size_t size = 0;
+    UINT16 type = 0;
+    acpiview::ArgList args;
+
+    input.Signature = ACPI_EVAL_INPUT_BUFFER_SIGNATURE_EX;
+    strcpy_s(input.MethodName, sizeof(input.MethodName), method);
+    int status = EvaluateAcpi(&input, sizeof(input), output, &length);
+
+    if (status == ERROR_SUCCESS && acpiview::Parse(output, length, args) && !args.Empty()) {
+        acpiview::Arg arg = args[0];
+        type = arg.Type();
+        if (arg.IsInteger()) {
+            values[0] = arg.Integer();
+            size = sizeof(UINT64);
+        } else if (arg.IsPackage()) {
+            for (acpiview::Arg element : arg.Package()) {
+                if (!element.IsInteger() || size == sizeof(values)) {
+                    break;
+                }
+                values[size / sizeof(UINT64)] = element.Integer();
+                size += sizeof(UINT64);
+            }
+        } else {
+            data = arg.Buffer();
+            size = min(arg.BufferLength(), static_cast<size_t>(EC_SHARE_DATA_MAX));
+        }
+    } else if (status == ERROR_SUCCESS) {
+        status = ERROR_INVALID_DATA;
+    }
+
+    segment.Write(slot, static_cast<UINT32>(status), type, data, size, GetTickCount64());
+}
+
+/*
+ * Function: ShareWorker
+ * ---------------------
+ * Waits to own the segment, then samples every series of its directory at its period until
+ * StopResultShare. A process that exits while owning the segment abandons the mutex, which
+ * hands it to a process waiting here.
+ */
+static DWORD WINAPI ShareWorker(
+    _In_ LPVOID parameter
+)
+{
+    UNREFERENCED_PARAMETER(parameter);
+    ecshare::Segment segment(g_share.writable);
+    ecshare::Series series[EC_SHARE_SERIES_MAX];
+    ULONGLONG due[EC_SHARE_SERIES_MAX] = {0};
+    UINT32 count = 0;
+    UINT32 generation;
+
+    DWORD wait = WaitForSingleObject(g_share.mutex, 0);
+    g_share.owner = (wait == WAIT_OBJECT_0 || wait == WAIT_ABANDONED);
+    SetEvent(g_share.started);
+
+    if (!g_share.owner) {
+        HANDLE waits[2] = { g_share.stop, g_share.mutex };
+        wait = WaitForMultipleObjects(2, waits, FALSE, INFINITE);
+        if (wait != WAIT_OBJECT_0 + 1 && wait != WAIT_ABANDONED_0 + 1) {
+            return 0;
+        }
+        g_share.owner = TRUE;
+    }
+
+    // A directory the last owner was replacing when it exited is dropped
+    segment.Initialize();
+    if (g_share.count > 0) {
+        for (UINT32 i = 0; i < g_share.count; i++) {
+            segment.Write(i, ERROR_NOT_READY, 0, nullptr, 0, 0);
+        }
+        segment.Publish(g_share.series, g_share.count);
+    }
+    if (!segment.Directory(series, count, generation)) {
+        segment.Publish(series, 0);
+        count = 0;
+    }
+    segment.SetOwner(GetCurrentProcessId());
+
+    for (;;) {
+        ULONGLONG now = GetTickCount64();
+        ULONGLONG next = now + SHARE_HEARTBEAT_MS;
+
+        for (UINT32 i = 0; i < count; i++) {
+            if (due[i] <= now) {
+                ShareSample(segment, i, series[i].method);
+                ULONGLONG period = max(series[i].period, static_cast<UINT32>(SHARE_MIN_PERIOD_MS));
+                due[i] = (due[i] + period > now) ? due[i] + period : now + period;
+            }
+            next = min(next, due[i]);
+        }
+        segment.SetHeartbeat(now);
+
+        now = GetTickCount64();
+        if (WaitForSingleObject(g_share.stop, next > now ? static_cast<DWORD>(next - now) : 0) == WAIT_OBJECT_0) {
+            break;
+        }
+    }
+
+    segment.SetOwner(0);
+    g_share.owner = FALSE;
+    ReleaseMutex(g_share.mutex);
+    return 0;
+}
+
+/*
+ * Function: StartResultShare
+ * --------------------------
+ * Publishes sampled ACPI results in a named shared memory segment other processes read with
+ * ReadSharedResult, so a telemetry agent, a UI and ectest sessions share one set of EC
+ * evaluations instead of each polling. Only one process on the host, the owner, evaluates the
+ * methods. Other processes that call this wait in the background and one of them takes over,
+ * with the same directory of series, if the owner exits or stops.
+ *
+ * Parameters:
+ *   const SharedSeries_t* series - Methods to sample, NULL to keep the directory of the
+ *                                  current owner.
+ *   UINT32 count                 - Entries in series, at most SHARED_SERIES_MAX.
+ *   BOOL* owner                  - Optional, TRUE if this process became the owner at once.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, ERROR_ALREADY_INITIALIZED if this process already shares,
+ *         or an error code on failure.
+ */
+ECLIB_API
+int StartResultShare(
+    _In_reads_opt_(count) const SharedSeries_t* series,
+    _In_ UINT32 count,
+    _Out_opt_ BOOL* owner
+)
+{
+    int status = ERROR_SUCCESS;
+
+    if (count > EC_SHARE_SERIES_MAX || (series == nullptr && count != 0)) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    AcquireSRWLockExclusive(&g_share.lock);
+    if (g_share.thread != nullptr) {
+        ReleaseSRWLockExclusive(&g_share.lock);
+        return ERROR_ALREADY_INITIALIZED;
+    }
+
+    // Paths are stored as eclib keys them, so relative names and case do not matter to readers
+    for (UINT32 i = 0; i < count; i++) {
+        if (series[i].method == nullptr || !ResolveMethodPath(series[i].method, ACPI_REQ_METHOD_MAX, g_share.series[i].method)) {
+            status = ERROR_INVALID_PARAMETER;
+        }
+        g_share.series[i].period = max(series[i].period_ms, static_cast<UINT32>(SHARE_MIN_PERIOD_MS));
+    }
+    g_share.count = (status == ERROR_SUCCESS) ? count : 0;
+
+    if (status == ERROR_SUCCESS && g_share.writable == nullptr) {
+        HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, EC_SHARE_SIZE, EC_SHARE_NAME);
+        if (mapping == nullptr) {
+            status = static_cast<int>(GetLastError());
+        } else {
+            g_share.writable = MapViewOfFile(mapping, FILE_MAP_WRITE | FILE_MAP_READ, 0, 0, EC_SHARE_SIZE);
+            if (g_share.writable == nullptr) {
+                status = static_cast<int>(GetLastError());
+                CloseHandle(mapping);
+            } else if (g_share.mapping == nullptr) {
+                g_share.mapping = mapping;
+            } else {
+                CloseHandle(mapping);
+            }
+        }
+    }
+
+    if (status == ERROR_SUCCESS && g_share.mutex == nullptr) {
+        g_share.mutex = CreateMutexW(nullptr, FALSE, EC_SHARE_OWNER_NAME);
+        g_share.stop = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        g_share.started = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        if (g_share.mutex == nullptr || g_share.stop == nullptr || g_share.started == nullptr) {
+            status = static_cast<int>(GetLastError());
+        }
+    }
+
+    if (status == ERROR_SUCCESS) {
+        ResetEvent(g_share.stop);
+        g_share.thread = CreateThread(nullptr, 0, ShareWorker, nullptr, 0, nullptr);
+        if (g_share.thread == nullptr) {
+            status = static_cast<int>(GetLastError());
+        } else {
+            WaitForSingleObject(g_share.started, INFINITE);
+            if (g_share.view == nullptr) {
+                g_share.view = g_share.writable;
+            }
+        }
+    }
+    ReleaseSRWLockExclusive(&g_share.lock);
+
+    if (owner != nullptr) {
+        *owner = (status == ERROR_SUCCESS) && g_share.owner;
+    }
+    return status;
+}
+
+/*
+ * Function: StopResultShare
+ * -------------------------
+ * Stops sampling or waiting to take over. An owner releases the segment, which a waiting
+ * process takes over; the last samples stay readable.
+ */
+ECLIB_API
+VOID StopResultShare()
+{
+    AcquireSRWLockExclusive(&g_share.lock);
+    if (g_share.thread != nullptr) {
+        SetEvent(g_share.stop);
+        WaitForSingleObject(g_share.thread, INFINITE);
+        CloseHandle(g_share.thread);
+        g_share.thread = nullptr;
+    }
+    ReleaseSRWLockExclusive(&g_share.lock);
+}
+
+/*
+ * Function: ShareResult
+ * ---------------------
+ * Copies the latest sample of a slot and its directory entry into a SharedResult_t.
+ */
+static BOOL ShareResult(
+    _In_ const ecshare::Segment& segment,
+    _In_ UINT32 slot,
+    _In_ const ecshare::Series& series,
+    _Out_ SharedResult_t* result
+)
+{
+    ecshare::Sample sample;
+
+    if (!segment.Read(slot, sample)) {
+        return FALSE;
+    }
+
+    memcpy(result->method, series.method, sizeof(result->method));
+    result->period_ms = series.period;
+    result->status = static_cast<INT32>(sample.status);
+    result->type = sample.type;
+    result->length = sample.length;
+    result->samples = sample.samples;
+    result->owner = segment.Owner();
+    result->timestamp = sample.timestamp;
+    memcpy(result->data, sample.data, sample.length);
+    return TRUE;
+}
+
+/*
+ * Function: ReadSharedResult
+ * --------------------------
+ * Reads the latest sample of a method from the shared result segment. After the segment has
+ * been mapped this makes no system call and sends nothing to the EC. Compare timestamp with
+ * GetTickCount64 for the age of the sample; owner is 0 while no process is sampling.
+ *
+ * Parameters:
+ *   const char* method     - Method of the series, absolute or relative to the device.
+ *   SharedResult_t* result - Receives the sample.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, ERROR_FILE_NOT_FOUND if no process shares results, ERROR_NOT_FOUND if
+ *         the method is not sampled, or ERROR_BUSY if the owner kept updating it.
+ */
+ECLIB_API
+int ReadSharedResult(
+    _In_ const char* method,
+    _Out_ SharedResult_t* result
+)
+{
+    ecshare::Series series[EC_SHARE_SERIES_MAX];
+    char path[ACPI_METHOD_PATH_MAX];
+    UINT32 count;
+    UINT32 generation;
+
+    void* view = ShareView();
+    if (view == nullptr) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+
+    ecshare::Segment segment(view);
+    if (!segment.Valid()) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+
+    if (!ResolveMethodPath(method, ACPI_REQ_METHOD_MAX, path)) {
+        return ERROR_NOT_FOUND;
+    }
+
+    // The directory is only replaced when an owner starts with new series, retry if it was
+    for (int attempt = 0; attempt < EC_SHARE_READ_RETRIES; attempt++) {
+        if (!segment.Directory(series, count, generation)) {
+            return ERROR_BUSY;
+        }
+
+        UINT32 slot = 0;
+        while (slot < count && strcmp(series[slot].method, path) != 0) {
+            slot++;
+        }
+        if (slot == count) {
+            return ERROR_NOT_FOUND;
+        }
+
+        if (!ShareResult(segment, slot, series[slot], result)) {
+            return ERROR_BUSY;
+        }
+        if (segment.Generation() == generation) {
+            return ERROR_SUCCESS;
+        }
+    }
+    return ERROR_BUSY;
+}
+
+/*
+ * Function: EnumSharedResults
+ * ---------------------------
+ * Reads the latest sample of every series in the shared result segment.
+ *
+ * Parameters:
+ *   SharedResult_t* results    - Optional output array.
+ *   UINT32* count              - Input: entries in results; Output: series in the directory.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, ERROR_MORE_DATA if results was too small, ERROR_FILE_NOT_FOUND if no
+ *         process shares results, or ERROR_BUSY if the owner kept updating the segment.
+ */
+ECLIB_API
+int EnumSharedResults(
+    _Out_writes_opt_(*count) SharedResult_t* results,
+    _Inout_ UINT32* count
+)
+{
+    ecshare::Series series[EC_SHARE_SERIES_MAX];
+    UINT32 total;
+    UINT32 generation;
+
+    void* view = ShareView();
+    if (view == nullptr) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+
+    ecshare::Segment segment(view);
+    if (!segment.Valid()) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+    if (!segment.Directory(series, total, generation)) {
+        return ERROR_BUSY;
+    }
+
+    for (UINT32 i = 0; results != nullptr && i < total && i < *count; i++) {
+        if (!ShareResult(segment, i, series[i], &results[i])) {
+            return ERROR_BUSY;
+        }
+    }
+
+    int status = (results == nullptr || total > *count) ? ERROR_MORE_DATA : ERROR_SUCCESS;
+    *count = total;
+    return status;
+}
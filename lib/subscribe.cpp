@@ -0,0 +1,483 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <Acpiioct.h>
+#include <devioctl.h>
+#include "..\inc\ectest.h"
+#include "..\inc\ecsvc.h"
+#include "..\inc\ecring.h"
+#include "..\inc\acpiview.h"
+#include "..\inc\acpireq.h"
+#include "..\inc\ecmethods.h"
+#include "..\inc\eclib.h"
+#include "internal.h"
+
+// Temperature subscriptions, one worker thread each, see SubscribeTemperature
+#define TEMP_SUBSCRIPTION_MAX   8
+#define TEMP_REFRESH_MS         60000   // EC timeout, the worker checks in at least this often
+#define TEMP_POLL_MS            1000    // Poll period when the EC thresholds are not available
+
+typedef struct {
+    BOOL in_use;                // Slot is taken until the worker exits
+    BOOL stopping;              // UnsubscribeTemperature was called
+    BOOL in_callback;
+    UINT32 id;
+    DWORD thread_id;
+    UINT32 sensor;
+    UINT32 low;
+    UINT32 high;
+    UINT32 hysteresis;
+    TEMPERATURE_CALLBACK callback;
+    PVOID context;
+    HANDLE stop;                // Wakes a polling worker
+} TempSubscription;
+
+static SRWLOCK g_temp_lock = SRWLOCK_INIT;
+static CONDITION_VARIABLE g_temp_cv = CONDITION_VARIABLE_INIT;
+static TempSubscription g_temp_subs[TEMP_SUBSCRIPTION_MAX];
+static UINT32 g_temp_next_id = 1;
+
+/*
+ * Function: EvaluateSkinMethod
+ * ----------------------------
+ * Evaluates a request for a \_SB.SKIN method of thermal.asl that returns an integer.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS with the integer the method returned in result, or an error code.
+ */
+static int EvaluateSkinMethod(
+    _In_reads_bytes_(length) void* request,
+    _In_ size_t length,
+    _Out_ UINT32* result
+)
+{
+    BYTE buffer[64] = {0};
+    size_t buf_len = sizeof(buffer);
+    UINT64 value = 0;
+
+    int status = EvaluateAcpi(request, length, buffer, &buf_len);
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
+
+    if (!acpibind::Integer(buffer, buf_len, value)) {
+        return ERROR_INVALID_DATA;
+    }
+    *result = static_cast<UINT32>(value);
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: ReadSensorTemperature
+ * -------------------------------
+ * Reads a sensor once through SKIN.GTMP, which returns Ones if the EC did not answer.
+ */
+static int ReadSensorTemperature(
+    _In_ UINT32 sensor,
+    _Out_ UINT32* temperature
+)
+{
+    BYTE request[ecmethods::SKIN::GTMP::Length];
+
+    size_t length = ecmethods::SKIN::GTMP::Build(request, sensor);
+    int status = EvaluateSkinMethod(request, length, temperature);
+    if (status == ERROR_SUCCESS && *temperature == MAXUINT32) {
+        return ERROR_GEN_FAILURE;
+    }
+    return status;
+}
+
+/*
+ * Function: ArmSensorThresholds
+ * -----------------------------
+ * Arms the EC thresholds of a sensor through SKIN.THRS, the EC raises EC_NOTIFY_THERMAL once
+ * the temperature leaves [low, high] or timeout_ms expires.
+ */
+static int ArmSensorThresholds(
+    _In_ UINT32 sensor,
+    _In_ UINT32 low,
+    _In_ UINT32 high,
+    _In_ UINT32 timeout_ms
+)
+{
+    BYTE request[ecmethods::SKIN::THRS::Length];
+    UINT32 result = 0;
+
+    size_t length = ecmethods::SKIN::THRS::Build(request, sensor, timeout_ms, low, high);
+    int status = EvaluateSkinMethod(request, length, &result);
+    if (status == ERROR_SUCCESS && result != 0) {
+        return ERROR_GEN_FAILURE;
+    }
+    return status;
+}
+
+/*
+ * Function: TemperatureWindow
+ * ---------------------------
+ * Computes the window to arm around the last reported temperature. It spans the hysteresis
+ * either side, none if the hysteresis is 0, and stops at the low and high thresholds so
+ * crossing one is always reported.
+ */
+static void TemperatureWindow(
+    _In_ const TempSubscription* sub,
+    _In_ UINT32 temperature,
+    _Out_ UINT32* low,
+    _Out_ UINT32* high
+)
+{
+    *low = 0;
+    *high = MAXUINT32;
+    if (sub->hysteresis != 0) {
+        *low = temperature > sub->hysteresis ? temperature - sub->hysteresis : 0;
+        *high = temperature < MAXUINT32 - sub->hysteresis ? temperature + sub->hysteresis : MAXUINT32;
+    }
+
+    if (temperature >= sub->low) {
+        *low = max(*low, sub->low);
+    } else {
+        *high = min(*high, sub->low - 1);
+    }
+    if (temperature <= sub->high) {
+        *high = min(*high, sub->high);
+    } else {
+        *low = max(*low, sub->high + 1);
+    }
+}
+
+/*
+ * Function: GetThermalEvent
+ * -------------------------
+ * Looks for the EC_NOTIFY_THERMAL event record the driver attached to a notification.
+ *
+ * Returns:
+ *   BOOL - TRUE if the notification carries one, with its sensor, reason and temperature.
+ */
+static BOOL GetThermalEvent(
+    _In_ const NotificationRsp_t* rsp,
+    _In_ size_t rsp_len,
+    _Out_ UINT32* sensor,
+    _Out_ UINT32* reason,
+    _Out_ UINT32* temperature
+)
+{
+    size_t size = min((size_t)rsp->payloadsize, rsp_len - NOTIFICATION_RSP_HEADER_SIZE);
+    size_t offset = 0;
+
+    while (offset + sizeof(NotificationItem_t) <= size) {
+        const NotificationItem_t* item = reinterpret_cast<const NotificationItem_t*>(rsp->payload + offset);
+        const BYTE* data = reinterpret_cast<const BYTE*>(item + 1);
+        if (offset + NOTIFY_ITEM_SIZE(item->length) > size) {
+            break;
+        }
+        if (item->type == NOTIFY_PAYLOAD_EVENT_DATA && item->length >= EC_THM_EVENT_SIZE) {
+            *sensor = data[EC_THM_EVENT_TZID];
+            *reason = data[EC_THM_EVENT_REASON];
+            memcpy(temperature, data + EC_THM_EVENT_TEMP, sizeof(UINT32));
+            return TRUE;
+        }
+        offset += NOTIFY_ITEM_SIZE(item->length);
+    }
+    return FALSE;
+}
+
+/*
+ * Function: IsSubscriptionStopping
+ * --------------------------------
+ * Returns TRUE once UnsubscribeTemperature was called for the subscription.
+ */
+static BOOL IsSubscriptionStopping(
+    _In_ TempSubscription* sub
+)
+{
+    AcquireSRWLockShared(&g_temp_lock);
+    BOOL stopping = sub->stopping;
+    ReleaseSRWLockShared(&g_temp_lock);
+    return stopping;
+}
+
+/*
+ * Function: DeliverTemperature
+ * ----------------------------
+ * Calls the subscriber unless it is being unsubscribed, UnsubscribeTemperature waits for a
+ * callback in progress.
+ *
+ * Returns:
+ *   BOOL - FALSE if the subscription is stopping.
+ */
+static BOOL DeliverTemperature(
+    _In_ TempSubscription* sub,
+    _In_ UINT32 temperature,
+    _In_ BOOL polled
+)
+{
+    UINT32 flags = (temperature < sub->low ? TEMP_ALERT_LOW : 0) |
+                   (temperature > sub->high ? TEMP_ALERT_HIGH : 0) |
+                   (polled ? TEMP_ALERT_POLLED : 0);
+
+    AcquireSRWLockExclusive(&g_temp_lock);
+    if (sub->stopping) {
+        ReleaseSRWLockExclusive(&g_temp_lock);
+        return FALSE;
+    }
+    sub->in_callback = TRUE;
+    ReleaseSRWLockExclusive(&g_temp_lock);
+
+    sub->callback(sub->sensor, temperature, flags, sub->context);
+
+    AcquireSRWLockExclusive(&g_temp_lock);
+    sub->in_callback = FALSE;
+    WakeAllConditionVariable(&g_temp_cv);
+    ReleaseSRWLockExclusive(&g_temp_lock);
+    return TRUE;
+}
+
+/*
+ * Function: TemperatureWorker
+ * ---------------------------
+ * Runs one subscription. After reporting a temperature the worker arms the EC with the window
+ * around it and sleeps in WaitForNotificationEx until the EC raises EC_NOTIFY_THERMAL for the
+ * sensor, so a steady temperature costs one evaluation per TEMP_REFRESH_MS instead of one per
+ * poll. The temperature comes with the event, it is only read when the driver did not attach
+ * the event record or the EC timeout expired. If the EC rejects the thresholds or notifications
+ * are not available the worker polls every TEMP_POLL_MS against the same window instead.
+ */
+static DWORD WINAPI TemperatureWorker(
+    _In_ LPVOID param
+)
+{
+    TempSubscription* sub = static_cast<TempSubscription*>(param);
+    BYTE response[NOTIFICATION_RSP_MAX_SIZE];
+    NotificationRsp_t* rsp = reinterpret_cast<NotificationRsp_t*>(response);
+    UINT32 temperature = 0;
+    UINT32 low = 0;
+    UINT32 high = 0;
+    BOOL first = TRUE;
+    BOOL known = FALSE;         // temperature came with the EC event
+    BOOL polled = FALSE;
+
+    AcquireSRWLockExclusive(&g_temp_lock);
+    sub->thread_id = GetCurrentThreadId();
+    ReleaseSRWLockExclusive(&g_temp_lock);
+
+    while (!IsSubscriptionStopping(sub)) {
+        if (!known && ReadSensorTemperature(sub->sensor, &temperature) != ERROR_SUCCESS) {
+            WaitForSingleObject(sub->stop, TEMP_POLL_MS);
+            continue;
+        }
+        known = FALSE;
+
+        // The window only moves when a temperature is reported, so slow drift still adds up
+        if (first || temperature < low || temperature > high) {
+            if (!DeliverTemperature(sub, temperature, polled)) {
+                break;
+            }
+            first = FALSE;
+            TemperatureWindow(sub, temperature, &low, &high);
+        }
+
+        if (!polled && ArmSensorThresholds(sub->sensor, low, high, TEMP_REFRESH_MS) != ERROR_SUCCESS) {
+            polled = TRUE;
+        }
+        if (polled) {
+            WaitForSingleObject(sub->stop, TEMP_POLL_MS);
+            continue;
+        }
+
+        for (;;) {
+            size_t rsp_len = sizeof(response);
+            UINT32 event = WaitForNotificationEx(0, rsp, &rsp_len);
+            UINT32 sensor, reason;
+
+            if (event == 0) {
+                // Notifications were cleaned up or the driver failed the request
+                polled = TRUE;
+                break;
+            }
+            if (IsSubscriptionStopping(sub)) {
+                break;
+            }
+            if (event != EC_ACPI_NOTIFY_EVENT) {
+                continue;
+            }
+            if (rsp_len < NOTIFICATION_RSP_HEADER_SIZE || rsp->ecevent == 0) {
+                // Driver did not say which EC event this was, read to find out
+                break;
+            }
+            if (rsp->ecevent != EC_NOTIFY_THERMAL) {
+                continue;
+            }
+            if (GetThermalEvent(rsp, rsp_len, &sensor, &reason, &temperature)) {
+                if (sensor != sub->sensor) {
+                    continue;
+                }
+                known = reason != EC_THM_REASON_TIMEOUT;
+            }
+            break;
+        }
+    }
+
+    AcquireSRWLockExclusive(&g_temp_lock);
+    CloseHandle(sub->stop);
+    sub->stop = NULL;
+    sub->in_use = FALSE;
+    ReleaseSRWLockExclusive(&g_temp_lock);
+    return 0;
+}
+
+/*
+ * Function: SubscribeTemperature
+ * ------------------------------
+ * Calls back with the temperature of a sensor when it crosses the low or high threshold or has
+ * moved by more than the hysteresis since it was last reported, and once with the first
+ * reading. Instead of polling _TMP the EC is armed with thresholds around the last report and
+ * the temperature is only looked at again when the EC raises EC_NOTIFY_THERMAL. Callbacks run
+ * on a worker thread of the subscription, one at a time.
+ *
+ * Parameters:
+ *   UINT32 sensor      - EC sensor ID, 2 for SKIN.
+ *   UINT32 low         - Low threshold in deci-Kelvin, 0 for none.
+ *   UINT32 high        - High threshold in deci-Kelvin, MAXUINT32 for none.
+ *   UINT32 hysteresis  - Change in deci-Kelvin that is reported, 0 to only report crossings.
+ *   TEMPERATURE_CALLBACK callback - Receives the sensor, temperature and TEMP_ALERT_* flags.
+ *   PVOID context      - Passed to the callback.
+ *   UINT32* subscription - Receives the ID for UnsubscribeTemperature.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, ERROR_ALREADY_EXISTS if the sensor has a subscription,
+ *         ERROR_NO_SYSTEM_RESOURCES if there are TEMP_SUBSCRIPTION_MAX, or an error code.
+ */
+ECLIB_API
+int SubscribeTemperature(
+    _In_ UINT32 sensor,
+    _In_ UINT32 low,
+    _In_ UINT32 high,
+    _In_ UINT32 hysteresis,
+    _In_ TEMPERATURE_CALLBACK callback,
+    _In_opt_ PVOID context,
+    _Out_ UINT32* subscription
+)
+{
+    TempSubscription* sub = nullptr;
+
+    if (callback == nullptr || subscription == nullptr || low > high) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    // Workers share the notification request with the app, without it they poll
+    InitializeNotification();
+
+    AcquireSRWLockExclusive(&g_temp_lock);
+    for (UINT32 i = 0; i < TEMP_SUBSCRIPTION_MAX; i++) {
+        TempSubscription* slot = &g_temp_subs[i];
+        if (!slot->in_use) {
+            sub = sub != nullptr ? sub : slot;
+        } else if (!slot->stopping && slot->sensor == sensor) {
+            // The EC has one set of thresholds per sensor
+            ReleaseSRWLockExclusive(&g_temp_lock);
+            return ERROR_ALREADY_EXISTS;
+        }
+    }
+    if (sub == nullptr) {
+        ReleaseSRWLockExclusive(&g_temp_lock);
+        return ERROR_NO_SYSTEM_RESOURCES;
+    }
+
+    sub->stop = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (sub->stop == NULL) {
+        ReleaseSRWLockExclusive(&g_temp_lock);
+        return static_cast<int>(GetLastError());
+    }
+    sub->in_use = TRUE;
+    sub->stopping = FALSE;
+    sub->in_callback = FALSE;
+    sub->id = g_temp_next_id++;
+    sub->thread_id = 0;
+    sub->sensor = sensor;
+    sub->low = low;
+    sub->high = high;
+    sub->hysteresis = hysteresis;
+    sub->callback = callback;
+    sub->context = context;
+    *subscription = sub->id;
+    ReleaseSRWLockExclusive(&g_temp_lock);
+
+    HANDLE thread = CreateThread(NULL, 0, TemperatureWorker, sub, 0, NULL);
+    if (thread == NULL) {
+        int status = static_cast<int>(GetLastError());
+        AcquireSRWLockExclusive(&g_temp_lock);
+        CloseHandle(sub->stop);
+        sub->stop = NULL;
+        sub->in_use = FALSE;
+        ReleaseSRWLockExclusive(&g_temp_lock);
+        return status;
+    }
+    CloseHandle(thread);
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: UnsubscribeTemperature
+ * --------------------------------
+ * Stops a subscription. No callback runs once this returns, except when called from the
+ * callback itself. The worker exits on its own shortly after, the EC thresholds of the sensor
+ * are set to expire so a worker waiting for a notification wakes up.
+ *
+ * Parameters:
+ *   UINT32 subscription - ID returned by SubscribeTemperature.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS on success, ERROR_NOT_FOUND if there is no such subscription.
+ */
+ECLIB_API
+int UnsubscribeTemperature(
+    _In_ UINT32 subscription
+)
+{
+    TempSubscription* sub = nullptr;
+
+    AcquireSRWLockExclusive(&g_temp_lock);
+    for (UINT32 i = 0; i < TEMP_SUBSCRIPTION_MAX; i++) {
+        if (g_temp_subs[i].in_use && !g_temp_subs[i].stopping && g_temp_subs[i].id == subscription) {
+            sub = &g_temp_subs[i];
+        }
+    }
+    if (sub == nullptr) {
+        ReleaseSRWLockExclusive(&g_temp_lock);
+        return ERROR_NOT_FOUND;
+    }
+
+    sub->stopping = TRUE;
+    SetEvent(sub->stop);
+    while (sub->in_callback && sub->thread_id != GetCurrentThreadId()) {
+        SleepConditionVariableSRW(&g_temp_cv, &g_temp_lock, INFINITE, 0);
+    }
+    UINT32 sensor = sub->sensor;
+    ReleaseSRWLockExclusive(&g_temp_lock);
+
+    ArmSensorThresholds(sensor, 0, MAXUINT32, 1);
+    return ERROR_SUCCESS;
+}
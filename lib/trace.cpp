@@ -0,0 +1,501 @@
+/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <Acpiioct.h>
+#include <devioctl.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "..\inc\ectest.h"
+#include "..\inc\ectrace.h"
+#include "..\inc\acpiview.h"
+#include "..\inc\acpireq.h"
+#include "..\inc\eclib.h"
+#include "internal.h"
+
+#include <wil/resource.h>
+#include <wil/result.h>
+
+// Trace capture, see StartTrace. Calls append fixed size events to a buffer under the lock and a
+// worker swaps the buffer out every TRACE_DRAIN_MS and writes it, together with the events it
+// read from the driver timeline, so a traced call never waits on the file or the driver.
+#define TRACE_DRAIN_MS          20
+#define TRACE_READ_EVENTS       1024
+#define TRACE_RESERVE_EVENTS    4096
+
+typedef struct {
+    SRWLOCK lock;                               // Exclusive to append events or swap the buffer
+    volatile BOOL active;                       // Checked without the lock by every call
+    HANDLE file;
+    HANDLE device;                              // Driver handle for timeline reads, nullptr if not supported
+    HANDLE worker;
+    HANDLE stop;
+    std::vector<TimelineEvent_t>* events;       // eclib events not written yet
+    std::vector<std::string>* names;            // Indexed by name ID
+    volatile LONG next;                         // Last correlation ID handed out
+    UINT64 cursor;                              // Driver timeline position, only used by the worker
+    TraceStats_t stats;
+} TraceState;
+
+static TraceState g_trace = { SRWLOCK_INIT };
+
+/*
+ * Function: TraceAppend
+ * ---------------------
+ * Appends an event stamped with the current time, called with the lock held exclusive.
+ */
+static void TraceAppend(
+    _In_ UINT16 kind,
+    _In_ UINT32 correlation,
+    _In_ UINT16 sequence,
+    _In_ UINT32 value,
+    _In_ UINT32 reserved
+)
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    g_trace.events->push_back({ static_cast<UINT64>(now.QuadPart), correlation, kind, sequence, value, reserved });
+}
+
+/*
+ * Function: TraceName
+ * -------------------
+ * Returns the ID of a name, appending its NAME event the first time. Called with the lock held
+ * exclusive; a trace only sees a few dozen names so they are searched in order.
+ */
+static UINT32 TraceName(
+    _In_reads_(length) const char* name,
+    _In_ size_t length
+)
+{
+    std::vector<std::string>& names = *g_trace.names;
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i].size() == length && memcmp(names[i].data(), name, length) == 0) {
+            return static_cast<UINT32>(i);
+        }
+    }
+
+    UINT32 id = static_cast<UINT32>(names.size());
+    names.emplace_back(name, length);
+    TraceAppend(EC_TRACE_NAME, 0, 0, id, static_cast<UINT32>(length));
+
+    // Name follows in whole events, zero padded
+    size_t first = g_trace.events->size();
+    g_trace.events->resize(first + (length + sizeof(TimelineEvent_t) - 1) / sizeof(TimelineEvent_t));
+    memcpy(g_trace.events->data() + first, name, length);
+    return id;
+}
+
+/*
+ * Function: TraceBegin
+ * --------------------
+ * Starts tracing a call and returns its correlation ID to pass to the driver, 0 if not tracing.
+ */
+UINT32 TraceBegin(
+    _In_reads_(length) const char* name,
+    _In_ size_t length,
+    _In_ UINT16 sequence
+)
+{
+    UINT32 correlation = 0;
+
+    if (!g_trace.active) {
+        return 0;
+    }
+
+    // IDs with TIMELINE_CORRELATION_DRIVER set belong to the driver
+    while (correlation == 0) {
+        correlation = static_cast<UINT32>(InterlockedIncrement(&g_trace.next)) & ~TIMELINE_CORRELATION_DRIVER;
+    }
+
+    AcquireSRWLockExclusive(&g_trace.lock);
+    if (g_trace.events == nullptr) {
+        correlation = 0;
+    } else {
+        UINT32 id = TraceName(name, length);
+        TraceAppend(EC_TRACE_CALL_BEGIN, correlation, sequence, id, 0);
+        g_trace.stats.calls++;
+    }
+    ReleaseSRWLockExclusive(&g_trace.lock);
+    return correlation;
+}
+
+/*
+ * Function: TraceEnd
+ * ------------------
+ * Ends a call started with TraceBegin, nothing to do for correlation 0.
+ */
+void TraceEnd(
+    _In_ UINT32 correlation,
+    _In_ int status
+)
+{
+    if (correlation == 0) {
+        return;
+    }
+
+    AcquireSRWLockExclusive(&g_trace.lock);
+    if (g_trace.events != nullptr) {
+        TraceAppend(EC_TRACE_CALL_END, correlation, 0, static_cast<UINT32>(status), 0);
+    }
+    ReleaseSRWLockExclusive(&g_trace.lock);
+}
+
+/*
+ * Function: TraceNotify
+ * ---------------------
+ * Traces a notification response when it arrives from the driver, nothing to do if not tracing.
+ */
+void TraceNotify(
+    _In_ UINT32 event
+)
+{
+    if (!g_trace.active) {
+        return;
+    }
+
+    AcquireSRWLockExclusive(&g_trace.lock);
+    if (g_trace.events != nullptr) {
+        TraceAppend(EC_TRACE_NOTIFY, 0, 0, event, 0);
+    }
+    ReleaseSRWLockExclusive(&g_trace.lock);
+}
+
+/*
+ * Function: TraceMethod
+ * ---------------------
+ * Returns the length of the method name in an evaluation input, which starts at
+ * ACPI_REQ_METHOD_OFFSET, or 0 if the input has none.
+ */
+static size_t TraceMethod(
+    _In_reads_bytes_(input_len) const void* input,
+    _In_ size_t input_len
+)
+{
+    const BYTE* bytes = static_cast<const BYTE*>(input);
+    UINT32 signature = 0;
+
+    if (input_len < sizeof(ACPI_EVAL_INPUT_BUFFER_V1_EX)) {
+        return 0;
+    }
+    memcpy(&signature, bytes, sizeof(signature));
+    if (signature != ACPI_EVAL_INPUT_BUFFER_SIGNATURE_EX && signature != ACPI_EVAL_INPUT_BUFFER_SIMPLE_INTEGER_SIGNATURE_EX &&
+        signature != ACPI_EVAL_INPUT_BUFFER_SIMPLE_STRING_SIGNATURE_EX && signature != ACPI_EVAL_INPUT_BUFFER_COMPLEX_SIGNATURE_EX) {
+        return 0;
+    }
+    return strnlen(reinterpret_cast<const char*>(bytes + ACPI_REQ_METHOD_OFFSET), sizeof(ACPI_EVAL_INPUT_BUFFER_V1_EX) - ACPI_REQ_METHOD_OFFSET);
+}
+
+/*
+ * Function: TraceBeginEval
+ * ------------------------
+ * Starts tracing an evaluation, named after its method.
+ */
+UINT32 TraceBeginEval(
+    _In_reads_bytes_(input_len) const void* input,
+    _In_ size_t input_len
+)
+{
+    if (!g_trace.active) {
+        return 0;
+    }
+
+    size_t length = TraceMethod(input, input_len);
+    if (length == 0) {
+        return TraceBegin("EvaluateAcpi", sizeof("EvaluateAcpi") - 1, 0);
+    }
+    return TraceBegin(reinterpret_cast<const char*>(input) + ACPI_REQ_METHOD_OFFSET, length, 0);
+}
+
+/*
+ * Function: TraceWrite
+ * --------------------
+ * Writes events to the trace. Only the worker writes while tracing, StopTrace after it exited.
+ */
+static void TraceWrite(
+    _In_reads_(count) const TimelineEvent_t* events,
+    _In_ size_t count
+)
+{
+    DWORD written = 0;
+    DWORD length = static_cast<DWORD>(count * sizeof(TimelineEvent_t));
+
+    if (count == 0) {
+        return;
+    }
+    if (WriteFile(g_trace.file, events, length, &written, nullptr) && written == length) {
+        g_trace.stats.bytes += written;
+    } else {
+        g_trace.stats.writefailed = TRUE;
+    }
+}
+
+/*
+ * Function: TraceDrain
+ * --------------------
+ * Reads the new driver events and writes them with the eclib events appended since the last
+ * drain. The eclib buffer is swapped with spare, so both keep their capacity.
+ *
+ * Parameters:
+ *   DWORD flags                            - TIMELINE_READ_* for the driver reads.
+ *   std::vector<TimelineEvent_t>& spare    - Empty buffer to swap in.
+ */
+static void TraceDrain(
+    _In_ DWORD flags,
+    _Inout_ std::vector<TimelineEvent_t>& spare
+)
+{
+    if (g_trace.device != nullptr) {
+        size_t size = TIMELINE_READ_RSP_HEADER_SIZE + TRACE_READ_EVENTS * sizeof(TimelineEvent_t);
+        std::unique_ptr<BYTE[]> buf(new BYTE[size]);
+        auto* rsp = reinterpret_cast<TimelineReadRsp_t*>(buf.get());
+        TimelineReadReq_t req = {};
+        ULONG bytesReturned = 0;
+
+        do {
+            req.cursor = g_trace.cursor;
+            req.flags = flags;
+            if (!DeviceIoControl(
+                g_trace.device,
+                static_cast<DWORD>(IOCTL_TIMELINE_READ),
+                &req,
+                sizeof(req),
+                rsp,
+                static_cast<DWORD>(size),
+                &bytesReturned,
+                nullptr) || bytesReturned < TIMELINE_READ_RSP_HEADER_SIZE) {
+                break;
+            }
+
+            g_trace.cursor = rsp->cursor;
+            if (rsp->lost != 0) {
+                LARGE_INTEGER now;
+                QueryPerformanceCounter(&now);
+                TimelineEvent_t lost = { rsp->count != 0 ? rsp->events[0].time : static_cast<UINT64>(now.QuadPart), 0,
+                                         EC_TRACE_LOST, 0, static_cast<UINT32>(min(rsp->lost, static_cast<UINT64>(UINT32_MAX))), 0 };
+                TraceWrite(&lost, 1);
+                g_trace.stats.lost += rsp->lost;
+            }
+            TraceWrite(rsp->events, rsp->count);
+            g_trace.stats.driverevents += rsp->count;
+        } while (rsp->count == TRACE_READ_EVENTS);
+    }
+
+    spare.clear();
+    AcquireSRWLockExclusive(&g_trace.lock);
+    spare.swap(*g_trace.events);
+    ReleaseSRWLockExclusive(&g_trace.lock);
+    TraceWrite(spare.data(), spare.size());
+}
+
+/*
+ * Function: TraceWorker
+ * ---------------------
+ * Drains the trace every TRACE_DRAIN_MS until StopTrace, then stops the driver capture.
+ */
+static DWORD WINAPI TraceWorker(
+    _In_ LPVOID param
+)
+{
+    std::vector<TimelineEvent_t> spare;
+
+    UNREFERENCED_PARAMETER(param);
+    spare.reserve(TRACE_RESERVE_EVENTS);
+    while (WaitForSingleObject(g_trace.stop, TRACE_DRAIN_MS) == WAIT_TIMEOUT) {
+        TraceDrain(0, spare);
+    }
+    TraceDrain(TIMELINE_READ_DISABLE, spare);
+    return 0;
+}
+
+/*
+ * Function: StartTrace
+ * --------------------
+ * Traces every evaluation, RX sequence wait, FF-A request and notification of this process to a
+ * file until StopTrace, together with the driver's timestamps of each request, for
+ * tools/ectrace.py to convert to Chrome trace JSON. Each call gets a correlation ID that is
+ * passed to the driver with the request, evaluations go through IOCTL_ACPI_EVAL_PRIORITY for
+ * that. Calls made while not tracing only pay for one flag check.
+ *
+ * Parameters:
+ *   const char* file   - Trace to create, replaced if it exists.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, also if the driver has no timeline and only eclib calls are traced,
+ *         ERROR_ALREADY_INITIALIZED if already tracing, or an error code.
+ */
+ECLIB_API
+int StartTrace(
+    _In_ const char* file
+)
+{
+    BYTE header[EC_TRACE_HEADER_SIZE] = {};
+    LARGE_INTEGER frequency, base;
+    FILETIME start;
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    DWORD written = 0;
+
+    if (file == nullptr) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    AcquireSRWLockExclusive(&g_trace.lock);
+    if (g_trace.events != nullptr) {
+        ReleaseSRWLockExclusive(&g_trace.lock);
+        return ERROR_ALREADY_INITIALIZED;
+    }
+
+    wil::unique_hfile hFile(CreateFileA(file, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+    if (!hFile.is_valid()) {
+        int status = static_cast<int>(GetLastError());
+        ReleaseSRWLockExclusive(&g_trace.lock);
+        return status;
+    }
+
+    wil::unique_handle hStop(CreateEvent(nullptr, TRUE, FALSE, nullptr));
+    if (!hStop.is_valid()) {
+        int status = static_cast<int>(GetLastError());
+        ReleaseSRWLockExclusive(&g_trace.lock);
+        return status;
+    }
+
+    UINT32 signature = EC_TRACE_SIGNATURE;
+    UINT16 version = EC_TRACE_VERSION;
+    UINT16 size = EC_TRACE_HEADER_SIZE;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&base);
+    GetSystemTimePreciseAsFileTime(&start);
+    memcpy(header + EC_TRACE_SIGNATURE_OFFSET, &signature, sizeof(signature));
+    memcpy(header + EC_TRACE_VERSION_OFFSET, &version, sizeof(version));
+    memcpy(header + EC_TRACE_HEADER_OFFSET, &size, sizeof(size));
+    memcpy(header + EC_TRACE_FREQUENCY_OFFSET, &frequency.QuadPart, sizeof(UINT64));
+    memcpy(header + EC_TRACE_BASE_OFFSET, &base.QuadPart, sizeof(UINT64));
+    memcpy(header + EC_TRACE_START_OFFSET, &start, sizeof(UINT64));
+    if (!WriteFile(hFile.get(), header, sizeof(header), &written, nullptr) || written != sizeof(header)) {
+        int status = static_cast<int>(GetLastError());
+        ReleaseSRWLockExclusive(&g_trace.lock);
+        return status;
+    }
+
+    g_trace.stats = {};
+    g_trace.stats.bytes = written;
+    g_trace.device = nullptr;
+    g_trace.cursor = 0;
+
+    // Enable the driver capture from its newest event on, older drivers reject the IOCTL
+    if (GetKMDFDriverHandle(0, &handle) == ERROR_SUCCESS) {
+        TimelineReadReq_t req = {};
+        TimelineReadRsp_t rsp = {};
+        ULONG bytesReturned = 0;
+
+        req.flags = TIMELINE_READ_ENABLE | TIMELINE_READ_NEWEST;
+        if (DeviceIoControl(handle, static_cast<DWORD>(IOCTL_TIMELINE_READ), &req, sizeof(req),
+                            &rsp, sizeof(rsp), &bytesReturned, nullptr) &&
+            bytesReturned >= TIMELINE_READ_RSP_HEADER_SIZE) {
+            g_trace.device = handle;
+            g_trace.cursor = rsp.cursor;
+            g_trace.stats.driver = TRUE;
+        } else {
+            CloseHandle(handle);
+        }
+    }
+
+    g_trace.file = hFile.release();
+    g_trace.stop = hStop.release();
+    g_trace.events = new std::vector<TimelineEvent_t>();
+    g_trace.events->reserve(TRACE_RESERVE_EVENTS);
+    g_trace.names = new std::vector<std::string>();
+    g_trace.worker = CreateThread(nullptr, 0, TraceWorker, nullptr, 0, nullptr);
+    if (g_trace.worker == nullptr) {
+        int status = static_cast<int>(GetLastError());
+        if (g_trace.device != nullptr) {
+            CloseHandle(g_trace.device);
+            g_trace.device = nullptr;
+        }
+        CloseHandle(g_trace.file);
+        CloseHandle(g_trace.stop);
+        delete g_trace.events;
+        delete g_trace.names;
+        g_trace.events = nullptr;
+        g_trace.names = nullptr;
+        ReleaseSRWLockExclusive(&g_trace.lock);
+        return status;
+    }
+    g_trace.active = TRUE;
+    ReleaseSRWLockExclusive(&g_trace.lock);
+    return ERROR_SUCCESS;
+}
+
+/*
+ * Function: StopTrace
+ * -------------------
+ * Stops the driver capture, writes out the events still buffered and closes the trace.
+ *
+ * Parameters:
+ *   TraceStats_t* stats - Optional, receives what was traced.
+ *
+ * Returns:
+ *   int - ERROR_SUCCESS, ERROR_NOT_READY if not tracing.
+ */
+ECLIB_API
+int StopTrace(
+    _Out_opt_ TraceStats_t* stats
+)
+{
+    g_trace.active = FALSE;
+
+    AcquireSRWLockShared(&g_trace.lock);
+    BOOL tracing = (g_trace.events != nullptr);
+    ReleaseSRWLockShared(&g_trace.lock);
+    if (!tracing) {
+        return ERROR_NOT_READY;
+    }
+
+    // Worker takes the lock to swap buffers, so it is not held while waiting
+    SetEvent(g_trace.stop);
+    WaitForSingleObject(g_trace.worker, INFINITE);
+
+    AcquireSRWLockExclusive(&g_trace.lock);
+    TraceWrite(g_trace.events->data(), g_trace.events->size());
+    CloseHandle(g_trace.worker);
+    CloseHandle(g_trace.stop);
+    CloseHandle(g_trace.file);
+    if (g_trace.device != nullptr) {
+        CloseHandle(g_trace.device);
+        g_trace.device = nullptr;
+    }
+    delete g_trace.events;
+    delete g_trace.names;
+    g_trace.events = nullptr;
+    g_trace.names = nullptr;
+    if (stats != nullptr) {
+        *stats = g_trace.stats;
+    }
+    ReleaseSRWLockExclusive(&g_trace.lock);
+    return ERROR_SUCCESS;
+}
@@ -4,6 +4,7 @@ use battery_service_messages::{
 };
 use color_eyre::{Result, eyre::eyre};
 use std::ffi;
+use std::marker::PhantomData;
 use time_alarm_service_messages::{
     AcpiTimerId, AcpiTimestamp, AlarmExpiredWakePolicy, AlarmTimerSeconds, TimeAlarmDeviceCapabilities, TimerStatus,
 };
@@ -11,6 +12,130 @@ use time_alarm_service_messages::{
 // This module maps the data returned from call into the C-Library to RUST structures
 unsafe extern "C" {
     fn EvaluateAcpi(input: *const i8, input_len: usize, buffer: *mut u8, buf_len: &mut usize) -> i32;
+    fn AcpiOutputArgs(buffer: *const u8, length: usize, list: *mut AcpiArgList) -> i32;
+    fn AcpiArgNext(list: *mut AcpiArgList, arg: *mut AcpiArg) -> i32;
+    fn AcpiArgInteger(arg: *const AcpiArg) -> u64;
+    fn AcpiArgPackage(arg: *const AcpiArg, list: *mut AcpiArgList) -> i32;
+}
+
+// AcpiArgList_t and AcpiArg_t from acpiview.h, pointers refer into the output buffer
+#[repr(C)]
+#[derive(Copy, Clone)]
+struct AcpiArgList {
+    next: *const u8,
+    end: *const u8,
+    count: u32,
+}
+
+#[repr(C)]
+#[derive(Copy, Clone)]
+struct AcpiArg {
+    type_: u16,
+    length: u16,
+    data: *const u8,
+}
+
+/// Arguments of an ACPI output buffer or package, read in place through the eclib view.
+/// The buffer is bounds checked once by `parse`, nothing is copied afterwards.
+pub struct AcpiArgs<'a> {
+    list: AcpiArgList,
+    _buffer: PhantomData<&'a [u8]>,
+}
+
+/// One argument borrowed from the output buffer
+#[derive(Copy, Clone)]
+pub struct AcpiArgView<'a> {
+    arg: AcpiArg,
+    _buffer: PhantomData<&'a [u8]>,
+}
+
+impl<'a> AcpiArgs<'a> {
+    fn parse(buffer: &'a [u8]) -> Result<Self, AcpiParseError> {
+        let mut list = AcpiArgList {
+            next: std::ptr::null(),
+            end: std::ptr::null(),
+            count: 0,
+        };
+
+        match unsafe { AcpiOutputArgs(buffer.as_ptr(), buffer.len(), &mut list) } {
+            ERROR_SUCCESS => Ok(Self {
+                list,
+                _buffer: PhantomData,
+            }),
+            _ => Err(AcpiParseError::InvalidFormat),
+        }
+    }
+
+    /// Number of arguments in the whole list
+    pub fn count(&self) -> u32 {
+        self.list.count
+    }
+
+    /// Next argument as an integer, errors if it is missing or of another type
+    pub fn next_u32(&mut self) -> Result<u32> {
+        self.next()
+            .and_then(|arg| arg.integer())
+            .map(|value| value as u32)
+            .ok_or(eyre!("Expected integer argument"))
+    }
+
+    /// Next argument as raw bytes, strings include their terminating NUL
+    pub fn next_bytes(&mut self) -> Result<&'a [u8]> {
+        self.next().map(|arg| arg.bytes()).ok_or(eyre!("Missing argument"))
+    }
+}
+
+impl<'a> Iterator for AcpiArgs<'a> {
+    type Item = AcpiArgView<'a>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        let mut arg = AcpiArg {
+            type_: 0,
+            length: 0,
+            data: std::ptr::null(),
+        };
+
+        // The list came from AcpiOutputArgs or AcpiArgPackage over a buffer borrowed for 'a
+        if unsafe { AcpiArgNext(&mut self.list, &mut arg) } != 0 {
+            Some(AcpiArgView {
+                arg,
+                _buffer: PhantomData,
+            })
+        } else {
+            None
+        }
+    }
+}
+
+impl<'a> AcpiArgView<'a> {
+    pub fn type_(&self) -> u16 {
+        self.arg.type_
+    }
+
+    pub fn integer(&self) -> Option<u64> {
+        (self.arg.type_ == AcpiArgumentType::Integer as u16).then(|| unsafe { AcpiArgInteger(&self.arg) })
+    }
+
+    pub fn bytes(&self) -> &'a [u8] {
+        // Checked to lie inside the output buffer when the list was parsed
+        unsafe { std::slice::from_raw_parts(self.arg.data, self.arg.length as usize) }
+    }
+
+    pub fn package(&self) -> Option<AcpiArgs<'a>> {
+        let mut list = AcpiArgList {
+            next: std::ptr::null(),
+            end: std::ptr::null(),
+            count: 0,
+        };
+
+        match unsafe { AcpiArgPackage(&self.arg, &mut list) } {
+            ERROR_SUCCESS => Some(AcpiArgs {
+                list,
+                _buffer: PhantomData,
+            }),
+            _ => None,
+        }
+    }
 }
 
 #[derive(num_enum::IntoPrimitive, num_enum::TryFromPrimitive, Debug, Copy, Clone)]
@@ -275,6 +400,41 @@ impl Acpi {
         }
     }
 
+    /// Evaluates the provided method and hands its arguments to `parse` without copying them
+    /// out of the output buffer.
+    pub fn evaluate_view<T>(
+        name: &str,
+        args: Option<&[AcpiMethodArgument]>,
+        parse: impl FnOnce(AcpiArgs<'_>) -> Result<T>,
+    ) -> Result<T> {
+        if let Some(args) = args
+            && args.len() > 7
+        {
+            return Err(AcpiParseError::InsufficientLength.into());
+        }
+
+        let method = AcpiMethodInput { name, args };
+        let input = AcpiEvalInputBufferComplexV1Ex::try_from(method)?;
+        let in_buf: Vec<u8> = input.into();
+
+        let mut out_buf = [0u8; 1024];
+        let mut out_buf_len = out_buf.len();
+
+        let res = unsafe {
+            EvaluateAcpi(
+                in_buf.as_ptr() as *const i8,
+                in_buf.len(),
+                out_buf.as_mut_ptr(),
+                &mut out_buf_len,
+            )
+        };
+
+        match res {
+            ERROR_SUCCESS => parse(AcpiArgs::parse(&out_buf[..out_buf_len.min(out_buf.len())])?),
+            err => Err(AcpiParseError::EvaluationFailed(err).into()),
+        }
+    }
+
     /// Evaluates the provided method with the provided arguments and returns its single u32 result.
     /// Errors if the result is not a single u32.
     pub fn evaluate_u32(name: &str, args: Option<&[AcpiMethodArgument]>) -> Result<u32> {
@@ -365,71 +525,54 @@ impl Source for Acpi {
     }
 
     fn get_bst(&self) -> Result<BstReturn> {
-        let data = Acpi::evaluate("\\_SB.ECT0.TBST", None)?;
-
-        // We are expecting 4 32-bit values
-        if data.count != 4 {
-            Err(eyre!("GET_BST unrecognized output"))
-        } else {
-            Ok(BstReturn {
-                battery_state: BatteryState::from_bits(data.arguments[0].data_32)
-                    .ok_or(eyre!("Invalid BatteryState"))?,
-                battery_present_rate: data.arguments[1].data_32,
-                battery_remaining_capacity: data.arguments[2].data_32,
-                battery_present_voltage: data.arguments[3].data_32,
-            })
-        }
+        Acpi::evaluate_view("\\_SB.ECT0.TBST", None, |mut data| {
+            // We are expecting 4 32-bit values
+            if data.count() != 4 {
+                Err(eyre!("GET_BST unrecognized output"))
+            } else {
+                Ok(BstReturn {
+                    battery_state: BatteryState::from_bits(data.next_u32()?).ok_or(eyre!("Invalid BatteryState"))?,
+                    battery_present_rate: data.next_u32()?,
+                    battery_remaining_capacity: data.next_u32()?,
+                    battery_present_voltage: data.next_u32()?,
+                })
+            }
+        })
     }
 
     fn get_bix(&self) -> Result<BixFixedStrings> {
-        let data = Acpi::evaluate("\\_SB.ECT0.TBIX", None)?;
-        // We are expecting 21 arguments
-        if data.count != 21 {
-            Err(eyre!("GET_BIX unrecognized output"))
-        } else {
-            Ok(BixFixedStrings {
-                revision: data.arguments[0].data_32,
-                power_unit: power_unit_try_from_u32(data.arguments[1].data_32)
-                    .map_err(|_| eyre!("Invalid PowerUnit"))?,
-                design_capacity: data.arguments[2].data_32,
-                last_full_charge_capacity: data.arguments[3].data_32,
-                battery_technology: bat_tech_try_from_u32(data.arguments[4].data_32)
-                    .map_err(|_| eyre!("Invalid BatteryTechnology"))?,
-                design_voltage: data.arguments[5].data_32,
-                design_cap_of_warning: data.arguments[6].data_32,
-                design_cap_of_low: data.arguments[7].data_32,
-                cycle_count: data.arguments[8].data_32,
-                measurement_accuracy: data.arguments[9].data_32,
-                max_sampling_time: data.arguments[10].data_32,
-                min_sampling_time: data.arguments[11].data_32,
-                max_averaging_interval: data.arguments[12].data_32,
-                min_averaging_interval: data.arguments[13].data_32,
-                battery_capacity_granularity_1: data.arguments[14].data_32,
-                battery_capacity_granularity_2: data.arguments[15].data_32,
-                model_number: data.arguments[16]
-                    .data
-                    .clone()
-                    .try_into()
-                    .map_err(|_| eyre!("Invalid model number"))?,
-                serial_number: data.arguments[17]
-                    .data
-                    .clone()
-                    .try_into()
-                    .map_err(|_| eyre!("Invalid serial number"))?,
-                battery_type: data.arguments[18]
-                    .data
-                    .clone()
-                    .try_into()
-                    .map_err(|_| eyre!("Invalid battery type"))?,
-                oem_info: data.arguments[19]
-                    .data
-                    .clone()
-                    .try_into()
-                    .map_err(|_| eyre!("Invalid OEM info"))?,
-                battery_swapping_capability: bat_swap_try_from_u32(data.arguments[20].data_32)
-                    .map_err(|_| eyre!("Invalid BatterySwapCapability"))?,
-            })
-        }
+        Acpi::evaluate_view("\\_SB.ECT0.TBIX", None, |mut data| {
+            // We are expecting 21 arguments
+            if data.count() != 21 {
+                Err(eyre!("GET_BIX unrecognized output"))
+            } else {
+                Ok(BixFixedStrings {
+                    revision: data.next_u32()?,
+                    power_unit: power_unit_try_from_u32(data.next_u32()?).map_err(|_| eyre!("Invalid PowerUnit"))?,
+                    design_capacity: data.next_u32()?,
+                    last_full_charge_capacity: data.next_u32()?,
+                    battery_technology: bat_tech_try_from_u32(data.next_u32()?)
+                        .map_err(|_| eyre!("Invalid BatteryTechnology"))?,
+                    design_voltage: data.next_u32()?,
+                    design_cap_of_warning: data.next_u32()?,
+                    design_cap_of_low: data.next_u32()?,
+                    cycle_count: data.next_u32()?,
+                    measurement_accuracy: data.next_u32()?,
+                    max_sampling_time: data.next_u32()?,
+                    min_sampling_time: data.next_u32()?,
+                    max_averaging_interval: data.next_u32()?,
+                    min_averaging_interval: data.next_u32()?,
+                    battery_capacity_granularity_1: data.next_u32()?,
+                    battery_capacity_granularity_2: data.next_u32()?,
+                    model_number: data.next_bytes()?.try_into().map_err(|_| eyre!("Invalid model number"))?,
+                    serial_number: data.next_bytes()?.try_into().map_err(|_| eyre!("Invalid serial number"))?,
+                    battery_type: data.next_bytes()?.try_into().map_err(|_| eyre!("Invalid battery type"))?,
+                    oem_info: data.next_bytes()?.try_into().map_err(|_| eyre!("Invalid OEM info"))?,
+                    battery_swapping_capability: bat_swap_try_from_u32(data.next_u32()?)
+                        .map_err(|_| eyre!("Invalid BatterySwapCapability"))?,
+                })
+            }
+        })
     }
 
     fn set_btp(&self, trippoint: u32) -> Result<()> {
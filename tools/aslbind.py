@@ -0,0 +1,589 @@
+#!/usr/bin/env python3
+#
+# MIT License
+#
+# Copyright (c) 2025 Open Device Partnership
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Generates inc/ecmethods.h, C++ bindings of the methods in the ASL sources.
+
+Each method gets a struct with its request serialized at compile time by acpibind.h and a
+typed Build that copies it and patches in the argument values. Argument types come from the
+"// ArgN ..." comments above the Method:
+
+    "UUID" or "GUID"            16 byte buffer, const AcpiGuid_t&
+    "Package with A, B and C"   package of integers, one uint32_t parameter per element
+    "Package of up to N ... UUIDs"
+                                package of up to N UUIDs, pointer and count
+    "Package of up to N ... pairs"
+                                flattened package of up to N UUID and integer pairs
+    anything else               uint32_t integer
+
+Methods with an undocumented or buffer argument are listed at the end of the header and not
+bound. A "// Return ..." comment naming a Package or Buffer sets the result type, otherwise
+it is an Integer, or nothing if the method never returns a value.
+
+Each Case of a _DSM that calls a method of the same device becomes a binding of its own, with
+the UUID, revision 0 and function index in the template. Its Arg3 takes the type of the callee
+argument it is passed as, or is the Integer 0 when the case does not use it.
+
+Usage: aslbind.py [-scope \\_SB] [-o inc/ecmethods.h] ectest.asl thermal.asl
+"""
+
+import os
+import re
+import sys
+
+ARG_HEADER = 4
+MIN_DATA = 4
+REQ_HEADER = 268
+GUID_SIZE = 16
+INTEGER_ARG = ARG_HEADER + MIN_DATA
+GUID_ARG = ARG_HEADER + GUID_SIZE
+
+STOPWORDS = {'a', 'an', 'the', 'of', 'is', 'to', 'with', 'for', 'up'}
+
+
+class AslError(Exception):
+    pass
+
+
+class Arg:
+    """One argument of a binding. kind is int, guid, fixed, guids or pairs."""
+
+    def __init__(self, kind, name, elements=None, maximum=0, const=None):
+        self.kind = kind
+        self.name = name
+        self.elements = elements or []  # Names of the integers of a fixed package
+        self.maximum = maximum          # Elements of a variable package
+        self.const = const              # Value baked into the template, no parameter
+
+    def size(self):
+        if self.kind == 'int':
+            return INTEGER_ARG
+        if self.kind == 'guid':
+            return GUID_ARG
+        return ARG_HEADER + self.maximum * self.stride()
+
+    def stride(self):
+        return {'fixed': INTEGER_ARG, 'guids': GUID_ARG, 'pairs': GUID_ARG + INTEGER_ARG}[self.kind]
+
+    def variable(self):
+        return self.kind in ('guids', 'pairs')
+
+
+class Method:
+    def __init__(self, device, name, argc, comments, body):
+        self.device = device
+        self.name = name
+        self.argc = argc
+        self.comments = comments
+        self.body = body
+
+
+class Binding:
+    def __init__(self, path, ident, doc, args, result):
+        self.path = path
+        self.ident = ident
+        self.doc = doc
+        self.args = args
+        self.result = result
+
+
+def identifier(name):
+    # Names such as _TMP are reserved in C++
+    return name.lstrip('_') or name
+
+
+def camel(text):
+    words = [w for w in re.findall(r'[A-Za-z0-9]+', text) if w.lower() not in STOPWORDS]
+    uuid = [w for w in words if w.lower() in ('uuid', 'guid')]
+    words = [w for w in words if w.lower() not in ('uuid', 'guid')][:3] + uuid[:1]
+    if not words:
+        raise AslError('no name in "%s"' % text)
+    name = words[0].lower() + ''.join(w[:1].upper() + w[1:].lower() for w in words[1:])
+    return name if not name[0].isdigit() else 'arg' + name
+
+
+def device_path(scope, name):
+    segments = [s.rstrip('_') or s for s in name.lstrip('\\').split('.')]
+    if name.startswith('\\'):
+        return '\\' + '.'.join(segments)
+    return scope + '.' + '.'.join(segments)
+
+
+def parse_methods(path, scope):
+    """Returns the methods of an ASL file with the comment block above each of them."""
+    methods = []
+    devices = []            # (path, brace depth inside the device)
+    depth = 0
+    comments = []
+    method = None           # (Method, depth it closes at)
+    pending = None          # Device or Method waiting for its opening brace
+
+    with open(path, encoding='utf-8') as f:
+        lines = f.read().splitlines()
+
+    for line in lines:
+        stripped = line.strip()
+        code = stripped.split('//', 1)[0]
+
+        if method is not None:
+            method[0].body.append(line)
+        elif stripped.startswith('//'):
+            comments.append(stripped[2:].strip())
+        elif stripped:
+            m = re.match(r'Device\s*\(\s*([\\\w.]+)\s*\)', code)
+            if m:
+                pending = ('device', device_path(devices[-1][0] if devices else scope, m.group(1)))
+            m = re.match(r'Method\s*\(\s*(\w+)\s*(?:,\s*(0x[0-9a-fA-F]+|\d+))?', code)
+            if m and devices:
+                argc = int(m.group(2), 0) if m.group(2) else 0
+                pending = ('method', Method(devices[-1][0], m.group(1), argc, comments, []))
+            comments = []
+        else:
+            comments = []
+
+        for c in code:
+            if c == '{':
+                depth += 1
+                if pending is not None:
+                    if pending[0] == 'device':
+                        devices.append((pending[1], depth))
+                    else:
+                        method = (pending[1], depth)
+                        methods.append(pending[1])
+                    pending = None
+            elif c == '}':
+                if method is not None and method[1] == depth:
+                    method = None
+                if devices and devices[-1][1] == depth:
+                    devices.pop()
+                depth -= 1
+
+    return methods
+
+
+def argument_docs(method):
+    """Returns {index: text} of the ArgN comments, continuation lines joined, and the Return text."""
+    docs = {}
+    result = None
+    last = None
+    for c in method.comments:
+        m = re.match(r'Arg(\d)\s*(?:==|is)?\s*(.*)', c)
+        if m:
+            last = int(m.group(1))
+            docs[last] = m.group(2)
+        elif re.match(r'Return\b', c):
+            result = c
+            last = None
+        elif last is not None and c:
+            docs[last] += '\n' + c
+    return docs, result
+
+
+def argument(text):
+    first = text.split('\n')[0]
+    lower = first.lower()
+    if 'package' in lower:
+        m = re.search(r'up to (\d+)', lower)
+        if m and 'pairs' in lower:
+            return Arg('pairs', 'count', maximum=int(m.group(1)))
+        if m and ('uuids' in lower or 'guids' in lower):
+            return Arg('guids', 'count', maximum=int(m.group(1)))
+        m = re.search(r'with (.+?)(?: set points| values)?$', first)
+        if m:
+            names = [camel(n) for n in re.split(r',\s*|\s+and\s+', m.group(1))]
+            return Arg('fixed', camel(first), elements=names, maximum=len(names))
+        raise AslError('package "%s" has no elements' % first)
+    if 'buffer' in lower:
+        raise AslError('buffer argument')
+    if 'uuid' in lower or 'guid' in lower:
+        return Arg('guid', camel(first))
+    return Arg('int', camel(first))
+
+
+def result_kind(method, text):
+    if text is not None:
+        lower = text.lower()
+        if 'buffer' in lower:
+            return 'any'
+        if 'package' in lower:
+            return 'package'
+        return 'integer'
+    body = '\n'.join(method.body)
+    if re.search(r'Return\s*\(\s*Package', body):
+        return 'package'
+    if re.search(r'\bReturn\s*\(', body):
+        return 'integer'
+    return 'none'
+
+
+def bind_method(method):
+    docs, result = argument_docs(method)
+    missing = [i for i in range(method.argc) if i not in docs]
+    if missing:
+        raise AslError('Arg%d is not documented' % missing[0])
+    args = [argument(docs[i]) for i in range(method.argc)]
+    for a in args[:-1]:
+        if a.variable():
+            raise AslError('variable package is not the last argument')
+    doc = ['Arg%d %s' % (i, docs[i].split('\n')[0]) for i in range(method.argc)]
+    if result is not None:
+        doc.append(result)
+    return Binding(method.device + '.' + method.name, identifier(method.name), doc, args,
+                   result_kind(method, result))
+
+
+def split_args(text):
+    args, depth, start = [], 0, 0
+    for i, c in enumerate(text):
+        if c == '(':
+            depth += 1
+        elif c == ')':
+            depth -= 1
+        elif c == ',' and depth == 0:
+            args.append(text[start:i].strip())
+            start = i + 1
+    args.append(text[start:].strip())
+    return args
+
+
+def parse_uuid(text):
+    m = re.fullmatch(r'ToU[Uu][Ii][Dd]\s*\(\s*"([0-9a-fA-F-]{36})"\s*\)', text.strip())
+    return m.group(1).lower() if m else None
+
+
+def bind_dsm(method, bindings, uuids):
+    """Returns {label: [Binding]} for the cases of a _DSM and records the UUIDs it names."""
+    docs, _ = argument_docs(method)
+    labels = {}
+    for line in docs.get(0, '').split('\n'):
+        m = re.search(r'([0-9a-fA-F-]{36})(?:\s*-\s*(\w+))?', line)
+        if m and m.group(2):
+            labels[m.group(1).lower()] = m.group(2)
+
+    groups = {}
+    current = None
+    case = None
+    for line in method.body:
+        code, _, comment = line.partition('//')
+        m = re.search(r'If\s*\(\s*LEqual\s*\(\s*(ToU[Uu][Ii][Dd]\s*\(\s*"[^"]+"\s*\))\s*,\s*Arg0\s*\)', code)
+        if m:
+            dsm = parse_uuid(m.group(1))
+            current = (dsm, labels.get(dsm, 'Dsm'))
+            uuids.setdefault(method.device, {})[current[1]] = dsm
+            case = None
+            continue
+        m = re.search(r'Case\s*\(\s*(\d+)\s*\)', code)
+        if m:
+            case = int(m.group(1))
+            continue
+        m = re.search(r'Return\s*\(\s*(\w+)\s*\((.*)\)\s*\)', code)
+        if current is None or case is None or case == 0 or not m:
+            continue
+
+        callee = bindings.get(method.device + '.' + m.group(1))
+        if callee is None:
+            raise AslError('case %d calls %s, which is not bound' % (case, m.group(1)))
+        comment = comment.strip()
+        name = comment if re.fullmatch(r'[A-Za-z]\w*', comment) else callee.ident
+
+        arg3 = Arg('int', 'arg3', const=0)
+        for i, a in enumerate(split_args(m.group(2))):
+            if a == 'Arg3':
+                arg3 = callee.args[i]
+            value = parse_uuid(a)
+            if value is not None and re.fullmatch(r'[A-Za-z]\w*', comment):
+                uuids.setdefault(method.device, {})[comment] = value
+
+        doc = ['%s function %d, %s' % (current[0], case, callee.path)]
+        doc += [d for d in callee.doc if d.startswith('Return')]
+        args = [Arg('guid', 'uuid', const=current[0]), Arg('int', 'revision', const=0),
+                Arg('int', 'function', const=case), arg3]
+        groups.setdefault(current[1], []).append(
+            Binding(method.device + '.' + method.name, name, doc, args, callee.result))
+    return groups
+
+
+def guid_initializer(text):
+    h = text.replace('-', '')
+    b = [h[i:i + 2] for i in range(16, 32, 2)]
+    return '{ 0x%s, 0x%s, 0x%s, { %s } }' % (h[0:8], h[8:12], h[12:16], ', '.join('0x' + x for x in b))
+
+
+def uuid_expression(text, device_uuids):
+    for name, value in device_uuids.items():
+        if value == text:
+            return 'Uuid::' + name
+    return 'AcpiGuid_t' + guid_initializer(text)
+
+
+def emit_binding(out, b, indent, device_uuids):
+    pad = ' ' * indent
+    capacity = REQ_HEADER + sum(a.size() for a in b.args)
+
+    # Template and the offsets of the values to patch
+    chain = []
+    params = []
+    patches = []
+    offset = REQ_HEADER
+    last = None
+    for a in b.args:
+        if a.kind == 'int':
+            chain.append('.Integer(%s)' % (a.const if a.const is not None else 0))
+            if a.const is None:
+                params.append('uint32_t ' + a.name)
+                patches.append('acpibind::Patch32(request, %d, %s);' % (offset + ARG_HEADER, a.name))
+        elif a.kind == 'guid':
+            if a.const is not None:
+                chain.append('.Guid(%s)' % uuid_expression(a.const, device_uuids))
+            else:
+                chain.append('.Guid({})')
+                params.append('const AcpiGuid_t& ' + a.name)
+                patches.append('acpibind::PatchGuid(request, %d, %s);' % (offset + ARG_HEADER, a.name))
+        elif a.kind == 'fixed':
+            chain.append('.Package()' + '.Integer(0)' * a.maximum + '.EndPackage()')
+            for i, e in enumerate(a.elements):
+                params.append('uint32_t ' + e)
+                patches.append('acpibind::Patch32(request, %d, %s);' %
+                               (offset + ARG_HEADER + i * INTEGER_ARG + ARG_HEADER, e))
+        else:
+            element = '.Guid({})' if a.kind == 'guids' else '.Guid({}).Integer(0)'
+            chain.append('.Package()' + element * a.maximum + '.EndPackage()')
+            params.append('const AcpiGuid_t* uuids')
+            if a.kind == 'pairs':
+                params.append('const uint32_t* values')
+            params.append('uint32_t count')
+            last = (a, offset)
+        offset += a.size()
+    chain.append('.End()')
+
+    for line in b.doc:
+        out.append(pad + '// ' + line)
+    out.append(pad + 'struct %s {' % b.ident)
+    out.append(pad + '    static constexpr size_t Length = %d;' % capacity)
+    out.append('')
+    out.append(pad + '    static const acpibind::Image<Length>& Template()')
+    out.append(pad + '    {')
+    out.append(pad + '        static constexpr acpibind::Image<Length> image =')
+    out.append(pad + '            acpibind::Image<Length>("%s")' % b.path.replace('\\', '\\\\'))
+    for c in chain:
+        out.append(pad + '                ' + c)
+    out[-1] += ';'
+    out.append(pad + '        static_assert(image.Length() == Length, "template does not match the generated offsets");')
+    out.append(pad + '        return image;')
+    out.append(pad + '    }')
+    out.append('')
+
+    comment = 'Request in request, at least Length bytes. Returns the bytes to send'
+    if last is not None:
+        comment += ', 0 if count is not 1 to %d' % last[0].maximum
+    out.append(pad + '    // ' + comment + '.')
+    out.append(pad + '    static size_t Build(%s)' % ', '.join(['void* request'] + params))
+    out.append(pad + '    {')
+    if last is not None:
+        a, base = last
+        out.append(pad + '        if (count == 0 || count > %d) {' % a.maximum)
+        out.append(pad + '            return 0;')
+        out.append(pad + '        }')
+        out.append(pad + '        const size_t length = %d + count * %d;' % (base + ARG_HEADER, a.stride()))
+        out.append(pad + '        memcpy(request, Template().Data(), length);')
+    else:
+        out.append(pad + '        memcpy(request, Template().Data(), Length);')
+    for p in patches:
+        out.append(pad + '        ' + p)
+    if last is not None:
+        a, base = last
+        out.append(pad + '        for (uint32_t i = 0; i < count; i++) {')
+        element = base + ARG_HEADER
+        out.append(pad + '            acpibind::PatchGuid(request, %d + i * %d, uuids[i]);' %
+                   (element + ARG_HEADER, a.stride()))
+        if a.kind == 'pairs':
+            out.append(pad + '            acpibind::Patch32(request, %d + i * %d, values[i]);' %
+                       (element + GUID_ARG + ARG_HEADER, a.stride()))
+        out.append(pad + '        }')
+        out.append(pad + '        return acpibind::Trim(request, %d, length);' % base)
+    else:
+        out.append(pad + '        return Length;')
+    out.append(pad + '    }')
+
+    result = {
+        'integer': ('uint64_t& value', 'acpibind::Integer(output, length, value)'),
+        'package': ('acpiview::ArgList& elements', 'acpibind::Package(output, length, elements)'),
+        'any': ('acpiview::Arg& value', 'acpibind::Any(output, length, value)'),
+    }.get(b.result)
+    if result is not None:
+        out.append('')
+        out.append(pad + '    static bool Result(const void* output, size_t length, %s)' % result[0])
+        out.append(pad + '    {')
+        out.append(pad + '        return %s;' % result[1])
+        out.append(pad + '    }')
+    out.append(pad + '};')
+    out.append('')
+
+
+def generate(sources, scope, header_sources):
+    methods = []
+    for source in sources:
+        methods += parse_methods(source, scope)
+
+    bindings = {}
+    skipped = []
+    for m in methods:
+        if m.name == '_DSM':
+            continue
+        try:
+            b = bind_method(m)
+        except AslError as e:
+            skipped.append('%s.%s, %s' % (m.device, m.name, e))
+            continue
+        bindings[b.path] = b
+
+    uuids = {}
+    dsms = {}
+    for m in methods:
+        if m.name == '_DSM':
+            dsms[m.device] = bind_dsm(m, bindings, uuids)
+
+    devices = []
+    for m in methods:
+        if m.device not in devices:
+            devices.append(m.device)
+
+    out = []
+    out.append('// Generated by tools/aslbind.py from %s, do not edit.' % ' and '.join(header_sources))
+    out.append('// Run "python3 tools/aslbind.py" from the root of the repository after changing the ASL.')
+    out.append('')
+    out.append('#pragma once')
+    out.append('')
+    out.append('#include "acpibind.h"')
+    out.append('')
+    out.append('namespace ecmethods {')
+    out.append('')
+
+    for device in devices:
+        ident = identifier(device.split('.')[-1])
+        members = [b for b in bindings.values() if b.path.rsplit('.', 1)[0] == device]
+        if not members and device not in dsms:
+            continue
+        names = [b.ident for b in members] + list(dsms.get(device, {}).keys())
+        if len(set(names)) != len(names):
+            raise AslError('%s has clashing binding names' % device)
+
+        out.append('// %s' % device)
+        out.append('namespace %s {' % ident)
+        out.append('')
+        device_uuids = uuids.get(device, {})
+        if device_uuids:
+            out.append('namespace Uuid {')
+            for name, value in device_uuids.items():
+                out.append('constexpr AcpiGuid_t %s = %s; // %s' % (name, guid_initializer(value), value))
+            out.append('} // namespace Uuid')
+            out.append('')
+        for b in members:
+            emit_binding(out, b, 0, device_uuids)
+        for label, group in dsms.get(device, {}).items():
+            out.append('// _DSM %s' % device_uuids[label])
+            out.append('namespace %s {' % label)
+            out.append('')
+            for b in group:
+                emit_binding(out, b, 0, device_uuids)
+            out.append('} // namespace %s' % label)
+            out.append('')
+        out.append('} // namespace %s' % ident)
+        out.append('')
+
+    out.append('// Every method of the ASL, bound or not, with the arguments it declares')
+    out.append('constexpr acpibind::MethodInfo Methods[] = {')
+    for m in methods:
+        out.append('    { "%s", %d },' % ((m.device + '.' + m.name).replace('\\', '\\\\'), m.argc))
+    out.append('};')
+    out.append('')
+    out.append('} // namespace ecmethods')
+    if skipped:
+        out.append('')
+        out.append('// Not bound:')
+        for s in skipped:
+            out.append('//   %s' % s)
+    return '\n'.join(out) + '\n'
+
+
+LICENSE = """/*
+MIT License
+
+Copyright (c) 2025 Open Device Partnership
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+"""
+
+
+def main(argv):
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    tables = os.path.join(root, 'uefi', 'Platforms', 'QemuSbsaPkg', 'AcpiTables')
+    scope = '\\_SB'
+    output = os.path.join(root, 'inc', 'ecmethods.h')
+    sources = []
+
+    i = 1
+    while i < len(argv):
+        if argv[i] == '-scope' and i + 1 < len(argv):
+            scope = argv[i + 1]
+            i += 2
+        elif argv[i] == '-o' and i + 1 < len(argv):
+            output = argv[i + 1]
+            i += 2
+        else:
+            sources.append(argv[i])
+            i += 1
+    if not sources:
+        sources = [os.path.join(tables, 'ectest.asl'), os.path.join(tables, 'thermal.asl')]
+
+    try:
+        text = generate(sources, scope, [os.path.basename(s) for s in sources])
+    except (AslError, OSError) as e:
+        print('aslbind: %s' % e, file=sys.stderr)
+        return 1
+
+    with open(output, 'w', encoding='utf-8', newline='\n') as f:
+        f.write(LICENSE + text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
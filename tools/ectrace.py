@@ -0,0 +1,310 @@
+#!/usr/bin/env python3
+#
+# MIT License
+#
+# Copyright (c) 2025 Open Device Partnership
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Converts a trace written by eclib StartTrace, ectest -trace, to Chrome trace JSON.
+
+The JSON loads in https://ui.perfetto.dev or chrome://tracing with one track per layer a
+request goes through:
+
+    eclib           calls into eclib, named after the method
+    queue           waiting in the driver priority queues
+    work item       driver work item, from pick up to completion
+    ACPI            evaluation by the ACPI driver and the AML
+    RX ring         waits for a sequence number on the shared memory RX ring
+    notifications   ACPI notifications, doorbells included, and the ones eclib handed out
+
+Overlapping requests are spread over extra tracks of the same layer. Spans of one call carry its
+correlation ID and are chained by flow arrows. An evaluation that returned an RX sequence
+number, as ASYQ does, is linked to the next wait on that sequence. A notification that arrived
+while exactly one evaluation was in ACPI, like the doorbell that completes ASYC, names it.
+
+The trace layout is described in inc/ectrace.h, the driver events in inc/ectest.h.
+
+Usage: ectrace.py trace.ect [-o trace.json]
+"""
+
+import json
+import struct
+import sys
+
+TRACE_SIGNATURE = 0x72544345
+TRACE_VERSION = 1
+HEADER = struct.Struct('<IHHQQQ')
+EVENT = struct.Struct('<QIHHII')
+
+# TIMELINE_* in ectest.h
+EVAL_QUEUED = 0x01
+EVAL_START = 0x02
+ACPI_BEGIN = 0x03
+ACPI_END = 0x04
+EVAL_DONE = 0x05
+RX_WAIT = 0x06
+RX_DONE = 0x07
+NOTIFY = 0x08
+CORRELATION_DRIVER = 0x80000000
+
+# EC_TRACE_* in ectrace.h
+CALL_BEGIN = 0x10
+CALL_END = 0x11
+NAME = 0x12
+LOST = 0x13
+APP_NOTIFY = 0x14
+
+LAYERS = ['eclib', 'queue', 'work item', 'ACPI', 'RX ring', 'notifications']
+LANES = 100
+PID = 1
+
+# Event that opens a span, the event that closes it and the layer it belongs to
+OPEN = {CALL_BEGIN: 'eclib', EVAL_QUEUED: 'queue', EVAL_START: 'work item',
+        ACPI_BEGIN: 'ACPI', RX_WAIT: 'RX ring'}
+CLOSE = {CALL_END: 'eclib', EVAL_START: 'queue', EVAL_DONE: 'work item',
+         ACPI_END: 'ACPI', RX_DONE: 'RX ring'}
+
+PRIORITY = ['critical', 'normal', 'bulk']
+
+
+class TraceError(Exception):
+    pass
+
+
+class Span:
+    def __init__(self, layer, event):
+        self.layer = layer
+        self.correlation = event['correlation']
+        self.begin = event['time']
+        self.end = None
+        self.open = event
+        self.close = None
+        self.lane = 0
+
+
+def read_trace(path):
+    """Returns the header fields and the events of a trace in time order."""
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    if len(data) < HEADER.size:
+        raise TraceError('%s: too short for a trace' % path)
+    signature, version, size, frequency, base, _ = HEADER.unpack_from(data, 0)
+    if signature != TRACE_SIGNATURE or version != TRACE_VERSION or frequency == 0:
+        raise TraceError('%s: not a version %u trace' % (path, TRACE_VERSION))
+
+    names = {}
+    events = []
+    offset = size
+    while offset + EVENT.size <= len(data):
+        time, correlation, kind, sequence, value, reserved = EVENT.unpack_from(data, offset)
+        offset += EVENT.size
+        if kind == NAME:
+            units = (reserved + EVENT.size - 1) // EVENT.size
+            names[value] = data[offset:offset + reserved].decode('ascii', 'replace')
+            offset += units * EVENT.size
+            continue
+        events.append({'time': time, 'correlation': correlation, 'kind': kind,
+                       'sequence': sequence, 'value': value, 'index': len(events)})
+
+    # Driver and eclib events are written in batches, stable so ties keep their order
+    events.sort(key=lambda e: (e['time'], e['index']))
+    return frequency, base, names, events
+
+
+def pair_spans(events, names):
+    """Matches the events that open and close a span by layer and correlation ID."""
+    spans = []
+    pending = {}
+    instants = []
+    calls = {}
+
+    for e in events:
+        kind = e['kind']
+        if kind == CALL_BEGIN:
+            calls[e['correlation']] = names.get(e['value'], 'call %u' % e['value'])
+        if kind in CLOSE:
+            key = (CLOSE[kind], e['correlation'], e['sequence'] if kind == RX_DONE else 0)
+            span = pending.pop(key, None)
+            if span is not None:
+                span.end = e['time']
+                span.close = e
+        if kind in OPEN:
+            key = (OPEN[kind], e['correlation'], e['sequence'] if kind == RX_WAIT else 0)
+            span = Span(OPEN[kind], e)
+            pending[key] = span
+            spans.append(span)
+        if kind in (NOTIFY, APP_NOTIFY, LOST):
+            instants.append(e)
+
+    return spans, instants, calls
+
+
+def assign_lanes(spans, last):
+    """Puts overlapping spans of a layer on separate lanes so every lane nests properly."""
+    lanes = {}
+    for span in sorted(spans, key=lambda s: s.begin):
+        if span.end is None:
+            span.end = last
+        ends = lanes.setdefault(span.layer, [])
+        for i, end in enumerate(ends):
+            if end <= span.begin:
+                span.lane = i
+                ends[i] = span.end
+                break
+        else:
+            span.lane = min(len(ends), LANES - 1)
+            ends.append(span.end)
+    return lanes
+
+
+def tid(layer, lane=0):
+    return LAYERS.index(layer) * LANES + lane + 1
+
+
+def span_name(span, calls):
+    e = span.open
+    if span.layer == 'queue':
+        priority = e['value']
+        return 'queued %s' % (PRIORITY[priority] if priority < len(PRIORITY) else priority)
+    if span.layer == 'RX ring':
+        return 'sequence %u' % e['sequence']
+    return calls.get(span.correlation, 'request')
+
+
+def convert(frequency, base, names, events):
+    trace = []
+    last = events[-1]['time'] if events else base
+
+    def us(time):
+        return (time - base) * 1000000.0 / frequency
+
+    spans, instants, calls = pair_spans(events, names)
+    lanes = assign_lanes(spans, last)
+
+    trace.append({'ph': 'M', 'pid': PID, 'name': 'process_name', 'args': {'name': 'ectest'}})
+    for layer in LAYERS:
+        for lane in range(max(1, len(lanes.get(layer, [])))):
+            label = layer if lane == 0 else '%s #%u' % (layer, lane + 1)
+            trace.append({'ph': 'M', 'pid': PID, 'tid': tid(layer, lane), 'name': 'thread_name',
+                          'args': {'name': label}})
+            trace.append({'ph': 'M', 'pid': PID, 'tid': tid(layer, lane), 'name': 'thread_sort_index',
+                          'args': {'sort_index': tid(layer, lane)}})
+
+    for span in spans:
+        args = {'correlation': '0x%08x' % span.correlation}
+        if span.correlation & CORRELATION_DRIVER:
+            args['assigned'] = 'driver'
+        if span.close is None:
+            args['incomplete'] = True
+        elif span.layer == 'eclib':
+            args['status'] = span.close['value']
+        elif span.layer in ('work item', 'ACPI', 'RX ring'):
+            args['status'] = '0x%08x' % span.close['value']
+        if span.open['sequence'] != 0:
+            args['sequence'] = span.open['sequence']
+        if span.layer == 'ACPI' and span.close is not None and span.close['sequence'] != 0:
+            args['result'] = span.close['sequence']
+        trace.append({'ph': 'X', 'pid': PID, 'tid': tid(span.layer, span.lane), 'name': span_name(span, calls),
+                      'cat': span.layer, 'ts': us(span.begin), 'dur': us(span.end) - us(span.begin),
+                      'args': args})
+
+    # Flow through the layers of each call in the order it reached them
+    chains = {}
+    for span in sorted(spans, key=lambda s: (s.begin, LAYERS.index(s.layer))):
+        if span.correlation != 0:
+            chains.setdefault(span.correlation, []).append(span)
+    for correlation, chain in chains.items():
+        for i, span in enumerate(chain if len(chain) > 1 else []):
+            phase = 's' if i == 0 else 'f' if i == len(chain) - 1 else 't'
+            flow = {'ph': phase, 'pid': PID, 'tid': tid(span.layer, span.lane), 'name': 'request',
+                    'cat': 'correlation', 'id': correlation, 'ts': us(span.begin)}
+            if phase == 'f':
+                flow['bp'] = 'e'
+            trace.append(flow)
+
+    # Evaluation that returned an RX sequence to the next wait on it
+    acpi = [s for s in spans if s.layer == 'ACPI' and s.close is not None and s.close['sequence'] != 0]
+    waits = sorted((s for s in spans if s.layer == 'RX ring'), key=lambda s: s.begin)
+    for n, span in enumerate(acpi):
+        wait = next((w for w in waits if w.begin >= span.end and w.open['sequence'] == span.close['sequence']), None)
+        if wait is None:
+            continue
+        flow = 'sequence %u #%u' % (span.close['sequence'], n)
+        trace.append({'ph': 's', 'pid': PID, 'tid': tid('ACPI', span.lane), 'name': 'RX sequence',
+                      'cat': 'sequence', 'id': flow, 'ts': us(span.begin)})
+        trace.append({'ph': 'f', 'pid': PID, 'tid': tid('RX ring', wait.lane), 'name': 'RX sequence',
+                      'cat': 'sequence', 'id': flow, 'ts': us(wait.begin), 'bp': 'e'})
+
+    in_acpi = [s for s in spans if s.layer == 'ACPI']
+    for e in instants:
+        if e['kind'] == LOST:
+            trace.append({'ph': 'i', 'pid': PID, 'tid': tid('notifications'), 's': 'g',
+                          'name': '%u driver events lost' % e['value'], 'ts': us(e['time'])})
+            continue
+        args = {'value': '0x%02x' % e['value']}
+        if e['kind'] == NOTIFY:
+            name = 'Notify 0x%02x' % e['value']
+            during = [s for s in in_acpi if s.begin <= e['time'] <= s.end]
+            if len(during) == 1:
+                args['during'] = calls.get(during[0].correlation, 'request')
+                args['correlation'] = '0x%08x' % during[0].correlation
+        else:
+            name = 'eclib Notify 0x%02x' % e['value']
+        trace.append({'ph': 'i', 'pid': PID, 'tid': tid('notifications'), 's': 't', 'name': name,
+                      'ts': us(e['time']), 'args': args})
+
+    return {'traceEvents': trace, 'displayTimeUnit': 'ns'}
+
+
+def main(argv):
+    source = None
+    output = None
+
+    i = 1
+    while i < len(argv):
+        if argv[i] == '-o' and i + 1 < len(argv):
+            output = argv[i + 1]
+            i += 2
+        elif source is None:
+            source = argv[i]
+            i += 1
+        else:
+            print(__doc__.strip().splitlines()[-1], file=sys.stderr)
+            return 1
+    if source is None:
+        print(__doc__.strip().splitlines()[-1], file=sys.stderr)
+        return 1
+    if output is None:
+        output = source.rsplit('.', 1)[0] + '.json'
+
+    try:
+        trace = convert(*read_trace(source))
+    except (TraceError, OSError) as e:
+        print('ectrace: %s' % e, file=sys.stderr)
+        return 1
+
+    with open(output, 'w', encoding='utf-8', newline='\n') as f:
+        json.dump(trace, f, separators=(',', ':'))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
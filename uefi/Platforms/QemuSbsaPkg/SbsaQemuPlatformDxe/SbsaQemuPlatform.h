@@ -1,112 +1,190 @@
-// SbsaQemuPlatform.h
-// Definitions for mapping shared memory and RX/TX buffers with SP
-
-#define SBSAQEMU_RESERVED_MEMORY_BASE 0x10060000000
-#define SBSAQEMU_RESERVED_MEMORY_SIZE 0x100000 // Reserve 1MB
-
-#define SBSAQEMU_SHARED_MEM_BASE 0x10060000000
-#define SBSAQEMU_SHARED_MEM_PAGE_COUNT 0x8
-
-#define SBSAQEMU_TX_BUFFER_BASE 0x10060080000
-#define SBSAQEMU_RX_BUFFER_BASE 0x10060090000
-#define EC_SVC_TX_BUFFER_BASE 0x100600A0000
-#define EC_SVC_RX_BUFFER_BASE 0x100600B0000
-
-#define EC_SERVICE_VMID 0x8002
-
-// This just needs ot be unique value use ascii of SBSAQEMU
-#define SBSAQEMU_SHARED_MEM_TAG 0x5342534151454D55
-#define EC_SVC_MANAGEMENT_GUID_LO 0xfde54757330c1273
-#define EC_SVC_MANAGEMENT_GUID_HI 0x3903750298195b65
-
-// Commands to send to EC management service
-#define EC_CAP_MAP_SHARE 0x5
-
-#define FFA_VERSION_SMC 0x84000063
-#define FFA_RXTX_MAP_SMC 0xC4000066
-#define FFA_RXTX_UNMAP_SMC 0x84000067
-#define FFA_MEM_SHARE_SMC 0x84000073
-#define FFA_MSG_SEND_DIRECT_REQ2_SMC 0xC400008D
-
-typedef UINT16 ffa_id_t;
-typedef UINT32 ffa_memory_region_flags_t;
-typedef UINT64 ffa_memory_handle_t;
-
-
-typedef struct {
-	UINT8 data_access : 2;
-	UINT8 instruction_access : 2;
-} ffa_memory_access_permissions_t;
-
-struct ffa_memory_access_impdef {
-	UINT64 val[2];
-};
-
-typedef struct {
-	UINT64 address;
-	UINT32 page_count;
-	UINT32 reserved;
-} memory_region_t;
-
-typedef struct {
-	UINT32 total_page_count;
-	UINT32 address_range_count;
-	UINT64 reserved;
-	memory_region_t regions[1];
-} composite_memory_region_t;
-
-typedef struct {
-  UINT16 id;
-  UINT8 perm;
-  UINT8 flags;
-} ffa_memory_attributes_t;
-
-typedef struct {
-  UINT64 impl_def[2];
-} ffa_memory_access_impdef_t;
-
-typedef struct {
-	ffa_memory_attributes_t receiver_permissions;
-	/**
-	 * Offset in bytes from the start of the outer `ffa_memory_region` to
-	 * an `ffa_composite_memory_region` struct.
-	 */
-	UINT32 composite_memory_region_offset;
-	//ffa_memory_access_impdef_t impldef;
-  UINT64 reserved_0;
-}ffa_memory_access_t;
-
-
-typedef struct {
-	/**
-	 * The ID of the VM which originally sent the memory region, i.e. the
-	 * owner.
-	 */
-	ffa_id_t sender;
-	UINT16 attributes;
-	/** Flags to control behaviour of the transaction. */
-	ffa_memory_region_flags_t flags;
-	ffa_memory_handle_t handle;
-	/**
-	 * An implementation defined value associated with the receiver and the
-	 * memory region.
-	 */
-	UINT64 tag;
-	/* Size of the memory access descriptor. */
-	UINT32 memory_access_desc_size;
-	/**
-	 * The number of `ffa_memory_access` entries included in this
-	 * transaction.
-	 */
-	UINT32 receiver_count;
-	/**
-	 * Offset of the 'ffa_memory_access' field, which relates to the memory access
-	 * descriptors.
-	 */
-	UINT32 receivers_offset;
-	/** Reserved field (12 bytes) must be 0. */
-	UINT32 reserved[3];
-
-//	ffa_memory_access_t memory_access;
-//	composite_memory_region_t memory_region;
-} ffa_memory_region_t;
\ No newline at end of file
+// SbsaQemuPlatform.h
+// Definitions for mapping shared memory and RX/TX buffers with SP
+
+#define SBSAQEMU_RESERVED_MEMORY_BASE 0x10060000000
+#define SBSAQEMU_RESERVED_MEMORY_SIZE 0x200000 // Reserve 2MB
+
+#define SBSAQEMU_SHARED_MEM_BASE 0x10060000000
+
+// Async ring geometry, change these to scale the rings. Entry size must be a multiple of 0x100
+// up to 0x1000 and slot count 1 to 64. Layout must match inc/ecring.h
+#define SBSAQEMU_RING_SLOT_COUNT 8
+#define SBSAQEMU_RING_ENTRY_SIZE 0x100
+
+#define SBSAQEMU_RING_ALIGN_UP(v, a) (((v) + (a) - 1) & ~((a) - 1))
+#define SBSAQEMU_RING_ENTRY_OFFSET SBSAQEMU_RING_ALIGN_UP(0x8 + SBSAQEMU_RING_SLOT_COUNT * 8, 0x100)
+#define SBSAQEMU_RING_SIZE SBSAQEMU_RING_ALIGN_UP(SBSAQEMU_RING_ENTRY_OFFSET + SBSAQEMU_RING_SLOT_COUNT * SBSAQEMU_RING_ENTRY_SIZE, EFI_PAGE_SIZE)
+
+// EC log stream ring, a power of two from 4KB to 1MB. Layout must match EC_LOG_* in inc/ecring.h
+#define SBSAQEMU_LOG_DATA_SIZE 0x10000
+#define SBSAQEMU_LOG_HEADER_SIZE 0x40
+#define SBSAQEMU_LOG_SIZE SBSAQEMU_RING_ALIGN_UP(SBSAQEMU_LOG_HEADER_SIZE + SBSAQEMU_LOG_DATA_SIZE, EFI_PAGE_SIZE)
+#define SBSAQEMU_LOG_TABLE_OFFSET 0x20
+#define EC_LOG_MAGIC 0x474C4345 // 'ECLG'
+
+// Region is the geometry header page followed by the TX ring, the RX ring and the log ring
+#define SBSAQEMU_RING_TX_OFFSET EFI_PAGE_SIZE
+#define SBSAQEMU_RING_RX_OFFSET (SBSAQEMU_RING_TX_OFFSET + SBSAQEMU_RING_SIZE)
+#define SBSAQEMU_LOG_OFFSET (SBSAQEMU_RING_RX_OFFSET + SBSAQEMU_RING_SIZE)
+#define SBSAQEMU_SHARED_MEM_SIZE (SBSAQEMU_LOG_OFFSET + SBSAQEMU_LOG_SIZE)
+#define SBSAQEMU_SHARED_MEM_PAGE_COUNT EFI_SIZE_TO_PAGES(SBSAQEMU_SHARED_MEM_SIZE)
+#define SBSAQEMU_SHARED_MEM_RANGE_COUNT 4
+
+#define EC_RING_GEO_MAGIC 0x47524345 // 'ECRG'
+#define EC_RING_GEO_VERSION 1
+
+// Pool of bulk transfer buffers after the FF-A RX/TX buffers, each shared with the EC in its own
+// FFA_MEM_SHARE so the OS can hand any of them to the EC by handle. Table layout must match
+// EC_BULK_* in inc/ecring.h
+#define SBSAQEMU_BULK_OFFSET 0x100000
+#define SBSAQEMU_BULK_BUFFER_COUNT 4
+#define SBSAQEMU_BULK_BUFFER_SIZE 0x40000
+#define SBSAQEMU_BULK_TABLE_OFFSET 0x40
+#define EC_BULK_MAGIC 0x4B424345 // 'ECBK'
+
+#define SBSAQEMU_TX_BUFFER_BASE 0x10060080000
+#define SBSAQEMU_RX_BUFFER_BASE 0x10060090000
+#define EC_SVC_TX_BUFFER_BASE 0x100600A0000
+#define EC_SVC_RX_BUFFER_BASE 0x100600B0000
+
+#define EC_SERVICE_VMID 0x8002
+
+// This just needs ot be unique value use ascii of SBSAQEMU
+#define SBSAQEMU_SHARED_MEM_TAG 0x5342534151454D55
+#define EC_SVC_MANAGEMENT_GUID_LO 0xfde54757330c1273
+#define EC_SVC_MANAGEMENT_GUID_HI 0x3903750298195b65
+
+// Commands to send to EC management service
+#define EC_CAP_MAP_SHARE 0x5
+
+#define FFA_SUCCESS_SMC32 0x84000061
+#define FFA_SUCCESS_SMC64 0xC4000061
+#define FFA_VERSION_SMC 0x84000063
+#define FFA_RXTX_MAP_SMC 0xC4000066
+#define FFA_RXTX_UNMAP_SMC 0x84000067
+#define FFA_MEM_SHARE_SMC 0x84000073
+#define FFA_MEM_RECLAIM_SMC 0x84000077
+#define FFA_MSG_SEND_DIRECT_REQ2_SMC 0xC400008D
+#define FFA_MSG_SEND_DIRECT_RESP2_SMC 0xC400008E
+
+// Published at SBSAQEMU_SHARED_MEM_BASE so the EC, ASL, driver and host tools agree on the layout
+typedef struct {
+  UINT32 magic;
+  UINT16 version;
+  UINT16 header_size;
+  UINT32 region_size;
+  UINT16 slot_count;
+  UINT16 entry_size;
+  UINT32 tx_offset;
+  UINT32 rx_offset;
+  UINT32 ring_size;
+  UINT16 entry_offset;
+  UINT16 reserved;
+} ec_ring_geometry_t;
+
+typedef UINT16 ffa_id_t;
+typedef UINT32 ffa_memory_region_flags_t;
+typedef UINT64 ffa_memory_handle_t;
+
+
+typedef struct {
+	UINT8 data_access : 2;
+	UINT8 instruction_access : 2;
+} ffa_memory_access_permissions_t;
+
+struct ffa_memory_access_impdef {
+	UINT64 val[2];
+};
+
+typedef struct {
+	UINT64 address;
+	UINT32 page_count;
+	UINT32 reserved;
+} memory_region_t;
+
+typedef struct {
+	UINT32 total_page_count;
+	UINT32 address_range_count;
+	UINT64 reserved;
+	memory_region_t regions[1];
+} composite_memory_region_t;
+
+typedef struct {
+  UINT16 id;
+  UINT8 perm;
+  UINT8 flags;
+} ffa_memory_attributes_t;
+
+typedef struct {
+  UINT64 impl_def[2];
+} ffa_memory_access_impdef_t;
+
+typedef struct {
+	ffa_memory_attributes_t receiver_permissions;
+	/**
+	 * Offset in bytes from the start of the outer `ffa_memory_region` to
+	 * an `ffa_composite_memory_region` struct.
+	 */
+	UINT32 composite_memory_region_offset;
+	//ffa_memory_access_impdef_t impldef;
+  UINT64 reserved_0;
+}ffa_memory_access_t;
+
+
+typedef struct {
+	/**
+	 * The ID of the VM which originally sent the memory region, i.e. the
+	 * owner.
+	 */
+	ffa_id_t sender;
+	UINT16 attributes;
+	/** Flags to control behaviour of the transaction. */
+	ffa_memory_region_flags_t flags;
+	ffa_memory_handle_t handle;
+	/**
+	 * An implementation defined value associated with the receiver and the
+	 * memory region.
+	 */
+	UINT64 tag;
+	/* Size of the memory access descriptor. */
+	UINT32 memory_access_desc_size;
+	/**
+	 * The number of `ffa_memory_access` entries included in this
+	 * transaction.
+	 */
+	UINT32 receiver_count;
+	/**
+	 * Offset of the 'ffa_memory_access' field, which relates to the memory access
+	 * descriptors.
+	 */
+	UINT32 receivers_offset;
+	/** Reserved field (12 bytes) must be 0. */
+	UINT32 reserved[3];
+
+//	ffa_memory_access_t memory_access;
+//	composite_memory_region_t memory_region;
+} ffa_memory_region_t;
+
+// Published at SBSAQEMU_SHARED_MEM_BASE + SBSAQEMU_LOG_TABLE_OFFSET, the EC owns the log header
+typedef struct {
+  UINT32 magic;
+  UINT32 offset;
+  UINT32 size;
+  UINT32 reserved;
+} ec_log_table_t;
+
+// Published at SBSAQEMU_SHARED_MEM_BASE + SBSAQEMU_BULK_TABLE_OFFSET, offsets are from the
+// start of the shared region
+typedef struct {
+  UINT64 handle;
+  UINT64 offset;
+} ec_bulk_entry_t;
+
+typedef struct {
+  UINT32 magic;
+  UINT16 count;
+  UINT16 reserved;
+  UINT32 buffer_size;
+  UINT32 reserved_1;
+  ec_bulk_entry_t entries[SBSAQEMU_BULK_BUFFER_COUNT];
+} ec_bulk_table_t;
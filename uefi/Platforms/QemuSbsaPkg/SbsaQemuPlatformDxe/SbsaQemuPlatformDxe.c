@@ -1,213 +1,365 @@
-/** @file
-*  FDT client protocol driver for qemu,mach-virt-ahci DT node
-*
-*  Copyright (c) 2019, Linaro Ltd. All rights reserved.
-*
-*  SPDX-License-Identifier: BSD-2-Clause-Patent
-*
-**/
-
-#include <Library/BaseLib.h>
-#include <Library/DebugLib.h>
-#include <Library/NonDiscoverableDeviceRegistrationLib.h>
-#include <Library/PcdLib.h>
-#include <Library/UefiBootServicesTableLib.h>
-#include <Library/UefiDriverEntryPoint.h>
-#include <Protocol/FdtClient.h>
-
-#include <Library/ArmSmcLib.h>
-#include <Library/BaseMemoryLib.h>
-#include "SbsaQemuPlatform.h"
-
-
-EFI_STATUS 
-SetupSbsaQemuSharedMemory(VOID)
-{
-  EFI_STATUS status;
-
-  // Chunk off this memory so the OS will not use it mark it reserved
-  EFI_PHYSICAL_ADDRESS MemoryAddress = SBSAQEMU_RESERVED_MEMORY_BASE;
-  UINT64 MemorySize = SBSAQEMU_RESERVED_MEMORY_SIZE;
-  status = gBS->AllocatePages(
-                  AllocateAddress,
-                  EfiReservedMemoryType,
-                  EFI_SIZE_TO_PAGES(MemorySize),
-                  &MemoryAddress
-                  );
-
-  DEBUG ((DEBUG_ERROR, "Allocated address: 0x%llx size: 0x%llx status: 0x%x\n", 
-            SBSAQEMU_RESERVED_MEMORY_BASE,
-            SBSAQEMU_RESERVED_MEMORY_SIZE,
-            status));
-  
-  ARM_SMC_ARGS  SmcArgs = {0};
-
-  DEBUG ((DEBUG_INFO, "Send that we support FFA version 1.2 request\n"));
-  ZeroMem(&SmcArgs, sizeof(SmcArgs));
-  SmcArgs.Arg0 = FFA_VERSION_SMC;
-  SmcArgs.Arg1 = 0x10002; // Indicate we support FFA Version 1.2
-  ArmCallSmc (&SmcArgs);
-
-  DEBUG ((DEBUG_ERROR, "    X0 = 0x%x\n", SmcArgs.Arg0));
-  DEBUG ((DEBUG_ERROR, "    X1 = 0x%x\n", SmcArgs.Arg1));
-  DEBUG ((DEBUG_ERROR, "    X2 = 0x%x\n", SmcArgs.Arg2));
-
-  // Send FFA_RXTX_MAP to setup buffers which are required to sned FFA_MEMS_SHARE request
-  DEBUG ((DEBUG_INFO, "Send FFA_RXTX_MAP request\n"));
-  ZeroMem(&SmcArgs, sizeof(SmcArgs));
-  SmcArgs.Arg0 = FFA_RXTX_MAP_SMC;
-  SmcArgs.Arg1 = SBSAQEMU_TX_BUFFER_BASE; // TX buffer
-  SmcArgs.Arg2 = SBSAQEMU_RX_BUFFER_BASE; // RX buffer
-  SmcArgs.Arg3 = 0x1; // Number of 4K pages for each RX/TX buffer
-
-  ArmCallSmc (&SmcArgs);
-  DEBUG ((DEBUG_ERROR, "    X0 = 0x%x\n", SmcArgs.Arg0));
-  DEBUG ((DEBUG_ERROR, "    X1 = 0x%x\n", SmcArgs.Arg1));
-  DEBUG ((DEBUG_ERROR, "    X2 = 0x%x\n", SmcArgs.Arg2));
-
-  // Populate the request
-  ffa_memory_region_t *mem_req = (ffa_memory_region_t *)SBSAQEMU_TX_BUFFER_BASE; // TX_BUFFER
-  mem_req->sender = 0; // OS VM is 0
-  mem_req->attributes = 0x03; // No share device no cache device memory nonsecure 0b0101 0100
-  mem_req->flags = 0;
-  mem_req->handle = 0x0;
-  mem_req->tag = SBSAQEMU_SHARED_MEM_TAG;
-  mem_req->memory_access_desc_size = sizeof(ffa_memory_access_t);
-  mem_req->receiver_count = 1;
-  mem_req->receivers_offset = sizeof(ffa_memory_region_t);
-  ffa_memory_access_t *memory_access = (ffa_memory_access_t *)((UINT64)mem_req + sizeof(ffa_memory_region_t));
-  DEBUG ((DEBUG_ERROR, "memory_access = 0x%x\n", (UINT64)memory_access));
-
-  memory_access->receiver_permissions.id = EC_SERVICE_VMID;
-  memory_access->receiver_permissions.perm = 2; // 0b0010 no instruction access data RW
-  memory_access->receiver_permissions.flags = 0;
-  memory_access->composite_memory_region_offset = sizeof(ffa_memory_region_t) + sizeof(ffa_memory_access_t);
-  memory_access->reserved_0 = 0;
-  composite_memory_region_t *memory_region = (composite_memory_region_t *)((UINT64)memory_access + sizeof(ffa_memory_access_t));
-  memory_region->total_page_count = 1;
-  memory_region->address_range_count = 1;
-  memory_region->reserved = 0;
-  memory_region->regions[0].address = SBSAQEMU_SHARED_MEM_BASE;
-  memory_region->regions[0].page_count = 1;
-
-  // Send FFA request to share this memory
-  DEBUG ((DEBUG_INFO, "Send FFA_MEM_SHARE request\n"));
-  UINT32 len = sizeof(ffa_memory_region_t) + sizeof(ffa_memory_access_t) + sizeof(composite_memory_region_t);
-
-  // Then register this test app to receive notifications from the Ffa test SP
-  ZeroMem(&SmcArgs, sizeof(SmcArgs));
-  SmcArgs.Arg0 = FFA_MEM_SHARE_SMC;
-  SmcArgs.Arg1 = len; // Length of Transaction descriptor
-  SmcArgs.Arg2 = len; // Length of Fragment
-  SmcArgs.Arg3 = 0x0; // Address of buffer holding ffa_memory_access
-  SmcArgs.Arg4 = 0x0; // Number of 4K pages
-
-  ArmCallSmc (&SmcArgs);
-
-  DEBUG ((DEBUG_ERROR, "    X0 = 0x%x\n", SmcArgs.Arg0));
-  DEBUG ((DEBUG_ERROR, "    X1 = 0x%x\n", SmcArgs.Arg1));
-  DEBUG ((DEBUG_ERROR, "    X2 = 0x%x\n", SmcArgs.Arg2));
-
-  // If success the handle is in x2 so save that off
-  mem_req->handle = SmcArgs.Arg2;
-
-  // Copy the Memory descriptor over to the TX_BUFFER for SP which it will use to retrieve
-  DEBUG ((DEBUG_INFO, "Send request to SP to fetch share memory region\n"));
-
-  // Initalize some known value in shared memory buffer
-  UINT64 *shared_mem = (UINT64 *)SBSAQEMU_SHARED_MEM_BASE;
-  *shared_mem = 0xDEADBEEF;
-
-  // Changed fields needed for the SP to retrieve this request
-  memory_access->composite_memory_region_offset = 0x0;
-
-  // Copy this into the TX buffer for EC svc so it can directly send
-  void *sp_tx_buffer = (void *)EC_SVC_TX_BUFFER_BASE;
-  CopyMem(sp_tx_buffer,mem_req,len);
-
-
-  // Then register this test app to receive notifications from the Ffa test SP
-  // <0x330c1273 0xfde54757 0x98195b65 0x39037502>
-  ZeroMem(&SmcArgs, sizeof(SmcArgs));
-  SmcArgs.Arg0 = FFA_MSG_SEND_DIRECT_REQ2_SMC;
-  SmcArgs.Arg1 = EC_SERVICE_VMID; // Sender and receiver
-  SmcArgs.Arg2 = EC_SVC_MANAGEMENT_GUID_LO; // uuid lo for FW Managment service
-  SmcArgs.Arg3 = EC_SVC_MANAGEMENT_GUID_HI; // uuid hi for FW Management service
-  SmcArgs.Arg4 = EC_CAP_MAP_SHARE;
-  SmcArgs.Arg5 = (UINT64)sp_tx_buffer;
-  SmcArgs.Arg6 = len;
-
-  ArmCallSmc (&SmcArgs);
-
-  DEBUG ((DEBUG_ERROR, "    X0 = 0x%x\n", SmcArgs.Arg0));
-  DEBUG ((DEBUG_ERROR, "    X1 = 0x%x\n", SmcArgs.Arg1));
-  DEBUG ((DEBUG_ERROR, "    X2 = 0x%x\n", SmcArgs.Arg2));
-
-
-  // We need to unmap our RXTX buffers again so the OS can re-set them up again
-  DEBUG ((DEBUG_INFO, "Send FFA_RXTX_UNMAP the OS will remap buffers again\n"));
-
-  ZeroMem(&SmcArgs, sizeof(SmcArgs));
-  SmcArgs.Arg0 = FFA_RXTX_UNMAP_SMC; // FFA_RXTX_UNMAP
-  SmcArgs.Arg1 = 0x0; // VM ID 0x0 for OS
-
-  ArmCallSmc (&SmcArgs);
-  DEBUG ((DEBUG_ERROR, "    X0 = 0x%x\n", SmcArgs.Arg0));
-  DEBUG ((DEBUG_ERROR, "    X1 = 0x%x\n", SmcArgs.Arg1));
-  DEBUG ((DEBUG_ERROR, "    X2 = 0x%x\n", SmcArgs.Arg2));
-
-  return EFI_SUCCESS;
-
-}
-
-EFI_STATUS
-EFIAPI
-InitializeSbsaQemuPlatformDxe (
-  IN EFI_HANDLE        ImageHandle,
-  IN EFI_SYSTEM_TABLE  *SystemTable
-  )
-{
-  EFI_STATUS  Status;
-  UINTN       Size;
-  VOID        *Base;
-
-  DEBUG ((DEBUG_INFO, "%a: InitializeSbsaQemuPlatformDxe called\n", __FUNCTION__));
-
-  Base = (VOID *)(UINTN)PcdGet64 (PcdPlatformAhciBase);
-  ASSERT (Base != NULL);
-  Size = (UINTN)PcdGet32 (PcdPlatformAhciSize);
-  ASSERT (Size != 0);
-
-  DEBUG ((
-    DEBUG_INFO,
-    "%a: Got platform AHCI %llx %u\n",
-    __FUNCTION__,
-    Base,
-    Size
-    ));
-
-  Status = RegisterNonDiscoverableMmioDevice (
-             NonDiscoverableDeviceTypeAhci,
-             NonDiscoverableDeviceDmaTypeCoherent,
-             NULL,
-             NULL,
-             1,
-             Base,
-             Size
-             );
-
-  if (EFI_ERROR (Status)) {
-    DEBUG ((
-      DEBUG_ERROR,
-      "%a: NonDiscoverable: Cannot install AHCI device @%p (Status == %r)\n",
-      __FUNCTION__,
-      Base,
-      Status
-      ));
-    return Status;
-  }
-
-  Status = SetupSbsaQemuSharedMemory();
-
-  return Status;
-}
+/** @file
+*  FDT client protocol driver for qemu,mach-virt-ahci DT node
+*
+*  Copyright (c) 2019, Linaro Ltd. All rights reserved.
+*
+*  SPDX-License-Identifier: BSD-2-Clause-Patent
+*
+**/
+
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/NonDiscoverableDeviceRegistrationLib.h>
+#include <Library/PcdLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiDriverEntryPoint.h>
+#include <Protocol/FdtClient.h>
+
+#include <Library/ArmSmcLib.h>
+#include <Library/BaseMemoryLib.h>
+#include "SbsaQemuPlatform.h"
+
+STATIC_ASSERT (sizeof (ec_ring_geometry_t) == 0x20, "Ring geometry header must match inc/ecring.h");
+STATIC_ASSERT (SBSAQEMU_SHARED_MEM_BASE + SBSAQEMU_SHARED_MEM_SIZE <= SBSAQEMU_TX_BUFFER_BASE, "Shared rings overlap FF-A RX/TX buffers");
+STATIC_ASSERT ((SBSAQEMU_RING_ENTRY_SIZE % 0x100) == 0 && SBSAQEMU_RING_ENTRY_SIZE <= 0x1000, "Invalid ring entry size");
+STATIC_ASSERT (SBSAQEMU_RING_SLOT_COUNT >= 1 && SBSAQEMU_RING_SLOT_COUNT <= 64, "Invalid ring slot count");
+STATIC_ASSERT ((SBSAQEMU_LOG_DATA_SIZE & (SBSAQEMU_LOG_DATA_SIZE - 1)) == 0 &&
+               SBSAQEMU_LOG_DATA_SIZE >= 0x1000 && SBSAQEMU_LOG_DATA_SIZE <= 0x100000, "Invalid log ring size");
+STATIC_ASSERT (SBSAQEMU_LOG_TABLE_OFFSET >= sizeof (ec_ring_geometry_t) &&
+               SBSAQEMU_LOG_TABLE_OFFSET + sizeof (ec_log_table_t) <= SBSAQEMU_BULK_TABLE_OFFSET, "Log table overlaps geometry or bulk table");
+STATIC_ASSERT (SBSAQEMU_BULK_OFFSET >= EC_SVC_RX_BUFFER_BASE + EFI_PAGE_SIZE - SBSAQEMU_SHARED_MEM_BASE, "Bulk pool overlaps FF-A RX/TX buffers");
+STATIC_ASSERT (SBSAQEMU_BULK_OFFSET + SBSAQEMU_BULK_BUFFER_COUNT * SBSAQEMU_BULK_BUFFER_SIZE <= SBSAQEMU_RESERVED_MEMORY_SIZE, "Bulk pool outside reserved memory");
+STATIC_ASSERT (SBSAQEMU_BULK_BUFFER_COUNT >= 1 && SBSAQEMU_BULK_BUFFER_COUNT <= 8, "Invalid bulk buffer count");
+STATIC_ASSERT ((SBSAQEMU_BULK_BUFFER_SIZE % EFI_PAGE_SIZE) == 0, "Bulk buffers must be whole pages");
+STATIC_ASSERT (SBSAQEMU_BULK_TABLE_OFFSET >= sizeof (ec_ring_geometry_t) &&
+               SBSAQEMU_BULK_TABLE_OFFSET + sizeof (ec_bulk_table_t) <= 0x100, "Bulk table overlaps geometry or event record");
+
+// Publish the ring geometry and log ring at the start of the shared region and clear the rings
+VOID
+PublishSbsaQemuRingGeometry(VOID)
+{
+  ec_ring_geometry_t *geometry = (ec_ring_geometry_t *)SBSAQEMU_SHARED_MEM_BASE;
+  ec_log_table_t *log = (ec_log_table_t *)(SBSAQEMU_SHARED_MEM_BASE + SBSAQEMU_LOG_TABLE_OFFSET);
+
+  ZeroMem((VOID *)SBSAQEMU_SHARED_MEM_BASE, SBSAQEMU_SHARED_MEM_SIZE);
+  geometry->version = EC_RING_GEO_VERSION;
+  geometry->header_size = sizeof(ec_ring_geometry_t);
+  geometry->region_size = SBSAQEMU_SHARED_MEM_SIZE;
+  geometry->slot_count = SBSAQEMU_RING_SLOT_COUNT;
+  geometry->entry_size = SBSAQEMU_RING_ENTRY_SIZE;
+  geometry->tx_offset = SBSAQEMU_RING_TX_OFFSET;
+  geometry->rx_offset = SBSAQEMU_RING_RX_OFFSET;
+  geometry->ring_size = SBSAQEMU_RING_SIZE;
+  geometry->entry_offset = SBSAQEMU_RING_ENTRY_OFFSET;
+  // Magic last so a reader never sees a partial header
+  MemoryFence();
+  geometry->magic = EC_RING_GEO_MAGIC;
+
+  // The EC fills in the log header when it maps the region
+  log->offset = SBSAQEMU_LOG_OFFSET;
+  log->size = SBSAQEMU_LOG_DATA_SIZE;
+  MemoryFence();
+  log->magic = EC_LOG_MAGIC;
+
+  DEBUG ((DEBUG_INFO, "Ring geometry slots %d entry 0x%x tx 0x%x rx 0x%x ring 0x%x log 0x%x\n",
+            SBSAQEMU_RING_SLOT_COUNT,
+            SBSAQEMU_RING_ENTRY_SIZE,
+            SBSAQEMU_RING_TX_OFFSET,
+            SBSAQEMU_RING_RX_OFFSET,
+            SBSAQEMU_RING_SIZE,
+            SBSAQEMU_LOG_OFFSET));
+}
+
+// Share each bulk buffer in its own transaction and have the EC retrieve it now, so the OS only
+// passes handles at runtime. RX/TX buffers must still be mapped.
+VOID
+ShareSbsaQemuBulkBuffers(VOID)
+{
+  ec_bulk_table_t *table = (ec_bulk_table_t *)(SBSAQEMU_SHARED_MEM_BASE + SBSAQEMU_BULK_TABLE_OFFSET);
+  ARM_SMC_ARGS  SmcArgs;
+  UINT32 count = 0;
+
+  ZeroMem(table, sizeof(ec_bulk_table_t));
+
+  for (UINT32 i = 0; i < SBSAQEMU_BULK_BUFFER_COUNT; i++) {
+    UINT64 offset = SBSAQEMU_BULK_OFFSET + i * SBSAQEMU_BULK_BUFFER_SIZE;
+
+    ffa_memory_region_t *mem_req = (ffa_memory_region_t *)SBSAQEMU_TX_BUFFER_BASE;
+    ZeroMem(mem_req, EFI_PAGE_SIZE);
+    mem_req->sender = 0;
+    mem_req->attributes = 0x03;
+    mem_req->tag = SBSAQEMU_SHARED_MEM_TAG + 1 + i;
+    mem_req->memory_access_desc_size = sizeof(ffa_memory_access_t);
+    mem_req->receiver_count = 1;
+    mem_req->receivers_offset = sizeof(ffa_memory_region_t);
+    ffa_memory_access_t *memory_access = (ffa_memory_access_t *)((UINT64)mem_req + sizeof(ffa_memory_region_t));
+    memory_access->receiver_permissions.id = EC_SERVICE_VMID;
+    memory_access->receiver_permissions.perm = 2; // 0b0010 no instruction access data RW
+    memory_access->composite_memory_region_offset = sizeof(ffa_memory_region_t) + sizeof(ffa_memory_access_t);
+    composite_memory_region_t *memory_region = (composite_memory_region_t *)((UINT64)memory_access + sizeof(ffa_memory_access_t));
+    memory_region->total_page_count = EFI_SIZE_TO_PAGES(SBSAQEMU_BULK_BUFFER_SIZE);
+    memory_region->address_range_count = 1;
+    memory_region->regions[0].address = SBSAQEMU_SHARED_MEM_BASE + offset;
+    memory_region->regions[0].page_count = EFI_SIZE_TO_PAGES(SBSAQEMU_BULK_BUFFER_SIZE);
+    UINT32 len = sizeof(ffa_memory_region_t) + sizeof(ffa_memory_access_t) + sizeof(composite_memory_region_t);
+
+    ZeroMem(&SmcArgs, sizeof(SmcArgs));
+    SmcArgs.Arg0 = FFA_MEM_SHARE_SMC;
+    SmcArgs.Arg1 = len;
+    SmcArgs.Arg2 = len;
+    ArmCallSmc (&SmcArgs);
+    if (SmcArgs.Arg0 != FFA_SUCCESS_SMC64 && SmcArgs.Arg0 != FFA_SUCCESS_SMC32) {
+      DEBUG ((DEBUG_ERROR, "Bulk buffer %u FFA_MEM_SHARE failed X0 = 0x%lx X2 = 0x%lx\n", i, SmcArgs.Arg0, SmcArgs.Arg2));
+      break;
+    }
+    mem_req->handle = SmcArgs.Arg2;
+
+    // Hand the descriptor to the EC so it retrieves the buffer once for the life of the system
+    memory_access->composite_memory_region_offset = 0x0;
+    CopyMem((void *)EC_SVC_TX_BUFFER_BASE, mem_req, len);
+
+    ZeroMem(&SmcArgs, sizeof(SmcArgs));
+    SmcArgs.Arg0 = FFA_MSG_SEND_DIRECT_REQ2_SMC;
+    SmcArgs.Arg1 = EC_SERVICE_VMID;
+    SmcArgs.Arg2 = EC_SVC_MANAGEMENT_GUID_LO;
+    SmcArgs.Arg3 = EC_SVC_MANAGEMENT_GUID_HI;
+    SmcArgs.Arg4 = EC_CAP_MAP_SHARE;
+    SmcArgs.Arg5 = EC_SVC_TX_BUFFER_BASE;
+    SmcArgs.Arg6 = len;
+    ArmCallSmc (&SmcArgs);
+    // The OS must never be handed a buffer the EC has not retrieved, take it back from the share
+    if (SmcArgs.Arg0 != FFA_MSG_SEND_DIRECT_RESP2_SMC || (UINT32)SmcArgs.Arg5 != 0) {
+      DEBUG ((DEBUG_ERROR, "Bulk buffer %u EC_CAP_MAP_SHARE refused X0 = 0x%lx X2 = 0x%lx X5 = 0x%lx\n", i, SmcArgs.Arg0, SmcArgs.Arg2, SmcArgs.Arg5));
+
+      ZeroMem(&SmcArgs, sizeof(SmcArgs));
+      SmcArgs.Arg0 = FFA_MEM_RECLAIM_SMC;
+      SmcArgs.Arg1 = (UINT32)mem_req->handle;
+      SmcArgs.Arg2 = (UINT32)(mem_req->handle >> 32);
+      ArmCallSmc (&SmcArgs);
+      if (SmcArgs.Arg0 != FFA_SUCCESS_SMC64 && SmcArgs.Arg0 != FFA_SUCCESS_SMC32) {
+        DEBUG ((DEBUG_ERROR, "Bulk buffer %u FFA_MEM_RECLAIM failed X0 = 0x%lx X2 = 0x%lx\n", i, SmcArgs.Arg0, SmcArgs.Arg2));
+      }
+      continue;
+    }
+
+    table->entries[count].handle = mem_req->handle;
+    table->entries[count].offset = offset;
+    count++;
+
+    DEBUG ((DEBUG_INFO, "Bulk buffer %u at 0x%lx handle 0x%lx\n", i, SBSAQEMU_SHARED_MEM_BASE + offset, mem_req->handle));
+  }
+
+  if (count == 0) {
+    return;
+  }
+
+  table->count = (UINT16)count;
+  table->buffer_size = SBSAQEMU_BULK_BUFFER_SIZE;
+  // Magic last so a reader never sees a partial table
+  MemoryFence();
+  table->magic = EC_BULK_MAGIC;
+}
+
+EFI_STATUS 
+SetupSbsaQemuSharedMemory(VOID)
+{
+  EFI_STATUS status;
+
+  // Chunk off this memory so the OS will not use it mark it reserved
+  EFI_PHYSICAL_ADDRESS MemoryAddress = SBSAQEMU_RESERVED_MEMORY_BASE;
+  UINT64 MemorySize = SBSAQEMU_RESERVED_MEMORY_SIZE;
+  status = gBS->AllocatePages(
+                  AllocateAddress,
+                  EfiReservedMemoryType,
+                  EFI_SIZE_TO_PAGES(MemorySize),
+                  &MemoryAddress
+                  );
+
+  DEBUG ((DEBUG_ERROR, "Allocated address: 0x%llx size: 0x%llx status: 0x%x\n", 
+            SBSAQEMU_RESERVED_MEMORY_BASE,
+            SBSAQEMU_RESERVED_MEMORY_SIZE,
+            status));
+  
+  ARM_SMC_ARGS  SmcArgs = {0};
+
+  DEBUG ((DEBUG_INFO, "Send that we support FFA version 1.2 request\n"));
+  ZeroMem(&SmcArgs, sizeof(SmcArgs));
+  SmcArgs.Arg0 = FFA_VERSION_SMC;
+  SmcArgs.Arg1 = 0x10002; // Indicate we support FFA Version 1.2
+  ArmCallSmc (&SmcArgs);
+
+  DEBUG ((DEBUG_ERROR, "    X0 = 0x%x\n", SmcArgs.Arg0));
+  DEBUG ((DEBUG_ERROR, "    X1 = 0x%x\n", SmcArgs.Arg1));
+  DEBUG ((DEBUG_ERROR, "    X2 = 0x%x\n", SmcArgs.Arg2));
+
+  // Send FFA_RXTX_MAP to setup buffers which are required to sned FFA_MEMS_SHARE request
+  DEBUG ((DEBUG_INFO, "Send FFA_RXTX_MAP request\n"));
+  ZeroMem(&SmcArgs, sizeof(SmcArgs));
+  SmcArgs.Arg0 = FFA_RXTX_MAP_SMC;
+  SmcArgs.Arg1 = SBSAQEMU_TX_BUFFER_BASE; // TX buffer
+  SmcArgs.Arg2 = SBSAQEMU_RX_BUFFER_BASE; // RX buffer
+  SmcArgs.Arg3 = 0x1; // Number of 4K pages for each RX/TX buffer
+
+  ArmCallSmc (&SmcArgs);
+  DEBUG ((DEBUG_ERROR, "    X0 = 0x%x\n", SmcArgs.Arg0));
+  DEBUG ((DEBUG_ERROR, "    X1 = 0x%x\n", SmcArgs.Arg1));
+  DEBUG ((DEBUG_ERROR, "    X2 = 0x%x\n", SmcArgs.Arg2));
+
+  // Populate the request
+  ffa_memory_region_t *mem_req = (ffa_memory_region_t *)SBSAQEMU_TX_BUFFER_BASE; // TX_BUFFER
+  mem_req->sender = 0; // OS VM is 0
+  mem_req->attributes = 0x03; // No share device no cache device memory nonsecure 0b0101 0100
+  mem_req->flags = 0;
+  mem_req->handle = 0x0;
+  mem_req->tag = SBSAQEMU_SHARED_MEM_TAG;
+  mem_req->memory_access_desc_size = sizeof(ffa_memory_access_t);
+  mem_req->receiver_count = 1;
+  mem_req->receivers_offset = sizeof(ffa_memory_region_t);
+  ffa_memory_access_t *memory_access = (ffa_memory_access_t *)((UINT64)mem_req + sizeof(ffa_memory_region_t));
+  DEBUG ((DEBUG_ERROR, "memory_access = 0x%x\n", (UINT64)memory_access));
+
+  memory_access->receiver_permissions.id = EC_SERVICE_VMID;
+  memory_access->receiver_permissions.perm = 2; // 0b0010 no instruction access data RW
+  memory_access->receiver_permissions.flags = 0;
+  memory_access->composite_memory_region_offset = sizeof(ffa_memory_region_t) + sizeof(ffa_memory_access_t);
+  memory_access->reserved_0 = 0;
+  composite_memory_region_t *memory_region = (composite_memory_region_t *)((UINT64)memory_access + sizeof(ffa_memory_access_t));
+  // Share the geometry page, TX ring, RX ring and log ring as separate ranges in one transaction
+  memory_region->total_page_count = SBSAQEMU_SHARED_MEM_PAGE_COUNT;
+  memory_region->address_range_count = SBSAQEMU_SHARED_MEM_RANGE_COUNT;
+  memory_region->reserved = 0;
+  memory_region->regions[0].address = SBSAQEMU_SHARED_MEM_BASE;
+  memory_region->regions[0].page_count = EFI_SIZE_TO_PAGES(SBSAQEMU_RING_TX_OFFSET);
+  memory_region->regions[0].reserved = 0;
+  memory_region->regions[1].address = SBSAQEMU_SHARED_MEM_BASE + SBSAQEMU_RING_TX_OFFSET;
+  memory_region->regions[1].page_count = EFI_SIZE_TO_PAGES(SBSAQEMU_RING_SIZE);
+  memory_region->regions[1].reserved = 0;
+  memory_region->regions[2].address = SBSAQEMU_SHARED_MEM_BASE + SBSAQEMU_RING_RX_OFFSET;
+  memory_region->regions[2].page_count = EFI_SIZE_TO_PAGES(SBSAQEMU_RING_SIZE);
+  memory_region->regions[2].reserved = 0;
+  memory_region->regions[3].address = SBSAQEMU_SHARED_MEM_BASE + SBSAQEMU_LOG_OFFSET;
+  memory_region->regions[3].page_count = EFI_SIZE_TO_PAGES(SBSAQEMU_LOG_SIZE);
+  memory_region->regions[3].reserved = 0;
+
+  // Send FFA request to share this memory
+  DEBUG ((DEBUG_INFO, "Send FFA_MEM_SHARE request for 0x%x pages\n", SBSAQEMU_SHARED_MEM_PAGE_COUNT));
+  UINT32 len = sizeof(ffa_memory_region_t) + sizeof(ffa_memory_access_t) + sizeof(composite_memory_region_t) +
+               (SBSAQEMU_SHARED_MEM_RANGE_COUNT - 1) * sizeof(memory_region_t);
+
+  // Then register this test app to receive notifications from the Ffa test SP
+  ZeroMem(&SmcArgs, sizeof(SmcArgs));
+  SmcArgs.Arg0 = FFA_MEM_SHARE_SMC;
+  SmcArgs.Arg1 = len; // Length of Transaction descriptor
+  SmcArgs.Arg2 = len; // Length of Fragment
+  SmcArgs.Arg3 = 0x0; // Address of buffer holding ffa_memory_access
+  SmcArgs.Arg4 = 0x0; // Number of 4K pages
+
+  ArmCallSmc (&SmcArgs);
+
+  DEBUG ((DEBUG_ERROR, "    X0 = 0x%x\n", SmcArgs.Arg0));
+  DEBUG ((DEBUG_ERROR, "    X1 = 0x%x\n", SmcArgs.Arg1));
+  DEBUG ((DEBUG_ERROR, "    X2 = 0x%x\n", SmcArgs.Arg2));
+
+  // If success the handle is in x2 so save that off
+  mem_req->handle = SmcArgs.Arg2;
+
+  // Copy the Memory descriptor over to the TX_BUFFER for SP which it will use to retrieve
+  DEBUG ((DEBUG_INFO, "Send request to SP to fetch share memory region\n"));
+
+  // Geometry must be in place before the EC service maps the region
+  PublishSbsaQemuRingGeometry();
+
+  // Changed fields needed for the SP to retrieve this request
+  memory_access->composite_memory_region_offset = 0x0;
+
+  // Copy this into the TX buffer for EC svc so it can directly send
+  void *sp_tx_buffer = (void *)EC_SVC_TX_BUFFER_BASE;
+  CopyMem(sp_tx_buffer,mem_req,len);
+
+
+  // Then register this test app to receive notifications from the Ffa test SP
+  // <0x330c1273 0xfde54757 0x98195b65 0x39037502>
+  ZeroMem(&SmcArgs, sizeof(SmcArgs));
+  SmcArgs.Arg0 = FFA_MSG_SEND_DIRECT_REQ2_SMC;
+  SmcArgs.Arg1 = EC_SERVICE_VMID; // Sender and receiver
+  SmcArgs.Arg2 = EC_SVC_MANAGEMENT_GUID_LO; // uuid lo for FW Managment service
+  SmcArgs.Arg3 = EC_SVC_MANAGEMENT_GUID_HI; // uuid hi for FW Management service
+  SmcArgs.Arg4 = EC_CAP_MAP_SHARE;
+  SmcArgs.Arg5 = (UINT64)sp_tx_buffer;
+  SmcArgs.Arg6 = len;
+
+  ArmCallSmc (&SmcArgs);
+
+  DEBUG ((DEBUG_ERROR, "    X0 = 0x%x\n", SmcArgs.Arg0));
+  DEBUG ((DEBUG_ERROR, "    X1 = 0x%x\n", SmcArgs.Arg1));
+  DEBUG ((DEBUG_ERROR, "    X2 = 0x%x\n", SmcArgs.Arg2));
+
+  ShareSbsaQemuBulkBuffers();
+
+  // We need to unmap our RXTX buffers again so the OS can re-set them up again
+  DEBUG ((DEBUG_INFO, "Send FFA_RXTX_UNMAP the OS will remap buffers again\n"));
+
+  ZeroMem(&SmcArgs, sizeof(SmcArgs));
+  SmcArgs.Arg0 = FFA_RXTX_UNMAP_SMC; // FFA_RXTX_UNMAP
+  SmcArgs.Arg1 = 0x0; // VM ID 0x0 for OS
+
+  ArmCallSmc (&SmcArgs);
+  DEBUG ((DEBUG_ERROR, "    X0 = 0x%x\n", SmcArgs.Arg0));
+  DEBUG ((DEBUG_ERROR, "    X1 = 0x%x\n", SmcArgs.Arg1));
+  DEBUG ((DEBUG_ERROR, "    X2 = 0x%x\n", SmcArgs.Arg2));
+
+  return EFI_SUCCESS;
+
+}
+
+EFI_STATUS
+EFIAPI
+InitializeSbsaQemuPlatformDxe (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Size;
+  VOID        *Base;
+
+  DEBUG ((DEBUG_INFO, "%a: InitializeSbsaQemuPlatformDxe called\n", __FUNCTION__));
+
+  Base = (VOID *)(UINTN)PcdGet64 (PcdPlatformAhciBase);
+  ASSERT (Base != NULL);
+  Size = (UINTN)PcdGet32 (PcdPlatformAhciSize);
+  ASSERT (Size != 0);
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: Got platform AHCI %llx %u\n",
+    __FUNCTION__,
+    Base,
+    Size
+    ));
+
+  Status = RegisterNonDiscoverableMmioDevice (
+             NonDiscoverableDeviceTypeAhci,
+             NonDiscoverableDeviceDmaTypeCoherent,
+             NULL,
+             NULL,
+             1,
+             Base,
+             Size
+             );
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((
+      DEBUG_ERROR,
+      "%a: NonDiscoverable: Cannot install AHCI device @%p (Status == %r)\n",
+      __FUNCTION__,
+      Base,
+      Status
+      ));
+    return Status;
+  }
+
+  Status = SetupSbsaQemuSharedMemory();
+
+  return Status;
+}